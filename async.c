@@ -0,0 +1,891 @@
+/*
+ * async.c -- non-blocking query engine
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#include <sys/time.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_EPOLL_CREATE1)
+#define USE_EPOLL 1
+#include <sys/epoll.h>
+#elif defined(HAVE_POLL)
+#include <poll.h>
+#endif
+
+/* The timer wheel has LDNS_ASYNC_SLOTS slots of LDNS_ASYNC_TICK
+ * milliseconds.  Timers more than a full turn of the wheel away stay in
+ * their slot until their turn comes.
+ */
+#define LDNS_ASYNC_TICK		8
+#define LDNS_ASYNC_SLOTS	1024
+
+/* Initial size of the hash table of queries in flight, a power of two */
+#define LDNS_ASYNC_HASH_SIZE	1024
+
+/* Datagrams read from one socket before moving on to the next */
+#define LDNS_ASYNC_READ_BUDGET	64
+
+/* Events handled per epoll_wait() */
+#define LDNS_ASYNC_EVENTS	64
+
+typedef struct ldns_async_q ldns_async_q;
+
+/* A query in flight */
+struct ldns_async_q {
+	ldns_async_cb		 cb;
+	void			*arg;
+
+	/* The query in wire format, the ID is set for every try */
+	uint8_t			*wire;
+	size_t			 wire_len;
+
+	/* The question, to check the answer against */
+	ldns_rdf		*qname;
+	ldns_rr_type		 qtype;
+	ldns_rr_class		 qclass;
+
+	/* The current try: socket, ID and nameserver */
+	size_t			 sock;
+	uint16_t		 id;
+	size_t			 ns;
+	struct sockaddr_storage	 to;
+	socklen_t		 tolen;
+	struct timeval		 sent;
+
+	/* Tries left after the current one */
+	size_t			 tries;
+
+	/* When the current try times out, in milliseconds */
+	uint64_t		 expiry;
+	size_t			 slot;
+	ldns_async_q		*tprev;
+	ldns_async_q		*tnext;
+
+	/* Next in the hash bucket for (sock, id) */
+	ldns_async_q		*hnext;
+};
+
+typedef struct ldns_async_sock {
+	int fd;
+	int family;
+} ldns_async_sock;
+
+struct ldns_struct_async {
+	ldns_resolver		*r;
+
+	/* sockets[0 .. n) are IPv4 and sockets[n .. 2n) are IPv6 */
+	ldns_async_sock		*sockets;
+	size_t			 n;
+	size_t			 next4;
+	size_t			 next6;
+#ifdef USE_EPOLL
+	int			 epfd;
+#elif defined(HAVE_POLL)
+	struct pollfd		*pfds;
+#endif
+
+	/* The queries in flight, on (socket, ID) */
+	ldns_async_q		**hash;
+	size_t			 hash_size;
+	size_t			 count;
+
+	/* The timers of the queries in flight */
+	ldns_async_q		*wheel[LDNS_ASYNC_SLOTS];
+	uint64_t		 tick;
+
+	uint8_t			*rbuf;
+};
+
+static uint64_t
+ldns_async_now(struct timeval *tv)
+{
+	struct timeval now;
+
+	if (!tv) {
+		tv = &now;
+	}
+	gettimeofday(tv, NULL);
+	return (uint64_t)tv->tv_sec * 1000 + (uint64_t)tv->tv_usec / 1000;
+}
+
+static void
+ldns_async_q_free(ldns_async_q *q)
+{
+	LDNS_FREE(q->wire);
+	ldns_rdf_deep_free(q->qname);
+	LDNS_FREE(q);
+}
+
+/*
+ * Hash table of queries in flight
+ */
+
+INLINE size_t
+ldns_async_bucket(const ldns_async *a, size_t sock, uint16_t id)
+{
+	return (((size_t)id << 8) ^ sock ^ id) & (a->hash_size - 1);
+}
+
+static ldns_async_q *
+ldns_async_lookup(const ldns_async *a, size_t sock, uint16_t id)
+{
+	ldns_async_q *q;
+
+	for (q = a->hash[ldns_async_bucket(a, sock, id)]; q; q = q->hnext) {
+		if (q->sock == sock && q->id == id) {
+			return q;
+		}
+	}
+	return NULL;
+}
+
+static void
+ldns_async_hash_remove(ldns_async *a, ldns_async_q *q)
+{
+	ldns_async_q **p = &a->hash[ldns_async_bucket(a, q->sock, q->id)];
+
+	while (*p && *p != q) {
+		p = &(*p)->hnext;
+	}
+	if (*p) {
+		*p = q->hnext;
+	}
+}
+
+static void
+ldns_async_hash_insert(ldns_async *a, ldns_async_q *q)
+{
+	ldns_async_q **hash, *e, *next;
+	size_t i, old_size, b;
+
+	if (a->count >= a->hash_size
+	&&  (hash = LDNS_CALLOC(ldns_async_q *, a->hash_size * 2))) {
+		/* grow, best effort: longer chains still work */
+		old_size = a->hash_size;
+		a->hash_size *= 2;
+		for (i = 0; i < old_size; i++) {
+			for (e = a->hash[i]; e; e = next) {
+				next = e->hnext;
+				b = ldns_async_bucket(a, e->sock, e->id);
+				e->hnext = hash[b];
+				hash[b] = e;
+			}
+		}
+		LDNS_FREE(a->hash);
+		a->hash = hash;
+	}
+	b = ldns_async_bucket(a, q->sock, q->id);
+	q->hnext = a->hash[b];
+	a->hash[b] = q;
+}
+
+/*
+ * Timer wheel
+ */
+
+static void
+ldns_async_timer_add(ldns_async *a, ldns_async_q *q)
+{
+	uint64_t t = q->expiry / LDNS_ASYNC_TICK;
+
+	if (t <= a->tick) {
+		t = a->tick + 1;
+	}
+	q->slot = (size_t)(t % LDNS_ASYNC_SLOTS);
+	q->tprev = NULL;
+	q->tnext = a->wheel[q->slot];
+	if (q->tnext) {
+		q->tnext->tprev = q;
+	}
+	a->wheel[q->slot] = q;
+}
+
+static void
+ldns_async_timer_remove(ldns_async *a, ldns_async_q *q)
+{
+	if (q->tprev) {
+		q->tprev->tnext = q->tnext;
+	} else {
+		a->wheel[q->slot] = q->tnext;
+	}
+	if (q->tnext) {
+		q->tnext->tprev = q->tprev;
+	}
+	q->tprev = q->tnext = NULL;
+}
+
+/*
+ * Sockets
+ */
+
+/** best effort to set nonblocking */
+static void
+ldns_async_sock_nonblock(int sockfd)
+{
+#ifdef HAVE_FCNTL
+	int flag;
+	if((flag = fcntl(sockfd, F_GETFL)) != -1) {
+		flag |= O_NONBLOCK;
+		if(fcntl(sockfd, F_SETFL, flag) == -1) {
+			/* ignore error, continue blockingly */
+		}
+	}
+#elif defined(HAVE_IOCTLSOCKET)
+	unsigned long on = 1;
+	if(ioctlsocket(sockfd, FIONBIO, &on) != 0) {
+		/* ignore error, continue blockingly */
+	}
+#endif
+}
+
+static bool
+ldns_async_sock_open(ldns_async *a, size_t i)
+{
+	ldns_async_sock *s = &a->sockets[i];
+	struct sockaddr_storage *src;
+	size_t src_len = 0;
+#ifdef USE_EPOLL
+	struct epoll_event ev;
+#endif
+
+	if ((s->fd = socket(s->family, SOCK_DGRAM, IPPROTO_UDP))
+			== SOCK_INVALID) {
+		s->fd = -1;
+		return false;
+	}
+	/* Bind to the source address of the resolver, on a random port
+	 * chosen by the system, when it is of the same address family.
+	 */
+	if (ldns_resolver_source(a->r)
+	&& (src = ldns_rdf2native_sockaddr_storage(
+			ldns_resolver_source(a->r), 0, &src_len))) {
+
+		if (src->ss_family == AF_INET) {
+			((struct sockaddr_in *)src)->sin_port = 0;
+		} else if (src->ss_family == AF_INET6) {
+			((struct sockaddr_in6 *)src)->sin6_port = 0;
+		}
+		if (src->ss_family == s->family
+		&&  bind(s->fd, (struct sockaddr *)src, (socklen_t)src_len)
+				== -1) {
+			LDNS_FREE(src);
+			close_socket(s->fd);
+			return false;
+		}
+		LDNS_FREE(src);
+	}
+	ldns_async_sock_nonblock(s->fd);
+#ifdef USE_EPOLL
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = (uint32_t)i;
+	if (epoll_ctl(a->epfd, EPOLL_CTL_ADD, s->fd, &ev) == -1) {
+		close_socket(s->fd);
+		return false;
+	}
+#endif
+	return true;
+}
+
+/* Chooses the socket and message ID for the next try of q to q->to */
+static ldns_status
+ldns_async_pick(ldns_async *a, ldns_async_q *q)
+{
+	size_t base, *next, i, j, k;
+
+	if (q->to.ss_family == AF_INET6) {
+		base = a->n;
+		next = &a->next6;
+	} else {
+		base = 0;
+		next = &a->next4;
+	}
+	for (i = 0; i < a->n; i++) {
+		j = base + (*next)++ % a->n;
+
+		if (a->sockets[j].fd == -1 && !ldns_async_sock_open(a, j)) {
+			return LDNS_STATUS_SOCKET_ERROR;
+		}
+		for (k = 0; k < 16; k++) {
+			q->id = ldns_get_random();
+			if (!ldns_async_lookup(a, j, q->id)) {
+				q->sock = j;
+				return LDNS_STATUS_OK;
+			}
+		}
+	}
+	/* All sockets are busy with (nearly) all IDs */
+	return LDNS_STATUS_SOCKET_ERROR;
+}
+
+/* Sets q->to to the first usable nameserver from index start onwards */
+static bool
+ldns_async_next_ns(ldns_async *a, ldns_async_q *q, size_t start)
+{
+	size_t count = ldns_resolver_nameserver_count(a->r);
+	ldns_rdf **nss = ldns_resolver_nameservers(a->r);
+	size_t *rtt = ldns_resolver_rtt(a->r);
+	struct sockaddr_storage *ns;
+	size_t ns_len, i, j;
+
+	for (i = 0; i < count; i++) {
+		j = (start + i) % count;
+		if (rtt && rtt[j] == LDNS_RESOLV_RTT_INF) {
+			continue;
+		}
+		if (!(ns = ldns_rdf2native_sockaddr_storage(nss[j],
+				ldns_resolver_port(a->r), &ns_len))) {
+			continue;
+		}
+		if ((ns->ss_family == AF_INET &&
+		     ldns_resolver_ip6(a->r) == LDNS_RESOLV_INET6)
+		||  (ns->ss_family == AF_INET6 &&
+		     ldns_resolver_ip6(a->r) == LDNS_RESOLV_INET)) {
+			/* not reachable */
+			LDNS_FREE(ns);
+			continue;
+		}
+		memcpy(&q->to, ns, ns_len);
+		q->tolen = (socklen_t)ns_len;
+		q->ns = j;
+		LDNS_FREE(ns);
+		return true;
+	}
+	return false;
+}
+
+static void
+ldns_async_send_try(ldns_async *a, ldns_async_q *q)
+{
+	struct timeval timeout = ldns_resolver_timeout(a->r);
+	ssize_t bytes;
+	uint64_t now;
+
+	ldns_write_uint16(q->wire, q->id);
+	ldns_async_hash_insert(a, q);
+
+	now = ldns_async_now(&q->sent);
+	bytes = sendto(a->sockets[q->sock].fd, (void *)q->wire, q->wire_len,
+			0, (struct sockaddr *)&q->to, q->tolen);
+	if (bytes == -1 || (size_t)bytes != q->wire_len) {
+		/* counts as a try that timed out right away */
+		q->expiry = now;
+	} else {
+		q->expiry = now + (uint64_t)timeout.tv_sec * 1000
+		                + (uint64_t)timeout.tv_usec / 1000;
+	}
+	ldns_async_timer_add(a, q);
+}
+
+static void
+ldns_async_finish(ldns_async *a, ldns_async_q *q,
+		ldns_status status, ldns_pkt *answer)
+{
+	a->count--;
+	q->cb(status, answer, q->arg);
+	ldns_async_q_free(q);
+}
+
+/* q timed out, send it again to the next nameserver or give up */
+static void
+ldns_async_retry(ldns_async *a, ldns_async_q *q)
+{
+	ldns_status status = LDNS_STATUS_NETWORK_ERR;
+
+	if (q->tries > 0) {
+		q->tries--;
+		if (ldns_async_next_ns(a, q, q->ns + 1)
+		&& (status = ldns_async_pick(a, q)) == LDNS_STATUS_OK) {
+			ldns_async_send_try(a, q);
+			return;
+		}
+		if (status == LDNS_STATUS_OK) {
+			status = LDNS_STATUS_NETWORK_ERR;
+		}
+	}
+	ldns_async_finish(a, q, status, NULL);
+}
+
+/* Handles the timers of the ticks that have fully passed */
+static void
+ldns_async_expire(ldns_async *a, uint64_t now)
+{
+	uint64_t t, end = now / LDNS_ASYNC_TICK;
+	ldns_async_q *q, *next, *expired = NULL;
+
+	if (end <= a->tick + 1) {
+		return;
+	}
+	t = a->tick + 1;
+	if (end - t > LDNS_ASYNC_SLOTS) {
+		/* visit every slot once */
+		t = end - LDNS_ASYNC_SLOTS;
+	}
+	for (; t < end; t++) {
+		for (q = a->wheel[t % LDNS_ASYNC_SLOTS]; q; q = next) {
+			next = q->tnext;
+			if (q->expiry <= now) {
+				ldns_async_timer_remove(a, q);
+				ldns_async_hash_remove(a, q);
+				q->tnext = expired;
+				expired = q;
+			}
+		}
+	}
+	a->tick = end - 1;
+
+	/* Retry after the wheel is updated, retries add new timers */
+	while ((q = expired)) {
+		expired = q->tnext;
+		q->tnext = NULL;
+		ldns_async_retry(a, q);
+	}
+}
+
+static bool
+ldns_async_from_ns(const ldns_async_q *q, const struct sockaddr_storage *from)
+{
+	const struct sockaddr_in *a4, *b4;
+	const struct sockaddr_in6 *a6, *b6;
+
+	if (from->ss_family != q->to.ss_family) {
+		return false;
+	}
+	if (from->ss_family == AF_INET) {
+		a4 = (const struct sockaddr_in *)from;
+		b4 = (const struct sockaddr_in *)&q->to;
+		return a4->sin_port == b4->sin_port
+		    && memcmp(&a4->sin_addr, &b4->sin_addr,
+				    sizeof(a4->sin_addr)) == 0;
+	}
+	if (from->ss_family == AF_INET6) {
+		a6 = (const struct sockaddr_in6 *)from;
+		b6 = (const struct sockaddr_in6 *)&q->to;
+		return a6->sin6_port == b6->sin6_port
+		    && memcmp(&a6->sin6_addr, &b6->sin6_addr,
+				    sizeof(a6->sin6_addr)) == 0;
+	}
+	return false;
+}
+
+static bool
+ldns_async_question_matches(const ldns_async_q *q, const ldns_pkt *answer)
+{
+	ldns_rr *question;
+
+	if (!q->qname) {
+		return true;
+	}
+	if (ldns_pkt_qdcount(answer) != 1) {
+		return false;
+	}
+	question = ldns_rr_list_rr(ldns_pkt_question(answer), 0);
+	return ldns_rr_get_type(question) == q->qtype
+	    && ldns_rr_get_class(question) == q->qclass
+	    && ldns_dname_compare(ldns_rr_owner(question), q->qname) == 0;
+}
+
+/* Reads and handles the datagrams waiting on socket i */
+static void
+ldns_async_read(ldns_async *a, size_t i)
+{
+	struct sockaddr_storage from;
+	socklen_t fromlen;
+	ssize_t len;
+	size_t n;
+	ldns_async_q *q;
+	ldns_pkt *answer;
+	struct timeval now;
+
+	for (n = 0; n < LDNS_ASYNC_READ_BUDGET; n++) {
+		if (a->sockets[i].fd == -1) {
+			break;
+		}
+		fromlen = (socklen_t)sizeof(from);
+		len = recvfrom(a->sockets[i].fd, (void *)a->rbuf,
+				LDNS_MAX_PACKETLEN, 0,
+				(struct sockaddr *)&from, &fromlen);
+		if (len == -1) {
+			/* EAGAIN, or an ICMP error for some query which
+			 * we can not tell apart; let that one time out.
+			 */
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			continue;
+		}
+		if ((size_t)len < LDNS_HEADER_SIZE || !LDNS_QR_WIRE(a->rbuf)) {
+			continue;
+		}
+		q = ldns_async_lookup(a, i, LDNS_ID_WIRE(a->rbuf));
+		if (!q || !ldns_async_from_ns(q, &from)) {
+			continue;
+		}
+		if (ldns_wire2pkt(&answer, a->rbuf, (size_t)len)
+				!= LDNS_STATUS_OK) {
+			continue;
+		}
+		if (!ldns_async_question_matches(q, answer)) {
+			ldns_pkt_free(answer);
+			continue;
+		}
+		ldns_async_hash_remove(a, q);
+		ldns_async_timer_remove(a, q);
+
+		gettimeofday(&now, NULL);
+		ldns_pkt_set_querytime(answer, (uint32_t)
+			((now.tv_sec - q->sent.tv_sec) * 1000) +
+			(now.tv_usec - q->sent.tv_usec) / 1000);
+		ldns_pkt_set_answerfrom(answer, ldns_rdf_clone(
+			ldns_resolver_nameservers(a->r)[q->ns]));
+		ldns_pkt_set_timestamp(answer, q->sent);
+		ldns_pkt_set_size(answer, (size_t)len);
+
+		ldns_async_finish(a, q, LDNS_STATUS_OK, answer);
+	}
+}
+
+/* Waits at most timeout milliseconds for answers and handles them, and
+ * then handles the timers that have expired.
+ */
+static ldns_status
+ldns_async_wait(ldns_async *a, int timeout)
+{
+	size_t i;
+#ifdef USE_EPOLL
+	struct epoll_event ev[LDNS_ASYNC_EVENTS];
+	int n;
+
+	n = epoll_wait(a->epfd, ev, LDNS_ASYNC_EVENTS, timeout);
+	if (n == -1 && errno != EINTR) {
+		return LDNS_STATUS_NETWORK_ERR;
+	}
+	for (i = 0; n > 0 && i < (size_t)n; i++) {
+		ldns_async_read(a, (size_t)ev[i].data.u32);
+	}
+#elif defined(HAVE_POLL)
+	size_t nfds = 0;
+	int n;
+
+	for (i = 0; i < 2 * a->n; i++) {
+		if (a->sockets[i].fd != -1) {
+			a->pfds[nfds].fd = a->sockets[i].fd;
+			a->pfds[nfds].events = POLLIN;
+			a->pfds[nfds].revents = 0;
+			nfds++;
+		}
+	}
+	n = poll(a->pfds, (nfds_t)nfds, timeout);
+	if (n == -1 && errno != EINTR) {
+		return LDNS_STATUS_NETWORK_ERR;
+	}
+	for (i = 0, nfds = 0; n > 0 && i < 2 * a->n; i++) {
+		if (a->sockets[i].fd != -1
+		&&  (a->pfds[nfds++].revents & (POLLIN|POLLERR))) {
+			ldns_async_read(a, i);
+		}
+	}
+#else
+	fd_set fds;
+	int max = -1, n;
+	struct timeval tv;
+
+	FD_ZERO(&fds);
+	for (i = 0; i < 2 * a->n; i++) {
+		if (a->sockets[i].fd != -1) {
+			FD_SET(FD_SET_T a->sockets[i].fd, &fds);
+			if (a->sockets[i].fd > max) {
+				max = a->sockets[i].fd;
+			}
+		}
+	}
+	tv.tv_sec = timeout / 1000;
+	tv.tv_usec = (timeout % 1000) * 1000;
+	n = select(max + 1, &fds, NULL, NULL, timeout < 0 ? NULL : &tv);
+	if (n == -1 && errno != EINTR) {
+		return LDNS_STATUS_NETWORK_ERR;
+	}
+	for (i = 0; n > 0 && i < 2 * a->n; i++) {
+		if (a->sockets[i].fd != -1
+		&&  FD_ISSET(a->sockets[i].fd, &fds)) {
+			ldns_async_read(a, i);
+		}
+	}
+#endif
+	ldns_async_expire(a, ldns_async_now(NULL));
+	return LDNS_STATUS_OK;
+}
+
+/*
+ * Public functions
+ */
+
+ldns_async *
+ldns_async_new(ldns_resolver *r, size_t sockets)
+{
+	ldns_async *a;
+	size_t i;
+
+	if (!r) {
+		return NULL;
+	}
+	if (sockets == 0) {
+		sockets = LDNS_ASYNC_DEFAULT_SOCKETS;
+	}
+	if (!(a = LDNS_CALLOC(ldns_async, 1))) {
+		return NULL;
+	}
+	a->r = r;
+	a->n = sockets;
+	a->hash_size = LDNS_ASYNC_HASH_SIZE;
+	a->sockets = LDNS_XMALLOC(ldns_async_sock, 2 * sockets);
+	a->hash = LDNS_CALLOC(ldns_async_q *, a->hash_size);
+	a->rbuf = LDNS_XMALLOC(uint8_t, LDNS_MAX_PACKETLEN);
+#ifdef USE_EPOLL
+	a->epfd = epoll_create1(0);
+	if (a->epfd == -1) {
+		LDNS_FREE(a->sockets);
+		LDNS_FREE(a->hash);
+		LDNS_FREE(a->rbuf);
+		LDNS_FREE(a);
+		return NULL;
+	}
+#elif defined(HAVE_POLL)
+	a->pfds = LDNS_XMALLOC(struct pollfd, 2 * sockets);
+	if (!a->pfds) {
+		LDNS_FREE(a->sockets);
+		LDNS_FREE(a->hash);
+		LDNS_FREE(a->rbuf);
+		LDNS_FREE(a);
+		return NULL;
+	}
+#endif
+	if (!a->sockets || !a->hash || !a->rbuf) {
+		a->n = 0;
+		ldns_async_free(a);
+		return NULL;
+	}
+	for (i = 0; i < 2 * sockets; i++) {
+		a->sockets[i].fd = -1;
+		a->sockets[i].family = i < sockets ? AF_INET : AF_INET6;
+	}
+	a->next4 = ldns_get_random();
+	a->next6 = ldns_get_random();
+	a->tick = ldns_async_now(NULL) / LDNS_ASYNC_TICK;
+	return a;
+}
+
+void
+ldns_async_free(ldns_async *a)
+{
+	ldns_async_q *q, *next;
+	size_t i;
+
+	if (!a) {
+		return;
+	}
+	for (i = 0; a->hash && i < a->hash_size; i++) {
+		for (q = a->hash[i]; q; q = next) {
+			next = q->hnext;
+			ldns_async_q_free(q);
+		}
+	}
+	for (i = 0; a->sockets && i < 2 * a->n; i++) {
+		close_socket(a->sockets[i].fd);
+	}
+#ifdef USE_EPOLL
+	close(a->epfd);
+#elif defined(HAVE_POLL)
+	LDNS_FREE(a->pfds);
+#endif
+	LDNS_FREE(a->sockets);
+	LDNS_FREE(a->hash);
+	LDNS_FREE(a->rbuf);
+	LDNS_FREE(a);
+}
+
+ldns_status
+ldns_async_send_pkt(ldns_async *a, const ldns_pkt *query,
+		ldns_async_cb cb, void *arg)
+{
+	ldns_async_q *q;
+	ldns_buffer *qb;
+	ldns_rr *question;
+	size_t count, start;
+	ldns_status status;
+
+	if (!a || !query || !cb) {
+		return LDNS_STATUS_NULL;
+	}
+	if ((count = ldns_resolver_nameserver_count(a->r)) == 0) {
+		return LDNS_STATUS_RES_NO_NS;
+	}
+	if (!(q = LDNS_CALLOC(ldns_async_q, 1))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	q->cb = cb;
+	q->arg = arg;
+
+	if (!(qb = ldns_buffer_new(LDNS_MIN_BUFLEN))) {
+		LDNS_FREE(q);
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if ((status = ldns_pkt2buffer_wire(qb, query)) != LDNS_STATUS_OK) {
+		ldns_buffer_free(qb);
+		LDNS_FREE(q);
+		return status;
+	}
+	q->wire_len = ldns_buffer_position(qb);
+	q->wire = ldns_buffer_export(qb);
+	ldns_buffer_free(qb);
+
+	if (ldns_pkt_qdcount(query) == 1) {
+		question = ldns_rr_list_rr(ldns_pkt_question(query), 0);
+		q->qtype = ldns_rr_get_type(question);
+		q->qclass = ldns_rr_get_class(question);
+		if (!(q->qname = ldns_rdf_clone(ldns_rr_owner(question)))) {
+			ldns_async_q_free(q);
+			return LDNS_STATUS_MEM_ERR;
+		}
+	}
+	/* Every try goes to the next nameserver */
+	q->tries = count * (ldns_resolver_retry(a->r) ?
+	                    ldns_resolver_retry(a->r) : 1) - 1;
+	start = ldns_resolver_random(a->r) ? ldns_get_random() % count : 0;
+
+	if (!ldns_async_next_ns(a, q, start)) {
+		ldns_async_q_free(q);
+		return LDNS_STATUS_RES_NO_NS;
+	}
+	if ((status = ldns_async_pick(a, q)) != LDNS_STATUS_OK) {
+		ldns_async_q_free(q);
+		return status;
+	}
+	a->count++;
+	ldns_async_send_try(a, q);
+	return LDNS_STATUS_OK;
+}
+
+ldns_status
+ldns_async_query(ldns_async *a, const ldns_rdf *name,
+		ldns_rr_type t, ldns_rr_class c, uint16_t flags,
+		ldns_async_cb cb, void *arg)
+{
+	ldns_pkt *query;
+	ldns_status status;
+
+	if (!a || !name) {
+		return LDNS_STATUS_NULL;
+	}
+	if (ldns_rdf_get_type(name) != LDNS_RDF_TYPE_DNAME) {
+		return LDNS_STATUS_RES_QUERY;
+	}
+	if (0 == t) {
+		t = LDNS_RR_TYPE_A;
+	}
+	if (0 == c) {
+		c = LDNS_RR_CLASS_IN;
+	}
+	status = ldns_resolver_prepare_query_pkt(&query, a->r, name,
+			t, c, flags);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	status = ldns_async_send_pkt(a, query, cb, arg);
+	ldns_pkt_free(query);
+	return status;
+}
+
+size_t
+ldns_async_outstanding(const ldns_async *a)
+{
+	return a ? a->count : 0;
+}
+
+size_t
+ldns_async_fds(const ldns_async *a, int *fds, size_t max)
+{
+#ifdef USE_EPOLL
+	if (max > 0) {
+		fds[0] = a->epfd;
+	}
+	return 1;
+#else
+	size_t i, n = 0;
+
+	for (i = 0; i < 2 * a->n; i++) {
+		if (a->sockets[i].fd != -1) {
+			if (n < max) {
+				fds[n] = a->sockets[i].fd;
+			}
+			n++;
+		}
+	}
+	return n;
+#endif
+}
+
+int
+ldns_async_timeout(const ldns_async *a)
+{
+	uint64_t now, due, t;
+	size_t i;
+
+	if (!a || !a->count) {
+		return -1;
+	}
+	for (i = 0, t = a->tick + 1; i < LDNS_ASYNC_SLOTS; i++, t++) {
+		if (a->wheel[t % LDNS_ASYNC_SLOTS]) {
+			break;
+		}
+	}
+	/* A slot is handled once its tick has fully passed */
+	due = (t + 1) * LDNS_ASYNC_TICK;
+	now = ldns_async_now(NULL);
+	if (due <= now) {
+		return 0;
+	}
+	return due - now > INT_MAX ? INT_MAX : (int)(due - now);
+}
+
+ldns_status
+ldns_async_process(ldns_async *a)
+{
+	if (!a) {
+		return LDNS_STATUS_NULL;
+	}
+	return ldns_async_wait(a, 0);
+}
+
+ldns_status
+ldns_async_run(ldns_async *a)
+{
+	ldns_status status;
+
+	if (!a) {
+		return LDNS_STATUS_NULL;
+	}
+	while (a->count > 0) {
+		status = ldns_async_wait(a, ldns_async_timeout(a));
+		if (status != LDNS_STATUS_OK) {
+			return status;
+		}
+	}
+	return LDNS_STATUS_OK;
+}
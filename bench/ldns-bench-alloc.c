@@ -0,0 +1,296 @@
+/*
+ * ldns-bench-alloc counts the memory allocations that reading, writing,
+ * sorting, signing and verifying take per operation, and how long they
+ * take, to see what the buffers that are used again save.
+ *
+ * The allocations are counted by wrapping malloc() and friends, which is
+ * only done with the GNU C library.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+#include <ldns/ldns.h>
+
+static size_t allocs = 0;
+
+#if defined(__GLIBC__)
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *
+malloc(size_t size)
+{
+	allocs++;
+	return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+	allocs++;
+	return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+	allocs++;
+	return __libc_realloc(ptr, size);
+}
+#endif
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  counts allocations per operation\n");
+	fprintf(fp, "-n <number>\tnumber of operations (default 20000)\n");
+}
+
+static void
+fail(const char *what)
+{
+	fprintf(stderr, "%s\n", what);
+	exit(EXIT_FAILURE);
+}
+
+static ldns_rr *
+rr_frm_str(const char *str)
+{
+	ldns_rr *rr;
+
+	if (ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL) != LDNS_STATUS_OK) {
+		fail(str);
+	}
+	return rr;
+}
+
+/* The time and the allocations of n operations */
+struct measure {
+	double t;
+	size_t allocs;
+};
+
+static void
+start(struct measure *m)
+{
+	m->allocs = allocs;
+	m->t = now();
+}
+
+static void
+report(const char *what, size_t n, struct measure *m)
+{
+	m->t = now() - m->t;
+	m->allocs = allocs - m->allocs;
+#if defined(__GLIBC__)
+	printf("%-24s %8.1f allocations %10.0f /s\n", what,
+		(double)m->allocs / (double)n, (double)n / m->t);
+#else
+	printf("%-24s      not counted %10.0f /s\n", what, (double)n / m->t);
+#endif
+}
+
+/* A zone apex with its MX RRset, and the answer a server gives for it */
+static ldns_rr_list *
+make_rrset(void)
+{
+	ldns_rr_list *rrset = ldns_rr_list_new();
+	char str[80];
+	unsigned i;
+
+	for (i = 0; i < 10; i++) {
+		snprintf(str, sizeof(str), "example.com. 3600 IN MX %u "
+			"mx%u.example.com.", 10 * ((i * 7) % 10), i);
+		ldns_rr_list_push_rr(rrset, rr_frm_str(str));
+	}
+	return rrset;
+}
+
+static ldns_pkt *
+make_answer(const ldns_rr_list *rrset)
+{
+	ldns_pkt *pkt;
+
+	pkt = ldns_pkt_query_new(ldns_dname_new_frm_str("example.com."),
+			LDNS_RR_TYPE_MX, LDNS_RR_CLASS_IN, LDNS_QR | LDNS_RD);
+	(void) ldns_pkt_push_rr_list(pkt, LDNS_SECTION_ANSWER,
+			ldns_rr_list_clone(rrset));
+	(void) ldns_pkt_push_rr(pkt, LDNS_SECTION_AUTHORITY,
+			rr_frm_str("example.com. 3600 IN NS ns.example.com."));
+	(void) ldns_pkt_push_rr(pkt, LDNS_SECTION_ADDITIONAL,
+			rr_frm_str("ns.example.com. 3600 IN A 192.0.2.53"));
+	return pkt;
+}
+
+static ldns_key *
+make_key(ldns_key_list *keys, ldns_rr_list *dnskeys)
+{
+	ldns_key *key = ldns_key_new_frm_algorithm(LDNS_SIGN_ECDSAP256SHA256, 0);
+	ldns_rr *rr;
+
+	if (!key) {
+		fail("can not make a key");
+	}
+	ldns_key_set_pubkey_owner(key, ldns_dname_new_frm_str("example.com."));
+	ldns_key_set_flags(key, LDNS_KEY_ZONE_KEY);
+	if (!(rr = ldns_key2rr(key))) {
+		fail("can not convert the key");
+	}
+	ldns_key_set_keytag(key, ldns_calc_keytag(rr));
+	ldns_key_list_push_key(keys, key);
+	ldns_rr_list_push_rr(dnskeys, rr);
+	return key;
+}
+
+int
+main(int argc, char *argv[])
+{
+	ldns_rr_list *rrset, *shuffled, *sigs, *dnskeys, *good;
+	ldns_key_list *keys;
+	struct measure m;
+	ldns_pkt *pkt, *p;
+	uint8_t *wire, *w;
+	size_t n = 20000, i, k, len, l;
+	char *str;
+	int c, fds[2];
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	rrset = make_rrset();
+	pkt = make_answer(rrset);
+	if (ldns_pkt2wire(&wire, pkt, &len) != LDNS_STATUS_OK) {
+		fail("can not make the answer");
+	}
+
+	start(&m);
+	for (i = 0; i < n; i++) {
+		if (ldns_wire2pkt(&p, wire, len) != LDNS_STATUS_OK) {
+			fail("can not read the answer");
+		}
+		ldns_pkt_free(p);
+	}
+	report("ldns_wire2pkt", n, &m);
+
+	if (socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) != 0) {
+		fail("can not make a socket pair");
+	}
+	start(&m);
+	for (i = 0; i < n; i++) {
+		if (send(fds[0], (void *)wire, len, 0) != (ssize_t)len
+		||  !(w = ldns_udp_read_wire(fds[1], &l, NULL, NULL))) {
+			fail("can not receive the answer");
+		}
+		LDNS_FREE(w);
+	}
+	report("ldns_udp_read_wire", n, &m);
+	close(fds[0]);
+	close(fds[1]);
+
+	start(&m);
+	for (i = 0; i < n; i++) {
+		if (ldns_pkt2wire(&w, pkt, &l) != LDNS_STATUS_OK) {
+			fail("can not write the answer");
+		}
+		LDNS_FREE(w);
+	}
+	report("ldns_pkt2wire", n, &m);
+
+	start(&m);
+	for (i = 0; i < n; i++) {
+		if (!(str = ldns_pkt2str(pkt))) {
+			fail("can not print the answer");
+		}
+		LDNS_FREE(str);
+	}
+	report("ldns_pkt2str", n, &m);
+
+	start(&m);
+	for (i = 0; i < n; i++) {
+		for (k = 0; k < ldns_rr_list_rr_count(rrset); k++) {
+			if (!(str = ldns_rr2str(ldns_rr_list_rr(rrset, k)))) {
+				fail("can not print an RR");
+			}
+			LDNS_FREE(str);
+		}
+	}
+	report("ldns_rr2str (RRset)", n, &m);
+
+	shuffled = ldns_rr_list_new();
+	for (k = 0; k < ldns_rr_list_rr_count(rrset); k++) {
+		ldns_rr_list_push_rr(shuffled, ldns_rr_list_rr(rrset, k));
+	}
+	start(&m);
+	for (i = 0; i < n; i++) {
+		for (k = 0; k < ldns_rr_list_rr_count(shuffled); k++) {
+			shuffled->_rrs[k] = ldns_rr_list_rr(rrset,
+				(k * 3 + i) % ldns_rr_list_rr_count(rrset));
+		}
+		ldns_rr_list_sort(shuffled);
+	}
+	report("ldns_rr_list_sort", n, &m);
+	ldns_rr_list_free(shuffled);
+
+	keys = ldns_key_list_new();
+	dnskeys = ldns_rr_list_new();
+	(void) make_key(keys, dnskeys);
+	sigs = NULL;
+	start(&m);
+	for (i = 0; i < n / 4; i++) {
+		ldns_rr_list_deep_free(sigs);
+		if (!(sigs = ldns_sign_public(rrset, keys))) {
+			fail("can not sign the RRset");
+		}
+	}
+	report("ldns_sign_public", n / 4, &m);
+
+	good = ldns_rr_list_new();
+	start(&m);
+	for (i = 0; i < n / 4; i++) {
+		if (ldns_verify_rrsig_keylist_notime(rrset,
+				ldns_rr_list_rr(sigs, 0), dnskeys, good)
+				!= LDNS_STATUS_OK) {
+			fail("can not verify the RRset");
+		}
+		ldns_rr_list_set_rr_count(good, 0);
+	}
+	report("ldns_verify_rrsig", n / 4, &m);
+
+	ldns_rr_list_free(good);
+	ldns_rr_list_deep_free(sigs);
+	ldns_rr_list_deep_free(dnskeys);
+	ldns_key_list_free(keys);
+	ldns_rr_list_deep_free(rrset);
+	ldns_pkt_free(pkt);
+	LDNS_FREE(wire);
+	return EXIT_SUCCESS;
+}
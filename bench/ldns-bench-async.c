@@ -0,0 +1,266 @@
+/*
+ * ldns-bench-async measures how many queries per second are answered
+ * with the non-blocking query engine and with ldns_send_bulk(), compared
+ * to sending them one by one with ldns_resolver_send(), over UDP and TCP.  Run it against
+ * a local ldns-testns:
+ *
+ *   examples/ldns-testns -p 53535 bench/ldns-bench-async.testns &
+ *   bench/ldns-bench-async -p 53535
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures queries per second to a local ldns-testns\n");
+	fprintf(fp, "-s <address>\tnameserver address (default 127.0.0.1)\n");
+	fprintf(fp, "-p <port>\tnameserver port (default 53535)\n");
+	fprintf(fp, "-n <number>\tnumber of queries (default 100000)\n");
+	fprintf(fp, "-c <number>\tqueries in flight (default 1000)\n");
+	fprintf(fp, "-b <number>\tnumber of blocking queries (default 2000)\n");
+}
+
+struct bench {
+	ldns_async *a;
+	size_t sent;
+	size_t total;
+	size_t answered;
+	size_t failed;
+};
+
+static void send_next(struct bench *b);
+
+static void
+answered(ldns_status status, ldns_pkt *answer, void *arg)
+{
+	struct bench *b = arg;
+
+	if (status == LDNS_STATUS_OK) {
+		b->answered++;
+		ldns_pkt_free(answer);
+	} else {
+		b->failed++;
+	}
+	send_next(b);
+}
+
+static void
+send_next(struct bench *b)
+{
+	char str[64];
+	ldns_rdf *name;
+
+	if (b->sent >= b->total) {
+		return;
+	}
+	snprintf(str, sizeof(str), "q%u.bench.example.", (unsigned)b->sent++);
+	name = ldns_dname_new_frm_str(str);
+	if (!name || ldns_async_query(b->a, name, LDNS_RR_TYPE_A,
+			LDNS_RR_CLASS_IN, LDNS_RD, answered, b)
+			!= LDNS_STATUS_OK) {
+		b->failed++;
+	}
+	ldns_rdf_deep_free(name);
+}
+
+static size_t
+send_blocking(ldns_resolver *r, size_t blocking)
+{
+	ldns_rdf *name;
+	ldns_pkt *answer;
+	size_t i, failed = 0;
+	char str[64];
+
+	for (i = 0; i < blocking; i++) {
+		snprintf(str, sizeof(str), "b%u.bench.example.", (unsigned)i);
+		name = ldns_dname_new_frm_str(str);
+		answer = NULL;
+		if (!name || ldns_resolver_send(&answer, r, name,
+				LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD)
+				!= LDNS_STATUS_OK) {
+			failed++;
+		}
+		ldns_pkt_free(answer);
+		ldns_rdf_deep_free(name);
+	}
+	return failed;
+}
+
+static size_t
+send_bulk(ldns_resolver *r, size_t n)
+{
+	ldns_pkt **queries, **answers;
+	ldns_rdf *name;
+	size_t i, failed = 0;
+	char str[64];
+
+	queries = LDNS_CALLOC(ldns_pkt *, n);
+	answers = LDNS_XMALLOC(ldns_pkt *, n);
+	if (!queries || !answers) {
+		fprintf(stderr, "Memory error\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < n; i++) {
+		snprintf(str, sizeof(str), "q%u.bench.example.", (unsigned)i);
+		name = ldns_dname_new_frm_str(str);
+		if (!name || ldns_resolver_prepare_query_pkt(&queries[i], r,
+				name, LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD)
+				!= LDNS_STATUS_OK) {
+			fprintf(stderr, "Could not make query %s\n", str);
+			exit(EXIT_FAILURE);
+		}
+		ldns_rdf_deep_free(name);
+	}
+	(void) ldns_send_bulk(answers, r, queries, n);
+	for (i = 0; i < n; i++) {
+		if (!answers[i]) {
+			failed++;
+		}
+		ldns_pkt_free(answers[i]);
+		ldns_pkt_free(queries[i]);
+	}
+	LDNS_FREE(queries);
+	LDNS_FREE(answers);
+	return failed;
+}
+
+static void
+report(const char *what, size_t queries, size_t failed, double secs)
+{
+	if (secs <= 0) {
+		secs = 0.000001;
+	}
+	printf("%-30s %8u queries %6u failed %8.3f s %10.0f q/s\n", what,
+	       (unsigned)queries, (unsigned)failed, secs,
+	       (double)(queries - failed) / secs);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const char *server = "127.0.0.1";
+	uint16_t port = 53535;
+	size_t n = 100000, in_flight = 1000, blocking = 2000, i, failed;
+	ldns_resolver *r;
+	ldns_rdf *ns;
+	struct timeval timeout;
+	struct bench b;
+	char str[64];
+	double start;
+	int c;
+
+	while ((c = getopt(argc, argv, "s:p:n:c:b:h")) != -1) {
+		switch (c) {
+		case 's':
+			server = optarg;
+			break;
+		case 'p':
+			port = (uint16_t)atoi(optarg);
+			break;
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'c':
+			in_flight = (size_t)atoi(optarg);
+			break;
+		case 'b':
+			blocking = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (!(r = ldns_resolver_new())) {
+		fprintf(stderr, "Memory error\n");
+		exit(EXIT_FAILURE);
+	}
+	if (!(ns = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_A, server))
+	&&  !(ns = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_AAAA, server))) {
+		fprintf(stderr, "Could not parse address %s\n", server);
+		exit(EXIT_FAILURE);
+	}
+	(void) ldns_resolver_push_nameserver(r, ns);
+	ldns_rdf_deep_free(ns);
+	ldns_resolver_set_port(r, port);
+	ldns_resolver_set_retry(r, 3);
+	timeout.tv_sec = 1;
+	timeout.tv_usec = 0;
+	ldns_resolver_set_timeout(r, timeout);
+
+	start = now();
+	failed = send_blocking(r, blocking);
+	report("ldns_resolver_send", blocking, failed, now() - start);
+
+	ldns_resolver_set_udp_pool(r, ldns_udp_pool_new(0));
+	start = now();
+	failed = send_blocking(r, blocking);
+	report("ldns_resolver_send (pool)", blocking, failed, now() - start);
+	ldns_resolver_set_udp_pool(r, NULL);
+
+	start = now();
+	failed = send_bulk(r, n);
+	report("ldns_send_bulk", n, failed, now() - start);
+
+	ldns_resolver_set_usevc(r, true);
+	start = now();
+	failed = send_blocking(r, blocking);
+	report("ldns_resolver_send tcp", blocking, failed, now() - start);
+
+	ldns_resolver_set_tcp_pool(r, ldns_tcp_pool_new());
+	start = now();
+	failed = send_blocking(r, blocking);
+	report("ldns_resolver_send tcp (pool)", blocking, failed,
+	       now() - start);
+
+	start = now();
+	failed = send_bulk(r, n);
+	report("ldns_send_bulk tcp", n, failed, now() - start);
+	ldns_resolver_set_tcp_pool(r, NULL);
+	ldns_resolver_set_usevc(r, false);
+
+	memset(&b, 0, sizeof(b));
+	if (!(b.a = ldns_async_new(r, 0))) {
+		fprintf(stderr, "Could not create query engine\n");
+		exit(EXIT_FAILURE);
+	}
+	b.total = n;
+	start = now();
+	for (i = 0; i < in_flight; i++) {
+		send_next(&b);
+	}
+	if (ldns_async_run(b.a) != LDNS_STATUS_OK) {
+		fprintf(stderr, "Error running query engine\n");
+		exit(EXIT_FAILURE);
+	}
+	snprintf(str, sizeof(str), "ldns_async (%u in flight)",
+	         (unsigned)in_flight);
+	report(str, n, b.failed, now() - start);
+
+	ldns_async_free(b.a);
+	ldns_resolver_deep_free(r);
+	return EXIT_SUCCESS;
+}
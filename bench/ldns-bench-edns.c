@@ -0,0 +1,188 @@
+/*
+ * ldns-bench-edns measures looking up one EDNS option in a decoded packet
+ * with ldns_pkt_edns_option_find(), which does not make the list of
+ * options, compared to ldns_pkt_edns_get_option_list(), and writing the
+ * options in place compared to through an intermediate buffer.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures EDNS option lookup and writing\n");
+	fprintf(fp, "-n <number>\tnumber of lookups (default 1000000)\n");
+}
+
+static void
+report(const char *what, size_t n, double t, double base)
+{
+	printf("%-36s %10.0f /s", what, (double)n / t);
+	if (base > 0) {
+		printf(" (%.2fx)", base / t);
+	}
+	printf("\n");
+}
+
+/* A query as a client sends it, with a client subnet, a cookie and
+ * padding */
+static ldns_pkt *
+make_query(void)
+{
+	uint8_t ecs[] = { 0, 1, 24, 0, 192, 0, 2 };
+	uint8_t cookie[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	uint8_t padding[64];
+	ldns_edns_option_list *list;
+	ldns_pkt *pkt;
+
+	memset(padding, 0, sizeof(padding));
+	pkt = ldns_pkt_query_new(ldns_dname_new_frm_str("www.example.com."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	ldns_pkt_set_edns_udp_size(pkt, 1232);
+	list = ldns_edns_option_list_new();
+	ldns_edns_option_list_push(list, ldns_edns_new_from_data(
+			LDNS_EDNS_CLIENT_SUBNET, sizeof(ecs), ecs));
+	ldns_edns_option_list_push(list, ldns_edns_new_from_data(
+			LDNS_EDNS_COOKIE, sizeof(cookie), cookie));
+	ldns_edns_option_list_push(list, ldns_edns_new_from_data(
+			LDNS_EDNS_PADDING, sizeof(padding), padding));
+	ldns_pkt_set_edns_option_list(pkt, list);
+	return pkt;
+}
+
+int
+main(int argc, char *argv[])
+{
+	size_t n = 1000000, i, k, found = 0;
+	ldns_edns_option_list *list;
+	ldns_edns_option option;
+	ldns_buffer *buf, *opts;
+	ldns_pkt *pkt, *query;
+	uint8_t *wire;
+	size_t wire_len;
+	double t, t_base;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	query = make_query();
+	if (ldns_pkt2wire(&wire, query, &wire_len) != LDNS_STATUS_OK
+	||  ldns_wire2pkt(&pkt, wire, wire_len) != LDNS_STATUS_OK) {
+		fprintf(stderr, "can not make the query\n");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("the cookie of a decoded query\n");
+	t = now();
+	for (i = 0; i < n; i++) {
+		list = ldns_pkt_edns_get_option_list(pkt);
+		for (k = 0; k < ldns_edns_option_list_get_count(list); k++) {
+			if (ldns_edns_get_code(ldns_edns_option_list_get_option(
+					list, k)) == LDNS_EDNS_COOKIE) {
+				found++;
+				break;
+			}
+		}
+		/* as for a packet that was just decoded */
+		ldns_pkt_set_edns_option_list(pkt, NULL);
+	}
+	t_base = now() - t;
+	report("ldns_pkt_edns_get_option_list", n, t_base, 0);
+	t = now();
+	for (i = 0; i < n; i++) {
+		if (ldns_pkt_edns_option_find(pkt, LDNS_EDNS_COOKIE, &option)) {
+			found++;
+		}
+	}
+	report("ldns_pkt_edns_option_find", n, now() - t, t_base);
+	ldns_pkt_free(pkt);
+
+	printf("decoding the query and finding the cookie\n");
+	t = now();
+	for (i = 0; i < n / 4; i++) {
+		if (ldns_wire2pkt(&pkt, wire, wire_len) != LDNS_STATUS_OK) {
+			exit(EXIT_FAILURE);
+		}
+		list = ldns_pkt_edns_get_option_list(pkt);
+		for (k = 0; k < ldns_edns_option_list_get_count(list); k++) {
+			if (ldns_edns_get_code(ldns_edns_option_list_get_option(
+					list, k)) == LDNS_EDNS_COOKIE) {
+				found++;
+				break;
+			}
+		}
+		ldns_pkt_free(pkt);
+	}
+	t_base = now() - t;
+	report("with the list", n / 4, t_base, 0);
+	t = now();
+	for (i = 0; i < n / 4; i++) {
+		if (ldns_wire2pkt(&pkt, wire, wire_len) != LDNS_STATUS_OK) {
+			exit(EXIT_FAILURE);
+		}
+		if (ldns_pkt_edns_option_find(pkt, LDNS_EDNS_COOKIE, &option)) {
+			found++;
+		}
+		ldns_pkt_free(pkt);
+	}
+	report("with ldns_pkt_edns_option_find", n / 4, now() - t, t_base);
+	LDNS_FREE(wire);
+
+	printf("writing the options of the query\n");
+	list = ldns_pkt_edns_get_option_list(query);
+	buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	t = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(buf);
+		opts = ldns_edns_option_list2wireformat_buffer(list);
+		ldns_buffer_write(buf, ldns_buffer_begin(opts),
+				ldns_buffer_limit(opts));
+		ldns_buffer_free(opts);
+	}
+	t_base = now() - t;
+	report("through a buffer", n, t_base, 0);
+	t = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(buf);
+		(void) ldns_edns_option_list2buffer_wire(buf, list);
+	}
+	report("in place", n, now() - t, t_base);
+	ldns_buffer_free(buf);
+	ldns_pkt_free(query);
+
+	if (found != 2 * n + 2 * (n / 4)) {
+		fprintf(stderr, "the cookie was not always found\n");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
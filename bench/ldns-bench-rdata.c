@@ -0,0 +1,411 @@
+/*
+ * ldns-bench-rdata measures how fast the rdata of common RR types is
+ * decoded, encoded, put in canonical form and compared, with the codecs
+ * made by rr_codec.pl compared to going over the rdata field descriptors
+ * like ldns did before.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures conversion of rdata with and without codecs\n");
+	fprintf(fp, "-n <number>\tnumber of conversions per type (default 1000000)\n");
+}
+
+/* ldns_wire2rdf() as it was before the codecs */
+static ldns_status
+desc_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max, size_t *pos)
+{
+	size_t end;
+	size_t cur_rdf_length;
+	uint8_t rdf_index;
+	uint8_t *data;
+	uint16_t rd_length;
+	ldns_rdf *cur_rdf = NULL;
+	ldns_rdf_type cur_rdf_type;
+	const ldns_rr_descriptor *descriptor;
+	ldns_status status;
+
+	assert(rr != NULL);
+
+	descriptor = ldns_rr_descript(ldns_rr_get_type(rr));
+
+	if (*pos + 2 > max) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+
+	rd_length = ldns_read_uint16(&wire[*pos]);
+	*pos = *pos + 2;
+
+	if (*pos + rd_length > max) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+
+	end = *pos + (size_t) rd_length;
+
+	rdf_index = 0;
+	while (*pos < end &&
+			rdf_index < ldns_rr_descriptor_maximum(descriptor)) {
+
+		cur_rdf_length = 0;
+
+		cur_rdf_type = ldns_rr_descriptor_field_type(
+				descriptor, rdf_index);
+
+		/* handle special cases immediately, set length
+		   for fixed length rdata and do them below */
+		switch (cur_rdf_type) {
+		case LDNS_RDF_TYPE_DNAME:
+			status = ldns_wire2dname(&cur_rdf, wire, max, pos);
+			if (status != LDNS_STATUS_OK) {
+				return status;
+			}
+			break;
+		case LDNS_RDF_TYPE_CLASS:
+		case LDNS_RDF_TYPE_ALG:
+		case LDNS_RDF_TYPE_CERTIFICATE_USAGE:
+		case LDNS_RDF_TYPE_SELECTOR:
+		case LDNS_RDF_TYPE_MATCHING_TYPE:
+		case LDNS_RDF_TYPE_INT8:
+			cur_rdf_length = LDNS_RDF_SIZE_BYTE;
+			break;
+		case LDNS_RDF_TYPE_TYPE:
+		case LDNS_RDF_TYPE_INT16:
+		case LDNS_RDF_TYPE_CERT_ALG:
+			cur_rdf_length = LDNS_RDF_SIZE_WORD;
+			break;
+		case LDNS_RDF_TYPE_TIME:
+		case LDNS_RDF_TYPE_INT32:
+		case LDNS_RDF_TYPE_A:
+		case LDNS_RDF_TYPE_PERIOD:
+			cur_rdf_length = LDNS_RDF_SIZE_DOUBLEWORD;
+			break;
+		case LDNS_RDF_TYPE_TSIGTIME:
+		case LDNS_RDF_TYPE_EUI48:
+			cur_rdf_length = LDNS_RDF_SIZE_6BYTES;
+			break;
+		case LDNS_RDF_TYPE_ILNP64:
+		case LDNS_RDF_TYPE_EUI64:
+			cur_rdf_length = LDNS_RDF_SIZE_8BYTES;
+			break;
+		case LDNS_RDF_TYPE_AAAA:
+			cur_rdf_length = LDNS_RDF_SIZE_16BYTES;
+			break;
+		case LDNS_RDF_TYPE_STR:
+		case LDNS_RDF_TYPE_NSEC3_SALT:
+		case LDNS_RDF_TYPE_TAG:
+			/* len is stored in first byte
+			 * it should be in the rdf too, so just
+			 * copy len+1 from this position
+			 */
+			cur_rdf_length = ((size_t) wire[*pos]) + 1;
+			break;
+
+		case LDNS_RDF_TYPE_INT16_DATA:
+			if (*pos + 2 > end) {
+				return LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			cur_rdf_length =
+				(size_t) ldns_read_uint16(&wire[*pos]) + 2;
+			break;
+		case LDNS_RDF_TYPE_HIP:
+			if (*pos + 4 > end) {
+				return LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			cur_rdf_length =
+				(size_t) wire[*pos] +
+				(size_t) ldns_read_uint16(&wire[*pos + 2]) + 4;
+			break;
+		case LDNS_RDF_TYPE_B32_EXT:
+		case LDNS_RDF_TYPE_NSEC3_NEXT_OWNER:
+			/* length is stored in first byte */
+			cur_rdf_length = ((size_t) wire[*pos]) + 1;
+			break;
+		case LDNS_RDF_TYPE_APL:
+		case LDNS_RDF_TYPE_B64:
+		case LDNS_RDF_TYPE_HEX:
+		case LDNS_RDF_TYPE_NSEC:
+		case LDNS_RDF_TYPE_UNKNOWN:
+		case LDNS_RDF_TYPE_SERVICE:
+		case LDNS_RDF_TYPE_LOC:
+		case LDNS_RDF_TYPE_WKS:
+		case LDNS_RDF_TYPE_NSAP:
+		case LDNS_RDF_TYPE_ATMA:
+		case LDNS_RDF_TYPE_IPSECKEY:
+		case LDNS_RDF_TYPE_LONG_STR:
+		case LDNS_RDF_TYPE_AMTRELAY:
+		case LDNS_RDF_TYPE_SVCPARAMS:
+		case LDNS_RDF_TYPE_NONE:
+			/*
+			 * Read to end of rr rdata
+			 */
+			cur_rdf_length = end - *pos;
+			break;
+		}
+
+		/* fixed length rdata */
+		if (cur_rdf_length > 0) {
+			if (cur_rdf_length + *pos > end) {
+				return LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			data = LDNS_XMALLOC(uint8_t, rd_length);
+			if (!data) {
+				return LDNS_STATUS_MEM_ERR;
+			}
+			memcpy(data, &wire[*pos], cur_rdf_length);
+
+			cur_rdf = ldns_rdf_new(cur_rdf_type,
+					cur_rdf_length, data);
+			*pos = *pos + cur_rdf_length;
+		}
+
+		if (cur_rdf) {
+			ldns_rr_push_rdf(rr, cur_rdf);
+			cur_rdf = NULL;
+		}
+
+		rdf_index++;
+
+	} /* while (rdf_index < ldns_rr_descriptor_maximum(descriptor)) */
+
+
+	return LDNS_STATUS_OK;
+}
+
+/* ldns_rr2buffer_wire_canonical() as it was before the codecs, for the
+ * types measured here */
+static void
+desc_rdata2canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	bool pre_rfc3597 = false;
+	size_t i;
+
+	switch (ldns_rr_get_type(rr)) {
+	case LDNS_RR_TYPE_NS:
+	case LDNS_RR_TYPE_MX:
+	case LDNS_RR_TYPE_RRSIG:
+		pre_rfc3597 = true;
+		break;
+	default:
+		break;
+	}
+	for (i = 0; i < ldns_rr_rd_count(rr); i++) {
+		if (pre_rfc3597) {
+			(void) ldns_rdf2buffer_wire_canonical(buffer,
+					ldns_rr_rdf(rr, i));
+		} else {
+			(void) ldns_rdf2buffer_wire(buffer, ldns_rr_rdf(rr, i));
+		}
+	}
+}
+
+/* ldns_rr2buffer_wire_canonical() as it was before the codecs */
+static void
+desc_rr2canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	size_t rdl_pos;
+
+	(void) ldns_rdf2buffer_wire_canonical(buffer, ldns_rr_owner(rr));
+	ldns_buffer_write_u16(buffer, ldns_rr_get_type(rr));
+	ldns_buffer_write_u16(buffer, ldns_rr_get_class(rr));
+	ldns_buffer_write_u32(buffer, ldns_rr_ttl(rr));
+	rdl_pos = ldns_buffer_position(buffer);
+	ldns_buffer_write_u16(buffer, 0);
+	desc_rdata2canonical(buffer, rr);
+	ldns_buffer_write_u16_at(buffer, rdl_pos,
+			ldns_buffer_position(buffer) - rdl_pos - 2);
+}
+
+/* ldns_rr_compare() as it was before the codecs */
+static int
+desc_compare(const ldns_rr *rr1, const ldns_rr *rr2)
+{
+	ldns_buffer *buf1, *buf2;
+	int result = ldns_rr_compare_no_rdata(rr1, rr2);
+
+	if (result != 0) {
+		return result;
+	}
+	buf1 = ldns_buffer_new(ldns_rr_uncompressed_size(rr1));
+	buf2 = ldns_buffer_new(ldns_rr_uncompressed_size(rr2));
+	(void) ldns_rdf2buffer_wire_canonical(buf1, ldns_rr_owner(rr1));
+	(void) ldns_rdf2buffer_wire_canonical(buf2, ldns_rr_owner(rr2));
+	ldns_buffer_write(buf1, "\0\0\0\0\0\0\0\0\0\0", 10);
+	ldns_buffer_write(buf2, "\0\0\0\0\0\0\0\0\0\0", 10);
+	desc_rdata2canonical(buf1, rr1);
+	desc_rdata2canonical(buf2, rr2);
+	result = ldns_rr_compare_wire(buf1, buf2);
+	ldns_buffer_free(buf1);
+	ldns_buffer_free(buf2);
+	return result;
+}
+
+static void
+report(const char *what, size_t n, double desc, double codec)
+{
+	if (desc <= 0) {
+		desc = 0.000001;
+	}
+	if (codec <= 0) {
+		codec = 0.000001;
+	}
+	printf("  %-9s descriptors %9.0f/s  codec %9.0f/s  %5.2fx\n", what,
+	       (double)n / desc, (double)n / codec, desc / codec);
+}
+
+static void
+bench(const char *str, size_t n)
+{
+	ldns_buffer *buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *desc_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_rr *rr, *other, *decoded;
+	uint8_t *wire;
+	size_t wire_len, rdata, pos, i;
+	double start, desc, codec;
+	int r1 = 0, r2 = 0;
+
+	if (ldns_rr_new_frm_str(&rr, str, 3600, NULL, NULL)
+			!= LDNS_STATUS_OK
+	||  ldns_rr2wire(&wire, rr, LDNS_SECTION_ANSWER, &wire_len)
+			!= LDNS_STATUS_OK) {
+		fprintf(stderr, "Could not parse %s\n", str);
+		exit(EXIT_FAILURE);
+	}
+	other = ldns_rr_clone(rr);
+	rdata = ldns_rdf_size(ldns_rr_owner(rr)) + 8;
+	printf("%s: %u bytes of rdata\n", str,
+	       (unsigned)(wire_len - rdata - 2));
+
+	start = now();
+	for (i = 0; i < n; i++) {
+		decoded = ldns_rr_new();
+		ldns_rr_set_type(decoded, ldns_rr_get_type(rr));
+		pos = rdata;
+		(void) desc_wire2rdf(decoded, wire, wire_len, &pos);
+		ldns_rr_free(decoded);
+	}
+	desc = now() - start;
+	start = now();
+	for (i = 0; i < n; i++) {
+		decoded = ldns_rr_new();
+		ldns_rr_set_type(decoded, ldns_rr_get_type(rr));
+		pos = rdata;
+		(void) ldns_wire2rdf(decoded, wire, wire_len, &pos);
+		ldns_rr_free(decoded);
+	}
+	codec = now() - start;
+	report("decode", n, desc, codec);
+
+	start = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(desc_buf);
+		for (pos = 0; pos < ldns_rr_rd_count(rr); pos++) {
+			(void) ldns_rdf2buffer_wire(desc_buf,
+					ldns_rr_rdf(rr, pos));
+		}
+	}
+	desc = now() - start;
+	start = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(buf);
+		(void) ldns_rr_rdata2buffer_wire(buf, rr);
+	}
+	codec = now() - start;
+	report("encode", n, desc, codec);
+
+	start = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(desc_buf);
+		desc_rr2canonical(desc_buf, rr);
+	}
+	desc = now() - start;
+	start = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(buf);
+		(void) ldns_rr2buffer_wire_canonical(buf, rr,
+				LDNS_SECTION_ANSWER);
+	}
+	codec = now() - start;
+	report("canonical", n, desc, codec);
+
+	start = now();
+	for (i = 0; i < n; i++) {
+		r1 += desc_compare(rr, other);
+	}
+	desc = now() - start;
+	start = now();
+	for (i = 0; i < n; i++) {
+		r2 += ldns_rr_compare(rr, other);
+	}
+	codec = now() - start;
+	report("compare", n, desc, codec);
+
+	if (r1 != r2) {
+		fprintf(stderr, "%s: compare differs\n", str);
+		exit(EXIT_FAILURE);
+	}
+	LDNS_FREE(wire);
+	ldns_rr_free(rr);
+	ldns_rr_free(other);
+	ldns_buffer_free(buf);
+	ldns_buffer_free(desc_buf);
+}
+
+int
+main(int argc, char *argv[])
+{
+	size_t n = 1000000;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	bench("www.example.com. A 192.0.2.1", n);
+	bench("www.example.com. AAAA 2001:db8::1", n);
+	bench("example.com. NS ns1.Example.com.", n);
+	bench("example.com. MX 10 mail.Example.com.", n);
+	bench("example.com. DS 60485 5 2 "
+	      "D4B7D520E7BB5F0F67674A0CCEB1E3E0614B93C4F9E99B8383F6A1E4469DA50A",
+	      n);
+	bench("example.com. RRSIG A 8 2 3600 20240201000000 20240101000000 "
+	      "12345 example.com. "
+	      "BwgJCgsMDQ4PEBESExQVFhcYGRobHB0eHyAhIiMkJSYnKCkqKywtLi8wMTIzNDU2"
+	      "Nzg5Ojs8PT4/QEFCQ0RFRkdISUpLTE1OT1BRUlNUVVZXWFlaW1xdXl9gYWJjZGVm"
+	      "Z2hpamtsbW5vcHFyc3R1dnd4eXp7fH1+f4CBgoOEhYaHiImKi4yNjo+QkZKTlJWW"
+	      "l5iZmpucnZ6foKGio6SlpqeoqaqrrK2ur7CxsrO0tba3uLm6u7y9vr/AwcLDxMXG",
+	      n);
+	bench("2vptu5timamqttgl4luu9kg21e0aor3s.example.com. NSEC3 1 0 10 "
+	      "AABBCCDD 2VQ6VOBNOBVG9Q2T1K9RB98VG8KE6A8R A RRSIG", n);
+	return EXIT_SUCCESS;
+}
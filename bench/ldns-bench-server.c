@@ -0,0 +1,427 @@
+/*
+ * ldns-bench-server measures how many queries per second a server answers
+ * per core, when it answers with ldns_query_info_from_wire() and a
+ * ldns_response, compared to making a ldns_pkt for each query and answer
+ * with ldns_wire2pkt() and ldns_pkt2wire(), like examples/ldnsd does.
+ *
+ * The queries are answered in memory, and by a server process over UDP on
+ * loopback.  The server answers per core are the answered queries divided
+ * by the CPU time the server process used.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include <ldns/ldns.h>
+
+#ifdef HAVE_SYS_SOCKET_H
+#  include <sys/socket.h>
+#endif
+#ifdef HAVE_ARPA_INET_H
+#  include <arpa/inet.h>
+#endif
+#ifdef HAVE_NETINET_IN_H
+#  include <netinet/in.h>
+#endif
+
+#define BATCH	32
+#define WINDOW	64
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+/* User and system CPU time */
+static double
+cpu_secs(const struct rusage *ru)
+{
+	return (double)ru->ru_utime.tv_sec + (double)ru->ru_utime.tv_usec / 1e6
+	     + (double)ru->ru_stime.tv_sec + (double)ru->ru_stime.tv_usec / 1e6;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures answering queries with and without ldns_pkt\n");
+	fprintf(fp, "-n <number>\tnumber of queries (default 200000)\n");
+}
+
+static void
+fail(const char *what)
+{
+	fprintf(stderr, "%s\n", what);
+	exit(EXIT_FAILURE);
+}
+
+/* The RRs served, as RR lists for the ldns_pkt path and in wire format
+ * for the fast path */
+struct zone {
+	ldns_rdf *qname;
+	ldns_rr_list *sections[4];
+	ldns_buffer *wire[4];
+};
+
+static void
+add_rr(struct zone *z, ldns_pkt_section section, const char *str)
+{
+	ldns_rr *rr;
+
+	if (ldns_rr_new_frm_str(&rr, str, 3600, NULL, NULL) != LDNS_STATUS_OK) {
+		fail("Could not parse RR");
+	}
+	if (ldns_rr2buffer_wire(z->wire[section], rr, section)
+			!= LDNS_STATUS_OK) {
+		fail("Could not convert RR");
+	}
+	ldns_rr_list_push_rr(z->sections[section], rr);
+}
+
+static void
+make_zone(struct zone *z)
+{
+	int s;
+
+	z->qname = ldns_dname_new_frm_str("www.example.com.");
+	for (s = LDNS_SECTION_ANSWER; s <= LDNS_SECTION_ADDITIONAL; s++) {
+		z->sections[s] = ldns_rr_list_new();
+		z->wire[s] = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	}
+	add_rr(z, LDNS_SECTION_ANSWER, "www.example.com. A 192.0.2.1");
+	add_rr(z, LDNS_SECTION_ANSWER, "www.example.com. A 192.0.2.2");
+	add_rr(z, LDNS_SECTION_AUTHORITY, "example.com. NS ns1.example.com.");
+	add_rr(z, LDNS_SECTION_AUTHORITY, "example.com. NS ns2.example.com.");
+	add_rr(z, LDNS_SECTION_ADDITIONAL, "ns1.example.com. A 192.0.2.53");
+	add_rr(z, LDNS_SECTION_ADDITIONAL, "ns2.example.com. A 198.51.100.53");
+}
+
+static void
+free_zone(struct zone *z)
+{
+	int s;
+
+	ldns_rdf_deep_free(z->qname);
+	for (s = LDNS_SECTION_ANSWER; s <= LDNS_SECTION_ADDITIONAL; s++) {
+		ldns_rr_list_deep_free(z->sections[s]);
+		ldns_buffer_free(z->wire[s]);
+	}
+}
+
+/* Answers with a ldns_pkt for the query and for the answer */
+static size_t
+answer_pkt(struct zone *z, const uint8_t *query, size_t len, uint8_t *out)
+{
+	ldns_pkt *q, *a;
+	ldns_rr *qrr;
+	uint8_t *wire = NULL;
+	size_t size = 0;
+	int s;
+
+	if (ldns_wire2pkt(&q, query, len) != LDNS_STATUS_OK) {
+		return 0;
+	}
+	qrr = ldns_rr_list_rr(ldns_pkt_question(q), 0);
+	if (!qrr || !(a = ldns_pkt_new())) {
+		ldns_pkt_free(q);
+		return 0;
+	}
+	ldns_pkt_set_id(a, ldns_pkt_id(q));
+	ldns_pkt_set_qr(a, true);
+	ldns_pkt_set_rd(a, ldns_pkt_rd(q));
+	ldns_pkt_push_rr(a, LDNS_SECTION_QUESTION, ldns_rr_clone(qrr));
+	if (ldns_dname_compare(ldns_rr_owner(qrr), z->qname) == 0
+	&&  ldns_rr_get_type(qrr) == LDNS_RR_TYPE_A) {
+		ldns_pkt_set_aa(a, true);
+		for (s = LDNS_SECTION_ANSWER; s <= LDNS_SECTION_ADDITIONAL; s++) {
+			ldns_rr_list *rrs = ldns_rr_list_clone(z->sections[s]);
+
+			ldns_pkt_push_rr_list(a, (ldns_pkt_section)s, rrs);
+			ldns_rr_list_free(rrs);
+		}
+	} else {
+		ldns_pkt_set_rcode(a, LDNS_RCODE_REFUSED);
+	}
+	if (ldns_pkt_edns(q)) {
+		ldns_pkt_set_edns_udp_size(a, LDNS_RESPONSE_EDNS_UDP_SIZE);
+		ldns_pkt_set_edns_do(a, ldns_pkt_edns_do(q));
+	}
+	if (ldns_pkt2wire(&wire, a, &size) == LDNS_STATUS_OK
+	&&  size <= LDNS_MAX_PACKETLEN) {
+		memcpy(out, wire, size);
+	} else {
+		size = 0;
+	}
+	LDNS_FREE(wire);
+	ldns_pkt_free(q);
+	ldns_pkt_free(a);
+	return size;
+}
+
+/* Answers with ldns_query_info_from_wire() and a ldns_response */
+static size_t
+answer_fast(struct zone *z, const uint8_t *query, size_t len,
+		ldns_buffer *out)
+{
+	ldns_query_info qi;
+	ldns_response resp;
+	int s;
+
+	if (ldns_query_info_from_wire(&qi, query, len) != LDNS_STATUS_OK
+	||  ldns_response_init(&resp, out, &qi, ldns_query_info_max_udp(&qi))
+			!= LDNS_STATUS_OK) {
+		return 0;
+	}
+	if (qi.qname_size == ldns_rdf_size(z->qname)
+	&&  strncasecmp((const char *)qi.qname,
+			(const char *)ldns_rdf_data(z->qname),
+			qi.qname_size) == 0
+	&&  qi.qtype == LDNS_RR_TYPE_A) {
+		ldns_response_set_flags(&resp, LDNS_AA);
+		for (s = LDNS_SECTION_ANSWER; s <= LDNS_SECTION_ADDITIONAL; s++) {
+			(void) ldns_response_add_wire(&resp, (ldns_pkt_section)s,
+					ldns_buffer_begin(z->wire[s]),
+					ldns_buffer_position(z->wire[s]),
+					(uint16_t)ldns_rr_list_rr_count(
+						z->sections[s]));
+		}
+	} else {
+		ldns_response_set_rcode(&resp, LDNS_RCODE_REFUSED);
+	}
+	if (ldns_response_finish(&resp) != LDNS_STATUS_OK) {
+		return 0;
+	}
+	return ldns_buffer_position(out);
+}
+
+static size_t
+answer(struct zone *z, bool fast, const uint8_t *query, size_t len,
+		ldns_buffer *out)
+{
+	if (fast) {
+		return answer_fast(z, query, len, out);
+	}
+	return answer_pkt(z, query, len, ldns_buffer_begin(out));
+}
+
+static uint8_t *
+make_query(size_t *len)
+{
+	ldns_pkt *q = ldns_pkt_query_new(
+			ldns_dname_new_frm_str("www.example.com."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	uint8_t *wire = NULL;
+
+	if (!q) {
+		fail("Memory error");
+	}
+	ldns_pkt_set_edns_udp_size(q, 1232);
+	if (ldns_pkt2wire(&wire, q, len) != LDNS_STATUS_OK) {
+		fail("Could not make query");
+	}
+	ldns_pkt_free(q);
+	return wire;
+}
+
+/* Whether both paths give the same answer.  The fast path does not
+ * compress names in the rdata of RRs in wire format, so the wire formats
+ * differ. */
+static bool
+same_answer(ldns_buffer *a, size_t a_size, ldns_buffer *b, size_t b_size)
+{
+	ldns_pkt *pa = NULL, *pb = NULL;
+	bool same = false;
+
+	if (ldns_wire2pkt(&pa, ldns_buffer_begin(a), a_size) == LDNS_STATUS_OK
+	&&  ldns_wire2pkt(&pb, ldns_buffer_begin(b), b_size) == LDNS_STATUS_OK
+	&&  memcmp(ldns_buffer_begin(a), ldns_buffer_begin(b),
+			LDNS_HEADER_SIZE) == 0) {
+		same = ldns_pkt_edns(pa) == ldns_pkt_edns(pb)
+		    && ldns_rr_list_compare(ldns_pkt_question(pa),
+				ldns_pkt_question(pb)) == 0
+		    && ldns_rr_list_compare(ldns_pkt_answer(pa),
+				ldns_pkt_answer(pb)) == 0
+		    && ldns_rr_list_compare(ldns_pkt_authority(pa),
+				ldns_pkt_authority(pb)) == 0
+		    && ldns_rr_list_compare(ldns_pkt_additional(pa),
+				ldns_pkt_additional(pb)) == 0;
+	}
+	ldns_pkt_free(pa);
+	ldns_pkt_free(pb);
+	return same;
+}
+
+static void
+bench_memory(struct zone *z, bool fast, size_t n)
+{
+	ldns_buffer *out = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *check = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	size_t len, i, size = 0;
+	uint8_t *query = make_query(&len);
+	double start, secs;
+
+	if (!out || !check) {
+		fail("Memory error");
+	}
+	start = now();
+	for (i = 0; i < n; i++) {
+		ldns_write_uint16(query, (uint16_t)i);
+		size = answer(z, fast, query, len, out);
+	}
+	secs = now() - start;
+	if (size == 0 || !same_answer(out, size, check,
+			answer(z, !fast, query, len, check))) {
+		fail("Answers differ");
+	}
+	if (secs <= 0) {
+		secs = 0.000001;
+	}
+	printf("in memory, %-8s %10.0f queries/s\n", fast ? "fast" : "ldns_pkt",
+	       (double)n / secs);
+	LDNS_FREE(query);
+	ldns_buffer_free(out);
+	ldns_buffer_free(check);
+}
+
+static void
+serve(int sock, struct zone *z, bool fast)
+{
+	ldns_udp_msg *in = ldns_udp_msgs_new(BATCH, LDNS_MAX_PACKETLEN);
+	ldns_udp_msg *out = ldns_udp_msgs_new(BATCH, LDNS_MAX_PACKETLEN);
+	ldns_buffer *buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ssize_t nb, i;
+	size_t nout;
+
+	if (!in || !out || !buf) {
+		fail("Memory error");
+	}
+	for (;;) {
+		if ((nb = ldns_udp_recv_batch(sock, in, BATCH)) < 1) {
+			continue;
+		}
+		nout = 0;
+		for (i = 0; i < nb; i++) {
+			out[nout].len = answer(z, fast, in[i].data, in[i].len,
+					buf);
+			if (out[nout].len == 0) {
+				continue;
+			}
+			memcpy(out[nout].data, ldns_buffer_begin(buf),
+					out[nout].len);
+			memcpy(&out[nout].addr, &in[i].addr, in[i].addrlen);
+			out[nout].addrlen = in[i].addrlen;
+			nout++;
+		}
+		(void) ldns_udp_send_batch(sock, out, nout);
+	}
+}
+
+static void
+bench_udp(struct zone *z, bool fast, size_t n)
+{
+	struct sockaddr_in addr;
+	socklen_t addrlen = (socklen_t) sizeof(addr);
+	struct timeval tv = { 0, 100000 };
+	struct rusage before, after;
+	int server, client, status;
+	uint8_t reply[LDNS_MAX_PACKETLEN];
+	size_t len, sent = 0, answered = 0, inflight = 0;
+	uint8_t *query = make_query(&len);
+	double start, secs, cpu;
+	pid_t pid;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if ((server = socket(AF_INET, SOCK_DGRAM, 0)) < 0
+	||  bind(server, (struct sockaddr *)&addr, addrlen) != 0
+	||  getsockname(server, (struct sockaddr *)&addr, &addrlen) != 0
+	||  (client = socket(AF_INET, SOCK_DGRAM, 0)) < 0
+	||  connect(client, (struct sockaddr *)&addr, addrlen) != 0
+	||  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv))) {
+		fail("Could not make sockets");
+	}
+	getrusage(RUSAGE_CHILDREN, &before);
+	if ((pid = fork()) < 0) {
+		fail("Could not fork");
+	} else if (pid == 0) {
+		close(client);
+		serve(server, z, fast);
+		exit(EXIT_SUCCESS);
+	}
+	close(server);
+
+	start = now();
+	while (sent < n || inflight > 0) {
+		while (sent < n && inflight < WINDOW) {
+			ldns_write_uint16(query, (uint16_t)sent);
+			if (send(client, query, len, 0) == (ssize_t)len) {
+				inflight++;
+			}
+			sent++;
+		}
+		if (recv(client, reply, sizeof(reply), 0) > 0) {
+			answered++;
+			inflight--;
+		} else {
+			/* Lost, send more */
+			inflight = 0;
+		}
+	}
+	secs = now() - start;
+	kill(pid, SIGTERM);
+	(void) waitpid(pid, &status, 0);
+	getrusage(RUSAGE_CHILDREN, &after);
+	cpu = cpu_secs(&after) - cpu_secs(&before);
+	close(client);
+	LDNS_FREE(query);
+	if (secs <= 0) {
+		secs = 0.000001;
+	}
+	printf("UDP loopback, %-8s %10.0f queries/s %10.0f queries/s per core"
+	       " (%u lost)\n", fast ? "fast" : "ldns_pkt", (double)answered / secs,
+	       (double)answered / (cpu > 0 ? cpu : 0.000001),
+	       (unsigned)(n - answered));
+}
+
+int
+main(int argc, char *argv[])
+{
+	size_t n = 200000;
+	struct zone z;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	make_zone(&z);
+	bench_memory(&z, false, n);
+	bench_memory(&z, true, n);
+	bench_udp(&z, false, n);
+	bench_udp(&z, true, n);
+	free_zone(&z);
+	return EXIT_SUCCESS;
+}
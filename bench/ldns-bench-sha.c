@@ -0,0 +1,131 @@
+/*
+ * ldns-bench-sha measures the throughput of the bundled SHA1 and
+ * SHA256 code, one message at a time and in batches.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+#define BATCH_SIZE 1024
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures SHA1 and SHA256 throughput\n");
+	fprintf(fp, "-l <length>\tmessage length in bytes (default 40, "
+	            "the size of a typical NSEC3 hash input)\n");
+	fprintf(fp, "-n <number>\tnumber of messages to hash (default 1000000)\n");
+}
+
+static void
+report(const char *what, size_t n, size_t len, double secs)
+{
+	if (secs <= 0) {
+		secs = 0.000001;
+	}
+	printf("%-24s %10.0f msg/s %10.1f MB/s %8.1f ns/msg\n", what,
+	       (double)n / secs, (double)n * (double)len / secs / 1000000.0,
+	       secs * 1000000000.0 / (double)n);
+}
+
+int
+main(int argc, char *argv[])
+{
+	size_t len = 40, n = 1000000, i, j;
+	unsigned char *data, *digests;
+	const unsigned char **ptrs;
+	size_t *lens;
+	double start;
+	int c;
+
+	while ((c = getopt(argc, argv, "l:n:h")) != -1) {
+		switch (c) {
+		case 'l':
+			len = (size_t)atoi(optarg);
+			break;
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	/* whole batches only */
+	n = n < BATCH_SIZE ? BATCH_SIZE : n - n % BATCH_SIZE;
+	data = LDNS_XMALLOC(unsigned char, BATCH_SIZE * (len + 1));
+	digests = LDNS_XMALLOC(unsigned char,
+			BATCH_SIZE * LDNS_SHA256_DIGEST_LENGTH);
+	ptrs = LDNS_XMALLOC(const unsigned char *, BATCH_SIZE);
+	lens = LDNS_XMALLOC(size_t, BATCH_SIZE);
+	if (!data || !digests || !ptrs || !lens) {
+		fprintf(stderr, "Memory error\n");
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < BATCH_SIZE * (len + 1); i++) {
+		data[i] = (unsigned char)ldns_get_random();
+	}
+	for (i = 0; i < BATCH_SIZE; i++) {
+		ptrs[i] = data + i * (len + 1);
+		lens[i] = len;
+	}
+	printf("%u byte messages, %u messages\n",
+	       (unsigned int)len, (unsigned int)n);
+
+	start = now();
+	for (i = 0; i < n; i += BATCH_SIZE) {
+		for (j = 0; j < BATCH_SIZE; j++) {
+			(void) ldns_sha1(ptrs[j], (unsigned int)len,
+			    digests + j * LDNS_SHA1_DIGEST_LENGTH);
+		}
+	}
+	report("ldns_sha1", n, len, now() - start);
+
+	start = now();
+	for (i = 0; i < n; i += BATCH_SIZE) {
+		ldns_sha1_many(BATCH_SIZE, ptrs, lens, digests);
+	}
+	report("ldns_sha1_many", n, len, now() - start);
+
+	start = now();
+	for (i = 0; i < n; i += BATCH_SIZE) {
+		for (j = 0; j < BATCH_SIZE; j++) {
+			(void) ldns_sha256(ptrs[j], (unsigned int)len,
+			    digests + j * LDNS_SHA256_DIGEST_LENGTH);
+		}
+	}
+	report("ldns_sha256", n, len, now() - start);
+
+	start = now();
+	for (i = 0; i < n; i += BATCH_SIZE) {
+		ldns_sha256_many(BATCH_SIZE, ptrs, lens, digests);
+	}
+	report("ldns_sha256_many", n, len, now() - start);
+
+	LDNS_FREE(data);
+	LDNS_FREE(digests);
+	LDNS_FREE(ptrs);
+	LDNS_FREE(lens);
+	return EXIT_SUCCESS;
+}
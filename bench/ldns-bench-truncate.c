@@ -0,0 +1,194 @@
+/*
+ * ldns-bench-truncate measures fitting a referral with much glue into the
+ * size a client takes, with a ldns_response that computes the size of each
+ * RRset before it is written, compared to encoding a ldns_pkt and taking
+ * RRsets out of it until it fits.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+#define NS_COUNT 13
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures fitting a referral in 512 and 1232 bytes\n");
+	fprintf(fp, "-n <number>\tnumber of referrals (default 200000)\n");
+}
+
+static ldns_rr *
+rr_frm_str(const char *str)
+{
+	ldns_rr *rr;
+
+	if (ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL) != LDNS_STATUS_OK) {
+		fprintf(stderr, "can not read %s\n", str);
+		exit(EXIT_FAILURE);
+	}
+	return rr;
+}
+
+/* A referral to example. with 13 name servers, each with an A and an
+ * AAAA RRset */
+static void
+make_referral(ldns_rr_list **ns, ldns_rr_list **glue)
+{
+	char str[128];
+	unsigned i;
+
+	*ns = ldns_rr_list_new();
+	for (i = 0; i < NS_COUNT; i++) {
+		snprintf(str, sizeof(str), "example. 172800 IN NS "
+			"%c.ns.example-servers.net.", 'a' + i);
+		ldns_rr_list_push_rr(*ns, rr_frm_str(str));
+		snprintf(str, sizeof(str), "%c.ns.example-servers.net. "
+			"172800 IN A 192.0.2.%u", 'a' + i, i + 1);
+		glue[2 * i] = ldns_rr_list_new();
+		ldns_rr_list_push_rr(glue[2 * i], rr_frm_str(str));
+		snprintf(str, sizeof(str), "%c.ns.example-servers.net. "
+			"172800 IN AAAA 2001:db8::%u", 'a' + i, i + 1);
+		glue[2 * i + 1] = ldns_rr_list_new();
+		ldns_rr_list_push_rr(glue[2 * i + 1], rr_frm_str(str));
+	}
+}
+
+/* Encodes the packet, and takes the last glue RRset out until it fits */
+static size_t
+fit_pkt(ldns_buffer *buf, ldns_pkt *pkt, size_t max)
+{
+	ldns_rr_list *additional = ldns_pkt_additional(pkt);
+	size_t removed = 0, n;
+
+	for (;;) {
+		ldns_buffer_clear(buf);
+		(void) ldns_pkt2buffer_wire(buf, pkt);
+		if (ldns_buffer_position(buf) <= max
+		||  ldns_rr_list_rr_count(additional) == 0) {
+			break;
+		}
+		n = ldns_rr_list_rr_count(additional) - 1;
+		ldns_rr_list_set_rr_count(additional, n);
+		ldns_pkt_set_arcount(pkt, (uint16_t)n);
+		removed++;
+	}
+	/* put them back for the next time */
+	n = ldns_rr_list_rr_count(additional) + removed;
+	ldns_rr_list_set_rr_count(additional, n);
+	ldns_pkt_set_arcount(pkt, (uint16_t)n);
+	return ldns_buffer_position(buf);
+}
+
+static void
+bench(size_t max, size_t n, const ldns_query_info *qi, ldns_pkt *pkt,
+		ldns_rr_list *ns, ldns_rr_list **glue)
+{
+	ldns_buffer *buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_response resp;
+	size_t i, len_pkt, len_resp = 0;
+	bool added[2 * NS_COUNT];
+	double t, t_pkt;
+
+	ldns_pkt_set_edns_udp_size(pkt, (uint16_t)max);
+	t = now();
+	for (i = 0; i < n; i++) {
+		(void) fit_pkt(buf, pkt, max);
+	}
+	t_pkt = now() - t;
+	len_pkt = ldns_buffer_position(buf);
+
+	t = now();
+	for (i = 0; i < n; i++) {
+		(void) ldns_response_init(&resp, buf, qi, max);
+		(void) ldns_response_add_rr_list(&resp,
+				LDNS_SECTION_AUTHORITY, ns);
+		(void) ldns_response_add_rrsets(&resp,
+				LDNS_SECTION_ADDITIONAL, glue, 2 * NS_COUNT,
+				added);
+		(void) ldns_response_finish(&resp);
+	}
+	t = now() - t;
+	len_resp = ldns_buffer_position(buf);
+
+	printf("%u bytes\n", (unsigned)max);
+	printf("  ldns_pkt encoded until it fits   %9.0f /s, %u bytes\n",
+		(double)n / t_pkt, (unsigned)len_pkt);
+	printf("  ldns_response with sizes         %9.0f /s, %u bytes "
+		"(%.2fx)\n", (double)n / t, (unsigned)len_resp, t_pkt / t);
+	ldns_buffer_free(buf);
+}
+
+int
+main(int argc, char *argv[])
+{
+	ldns_rr_list *ns, *glue[2 * NS_COUNT];
+	ldns_query_info qi;
+	ldns_pkt *query, *pkt;
+	uint8_t *wire;
+	size_t n = 200000, i, len;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	make_referral(&ns, glue);
+
+	query = ldns_pkt_query_new(ldns_dname_new_frm_str("www.example."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, 0);
+	ldns_pkt_set_edns_udp_size(query, 1232);
+	(void) ldns_pkt2wire(&wire, query, &len);
+	(void) ldns_query_info_from_wire(&qi, wire, len);
+	LDNS_FREE(wire);
+
+	pkt = ldns_pkt_clone(query);
+	ldns_pkt_set_qr(pkt, true);
+	(void) ldns_pkt_push_rr_list(pkt, LDNS_SECTION_AUTHORITY, ns);
+	for (i = 0; i < 2 * NS_COUNT; i++) {
+		(void) ldns_pkt_push_rr_list(pkt, LDNS_SECTION_ADDITIONAL,
+				glue[i]);
+	}
+
+	bench(512, n, &qi, pkt, ns, glue);
+	bench(1232, n, &qi, pkt, ns, glue);
+
+	/* the RRs are in the packet too, without being cloned */
+	ldns_rr_list_deep_free(ns);
+	for (i = 0; i < 2 * NS_COUNT; i++) {
+		ldns_rr_list_deep_free(glue[i]);
+	}
+	ldns_rr_list_free(ldns_pkt_authority(pkt));
+	ldns_rr_list_free(ldns_pkt_additional(pkt));
+	ldns_pkt_set_authority(pkt, ldns_rr_list_new());
+	ldns_pkt_set_additional(pkt, ldns_rr_list_new());
+	ldns_pkt_free(pkt);
+	ldns_pkt_free(query);
+	return EXIT_SUCCESS;
+}
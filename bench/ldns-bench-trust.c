@@ -0,0 +1,228 @@
+/*
+ * ldns-bench-trust validates many RRsets signed by the same zone with
+ * ldns_verify_trusted_cached(), with and without a trust cache of the
+ * DNSKEY and DS RRsets of the chain of trust.
+ *
+ * The chain is . -> example. -> bench.example., signed on the fly.  The
+ * DNSKEY and DS answers are put in the response cache of the resolver
+ * beforehand, so no queries are sent and only validation is measured.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures validation with and without a trust cache\n");
+	fprintf(fp, "-n <number>\tnumber of names in the zone (default 10000)\n");
+}
+
+static void
+fail(const char *what)
+{
+	fprintf(stderr, "%s\n", what);
+	exit(EXIT_FAILURE);
+}
+
+static ldns_key *
+make_key(const char *zone, ldns_key_list *keys)
+{
+	ldns_key *key = ldns_key_new_frm_algorithm(LDNS_SIGN_ECDSAP256SHA256, 0);
+	ldns_rr *rr;
+
+	if (!key) {
+		fail("Could not create key");
+	}
+	ldns_key_set_pubkey_owner(key, ldns_dname_new_frm_str(zone));
+	ldns_key_set_flags(key, LDNS_KEY_ZONE_KEY | LDNS_KEY_SEP_KEY);
+	if (!(rr = ldns_key2rr(key))) {
+		fail("Could not convert key");
+	}
+	ldns_key_set_keytag(key, ldns_calc_keytag(rr));
+	ldns_rr_free(rr);
+	ldns_key_list_push_key(keys, key);
+	return key;
+}
+
+/* Puts the RR, signed, in the response cache as answer to its query */
+static void
+put(ldns_resolver *res, ldns_rr *rr, ldns_key_list *signer)
+{
+	ldns_rr_list *rrset = ldns_rr_list_new();
+	ldns_rr_list *sigs;
+	ldns_pkt *query, *answer;
+
+	ldns_rr_set_ttl(rr, 3600);
+	ldns_rr_list_push_rr(rrset, rr);
+	if (!(sigs = ldns_sign_public(rrset, signer))
+	||  ldns_resolver_prepare_query_pkt(&query, res,
+			ldns_rr_owner(rr), ldns_rr_get_type(rr),
+			LDNS_RR_CLASS_IN, LDNS_RD) != LDNS_STATUS_OK
+	||  !(answer = ldns_pkt_clone(query))) {
+		fail("Could not make answer");
+	}
+	ldns_pkt_set_qr(answer, true);
+	ldns_pkt_set_aa(answer, true);
+	(void) ldns_pkt_push_rr_list(answer, LDNS_SECTION_ANSWER, rrset);
+	(void) ldns_pkt_push_rr_list(answer, LDNS_SECTION_ANSWER, sigs);
+	if (ldns_cache_store(ldns_resolver_cache(res), query, answer)
+			!= LDNS_STATUS_OK) {
+		fail("Could not cache answer");
+	}
+	ldns_pkt_free(query);
+	ldns_pkt_free(answer);
+	ldns_rr_list_free(rrset);
+	ldns_rr_list_free(sigs);
+}
+
+static double
+validate(ldns_resolver *res, ldns_rr_list **rrsets, ldns_rr_list **sigs,
+		size_t n, ldns_trust_cache *tc)
+{
+	double start = now();
+	ldns_status st;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		st = ldns_verify_trusted_cached(res, rrsets[i], sigs[i],
+				ldns_time(NULL), tc, NULL);
+		if (st != LDNS_STATUS_OK) {
+			fprintf(stderr, "Validation failed: %s\n",
+			        ldns_get_errorstr_by_id(st));
+			exit(EXIT_FAILURE);
+		}
+	}
+	return now() - start;
+}
+
+static void
+report(const char *what, size_t n, double secs)
+{
+	if (secs <= 0) {
+		secs = 0.000001;
+	}
+	printf("%-24s %8.3f s %10.0f validations/s\n", what, secs,
+	       (double)n / secs);
+}
+
+int
+main(int argc, char *argv[])
+{
+	size_t n = 10000, i;
+	ldns_key_list *root_keys, *tld_keys, *zone_keys;
+	ldns_key *root, *tld, *zone;
+	ldns_rr_list **rrsets, **sigs;
+	ldns_resolver *res;
+	ldns_trust_cache *tc;
+	ldns_trust_cache_stats stats;
+	ldns_rdf *ns;
+	ldns_rr *rr;
+	char str[256];
+	double without, with;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	root_keys = ldns_key_list_new();
+	tld_keys = ldns_key_list_new();
+	zone_keys = ldns_key_list_new();
+	root = make_key(".", root_keys);
+	tld = make_key("example.", tld_keys);
+	zone = make_key("bench.example.", zone_keys);
+
+	/* Nothing is sent to this nameserver: all answers are cached */
+	res = ldns_resolver_new();
+	ns = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_A, "127.0.0.1");
+	if (!res || !ns || ldns_resolver_push_nameserver(res, ns)
+			!= LDNS_STATUS_OK) {
+		fail("Could not create resolver");
+	}
+	ldns_rdf_deep_free(ns);
+	ldns_resolver_set_cache(res, ldns_cache_new(0));
+	rr = ldns_key2rr(root);
+	ldns_resolver_push_dnssec_anchor(res, rr);
+	put(res, rr, root_keys);
+	rr = ldns_key2rr(tld);
+	put(res, ldns_key_rr2ds(rr, LDNS_SHA256), root_keys);
+	put(res, rr, tld_keys);
+	rr = ldns_key2rr(zone);
+	put(res, ldns_key_rr2ds(rr, LDNS_SHA256), tld_keys);
+	put(res, rr, zone_keys);
+
+	rrsets = LDNS_XMALLOC(ldns_rr_list *, n);
+	sigs = LDNS_XMALLOC(ldns_rr_list *, n);
+	if (!rrsets || !sigs) {
+		fail("Memory error");
+	}
+	for (i = 0; i < n; i++) {
+		snprintf(str, sizeof(str), "h%u.bench.example. 3600 IN A "
+		         "192.0.2.%u", (unsigned)i, (unsigned)(i % 250));
+		if (ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL)
+				!= LDNS_STATUS_OK) {
+			fail("Could not make RR");
+		}
+		rrsets[i] = ldns_rr_list_new();
+		ldns_rr_list_push_rr(rrsets[i], rr);
+		if (!(sigs[i] = ldns_sign_public(rrsets[i], zone_keys))) {
+			fail("Could not sign RR");
+		}
+	}
+	printf("%u names in bench.example.\n", (unsigned)n);
+
+	without = validate(res, rrsets, sigs, n, NULL);
+	report("without trust cache", n, without);
+
+	if (!(tc = ldns_trust_cache_new())) {
+		fail("Memory error");
+	}
+	with = validate(res, rrsets, sigs, n, tc);
+	report("with trust cache", n, with);
+	ldns_trust_cache_get_stats(tc, &stats);
+	printf("trust cache: %u hits, %u misses, %u RRsets\n",
+	       (unsigned)stats.hits, (unsigned)stats.misses,
+	       (unsigned)stats.entries);
+
+	for (i = 0; i < n; i++) {
+		ldns_rr_list_deep_free(rrsets[i]);
+		ldns_rr_list_deep_free(sigs[i]);
+	}
+	LDNS_FREE(rrsets);
+	LDNS_FREE(sigs);
+	ldns_trust_cache_free(tc);
+	ldns_cache_free(ldns_resolver_cache(res));
+	ldns_resolver_deep_free(res);
+	ldns_key_list_free(root_keys);
+	ldns_key_list_free(tld_keys);
+	ldns_key_list_free(zone_keys);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,208 @@
+/*
+ * ldns-bench-validate measures how fast malformed packets are turned away
+ * by ldns_wire2pkt(), which checks them with ldns_wire_validate() before
+ * it allocates anything, and what the check costs for packets that are
+ * fine.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+#define CORPUS_SIZE 1000
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures reading of malformed and valid packets\n");
+	fprintf(fp, "-n <number>\tnumber of rounds over the corpus (default 1000)\n");
+}
+
+/* An answer with a few RRs of common types, as a resolver would get */
+static uint8_t *
+make_answer(size_t *len)
+{
+	const char *rrs[] = {
+		"www.example.com. 300 IN CNAME web.example.com.",
+		"web.example.com. 300 IN A 192.0.2.1",
+		"web.example.com. 300 IN A 192.0.2.2",
+		"web.example.com. 300 IN AAAA 2001:db8::1",
+		"example.com. 300 IN NS ns1.example.com.",
+		"example.com. 300 IN NS ns2.example.com.",
+		"ns1.example.com. 300 IN A 192.0.2.53",
+		"ns2.example.com. 300 IN AAAA 2001:db8::53",
+	};
+	const ldns_pkt_section sections[] = {
+		LDNS_SECTION_ANSWER, LDNS_SECTION_ANSWER, LDNS_SECTION_ANSWER,
+		LDNS_SECTION_ANSWER, LDNS_SECTION_AUTHORITY,
+		LDNS_SECTION_AUTHORITY, LDNS_SECTION_ADDITIONAL,
+		LDNS_SECTION_ADDITIONAL
+	};
+	ldns_pkt *pkt;
+	ldns_rr *rr;
+	uint8_t *wire = NULL;
+	size_t i;
+
+	pkt = ldns_pkt_query_new(ldns_dname_new_frm_str("www.example.com."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_QR | LDNS_RD);
+	for (i = 0; i < sizeof(rrs) / sizeof(rrs[0]); i++) {
+		if (ldns_rr_new_frm_str(&rr, rrs[i], 0, NULL, NULL)
+				!= LDNS_STATUS_OK) {
+			fprintf(stderr, "can not read %s\n", rrs[i]);
+			exit(EXIT_FAILURE);
+		}
+		(void) ldns_pkt_push_rr(pkt, sections[i], rr);
+	}
+	if (ldns_pkt2wire(&wire, pkt, len) != LDNS_STATUS_OK) {
+		fprintf(stderr, "can not make the answer\n");
+		exit(EXIT_FAILURE);
+	}
+	ldns_pkt_free(pkt);
+	return wire;
+}
+
+/* Copies of the answer with random bytes changed or cut short, that
+ * ldns_wire2pkt() does not take */
+static void
+make_corpus(const uint8_t *wire, size_t len, uint8_t **corpus,
+		size_t *lens)
+{
+	ldns_pkt *pkt;
+	size_t i, k;
+
+	srandom(1035);
+	for (i = 0; i < CORPUS_SIZE; ) {
+		corpus[i] = LDNS_XMALLOC(uint8_t, len);
+		memcpy(corpus[i], wire, len);
+		lens[i] = i % 4 ? len : 12 + (size_t)random() % (len - 12);
+		for (k = 0; k < 1 + i % 3; k++) {
+			corpus[i][12 + (size_t)random() % (len - 12)] =
+				(uint8_t)random();
+		}
+		if (ldns_wire2pkt(&pkt, corpus[i], lens[i]) == LDNS_STATUS_OK) {
+			ldns_pkt_free(pkt);
+			LDNS_FREE(corpus[i]);
+			continue;
+		}
+		i++;
+	}
+}
+
+static void
+report(const char *what, size_t n, double t, double base)
+{
+	printf("%-32s %10.0f packets/s", what, (double)n / t);
+	if (base > 0) {
+		printf(" (%.2fx)", base / t);
+	}
+	printf("\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+	uint8_t *corpus[CORPUS_SIZE];
+	size_t lens[CORPUS_SIZE];
+	size_t n = 1000, round, i, len, errors;
+	uint8_t *wire;
+	ldns_pkt *pkt;
+	double t, t_pkt;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	wire = make_answer(&len);
+	make_corpus(wire, len, corpus, lens);
+
+	printf("%u malformed packets\n", (unsigned)CORPUS_SIZE);
+	errors = 0;
+	t = now();
+	for (round = 0; round < n; round++) {
+		for (i = 0; i < CORPUS_SIZE; i++) {
+			if (ldns_wire2pkt(&pkt, corpus[i], lens[i])
+					== LDNS_STATUS_OK) {
+				ldns_pkt_free(pkt);
+				errors++;
+			}
+		}
+	}
+	t_pkt = now() - t;
+	report("ldns_wire2pkt", n * CORPUS_SIZE, t_pkt, 0);
+	t = now();
+	for (round = 0; round < n; round++) {
+		for (i = 0; i < CORPUS_SIZE; i++) {
+			if (ldns_wire_validate(corpus[i], lens[i], false)
+					== LDNS_STATUS_OK) {
+				errors++;
+			}
+		}
+	}
+	report("ldns_wire_validate", n * CORPUS_SIZE, now() - t, t_pkt);
+	t = now();
+	for (round = 0; round < n; round++) {
+		for (i = 0; i < CORPUS_SIZE; i++) {
+			(void) ldns_wire_validate(corpus[i], lens[i], true);
+		}
+	}
+	report("ldns_wire_validate strict", n * CORPUS_SIZE, now() - t, t_pkt);
+
+	printf("a valid answer of %u bytes\n", (unsigned)len);
+	t = now();
+	for (round = 0; round < n * CORPUS_SIZE / 10; round++) {
+		if (ldns_wire2pkt(&pkt, wire, len) != LDNS_STATUS_OK) {
+			errors++;
+			continue;
+		}
+		ldns_pkt_free(pkt);
+	}
+	t_pkt = now() - t;
+	report("ldns_wire2pkt", n * CORPUS_SIZE / 10, t_pkt, 0);
+	t = now();
+	for (round = 0; round < n * CORPUS_SIZE / 10; round++) {
+		if (ldns_wire_validate(wire, len, true) != LDNS_STATUS_OK) {
+			errors++;
+		}
+	}
+	t = now() - t;
+	report("ldns_wire_validate strict", n * CORPUS_SIZE / 10, t, t_pkt);
+	printf("the check is %.1f%% of ldns_wire2pkt\n", 100.0 * t / t_pkt);
+
+	for (i = 0; i < CORPUS_SIZE; i++) {
+		LDNS_FREE(corpus[i]);
+	}
+	LDNS_FREE(wire);
+	if (errors) {
+		fprintf(stderr, "%u packets were not read as expected\n",
+			(unsigned)errors);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
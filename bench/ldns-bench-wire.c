@@ -0,0 +1,320 @@
+/*
+ * ldns-bench-wire measures how fast packets are converted to wire format
+ * with name compression, with a compression table on the stack compared
+ * to a tree of names allocated on the heap, like ldns did before.  And
+ * how fast the header, question and EDNS data are read from them with
+ * a ldns_pkt_view compared to decoding the whole packet.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures conversion of packets to and from wire format\n");
+	fprintf(fp, "-n <number>\tnumber of conversions per packet (default 200000)\n");
+}
+
+static void
+add_rr(ldns_pkt *pkt, ldns_pkt_section section, const char *str)
+{
+	ldns_rr *rr;
+	ldns_status st;
+
+	if (section == LDNS_SECTION_QUESTION) {
+		st = ldns_rr_new_question_frm_str(&rr, str, NULL, NULL);
+	} else {
+		st = ldns_rr_new_frm_str(&rr, str, 3600, NULL, NULL);
+	}
+	if (st != LDNS_STATUS_OK) {
+		fprintf(stderr, "Could not parse %s\n", str);
+		exit(EXIT_FAILURE);
+	}
+	(void) ldns_pkt_push_rr(pkt, section, rr);
+}
+
+static ldns_pkt *
+new_pkt(const char *qname, const char *qtype)
+{
+	ldns_pkt *pkt = ldns_pkt_new();
+	char str[256];
+
+	if (!pkt) {
+		fprintf(stderr, "Memory error\n");
+		exit(EXIT_FAILURE);
+	}
+	ldns_pkt_set_id(pkt, 4711);
+	ldns_pkt_set_qr(pkt, true);
+	ldns_pkt_set_rd(pkt, true);
+	snprintf(str, sizeof(str), "%s IN %s", qname, qtype);
+	add_rr(pkt, LDNS_SECTION_QUESTION, str);
+	ldns_pkt_set_edns_udp_size(pkt, 1232);
+	return pkt;
+}
+
+/* An answer with a CNAME, the NS RRs of the zone and glue */
+static ldns_pkt *
+answer_pkt(void)
+{
+	ldns_pkt *pkt = new_pkt("www.example.com.", "A");
+
+	ldns_pkt_set_aa(pkt, true);
+	add_rr(pkt, LDNS_SECTION_ANSWER,
+	       "www.example.com. CNAME web.example.com.");
+	add_rr(pkt, LDNS_SECTION_ANSWER, "web.example.com. A 192.0.2.1");
+	add_rr(pkt, LDNS_SECTION_ANSWER, "web.example.com. A 192.0.2.2");
+	add_rr(pkt, LDNS_SECTION_AUTHORITY, "example.com. NS ns1.example.com.");
+	add_rr(pkt, LDNS_SECTION_AUTHORITY, "example.com. NS ns2.example.com.");
+	add_rr(pkt, LDNS_SECTION_ADDITIONAL, "ns1.example.com. A 192.0.2.53");
+	add_rr(pkt, LDNS_SECTION_ADDITIONAL, "ns2.example.com. A 198.51.100.53");
+	add_rr(pkt, LDNS_SECTION_ADDITIONAL,
+	       "ns1.example.com. AAAA 2001:db8::53");
+	add_rr(pkt, LDNS_SECTION_ADDITIONAL,
+	       "ns2.example.com. AAAA 2001:db8:1::53");
+	return pkt;
+}
+
+/* A referral from the root to com., with glue for all nameservers */
+static ldns_pkt *
+referral_pkt(void)
+{
+	ldns_pkt *pkt = new_pkt("www.example.com.", "A");
+	char str[256];
+	int i;
+
+	for (i = 0; i < 13; i++) {
+		snprintf(str, sizeof(str), "com. NS %c.gtld-servers.net.",
+		         'a' + i);
+		add_rr(pkt, LDNS_SECTION_AUTHORITY, str);
+	}
+	for (i = 0; i < 13; i++) {
+		snprintf(str, sizeof(str), "%c.gtld-servers.net. A 192.0.2.%d",
+		         'a' + i, 30 + i);
+		add_rr(pkt, LDNS_SECTION_ADDITIONAL, str);
+		snprintf(str, sizeof(str),
+		         "%c.GTLD-servers.net. AAAA 2001:db8::%d", 'a' + i, 30 + i);
+		add_rr(pkt, LDNS_SECTION_ADDITIONAL, str);
+	}
+	return pkt;
+}
+
+/* A large answer to ANY */
+static ldns_pkt *
+any_pkt(void)
+{
+	ldns_pkt *pkt = new_pkt("example.com.", "ANY");
+	char str[256];
+	int i;
+
+	ldns_pkt_set_aa(pkt, true);
+	add_rr(pkt, LDNS_SECTION_ANSWER, "example.com. SOA ns1.example.com. "
+	       "hostmaster.example.com. 2024010101 3600 600 86400 300");
+	for (i = 0; i < 4; i++) {
+		snprintf(str, sizeof(str), "example.com. NS ns%d.example.com.",
+		         i + 1);
+		add_rr(pkt, LDNS_SECTION_ANSWER, str);
+	}
+	for (i = 0; i < 10; i++) {
+		snprintf(str, sizeof(str),
+		         "Example.COM. MX %d mail%d.mx.example.com.", i * 10, i);
+		add_rr(pkt, LDNS_SECTION_ANSWER, str);
+	}
+	for (i = 0; i < 8; i++) {
+		snprintf(str, sizeof(str), "example.com. A 192.0.2.%d", i + 1);
+		add_rr(pkt, LDNS_SECTION_ANSWER, str);
+		snprintf(str, sizeof(str), "example.com. AAAA 2001:db8::%d",
+		         i + 1);
+		add_rr(pkt, LDNS_SECTION_ANSWER, str);
+	}
+	for (i = 0; i < 10; i++) {
+		snprintf(str, sizeof(str), "example.com. TXT \"record %d "
+		         "v=spf1 include:_spf.example.com -all\"", i);
+		add_rr(pkt, LDNS_SECTION_ANSWER, str);
+	}
+	for (i = 0; i < 10; i++) {
+		snprintf(str, sizeof(str), "mail%d.mx.example.com. A 192.0.2.%d",
+		         i, 100 + i);
+		add_rr(pkt, LDNS_SECTION_ADDITIONAL, str);
+	}
+	return pkt;
+}
+
+static void
+compression_node_free(ldns_rbnode_t *node, void *arg)
+{
+	(void)arg;
+	ldns_rdf_deep_free((ldns_rdf *)node->key);
+	LDNS_FREE(node);
+}
+
+/* Converts a packet with a tree of names, like ldns did before */
+static ldns_status
+pkt2buffer_tree(ldns_buffer *buffer, const ldns_pkt *pkt)
+{
+	ldns_rbtree_t *tree = ldns_rbtree_create(
+			(int (*)(const void *, const void *))ldns_dname_compare);
+	ldns_status status;
+
+	status = ldns_pkt2buffer_wire_compress(buffer, pkt, tree);
+	ldns_traverse_postorder(tree, compression_node_free, NULL);
+	ldns_rbtree_free(tree);
+	return status;
+}
+
+static void
+bench(const char *what, const ldns_pkt *pkt, size_t n)
+{
+	ldns_buffer *tree_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *table_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	double start, tree, table;
+	size_t i;
+
+	if (!tree_buf || !table_buf) {
+		fprintf(stderr, "Memory error\n");
+		exit(EXIT_FAILURE);
+	}
+	start = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(tree_buf);
+		(void) pkt2buffer_tree(tree_buf, pkt);
+	}
+	tree = now() - start;
+
+	start = now();
+	for (i = 0; i < n; i++) {
+		ldns_buffer_clear(table_buf);
+		(void) ldns_pkt2buffer_wire(table_buf, pkt);
+	}
+	table = now() - start;
+
+	if (ldns_buffer_position(tree_buf) != ldns_buffer_position(table_buf)
+	||  memcmp(ldns_buffer_begin(tree_buf), ldns_buffer_begin(table_buf),
+			ldns_buffer_position(tree_buf)) != 0) {
+		fprintf(stderr, "%s: wire formats differ\n", what);
+		exit(EXIT_FAILURE);
+	}
+	if (tree <= 0) {
+		tree = 0.000001;
+	}
+	if (table <= 0) {
+		table = 0.000001;
+	}
+	printf("%-9s %4u bytes  tree %9.0f pkts/s  table %9.0f pkts/s\n",
+	       what, (unsigned)ldns_buffer_position(table_buf),
+	       (double)n / tree, (double)n / table);
+	ldns_buffer_free(tree_buf);
+	ldns_buffer_free(table_buf);
+}
+
+/* Reads what a proxy or logger needs from a packet: the ID, rcode,
+ * question and EDNS UDP size */
+static void
+bench_read(const char *what, const ldns_pkt *pkt, size_t n)
+{
+	uint8_t *wire, qname[LDNS_MAX_DOMAINLEN];
+	size_t len, qname_len, i, sum_pkt = 0, sum_view = 0;
+	ldns_pkt *decoded;
+	ldns_pkt_view view;
+	ldns_pkt_view_rr q, opt;
+	double start, full, lazy;
+
+	if (ldns_pkt2wire(&wire, pkt, &len) != LDNS_STATUS_OK) {
+		fprintf(stderr, "%s: can not convert to wire format\n", what);
+		exit(EXIT_FAILURE);
+	}
+	start = now();
+	for (i = 0; i < n; i++) {
+		if (ldns_wire2pkt(&decoded, wire, len) != LDNS_STATUS_OK) {
+			exit(EXIT_FAILURE);
+		}
+		sum_pkt += ldns_pkt_id(decoded) + ldns_pkt_get_rcode(decoded)
+		         + ldns_rdf_size(ldns_rr_owner(ldns_rr_list_rr(
+				ldns_pkt_question(decoded), 0)))
+		         + ldns_pkt_edns_udp_size(decoded);
+		ldns_pkt_free(decoded);
+	}
+	full = now() - start;
+
+	start = now();
+	for (i = 0; i < n; i++) {
+		if (ldns_pkt_view_init(&view, wire, len) != LDNS_STATUS_OK
+		||  !ldns_pkt_view_rr_first(&view, LDNS_SECTION_QUESTION, &q)
+		||  ldns_pkt_view_name(&view, q.owner, qname, sizeof(qname),
+				&qname_len) != LDNS_STATUS_OK
+		||  !ldns_pkt_view_edns(&view, &opt)) {
+			exit(EXIT_FAILURE);
+		}
+		sum_view += ldns_pkt_view_id(&view)
+		          + ldns_pkt_view_get_rcode(&view) + qname_len
+		          + opt.rr_class;
+	}
+	lazy = now() - start;
+
+	if (sum_pkt != sum_view) {
+		fprintf(stderr, "%s: view reads differently\n", what);
+		exit(EXIT_FAILURE);
+	}
+	if (full <= 0) {
+		full = 0.000001;
+	}
+	if (lazy <= 0) {
+		lazy = 0.000001;
+	}
+	printf("%-9s %4u bytes  wire2pkt %9.0f pkts/s  view %9.0f pkts/s\n",
+	       what, (unsigned)len, (double)n / full, (double)n / lazy);
+	LDNS_FREE(wire);
+}
+
+int
+main(int argc, char *argv[])
+{
+	size_t n = 200000;
+	ldns_pkt *pkt;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	pkt = answer_pkt();
+	bench("answer", pkt, n);
+	bench_read("answer", pkt, n);
+	ldns_pkt_free(pkt);
+	pkt = referral_pkt();
+	bench("referral", pkt, n);
+	bench_read("referral", pkt, n);
+	ldns_pkt_free(pkt);
+	pkt = any_pkt();
+	bench("ANY", pkt, n);
+	bench_read("ANY", pkt, n);
+	ldns_pkt_free(pkt);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,171 @@
+/*
+ * ldns-bench-zonemd measures how fast the SHA384 and SHA512 ZONEMD
+ * digests of a zone are computed, compared to computing them one RR
+ * at a time in a single thread.
+ *
+ * (c) NLnet Labs, 2024
+ * See the file LICENSE for the license
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <ldns/ldns.h>
+
+static double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static void
+usage(FILE *fp, const char *prog)
+{
+	fprintf(fp, "%s [OPTIONS]\n", prog);
+	fprintf(fp, "  measures SHA384 and SHA512 ZONEMD computation\n");
+	fprintf(fp, "-n <number>\tnumber of names in the zone (default 500000)\n");
+	fprintf(fp, "-r <number>\tnumber of rounds (default 3)\n");
+}
+
+static void
+add_rr(ldns_dnssec_zone *zone, const char *str)
+{
+	ldns_rr *rr;
+
+	if (ldns_rr_new_frm_str(&rr, str, 3600, NULL, NULL) != LDNS_STATUS_OK
+	||  ldns_dnssec_zone_add_rr(zone, rr) != LDNS_STATUS_OK) {
+		fprintf(stderr, "Could not add %s\n", str);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void
+report(const char *what, size_t bytes, double secs)
+{
+	if (secs <= 0) {
+		secs = 0.000001;
+	}
+	printf("%-28s %8.3f s %10.1f MB/s\n", what, secs,
+	       (double)bytes / secs / 1000000.0);
+}
+
+/* Both digests over all RRs, one RR at a time, like ldns did before */
+static size_t
+digest_serial(ldns_dnssec_zone *zone)
+{
+	uint8_t sha384[LDNS_SHA384_DIGEST_LENGTH];
+	uint8_t sha512[LDNS_SHA512_DIGEST_LENGTH];
+	ldns_sha384_CTX ctx384;
+	ldns_sha512_CTX ctx512;
+	ldns_buffer *buf = ldns_buffer_new(65536);
+	ldns_rbnode_t *node;
+	ldns_dnssec_rrsets *rrset;
+	ldns_dnssec_rrs *rrs;
+	size_t bytes = 0;
+
+	ldns_sha384_init(&ctx384);
+	ldns_sha512_init(&ctx512);
+	for (node = ldns_rbtree_first(zone->names); node != LDNS_RBTREE_NULL;
+			node = ldns_rbtree_next(node)) {
+		rrset = ((ldns_dnssec_name *)node->data)->rrsets;
+		for (; rrset; rrset = rrset->next) {
+			if (rrset->type == LDNS_RR_TYPE_ZONEMD) {
+				continue;
+			}
+			for (rrs = rrset->rrs; rrs; rrs = rrs->next) {
+				ldns_buffer_clear(buf);
+				(void) ldns_rr2buffer_wire_canonical(buf,
+					rrs->rr, LDNS_SECTION_ANSWER);
+				ldns_sha384_update(&ctx384,
+					ldns_buffer_begin(buf),
+					ldns_buffer_position(buf));
+				ldns_sha512_update(&ctx512,
+					ldns_buffer_begin(buf),
+					ldns_buffer_position(buf));
+				bytes += ldns_buffer_position(buf);
+			}
+		}
+	}
+	ldns_sha384_final(sha384, &ctx384);
+	ldns_sha512_final(sha512, &ctx512);
+	ldns_buffer_free(buf);
+	return bytes;
+}
+
+int
+main(int argc, char *argv[])
+{
+	size_t n = 500000, rounds = 3, i, bytes = 0;
+	ldns_dnssec_zone *zone;
+	char str[512];
+	double start, serial = 0, pipelined = 0;
+	ldns_status st;
+	int c;
+
+	while ((c = getopt(argc, argv, "n:r:h")) != -1) {
+		switch (c) {
+		case 'n':
+			n = (size_t)atoi(optarg);
+			break;
+		case 'r':
+			rounds = (size_t)atoi(optarg);
+			break;
+		case 'h':
+			usage(stdout, argv[0]);
+			exit(EXIT_SUCCESS);
+		default:
+			usage(stderr, argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (!(zone = ldns_dnssec_zone_new())) {
+		fprintf(stderr, "Memory error\n");
+		exit(EXIT_FAILURE);
+	}
+	add_rr(zone, "bench.example. SOA ns.bench.example. "
+	             "hostmaster.bench.example. 1 3600 600 86400 300");
+	add_rr(zone, "bench.example. NS ns.bench.example.");
+	/* The digests will not match, but they are computed all the same */
+	add_rr(zone, "bench.example. ZONEMD 1 1 1 "
+	             "000000000000000000000000000000000000000000000000"
+	             "000000000000000000000000000000000000000000000000");
+	add_rr(zone, "bench.example. ZONEMD 1 1 2 "
+	             "0000000000000000000000000000000000000000000000000000000000000000"
+	             "0000000000000000000000000000000000000000000000000000000000000000");
+	for (i = 0; i < n; i++) {
+		snprintf(str, sizeof(str), "h%u.bench.example. A 192.0.2.%u",
+		         (unsigned)i, (unsigned)(i % 250));
+		add_rr(zone, str);
+		snprintf(str, sizeof(str), "h%u.bench.example. TXT "
+		         "\"v=spf1 ip4:192.0.2.0/24 ip6:2001:db8::/32 -all\"",
+		         (unsigned)i);
+		add_rr(zone, str);
+	}
+	printf("%u names, %u rounds\n", (unsigned)n, (unsigned)rounds);
+
+	for (i = 0; i < rounds; i++) {
+		start = now();
+		bytes = digest_serial(zone);
+		serial += now() - start;
+
+		start = now();
+		st = ldns_dnssec_zone_verify_zonemd(zone);
+		pipelined += now() - start;
+		if (st != LDNS_STATUS_NO_VALID_ZONEMD) {
+			fprintf(stderr, "Unexpected result: %s\n",
+			        ldns_get_errorstr_by_id(st));
+			exit(EXIT_FAILURE);
+		}
+	}
+	report("one RR at a time", bytes * rounds, serial);
+	report("ldns_dnssec_zone_verify_zonemd", bytes * rounds, pipelined);
+
+	ldns_dnssec_zone_deep_free(zone);
+	return EXIT_SUCCESS;
+}
@@ -12,6 +12,10 @@
 #include <ldns/ldns.h>
 #include <ldns/buffer.h>
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 ldns_buffer *
 ldns_buffer_new(size_t capacity)
 {
@@ -56,6 +60,20 @@ ldns_buffer_new_frm_data(ldns_buffer *buffer, const void *data, size_t size)
 	ldns_buffer_invariant(buffer);
 }
 
+void
+ldns_buffer_init_frm_data(ldns_buffer *buffer, void *data, size_t size)
+{
+	assert(data != NULL);
+
+	buffer->_position = 0;
+	buffer->_limit = buffer->_capacity = size;
+	buffer->_fixed = 1;
+	buffer->_data = data;
+	buffer->_status = LDNS_STATUS_OK;
+
+	ldns_buffer_invariant(buffer);
+}
+
 bool
 ldns_buffer_set_capacity(ldns_buffer *buffer, size_t capacity)
 {
@@ -86,7 +104,9 @@ ldns_buffer_reserve(ldns_buffer *buffer, size_t amount)
 		if (new_capacity < buffer->_position + amount) {
 			new_capacity = buffer->_position + amount;
 		}
-		if (!ldns_buffer_set_capacity(buffer, new_capacity)) {
+		/* the memory of a fixed buffer is not ours to resize */
+		if (buffer->_fixed
+		||  !ldns_buffer_set_capacity(buffer, new_capacity)) {
 			buffer->_status = LDNS_STATUS_MEM_ERR;
 			return false;
 		}
@@ -153,6 +173,148 @@ ldns_buffer_export(ldns_buffer *buffer)
 	return buffer->_data;
 }
 
+/* The capacities of the buffers that are kept for reuse, and how many of
+ * each are kept per thread */
+#define LDNS_BUFFER_POOL_CLASSES 3
+#define LDNS_BUFFER_POOL_DEPTH   4
+
+static const size_t ldns_buffer_pool_sizes[LDNS_BUFFER_POOL_CLASSES] = {
+	LDNS_MIN_BUFLEN, 4096, LDNS_MAX_PACKETLEN
+};
+
+#ifdef HAVE_PTHREAD
+struct ldns_buffer_pool {
+	size_t       count[LDNS_BUFFER_POOL_CLASSES];
+	ldns_buffer *free[LDNS_BUFFER_POOL_CLASSES][LDNS_BUFFER_POOL_DEPTH];
+};
+
+static pthread_key_t  ldns_buffer_pool_key;
+static pthread_once_t ldns_buffer_pool_once = PTHREAD_ONCE_INIT;
+static bool           ldns_buffer_pool_have_key = false;
+
+static void
+ldns_buffer_pool_empty(struct ldns_buffer_pool *pool)
+{
+	size_t i;
+
+	for (i = 0; i < LDNS_BUFFER_POOL_CLASSES; i++) {
+		while (pool->count[i] > 0) {
+			ldns_buffer_free(pool->free[i][--pool->count[i]]);
+		}
+	}
+}
+
+/* Called when a thread that has a pool exits */
+static void
+ldns_buffer_pool_destroy(void *arg)
+{
+	ldns_buffer_pool_empty((struct ldns_buffer_pool *)arg);
+	LDNS_FREE(arg);
+}
+
+static void
+ldns_buffer_pool_key_create(void)
+{
+	ldns_buffer_pool_have_key = pthread_key_create(&ldns_buffer_pool_key,
+			ldns_buffer_pool_destroy) == 0;
+}
+
+/* The pool of the calling thread, made when create is set */
+static struct ldns_buffer_pool *
+ldns_buffer_pool_get(bool create)
+{
+	struct ldns_buffer_pool *pool;
+
+	if (pthread_once(&ldns_buffer_pool_once, ldns_buffer_pool_key_create)
+			!= 0 || !ldns_buffer_pool_have_key) {
+		return NULL;
+	}
+	pool = pthread_getspecific(ldns_buffer_pool_key);
+	if (!pool && create && (pool = LDNS_CALLOC(struct ldns_buffer_pool, 1))
+	&&  pthread_setspecific(ldns_buffer_pool_key, pool) != 0) {
+		LDNS_FREE(pool);
+	}
+	return pool;
+}
+#endif /* HAVE_PTHREAD */
+
+ldns_buffer *
+ldns_buffer_acquire(size_t capacity)
+{
+	size_t i;
+#ifdef HAVE_PTHREAD
+	struct ldns_buffer_pool *pool;
+	ldns_buffer *buffer;
+#endif
+
+	for (i = 0; i < LDNS_BUFFER_POOL_CLASSES; i++) {
+		if (capacity <= ldns_buffer_pool_sizes[i]) {
+			break;
+		}
+	}
+	if (i == LDNS_BUFFER_POOL_CLASSES) {
+		return ldns_buffer_new(capacity);
+	}
+#ifdef HAVE_PTHREAD
+	if ((pool = ldns_buffer_pool_get(false)) && pool->count[i] > 0) {
+		buffer = pool->free[i][--pool->count[i]];
+		ldns_buffer_clear(buffer);
+		buffer->_status = LDNS_STATUS_OK;
+		return buffer;
+	}
+#endif
+	return ldns_buffer_new(ldns_buffer_pool_sizes[i]);
+}
+
+void
+ldns_buffer_release(ldns_buffer *buffer)
+{
+#ifdef HAVE_PTHREAD
+	struct ldns_buffer_pool *pool;
+	size_t i;
+
+	/* Buffers that were exported, or have grown beyond the largest
+	 * class, are not kept */
+	if (buffer && !buffer->_fixed
+	&&  buffer->_capacity >= ldns_buffer_pool_sizes[0]
+	&&  buffer->_capacity <= LDNS_MAX_PACKETLEN) {
+		for (i = LDNS_BUFFER_POOL_CLASSES - 1;
+		     buffer->_capacity < ldns_buffer_pool_sizes[i]; i--)
+			;
+		if ((pool = ldns_buffer_pool_get(true))
+		&&  pool->count[i] < LDNS_BUFFER_POOL_DEPTH) {
+			pool->free[i][pool->count[i]++] = buffer;
+			return;
+		}
+	}
+#endif
+	ldns_buffer_free(buffer);
+}
+
+void
+ldns_buffer_release_clear(ldns_buffer *buffer)
+{
+	if (buffer && !buffer->_fixed) {
+		/* what was written ends at the limit of a flipped buffer,
+		 * which may be the capacity, or at the position otherwise */
+		memset(buffer->_data, 0, buffer->_limit > buffer->_position
+				? buffer->_limit : buffer->_position);
+	}
+	ldns_buffer_release(buffer);
+}
+
+void
+ldns_buffer_pool_clear(void)
+{
+#ifdef HAVE_PTHREAD
+	struct ldns_buffer_pool *pool = ldns_buffer_pool_get(false);
+
+	if (pool) {
+		ldns_buffer_pool_empty(pool);
+	}
+#endif
+}
+
 int
 ldns_bgetc(ldns_buffer *buffer)
 {
@@ -0,0 +1,1455 @@
+/*
+ * cache.c -- cache of DNS answers
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+#include <time.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* Number of shards, with a lock each.  Must be a power of two. */
+#define LDNS_CACHE_SHARDS		16
+#define LDNS_CACHE_SHARD_BITS		4
+
+/* Number of hash buckets a shard starts with.  Doubled when a shard holds
+ * more than twice as many answers. */
+#define LDNS_CACHE_BUCKETS		64
+
+/* Flag, type, class and name of a question */
+#define LDNS_CACHE_KEY_MAX		(5 + LDNS_MAX_DOMAINLEN)
+
+/* Part of the size of a cache used for NSEC and NSEC3 records: a quarter */
+#define LDNS_CACHE_DENIAL_SHARE		4
+
+/* Longest NSEC3 hash kept */
+#define LDNS_CACHE_HASH_MAX		64
+
+/* Query bits that are part of the key */
+#define LDNS_CACHE_KEY_DO		0x01
+#define LDNS_CACHE_KEY_CD		0x02
+#define LDNS_CACHE_KEY_RD		0x04
+
+typedef struct ldns_cache_entry ldns_cache_entry;
+
+struct ldns_cache_entry {
+	/* Next entry in the hash bucket */
+	ldns_cache_entry	*next;
+	/* Neighbours in the clock of the shard */
+	ldns_cache_entry	*clock_prev;
+	ldns_cache_entry	*clock_next;
+
+	uint32_t		 hash;
+	uint8_t			*key;
+	size_t			 key_len;
+
+	/* The answer in wire format, and where it came from */
+	uint8_t			*wire;
+	size_t			 wire_len;
+	ldns_rdf		*answerfrom;
+
+	/* When the answer was stored, and for how long it is kept */
+	time_t			 stored;
+	uint32_t		 ttl;
+
+	/* Bytes counted against the size of the shard */
+	size_t			 size;
+	/* Lookups answered with this entry */
+	size_t			 hits;
+	/* Used since the clock hand last passed */
+	bool			 referenced;
+	/* A lookup was told to refresh this answer */
+	bool			 refreshing;
+};
+
+typedef struct ldns_cache_shard {
+#ifdef HAVE_PTHREAD
+	pthread_mutex_t		 lock;
+#endif
+	ldns_cache_entry	**buckets;
+	size_t			 nbuckets;
+	/* The clock hand, the entry looked at next when making room */
+	ldns_cache_entry	*hand;
+	size_t			 max_size;
+	ldns_cache_stats	 stats;
+} ldns_cache_shard;
+
+typedef struct ldns_cache_denial ldns_cache_denial;
+
+/* A validated NSEC or NSEC3 record with its signatures */
+struct ldns_cache_denial {
+	/* In the nsecs tree of the zone keyed by owner name, or in the
+	 * nsec3s tree keyed by the denial itself, sorted by hash */
+	ldns_rbnode_t		 node;
+	ldns_rr			*rr;
+	ldns_rr_list		*rrsigs;
+	/* Owner and next hashes of a NSEC3 */
+	uint8_t			 hash[LDNS_CACHE_HASH_MAX];
+	size_t			 hash_len;
+	uint8_t			 next[LDNS_CACHE_HASH_MAX];
+	time_t			 expires;
+	size_t			 size;
+};
+
+/* The NSEC and NSEC3 records of a zone */
+typedef struct ldns_cache_zone {
+	/* In the zones tree, keyed by name */
+	ldns_rbnode_t		 node;
+	ldns_rdf		*name;
+	ldns_rr			*soa;
+	ldns_rr_list		*soa_rrsigs;
+	time_t			 soa_expires;
+	size_t			 size;
+	ldns_rbtree_t		 nsecs;
+	ldns_rbtree_t		 nsec3s;
+	/* Parameters of the records in nsec3s */
+	uint8_t			 nsec3_algorithm;
+	uint16_t		 nsec3_iterations;
+	uint8_t			 nsec3_salt[256];
+} ldns_cache_zone;
+
+struct ldns_struct_cache {
+	ldns_cache_shard	 shards[LDNS_CACHE_SHARDS];
+
+	/* Validated NSEC and NSEC3 records, by zone */
+#ifdef HAVE_PTHREAD
+	pthread_mutex_t		 denial_lock;
+#endif
+	ldns_rbtree_t		 zones;
+	size_t			 denial_max_size;
+	size_t			 denial_bytes;
+	size_t			 denials;
+	size_t			 synthesized;
+};
+
+static void
+ldns_cache_lock(ldns_cache_shard *shard)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&shard->lock);
+#else
+	(void)shard;
+#endif
+}
+
+static void
+ldns_cache_unlock(ldns_cache_shard *shard)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&shard->lock);
+#else
+	(void)shard;
+#endif
+}
+
+/* FNV-1a */
+static uint32_t
+ldns_cache_hash(const uint8_t *key, size_t key_len)
+{
+	uint32_t h = 2166136261U;
+	size_t i;
+
+	for (i = 0; i < key_len; i++) {
+		h ^= key[i];
+		h *= 16777619U;
+	}
+	return h;
+}
+
+static ldns_cache_shard *
+ldns_cache_shard_of(ldns_cache *cache, uint32_t hash)
+{
+	return &cache->shards[hash >> (32 - LDNS_CACHE_SHARD_BITS)];
+}
+
+/*
+ * Makes the key of the question of query in key, which must have room for
+ * LDNS_CACHE_KEY_MAX bytes.  Returns its length, or 0 when the query does
+ * not have exactly one question.
+ */
+static size_t
+ldns_cache_key(const ldns_pkt *query, uint8_t *key)
+{
+	const ldns_rr *q;
+	const ldns_rdf *name;
+	size_t i, len;
+
+	if (ldns_rr_list_rr_count(ldns_pkt_question(query)) != 1) {
+		return 0;
+	}
+	q = ldns_rr_list_rr(ldns_pkt_question(query), 0);
+	name = ldns_rr_owner(q);
+	if (!name || ldns_rdf_get_type(name) != LDNS_RDF_TYPE_DNAME
+	    || ldns_rdf_size(name) > LDNS_MAX_DOMAINLEN) {
+		return 0;
+	}
+	key[0] = (ldns_pkt_edns_do(query) ? LDNS_CACHE_KEY_DO : 0)
+	       | (ldns_pkt_cd(query) ? LDNS_CACHE_KEY_CD : 0)
+	       | (ldns_pkt_rd(query) ? LDNS_CACHE_KEY_RD : 0);
+	ldns_write_uint16(key + 1, ldns_rr_get_type(q));
+	ldns_write_uint16(key + 3, ldns_rr_get_class(q));
+	len = ldns_rdf_size(name);
+	for (i = 0; i < len; i++) {
+		key[5 + i] = (uint8_t)LDNS_DNAME_NORMALIZE(
+				(int)ldns_rdf_data(name)[i]);
+	}
+	return 5 + len;
+}
+
+static ldns_cache_entry **
+ldns_cache_find(ldns_cache_shard *shard, uint32_t hash,
+		const uint8_t *key, size_t key_len)
+{
+	ldns_cache_entry **e;
+
+	for (e = &shard->buckets[hash & (shard->nbuckets - 1)]; *e;
+			e = &(*e)->next) {
+		if ((*e)->hash == hash && (*e)->key_len == key_len
+		    && memcmp((*e)->key, key, key_len) == 0) {
+			break;
+		}
+	}
+	return e;
+}
+
+static void
+ldns_cache_entry_free(ldns_cache_entry *entry)
+{
+	LDNS_FREE(entry->key);
+	LDNS_FREE(entry->wire);
+	ldns_rdf_deep_free(entry->answerfrom);
+	LDNS_FREE(entry);
+}
+
+/* Takes entry out of the hash table and the clock of shard and frees it */
+static void
+ldns_cache_remove(ldns_cache_shard *shard, ldns_cache_entry *entry)
+{
+	ldns_cache_entry **e;
+
+	e = ldns_cache_find(shard, entry->hash, entry->key, entry->key_len);
+	assert(*e == entry);
+	*e = entry->next;
+
+	if (entry->clock_next == entry) {
+		shard->hand = NULL;
+	} else {
+		entry->clock_prev->clock_next = entry->clock_next;
+		entry->clock_next->clock_prev = entry->clock_prev;
+		if (shard->hand == entry) {
+			shard->hand = entry->clock_next;
+		}
+	}
+	shard->stats.entries--;
+	shard->stats.bytes -= entry->size;
+	ldns_cache_entry_free(entry);
+}
+
+/* Doubles the number of buckets of shard.  Keeps the old buckets when
+ * out of memory. */
+static void
+ldns_cache_grow(ldns_cache_shard *shard)
+{
+	ldns_cache_entry **buckets, *e, *next;
+	size_t nbuckets = shard->nbuckets * 2, i, b;
+
+	if (!(buckets = LDNS_XMALLOC(ldns_cache_entry *, nbuckets))) {
+		return;
+	}
+	for (i = 0; i < nbuckets; i++) {
+		buckets[i] = NULL;
+	}
+	for (i = 0; i < shard->nbuckets; i++) {
+		for (e = shard->buckets[i]; e; e = next) {
+			next = e->next;
+			b = e->hash & (nbuckets - 1);
+			e->next = buckets[b];
+			buckets[b] = e;
+		}
+	}
+	LDNS_FREE(shard->buckets);
+	shard->buckets = buckets;
+	shard->nbuckets = nbuckets;
+}
+
+/* Drops answers not used recently until size more bytes fit in shard */
+static void
+ldns_cache_make_room(ldns_cache_shard *shard, size_t size)
+{
+	ldns_cache_entry *victim;
+
+	while (shard->hand && shard->stats.bytes + size > shard->max_size) {
+		if (shard->hand->referenced) {
+			shard->hand->referenced = false;
+			shard->hand = shard->hand->clock_next;
+			continue;
+		}
+		victim = shard->hand;
+		ldns_cache_remove(shard, victim);
+		shard->stats.evictions++;
+	}
+}
+
+ldns_cache *
+ldns_cache_new(size_t max_size)
+{
+	ldns_cache *cache;
+	size_t i, j;
+
+	if (!(cache = LDNS_CALLOC(ldns_cache, 1))) {
+		return NULL;
+	}
+	if (max_size == 0) {
+		max_size = LDNS_CACHE_DEFAULT_SIZE;
+	}
+	cache->denial_max_size = max_size / LDNS_CACHE_DENIAL_SHARE;
+	max_size -= cache->denial_max_size;
+	for (i = 0; i < LDNS_CACHE_SHARDS; i++) {
+		ldns_cache_shard *shard = &cache->shards[i];
+
+		if (!(shard->buckets = LDNS_XMALLOC(ldns_cache_entry *,
+						LDNS_CACHE_BUCKETS))) {
+			while (i-- > 0) {
+#ifdef HAVE_PTHREAD
+				pthread_mutex_destroy(&cache->shards[i].lock);
+#endif
+				LDNS_FREE(cache->shards[i].buckets);
+			}
+			LDNS_FREE(cache);
+			return NULL;
+		}
+		for (j = 0; j < LDNS_CACHE_BUCKETS; j++) {
+			shard->buckets[j] = NULL;
+		}
+		shard->nbuckets = LDNS_CACHE_BUCKETS;
+		shard->max_size = max_size / LDNS_CACHE_SHARDS;
+#ifdef HAVE_PTHREAD
+		pthread_mutex_init(&shard->lock, NULL);
+#endif
+	}
+	ldns_rbtree_init(&cache->zones, ldns_dname_compare_v);
+#ifdef HAVE_PTHREAD
+	pthread_mutex_init(&cache->denial_lock, NULL);
+#endif
+	return cache;
+}
+
+static void
+ldns_cache_shard_flush(ldns_cache_shard *shard)
+{
+	ldns_cache_entry *e, *next;
+	size_t i;
+
+	for (i = 0; i < shard->nbuckets; i++) {
+		for (e = shard->buckets[i]; e; e = next) {
+			next = e->next;
+			ldns_cache_entry_free(e);
+		}
+		shard->buckets[i] = NULL;
+	}
+	shard->hand = NULL;
+	shard->stats.entries = 0;
+	shard->stats.bytes = 0;
+}
+
+static void
+ldns_cache_denial_lock(ldns_cache *cache)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&cache->denial_lock);
+#else
+	(void)cache;
+#endif
+}
+
+static void
+ldns_cache_denial_unlock(ldns_cache *cache)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&cache->denial_lock);
+#else
+	(void)cache;
+#endif
+}
+
+static int
+ldns_cache_hash_cmp(const void *a, const void *b)
+{
+	const ldns_cache_denial *x = a, *y = b;
+
+	if (x->hash_len != y->hash_len) {
+		return x->hash_len < y->hash_len ? -1 : 1;
+	}
+	return memcmp(x->hash, y->hash, x->hash_len);
+}
+
+static void
+ldns_cache_denial_free(ldns_rbnode_t *node, void *arg)
+{
+	ldns_cache_denial *d = (ldns_cache_denial *)node;
+
+	(void)arg;
+	ldns_rr_free(d->rr);
+	ldns_rr_list_deep_free(d->rrsigs);
+	LDNS_FREE(d);
+}
+
+static void
+ldns_cache_zone_free(ldns_rbnode_t *node, void *arg)
+{
+	ldns_cache_zone *zone = (ldns_cache_zone *)node;
+
+	(void)arg;
+	ldns_traverse_postorder(&zone->nsecs, ldns_cache_denial_free, NULL);
+	ldns_traverse_postorder(&zone->nsec3s, ldns_cache_denial_free, NULL);
+	ldns_rdf_deep_free(zone->name);
+	ldns_rr_free(zone->soa);
+	ldns_rr_list_deep_free(zone->soa_rrsigs);
+	LDNS_FREE(zone);
+}
+
+static void
+ldns_cache_denials_flush(ldns_cache *cache)
+{
+	ldns_traverse_postorder(&cache->zones, ldns_cache_zone_free, NULL);
+	ldns_rbtree_init(&cache->zones, ldns_dname_compare_v);
+	cache->denial_bytes = 0;
+	cache->denials = 0;
+}
+
+/* Drops the denial from tree of zone */
+static void
+ldns_cache_denial_remove(ldns_cache *cache, ldns_rbtree_t *tree,
+		ldns_cache_denial *d)
+{
+	(void) ldns_rbtree_delete(tree, d->node.key);
+	cache->denial_bytes -= d->size;
+	cache->denials--;
+	ldns_cache_denial_free(&d->node, NULL);
+}
+
+static void
+ldns_cache_denials_expire_tree(ldns_cache *cache, ldns_rbtree_t *tree,
+		time_t now)
+{
+	ldns_rbnode_t *node, *next;
+
+	for (node = ldns_rbtree_first(tree); node != LDNS_RBTREE_NULL;
+			node = next) {
+		next = ldns_rbtree_next(node);
+		if (((ldns_cache_denial *)node)->expires <= now) {
+			ldns_cache_denial_remove(cache, tree,
+					(ldns_cache_denial *)node);
+		}
+	}
+}
+
+/* Removes zone, which has no NSEC or NSEC3 records left */
+static void
+ldns_cache_zone_remove(ldns_cache *cache, ldns_cache_zone *zone)
+{
+	(void) ldns_rbtree_delete(&cache->zones, zone->name);
+	cache->denial_bytes -= zone->size;
+	ldns_cache_zone_free(&zone->node, NULL);
+}
+
+/* Drops expired NSEC and NSEC3 records, and zones without any left
+ * except keep */
+static void
+ldns_cache_denials_expire(ldns_cache *cache, time_t now,
+		ldns_cache_zone *keep)
+{
+	ldns_rbnode_t *node, *next;
+	ldns_cache_zone *zone;
+
+	for (node = ldns_rbtree_first(&cache->zones);
+			node != LDNS_RBTREE_NULL; node = next) {
+		next = ldns_rbtree_next(node);
+		zone = (ldns_cache_zone *)node;
+		ldns_cache_denials_expire_tree(cache, &zone->nsecs, now);
+		ldns_cache_denials_expire_tree(cache, &zone->nsec3s, now);
+		if (zone != keep && zone->nsecs.count == 0
+		    && zone->nsec3s.count == 0) {
+			ldns_cache_zone_remove(cache, zone);
+		}
+	}
+}
+
+/* Number of labels the names have in common at their end */
+static size_t
+ldns_cache_common_labels(const ldns_rdf *a, const ldns_rdf *b)
+{
+	const uint8_t *la[LDNS_MAX_DOMAINLEN / 2 + 1];
+	const uint8_t *lb[LDNS_MAX_DOMAINLEN / 2 + 1];
+	size_t na = 0, nb = 0, n = 0, i;
+	const uint8_t *p;
+
+	for (p = ldns_rdf_data(a); *p; p += *p + 1) {
+		la[na++] = p;
+	}
+	for (p = ldns_rdf_data(b); *p; p += *p + 1) {
+		lb[nb++] = p;
+	}
+	while (na > 0 && nb > 0) {
+		p = la[--na];
+		if (*p != *lb[--nb]) {
+			break;
+		}
+		for (i = 1; i <= *p; i++) {
+			if (LDNS_DNAME_NORMALIZE((int)p[i])
+			    != LDNS_DNAME_NORMALIZE((int)lb[nb][i])) {
+				return n;
+			}
+		}
+		n++;
+	}
+	return n;
+}
+
+/* Is a an ancestor of b, or b itself? */
+static bool
+ldns_cache_is_ancestor(const ldns_rdf *a, const ldns_rdf *b)
+{
+	return ldns_cache_common_labels(a, b) == ldns_dname_label_count(a);
+}
+
+/* Is the owner of the NSEC or NSEC3 record a delegation or a DNAME? */
+static bool
+ldns_cache_is_cut(const ldns_rr *rr)
+{
+	const ldns_rdf *bitmap = ldns_nsec_get_bitmap(rr);
+
+	return ldns_nsec_bitmap_covers_type(bitmap, LDNS_RR_TYPE_DNAME)
+	    || (ldns_nsec_bitmap_covers_type(bitmap, LDNS_RR_TYPE_NS)
+	        && !ldns_nsec_bitmap_covers_type(bitmap, LDNS_RR_TYPE_SOA));
+}
+
+/* Can the NSEC or NSEC3 record say there is no data of type at its
+ * owner?  Not when the owner is a delegation or a DNAME. */
+static bool
+ldns_cache_denies_type(const ldns_rr *rr, ldns_rr_type type)
+{
+	const ldns_rdf *bitmap = ldns_nsec_get_bitmap(rr);
+
+	if (ldns_nsec_bitmap_covers_type(bitmap, type)
+	    || ldns_nsec_bitmap_covers_type(bitmap, LDNS_RR_TYPE_CNAME)) {
+		return false;
+	}
+	return type == LDNS_RR_TYPE_DS || !ldns_cache_is_cut(rr);
+}
+
+/* Finds the NSEC that covers name, which is not an owner name */
+static ldns_cache_denial *
+ldns_cache_nsec_cover(ldns_cache_zone *zone, const ldns_rdf *name,
+		time_t now)
+{
+	ldns_rbnode_t *node = NULL;
+	ldns_cache_denial *d;
+	const ldns_rdf *next;
+
+	if (ldns_rbtree_find_less_equal(&zone->nsecs, name, &node)
+	    || !node || node == LDNS_RBTREE_NULL) {
+		return NULL;
+	}
+	d = (ldns_cache_denial *)node;
+	next = ldns_rr_rdf(d->rr, 0);
+	if (d->expires <= now || (ldns_dname_compare(
+	    ldns_rr_owner(d->rr), next) < 0
+	    && ldns_dname_compare(name, next) >= 0)) {
+		return NULL;
+	}
+	return d;
+}
+
+/*
+ * Proves with NSEC records that name does not exist, or has no data of
+ * type (RFC 4035 Section 5.4).  Puts the records used in used and
+ * returns the rcode, or -1 when it can not be proven.
+ */
+static int
+ldns_cache_nsec_deny(ldns_cache_zone *zone, const ldns_rdf *name,
+		ldns_rr_type type, time_t now,
+		ldns_cache_denial **used, size_t *n)
+{
+	ldns_rbnode_t *node;
+	ldns_cache_denial *d, *w;
+	ldns_rdf *ce, *wildcard;
+	size_t ce_labels, l;
+	int rcode = -1;
+
+	if ((node = ldns_rbtree_search(&zone->nsecs, name))) {
+		d = (ldns_cache_denial *)node;
+		if (d->expires <= now || !ldns_cache_denies_type(d->rr, type)) {
+			return -1;
+		}
+		used[(*n)++] = d;
+		return LDNS_RCODE_NOERROR;
+	}
+	if (!(d = ldns_cache_nsec_cover(zone, name, now))
+	    || (ldns_cache_is_cut(d->rr)
+	        && ldns_cache_is_ancestor(ldns_rr_owner(d->rr), name))) {
+		return -1;
+	}
+	if (ldns_dname_is_subdomain(ldns_rr_rdf(d->rr, 0), name)) {
+		/* name is an empty non-terminal */
+		used[(*n)++] = d;
+		return LDNS_RCODE_NOERROR;
+	}
+
+	/* The closest encloser is the longest ancestor of name that the
+	 * owner or next name of the NSEC have */
+	ce_labels = ldns_cache_common_labels(name, ldns_rr_owner(d->rr));
+	l = ldns_cache_common_labels(name, ldns_rr_rdf(d->rr, 0));
+	if (l > ce_labels) {
+		ce_labels = l;
+	}
+	ce = ldns_dname_clone_from(name,
+			(uint16_t)(ldns_dname_label_count(name) - ce_labels));
+	wildcard = ldns_dname_new_frm_str("*");
+	if (ce && wildcard && ldns_dname_cat(wildcard, ce) == LDNS_STATUS_OK
+	    && !ldns_rbtree_search(&zone->nsecs, wildcard)
+	    && (w = ldns_cache_nsec_cover(zone, wildcard, now))) {
+		used[(*n)++] = d;
+		used[(*n)++] = w;
+		rcode = LDNS_RCODE_NXDOMAIN;
+	}
+	ldns_rdf_deep_free(ce);
+	ldns_rdf_deep_free(wildcard);
+	return rcode;
+}
+
+/* Decodes the base32hex label at label into hash.  Returns its length,
+ * or 0 when it is not a hash. */
+static size_t
+ldns_cache_hash_label(const uint8_t *label, uint8_t *hash)
+{
+	int len = ldns_b32_pton_extended_hex((const char *)label + 1,
+			label[0], hash, LDNS_CACHE_HASH_MAX);
+
+	return len > 0 ? (size_t)len : 0;
+}
+
+/* Hashes name with the NSEC3 parameters of zone */
+static bool
+ldns_cache_nsec3_hash(ldns_cache_zone *zone, const ldns_rdf *name,
+		ldns_cache_denial *key)
+{
+	ldns_rdf *hashed = ldns_nsec3_hash_name(name, zone->nsec3_algorithm,
+			zone->nsec3_iterations, zone->nsec3_salt[0],
+			zone->nsec3_salt + 1);
+
+	if (!hashed) {
+		return false;
+	}
+	key->hash_len = ldns_cache_hash_label(ldns_rdf_data(hashed),
+			key->hash);
+	ldns_rdf_deep_free(hashed);
+	return key->hash_len > 0;
+}
+
+/* Finds the NSEC3 matching name in match, or the one covering it in
+ * cover.  Returns false when neither is known. */
+static bool
+ldns_cache_nsec3_find(ldns_cache_zone *zone, const ldns_rdf *name,
+		time_t now, ldns_cache_denial **match,
+		ldns_cache_denial **cover)
+{
+	ldns_cache_denial key, *d;
+	ldns_rbnode_t *node = NULL;
+	bool wraps, after, before;
+
+	*match = *cover = NULL;
+	if (!ldns_cache_nsec3_hash(zone, name, &key)) {
+		return false;
+	}
+	if (ldns_rbtree_find_less_equal(&zone->nsec3s, &key, &node)) {
+		d = (ldns_cache_denial *)node;
+		*match = d->expires > now ? d : NULL;
+		return *match != NULL;
+	}
+	if (!node || node == LDNS_RBTREE_NULL) {
+		/* Before the first hash, only the last NSEC3 can cover it */
+		node = ldns_rbtree_last(&zone->nsec3s);
+		if (node == LDNS_RBTREE_NULL) {
+			return false;
+		}
+	}
+	d = (ldns_cache_denial *)node;
+	/* The last NSEC3 of the chain wraps around to the first; all others
+	 * cover only the hashes between their own and the next */
+	wraps = memcmp(d->next, d->hash, d->hash_len) <= 0;
+	after = memcmp(key.hash, d->hash, key.hash_len) > 0;
+	before = memcmp(key.hash, d->next, key.hash_len) < 0;
+	if (d->expires > now && (wraps ? after || before : after && before)) {
+		*cover = d;
+	}
+	return *cover != NULL;
+}
+
+/*
+ * Proves with NSEC3 records that name does not exist, or has no data of
+ * type (RFC 5155 Section 8).  Puts the records used in used and returns
+ * the rcode, or -1 when it can not be proven.
+ */
+static int
+ldns_cache_nsec3_deny(ldns_cache_zone *zone, const ldns_rdf *name,
+		ldns_rr_type type, time_t now,
+		ldns_cache_denial **used, size_t *n)
+{
+	ldns_cache_denial *match, *cover, *nc_cover = NULL, *wc_cover = NULL;
+	ldns_rdf *ce, *next_closer, *wildcard = NULL;
+	size_t zone_labels = ldns_dname_label_count(zone->name);
+	int rcode = -1;
+
+	if (zone->nsec3s.count == 0) {
+		return -1;
+	}
+	if (ldns_cache_nsec3_find(zone, name, now, &match, &cover)
+	    && match) {
+		if (!ldns_cache_denies_type(match->rr, type)) {
+			return -1;
+		}
+		used[(*n)++] = match;
+		return LDNS_RCODE_NOERROR;
+	}
+
+	/* Closest encloser proof: an ancestor that exists, and the next
+	 * closer name below it that does not */
+	match = NULL;
+	next_closer = ldns_rdf_clone(name);
+	ce = ldns_dname_left_chop(name);
+	while (ce && next_closer
+	    && ldns_dname_label_count(ce) >= zone_labels) {
+		if (!ldns_cache_nsec3_find(zone, ce, now, &match, &cover)
+		    || match) {
+			break;
+		}
+		ldns_rdf_deep_free(next_closer);
+		next_closer = ce;
+		ce = ldns_dname_left_chop(ce);
+	}
+	if (!match || ldns_cache_is_cut(match->rr)
+	    || !ldns_cache_nsec3_find(zone, next_closer, now,
+			    &cover, &nc_cover) || !nc_cover
+	    || ldns_nsec3_optout(nc_cover->rr)) {
+		goto done;
+	}
+	if (!(wildcard = ldns_dname_new_frm_str("*"))
+	    || ldns_dname_cat(wildcard, ce) != LDNS_STATUS_OK
+	    || !ldns_cache_nsec3_find(zone, wildcard, now,
+			    &cover, &wc_cover) || !wc_cover) {
+		goto done;
+	}
+	used[(*n)++] = match;
+	used[(*n)++] = nc_cover;
+	used[(*n)++] = wc_cover;
+	rcode = LDNS_RCODE_NXDOMAIN;
+done:
+	ldns_rdf_deep_free(ce);
+	ldns_rdf_deep_free(next_closer);
+	ldns_rdf_deep_free(wildcard);
+	return rcode;
+}
+
+/* Pushes a clone of rr with ttl in section of pkt */
+static bool
+ldns_cache_push_clone(ldns_pkt *pkt, ldns_pkt_section section,
+		const ldns_rr *rr, uint32_t ttl)
+{
+	ldns_rr *clone;
+
+	if (!(clone = ldns_rr_clone(rr))) {
+		return false;
+	}
+	ldns_rr_set_ttl(clone, ttl);
+	if (!ldns_pkt_push_rr(pkt, section, clone)) {
+		ldns_rr_free(clone);
+		return false;
+	}
+	return true;
+}
+
+/* Pushes clones of the RRs in list with ttl in section of pkt */
+static bool
+ldns_cache_push_clones(ldns_pkt *pkt, ldns_pkt_section section,
+		const ldns_rr_list *list, uint32_t ttl)
+{
+	size_t i;
+
+	for (i = 0; i < ldns_rr_list_rr_count(list); i++) {
+		if (!ldns_cache_push_clone(pkt, section,
+				ldns_rr_list_rr(list, i), ttl)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Makes the answer to query from the SOA of zone and the records used,
+ * which may repeat.  The records are only included when the query has
+ * the DO bit. */
+static ldns_pkt *
+ldns_cache_denial_pkt(const ldns_pkt *query, ldns_cache_zone *zone,
+		ldns_cache_denial **used, size_t n, int rcode, time_t now)
+{
+	ldns_pkt *answer;
+	uint32_t ttl = (uint32_t)(zone->soa_expires - now), d_ttl;
+	bool dnssec_ok = ldns_pkt_edns_do(query);
+	struct timeval tv;
+	size_t i, j;
+
+	for (i = 0; i < n; i++) {
+		if ((uint32_t)(used[i]->expires - now) < ttl) {
+			ttl = (uint32_t)(used[i]->expires - now);
+		}
+	}
+	if (!(answer = ldns_pkt_new())) {
+		return NULL;
+	}
+	ldns_pkt_set_id(answer, ldns_pkt_id(query));
+	ldns_pkt_set_qr(answer, true);
+	ldns_pkt_set_opcode(answer, LDNS_PACKET_QUERY);
+	ldns_pkt_set_rd(answer, ldns_pkt_rd(query));
+	ldns_pkt_set_ra(answer, true);
+	ldns_pkt_set_ad(answer, dnssec_ok);
+	ldns_pkt_set_rcode(answer, (uint8_t)rcode);
+	if (ldns_pkt_edns(query)) {
+		ldns_pkt_set_edns_udp_size(answer,
+				ldns_pkt_edns_udp_size(query));
+		ldns_pkt_set_edns_do(answer, dnssec_ok);
+	}
+	if (!ldns_cache_push_clones(answer, LDNS_SECTION_QUESTION,
+			ldns_pkt_question(query), 0)
+	    || !ldns_cache_push_clone(answer, LDNS_SECTION_AUTHORITY,
+			zone->soa, ttl)
+	    || (dnssec_ok && !ldns_cache_push_clones(answer,
+			LDNS_SECTION_AUTHORITY, zone->soa_rrsigs, ttl))) {
+		ldns_pkt_free(answer);
+		return NULL;
+	}
+	for (i = 0; dnssec_ok && i < n; i++) {
+		for (j = 0; j < i && used[j] != used[i]; j++);
+		if (j < i) {
+			continue;
+		}
+		d_ttl = (uint32_t)(used[i]->expires - now);
+		if (!ldns_cache_push_clone(answer, LDNS_SECTION_AUTHORITY,
+				used[i]->rr, d_ttl)
+		    || !ldns_cache_push_clones(answer, LDNS_SECTION_AUTHORITY,
+				used[i]->rrsigs, d_ttl)) {
+			ldns_pkt_free(answer);
+			return NULL;
+		}
+	}
+	ldns_pkt_set_querytime(answer, 0);
+	tv.tv_sec = now;
+	tv.tv_usec = 0;
+	ldns_pkt_set_timestamp(answer, tv);
+	return answer;
+}
+
+/*
+ * Answers query from the NSEC and NSEC3 records when they prove that
+ * the name or type asked for does not exist (RFC 8198).
+ */
+static ldns_pkt *
+ldns_cache_synthesize(ldns_cache *cache, const ldns_pkt *query)
+{
+	const ldns_rr *q;
+	ldns_rdf *name, *chopped;
+	ldns_rbnode_t *node = NULL;
+	ldns_cache_zone *zone;
+	ldns_cache_denial *used[3];
+	ldns_pkt *answer = NULL;
+	size_t n = 0;
+	int rcode;
+	time_t now;
+
+	if (ldns_pkt_cd(query)
+	    || ldns_rr_list_rr_count(ldns_pkt_question(query)) != 1) {
+		return NULL;
+	}
+	q = ldns_rr_list_rr(ldns_pkt_question(query), 0);
+	now = time(NULL);
+
+	ldns_cache_denial_lock(cache);
+	if (cache->zones.count == 0 || !(name = ldns_rdf_clone(ldns_rr_owner(q)))) {
+		ldns_cache_denial_unlock(cache);
+		return NULL;
+	}
+	/* The closest zone with records */
+	while (!(node = ldns_rbtree_search(&cache->zones, name))
+	    && ldns_dname_label_count(name) > 0
+	    && (chopped = ldns_dname_left_chop(name))) {
+		ldns_rdf_deep_free(name);
+		name = chopped;
+	}
+	ldns_rdf_deep_free(name);
+	if (node && (zone = (ldns_cache_zone *)node)->soa_expires > now) {
+		rcode = ldns_cache_nsec_deny(zone, ldns_rr_owner(q),
+				ldns_rr_get_type(q), now, used, &n);
+		if (rcode < 0) {
+			n = 0;
+			rcode = ldns_cache_nsec3_deny(zone, ldns_rr_owner(q),
+					ldns_rr_get_type(q), now, used, &n);
+		}
+		if (rcode >= 0 && (answer = ldns_cache_denial_pkt(query,
+				zone, used, n, rcode, now))) {
+			cache->synthesized++;
+		}
+	}
+	ldns_cache_denial_unlock(cache);
+	return answer;
+}
+
+void
+ldns_cache_free(ldns_cache *cache)
+{
+	size_t i;
+
+	if (!cache) {
+		return;
+	}
+	for (i = 0; i < LDNS_CACHE_SHARDS; i++) {
+		ldns_cache_shard_flush(&cache->shards[i]);
+		LDNS_FREE(cache->shards[i].buckets);
+#ifdef HAVE_PTHREAD
+		pthread_mutex_destroy(&cache->shards[i].lock);
+#endif
+	}
+	ldns_cache_denials_flush(cache);
+#ifdef HAVE_PTHREAD
+	pthread_mutex_destroy(&cache->denial_lock);
+#endif
+	LDNS_FREE(cache);
+}
+
+void
+ldns_cache_flush(ldns_cache *cache)
+{
+	size_t i;
+
+	for (i = 0; i < LDNS_CACHE_SHARDS; i++) {
+		ldns_cache_lock(&cache->shards[i]);
+		ldns_cache_shard_flush(&cache->shards[i]);
+		ldns_cache_unlock(&cache->shards[i]);
+	}
+	ldns_cache_denial_lock(cache);
+	ldns_cache_denials_flush(cache);
+	ldns_cache_denial_unlock(cache);
+}
+
+/* Lowers the TTLs of the RRs in list by age seconds */
+static void
+ldns_cache_age_rr_list(ldns_rr_list *list, uint32_t age)
+{
+	size_t i;
+	ldns_rr *rr;
+
+	for (i = 0; i < ldns_rr_list_rr_count(list); i++) {
+		rr = ldns_rr_list_rr(list, i);
+		ldns_rr_set_ttl(rr, ldns_rr_ttl(rr) > age
+				? ldns_rr_ttl(rr) - age : 0);
+	}
+}
+
+ldns_pkt *
+ldns_cache_lookup(ldns_cache *cache, const ldns_pkt *query)
+{
+	uint8_t key[LDNS_CACHE_KEY_MAX];
+	size_t key_len, wire_len = 0;
+	uint32_t hash, age = 0;
+	ldns_cache_shard *shard;
+	ldns_cache_entry *entry;
+	uint8_t *wire = NULL;
+	ldns_rdf *answerfrom = NULL;
+	ldns_pkt *answer = NULL;
+	time_t now;
+	struct timeval tv;
+
+	if (!cache || !query || !(key_len = ldns_cache_key(query, key))) {
+		return NULL;
+	}
+	hash = ldns_cache_hash(key, key_len);
+	shard = ldns_cache_shard_of(cache, hash);
+	now = time(NULL);
+
+	ldns_cache_lock(shard);
+	entry = *ldns_cache_find(shard, hash, key, key_len);
+	if (entry && (now < entry->stored
+	    || (uint32_t)(now - entry->stored) >= entry->ttl)) {
+		ldns_cache_remove(shard, entry);
+		shard->stats.expired++;
+		entry = NULL;
+	}
+	if (!entry) {
+		ldns_cache_unlock(shard);
+		if ((answer = ldns_cache_synthesize(cache, query))) {
+			return answer;
+		}
+		ldns_cache_lock(shard);
+		shard->stats.misses++;
+		ldns_cache_unlock(shard);
+		return NULL;
+	}
+	age = (uint32_t)(now - entry->stored);
+	if (entry->hits >= LDNS_CACHE_PREFETCH_HITS && !entry->refreshing
+	    && (uint64_t)(entry->ttl - age) * 100
+	       < (uint64_t)entry->ttl * LDNS_CACHE_PREFETCH) {
+		/* Let this caller ask again, others still get the answer */
+		entry->refreshing = true;
+		shard->stats.prefetches++;
+		ldns_cache_unlock(shard);
+		return NULL;
+	}
+	if ((wire = LDNS_XMALLOC(uint8_t, entry->wire_len))) {
+		memcpy(wire, entry->wire, entry->wire_len);
+		wire_len = entry->wire_len;
+		answerfrom = entry->answerfrom
+			   ? ldns_rdf_clone(entry->answerfrom) : NULL;
+		entry->hits++;
+		entry->referenced = true;
+		shard->stats.hits++;
+	} else {
+		shard->stats.misses++;
+	}
+	ldns_cache_unlock(shard);
+
+	if (!wire) {
+		return NULL;
+	}
+	if (ldns_wire2pkt(&answer, wire, wire_len) != LDNS_STATUS_OK) {
+		LDNS_FREE(wire);
+		ldns_rdf_deep_free(answerfrom);
+		return NULL;
+	}
+	LDNS_FREE(wire);
+
+	ldns_cache_age_rr_list(ldns_pkt_answer(answer), age);
+	ldns_cache_age_rr_list(ldns_pkt_authority(answer), age);
+	ldns_cache_age_rr_list(ldns_pkt_additional(answer), age);
+	ldns_pkt_set_id(answer, ldns_pkt_id(query));
+	ldns_pkt_set_answerfrom(answer, answerfrom);
+	ldns_pkt_set_querytime(answer, 0);
+	ldns_pkt_set_size(answer, wire_len);
+	tv.tv_sec = now;
+	tv.tv_usec = 0;
+	ldns_pkt_set_timestamp(answer, tv);
+	return answer;
+}
+
+/*
+ * Returns for how long answer may be kept, or 0 when it may not be kept.
+ */
+static uint32_t
+ldns_cache_ttl(const ldns_pkt *answer)
+{
+	ldns_rr_list *section;
+	const ldns_rr *rr, *soa = NULL;
+	uint32_t ttl = LDNS_CACHE_MAX_TTL, minimum;
+	size_t i, s;
+	bool negative;
+
+	negative = ldns_pkt_get_rcode(answer) == LDNS_RCODE_NXDOMAIN
+		|| ldns_pkt_ancount(answer) == 0;
+
+	for (s = 0; s < 2; s++) {
+		section = s == 0 ? ldns_pkt_answer(answer)
+				 : ldns_pkt_authority(answer);
+		for (i = 0; i < ldns_rr_list_rr_count(section); i++) {
+			rr = ldns_rr_list_rr(section, i);
+			if (ldns_rr_ttl(rr) < ttl) {
+				ttl = ldns_rr_ttl(rr);
+			}
+			if (s == 1 && !soa
+			    && ldns_rr_get_type(rr) == LDNS_RR_TYPE_SOA) {
+				soa = rr;
+			}
+		}
+	}
+	if (negative) {
+		/* RFC 2308 Section 5 */
+		if (!soa || ldns_rr_rd_count(soa) < 7) {
+			return 0;
+		}
+		minimum = ldns_rdf2native_int32(ldns_rr_rdf(soa, 6));
+		if (minimum < ttl) {
+			ttl = minimum;
+		}
+		if (ttl > LDNS_CACHE_MAX_NEG_TTL) {
+			ttl = LDNS_CACHE_MAX_NEG_TTL;
+		}
+	}
+	return ttl;
+}
+
+/* Does the question of answer match the question of query? */
+static bool
+ldns_cache_same_question(const ldns_pkt *query, const ldns_pkt *answer)
+{
+	const ldns_rr *q, *a;
+
+	if (ldns_rr_list_rr_count(ldns_pkt_question(answer)) != 1) {
+		return false;
+	}
+	q = ldns_rr_list_rr(ldns_pkt_question(query), 0);
+	a = ldns_rr_list_rr(ldns_pkt_question(answer), 0);
+	return ldns_rr_get_type(q) == ldns_rr_get_type(a)
+	    && ldns_rr_get_class(q) == ldns_rr_get_class(a)
+	    && ldns_dname_compare(ldns_rr_owner(q), ldns_rr_owner(a)) == 0;
+}
+
+ldns_status
+ldns_cache_store(ldns_cache *cache, const ldns_pkt *query,
+		const ldns_pkt *answer)
+{
+	uint8_t key[LDNS_CACHE_KEY_MAX];
+	size_t key_len;
+	uint32_t hash, ttl;
+	ldns_cache_shard *shard;
+	ldns_cache_entry *entry, *old;
+	ldns_rr_type qtype;
+	ldns_status s;
+
+	if (!cache || !query || !answer
+	    || !(key_len = ldns_cache_key(query, key))) {
+		return LDNS_STATUS_ERR;
+	}
+	qtype = ldns_rr_get_type(ldns_rr_list_rr(ldns_pkt_question(query), 0));
+	if (qtype == LDNS_RR_TYPE_AXFR || qtype == LDNS_RR_TYPE_IXFR
+	    || ldns_pkt_tc(answer) || ldns_pkt_tsig(answer)
+	    || (ldns_pkt_get_rcode(answer) != LDNS_RCODE_NOERROR
+	        && ldns_pkt_get_rcode(answer) != LDNS_RCODE_NXDOMAIN)
+	    || !ldns_cache_same_question(query, answer)
+	    || (ttl = ldns_cache_ttl(answer)) == 0) {
+		return LDNS_STATUS_ERR;
+	}
+	hash = ldns_cache_hash(key, key_len);
+	shard = ldns_cache_shard_of(cache, hash);
+
+	if (!(entry = LDNS_CALLOC(ldns_cache_entry, 1))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	s = ldns_pkt2wire(&entry->wire, answer, &entry->wire_len);
+	if (s != LDNS_STATUS_OK) {
+		LDNS_FREE(entry);
+		return s;
+	}
+	if (!(entry->key = LDNS_XMALLOC(uint8_t, key_len))
+	    || (ldns_pkt_answerfrom(answer) && !(entry->answerfrom =
+			ldns_rdf_clone(ldns_pkt_answerfrom(answer))))) {
+		ldns_cache_entry_free(entry);
+		return LDNS_STATUS_MEM_ERR;
+	}
+	memcpy(entry->key, key, key_len);
+	entry->key_len = key_len;
+	entry->hash = hash;
+	entry->ttl = ttl;
+	entry->stored = time(NULL);
+	entry->size = sizeof(*entry) + key_len + entry->wire_len;
+
+	ldns_cache_lock(shard);
+	if (entry->size > shard->max_size) {
+		ldns_cache_unlock(shard);
+		ldns_cache_entry_free(entry);
+		return LDNS_STATUS_ERR;
+	}
+	if ((old = *ldns_cache_find(shard, hash, key, key_len))) {
+		ldns_cache_remove(shard, old);
+	}
+	ldns_cache_make_room(shard, entry->size);
+	if (shard->stats.entries >= 2 * shard->nbuckets) {
+		ldns_cache_grow(shard);
+	}
+	entry->next = shard->buckets[hash & (shard->nbuckets - 1)];
+	shard->buckets[hash & (shard->nbuckets - 1)] = entry;
+
+	/* Just behind the hand, so the hand comes by last */
+	if (!shard->hand) {
+		entry->clock_prev = entry->clock_next = entry;
+		shard->hand = entry;
+	} else {
+		entry->clock_next = shard->hand;
+		entry->clock_prev = shard->hand->clock_prev;
+		entry->clock_prev->clock_next = entry;
+		shard->hand->clock_prev = entry;
+	}
+	shard->stats.entries++;
+	shard->stats.bytes += entry->size;
+	shard->stats.stores++;
+	ldns_cache_unlock(shard);
+	return LDNS_STATUS_OK;
+}
+
+void
+ldns_cache_get_stats(ldns_cache *cache, ldns_cache_stats *stats)
+{
+	size_t i;
+	ldns_cache_shard *shard;
+
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i < LDNS_CACHE_SHARDS; i++) {
+		shard = &cache->shards[i];
+		ldns_cache_lock(shard);
+		stats->hits       += shard->stats.hits;
+		stats->misses     += shard->stats.misses;
+		stats->prefetches += shard->stats.prefetches;
+		stats->stores     += shard->stats.stores;
+		stats->evictions  += shard->stats.evictions;
+		stats->expired    += shard->stats.expired;
+		stats->entries    += shard->stats.entries;
+		stats->bytes      += shard->stats.bytes;
+		ldns_cache_unlock(shard);
+	}
+	ldns_cache_denial_lock(cache);
+	stats->denials     = cache->denials;
+	stats->synthesized = cache->synthesized;
+	stats->bytes      += cache->denial_bytes;
+	ldns_cache_denial_unlock(cache);
+}
+
+/* Collects the RRSIGs in list over the RRset of type at owner */
+static ldns_rr_list *
+ldns_cache_rrsigs(const ldns_rr_list *list, const ldns_rdf *owner,
+		ldns_rr_type type)
+{
+	ldns_rr_list *rrsigs;
+	ldns_rr *rr, *clone;
+	size_t i;
+
+	if (!(rrsigs = ldns_rr_list_new())) {
+		return NULL;
+	}
+	for (i = 0; i < ldns_rr_list_rr_count(list); i++) {
+		rr = ldns_rr_list_rr(list, i);
+		if (ldns_rr_get_type(rr) != LDNS_RR_TYPE_RRSIG
+		    || ldns_rdf2rr_type(ldns_rr_rrsig_typecovered(rr)) != type
+		    || ldns_dname_compare(ldns_rr_owner(rr), owner) != 0) {
+			continue;
+		}
+		if (!(clone = ldns_rr_clone(rr))
+		    || !ldns_rr_list_push_rr(rrsigs, clone)) {
+			ldns_rr_free(clone);
+			ldns_rr_list_deep_free(rrsigs);
+			return NULL;
+		}
+	}
+	return rrsigs;
+}
+
+static size_t
+ldns_cache_rrs_size(const ldns_rr *rr, const ldns_rr_list *rrsigs)
+{
+	size_t size = ldns_rr_uncompressed_size(rr), i;
+
+	for (i = 0; i < ldns_rr_list_rr_count(rrsigs); i++) {
+		size += ldns_rr_uncompressed_size(ldns_rr_list_rr(rrsigs, i));
+	}
+	return size;
+}
+
+/* Finds or adds the zone of soa, and sets its SOA */
+static ldns_status
+ldns_cache_denial_zone(ldns_cache *cache, const ldns_rr *soa,
+		const ldns_rr_list *authority, uint32_t ttl, time_t now,
+		ldns_cache_zone **zone_r)
+{
+	ldns_cache_zone *zone;
+	ldns_rr *soa_clone;
+	ldns_rr_list *soa_rrsigs;
+
+	if (!(zone = (ldns_cache_zone *)ldns_rbtree_search(&cache->zones,
+					ldns_rr_owner(soa)))) {
+		if (!(zone = LDNS_CALLOC(ldns_cache_zone, 1))) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		if (!(zone->name = ldns_rdf_clone(ldns_rr_owner(soa)))) {
+			LDNS_FREE(zone);
+			return LDNS_STATUS_MEM_ERR;
+		}
+		ldns_dname2canonical(zone->name);
+		zone->node.key = zone->name;
+		ldns_rbtree_init(&zone->nsecs, ldns_dname_compare_v);
+		ldns_rbtree_init(&zone->nsec3s, ldns_cache_hash_cmp);
+		(void) ldns_rbtree_insert(&cache->zones, &zone->node);
+	}
+	if (!(soa_clone = ldns_rr_clone(soa))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (!(soa_rrsigs = ldns_cache_rrsigs(authority, ldns_rr_owner(soa),
+					LDNS_RR_TYPE_SOA))) {
+		ldns_rr_free(soa_clone);
+		return LDNS_STATUS_MEM_ERR;
+	}
+	cache->denial_bytes -= zone->size;
+	ldns_rr_free(zone->soa);
+	ldns_rr_list_deep_free(zone->soa_rrsigs);
+	zone->soa = soa_clone;
+	zone->soa_rrsigs = soa_rrsigs;
+	zone->soa_expires = now + ttl;
+	zone->size = sizeof(*zone) + ldns_rdf_size(zone->name)
+		   + ldns_cache_rrs_size(soa_clone, soa_rrsigs);
+	cache->denial_bytes += zone->size;
+	*zone_r = zone;
+	return LDNS_STATUS_OK;
+}
+
+/* Sets the owner and next hashes of NSEC3 d, and makes its parameters
+ * those of zone.  Returns false when it is not a proper NSEC3. */
+static bool
+ldns_cache_denial_nsec3(ldns_cache *cache, ldns_cache_zone *zone,
+		ldns_cache_denial *d)
+{
+	const ldns_rdf *salt = ldns_nsec3_salt(d->rr);
+	const ldns_rdf *next = ldns_nsec3_next_owner(d->rr);
+
+	if (!salt || !next || ldns_rdf_size(salt) < 1
+	    || ldns_rdf_size(next) < 1
+	    || ldns_rdf_data(next)[0] != ldns_rdf_size(next) - 1
+	    || !(d->hash_len = ldns_cache_hash_label(
+			    ldns_rdf_data(ldns_rr_owner(d->rr)), d->hash))
+	    || d->hash_len != ldns_rdf_data(next)[0]) {
+		return false;
+	}
+	memcpy(d->next, ldns_rdf_data(next) + 1, d->hash_len);
+
+	if (zone->nsec3s.count == 0
+	    || zone->nsec3_algorithm != ldns_nsec3_algorithm(d->rr)
+	    || zone->nsec3_iterations != ldns_nsec3_iterations(d->rr)
+	    || memcmp(zone->nsec3_salt, ldns_rdf_data(salt),
+		    ldns_rdf_size(salt)) != 0) {
+		/* New parameters replace the records with the old ones */
+		while (zone->nsec3s.count > 0) {
+			ldns_cache_denial_remove(cache, &zone->nsec3s,
+				(ldns_cache_denial *)zone->nsec3s.root->key);
+		}
+		zone->nsec3_algorithm = ldns_nsec3_algorithm(d->rr);
+		zone->nsec3_iterations = ldns_nsec3_iterations(d->rr);
+		memcpy(zone->nsec3_salt, ldns_rdf_data(salt),
+				ldns_rdf_size(salt));
+	}
+	return true;
+}
+
+ldns_status
+ldns_cache_store_denial(ldns_cache *cache, const ldns_pkt *answer)
+{
+	const ldns_rr_list *authority;
+	const ldns_rr *rr, *soa = NULL;
+	ldns_cache_zone *zone;
+	ldns_cache_denial *d, *old;
+	ldns_rbtree_t *tree;
+	uint32_t ttl, minimum;
+	size_t i, stored = 0;
+	bool expired = false;
+	ldns_status s;
+	time_t now;
+
+	if (!cache || !answer) {
+		return LDNS_STATUS_ERR;
+	}
+	authority = ldns_pkt_authority(answer);
+	for (i = 0; !soa && i < ldns_rr_list_rr_count(authority); i++) {
+		rr = ldns_rr_list_rr(authority, i);
+		if (ldns_rr_get_type(rr) == LDNS_RR_TYPE_SOA
+		    && ldns_rr_rd_count(rr) == 7) {
+			soa = rr;
+		}
+	}
+	if (!soa) {
+		return LDNS_STATUS_ERR;
+	}
+	/* RFC 9077: no longer than the negative TTL of the zone */
+	ttl = ldns_rr_ttl(soa);
+	minimum = ldns_rdf2native_int32(ldns_rr_rdf(soa, 6));
+	if (minimum < ttl) {
+		ttl = minimum;
+	}
+	if (ttl > LDNS_CACHE_MAX_NEG_TTL) {
+		ttl = LDNS_CACHE_MAX_NEG_TTL;
+	}
+	if (ttl == 0) {
+		return LDNS_STATUS_ERR;
+	}
+	now = time(NULL);
+
+	ldns_cache_denial_lock(cache);
+	if ((s = ldns_cache_denial_zone(cache, soa, authority, ttl, now,
+					&zone)) != LDNS_STATUS_OK) {
+		ldns_cache_denial_unlock(cache);
+		return s;
+	}
+	for (i = 0; i < ldns_rr_list_rr_count(authority); i++) {
+		rr = ldns_rr_list_rr(authority, i);
+		if ((ldns_rr_get_type(rr) != LDNS_RR_TYPE_NSEC
+		     && ldns_rr_get_type(rr) != LDNS_RR_TYPE_NSEC3)
+		    || !ldns_cache_is_ancestor(zone->name, ldns_rr_owner(rr))
+		    || ldns_rr_ttl(rr) == 0) {
+			continue;
+		}
+		if (!(d = LDNS_CALLOC(ldns_cache_denial, 1))) {
+			s = LDNS_STATUS_MEM_ERR;
+			break;
+		}
+		if (!(d->rr = ldns_rr_clone(rr))
+		    || !(d->rrsigs = ldns_cache_rrsigs(authority,
+				    ldns_rr_owner(rr), ldns_rr_get_type(rr)))) {
+			ldns_cache_denial_free(&d->node, NULL);
+			s = LDNS_STATUS_MEM_ERR;
+			break;
+		}
+		/* Validated records come with their signatures */
+		if (ldns_rr_list_rr_count(d->rrsigs) == 0) {
+			ldns_cache_denial_free(&d->node, NULL);
+			continue;
+		}
+		ldns_dname2canonical(ldns_rr_owner(d->rr));
+		if (ldns_rr_get_type(rr) == LDNS_RR_TYPE_NSEC) {
+			tree = &zone->nsecs;
+			d->node.key = ldns_rr_owner(d->rr);
+		} else if (ldns_cache_denial_nsec3(cache, zone, d)) {
+			tree = &zone->nsec3s;
+			d->node.key = d;
+		} else {
+			ldns_cache_denial_free(&d->node, NULL);
+			continue;
+		}
+		d->expires = now + (ldns_rr_ttl(rr) < ttl
+				    ? ldns_rr_ttl(rr) : ttl);
+		d->size = sizeof(*d) + ldns_cache_rrs_size(d->rr, d->rrsigs);
+
+		if ((old = (ldns_cache_denial *)ldns_rbtree_search(tree,
+						d->node.key))) {
+			ldns_cache_denial_remove(cache, tree, old);
+		}
+		if (cache->denial_bytes + d->size > cache->denial_max_size
+		    && !expired) {
+			ldns_cache_denials_expire(cache, now, zone);
+			expired = true;
+		}
+		if (cache->denial_bytes + d->size > cache->denial_max_size) {
+			ldns_cache_denial_free(&d->node, NULL);
+			continue;
+		}
+		(void) ldns_rbtree_insert(tree, &d->node);
+		cache->denial_bytes += d->size;
+		cache->denials++;
+		stored++;
+	}
+	if (zone->nsecs.count == 0 && zone->nsec3s.count == 0) {
+		ldns_cache_zone_remove(cache, zone);
+	}
+	ldns_cache_denial_unlock(cache);
+	if (s != LDNS_STATUS_OK) {
+		return s;
+	}
+	return stored > 0 ? LDNS_STATUS_OK : LDNS_STATUS_ERR;
+}
@@ -0,0 +1,358 @@
+/*
+ * dnskey_cache.c
+ *
+ * index of DNSKEY RRs for signature verification
+ *
+ * a Net::DNS like library for C
+ *
+ * (c) NLnet Labs, 2024
+ *
+ * See the file LICENSE for the license
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+/* All keys with the same owner, algorithm and key tag */
+typedef struct ldns_dnskey_cache_node {
+	/* key points to this struct */
+	ldns_rbnode_t node;
+	const ldns_rdf *owner;
+	uint16_t keytag;
+	uint8_t algorithm;
+	ldns_dnskey_cache_key *keys;
+} ldns_dnskey_cache_node;
+
+struct ldns_struct_dnskey_cache
+{
+	ldns_rbtree_t *tree;
+	size_t count;
+};
+
+static int
+ldns_dnskey_cache_cmp(const void *a, const void *b)
+{
+	const ldns_dnskey_cache_node *na = a, *nb = b;
+
+	/* cheap comparisons first */
+	if (na->keytag != nb->keytag) {
+		return na->keytag < nb->keytag ? -1 : 1;
+	}
+	if (na->algorithm != nb->algorithm) {
+		return na->algorithm < nb->algorithm ? -1 : 1;
+	}
+	return ldns_dname_compare(na->owner, nb->owner);
+}
+
+ldns_dnskey_cache *
+ldns_dnskey_cache_new(void)
+{
+	ldns_dnskey_cache *cache = LDNS_MALLOC(ldns_dnskey_cache);
+
+	if (!cache) {
+		return NULL;
+	}
+	cache->tree = ldns_rbtree_create(ldns_dnskey_cache_cmp);
+	if (!cache->tree) {
+		LDNS_FREE(cache);
+		return NULL;
+	}
+	cache->count = 0;
+	return cache;
+}
+
+static void
+ldns_dnskey_cache_node_free(ldns_rbnode_t *node, void *arg)
+{
+	ldns_dnskey_cache_key *key, *next;
+
+	(void) arg;
+	for (key = ((ldns_dnskey_cache_node *)node)->keys; key; key = next) {
+		next = key->next;
+#ifdef HAVE_SSL
+		if (key->pkey) {
+			EVP_PKEY_free(key->pkey);
+		}
+#endif
+		ldns_rr_free(key->rr);
+		LDNS_FREE(key);
+	}
+	LDNS_FREE(node);
+}
+
+void
+ldns_dnskey_cache_free(ldns_dnskey_cache *cache)
+{
+	if (!cache) {
+		return;
+	}
+	ldns_traverse_postorder(cache->tree, ldns_dnskey_cache_node_free, NULL);
+	ldns_rbtree_free(cache->tree);
+	LDNS_FREE(cache);
+}
+
+ldns_dnskey_cache_key *
+ldns_dnskey_cache_lookup(const ldns_dnskey_cache *cache,
+		const ldns_rdf *owner, uint8_t algorithm, uint16_t keytag)
+{
+	ldns_dnskey_cache_node search;
+	ldns_rbnode_t *node;
+
+	if (!cache || !owner) {
+		return NULL;
+	}
+	search.owner = owner;
+	search.algorithm = algorithm;
+	search.keytag = keytag;
+	node = ldns_rbtree_search(cache->tree, &search);
+	return node ? ((ldns_dnskey_cache_node *)node)->keys : NULL;
+}
+
+ldns_dnskey_cache_key *
+ldns_dnskey_cache_lookup_rrsig(const ldns_dnskey_cache *cache,
+		const ldns_rr *rrsig)
+{
+	if (!rrsig || !ldns_rr_rrsig_signame(rrsig)
+	||  !ldns_rr_rrsig_algorithm(rrsig) || !ldns_rr_rrsig_keytag(rrsig)) {
+		return NULL;
+	}
+	return ldns_dnskey_cache_lookup(cache, ldns_rr_rrsig_signame(rrsig),
+			ldns_rdf2native_int8(ldns_rr_rrsig_algorithm(rrsig)),
+			ldns_rdf2native_int16(ldns_rr_rrsig_keytag(rrsig)));
+}
+
+ldns_status
+ldns_dnskey_cache_add_rr(ldns_dnskey_cache *cache, const ldns_rr *key)
+{
+	ldns_dnskey_cache_node search, *node;
+	ldns_dnskey_cache_key *entry, **last;
+	uint16_t keytag;
+	uint8_t algorithm;
+
+	if (!cache || !key) {
+		return LDNS_STATUS_NULL;
+	}
+	if (ldns_rr_get_type(key) != LDNS_RR_TYPE_DNSKEY
+	||  ldns_rr_rd_count(key) < 4 || !ldns_rr_rdf(key, 2)) {
+		return LDNS_STATUS_CRYPTO_NO_DNSKEY;
+	}
+	keytag = ldns_calc_keytag(key);
+	algorithm = ldns_rdf2native_int8(ldns_rr_rdf(key, 2));
+
+	search.owner = ldns_rr_owner(key);
+	search.keytag = keytag;
+	search.algorithm = algorithm;
+	node = (ldns_dnskey_cache_node *)ldns_rbtree_search(cache->tree,
+			&search);
+	if (node) {
+		for (last = &node->keys; *last; last = &(*last)->next) {
+			if (ldns_rr_compare(key, (*last)->rr) == 0) {
+				return LDNS_STATUS_OK;
+			}
+		}
+	}
+	entry = LDNS_MALLOC(ldns_dnskey_cache_key);
+	if (!entry) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (!(entry->rr = ldns_rr_clone(key))) {
+		LDNS_FREE(entry);
+		return LDNS_STATUS_MEM_ERR;
+	}
+	entry->keytag = keytag;
+	entry->algorithm = algorithm;
+	entry->next = NULL;
+#ifdef HAVE_SSL
+	entry->pkey = NULL;
+	entry->md = NULL;
+#endif
+	entry->parsed = false;
+	entry->status = LDNS_STATUS_OK;
+
+	if (!node) {
+		node = LDNS_MALLOC(ldns_dnskey_cache_node);
+		if (!node) {
+			ldns_rr_free(entry->rr);
+			LDNS_FREE(entry);
+			return LDNS_STATUS_MEM_ERR;
+		}
+		node->node.key = node;
+		node->owner = ldns_rr_owner(entry->rr);
+		node->keytag = keytag;
+		node->algorithm = algorithm;
+		node->keys = NULL;
+		(void) ldns_rbtree_insert(cache->tree, &node->node);
+		last = &node->keys;
+	}
+	*last = entry;
+	cache->count++;
+	return LDNS_STATUS_OK;
+}
+
+ldns_status
+ldns_dnskey_cache_add_rr_list(ldns_dnskey_cache *cache,
+		const ldns_rr_list *keys)
+{
+	ldns_status status;
+	size_t i;
+
+	for (i = 0; i < ldns_rr_list_rr_count(keys); i++) {
+		status = ldns_dnskey_cache_add_rr(cache,
+				ldns_rr_list_rr(keys, i));
+		if (status != LDNS_STATUS_OK
+		&&  status != LDNS_STATUS_CRYPTO_NO_DNSKEY) {
+			return status;
+		}
+	}
+	return LDNS_STATUS_OK;
+}
+
+size_t
+ldns_dnskey_cache_count(const ldns_dnskey_cache *cache)
+{
+	return cache ? cache->count : 0;
+}
+
+#ifdef HAVE_SSL
+/*
+ * Converts the public key of a DNSKEY RR into an EVP_PKEY, and gives the
+ * digest to use with it in *md (NULL for EdDSA).  The failure reasons
+ * are those ldns_verify_rrsig_buffers_raw() would have returned.
+ */
+static EVP_PKEY *
+ldns_dnskey_rr2pkey(const ldns_rr *key, const EVP_MD **md,
+		ldns_status *status)
+{
+	unsigned char *data;
+	size_t len;
+	uint8_t algo;
+	EVP_PKEY *evp_key = NULL;
+
+	*md = NULL;
+	if (ldns_rr_rd_count(key) < 4 || !ldns_rr_rdf(key, 2)
+	||  !ldns_rr_rdf(key, 3)) {
+		*status = LDNS_STATUS_MISSING_RDATA_FIELDS_KEY;
+		return NULL;
+	}
+	algo = ldns_rdf2native_int8(ldns_rr_rdf(key, 2));
+	data = ldns_rdf_data(ldns_rr_rdf(key, 3));
+	len  = ldns_rdf_size(ldns_rr_rdf(key, 3));
+	*status = LDNS_STATUS_CRYPTO_BOGUS;
+
+	switch (algo) {
+#ifdef USE_DSA
+	case LDNS_DSA:
+	case LDNS_DSA_NSEC3:
+		*status = LDNS_STATUS_SSL_ERR;
+		if ((evp_key = EVP_PKEY_new()) && !EVP_PKEY_assign_DSA(
+				evp_key, ldns_key_buf2dsa_raw(data, len))) {
+			EVP_PKEY_free(evp_key);
+			evp_key = NULL;
+		}
+# ifdef HAVE_EVP_DSS1
+		*md = EVP_dss1();
+# else
+		*md = EVP_sha1();
+# endif
+		break;
+#endif
+	case LDNS_RSAMD5:
+	case LDNS_RSASHA1:
+	case LDNS_RSASHA1_NSEC3:
+#ifdef USE_SHA2
+	case LDNS_RSASHA256:
+	case LDNS_RSASHA512:
+#endif
+		*status = LDNS_STATUS_SSL_ERR;
+		if ((evp_key = EVP_PKEY_new()) && !EVP_PKEY_assign_RSA(
+				evp_key, ldns_key_buf2rsa_raw(data, len))) {
+			EVP_PKEY_free(evp_key);
+			evp_key = NULL;
+		}
+		switch (algo) {
+		case LDNS_RSAMD5:	*md = EVP_md5();
+					break;
+#ifdef USE_SHA2
+		case LDNS_RSASHA256:	*md = EVP_sha256();
+					break;
+		case LDNS_RSASHA512:	*md = EVP_sha512();
+					break;
+#endif
+		default:		*md = EVP_sha1();
+					break;
+		}
+		break;
+#ifdef USE_GOST
+	case LDNS_ECC_GOST:
+		(void) ldns_key_EVP_load_gost_id();
+		evp_key = ldns_gost2pkey_raw(data, len);
+		*md = EVP_get_digestbyname("md_gost94");
+		break;
+#endif
+#ifdef USE_ECDSA
+	case LDNS_ECDSAP256SHA256:
+	case LDNS_ECDSAP384SHA384:
+		evp_key = ldns_ecdsa2pkey_raw(data, len, algo);
+		*md = algo == LDNS_ECDSAP256SHA256 ? EVP_sha256() : EVP_sha384();
+		break;
+#endif
+#ifdef USE_ED25519
+	case LDNS_ED25519:
+		evp_key = ldns_ed255192pkey_raw(data, len);
+		break;
+#endif
+#ifdef USE_ED448
+	case LDNS_ED448:
+		evp_key = ldns_ed4482pkey_raw(data, len);
+		break;
+#endif
+	default:
+		*status = LDNS_STATUS_CRYPTO_UNKNOWN_ALGO;
+		break;
+	}
+	if (evp_key) {
+		*status = LDNS_STATUS_OK;
+	}
+	return evp_key;
+}
+
+EVP_PKEY *
+ldns_dnskey_cache_key_pkey(ldns_dnskey_cache_key *key, const EVP_MD **md,
+		ldns_status *status)
+{
+	if (!key->parsed) {
+		key->pkey = ldns_dnskey_rr2pkey(key->rr, &key->md, &key->status);
+		key->parsed = true;
+	}
+	if (md) {
+		*md = key->md;
+	}
+	if (status) {
+		*status = key->status;
+	}
+	return key->pkey;
+}
+#endif /* HAVE_SSL */
+
+void
+ldns_dnskey_cache_prepare(ldns_dnskey_cache *cache)
+{
+#ifdef HAVE_SSL
+	ldns_rbnode_t *node;
+	ldns_dnskey_cache_key *key;
+
+	if (!cache) {
+		return;
+	}
+	for (node = ldns_rbtree_first(cache->tree); node != LDNS_RBTREE_NULL;
+			node = ldns_rbtree_next(node)) {
+		for (key = ((ldns_dnskey_cache_node *)node)->keys; key;
+				key = key->next) {
+			(void) ldns_dnskey_cache_key_pkey(key, NULL, NULL);
+		}
+	}
+#else
+	(void) cache;
+#endif
+}
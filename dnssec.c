@@ -85,6 +85,15 @@ ldns_dnssec_get_dnskey_for_rrsig(const ldns_rr *rrsig,
 	return NULL;
 }
 
+ldns_rr *
+ldns_dnssec_get_dnskey_for_rrsig_keycache(const ldns_rr *rrsig,
+		const ldns_dnskey_cache *keys)
+{
+	ldns_dnskey_cache_key *key = ldns_dnskey_cache_lookup_rrsig(keys, rrsig);
+
+	return key ? key->rr : NULL;
+}
+
 ldns_rdf *
 ldns_nsec_get_bitmap(const ldns_rr *nsec) {
 	if (ldns_rr_get_type(nsec) == LDNS_RR_TYPE_NSEC) {
@@ -583,7 +592,7 @@ ldns_key_rr2ds(const ldns_rr *key, ldns_hash h)
 #endif
 	}
 
-	data_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	data_buf = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	if (!data_buf) {
 		LDNS_FREE(digest);
 		ldns_rr_free(ds);
@@ -600,7 +609,7 @@ ldns_key_rr2ds(const ldns_rr *key, ldns_hash h)
 	/* copy the algorithm field */
 	if ((tmp = ldns_rr_rdf(key, 2)) == NULL) {
 		LDNS_FREE(digest);
-		ldns_buffer_free(data_buf);
+		ldns_buffer_release(data_buf);
 		ldns_rr_free(ds);
 		return NULL;
 	} else {
@@ -620,7 +629,7 @@ ldns_key_rr2ds(const ldns_rr *key, ldns_hash h)
 	ldns_dname2canonical(tmp);
 	if (ldns_rdf2buffer_wire(data_buf, tmp) != LDNS_STATUS_OK) {
 		LDNS_FREE(digest);
-		ldns_buffer_free(data_buf);
+		ldns_buffer_release(data_buf);
 		ldns_rr_free(ds);
 		ldns_rdf_deep_free(tmp);
 		return NULL;
@@ -631,7 +640,7 @@ ldns_key_rr2ds(const ldns_rr *key, ldns_hash h)
 	if (ldns_rr_rdata2buffer_wire(data_buf,
 							(ldns_rr*)key) != LDNS_STATUS_OK) {
 		LDNS_FREE(digest);
-		ldns_buffer_free(data_buf);
+		ldns_buffer_release(data_buf);
 		ldns_rr_free(ds);
 		return NULL;
 	}
@@ -662,7 +671,7 @@ ldns_key_rr2ds(const ldns_rr *key, ldns_hash h)
 				(unsigned int) ldns_buffer_position(data_buf),
 				(unsigned char *) digest, md)) {
 			LDNS_FREE(digest);
-			ldns_buffer_free(data_buf);
+			ldns_buffer_release(data_buf);
 			ldns_rr_free(ds);
 			return NULL;
 		}
@@ -686,7 +695,7 @@ ldns_key_rr2ds(const ldns_rr *key, ldns_hash h)
 	}
 
 	LDNS_FREE(digest);
-	ldns_buffer_free(data_buf);
+	ldns_buffer_release(data_buf);
 	return ds;
 }
 
@@ -876,6 +885,21 @@ ldns_dnssec_create_nsec3(const ldns_dnssec_name *from,
 					uint16_t iterations,
 					uint8_t salt_length,
 					const uint8_t *salt)
+{
+	return ldns_dnssec_create_nsec3_cached(from, to, zone_name, algorithm,
+			flags, iterations, salt_length, salt, NULL);
+}
+
+ldns_rr *
+ldns_dnssec_create_nsec3_cached(const ldns_dnssec_name *from,
+					const ldns_dnssec_name *to,
+					const ldns_rdf *zone_name,
+					uint8_t algorithm,
+					uint8_t flags,
+					uint16_t iterations,
+					uint8_t salt_length,
+					const uint8_t *salt,
+					ldns_nsec3_cache *cache)
 {
 	ldns_rr *nsec_rr;
 	ldns_rr_type types[65536];
@@ -890,7 +914,8 @@ ldns_dnssec_create_nsec3(const ldns_dnssec_name *from,
 
 	nsec_rr = ldns_rr_new_frm_type(LDNS_RR_TYPE_NSEC3);
 	ldns_rr_set_owner(nsec_rr,
-	                  ldns_nsec3_hash_name(ldns_dnssec_name_name(from),
+	                  ldns_nsec3_cache_hash_name(cache,
+	                  ldns_dnssec_name_name(from),
 	                  algorithm,
 	                  iterations,
 	                  salt_length,
@@ -266,7 +266,7 @@ ldns_sign_public(ldns_rr_list *rrset, ldns_key_list *keys)
 		if (!ldns_key_use(ldns_key_list_key(keys, key_count))) {
 			continue;
 		}
-		sign_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+		sign_buf = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 		if (!sign_buf) {
 			ldns_rr_list_free(rrset_clone);
 			ldns_rr_list_free(signatures);
@@ -288,7 +288,7 @@ ldns_sign_public(ldns_rr_list *rrset, ldns_key_list *keys)
 
 			if (ldns_rrsig2buffer_wire(sign_buf, current_sig)
 			    != LDNS_STATUS_OK) {
-				ldns_buffer_free(sign_buf);
+				ldns_buffer_release_clear(sign_buf);
 				/* ERROR */
 				ldns_rr_list_deep_free(rrset_clone);
 				ldns_rr_free(current_sig);
@@ -299,7 +299,7 @@ ldns_sign_public(ldns_rr_list *rrset, ldns_key_list *keys)
 			/* add the rrset in sign_buf */
 			if (ldns_rr_list2buffer_wire(sign_buf, rrset_clone)
 			    != LDNS_STATUS_OK) {
-				ldns_buffer_free(sign_buf);
+				ldns_buffer_release_clear(sign_buf);
 				ldns_rr_list_deep_free(rrset_clone);
 				ldns_rr_free(current_sig);
 				ldns_rr_list_deep_free(signatures);
@@ -310,6 +310,7 @@ ldns_sign_public(ldns_rr_list *rrset, ldns_key_list *keys)
 
 			if (!b64rdf) {
 				/* signing went wrong */
+				ldns_buffer_release_clear(sign_buf);
 				ldns_rr_list_deep_free(rrset_clone);
 				ldns_rr_free(current_sig);
 				ldns_rr_list_deep_free(signatures);
@@ -321,7 +322,7 @@ ldns_sign_public(ldns_rr_list *rrset, ldns_key_list *keys)
 			/* push the signature to the signatures list */
 			ldns_rr_list_push_rr(signatures, current_sig);
 		}
-		ldns_buffer_free(sign_buf); /* restart for the next key */
+		ldns_buffer_release_clear(sign_buf); /* restart for the next key */
 	}
 	ldns_rr_list_deep_free(rrset_clone);
 
@@ -342,7 +343,7 @@ ldns_sign_public_dsa(ldns_buffer *to_sign, DSA *key)
 	uint8_t *data;
 	size_t pad;
 
-	b64sig = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	b64sig = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	if (!b64sig) {
 		return NULL;
 	}
@@ -350,19 +351,19 @@ ldns_sign_public_dsa(ldns_buffer *to_sign, DSA *key)
 	sha1_hash = SHA1((unsigned char*)ldns_buffer_begin(to_sign),
 				  ldns_buffer_position(to_sign), md);
 	if (!sha1_hash) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		return NULL;
 	}
 
 	sig = DSA_do_sign(sha1_hash, SHA_DIGEST_LENGTH, key);
         if(!sig) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		return NULL;
         }
 
 	data = LDNS_XMALLOC(uint8_t, 1 + 2 * SHA_DIGEST_LENGTH);
         if(!data) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
                 DSA_SIG_free(sig);
 		return NULL;
         }
@@ -390,7 +391,7 @@ ldns_sign_public_dsa(ldns_buffer *to_sign, DSA *key)
 								 1 + 2 * SHA_DIGEST_LENGTH,
 								 data);
 
-	ldns_buffer_free(b64sig);
+	ldns_buffer_release(b64sig);
 	LDNS_FREE(data);
         DSA_SIG_free(sig);
 
@@ -453,7 +454,7 @@ ldns_sign_public_evp(ldns_buffer *to_sign,
 	int r;
 
 	siglen = 0;
-	b64sig = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	b64sig = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	if (!b64sig) {
 		return NULL;
 	}
@@ -473,7 +474,7 @@ ldns_sign_public_evp(ldns_buffer *to_sign,
 #endif
 	if(!md_type) {
 		/* unknown message digest */
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		return NULL;
 	}
 
@@ -484,7 +485,7 @@ ldns_sign_public_evp(ldns_buffer *to_sign,
 	if(ctx) EVP_MD_CTX_init(ctx);
 #endif
 	if(!ctx) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		return NULL;
 	}
 
@@ -518,7 +519,7 @@ ldns_sign_public_evp(ldns_buffer *to_sign,
 		}
 	}
 	if(r != 1) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		EVP_MD_CTX_destroy(ctx);
 		return NULL;
 	}
@@ -564,7 +565,7 @@ ldns_sign_public_evp(ldns_buffer *to_sign,
 		sigdata_rdf = ldns_rdf_new_frm_data(LDNS_RDF_TYPE_B64, siglen,
 									 ldns_buffer_begin(b64sig));
 	}
-	ldns_buffer_free(b64sig);
+	ldns_buffer_release(b64sig);
 	EVP_MD_CTX_destroy(ctx);
 	return sigdata_rdf;
 }
@@ -580,7 +581,7 @@ ldns_sign_public_rsasha1(ldns_buffer *to_sign, RSA *key)
 	int result;
 
 	siglen = 0;
-	b64sig = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	b64sig = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	if (!b64sig) {
 		return NULL;
 	}
@@ -588,7 +589,7 @@ ldns_sign_public_rsasha1(ldns_buffer *to_sign, RSA *key)
 	sha1_hash = SHA1((unsigned char*)ldns_buffer_begin(to_sign),
 				  ldns_buffer_position(to_sign), md);
 	if (!sha1_hash) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		return NULL;
 	}
 
@@ -596,13 +597,13 @@ ldns_sign_public_rsasha1(ldns_buffer *to_sign, RSA *key)
 				   (unsigned char*)ldns_buffer_begin(b64sig),
 				   &siglen, key);
 	if (result != 1) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		return NULL;
 	}
 
 	sigdata_rdf = ldns_rdf_new_frm_data(LDNS_RDF_TYPE_B64, siglen, 
 								 ldns_buffer_begin(b64sig));
-	ldns_buffer_free(b64sig); /* can't free this buffer ?? */
+	ldns_buffer_release(b64sig);
 	return sigdata_rdf;
 }
 
@@ -615,7 +616,7 @@ ldns_sign_public_rsamd5(ldns_buffer *to_sign, RSA *key)
 	ldns_rdf *sigdata_rdf;
 	ldns_buffer *b64sig;
 
-	b64sig = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	b64sig = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	if (!b64sig) {
 		return NULL;
 	}
@@ -623,7 +624,7 @@ ldns_sign_public_rsamd5(ldns_buffer *to_sign, RSA *key)
 	md5_hash = MD5((unsigned char*)ldns_buffer_begin(to_sign),
 				ldns_buffer_position(to_sign), md);
 	if (!md5_hash) {
-		ldns_buffer_free(b64sig);
+		ldns_buffer_release(b64sig);
 		return NULL;
 	}
 
@@ -633,7 +634,7 @@ ldns_sign_public_rsamd5(ldns_buffer *to_sign, RSA *key)
 
 	sigdata_rdf = ldns_rdf_new_frm_data(LDNS_RDF_TYPE_B64, siglen,
 								 ldns_buffer_begin(b64sig));
-	ldns_buffer_free(b64sig);
+	ldns_buffer_release(b64sig);
 	return sigdata_rdf;
 }
 #endif /* HAVE_SSL */
@@ -878,7 +879,8 @@ ldns_dnssec_zone_create_nsec3s_mkmap(ldns_dnssec_zone *zone,
 		uint16_t iterations,
 		uint8_t salt_length,
 		uint8_t *salt,
-		ldns_rbtree_t **map)
+		ldns_rbtree_t **map,
+		ldns_nsec3_cache *cache)
 {
 	ldns_rbnode_t *first_name_node;
 	ldns_rbnode_t *current_name_node;
@@ -939,14 +941,15 @@ ldns_dnssec_zone_create_nsec3s_mkmap(ldns_dnssec_zone *zone,
 			result == LDNS_STATUS_OK) {
 
 		current_name = (ldns_dnssec_name *) current_name_node->data;
-		nsec_rr = ldns_dnssec_create_nsec3(current_name,
+		nsec_rr = ldns_dnssec_create_nsec3_cached(current_name,
 		                                   NULL,
 		                                   zone->soa->name,
 		                                   algorithm,
 		                                   flags,
 		                                   iterations,
 		                                   salt_length,
-		                                   salt);
+		                                   salt,
+		                                   cache);
 		/* by default, our nsec based generator adds rrsigs
 		 * remove the bitmap for empty nonterminals */
 		if (!current_name->rrsets) {
@@ -1013,9 +1016,23 @@ ldns_dnssec_zone_create_nsec3s(ldns_dnssec_zone *zone,
 		uint8_t *salt)
 {
 	return ldns_dnssec_zone_create_nsec3s_mkmap(zone, new_rrs, algorithm,
-		       	flags, iterations, salt_length, salt, NULL);
+		       	flags, iterations, salt_length, salt, NULL, NULL);
 
 }
+
+ldns_status
+ldns_dnssec_zone_create_nsec3s_cached(ldns_dnssec_zone *zone,
+		ldns_rr_list *new_rrs,
+		uint8_t algorithm,
+		uint8_t flags,
+		uint16_t iterations,
+		uint8_t salt_length,
+		uint8_t *salt,
+		ldns_nsec3_cache *cache)
+{
+	return ldns_dnssec_zone_create_nsec3s_mkmap(zone, new_rrs, algorithm,
+		       	flags, iterations, salt_length, salt, NULL, cache);
+}
 #endif /* HAVE_SSL */
 
 ldns_dnssec_rrs *
@@ -1472,6 +1489,26 @@ ldns_dnssec_zone_sign_nsec3_flg_mkmap(ldns_dnssec_zone *zone,
 		uint8_t *salt,
 		int signflags,
 		ldns_rbtree_t **map)
+{
+	return ldns_dnssec_zone_sign_nsec3_flg_mkmap_cached(zone, new_rrs,
+		key_list, func, arg, algorithm, flags, iterations,
+		salt_length, salt, signflags, map, NULL);
+}
+
+ldns_status
+ldns_dnssec_zone_sign_nsec3_flg_mkmap_cached(ldns_dnssec_zone *zone,
+		ldns_rr_list *new_rrs,
+		ldns_key_list *key_list,
+		int (*func)(ldns_rr *, void *),
+		void *arg,
+		uint8_t algorithm,
+		uint8_t flags,
+		uint16_t iterations,
+		uint8_t salt_length,
+		uint8_t *salt,
+		int signflags,
+		ldns_rbtree_t **map,
+		ldns_nsec3_cache *cache)
 {
 	ldns_rr *nsec3, *nsec3param;
 	ldns_status result = LDNS_STATUS_OK;
@@ -1552,7 +1589,8 @@ ldns_dnssec_zone_sign_nsec3_flg_mkmap(ldns_dnssec_zone *zone,
 											iterations,
 											salt_length,
 											salt,
-											map);
+											map,
+											cache);
 			if (zonemd_added) {
 				ldns_dnssec_rrsets **rrsets_ref
 				    = &zone->soa->rrsets;
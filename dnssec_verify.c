@@ -14,6 +14,12 @@
 #include <openssl/rand.h>
 #include <openssl/err.h>
 #include <openssl/md5.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 ldns_dnssec_data_chain *
 ldns_dnssec_data_chain_new(void)
@@ -441,6 +447,199 @@ ldns_dnssec_build_data_chain(ldns_resolver *res,
 	return new_chain;
 }
 
+/* Adds a query for name and t to queries, unless it is already there */
+static ldns_status
+ldns_dnssec_prefetch_add(ldns_resolver *res, uint16_t qflags,
+		const ldns_rdf *name, ldns_rr_type t,
+		ldns_pkt ***queries, size_t *n, size_t *capacity)
+{
+	ldns_pkt **grown;
+	const ldns_rr *q;
+	size_t i;
+	ldns_status s;
+
+	for (i = 0; i < *n; i++) {
+		q = ldns_rr_list_rr(ldns_pkt_question((*queries)[i]), 0);
+		if (ldns_rr_get_type(q) == t
+		    && ldns_dname_compare(ldns_rr_owner(q), name) == 0) {
+			return LDNS_STATUS_OK;
+		}
+	}
+	if (*n == *capacity) {
+		if (!(grown = LDNS_XREALLOC(*queries, ldns_pkt *,
+						*capacity * 2 + 8))) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		*queries = grown;
+		*capacity = *capacity * 2 + 8;
+	}
+	s = ldns_resolver_prepare_query_pkt(&(*queries)[*n], res, name, t,
+			LDNS_RR_CLASS_IN, qflags);
+	if (s == LDNS_STATUS_OK) {
+		(*n)++;
+	}
+	return s;
+}
+
+/* Is there a key for name in anchors? */
+static bool
+ldns_dnssec_is_anchor(const ldns_rdf *name, const ldns_rr_list *anchors)
+{
+	size_t i;
+
+	for (i = 0; i < ldns_rr_list_rr_count(anchors); i++) {
+		if (ldns_dname_compare(ldns_rr_owner(
+				ldns_rr_list_rr(anchors, i)), name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * Fetches the DNSKEY and DS RRsets of the names and of all their
+ * ancestors, up to a name that has a key in anchors or the root, at once
+ * with ldns_send_bulk(), and stores the answers in the cache of the
+ * resolver.  The chain of trust is then built from the cache by the
+ * functions that would otherwise query one name after another.  When the
+ * resolver has no cache, it is given one for the time being, which is
+ * returned to be passed to ldns_dnssec_prefetch_done().
+ */
+static ldns_cache *
+ldns_dnssec_prefetch(ldns_resolver *res, uint16_t qflags,
+		const ldns_rdf * const *names, size_t n_names,
+		const ldns_rr_list *anchors)
+{
+	ldns_cache *cache = ldns_resolver_cache(res), *own = NULL;
+	ldns_pkt **queries = NULL, **answers = NULL, *cached;
+	ldns_rdf *name, *parent;
+	size_t n = 0, capacity = 0, i, j;
+	ldns_status s = LDNS_STATUS_OK;
+
+	/* ldns_send_bulk() does not do TSIG */
+	if (ldns_resolver_tsig_keyname(res)
+	    || ldns_resolver_nameserver_count(res) == 0) {
+		return NULL;
+	}
+	if (!cache) {
+		if (!(cache = own = ldns_cache_new(0))) {
+			return NULL;
+		}
+		ldns_resolver_set_cache(res, own);
+	}
+	for (i = 0; s == LDNS_STATUS_OK && i < n_names; i++) {
+		if (!names[i]
+		    || ldns_rdf_get_type(names[i]) != LDNS_RDF_TYPE_DNAME
+		    || !(name = ldns_rdf_clone(names[i]))) {
+			continue;
+		}
+		while (name) {
+			s = ldns_dnssec_prefetch_add(res, qflags, name,
+					LDNS_RR_TYPE_DNSKEY,
+					&queries, &n, &capacity);
+			if (s != LDNS_STATUS_OK
+			    || ldns_dname_label_count(name) == 0
+			    || ldns_dnssec_is_anchor(name, anchors)) {
+				break;
+			}
+			s = ldns_dnssec_prefetch_add(res, qflags, name,
+					LDNS_RR_TYPE_DS,
+					&queries, &n, &capacity);
+			if (s != LDNS_STATUS_OK) {
+				break;
+			}
+			parent = ldns_dname_left_chop(name);
+			ldns_rdf_deep_free(name);
+			name = parent;
+		}
+		ldns_rdf_deep_free(name);
+	}
+
+	/* Only ask what is not in the cache yet */
+	for (i = 0, j = 0; i < n; i++) {
+		if ((cached = ldns_cache_lookup(cache, queries[i]))) {
+			ldns_pkt_free(cached);
+			ldns_pkt_free(queries[i]);
+		} else {
+			queries[j++] = queries[i];
+		}
+	}
+	n = j;
+	if (n > 0 && (answers = LDNS_CALLOC(ldns_pkt *, n))) {
+		(void) ldns_send_bulk(answers, res, queries, n);
+		for (i = 0; i < n; i++) {
+			if (answers[i]) {
+				(void) ldns_cache_store(cache,
+						queries[i], answers[i]);
+				ldns_pkt_free(answers[i]);
+			}
+		}
+		LDNS_FREE(answers);
+	}
+	for (i = 0; i < n; i++) {
+		ldns_pkt_free(queries[i]);
+	}
+	LDNS_FREE(queries);
+	return own;
+}
+
+/* Takes away the cache ldns_dnssec_prefetch() gave the resolver */
+static void
+ldns_dnssec_prefetch_done(ldns_resolver *res, ldns_cache *own)
+{
+	if (own) {
+		ldns_resolver_set_cache(res, NULL);
+		ldns_cache_free(own);
+	}
+}
+
+/* The signer names of the RRSIGs in list */
+static const ldns_rdf **
+ldns_dnssec_signers(const ldns_rr_list *list, size_t *n)
+{
+	const ldns_rdf **signers;
+	const ldns_rr *rr;
+	size_t i;
+
+	*n = 0;
+	if (!(signers = LDNS_XMALLOC(const ldns_rdf *,
+					ldns_rr_list_rr_count(list) + 1))) {
+		return NULL;
+	}
+	for (i = 0; i < ldns_rr_list_rr_count(list); i++) {
+		rr = ldns_rr_list_rr(list, i);
+		if (ldns_rr_get_type(rr) == LDNS_RR_TYPE_RRSIG
+		    && ldns_rr_rrsig_signame(rr)) {
+			signers[(*n)++] = ldns_rr_rrsig_signame(rr);
+		}
+	}
+	return signers;
+}
+
+ldns_dnssec_data_chain *
+ldns_dnssec_build_data_chain_parallel(ldns_resolver *res,
+		uint16_t qflags, const ldns_rr_list *rrset,
+		const ldns_pkt *pkt, ldns_rr *orig_rr)
+{
+	ldns_dnssec_data_chain *chain;
+	ldns_rr_list *rrsigs;
+	const ldns_rdf **signers = NULL;
+	ldns_cache *own = NULL;
+	size_t n = 0;
+
+	rrsigs = pkt ? ldns_pkt_rr_list_by_type(pkt, LDNS_RR_TYPE_RRSIG,
+			LDNS_SECTION_ANY_NOQUESTION) : NULL;
+	if (rrsigs && (signers = ldns_dnssec_signers(rrsigs, &n))) {
+		own = ldns_dnssec_prefetch(res, qflags, signers, n,
+				ldns_resolver_dnssec_anchors(res));
+	}
+	chain = ldns_dnssec_build_data_chain(res, qflags, rrset, pkt, orig_rr);
+	ldns_dnssec_prefetch_done(res, own);
+	LDNS_FREE(signers);
+	ldns_rr_list_deep_free(rrsigs);
+	return chain;
+}
+
 ldns_dnssec_trust_tree *
 ldns_dnssec_trust_tree_new(void)
 {
@@ -1185,11 +1384,22 @@ ldns_verify_notime(ldns_rr_list *rrset, ldns_rr_list *rrsig,
 	return verify_result;
 }
 
+static ldns_rr_list *
+ldns_validate_domain_dnskey_cached(const ldns_resolver *res,
+		const ldns_rdf *domain, const ldns_rr_list *keys,
+		time_t check_time, ldns_trust_cache *tc);
+
+static ldns_rr_list *
+ldns_validate_domain_ds_cached(const ldns_resolver *res,
+		const ldns_rdf *domain, const ldns_rr_list *keys,
+		time_t check_time, ldns_trust_cache *tc);
+
 ldns_rr_list *
-ldns_fetch_valid_domain_keys_time(const ldns_resolver *res,
+ldns_fetch_valid_domain_keys_cached(const ldns_resolver *res,
                              const ldns_rdf *domain,
                              const ldns_rr_list *keys,
 			     time_t check_time,
+			     ldns_trust_cache *tc,
                              ldns_status *status)
 {
 	ldns_rr_list * trusted_keys = NULL;
@@ -1200,8 +1410,12 @@ ldns_fetch_valid_domain_keys_time(const ldns_resolver *res,
 
 	if (res && domain && keys) {
 
-		if ((trusted_keys = ldns_validate_domain_dnskey_time(res,
-                                         domain, keys, check_time))) {
+		if ((trusted_keys = ldns_trust_cache_lookup(tc, domain,
+				LDNS_RR_TYPE_DNSKEY, check_time))) {
+			*status = LDNS_STATUS_OK;
+
+		} else if ((trusted_keys = ldns_validate_domain_dnskey_cached(
+				res, domain, keys, check_time, tc))) {
 			*status = LDNS_STATUS_OK;
 		} else {
 			/* No trusted keys in this domain, we'll have to find some in the parent domain */
@@ -1212,23 +1426,26 @@ ldns_fetch_valid_domain_keys_time(const ldns_resolver *res,
 					ldns_rdf_size(parent_domain) > 0) {
 	
 				if ((parent_keys = 
-					ldns_fetch_valid_domain_keys_time(res,
+					ldns_fetch_valid_domain_keys_cached(res,
 					     parent_domain,
 					     keys,
 					     check_time,
+					     tc,
 					     status))) {
 					/* Check DS records */
 					if ((ds_keys =
-						ldns_validate_domain_ds_time(res,
+						ldns_validate_domain_ds_cached(res,
 						     domain,
 						     parent_keys,
-						     check_time))) {
+						     check_time,
+						     tc))) {
 						trusted_keys =
-						ldns_fetch_valid_domain_keys_time(
+						ldns_fetch_valid_domain_keys_cached(
 								res, 
 								domain, 
 								ds_keys, 
 								check_time,
+								tc,
 								status);
 						ldns_rr_list_deep_free(ds_keys);
 					} else {
@@ -1253,6 +1470,17 @@ ldns_fetch_valid_domain_keys_time(const ldns_resolver *res,
 	return trusted_keys;
 }
 
+ldns_rr_list *
+ldns_fetch_valid_domain_keys_time(const ldns_resolver *res,
+                             const ldns_rdf *domain,
+                             const ldns_rr_list *keys,
+			     time_t check_time,
+                             ldns_status *status)
+{
+	return ldns_fetch_valid_domain_keys_cached(
+			res, domain, keys, check_time, NULL, status);
+}
+
 ldns_rr_list *
 ldns_fetch_valid_domain_keys(const ldns_resolver *res,
                              const ldns_rdf *domain,
@@ -1264,11 +1492,31 @@ ldns_fetch_valid_domain_keys(const ldns_resolver *res,
 }
 
 ldns_rr_list *
-ldns_validate_domain_dnskey_time(
+ldns_fetch_valid_domain_keys_parallel(ldns_resolver *res,
+		const ldns_rdf *domain, const ldns_rr_list *keys,
+		time_t check_time, ldns_status *status)
+{
+	ldns_rr_list *trusted_keys;
+	ldns_cache *own = NULL;
+
+	if (res && domain && keys) {
+		own = ldns_dnssec_prefetch(res, LDNS_RD, &domain, 1, keys);
+	}
+	trusted_keys = ldns_fetch_valid_domain_keys_time(res, domain, keys,
+			check_time, status);
+	if (res) {
+		ldns_dnssec_prefetch_done(res, own);
+	}
+	return trusted_keys;
+}
+
+static ldns_rr_list *
+ldns_validate_domain_dnskey_cached(
 		const ldns_resolver * res,
 		const ldns_rdf * domain,
 		const ldns_rr_list * keys,
-		time_t check_time
+		time_t check_time,
+		ldns_trust_cache *tc
 		)
 {
 	ldns_pkt * keypkt;
@@ -1330,6 +1578,14 @@ ldns_validate_domain_dnskey_time(
 											  domain_keys,
 											  key_k)));
 								}
+								if (tc) {
+									(void) ldns_trust_cache_store(
+									    tc, domain,
+									    LDNS_RR_TYPE_DNSKEY,
+									    domain_keys,
+									    domain_sigs,
+									    check_time);
+								}
                 
 								ldns_rr_list_deep_free(domain_keys);
 								ldns_rr_list_deep_free(domain_sigs);
@@ -1357,6 +1613,18 @@ ldns_validate_domain_dnskey_time(
 	return trusted_keys;
 }
 
+ldns_rr_list *
+ldns_validate_domain_dnskey_time(
+		const ldns_resolver * res,
+		const ldns_rdf * domain,
+		const ldns_rr_list * keys,
+		time_t check_time
+		)
+{
+	return ldns_validate_domain_dnskey_cached(
+			res, domain, keys, check_time, NULL);
+}
+
 ldns_rr_list *
 ldns_validate_domain_dnskey(const ldns_resolver * res,
 					   const ldns_rdf * domain,
@@ -1366,12 +1634,13 @@ ldns_validate_domain_dnskey(const ldns_resolver * res,
 			res, domain, keys, ldns_time(NULL));
 }
 
-ldns_rr_list *
-ldns_validate_domain_ds_time(
+static ldns_rr_list *
+ldns_validate_domain_ds_cached(
 		const ldns_resolver *res, 
 		const ldns_rdf * domain,
 		const ldns_rr_list * keys,
-		time_t check_time)
+		time_t check_time,
+		ldns_trust_cache *tc)
 {
 	ldns_pkt * dspkt;
 	uint16_t key_i;
@@ -1379,6 +1648,11 @@ ldns_validate_domain_ds_time(
 	ldns_rr_list * sigs = NULL;
 	ldns_rr_list * trusted_keys = NULL;
 
+	if ((trusted_keys = ldns_trust_cache_lookup(tc, domain,
+			LDNS_RR_TYPE_DS, check_time))) {
+		return trusted_keys;
+	}
+
 	/* Fetch DS for the domain */
 	dspkt = ldns_resolver_query(res, domain,
 		LDNS_RR_TYPE_DS, LDNS_RR_CLASS_IN, LDNS_RD);
@@ -1401,6 +1675,11 @@ ldns_validate_domain_ds_time(
 											)
 								 );
 			}
+			if (tc) {
+				(void) ldns_trust_cache_store(tc, domain,
+						LDNS_RR_TYPE_DS, rrset, sigs,
+						check_time);
+			}
 		}
 
 		ldns_rr_list_deep_free(rrset);
@@ -1414,6 +1693,17 @@ ldns_validate_domain_ds_time(
 	return trusted_keys;
 }
 
+ldns_rr_list *
+ldns_validate_domain_ds_time(
+		const ldns_resolver *res, 
+		const ldns_rdf * domain,
+		const ldns_rr_list * keys,
+		time_t check_time)
+{
+	return ldns_validate_domain_ds_cached(
+			res, domain, keys, check_time, NULL);
+}
+
 ldns_rr_list *
 ldns_validate_domain_ds(const ldns_resolver *res,
 				    const ldns_rdf * domain,
@@ -1423,17 +1713,20 @@ ldns_validate_domain_ds(const ldns_resolver *res,
 }
 
 ldns_status
-ldns_verify_trusted_time(
+ldns_verify_trusted_cached(
 		ldns_resolver *res, 
 		ldns_rr_list *rrset, 
 		ldns_rr_list * rrsigs, 
 		time_t check_time,
+		ldns_trust_cache *tc,
 		ldns_rr_list * validating_keys
 		)
 {
 	uint16_t sig_i; uint16_t key_i;
-	ldns_rr * cur_sig; ldns_rr * cur_key;
+	ldns_rr * cur_sig;
 	ldns_rr_list * trusted_keys = NULL;
+	ldns_rr_list * good_keys;
+	ldns_dnskey_cache * keys;
 	ldns_status result = LDNS_STATUS_ERR;
 
 	if (!res || !rrset || !rrsigs) {
@@ -1453,30 +1746,46 @@ ldns_verify_trusted_time(
 
 		cur_sig = ldns_rr_list_rr(rrsigs, sig_i);
 		/* Get a valid signer key and validate the sig */
-		if ((trusted_keys = ldns_fetch_valid_domain_keys_time(
+		if ((trusted_keys = ldns_fetch_valid_domain_keys_cached(
 					res, 
 					ldns_rr_rrsig_signame(cur_sig), 
 					ldns_resolver_dnssec_anchors(res), 
 					check_time,
+					tc,
 					&result))) {
 
-			for (key_i = 0;
-				key_i < ldns_rr_list_rr_count(trusted_keys);
-				key_i++) {
-				cur_key = ldns_rr_list_rr(trusted_keys, key_i);
-
-				if ((result = ldns_verify_rrsig_time(rrset,
-								cur_sig, 
-								cur_key,
-								check_time))
-				    == LDNS_STATUS_OK) {
-					if (validating_keys) {
-						ldns_rr_list_push_rr(validating_keys,
-										 ldns_rr_clone(cur_key));
-					}
-					ldns_rr_list_deep_free(trusted_keys);
-					return LDNS_STATUS_OK;
-				} 
+			/* Only the keys with the key tag and algorithm of
+			 * the signature are tried, and the RRset is put in
+			 * canonical form once for all of them */
+			keys = ldns_dnskey_cache_new();
+			good_keys = ldns_rr_list_new();
+			if (!keys || !good_keys
+			||  (result = ldns_dnskey_cache_add_rr_list(keys,
+						trusted_keys))
+					!= LDNS_STATUS_OK) {
+				ldns_dnskey_cache_free(keys);
+				ldns_rr_list_free(good_keys);
+				ldns_rr_list_deep_free(trusted_keys);
+				return LDNS_STATUS_MEM_ERR;
+			}
+			ldns_rr_list_deep_free(trusted_keys);
+			trusted_keys = NULL;
+
+			result = ldns_verify_rrsig_keycache_time(rrset,
+					cur_sig, keys, check_time, good_keys);
+			if (result == LDNS_STATUS_OK && validating_keys) {
+				for (key_i = 0;
+					key_i < ldns_rr_list_rr_count(good_keys);
+					key_i++) {
+					ldns_rr_list_push_rr(validating_keys,
+						ldns_rr_clone(ldns_rr_list_rr(
+							good_keys, key_i)));
+				}
+			}
+			ldns_rr_list_free(good_keys);
+			ldns_dnskey_cache_free(keys);
+			if (result == LDNS_STATUS_OK) {
+				return LDNS_STATUS_OK;
 			}
 		}
 	}
@@ -1485,6 +1794,19 @@ ldns_verify_trusted_time(
 	return result;
 }
 
+ldns_status
+ldns_verify_trusted_time(
+		ldns_resolver *res, 
+		ldns_rr_list *rrset, 
+		ldns_rr_list * rrsigs, 
+		time_t check_time,
+		ldns_rr_list * validating_keys
+		)
+{
+	return ldns_verify_trusted_cached(
+			res, rrset, rrsigs, check_time, NULL, validating_keys);
+}
+
 ldns_status
 ldns_verify_trusted(
 		ldns_resolver *res,
@@ -1496,6 +1818,32 @@ ldns_verify_trusted(
 			res, rrset, rrsigs, ldns_time(NULL), validating_keys);
 }
 
+ldns_status
+ldns_verify_trusted_parallel(
+		ldns_resolver *res,
+		ldns_rr_list *rrset,
+		ldns_rr_list *rrsigs,
+		time_t check_time,
+		ldns_rr_list *validating_keys)
+{
+	const ldns_rdf **signers;
+	ldns_cache *own = NULL;
+	ldns_status result;
+	size_t n;
+
+	if (res && rrsigs && (signers = ldns_dnssec_signers(rrsigs, &n))) {
+		own = ldns_dnssec_prefetch(res, LDNS_RD, signers, n,
+				ldns_resolver_dnssec_anchors(res));
+		LDNS_FREE(signers);
+	}
+	result = ldns_verify_trusted_time(res, rrset, rrsigs, check_time,
+			validating_keys);
+	if (res) {
+		ldns_dnssec_prefetch_done(res, own);
+	}
+	return result;
+}
+
 
 ldns_status
 ldns_dnssec_verify_denial(ldns_rr *rr,
@@ -2346,18 +2694,18 @@ ldns_verify_test_sig_key(ldns_buffer* rawsig_buf, ldns_buffer* verify_buf,
 	    ==
 	    ldns_rdf2native_int16(ldns_rr_rrsig_keytag(rrsig))
 	    ) {
-		ldns_buffer* key_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+		ldns_buffer* key_buf = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 		ldns_status result = LDNS_STATUS_ERR;
 
 		/* put the key-data in a buffer, that's the third rdf, with
 		 * the base64 encoded key data */
 		if (ldns_rr_rdf(key, 3) == NULL) {
-			ldns_buffer_free(key_buf);
+			ldns_buffer_release(key_buf);
 			return LDNS_STATUS_MISSING_RDATA_FIELDS_KEY;
 		}
 		if (ldns_rdf2buffer_wire(key_buf, ldns_rr_rdf(key, 3))
 			       	!= LDNS_STATUS_OK) {
-			ldns_buffer_free(key_buf); 
+			ldns_buffer_release(key_buf); 
 			/* returning is bad might screw up
 			   good keys later in the list
 			   what to do? */
@@ -2376,7 +2724,7 @@ ldns_verify_test_sig_key(ldns_buffer* rawsig_buf, ldns_buffer* verify_buf,
 			result = LDNS_STATUS_CRYPTO_NO_MATCHING_KEYTAG_DNSKEY;
 		}
 
-		ldns_buffer_free(key_buf); 
+		ldns_buffer_release(key_buf); 
 		return result;
 	}
 	else {
@@ -2474,14 +2822,14 @@ ldns_verify_rrsig_keylist_notime(const ldns_rr_list *rrset,
 	rrset_clone = ldns_rr_list_clone(rrset);
 
 	/* create the buffers which will certainly hold the raw data */
-	rawsig_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
-	verify_buf  = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	rawsig_buf = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
+	verify_buf  = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 
 	result = ldns_prepare_for_verify(rawsig_buf, verify_buf, 
 		rrset_clone, rrsig);
 	if(result != LDNS_STATUS_OK) {
-		ldns_buffer_free(verify_buf);
-		ldns_buffer_free(rawsig_buf);
+		ldns_buffer_release(verify_buf);
+		ldns_buffer_release(rawsig_buf);
 		ldns_rr_list_deep_free(rrset_clone);
 		ldns_rr_list_free(validkeys);
 		return result;
@@ -2499,8 +2847,8 @@ ldns_verify_rrsig_keylist_notime(const ldns_rr_list *rrset,
 			if (!ldns_rr_list_push_rr(validkeys, 
 				ldns_rr_list_rr(keys,i))) {
 				/* couldn't push the key?? */
-				ldns_buffer_free(rawsig_buf);
-				ldns_buffer_free(verify_buf);
+				ldns_buffer_release(rawsig_buf);
+				ldns_buffer_release(verify_buf);
 				ldns_rr_list_deep_free(rrset_clone);
 				ldns_rr_list_free(validkeys);
 				return LDNS_STATUS_MEM_ERR;
@@ -2516,8 +2864,8 @@ ldns_verify_rrsig_keylist_notime(const ldns_rr_list *rrset,
 
 	/* no longer needed */
 	ldns_rr_list_deep_free(rrset_clone);
-	ldns_buffer_free(rawsig_buf);
-	ldns_buffer_free(verify_buf);
+	ldns_buffer_release(rawsig_buf);
+	ldns_buffer_release(verify_buf);
 
 	if (ldns_rr_list_rr_count(validkeys) == 0) {
 		/* no keys were added, return last error */
@@ -2532,6 +2880,112 @@ ldns_verify_rrsig_keylist_notime(const ldns_rr_list *rrset,
 	return LDNS_STATUS_OK;
 }
 
+ldns_status
+ldns_verify_rrsig_keycache_notime(const ldns_rr_list *rrset,
+		const ldns_rr *rrsig, ldns_dnskey_cache *keys,
+		ldns_rr_list *good_keys)
+{
+	ldns_buffer *rawsig_buf;
+	ldns_buffer *verify_buf;
+	ldns_status result, status;
+	ldns_rr_list *rrset_clone;
+	ldns_rr_list *validkeys;
+	ldns_dnskey_cache_key *key;
+	EVP_PKEY *pkey;
+	const EVP_MD *md;
+
+	if (!rrset) {
+		return LDNS_STATUS_ERR;
+	}
+	if (!rrsig) {
+		return LDNS_STATUS_CRYPTO_NO_RRSIG;
+	}
+	validkeys = ldns_rr_list_new();
+	if (!validkeys) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	rrset_clone = ldns_rr_list_clone(rrset);
+	rawsig_buf = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
+	verify_buf  = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
+	if (!rrset_clone || !rawsig_buf || !verify_buf) {
+		result = LDNS_STATUS_MEM_ERR;
+		goto done;
+	}
+	result = ldns_prepare_for_verify(rawsig_buf, verify_buf,
+		rrset_clone, rrsig);
+	if (result != LDNS_STATUS_OK) {
+		goto done;
+	}
+
+	/* Only the keys with the signer name, algorithm and keytag
+	 * of the signature are tried.
+	 */
+	result = LDNS_STATUS_CRYPTO_NO_MATCHING_KEYTAG_DNSKEY;
+	for (key = ldns_dnskey_cache_lookup_rrsig(keys, rrsig); key;
+			key = key->next) {
+		if ((pkey = ldns_dnskey_cache_key_pkey(key, &md, &status))) {
+			status = ldns_verify_rrsig_evp_raw(
+					ldns_buffer_begin(rawsig_buf),
+					ldns_buffer_position(rawsig_buf),
+					verify_buf, pkey, md);
+		}
+		if (status == LDNS_STATUS_OK) {
+			if (!ldns_rr_list_push_rr(validkeys, key->rr)) {
+				result = LDNS_STATUS_MEM_ERR;
+				goto done;
+			}
+			result = status;
+		}
+		if (result == LDNS_STATUS_CRYPTO_NO_MATCHING_KEYTAG_DNSKEY) {
+			result = status;
+		}
+	}
+	if (ldns_rr_list_rr_count(validkeys) > 0) {
+		ldns_rr_list_cat(good_keys, validkeys);
+		result = LDNS_STATUS_OK;
+	}
+done:
+	ldns_rr_list_deep_free(rrset_clone);
+	ldns_buffer_release(rawsig_buf);
+	ldns_buffer_release(verify_buf);
+	ldns_rr_list_free(validkeys);
+	return result;
+}
+
+ldns_status
+ldns_verify_rrsig_keycache_time(const ldns_rr_list *rrset,
+		const ldns_rr *rrsig, ldns_dnskey_cache *keys,
+		time_t check_time, ldns_rr_list *good_keys)
+{
+	ldns_status result;
+	ldns_rr_list *valid;
+
+	if (!good_keys)
+		valid = NULL;
+
+	else if (!(valid = ldns_rr_list_new()))
+		return LDNS_STATUS_MEM_ERR;
+
+	result = ldns_verify_rrsig_keycache_notime(rrset, rrsig, keys, valid);
+	if (result == LDNS_STATUS_OK) {
+		/* check timestamps last; its OK except time */
+		result = ldns_rrsig_check_timestamps(rrsig, check_time);
+	}
+	if (result == LDNS_STATUS_OK) {
+		ldns_rr_list_cat(good_keys, valid);
+	}
+	ldns_rr_list_free(valid);
+	return result;
+}
+
+ldns_status
+ldns_verify_rrsig_keycache(const ldns_rr_list *rrset, const ldns_rr *rrsig,
+		ldns_dnskey_cache *keys, ldns_rr_list *good_keys)
+{
+	return ldns_verify_rrsig_keycache_time(
+			rrset, rrsig, keys, ldns_time(NULL), good_keys);
+}
+
 ldns_status
 ldns_verify_rrsig_time(
 		ldns_rr_list *rrset, 
@@ -2550,23 +3004,23 @@ ldns_verify_rrsig_time(
 	/* clone the rrset so that we can fiddle with it */
 	rrset_clone = ldns_rr_list_clone(rrset);
 	/* create the buffers which will certainly hold the raw data */
-	rawsig_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
-	verify_buf  = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	rawsig_buf = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
+	verify_buf  = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 
 	result = ldns_prepare_for_verify(rawsig_buf, verify_buf, 
 		rrset_clone, rrsig);
 	if(result != LDNS_STATUS_OK) {
 		ldns_rr_list_deep_free(rrset_clone);
-		ldns_buffer_free(rawsig_buf);
-		ldns_buffer_free(verify_buf);
+		ldns_buffer_release(rawsig_buf);
+		ldns_buffer_release(verify_buf);
 		return result;
 	}
 	result = ldns_verify_test_sig_key(rawsig_buf, verify_buf, 
 		rrsig, key);
 	/* no longer needed */
 	ldns_rr_list_deep_free(rrset_clone);
-	ldns_buffer_free(rawsig_buf);
-	ldns_buffer_free(verify_buf);
+	ldns_buffer_release(rawsig_buf);
+	ldns_buffer_release(verify_buf);
 
 	/* check timestamp last, apart from time its OK */
 	if(result == LDNS_STATUS_OK)
@@ -2827,4 +3281,695 @@ ldns_verify_rrsig_rsamd5_raw(unsigned char* sig,
 	return result;
 }
 
+/*
+ * Bulk verification of all signatures in a ldns_dnssec_zone.
+ *
+ * The zone keys are converted to EVP_PKEYs once, up front, in a
+ * ldns_dnskey_cache.  The RRsets
+ * to verify are collected in a job list, which is then worked off by
+ * a number of threads.  Each thread has its own buffers, and writes
+ * every RRset to wire format in canonical form only once, no matter
+ * how many signatures cover it.
+ */
+
+/* A single RRset (or NSEC(3) RR) with its signatures */
+typedef struct ldns_zone_verify_job {
+	const ldns_rdf *name;
+	ldns_rr_type type;
+	ldns_dnssec_rrs *rrs;
+	ldns_dnssec_rrs *signatures;
+	/* storage for rrs when it is the NSEC(3) of a name */
+	ldns_dnssec_rrs nsec;
+} ldns_zone_verify_job;
+
+/* An error and the job it belongs to, to be able to report in order */
+typedef struct ldns_zone_verify_job_error {
+	size_t job;
+	size_t seq;
+	ldns_dnssec_verify_error error;
+} ldns_zone_verify_job_error;
+
+/* One RR of a RRset in canonical wire format */
+typedef struct ldns_zone_verify_wire_rr {
+	const uint8_t *wire;
+	size_t len;
+} ldns_zone_verify_wire_rr;
+
+typedef struct ldns_zone_verify_ctx {
+	ldns_zone_verify_job *jobs;
+	size_t job_count;
+	size_t next_job;
+	ldns_dnskey_cache *keys;
+	time_t check_time;
+	int32_t inception_margin;
+	int32_t expiration_margin;
+#ifdef HAVE_PTHREAD
+	pthread_mutex_t lock;
+#endif
+} ldns_zone_verify_ctx;
+
+typedef struct ldns_zone_verify_worker {
+	ldns_zone_verify_ctx *ctx;
+	ldns_buffer *rrset_buf;
+	ldns_buffer *verify_buf;
+	ldns_buffer *rawsig_buf;
+	ldns_zone_verify_wire_rr *rrs;
+	size_t rrs_capacity;
+	ldns_zone_verify_job_error *errors;
+	size_t error_count;
+	size_t error_capacity;
+	size_t rrsets;
+	size_t signatures;
+	ldns_status status;
+#ifdef HAVE_PTHREAD
+	pthread_t thread;
+#endif
+} ldns_zone_verify_worker;
+
+#define LDNS_ZONE_VERIFY_BATCH 16
+
+static int
+ldns_zone_verify_wire_rr_cmp(const void *a, const void *b)
+{
+	const ldns_zone_verify_wire_rr *ra = a, *rb = b;
+	size_t min_len = ra->len < rb->len ? ra->len : rb->len;
+	int c;
+
+	/* all RRs of the RRset have the same owner, type and class, and
+	 * TTLs do not count, so compare from the RDATA onwards */
+	c = memcmp(ra->wire, rb->wire, min_len);
+	return c ? c : ra->len < rb->len ? -1 : ra->len > rb->len ? 1 : 0;
+}
+
+/* Puts the RRset in canonical wire format and canonical order in
+ * w->rrset_buf and w->rrs.  Returns the length of the owner name.
+ */
+static ldns_status
+ldns_zone_verify_rrset2wire(ldns_zone_verify_worker *w,
+		ldns_dnssec_rrs *rrs, size_t *rr_count, size_t *owner_len)
+{
+	ldns_dnssec_rrs *cur;
+	size_t n = 0, i, start;
+
+	ldns_buffer_clear(w->rrset_buf);
+	*owner_len = ldns_rdf_size(ldns_rr_owner(rrs->rr));
+	for (cur = rrs; cur && cur->rr; cur = cur->next) {
+		if (n == w->rrs_capacity) {
+			size_t capacity = w->rrs_capacity * 2 + 8;
+			ldns_zone_verify_wire_rr *r = LDNS_XREALLOC(w->rrs,
+					ldns_zone_verify_wire_rr, capacity);
+
+			if (!r) {
+				return LDNS_STATUS_MEM_ERR;
+			}
+			w->rrs = r;
+			w->rrs_capacity = capacity;
+		}
+		start = ldns_buffer_position(w->rrset_buf);
+		if (ldns_rr2buffer_wire_canonical(w->rrset_buf, cur->rr,
+					LDNS_SECTION_ANY) != LDNS_STATUS_OK) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		/* remember offsets now, the buffer may still move */
+		w->rrs[n].wire = NULL;
+		w->rrs[n].len = start;
+		n++;
+	}
+	/* turn offsets into pointers at the RDATA */
+	for (i = 0; i < n; i++) {
+		size_t end = i + 1 < n ? w->rrs[i + 1].len
+		                       : ldns_buffer_position(w->rrset_buf);
+
+		w->rrs[i].wire = ldns_buffer_at(w->rrset_buf,
+				w->rrs[i].len + *owner_len + 10);
+		w->rrs[i].len = end - w->rrs[i].len - *owner_len - 10;
+	}
+	if (n > 1) {
+		qsort(w->rrs, n, sizeof(ldns_zone_verify_wire_rr),
+				ldns_zone_verify_wire_rr_cmp);
+	}
+	*rr_count = n;
+	return LDNS_STATUS_OK;
+}
+
+/* Fills w->verify_buf with the data covered by rrsig */
+static ldns_status
+ldns_zone_verify_prepare(ldns_zone_verify_worker *w, const ldns_rr *rrsig,
+		ldns_rr_type type, size_t rr_count, size_t owner_len)
+{
+	const uint8_t *owner = ldns_buffer_begin(w->rrset_buf);
+	uint8_t labels, owner_labels = 0;
+	size_t pos, skip = 0, i;
+	ldns_status status;
+
+	if (ldns_rr_rd_count(rrsig) < 9 || !ldns_rr_rrsig_typecovered(rrsig)
+	||  !ldns_rr_rrsig_labels(rrsig) || !ldns_rr_rrsig_origttl(rrsig)) {
+		return LDNS_STATUS_MISSING_RDATA_FIELDS_RRSIG;
+	}
+	if (ldns_rdf2rr_type(ldns_rr_rrsig_typecovered(rrsig)) != type) {
+		return LDNS_STATUS_CRYPTO_TYPE_COVERED_ERR;
+	}
+	ldns_buffer_clear(w->rawsig_buf);
+	ldns_buffer_clear(w->verify_buf);
+	status = ldns_rrsig2rawsig_buffer(w->rawsig_buf, rrsig);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (ldns_rrsig2buffer_wire(w->verify_buf, rrsig) != LDNS_STATUS_OK) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+
+	/* Expand wildcards to the number of labels in the signature */
+	labels = ldns_rdf2native_int8(ldns_rr_rrsig_labels(rrsig));
+	for (pos = 0; pos < owner_len && owner[pos]; pos += owner[pos] + 1) {
+		owner_labels++;
+	}
+	for (pos = 0; owner_labels > labels; owner_labels--) {
+		pos += owner[pos] + 1;
+		skip = pos;
+	}
+	for (i = 0; i < rr_count; i++) {
+		if (!ldns_buffer_reserve(w->verify_buf,
+				owner_len + 12 + w->rrs[i].len)) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		if (skip) {
+			ldns_buffer_write_u8(w->verify_buf, 1);
+			ldns_buffer_write_u8(w->verify_buf, '*');
+		}
+		ldns_buffer_write(w->verify_buf, owner + skip, owner_len - skip);
+		ldns_buffer_write(w->verify_buf, owner + owner_len, 4);
+		ldns_buffer_write(w->verify_buf,
+				ldns_rdf_data(ldns_rr_rrsig_origttl(rrsig)), 4);
+		ldns_buffer_write_u16(w->verify_buf, (uint16_t)w->rrs[i].len);
+		ldns_buffer_write(w->verify_buf, w->rrs[i].wire, w->rrs[i].len);
+	}
+	return LDNS_STATUS_OK;
+}
+
+/* Same results and error precedence as ldns_verify_rrsig_keylist_time() */
+static ldns_status
+ldns_zone_verify_rrsig(ldns_zone_verify_worker *w, const ldns_rr *rrsig)
+{
+	ldns_zone_verify_ctx *ctx = w->ctx;
+	ldns_status result = LDNS_STATUS_CRYPTO_NO_MATCHING_KEYTAG_DNSKEY;
+	ldns_status status;
+	ldns_dnskey_cache_key *key;
+	EVP_PKEY *pkey;
+	const EVP_MD *md;
+	int32_t inception, expiration;
+
+	/* the cache was prepared, so this does not modify it */
+	for (key = ldns_dnskey_cache_lookup_rrsig(ctx->keys, rrsig)
+	    ; key && result != LDNS_STATUS_OK; key = key->next) {
+		if ((pkey = ldns_dnskey_cache_key_pkey(key, &md, &status))) {
+			w->signatures++;
+			status = ldns_verify_rrsig_evp_raw(
+				ldns_buffer_begin(w->rawsig_buf),
+				ldns_buffer_position(w->rawsig_buf),
+				w->verify_buf, pkey, md);
+		}
+		if (status == LDNS_STATUS_OK
+		||  result == LDNS_STATUS_CRYPTO_NO_MATCHING_KEYTAG_DNSKEY) {
+			result = status;
+		}
+	}
+	if (result != LDNS_STATUS_OK) {
+		return result;
+	}
+	result = ldns_rrsig_check_timestamps(rrsig, ctx->check_time);
+	if (result != LDNS_STATUS_OK) {
+		return result;
+	}
+	inception  = ldns_rdf2native_int32(ldns_rr_rrsig_inception(rrsig));
+	expiration = ldns_rdf2native_int32(ldns_rr_rrsig_expiration(rrsig));
+	if (((int32_t)(ctx->check_time - ctx->inception_margin))
+			- inception < 0) {
+		return LDNS_STATUS_CRYPTO_SIG_NOT_INCEPTED_WITHIN_MARGIN;
+	}
+	if (expiration - ((int32_t)(ctx->check_time + ctx->expiration_margin))
+			< 0) {
+		return LDNS_STATUS_CRYPTO_SIG_EXPIRED_WITHIN_MARGIN;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static ldns_status
+ldns_zone_verify_add_error(ldns_zone_verify_worker *w, size_t job_nr,
+		const ldns_zone_verify_job *job, const ldns_rr *rrsig,
+		ldns_status reason)
+{
+	ldns_zone_verify_job_error *e;
+
+	if (w->error_count == w->error_capacity) {
+		size_t capacity = w->error_capacity * 2 + 16;
+
+		e = LDNS_XREALLOC(w->errors,
+				ldns_zone_verify_job_error, capacity);
+		if (!e) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		w->errors = e;
+		w->error_capacity = capacity;
+	}
+	e = &w->errors[w->error_count];
+	e->job = job_nr;
+	e->seq = w->error_count;
+	e->error.name = ldns_rdf_clone(job->name);
+	if (!e->error.name) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	e->error.type = job->type;
+	e->error.keytag = ldns_rr_rrsig_keytag(rrsig)
+	    ? ldns_rdf2native_int16(ldns_rr_rrsig_keytag(rrsig)) : 0;
+	e->error.algorithm = ldns_rr_rrsig_algorithm(rrsig)
+	    ? ldns_rdf2native_int8(ldns_rr_rrsig_algorithm(rrsig)) : 0;
+	e->error.reason = reason;
+	w->error_count++;
+	return LDNS_STATUS_OK;
+}
+
+static ldns_status
+ldns_zone_verify_job_run(ldns_zone_verify_worker *w, size_t job_nr)
+{
+	ldns_zone_verify_job *job = &w->ctx->jobs[job_nr];
+	ldns_dnssec_rrs *sig;
+	size_t rr_count, owner_len, first_error = w->error_count;
+	ldns_status status;
+
+	status = ldns_zone_verify_rrset2wire(w, job->rrs, &rr_count, &owner_len);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	w->rrsets++;
+
+	/* A single valid signature validates the RRset */
+	for (sig = job->signatures; sig && sig->rr; sig = sig->next) {
+		status = ldns_zone_verify_prepare(w, sig->rr, job->type,
+				rr_count, owner_len);
+		if (status == LDNS_STATUS_MEM_ERR) {
+			return status;
+		}
+		if (status == LDNS_STATUS_OK) {
+			status = ldns_zone_verify_rrsig(w, sig->rr);
+		}
+		if (status == LDNS_STATUS_OK) {
+			break;
+		}
+		if (ldns_zone_verify_add_error(w, job_nr, job, sig->rr, status)
+				!= LDNS_STATUS_OK) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+	}
+	if (sig && sig->rr) {
+		/* forget about the signatures that did not verify */
+		while (w->error_count > first_error) {
+			ldns_rdf_deep_free(
+				w->errors[--w->error_count].error.name);
+		}
+	}
+	return LDNS_STATUS_OK;
+}
+
+static void *
+ldns_zone_verify_worker_run(void *arg)
+{
+	ldns_zone_verify_worker *w = (ldns_zone_verify_worker *)arg;
+	ldns_zone_verify_ctx *ctx = w->ctx;
+	size_t first, last;
+
+	while (w->status == LDNS_STATUS_OK) {
+#ifdef HAVE_PTHREAD
+		pthread_mutex_lock(&ctx->lock);
+#endif
+		first = ctx->next_job;
+		last = first + LDNS_ZONE_VERIFY_BATCH < ctx->job_count
+		     ? first + LDNS_ZONE_VERIFY_BATCH : ctx->job_count;
+		ctx->next_job = last;
+#ifdef HAVE_PTHREAD
+		pthread_mutex_unlock(&ctx->lock);
+#endif
+		if (first == last) {
+			break;
+		}
+		for (; first < last && w->status == LDNS_STATUS_OK; first++) {
+			w->status = ldns_zone_verify_job_run(w, first);
+		}
+	}
+	return NULL;
+}
+
+static ldns_status
+ldns_zone_verify_add_job(ldns_zone_verify_ctx *ctx, size_t *capacity,
+		const ldns_rdf *name, ldns_rr_type type,
+		ldns_dnssec_rrs *rrs, ldns_rr *nsec,
+		ldns_dnssec_rrs *signatures)
+{
+	ldns_zone_verify_job *job;
+
+	if (ctx->job_count == *capacity) {
+		*capacity = *capacity * 2 + 1024;
+		job = LDNS_XREALLOC(ctx->jobs, ldns_zone_verify_job, *capacity);
+		if (!job) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		ctx->jobs = job;
+	}
+	job = &ctx->jobs[ctx->job_count++];
+	job->name = name;
+	job->type = type;
+	job->rrs = rrs;
+	job->signatures = signatures;
+	job->nsec.rr = nsec;
+	job->nsec.next = NULL;
+	return LDNS_STATUS_OK;
+}
+
+/* Collects the RRsets that ldns-verify-zone would verify */
+static ldns_status
+ldns_zone_verify_collect(ldns_zone_verify_ctx *ctx, ldns_dnssec_zone *zone)
+{
+	ldns_rbnode_t *node;
+	ldns_dnssec_name *name;
+	ldns_dnssec_rrsets *rrset;
+	size_t capacity = 0;
+	bool on_delegation_point;
+	ldns_status status = LDNS_STATUS_OK;
+
+	for (node = ldns_rbtree_first(zone->names)
+	    ; node != LDNS_RBTREE_NULL && status == LDNS_STATUS_OK
+	    ; node = ldns_rbtree_next(node)) {
+
+		name = (ldns_dnssec_name *) node->data;
+		if (ldns_dnssec_name_is_glue(name)) {
+			continue;
+		}
+		on_delegation_point =
+			    ldns_dnssec_rrsets_contains_type(name->rrsets,
+					LDNS_RR_TYPE_NS)
+			&& !ldns_dnssec_rrsets_contains_type(name->rrsets,
+					LDNS_RR_TYPE_SOA);
+
+		for (rrset = name->rrsets; rrset && status == LDNS_STATUS_OK
+				; rrset = rrset->next) {
+			if (!rrset->rrs || !rrset->signatures
+			||  rrset->type == LDNS_RR_TYPE_RRSIG
+			||  rrset->type == LDNS_RR_TYPE_NSEC
+			|| (on_delegation_point
+			    && rrset->type != LDNS_RR_TYPE_NS
+			    && rrset->type != LDNS_RR_TYPE_DS)) {
+				continue;
+			}
+			status = ldns_zone_verify_add_job(ctx, &capacity,
+					name->name, rrset->type,
+					rrset->rrs, NULL, rrset->signatures);
+		}
+		if (status == LDNS_STATUS_OK
+		&&  name->nsec && name->nsec_signatures) {
+			/* the owner of an NSEC3 is the hashed name */
+			status = ldns_zone_verify_add_job(ctx, &capacity,
+					ldns_rr_owner(name->nsec),
+					ldns_rr_get_type(name->nsec),
+					NULL, name->nsec,
+					name->nsec_signatures);
+		}
+	}
+	return status;
+}
+
+static ldns_status
+ldns_zone_verify_keys(ldns_zone_verify_ctx *ctx, ldns_dnssec_zone *zone)
+{
+	ldns_dnssec_rrsets *apex_keys;
+	ldns_dnssec_rrs *cur;
+	ldns_status status;
+
+	if (!(ctx->keys = ldns_dnskey_cache_new())) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (zone->soa && (apex_keys = ldns_dnssec_name_find_rrset(
+				zone->soa, LDNS_RR_TYPE_DNSKEY))) {
+		for (cur = apex_keys->rrs; cur && cur->rr; cur = cur->next) {
+			status = ldns_dnskey_cache_add_rr(ctx->keys, cur->rr);
+			if (status == LDNS_STATUS_MEM_ERR) {
+				return status;
+			}
+		}
+	}
+	return LDNS_STATUS_OK;
+}
+
+static int
+ldns_zone_verify_job_error_cmp(const void *a, const void *b)
+{
+	const ldns_zone_verify_job_error *ea = a, *eb = b;
+
+	if (ea->job != eb->job) {
+		return ea->job < eb->job ? -1 : 1;
+	}
+	return ea->seq < eb->seq ? -1 : ea->seq > eb->seq ? 1 : 0;
+}
+
+static ldns_status
+ldns_zone_verify_gather_errors(ldns_zone_verify_worker *workers,
+		size_t n_workers, ldns_dnssec_verify_errors **errors)
+{
+	ldns_zone_verify_job_error *all = NULL;
+	ldns_dnssec_verify_errors *result;
+	size_t count = 0, i, j;
+
+	for (i = 0; i < n_workers; i++) {
+		count += workers[i].error_count;
+	}
+	result = LDNS_MALLOC(ldns_dnssec_verify_errors);
+	if (!result) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	result->count = 0;
+	result->errors = NULL;
+	result->rrsets = 0;
+	result->signatures = 0;
+	for (i = 0; i < n_workers; i++) {
+		result->rrsets += workers[i].rrsets;
+		result->signatures += workers[i].signatures;
+	}
+	if (count > 0) {
+		all = LDNS_XMALLOC(ldns_zone_verify_job_error, count);
+		result->errors = LDNS_XMALLOC(ldns_dnssec_verify_error, count);
+		if (!all || !result->errors) {
+			LDNS_FREE(all);
+			LDNS_FREE(result->errors);
+			LDNS_FREE(result);
+			return LDNS_STATUS_MEM_ERR;
+		}
+		for (i = 0, count = 0; i < n_workers; i++) {
+			for (j = 0; j < workers[i].error_count; j++) {
+				all[count++] = workers[i].errors[j];
+			}
+			/* ownership of the names moved to all */
+			workers[i].error_count = 0;
+		}
+		qsort(all, count, sizeof(ldns_zone_verify_job_error),
+				ldns_zone_verify_job_error_cmp);
+		for (i = 0; i < count; i++) {
+			result->errors[i] = all[i].error;
+		}
+		result->count = count;
+		LDNS_FREE(all);
+	}
+	*errors = result;
+	return LDNS_STATUS_OK;
+}
+
+static void
+ldns_zone_verify_worker_free(ldns_zone_verify_worker *w)
+{
+	size_t i;
+
+	for (i = 0; i < w->error_count; i++) {
+		ldns_rdf_deep_free(w->errors[i].error.name);
+	}
+	LDNS_FREE(w->errors);
+	LDNS_FREE(w->rrs);
+	ldns_buffer_free(w->rrset_buf);
+	ldns_buffer_free(w->verify_buf);
+	ldns_buffer_free(w->rawsig_buf);
+}
+
+ldns_status
+ldns_dnssec_zone_verify_signatures_keycache(ldns_dnssec_zone *zone,
+		ldns_dnskey_cache *keys, time_t check_time,
+		int32_t inception_margin, int32_t expiration_margin,
+		size_t threads, ldns_dnssec_verify_errors **errors)
+{
+	ldns_zone_verify_ctx ctx;
+	ldns_zone_verify_worker *workers = NULL;
+	ldns_dnssec_verify_errors *found = NULL;
+	ldns_status status;
+	size_t i, started = 0;
+
+	if (errors) {
+		*errors = NULL;
+	}
+	if (!zone || !zone->names) {
+		return LDNS_STATUS_NULL;
+	}
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.check_time = check_time;
+	ctx.inception_margin = inception_margin;
+	ctx.expiration_margin = expiration_margin;
+
+	ctx.keys = keys;
+	if ((status = ldns_dnssec_zone_mark_glue(zone)) != LDNS_STATUS_OK
+	|| (!keys && (status = ldns_zone_verify_keys(&ctx, zone))
+			!= LDNS_STATUS_OK)) {
+		goto done;
+	}
+	if (ldns_dnskey_cache_count(ctx.keys) == 0) {
+		status = LDNS_STATUS_CRYPTO_NO_DNSKEY;
+		goto done;
+	}
+	/* convert all keys now, so the threads only read the cache */
+	ldns_dnskey_cache_prepare(ctx.keys);
+	if ((status = ldns_zone_verify_collect(&ctx, zone))
+			!= LDNS_STATUS_OK) {
+		goto done;
+	}
+	for (i = 0; i < ctx.job_count; i++) {
+		/* the jobs array may have moved while collecting */
+		if (!ctx.jobs[i].rrs) {
+			ctx.jobs[i].rrs = &ctx.jobs[i].nsec;
+		}
+	}
+
+#ifdef HAVE_PTHREAD
+	if (threads == 0) {
+# if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+		long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+		threads = n > 0 ? (size_t)n : 1;
+# else
+		threads = 1;
+# endif
+	}
+	if (threads > ctx.job_count / LDNS_ZONE_VERIFY_BATCH + 1) {
+		threads = ctx.job_count / LDNS_ZONE_VERIFY_BATCH + 1;
+	}
+#else
+	threads = 1;
+#endif
+	workers = LDNS_XMALLOC(ldns_zone_verify_worker, threads);
+	if (!workers) {
+		status = LDNS_STATUS_MEM_ERR;
+		goto done;
+	}
+	memset(workers, 0, sizeof(ldns_zone_verify_worker) * threads);
+	for (i = 0; i < threads; i++) {
+		workers[i].ctx = &ctx;
+		workers[i].status = LDNS_STATUS_OK;
+		workers[i].rrset_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+		workers[i].verify_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+		workers[i].rawsig_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+		if (!workers[i].rrset_buf || !workers[i].verify_buf
+		||  !workers[i].rawsig_buf) {
+			status = LDNS_STATUS_MEM_ERR;
+		}
+	}
+	if (status != LDNS_STATUS_OK) {
+		goto done;
+	}
+#ifdef HAVE_PTHREAD
+	pthread_mutex_init(&ctx.lock, NULL);
+	/* the calling thread is the first worker */
+	for (started = 1; started < threads; started++) {
+		if (pthread_create(&workers[started].thread, NULL,
+				ldns_zone_verify_worker_run,
+				&workers[started]) != 0) {
+			break;
+		}
+	}
+#endif
+	(void) ldns_zone_verify_worker_run(&workers[0]);
+#ifdef HAVE_PTHREAD
+	for (i = 1; i < started; i++) {
+		pthread_join(workers[i].thread, NULL);
+	}
+	pthread_mutex_destroy(&ctx.lock);
+#else
+	(void) started;
+#endif
+	for (i = 0; i < threads && status == LDNS_STATUS_OK; i++) {
+		status = workers[i].status;
+	}
+	if (status == LDNS_STATUS_OK) {
+		status = ldns_zone_verify_gather_errors(workers, threads,
+				&found);
+	}
+	if (status == LDNS_STATUS_OK && found->count > 0) {
+		status = found->errors[0].reason;
+	}
+	if (errors) {
+		*errors = found;
+	} else {
+		ldns_dnssec_verify_errors_free(found);
+	}
+done:
+	if (workers) {
+		for (i = 0; i < threads; i++) {
+			ldns_zone_verify_worker_free(&workers[i]);
+		}
+		LDNS_FREE(workers);
+	}
+	if (!keys) {
+		ldns_dnskey_cache_free(ctx.keys);
+	}
+	LDNS_FREE(ctx.jobs);
+	return status;
+}
+
+ldns_status
+ldns_dnssec_zone_verify_signatures(ldns_dnssec_zone *zone,
+		const ldns_rr_list *keys, time_t check_time,
+		int32_t inception_margin, int32_t expiration_margin,
+		size_t threads, ldns_dnssec_verify_errors **errors)
+{
+	ldns_dnskey_cache *cache;
+	ldns_status status;
+
+	if (!keys) {
+		return ldns_dnssec_zone_verify_signatures_keycache(zone, NULL,
+				check_time, inception_margin,
+				expiration_margin, threads, errors);
+	}
+	if (errors) {
+		*errors = NULL;
+	}
+	if (!(cache = ldns_dnskey_cache_new())) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	status = ldns_dnskey_cache_add_rr_list(cache, keys);
+	if (status == LDNS_STATUS_OK) {
+		status = ldns_dnssec_zone_verify_signatures_keycache(zone,
+				cache, check_time, inception_margin,
+				expiration_margin, threads, errors);
+	}
+	ldns_dnskey_cache_free(cache);
+	return status;
+}
+
+void
+ldns_dnssec_verify_errors_free(ldns_dnssec_verify_errors *errors)
+{
+	size_t i;
+
+	if (!errors) {
+		return;
+	}
+	for (i = 0; i < errors->count; i++) {
+		ldns_rdf_deep_free(errors->errors[i].name);
+	}
+	LDNS_FREE(errors->errors);
+	LDNS_FREE(errors);
+}
+
 #endif
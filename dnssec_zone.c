@@ -6,6 +6,10 @@
 
 #include <ldns/ldns.h>
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 ldns_dnssec_rrs *
 ldns_dnssec_rrs_new(void)
 {
@@ -1304,6 +1308,35 @@ typedef struct dnssec_zone_rr_iter {
 	uint8_t                   apex_labs;
 } dnssec_zone_rr_iter;
 
+/* Like ldns_dname_is_subdomain(), but without the allocations, as it is
+ * done for every name in the zone.
+ */
+INLINE bool
+dnssec_zone_rr_iter_is_subdomain(const ldns_rdf *name, const ldns_rdf *apex)
+{
+	const uint8_t *n = ldns_rdf_data(name);
+	const uint8_t *a = ldns_rdf_data(apex);
+	size_t n_len = ldns_rdf_size(name);
+	size_t a_len = ldns_rdf_size(apex);
+	size_t pos = 0, j;
+
+	if (n_len <= a_len)
+		return false;
+
+	/* skip labels until what is left is as long as the apex */
+	while (pos < n_len && n[pos] && n_len - pos > a_len)
+		pos += n[pos] + 1;
+
+	if (pos >= n_len || n_len - pos != a_len)
+		return false;
+
+	for (j = 0; j < a_len; j++)
+		if (LDNS_DNAME_NORMALIZE((int)n[pos + j])
+		 != LDNS_DNAME_NORMALIZE((int)a[j]))
+			return false;
+	return true;
+}
+
 INLINE void
 dnssec_zone_rr_iter_set_state_for_next_name(dnssec_zone_rr_iter *i)
 {
@@ -1316,7 +1349,7 @@ dnssec_zone_rr_iter_set_state_for_next_name(dnssec_zone_rr_iter *i)
 		&& (  ldns_dname_label_count(name) != i->apex_labs
 		   || ldns_dname_compare(name, i->apex_name)) /* not apex */
 
-		&& !ldns_dname_is_subdomain(name, i->apex_name) /* no sub */) {
+		&& !dnssec_zone_rr_iter_is_subdomain(name, i->apex_name)) {
 
 			/* next name */
 			i->node = ldns_rbtree_next(i->node);
@@ -1725,6 +1758,209 @@ zone_digester_export(
 	return NULL;
 }
 
+/* Apex ZONEMD RRs and their signatures are not part of the digest */
+INLINE bool
+zone_digest_skip_rr(ldns_rr *rr, ldns_rdf *apex_name)
+{
+	if (ldns_rr_get_type(rr) == LDNS_RR_TYPE_ZONEMD)
+		return !ldns_dname_compare(ldns_rr_owner(rr), apex_name);
+
+	return ldns_rr_get_type(rr) == LDNS_RR_TYPE_RRSIG
+	    && LDNS_RR_TYPE_ZONEMD == ldns_rdf2rr_type(
+			ldns_rr_rrsig_typecovered(rr))
+	    && !ldns_dname_compare(ldns_rr_owner(rr), apex_name);
+}
+
+#ifdef HAVE_PTHREAD
+/*
+ * With large zones the digests are computed in a pipeline.  The calling
+ * thread walks the zone and writes the RRs in canonical wire format in
+ * large batches, while a thread per hash algorithm digests the batches.
+ * The batches are in a ring, and a batch is reused once all hash threads
+ * are done with it.  Each hash thread sees the same bytes in the same
+ * order as zone_digester_update() would, so the digests are identical.
+ */
+#define ZONE_DIGEST_BATCH_SIZE	(1024 * 1024)
+#define ZONE_DIGEST_BATCHES	4
+#define ZONE_DIGEST_MAX_RR	(LDNS_MAX_DOMAINLEN + 10 + LDNS_MAX_RDFLEN)
+/* Smaller zones are digested without threads */
+#define ZONE_DIGEST_MIN_NAMES	1024
+
+struct struct_zone_digest_batch {
+	uint8_t *data;
+	size_t len;
+	/* number of hash threads that still have to digest this batch */
+	unsigned pending;
+};
+typedef struct struct_zone_digest_batch zone_digest_batch;
+
+struct struct_zone_digest_pipe {
+	pthread_mutex_t lock;
+	pthread_cond_t filled;
+	pthread_cond_t drained;
+	zone_digest_batch batches[ZONE_DIGEST_BATCHES];
+	/* number of batches handed to the hash threads */
+	size_t produced;
+	/* no more batches will be produced */
+	bool done;
+	unsigned hashers;
+};
+typedef struct struct_zone_digest_pipe zone_digest_pipe;
+
+struct struct_zone_digest_hasher {
+	zone_digest_pipe *pipe;
+	zone_digester *zd;
+	zonemd_hash hash;
+	pthread_t thread;
+};
+typedef struct struct_zone_digest_hasher zone_digest_hasher;
+
+static void *
+zone_digest_hasher_run(void *arg)
+{
+	zone_digest_hasher *h = (zone_digest_hasher *)arg;
+	zone_digest_pipe *p = h->pipe;
+	zone_digest_batch *b;
+	size_t seq;
+
+	for (seq = 0; ; seq++) {
+		pthread_mutex_lock(&p->lock);
+		while (p->produced <= seq && !p->done)
+			pthread_cond_wait(&p->filled, &p->lock);
+		if (p->produced <= seq) {
+			pthread_mutex_unlock(&p->lock);
+			break;
+		}
+		pthread_mutex_unlock(&p->lock);
+
+		b = &p->batches[seq % ZONE_DIGEST_BATCHES];
+		if (h->hash == ZONEMD_HASH_SHA384)
+			ldns_sha384_update(&h->zd->sha384_CTX, b->data, b->len);
+		else
+			ldns_sha512_update(&h->zd->sha512_CTX, b->data, b->len);
+
+		pthread_mutex_lock(&p->lock);
+		if (--b->pending == 0)
+			pthread_cond_signal(&p->drained);
+		pthread_mutex_unlock(&p->lock);
+	}
+	return NULL;
+}
+
+/* Hands the current batch to the hash threads, and waits for the next
+ * batch in the ring to be free.
+ */
+static zone_digest_batch *
+zone_digest_pipe_publish(zone_digest_pipe *p, zone_digest_batch *b)
+{
+	pthread_mutex_lock(&p->lock);
+	b->pending = p->hashers;
+	p->produced += 1;
+	pthread_cond_broadcast(&p->filled);
+
+	b = &p->batches[p->produced % ZONE_DIGEST_BATCHES];
+	while (b->pending)
+		pthread_cond_wait(&p->drained, &p->lock);
+	pthread_mutex_unlock(&p->lock);
+	b->len = 0;
+	return b;
+}
+
+static void
+zone_digest_pipe_finish(zone_digest_pipe *p, zone_digest_hasher *hashers,
+		unsigned started)
+{
+	unsigned i;
+
+	pthread_mutex_lock(&p->lock);
+	p->done = true;
+	pthread_cond_broadcast(&p->filled);
+	pthread_mutex_unlock(&p->lock);
+	for (i = 0; i < started; i++)
+		pthread_join(hashers[i].thread, NULL);
+}
+
+/* Returns LDNS_STATUS_NOT_IMPL when the pipeline could not be set up, in
+ * which case nothing has been digested yet.
+ */
+static ldns_status
+ldns_digest_zone_pipelined(ldns_dnssec_zone *zone, zone_digester *zd)
+{
+	ldns_status st = LDNS_STATUS_OK;
+	zone_digest_pipe p;
+	zone_digest_hasher hashers[2];
+	zone_digest_batch *b;
+	unsigned i, started = 0;
+	dnssec_zone_rr_iter rr_iter;
+	ldns_rr *rr;
+	ldns_buffer buf;
+
+	memset(&p, 0, sizeof(p));
+	if (zd->simple_sha384) {
+		hashers[p.hashers].hash = ZONEMD_HASH_SHA384;
+		hashers[p.hashers++].zd = zd;
+	}
+	if (zd->simple_sha512) {
+		hashers[p.hashers].hash = ZONEMD_HASH_SHA512;
+		hashers[p.hashers++].zd = zd;
+	}
+	for (i = 0; i < ZONE_DIGEST_BATCHES; i++) {
+		if (!(p.batches[i].data = LDNS_XMALLOC(uint8_t,
+						ZONE_DIGEST_BATCH_SIZE))) {
+			st = LDNS_STATUS_NOT_IMPL;
+			goto free_batches;
+		}
+	}
+	pthread_mutex_init(&p.lock, NULL);
+	pthread_cond_init(&p.filled, NULL);
+	pthread_cond_init(&p.drained, NULL);
+	for (started = 0; started < p.hashers; started++) {
+		hashers[started].pipe = &p;
+		if (pthread_create(&hashers[started].thread, NULL,
+				zone_digest_hasher_run, &hashers[started]))
+			break;
+	}
+	if (started < p.hashers) {
+		/* Nothing was produced, so nothing was digested */
+		zone_digest_pipe_finish(&p, hashers, started);
+		st = LDNS_STATUS_NOT_IMPL;
+		goto destroy;
+	}
+	buf._fixed = 1;
+	b = &p.batches[0];
+	for ( rr = dnssec_zone_rr_iter_first(&rr_iter, zone)
+	    ; rr && !st
+	    ; rr = dnssec_zone_rr_iter_next(&rr_iter)) {
+
+		if (zone_digest_skip_rr(rr, zone->soa->name))
+			continue;
+
+		if (ZONE_DIGEST_BATCH_SIZE - b->len < ZONE_DIGEST_MAX_RR)
+			b = zone_digest_pipe_publish(&p, b);
+
+		buf._data = b->data + b->len;
+		buf._position = 0;
+		buf._limit = ZONE_DIGEST_BATCH_SIZE - b->len;
+		buf._capacity = ZONE_DIGEST_BATCH_SIZE - b->len;
+		buf._status = LDNS_STATUS_OK;
+		if (!(st = ldns_rr2buffer_wire_canonical(
+						&buf, rr, LDNS_SECTION_ANSWER)))
+			b->len += buf._position;
+	}
+	if (!st && b->len)
+		(void) zone_digest_pipe_publish(&p, b);
+	zone_digest_pipe_finish(&p, hashers, started);
+destroy:
+	pthread_cond_destroy(&p.drained);
+	pthread_cond_destroy(&p.filled);
+	pthread_mutex_destroy(&p.lock);
+free_batches:
+	for (i = 0; i < ZONE_DIGEST_BATCHES; i++)
+		LDNS_FREE(p.batches[i].data);
+	return st;
+}
+#endif /* HAVE_PTHREAD */
+
 static ldns_status
 ldns_digest_zone(ldns_dnssec_zone *zone, zone_digester *zd)
 {
@@ -1736,19 +1972,18 @@ ldns_digest_zone(ldns_dnssec_zone *zone, zone_digester *zd)
 	if (!zone || !zd || !zone->soa || !zone->soa->name)
 		return LDNS_STATUS_NULL;
 
+#ifdef HAVE_PTHREAD
+	if (zone->names && zone->names->count >= ZONE_DIGEST_MIN_NAMES
+	&&  zone_digester_set(zd)
+	&&  (st = ldns_digest_zone_pipelined(zone, zd)) != LDNS_STATUS_NOT_IMPL)
+		return st;
+	st = LDNS_STATUS_OK;
+#endif
 	apex_name = zone->soa->name;
 	for ( rr = dnssec_zone_rr_iter_first(&rr_iter, zone)
 	    ; rr && !st
 	    ; rr = dnssec_zone_rr_iter_next(&rr_iter)) {
-		/* Skip apex ZONEMD RRs */
-		if (ldns_rr_get_type(rr) == LDNS_RR_TYPE_ZONEMD
-		&& !ldns_dname_compare(ldns_rr_owner(rr), apex_name))
-			continue;
-		/* Skip RRSIGs for apex ZONEMD RRs */
-		if (ldns_rr_get_type(rr) == LDNS_RR_TYPE_RRSIG
-		&&  LDNS_RR_TYPE_ZONEMD == ldns_rdf2rr_type(
-				ldns_rr_rrsig_typecovered(rr))
-		&& !ldns_dname_compare(ldns_rr_owner(rr), apex_name))
+		if (zone_digest_skip_rr(rr, apex_name))
 			continue;
 		st = zone_digester_update(zd, rr);
 	}
@@ -452,10 +452,10 @@ do_chase(ldns_resolver *res,
 		ldns_rr_set_type(orig_rr, type);
 		ldns_rr_set_owner(orig_rr, ldns_rdf_clone(name));
 	
-		chain = ldns_dnssec_build_data_chain(res, qflags, rrset, pkt, ldns_rr_clone(orig_rr));
+		chain = ldns_dnssec_build_data_chain_parallel(res, qflags, rrset, pkt, ldns_rr_clone(orig_rr));
 	} else {
 		/* chase the first answer */
-		chain = ldns_dnssec_build_data_chain(res, qflags, rrset, pkt, NULL);
+		chain = ldns_dnssec_build_data_chain_parallel(res, qflags, rrset, pkt, NULL);
 	}
 
 	if (verbosity >= 4) {
@@ -71,6 +71,8 @@ usage(FILE *stream, const char *progname)
 			"\n\t\t\t[QR|qr][AA|aa][TC|tc][RD|rd][CD|cd][RA|ra][AD|ad]\n");
 	fprintf(stream, "\t\t\tlowercase: unset bit, uppercase: set bit\n");
 	fprintf(stream, "\t-p <port>\tuse <port> as remote port number\n");
+	fprintf(stream, "\t-R <file>\tpick the fastest nameserver, keeping round trip\n"
+			"\t\t\ttimes in file from one run to the next\n");
 	fprintf(stream, "\t-s\t\tshow the DS RR for each key in a packet\n");
 	fprintf(stream, "\t-u\t\tsend the query with udp (the default)\n");
 	fprintf(stream, "\t-x\t\tdo a reverse lookup\n");
@@ -120,6 +122,8 @@ main(int argc, char *argv[])
 	char		*progname;
 	char 		*query_file = NULL;
 	char		*answer_file = NULL;
+	char		*rtt_file = NULL;
+	FILE		*rtt_fp;
 	ldns_buffer	*query_buffer = NULL;
 	ldns_rdf 	*serv_rdf;
 	ldns_rdf 	*src_rdf = NULL;
@@ -211,7 +215,7 @@ main(int argc, char *argv[])
 	/* global first, query opt next, option with parm's last
 	 * and sorted */ /*  "46DITSVQf:i:w:q:achuvxzy:so:p:b:k:" */
 	                               
-	while ((c = getopt(argc, argv, "46ab:c:d:Df:hi:I:k:o:p:q:Qr:sStTuvV:w:xy:z")) != -1) {
+	while ((c = getopt(argc, argv, "46ab:c:d:Df:hi:I:k:o:p:q:Qr:R:sStTuvV:w:xy:z")) != -1) {
 		switch(c) {
 			/* global options */
 			case '4':
@@ -278,6 +282,9 @@ main(int argc, char *argv[])
 					exit(EXIT_FAILURE);
 				}
 				break;
+			case 'R':
+				rtt_file = optarg;
+				break;
 			/* query options */
 			case 'a':
 				qfallback = true;
@@ -673,6 +680,16 @@ main(int argc, char *argv[])
 	ldns_resolver_set_fallback(res, qfallback);
 	ldns_resolver_set_usevc(res, qusevc);
 	ldns_resolver_set_random(res, qrandom);
+	if (rtt_file) {
+		ldns_resolver_set_srtt(res, true);
+		if ((rtt_fp = fopen(rtt_file, "r"))) {
+			if (ldns_resolver_read_rtt(res, rtt_fp)
+					!= LDNS_STATUS_OK) {
+				warning("Skipped bad lines in %s", rtt_file);
+			}
+			fclose(rtt_fp);
+		}
+	}
 	if (qbuf != 0) {
 		ldns_resolver_set_edns_udp_size(res, qbuf);
 	}
@@ -1024,6 +1041,17 @@ main(int argc, char *argv[])
 	}
 
 	exit:
+	if (rtt_file && res && ldns_resolver_srtt(res)) {
+		if (!(rtt_fp = fopen(rtt_file, "w"))) {
+			warning("Unable to write %s", rtt_file);
+		} else {
+			if (ldns_resolver_write_rtt(rtt_fp, res)
+					!= LDNS_STATUS_OK) {
+				warning("Unable to write %s", rtt_file);
+			}
+			fclose(rtt_fp);
+		}
+	}
 	ldns_rdf_deep_free(qname);
 	ldns_rdf_deep_free(src_rdf);
 	ldns_resolver_deep_free(res);
@@ -473,3 +473,100 @@ ldns_edns_option_list2wireformat_buffer(const ldns_edns_option_list *option_list
 
 	return buffer;
 }
+
+void
+ldns_edns_option_iter_init(ldns_edns_option_iter *iter, const uint8_t *data,
+		size_t size)
+{
+	iter->_data = data;
+	iter->_size = data ? size : 0;
+	iter->_pos = 0;
+}
+
+bool
+ldns_edns_option_iter_next(ldns_edns_option_iter *iter,
+		ldns_edns_option *option)
+{
+	size_t size;
+
+	if (iter->_pos + 4 > iter->_size) {
+		return false;
+	}
+	size = ldns_read_uint16(&iter->_data[iter->_pos + 2]);
+	if (iter->_pos + 4 + size > iter->_size) {
+		/* the rest is malformed, like pkt_edns_data2edns_option_list
+		 * finds it */
+		iter->_pos = iter->_size;
+		return false;
+	}
+	option->_code = ldns_read_uint16(&iter->_data[iter->_pos]);
+	option->_size = size;
+	option->_data = (void *)(iter->_data + iter->_pos + 4);
+	iter->_pos += 4 + size;
+	return true;
+}
+
+ldns_status
+ldns_edns_option2buffer_wire(ldns_buffer *buffer, ldns_edns_option_code code,
+		size_t size, const void *data)
+{
+	if (size > 65535) {
+		return LDNS_STATUS_RDATA_OVERFLOW;
+	}
+	if (ldns_buffer_reserve(buffer, size + 4)) {
+		ldns_buffer_write_u16(buffer, code);
+		ldns_buffer_write_u16(buffer, (uint16_t)size);
+		ldns_buffer_write(buffer, data, size);
+	}
+	return ldns_buffer_status(buffer);
+}
+
+ldns_status
+ldns_edns_option_list2buffer_wire(ldns_buffer *buffer,
+		const ldns_edns_option_list *option_list)
+{
+	ldns_edns_option *edns;
+	size_t i;
+
+	for (i = 0; i < ldns_edns_option_list_get_count(option_list); i++) {
+		edns = ldns_edns_option_list_get_option(option_list, i);
+		if (ldns_edns_option2buffer_wire(buffer, edns->_code,
+				edns->_size, edns->_data) != LDNS_STATUS_OK) {
+			break;
+		}
+	}
+	return ldns_buffer_status(buffer);
+}
+
+size_t
+ldns_edns_opt_begin(ldns_buffer *buffer, uint16_t udp_size,
+		uint8_t extended_rcode, uint8_t version, uint16_t z)
+{
+	if (!ldns_buffer_reserve(buffer, 11)) {
+		return ldns_buffer_position(buffer);
+	}
+	ldns_buffer_write_u8(buffer, 0);
+	ldns_buffer_write_u16(buffer, LDNS_RR_TYPE_OPT);
+	ldns_buffer_write_u16(buffer, udp_size);
+	ldns_buffer_write_u8(buffer, extended_rcode);
+	ldns_buffer_write_u8(buffer, version);
+	ldns_buffer_write_u16(buffer, z);
+	ldns_buffer_write_u16(buffer, 0);
+	return ldns_buffer_position(buffer);
+}
+
+ldns_status
+ldns_edns_opt_end(ldns_buffer *buffer, size_t start)
+{
+	size_t rdlength;
+
+	if (!ldns_buffer_status_ok(buffer)) {
+		return ldns_buffer_status(buffer);
+	}
+	rdlength = ldns_buffer_position(buffer) - start;
+	if (start < 2 || rdlength > 65535) {
+		return LDNS_STATUS_RDATA_OVERFLOW;
+	}
+	ldns_buffer_write_u16_at(buffer, start - 2, (uint16_t)rdlength);
+	return LDNS_STATUS_OK;
+}
@@ -67,6 +67,7 @@ usage(FILE *fp, const char *prog) {
 	fprintf(fp, "\t\t-t [number] number of hash iterations\n");
 	fprintf(fp, "\t\t-s [string] salt\n");
 	fprintf(fp, "\t\t-p set the opt-out flag on all nsec3 rrs\n");
+	fprintf(fp, "\t\t-H [file] cache hashed owner names in file\n");
 	fprintf(fp, "\n");
 	fprintf(fp, "  keys must be specified by their base name (usually K<name>+<alg>+<id>),\n");
 	fprintf(fp, "  i.e. WITHOUT the .private extension.\n");
@@ -647,6 +648,8 @@ main(int argc, char *argv[])
 	uint16_t nsec3_iterations = 1;
 	uint8_t nsec3_salt_length = 0;
 	uint8_t *nsec3_salt = NULL;
+	const char *nsec3_cache_file = NULL;
+	ldns_nsec3_cache *nsec3_cache = NULL;
 	
 	/* we need to know the origin before reading ksk's,
 	 * so keep an array of filenames until we know it
@@ -673,7 +676,7 @@ main(int argc, char *argv[])
 	
 	keys = ldns_key_list_new();
 
-	while ((c = getopt(argc, argv, "a:bde:f:i:k:no:ps:t:uvz:ZAUE:K:")) != -1) {
+	while ((c = getopt(argc, argv, "a:bde:f:i:k:no:ps:t:uvz:ZAUE:H:K:")) != -1) {
 		switch (c) {
 		case 'a':
 			nsec3_algorithm = (uint8_t) atoi(optarg);
@@ -811,6 +814,9 @@ main(int argc, char *argv[])
 		case 'U':
 			signflags |= LDNS_SIGN_WITH_ALL_ALGORITHMS;
 			break;
+		case 'H':
+			nsec3_cache_file = optarg;
+			break;
 		case 's':
 			if (strlen(optarg) % 2 != 0) {
 				fprintf(stderr, "Salt value is not valid hex data, not a multiple of 2 characters\n");
@@ -1048,7 +1054,22 @@ main(int argc, char *argv[])
 			    "See: https://datatracker.ietf.org/doc/html/"
 			    "draft-hardaker-dnsop-nsec3-guidance-03#section-4\n");
 
-		result = ldns_dnssec_zone_sign_nsec3_flg_mkmap(signed_zone,
+		if (nsec3_cache_file) {
+			nsec3_cache = ldns_nsec3_cache_new();
+			if (!nsec3_cache) {
+				fprintf(stderr, "Memory error\n");
+				exit(EXIT_FAILURE);
+			}
+			s = ldns_nsec3_cache_load(nsec3_cache,
+					nsec3_cache_file);
+			if (s != LDNS_STATUS_OK) {
+				fprintf(stderr, "Warning: ignoring NSEC3 hash "
+				    "cache %s: %s\n", nsec3_cache_file,
+				    ldns_get_errorstr_by_id(s));
+			}
+		}
+		result = ldns_dnssec_zone_sign_nsec3_flg_mkmap_cached(
+			signed_zone,
 			added_rrs,
 			keys,
 			ldns_dnssec_default_replace_signatures,
@@ -1059,7 +1080,33 @@ main(int argc, char *argv[])
 			nsec3_salt_length,
 			nsec3_salt,
 			signflags,
-			&fmt_st.hashmap);
+			&fmt_st.hashmap,
+			nsec3_cache);
+		if (nsec3_cache && result == LDNS_STATUS_OK) {
+			size_t hits = ldns_nsec3_cache_hits(nsec3_cache);
+			size_t lookups = hits
+			               + ldns_nsec3_cache_misses(nsec3_cache);
+
+			s = ldns_nsec3_cache_save(nsec3_cache,
+					nsec3_cache_file);
+			if (s != LDNS_STATUS_OK) {
+				fprintf(stderr, "Error writing NSEC3 hash "
+				    "cache %s: %s\n", nsec3_cache_file,
+				    ldns_get_errorstr_by_id(s));
+			}
+			if (verbosity >= 1) {
+				fprintf(stderr, "NSEC3 hash cache: %u of %u "
+				    "hashes cached (%.1f%%), saved %.3f "
+				    "seconds%s\n", (unsigned int)hits,
+				    (unsigned int)lookups, lookups
+				    ? 100.0 * hits / lookups : 0.0,
+				    ldns_nsec3_cache_time_saved(nsec3_cache)
+				    / 1000000.0,
+				    ldns_nsec3_cache_invalidations(nsec3_cache)
+				    ? ", parameters changed" : "");
+			}
+		}
+		ldns_nsec3_cache_free(nsec3_cache);
 	} else {
 		result = ldns_dnssec_zone_sign_flg(signed_zone,
 				added_rrs,
@@ -169,6 +169,7 @@ struct sockaddr_storage;
 #define INBUF_SIZE 4096         /* max size for incoming queries */
 #define DEFAULT_PORT 53		/* default if no -p port is specified */
 #define CONN_BACKLOG 256	/* connections queued up for tcp */
+#define UDP_BATCH 32		/* udp queries read, and answers sent, at once */
 static const char* prog_name = "ldns-testns";
 static FILE* logfile = 0;
 static int do_verbose = 0;
@@ -243,6 +244,13 @@ static int bind_port(int sock, int port, int fam)
     return bind(sock, (struct sockaddr *)&addr, (socklen_t) sizeof(addr));
 }
 
+/* udp queries and answers, a batch at a time */
+static ldns_udp_msg* udp_in;
+static ldns_udp_msg* udp_out;
+static size_t udp_out_count;
+/* entries sleep before (some) answers, so send those right away */
+static int udp_send_now;
+
 struct handle_udp_userdata {
 	int udp_sock;
 	struct sockaddr_storage addr_him;
@@ -254,6 +262,17 @@ send_udp(uint8_t* buf, size_t len, void* data)
 	struct handle_udp_userdata *userdata = (struct handle_udp_userdata*)data;
 	/* udp send reply */
 	ssize_t nb;
+	ldns_udp_msg* m;
+	if(!udp_send_now && udp_out_count < UDP_BATCH &&
+		len <= udp_out[udp_out_count].size) {
+		/* sent with the rest of the batch */
+		m = &udp_out[udp_out_count++];
+		memcpy(m->data, buf, len);
+		m->len = len;
+		memcpy(&m->addr, &userdata->addr_him, (size_t)userdata->hislen);
+		m->addrlen = userdata->hislen;
+		return;
+	}
 	nb = sendto(userdata->udp_sock, (void*)buf, len, 0, 
 		(struct sockaddr*)&userdata->addr_him, userdata->hislen);
 	if(nb == -1)
@@ -266,15 +285,12 @@ send_udp(uint8_t* buf, size_t len, void* data)
 static void
 handle_udp(int udp_sock, struct entry* entries, int *count)
 {
-	ssize_t nb;
-	uint8_t inbuf[INBUF_SIZE];
+	ssize_t nb, i;
 	struct handle_udp_userdata userdata;
 	userdata.udp_sock = udp_sock;
 
-	userdata.hislen = (socklen_t)sizeof(userdata.addr_him);
 	/* udp recv */
-	nb = recvfrom(udp_sock, (void*)inbuf, INBUF_SIZE, 0, 
-		(struct sockaddr*)&userdata.addr_him, &userdata.hislen);
+	nb = ldns_udp_recv_batch(udp_sock, udp_in, UDP_BATCH);
 	if (nb < 1) {
 #ifndef USE_WINSOCK
 		log_msg("recvfrom(): %s\n", strerror(errno));
@@ -286,54 +302,49 @@ handle_udp(int udp_sock, struct entry* entries, int *count)
 #endif
 		return;
 	}
-	handle_query(inbuf, nb, entries, count, transport_udp, send_udp, 
-		&userdata, do_verbose?logfile:0);
-}
-
-static int
-read_n_bytes(int sock, uint8_t* buf, size_t sz)
-{
-	size_t count = 0;
-	while(count < sz) {
-		ssize_t nb = recv(sock, (void*)(buf+count), sz-count, 0);
-		if(nb < 0) {
-			log_msg("recv(): %s\n", strerror(errno));
-			return -1;
-		} else if(nb == 0) {
-			log_msg("recv: remote end closed the channel\n");
-			return sz-count;
-		}
-		count += nb;
+	for(i = 0; i < nb; i++) {
+		if(udp_in[i].len < 1)
+			continue;
+		memcpy(&userdata.addr_him, &udp_in[i].addr,
+			(size_t)udp_in[i].addrlen);
+		userdata.hislen = udp_in[i].addrlen;
+		handle_query(udp_in[i].data, (ssize_t)udp_in[i].len, entries,
+			count, transport_udp, send_udp, &userdata,
+			do_verbose?logfile:0);
 	}
-	return 0;
-}
-
-static void
-write_n_bytes(int sock, uint8_t* buf, size_t sz)
-{
-	size_t count = 0;
-	while(count < sz) {
-		ssize_t nb = send(sock, (void*)(buf+count), sz-count, 0);
-		if(nb < 0) {
-			log_msg("send(): %s\n", strerror(errno));
-			return;
-		}
-		count += nb;
+	if(udp_out_count > 0) {
+		nb = ldns_udp_send_batch(udp_sock, udp_out, udp_out_count);
+		if(nb == -1)
+			log_msg("sendto(): %s\n", strerror(errno));
+		else if((size_t)nb != udp_out_count)
+			log_msg("sendto(): only sent %d of %d answers.\n",
+				(int)nb, (int)udp_out_count);
+		udp_out_count = 0;
 	}
 }
 
 struct handle_tcp_userdata {
 	int s;
+	ldns_tcp_writer w;
 };
 static void
 send_tcp(uint8_t* buf, size_t len, void* data)
 {
 	struct handle_tcp_userdata *userdata = (struct handle_tcp_userdata*)data;
-	uint16_t tcplen;
-	/* tcp send reply */
-	tcplen = htons(len);
-	write_n_bytes(userdata->s, (uint8_t*)&tcplen, sizeof(tcplen));
-	write_n_bytes(userdata->s, buf, len);
+	/* tcp send reply, length and message in one write so that clients
+	 * that keep the connection open do not wait on a delayed ack */
+	if(!ldns_tcp_writer_add(&userdata->w, buf, len)) {
+		log_msg("send_tcp: answer too large\n");
+		return;
+	}
+	while(ldns_tcp_writer_pending(&userdata->w) > 0) {
+		if(ldns_tcp_writer_flush(&userdata->w, userdata->s)
+			!= LDNS_STATUS_OK) {
+			log_msg("send(): %s\n", strerror(errno));
+			ldns_tcp_writer_init(&userdata->w);
+			return;
+		}
+	}
 }
 
 static void
@@ -342,8 +353,10 @@ handle_tcp(int tcp_sock, struct entry* entries, int *count)
 	int s;
 	struct sockaddr_storage addr_him;
 	socklen_t hislen;
-	uint8_t inbuf[INBUF_SIZE];
-	uint16_t tcplen = 0;
+	ldns_tcp_reader reader;
+	const uint8_t *query;
+	size_t len;
+	ldns_status status;
 	struct handle_tcp_userdata userdata;
 
 	/* accept */
@@ -353,42 +366,32 @@ handle_tcp(int tcp_sock, struct entry* entries, int *count)
 		return;
 	}
 	userdata.s = s;
+	ldns_tcp_writer_init(&userdata.w);
+	ldns_tcp_reader_init(&reader);
 
 	while(1) {
-		/* tcp recv */
-		if (read_n_bytes(s, (uint8_t*)&tcplen, sizeof(tcplen))) {
-#ifndef USE_WINSOCK
-			close(s);
-#else
-			closesocket(s);
-#endif
-			return;
-		}
-		tcplen = ntohs(tcplen);
-		if(tcplen >= INBUF_SIZE) {
-			log_msg("query %d bytes too large, buffer %d bytes.\n",
-				tcplen, INBUF_SIZE);
+		/* tcp recv; the queries that came in one read are all
+		 * answered before reading again */
+		while(!ldns_tcp_reader_get(&reader, &query, &len)) {
+			status = ldns_tcp_reader_recv(&reader, s);
+			if(status != LDNS_STATUS_OK) {
+				log_msg("recv: remote end closed the "
+					"channel\n");
+				ldns_tcp_reader_clear(&reader);
 #ifndef USE_WINSOCK
-			close(s);
+				close(s);
 #else
-			closesocket(s);
+				closesocket(s);
 #endif
-			return;
-		}
-		if (read_n_bytes(s, inbuf, tcplen)) {
-#ifndef USE_WINSOCK
-			close(s);
-#else
-			closesocket(s);
-#endif
-			return;
+				return;
+			}
 		}
 
-		handle_query(inbuf, (ssize_t) tcplen, entries, count, transport_tcp, 
+		handle_query(query, (ssize_t) len, entries, count, transport_tcp, 
 			send_tcp, &userdata, do_verbose?logfile:0);
 
 		/* another query straight away? */
-		if(1) {
+		if(!ldns_tcp_reader_partial(&reader)) {
 			fd_set rset;
 			struct timeval tv;
 			int ret;
@@ -406,6 +409,7 @@ handle_tcp(int tcp_sock, struct entry* entries, int *count)
 			}
 		}
 	}
+	ldns_tcp_reader_clear(&reader);
 #ifndef USE_WINSOCK
 	close(s);
 #else
@@ -499,6 +503,8 @@ main(int argc, char **argv)
 
 	/* network */
 	int fam = AF_INET;
+	struct entry* p;
+	struct reply_packet* r;
 	bool random_port_success;
 
 #ifdef USE_WINSOCK
@@ -551,6 +557,17 @@ main(int argc, char **argv)
 	datafile = argv[0];
 	log_msg("Reading datafile %s\n", datafile);
 	entries = read_datafile(datafile, 0);
+	for(p = entries; p; p = p->next) {
+		if(p->sleeptime > 0)
+			udp_send_now = 1;
+		for(r = p->reply_list; r; r = r->next)
+			if(r->packet_sleep > 0)
+				udp_send_now = 1;
+	}
+	udp_in = ldns_udp_msgs_new(UDP_BATCH, INBUF_SIZE);
+	udp_out = ldns_udp_msgs_new(UDP_BATCH, INBUF_SIZE);
+	if(!udp_in || !udp_out)
+		error("out of memory\n");
 
 #ifdef SIGPIPE
         (void)signal(SIGPIPE, SIG_IGN);
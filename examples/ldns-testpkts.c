@@ -850,7 +850,7 @@ adjust_packet(struct entry* match, ldns_pkt* answer_pkt, ldns_pkt* query_pkt)
  * and calls the given function for every packet to send.
  */
 void
-handle_query(uint8_t* inbuf, ssize_t inlen, struct entry* entries, int* count,
+handle_query(const uint8_t* inbuf, ssize_t inlen, struct entry* entries, int* count,
 	enum transport_type transport, void (*sendfunc)(uint8_t*, size_t, void*),
 	void* userdata, FILE* verbose_out)
 {
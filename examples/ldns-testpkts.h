@@ -266,7 +266,7 @@ void adjust_packet(struct entry* match, ldns_pkt* answer_pkt,
  * @param userdata: userarg to give to sendfunc.
  * @param verbose_out: if not NULL, verbose messages are printed there.
  */
-void handle_query(uint8_t* inbuf, ssize_t inlen, struct entry* entries, 
+void handle_query(const uint8_t* inbuf, ssize_t inlen, struct entry* entries, 
 	int* count, enum transport_type transport, 
 	void (*sendfunc)(uint8_t*, size_t, void*), void* userdata,
 	FILE* verbose_out);
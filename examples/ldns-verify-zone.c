@@ -26,6 +26,8 @@ static int32_t inception_offset = 0;
 static int32_t expiration_offset = 0;
 static bool do_sigchase = false;
 static bool no_nomatch_msg = false;
+static int threads = -1;
+static bool signatures_verified = false;
 
 static FILE* myout;
 static FILE* myerr;
@@ -173,6 +175,10 @@ verify_rrs(ldns_rr_list* rrset_rrs, ldns_dnssec_rrs* cur_sig,
 	ldns_status status, result = LDNS_STATUS_OK;
 	ldns_dnssec_rrs *cur_sig_bak = cur_sig;
 
+	/* Already done by ldns_dnssec_zone_verify_signatures() */
+	if (signatures_verified)
+		return LDNS_STATUS_OK;
+
 	/* A single valid signature validates the RRset */
 	while (cur_sig) {
 		if (ldns_verify_rrsig_keylist_time( rrset_rrs, cur_sig->rr
@@ -618,6 +624,46 @@ sigchase(ldns_resolver* res, ldns_rdf *zone_name, ldns_dnssec_rrsets *zonekeys,
 	return status;
 }
 
+static ldns_status
+verify_signatures_parallel(ldns_dnssec_zone *dnssec_zone, ldns_rr_list *keys)
+{
+	ldns_dnssec_verify_errors *errors = NULL;
+	ldns_dnssec_verify_error *e;
+	ldns_status status, result = LDNS_STATUS_OK;
+	size_t i;
+
+	status = ldns_dnssec_zone_verify_signatures(dnssec_zone, keys,
+			check_time, inception_offset, expiration_offset,
+			(size_t) threads, &errors);
+	if (!errors) {
+		if (verbosity > 0) {
+			fprintf(myerr, "Error verifying signatures: %s\n",
+					ldns_get_errorstr_by_id(status));
+		}
+		return status;
+	}
+	for (i = 0; i < errors->count; i++) {
+		e = &errors->errors[i];
+		if (verbosity > 0 && (!no_nomatch_msg || e->reason !=
+		    LDNS_STATUS_CRYPTO_NO_MATCHING_KEYTAG_DNSKEY)) {
+			fprintf(myerr, "Error: %s for ",
+					ldns_get_errorstr_by_id(e->reason));
+			ldns_rdf_print(myerr, e->name);
+			fprintf(myerr, "\t");
+			print_type(myerr, e->type);
+			fprintf(myerr, "\n");
+		}
+		update_error(&result, e->reason);
+	}
+	if (verbosity >= 5) {
+		fprintf(myout, "Verified %zu signatures over %zu RRsets\n",
+				errors->signatures, errors->rrsets);
+	}
+	ldns_dnssec_verify_errors_free(errors);
+	signatures_verified = true;
+	return result;
+}
+
 static ldns_status
 verify_dnssec_zone(ldns_dnssec_zone *dnssec_zone, ldns_rdf *zone_name,
 		ldns_rr_list *keys, bool apexonly, int percentage,
@@ -667,6 +713,9 @@ verify_dnssec_zone(ldns_dnssec_zone *dnssec_zone, ldns_rdf *zone_name,
 			 * be checked.
 			 */
 			percentage = 100;
+		} else if (threads >= 0 && percentage == 100) {
+			status = verify_signatures_parallel(dnssec_zone, keys);
+			update_error(&result, status);
 		}
 		while (cur_node != LDNS_RBTREE_NULL) {
 			/* should we check this one? saves calls to random. */
@@ -706,6 +755,10 @@ static void print_usage(FILE *out, const char *progname)
 	fprintf(out, "\t-i <period>\tsignatures must have been "
 	       "valid at least this long.\n\t\t\t"
 	       "(default signatures should just be valid now)\n");
+	fprintf(out, "\t-j <threads>\tverify the signatures with this many "
+	       "threads.\n\t\t\tWith 0 one thread per CPU is used. "
+	       "(default the\n\t\t\tsignatures are verified one by one "
+	       "with the zone)\n");
 	fprintf(out, "\t-k <file>\tspecify a file that contains a "
 	       "trusted DNSKEY or DS rr.\n\t\t\t"
 	       "This option may be given more than once.\n"
@@ -759,7 +812,7 @@ main(int argc, char **argv)
 	myout = stdout;
 	myerr = stderr;
 
-	while ((c = getopt(argc, argv, "ae:hi:k:vV:p:St:Z")) != -1) {
+	while ((c = getopt(argc, argv, "ae:hi:j:k:vV:p:St:Z")) != -1) {
 		switch(c) {
                 case 'a':
                         apexonly = true;
@@ -788,6 +841,17 @@ main(int argc, char **argv)
 				inception_offset =
 					ldns_duration2time(duration);
 			break;
+		case 'j':
+			threads = atoi(optarg);
+			if (threads < 0) {
+				if (verbosity > 0) {
+					fprintf(myerr,
+						"number of threads can not "
+						"be negative\n");
+				}
+				exit(EXIT_FAILURE);
+			}
+			break;
 		case 'k':
 			s = read_key_file(optarg, keys);
 			if (s == LDNS_STATUS_FILE_ERR) {
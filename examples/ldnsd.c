@@ -29,6 +29,7 @@
 #include <errno.h>
 
 #define INBUF_SIZE 4096
+#define UDP_BATCH 32	/* queries read, and answers sent, at once */
 
 static void usage(FILE *output)
 {
@@ -98,23 +99,20 @@ main(int argc, char **argv)
 
 	/* network */
 	int sock;
-	ssize_t nb;
+	ssize_t nb, i;
 	struct sockaddr addr_me;
-	struct sockaddr addr_him;
-	socklen_t hislen = (socklen_t) sizeof(addr_him);
-	uint8_t inbuf[INBUF_SIZE];
-	uint8_t *outbuf;
+	ldns_udp_msg *in;
+	ldns_udp_msg *out;
+	size_t nout;
 
 	/* dns */
 	ldns_status status;
-	ldns_pkt *query_pkt;
-	ldns_pkt *answer_pkt;
-	size_t answer_size;
-	ldns_rr *query_rr;
-	ldns_rr_list *answer_qr;
+	ldns_query_info qi;
+	ldns_response resp;
+	ldns_buffer *answer;
+	ldns_rdf *qname;
+	char *qtype_str;
 	ldns_rr_list *answer_an;
-	ldns_rr_list *answer_ns;
-	ldns_rr_list *answer_ad;
 	ldns_rdf *origin = NULL;
 	
 	/* zone */
@@ -175,65 +173,71 @@ main(int argc, char **argv)
 		exit(errno);
 	}
 
-	/* Done. Now receive */
+	in = ldns_udp_msgs_new(UDP_BATCH, INBUF_SIZE);
+	out = ldns_udp_msgs_new(UDP_BATCH, LDNS_MAX_PACKETLEN);
+	answer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	if (!in || !out || !answer) {
+		fprintf(stderr, "%s: out of memory\n", argv[0]);
+		exit(1);
+	}
+
+	/* Done. Now receive, a batch of queries at a time */
 	while (1) {
-		nb = recvfrom(sock, (void*)inbuf, INBUF_SIZE, 0, 
-			&addr_him, &hislen);
+		nb = ldns_udp_recv_batch(sock, in, UDP_BATCH);
 		if (nb < 1) {
 			fprintf(stderr, "%s: recvfrom(): %s\n",
 			argv[0], strerror(errno));
 			exit(1);
 		}
 
-		/*
-		show(inbuf, nb, nn, hp, sp, ip, bp);
-		*/
-		printf("Got query of %u bytes\n", (unsigned int) nb);
-		status = ldns_wire2pkt(&query_pkt, inbuf, (size_t) nb);
-		if (status != LDNS_STATUS_OK) {
-			printf("Got bad packet: %s\n", ldns_get_errorstr_by_id(status));
-		} else {
-			ldns_pkt_print(stdout, query_pkt);
+		nout = 0;
+		for (i = 0; i < nb; i++) {
+			printf("Got query of %u bytes\n", (unsigned int) in[i].len);
+			/* No ldns_pkt is made for the query or the answer */
+			status = ldns_query_info_from_wire(&qi, in[i].data, in[i].len);
+			if (status != LDNS_STATUS_OK) {
+				printf("Got bad packet: %s\n", ldns_get_errorstr_by_id(status));
+				continue;
+			}
+			qname = ldns_dname_new_frm_data(qi.qname_size, qi.qname);
+			if (!qname) {
+				continue;
+			}
+			qtype_str = ldns_rr_type2str(qi.qtype);
+			printf("QUERY: ");
+			ldns_rdf_print(stdout, qname);
+			printf(" %s\n", qtype_str ? qtype_str : "");
+			LDNS_FREE(qtype_str);
+
+			answer_an = get_rrset(zone, qname, qi.qtype, qi.qclass);
+			status = ldns_response_init(&resp, answer, &qi,
+					ldns_query_info_max_udp(&qi));
+			if (status == LDNS_STATUS_OK) {
+				ldns_response_set_flags(&resp, LDNS_AA);
+				/* Sets TC when it does not fit */
+				(void) ldns_response_add_rr_list(&resp,
+						LDNS_SECTION_ANSWER, answer_an);
+				status = ldns_response_finish(&resp);
+			}
+
+			printf("Answer packet size: %u bytes.\n", (unsigned int) ldns_buffer_position(answer));
+			if (status != LDNS_STATUS_OK) {
+				printf("Error creating answer: %s\n", ldns_get_errorstr_by_id(status));
+			} else {
+				/* sent with the rest of the batch */
+				memcpy(out[nout].data, ldns_buffer_begin(answer),
+						ldns_buffer_position(answer));
+				out[nout].len = ldns_buffer_position(answer);
+				memcpy(&out[nout].addr, &in[i].addr, in[i].addrlen);
+				out[nout].addrlen = in[i].addrlen;
+				nout++;
+			}
+
+			ldns_rdf_deep_free(qname);
+			ldns_rr_list_deep_free(answer_an);
 		}
 
-		query_rr = ldns_rr_list_rr(ldns_pkt_question(query_pkt), 0);
-		printf("QUERY RR: \n");
-		ldns_rr_print(stdout, query_rr);
-		
-		answer_qr = ldns_rr_list_new();
-		ldns_rr_list_push_rr(answer_qr, ldns_rr_clone(query_rr));
-
-		answer_an = get_rrset(zone, ldns_rr_owner(query_rr), ldns_rr_get_type(query_rr), ldns_rr_get_class(query_rr));
-		answer_pkt = ldns_pkt_new();
-		answer_ns = ldns_rr_list_new();
-		answer_ad = ldns_rr_list_new();
-		
-		ldns_pkt_set_qr(answer_pkt, 1);
-		ldns_pkt_set_aa(answer_pkt, 1);
-		ldns_pkt_set_id(answer_pkt, ldns_pkt_id(query_pkt));
-
-		ldns_pkt_push_rr_list(answer_pkt, LDNS_SECTION_QUESTION, answer_qr);
-		ldns_pkt_push_rr_list(answer_pkt, LDNS_SECTION_ANSWER, answer_an);
-		ldns_pkt_push_rr_list(answer_pkt, LDNS_SECTION_AUTHORITY, answer_ns);
-		ldns_pkt_push_rr_list(answer_pkt, LDNS_SECTION_ADDITIONAL, answer_ad);
-
-		status = ldns_pkt2wire(&outbuf, answer_pkt, &answer_size);
-		
-		printf("Answer packet size: %u bytes.\n", (unsigned int) answer_size);
-		if (status != LDNS_STATUS_OK) {
-			printf("Error creating answer: %s\n", ldns_get_errorstr_by_id(status));
-		} else {
-			(void) sendto(sock, (void*)outbuf, answer_size, 0, 
-				&addr_him, hislen);
-		}
-		
-		ldns_pkt_free(query_pkt);
-		ldns_pkt_free(answer_pkt);
-		LDNS_FREE(outbuf);
-		ldns_rr_list_free(answer_qr);
-		ldns_rr_list_free(answer_an);
-		ldns_rr_list_free(answer_ns);
-		ldns_rr_list_free(answer_ad);
+		(void) ldns_udp_send_batch(sock, out, nout);
 	}
 	
 	/* No cleanup because of the infinite loop
@@ -3272,20 +3272,41 @@ ldns_buffer_export2str(ldns_buffer *buffer)
 	return ldns_buffer_export(buffer);
 }
 
+/*
+ * Zero terminate the buffer and copy the data into a string of its size,
+ * so that the buffer can be used again.
+ */
+static char *
+ldns_buffer_copy2str(ldns_buffer *buffer)
+{
+	char *str;
+
+	if (!ldns_buffer_reserve(buffer, 1)) {
+		return NULL;
+	}
+	ldns_buffer_write_char(buffer, 0);
+	str = LDNS_XMALLOC(char, ldns_buffer_position(buffer));
+	if (str) {
+		memcpy(str, ldns_buffer_begin(buffer),
+				ldns_buffer_position(buffer));
+	}
+	return str;
+}
+
 char *
 ldns_rdf2str(const ldns_rdf *rdf)
 {
 	char *result = NULL;
-	ldns_buffer *tmp_buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *tmp_buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 
 	if (!tmp_buffer) {
 		return NULL;
 	}
 	if (ldns_rdf2buffer_str(tmp_buffer, rdf) == LDNS_STATUS_OK) {
-		/* export and return string, destroy rest */
-		result = ldns_buffer_export2str(tmp_buffer);
+		/* copy and return string, keep the buffer */
+		result = ldns_buffer_copy2str(tmp_buffer);
 	}
-	ldns_buffer_free(tmp_buffer);
+	ldns_buffer_release(tmp_buffer);
 	return result;
 }
 
@@ -3293,17 +3314,17 @@ char *
 ldns_rr2str_fmt(const ldns_output_format *fmt, const ldns_rr *rr)
 {
 	char *result = NULL;
-	ldns_buffer *tmp_buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *tmp_buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 
 	if (!tmp_buffer) {
 		return NULL;
 	}
 	if (ldns_rr2buffer_str_fmt(tmp_buffer, fmt, rr)
 		       	== LDNS_STATUS_OK) {
-		/* export and return string, destroy rest */
-		result = ldns_buffer_export2str(tmp_buffer);
+		/* copy and return string, keep the buffer */
+		result = ldns_buffer_copy2str(tmp_buffer);
 	}
-	ldns_buffer_free(tmp_buffer);
+	ldns_buffer_release(tmp_buffer);
 	return result;
 }
 
@@ -3317,18 +3338,18 @@ char *
 ldns_pkt2str_fmt(const ldns_output_format *fmt, const ldns_pkt *pkt)
 {
 	char *result = NULL;
-	ldns_buffer *tmp_buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *tmp_buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 
 	if (!tmp_buffer) {
 		return NULL;
 	}
 	if (ldns_pkt2buffer_str_fmt(tmp_buffer, fmt, pkt)
 		       	== LDNS_STATUS_OK) {
-		/* export and return string, destroy rest */
-		result = ldns_buffer_export2str(tmp_buffer);
+		/* copy and return string, keep the buffer */
+		result = ldns_buffer_copy2str(tmp_buffer);
 	}
 
-	ldns_buffer_free(tmp_buffer);
+	ldns_buffer_release(tmp_buffer);
 	return result;
 }
 
@@ -3342,6 +3363,7 @@ char *
 ldns_key2str(const ldns_key *k)
 {
 	char *result = NULL;
+	/* not from the pool, the private key should not stay around */
 	ldns_buffer *tmp_buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
 
 	if (!tmp_buffer) {
@@ -3359,7 +3381,7 @@ char *
 ldns_rr_list2str_fmt(const ldns_output_format *fmt, const ldns_rr_list *list)
 {
 	char *result = NULL;
-	ldns_buffer *tmp_buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *tmp_buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 
 	if (!tmp_buffer) {
 		return NULL;
@@ -3378,9 +3400,9 @@ ldns_rr_list2str_fmt(const ldns_output_format *fmt, const ldns_rr_list *list)
 		}
 	}
 
-	/* export and return string, destroy rest */
-	result = ldns_buffer_export2str(tmp_buffer);
-	ldns_buffer_free(tmp_buffer);
+	/* copy and return string, keep the buffer */
+	result = ldns_buffer_copy2str(tmp_buffer);
+	ldns_buffer_release(tmp_buffer);
 	return result;
 }
 
@@ -3483,6 +3505,9 @@ ldns_resolver_print_fmt(FILE *output,
 	fprintf(output, "retrans: %d\n", (int)ldns_resolver_retrans(r));
 	fprintf(output, "fallback: %d\n", ldns_resolver_fallback(r));
 	fprintf(output, "random: %d\n", ldns_resolver_random(r));
+	fprintf(output, "race: %d\n", ldns_resolver_race(r));
+	fprintf(output, "srtt: %d\n", ldns_resolver_srtt(r));
+	fprintf(output, "cache: %d\n", ldns_resolver_cache(r) != NULL);
 	fprintf(output, "timeout: %d\n", (int)ldns_resolver_timeout(r).tv_sec);
 	fprintf(output, "dnssec: %d\n", ldns_resolver_dnssec(r));
 	fprintf(output, "dnssec cd: %d\n", ldns_resolver_dnssec_cd(r));
@@ -105,6 +105,200 @@ ldns_dname2buffer_wire_compress(ldns_buffer *buffer, const ldns_rdf *name, ldns_
 	}
 }
 
+/* Most labels a name can have */
+#define LDNS_COMPRESSION_MAX_LABELS	((LDNS_MAX_DOMAINLEN + 1) / 2)
+/* Most suffixes a compression table takes */
+#define LDNS_COMPRESSION_TABLE_MAX	(LDNS_COMPRESSION_TABLE_SIZE / 4 * 3)
+
+void
+ldns_compression_table_init(ldns_compression_table *table)
+{
+	memset(table, 0, sizeof(*table));
+}
+
+void
+ldns_compression_table_truncate(ldns_compression_table *table,
+		size_t position)
+{
+	size_t i;
+
+	/* The names written last are the last inserted, and no probe
+	 * sequence of an earlier name runs through their slots, so emptying
+	 * these slots keeps the earlier names reachable.
+	 */
+	for (i = 0; i < LDNS_COMPRESSION_TABLE_SIZE && table->count > 0; i++) {
+		if (table->entries[i].position != 0
+		&&  table->entries[i].position >= position) {
+			table->entries[i].position = 0;
+			table->count--;
+		}
+	}
+}
+
+/* FNV-1a of a label, lowercased, continuing from the hash of the rest of
+ * the name */
+static uint32_t
+ldns_compression_hash(const uint8_t *label, uint32_t hash)
+{
+	uint8_t i;
+
+	hash = (hash ^ label[0]) * 16777619u;
+	for (i = 1; i <= label[0]; i++) {
+		hash = (hash ^ (uint8_t)tolower((unsigned char)label[i]))
+		     * 16777619u;
+	}
+	return hash;
+}
+
+/* Whether the name at position in the buffer, following compression
+ * pointers, is the uncompressed name at name, ignoring case */
+static bool
+ldns_compression_equal(const ldns_buffer *buffer, size_t position,
+		const uint8_t *name)
+{
+	const uint8_t *wire = ldns_buffer_begin(buffer);
+	size_t end = ldns_buffer_position(buffer);
+	size_t target;
+	uint8_t len, i;
+
+	for (;;) {
+		if (position >= end) {
+			return false;
+		}
+		len = wire[position];
+		if ((len & 0xC0) == 0xC0) {
+			if (position + 1 >= end) {
+				return false;
+			}
+			/* Pointers only point backwards */
+			target = (size_t)(len & 0x3F) << 8 | wire[position + 1];
+			if (target >= position) {
+				return false;
+			}
+			position = target;
+			continue;
+		}
+		if (len != name[0] || position + 1 + len > end) {
+			return false;
+		}
+		if (len == 0) {
+			return true;
+		}
+		for (i = 1; i <= len; i++) {
+			if (tolower((unsigned char)wire[position + i])
+			    != tolower((unsigned char)name[i])) {
+				return false;
+			}
+		}
+		position += 1 + len;
+		name += 1 + len;
+	}
+}
+
+/* The entry of a suffix written before, or NULL */
+static const ldns_compression_entry *
+ldns_compression_find(const ldns_compression_table *table,
+		const ldns_buffer *buffer, uint32_t hash, const uint8_t *suffix)
+{
+	const ldns_compression_entry *entry;
+	size_t slot = hash & (LDNS_COMPRESSION_TABLE_SIZE - 1);
+
+	for (entry = &table->entries[slot]; entry->position != 0;
+			entry = &table->entries[slot]) {
+		if (entry->hash == hash
+		&&  ldns_compression_equal(buffer, entry->position, suffix)) {
+			return entry;
+		}
+		slot = (slot + 1) & (LDNS_COMPRESSION_TABLE_SIZE - 1);
+	}
+	return NULL;
+}
+
+/* Finds the labels of a name, the hashes of its suffixes and its length
+ * up to the root label.  Returns false for names that are not compressed. */
+static bool
+ldns_compression_labels(const ldns_rdf *name,
+		size_t offsets[LDNS_COMPRESSION_MAX_LABELS],
+		uint32_t hashes[LDNS_COMPRESSION_MAX_LABELS], size_t *n,
+		size_t *len)
+{
+	const uint8_t *data = ldns_rdf_data(name);
+	size_t size = ldns_rdf_size(name);
+	uint32_t hash = 2166136261u;
+	size_t raw, i;
+
+	*n = 0;
+	for (raw = 0; raw < size && data[raw] != 0; raw += data[raw] + 1) {
+		if (*n == LDNS_COMPRESSION_MAX_LABELS
+		||  (data[raw] & 0xC0) != 0) {
+			break;
+		}
+		offsets[(*n)++] = raw;
+	}
+	if (raw >= size || data[raw] != 0) {
+		return false;
+	}
+	*len = raw + 1;
+	for (i = *n; i-- > 0; ) {
+		hashes[i] = hash = ldns_compression_hash(data + offsets[i],
+				hash);
+	}
+	return true;
+}
+
+ldns_status
+ldns_dname2buffer_wire_table(ldns_buffer *buffer, const ldns_rdf *name,
+		ldns_compression_table *table)
+{
+	size_t offsets[LDNS_COMPRESSION_MAX_LABELS];
+	uint32_t hashes[LDNS_COMPRESSION_MAX_LABELS];
+	const uint8_t *data = ldns_rdf_data(name);
+	size_t n, i, j, raw, start, slot;
+	const ldns_compression_entry *entry = NULL;
+
+	if (!table
+	||  !ldns_compression_labels(name, offsets, hashes, &n, &raw)) {
+		/* Not a name we can compress, write it as it is */
+		return ldns_dname2buffer_wire_compress(buffer, name, NULL);
+	}
+
+	/* Find the longest suffix written before */
+	for (i = 0; i < n; i++) {
+		if ((entry = ldns_compression_find(table, buffer, hashes[i],
+				data + offsets[i]))) {
+			raw = offsets[i];
+			break;
+		}
+	}
+	start = ldns_buffer_position(buffer);
+	if (!ldns_buffer_reserve(buffer, raw + (i < n ? 2 : 0))) {
+		return ldns_buffer_status(buffer);
+	}
+	ldns_buffer_write(buffer, data, raw);
+	if (i < n) {
+		ldns_buffer_write_u16(buffer, 0xC000 | entry->position);
+	}
+
+	/* Add the suffixes that were not written before */
+	for (j = 0; j < i; j++) {
+		if (start + offsets[j] >= 16384
+		||  table->count >= LDNS_COMPRESSION_TABLE_MAX) {
+			break;
+		}
+		if (start + offsets[j] == 0) {
+			continue;
+		}
+		slot = hashes[j] & (LDNS_COMPRESSION_TABLE_SIZE - 1);
+		while (table->entries[slot].position != 0) {
+			slot = (slot + 1) & (LDNS_COMPRESSION_TABLE_SIZE - 1);
+		}
+		table->entries[slot].hash = hashes[j];
+		table->entries[slot].position = (uint16_t)(start + offsets[j]);
+		table->count++;
+	}
+	return ldns_buffer_status(buffer);
+}
+
 ldns_status
 ldns_rdf2buffer_wire(ldns_buffer *buffer, const ldns_rdf *rdf)
 {
@@ -173,39 +367,11 @@ ldns_rr2buffer_wire_canonical(ldns_buffer *buffer,
 						int section)
 {
 	uint16_t i;
-	uint16_t rdl_pos = 0;
-	bool pre_rfc3597 = false;
-	switch (ldns_rr_get_type(rr)) {
-	case LDNS_RR_TYPE_NS:
-	case LDNS_RR_TYPE_MD:
-	case LDNS_RR_TYPE_MF:
-	case LDNS_RR_TYPE_CNAME:
-	case LDNS_RR_TYPE_SOA:
-	case LDNS_RR_TYPE_MB:
-	case LDNS_RR_TYPE_MG:
-	case LDNS_RR_TYPE_MR:
-	case LDNS_RR_TYPE_PTR:
-	case LDNS_RR_TYPE_HINFO:
-	case LDNS_RR_TYPE_MINFO:
-	case LDNS_RR_TYPE_MX:
-	case LDNS_RR_TYPE_RP:
-	case LDNS_RR_TYPE_AFSDB:
-	case LDNS_RR_TYPE_RT:
-	case LDNS_RR_TYPE_SIG:
-	case LDNS_RR_TYPE_PX:
-	case LDNS_RR_TYPE_NXT:
-	case LDNS_RR_TYPE_NAPTR:
-	case LDNS_RR_TYPE_KX:
-	case LDNS_RR_TYPE_SRV:
-	case LDNS_RR_TYPE_DNAME:
-	case LDNS_RR_TYPE_A6:
-	case LDNS_RR_TYPE_RRSIG:
-		pre_rfc3597 = true;
-		break;
-	default:
-		break;
-	}
-	
+	size_t rdl_pos = 0;
+	/* The types of which the names are lowercased all have a codec */
+	const ldns_rr_codec *codec = ldns_rr_codec_get(ldns_rr_get_type(rr));
+	bool pre_rfc3597 = codec && codec->canonical_lowercase;
+
 	if (ldns_rr_owner(rr)) {
 		(void) ldns_rdf2buffer_wire_canonical(buffer, ldns_rr_owner(rr));
 	}
@@ -222,13 +388,15 @@ ldns_rr2buffer_wire_canonical(ldns_buffer *buffer,
 			rdl_pos = ldns_buffer_position(buffer);
 			ldns_buffer_write_u16(buffer, 0);
 		}	
-		for (i = 0; i < ldns_rr_rd_count(rr); i++) {
-			if (pre_rfc3597) {
-				(void) ldns_rdf2buffer_wire_canonical(
-					buffer, ldns_rr_rdf(rr, i));
-			} else {
-				(void) ldns_rdf2buffer_wire(
-					buffer, ldns_rr_rdf(rr, i));
+		if (!codec || !codec->rdata2wire_canonical(buffer, rr)) {
+			for (i = 0; i < ldns_rr_rd_count(rr); i++) {
+				if (pre_rfc3597) {
+					(void) ldns_rdf2buffer_wire_canonical(
+						buffer, ldns_rr_rdf(rr, i));
+				} else {
+					(void) ldns_rdf2buffer_wire(
+						buffer, ldns_rr_rdf(rr, i));
+				}
 			}
 		}
 		if (rdl_pos != 0) {
@@ -246,14 +414,23 @@ ldns_rr2buffer_wire(ldns_buffer *buffer, const ldns_rr *rr, int section)
 	return ldns_rr2buffer_wire_compress(buffer,rr,section,NULL);
 }
 
-ldns_status
-ldns_rr2buffer_wire_compress(ldns_buffer *buffer, const ldns_rr *rr, int section, ldns_rbtree_t *compression_data)
+/* Writes a RR compressed with either a tree or a table, or neither */
+static ldns_status
+ldns_rr2buffer_wire_any(ldns_buffer *buffer, const ldns_rr *rr, int section,
+		ldns_rbtree_t *compression_data, ldns_compression_table *table)
 {
 	uint16_t i;
-	uint16_t rdl_pos = 0;
+	size_t rdl_pos = 0;
+	const ldns_rr_codec *codec;
 
 	if (ldns_rr_owner(rr)) {
-		(void) ldns_dname2buffer_wire_compress(buffer, ldns_rr_owner(rr), compression_data);
+		if (table) {
+			(void) ldns_dname2buffer_wire_table(buffer,
+					ldns_rr_owner(rr), table);
+		} else {
+			(void) ldns_dname2buffer_wire_compress(buffer,
+					ldns_rr_owner(rr), compression_data);
+		}
 	}
 	
 	if (ldns_buffer_reserve(buffer, 4)) {
@@ -268,14 +445,23 @@ ldns_rr2buffer_wire_compress(ldns_buffer *buffer, const ldns_rr *rr, int section
 			rdl_pos = ldns_buffer_position(buffer);
 			ldns_buffer_write_u16(buffer, 0);
 		}
-		if (LDNS_RR_COMPRESS ==
+		if ((compression_data || table) && LDNS_RR_COMPRESS ==
 		    ldns_rr_descript(ldns_rr_get_type(rr))->_compress) {
 
 			for (i = 0; i < ldns_rr_rd_count(rr); i++) {
-				(void) ldns_rdf2buffer_wire_compress(buffer,
-				    ldns_rr_rdf(rr, i), compression_data);
+				if (table && ldns_rdf_get_type(
+						ldns_rr_rdf(rr, i))
+						== LDNS_RDF_TYPE_DNAME) {
+					(void) ldns_dname2buffer_wire_table(
+					    buffer, ldns_rr_rdf(rr, i), table);
+				} else {
+					(void) ldns_rdf2buffer_wire_compress(
+					    buffer, ldns_rr_rdf(rr, i),
+					    compression_data);
+				}
 			}
-		} else {
+		} else if (!(codec = ldns_rr_codec_get(ldns_rr_get_type(rr)))
+		    || !codec->rdata2wire(buffer, rr)) {
 			for (i = 0; i < ldns_rr_rd_count(rr); i++) {
 				(void) ldns_rdf2buffer_wire(
 				    buffer, ldns_rr_rdf(rr, i));
@@ -290,6 +476,153 @@ ldns_rr2buffer_wire_compress(ldns_buffer *buffer, const ldns_rr *rr, int section
 	return ldns_buffer_status(buffer);
 }
 
+ldns_status
+ldns_rr2buffer_wire_compress(ldns_buffer *buffer, const ldns_rr *rr, int section, ldns_rbtree_t *compression_data)
+{
+	return ldns_rr2buffer_wire_any(buffer, rr, section,
+			compression_data, NULL);
+}
+
+ldns_status
+ldns_rr2buffer_wire_table(ldns_buffer *buffer, const ldns_rr *rr,
+		int section, ldns_compression_table *table)
+{
+	return ldns_rr2buffer_wire_any(buffer, rr, section, NULL, table);
+}
+
+/* Names sized as if they were written after the buffer, with the suffixes
+ * they would add to the compression table */
+struct ldns_compression_sizer
+{
+	const ldns_buffer *buffer;
+	const ldns_compression_table *table;
+	/* Where the next byte would be written */
+	size_t position;
+	/* Suffixes in the table, with the ones that would be added */
+	size_t count;
+	/* The suffixes that would be added */
+	size_t pending;
+	uint32_t hashes[LDNS_COMPRESSION_TABLE_MAX];
+	const uint8_t *suffixes[LDNS_COMPRESSION_TABLE_MAX];
+};
+
+/* Whether two uncompressed name suffixes are equal, ignoring case */
+static bool
+ldns_compression_equal_raw(const uint8_t *a, const uint8_t *b)
+{
+	uint8_t i;
+
+	for (;;) {
+		if (a[0] != b[0]) {
+			return false;
+		}
+		if (a[0] == 0) {
+			return true;
+		}
+		for (i = 1; i <= a[0]; i++) {
+			if (tolower((unsigned char)a[i])
+			    != tolower((unsigned char)b[i])) {
+				return false;
+			}
+		}
+		a += 1 + a[0];
+		b += 1 + b[0];
+	}
+}
+
+/* Sizes a name as ldns_dname2buffer_wire_table() would write it */
+static void
+ldns_compression_sizer_name(struct ldns_compression_sizer *sizer,
+		const ldns_rdf *name)
+{
+	size_t offsets[LDNS_COMPRESSION_MAX_LABELS];
+	uint32_t hashes[LDNS_COMPRESSION_MAX_LABELS];
+	const uint8_t *data = ldns_rdf_data(name);
+	size_t n, i, j, k, raw, start;
+
+	if (!ldns_compression_labels(name, offsets, hashes, &n, &raw)) {
+		sizer->position += ldns_rdf_size(name);
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		if (ldns_compression_find(sizer->table, sizer->buffer,
+				hashes[i], data + offsets[i])) {
+			break;
+		}
+		for (k = 0; k < sizer->pending; k++) {
+			if (sizer->hashes[k] == hashes[i]
+			&&  ldns_compression_equal_raw(sizer->suffixes[k],
+					data + offsets[i])) {
+				break;
+			}
+		}
+		if (k < sizer->pending) {
+			break;
+		}
+	}
+	start = sizer->position;
+	sizer->position += i < n ? offsets[i] + 2 : raw;
+	for (j = 0; j < i; j++) {
+		if (start + offsets[j] >= 16384
+		||  sizer->count >= LDNS_COMPRESSION_TABLE_MAX) {
+			break;
+		}
+		if (start + offsets[j] == 0) {
+			continue;
+		}
+		sizer->hashes[sizer->pending] = hashes[j];
+		sizer->suffixes[sizer->pending++] = data + offsets[j];
+		sizer->count++;
+	}
+}
+
+size_t
+ldns_rr_list_compressed_size(const ldns_buffer *buffer,
+		const ldns_rr_list *rrs, int section,
+		const ldns_compression_table *table)
+{
+	struct ldns_compression_sizer sizer;
+	const ldns_rr *rr;
+	bool compress;
+	size_t i, j;
+
+	sizer.buffer = buffer;
+	sizer.table = table;
+	sizer.position = ldns_buffer_position(buffer);
+	sizer.count = table ? table->count : 0;
+	sizer.pending = 0;
+	for (i = 0; i < ldns_rr_list_rr_count(rrs); i++) {
+		rr = ldns_rr_list_rr(rrs, i);
+		if (ldns_rr_owner(rr)) {
+			if (table) {
+				ldns_compression_sizer_name(&sizer,
+						ldns_rr_owner(rr));
+			} else {
+				sizer.position += ldns_rdf_size(
+						ldns_rr_owner(rr));
+			}
+		}
+		sizer.position += 4;
+		if (section == LDNS_SECTION_QUESTION) {
+			continue;
+		}
+		sizer.position += 6;
+		compress = table && LDNS_RR_COMPRESS ==
+			ldns_rr_descript(ldns_rr_get_type(rr))->_compress;
+		for (j = 0; j < ldns_rr_rd_count(rr); j++) {
+			if (compress && ldns_rdf_get_type(ldns_rr_rdf(rr, j))
+					== LDNS_RDF_TYPE_DNAME) {
+				ldns_compression_sizer_name(&sizer,
+						ldns_rr_rdf(rr, j));
+			} else {
+				sizer.position += ldns_rdf_size(
+						ldns_rr_rdf(rr, j));
+			}
+		}
+	}
+	return sizer.position - ldns_buffer_position(buffer);
+}
+
 ldns_status
 ldns_rrsig2buffer_wire(ldns_buffer *buffer, const ldns_rr *rr)
 {
@@ -314,7 +647,11 @@ ldns_status
 ldns_rr_rdata2buffer_wire(ldns_buffer *buffer, const ldns_rr *rr)
 {
 	uint16_t i;
+	const ldns_rr_codec *codec = ldns_rr_codec_get(ldns_rr_get_type(rr));
 
+	if (codec && codec->rdata2wire(buffer, rr)) {
+		return ldns_buffer_status(buffer);
+	}
 	/* convert all the rdf's */
 	for (i = 0; i < ldns_rr_rd_count(rr); i++) {
 		(void) ldns_rdf2buffer_wire(buffer, ldns_rr_rdf(rr,i));
@@ -364,118 +701,119 @@ ldns_hdr2buffer_wire(ldns_buffer *buffer, const ldns_pkt *packet)
 	return ldns_buffer_status(buffer);
 }
 
-static void
-compression_node_free(ldns_rbnode_t *node, void *arg)
-{
-	(void)arg; /* Yes, dear compiler, it is used */
-	ldns_rdf_deep_free((ldns_rdf *)node->key);
-	LDNS_FREE(node);
-}
+static ldns_status ldns_pkt2buffer_wire_any(ldns_buffer *buffer,
+		const ldns_pkt *packet, ldns_rbtree_t *compression_data,
+		ldns_compression_table *table);
 
 ldns_status
 ldns_pkt2buffer_wire(ldns_buffer *buffer, const ldns_pkt *packet)
 {
-	ldns_status status;
-	ldns_rbtree_t *compression_data = ldns_rbtree_create((int (*)(const void *, const void *))ldns_dname_compare);
-
-	status = ldns_pkt2buffer_wire_compress(buffer, packet, compression_data);
+	ldns_compression_table table;
 
-	ldns_traverse_postorder(compression_data,compression_node_free,NULL);
-	ldns_rbtree_free(compression_data);
+	return ldns_pkt2buffer_wire_table(buffer, packet, &table);
+}
 
-	return status;
+ldns_status
+ldns_pkt2buffer_wire_table(ldns_buffer *buffer, const ldns_pkt *packet,
+		ldns_compression_table *table)
+{
+	ldns_compression_table_init(table);
+	return ldns_pkt2buffer_wire_any(buffer, packet, NULL, table);
 }
 
 ldns_status
 ldns_pkt2buffer_wire_compress(ldns_buffer *buffer, const ldns_pkt *packet, ldns_rbtree_t *compression_data)
+{
+	return ldns_pkt2buffer_wire_any(buffer, packet, compression_data, NULL);
+}
+
+/* Writes a packet compressed with either a tree or a table, or neither */
+static ldns_status
+ldns_pkt2buffer_wire_any(ldns_buffer *buffer, const ldns_pkt *packet,
+		ldns_rbtree_t *compression_data, ldns_compression_table *table)
 {
 	ldns_rr_list *rr_list;
 	uint16_t i;
-
-	/* edns tmp vars */
-	ldns_rr *edns_rr;
-	uint8_t edata[4];
-
-	ldns_buffer *edns_buf = NULL;
-	ldns_rdf    *edns_rdf = NULL;
+	size_t start;
 
 	(void) ldns_hdr2buffer_wire(buffer, packet);
 
 	rr_list = ldns_pkt_question(packet);
 	if (rr_list) {
 		for (i = 0; i < ldns_rr_list_rr_count(rr_list); i++) {
-			(void) ldns_rr2buffer_wire_compress(buffer, 
-			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_QUESTION, compression_data);
+			(void) ldns_rr2buffer_wire_any(buffer, 
+			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_QUESTION, compression_data, table);
 		}
 	}
 	rr_list = ldns_pkt_answer(packet);
 	if (rr_list) {
 		for (i = 0; i < ldns_rr_list_rr_count(rr_list); i++) {
-			(void) ldns_rr2buffer_wire_compress(buffer, 
-			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_ANSWER, compression_data);
+			(void) ldns_rr2buffer_wire_any(buffer, 
+			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_ANSWER, compression_data, table);
 		}
 	}
 	rr_list = ldns_pkt_authority(packet);
 	if (rr_list) {
 		for (i = 0; i < ldns_rr_list_rr_count(rr_list); i++) {
-			(void) ldns_rr2buffer_wire_compress(buffer, 
-			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_AUTHORITY, compression_data);
+			(void) ldns_rr2buffer_wire_any(buffer, 
+			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_AUTHORITY, compression_data, table);
 		}
 	}
 	rr_list = ldns_pkt_additional(packet);
 	if (rr_list) {
 		for (i = 0; i < ldns_rr_list_rr_count(rr_list); i++) {
-			(void) ldns_rr2buffer_wire_compress(buffer, 
-			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_ADDITIONAL, compression_data);
+			(void) ldns_rr2buffer_wire_any(buffer, 
+			             ldns_rr_list_rr(rr_list, i), LDNS_SECTION_ADDITIONAL, compression_data, table);
 		}
 	}
 	
-	/* add EDNS to additional if it is needed */
+	/* add EDNS to additional if it is needed, with the options written
+	 * in place */
 	if (ldns_pkt_edns(packet)) {
-		edns_rr = ldns_rr_new();
-		if(!edns_rr) return LDNS_STATUS_MEM_ERR;
-		ldns_rr_set_owner(edns_rr,
-				ldns_rdf_new_frm_str(LDNS_RDF_TYPE_DNAME, "."));
-		ldns_rr_set_type(edns_rr, LDNS_RR_TYPE_OPT);
-		ldns_rr_set_class(edns_rr, ldns_pkt_edns_udp_size(packet));
-		edata[0] = ldns_pkt_edns_extended_rcode(packet);
-		edata[1] = ldns_pkt_edns_version(packet);
-		ldns_write_uint16(&edata[2], ldns_pkt_edns_z(packet));
-		ldns_rr_set_ttl(edns_rr, ldns_read_uint32(edata));
-		/* don't forget to add the edns rdata (if any) */
-		if ((edns_buf = ldns_edns_option_list2wireformat_buffer(packet->_edns_list))) {
-			edns_rdf = ldns_rdf_new( LDNS_RDF_TYPE_UNKNOWN
-			                       , ldns_buffer_limit(edns_buf)
-			                       , ldns_buffer_export(edns_buf));
-			ldns_buffer_free(edns_buf);
-		}
-		if (edns_rdf)
-			ldns_rr_push_rdf(edns_rr, edns_rdf);
-		else if (packet->_edns_data)
-			ldns_rr_push_rdf(edns_rr, packet->_edns_data);
-		(void)ldns_rr2buffer_wire_compress(buffer, edns_rr, LDNS_SECTION_ADDITIONAL, compression_data);
-		/* if the rdata of the OPT came from packet->_edns_data
-		 * we need to take it back out of the edns_rr before we free it
-		 * so packet->_edns_data doesn't get freed
-		 */
-		if (!edns_rdf && packet->_edns_data)
-			(void)ldns_rr_pop_rdf (edns_rr);
-		ldns_rr_free(edns_rr);
+		start = ldns_edns_opt_begin(buffer,
+				ldns_pkt_edns_udp_size(packet),
+				ldns_pkt_edns_extended_rcode(packet),
+				ldns_pkt_edns_version(packet),
+				ldns_pkt_edns_z(packet));
+		if (packet->_edns_list) {
+			(void) ldns_edns_option_list2buffer_wire(buffer,
+					packet->_edns_list);
+		} else if (packet->_edns_data) {
+			(void) ldns_rdf2buffer_wire(buffer, packet->_edns_data);
+		}
+		(void) ldns_edns_opt_end(buffer, start);
 	}
-	
+
 	/* add TSIG to additional if it is there */
 	if (ldns_pkt_tsig(packet)) {
-		(void) ldns_rr2buffer_wire_compress(buffer,
-		                           ldns_pkt_tsig(packet), LDNS_SECTION_ADDITIONAL, compression_data);
+		(void) ldns_rr2buffer_wire_any(buffer,
+		                           ldns_pkt_tsig(packet), LDNS_SECTION_ADDITIONAL, compression_data, table);
 	}
 
 	return LDNS_STATUS_OK;
 }
 
+/* Copies the data written to buffer into memory of its size, so that the
+ * buffer can be used again */
+static ldns_status
+ldns_buffer2wire(uint8_t **dest, const ldns_buffer *buffer,
+		size_t *result_size)
+{
+	/* an empty rdf still gives memory to free */
+	*dest = LDNS_XMALLOC(uint8_t, ldns_buffer_position(buffer) > 0
+			? ldns_buffer_position(buffer) : 1);
+	if (!*dest) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	memcpy(*dest, ldns_buffer_begin(buffer), ldns_buffer_position(buffer));
+	*result_size = ldns_buffer_position(buffer);
+	return LDNS_STATUS_OK;
+}
+
 ldns_status
 ldns_rdf2wire(uint8_t **dest, const ldns_rdf *rdf, size_t *result_size)
 {
-	ldns_buffer *buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	ldns_status status;
 	*result_size = 0;
 	*dest = NULL;
@@ -483,17 +821,16 @@ ldns_rdf2wire(uint8_t **dest, const ldns_rdf *rdf, size_t *result_size)
 	
 	status = ldns_rdf2buffer_wire(buffer, rdf);
 	if (status == LDNS_STATUS_OK) {
-		*result_size =  ldns_buffer_position(buffer);
-		*dest = (uint8_t *) ldns_buffer_export(buffer);
+		status = ldns_buffer2wire(dest, buffer, result_size);
 	}
-	ldns_buffer_free(buffer);
+	ldns_buffer_release(buffer);
 	return status;
 }
 
 ldns_status
 ldns_rr2wire(uint8_t **dest, const ldns_rr *rr, int section, size_t *result_size)
 {
-	ldns_buffer *buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	ldns_status status;
 	*result_size = 0;
 	*dest = NULL;
@@ -501,17 +838,16 @@ ldns_rr2wire(uint8_t **dest, const ldns_rr *rr, int section, size_t *result_size
 	
 	status = ldns_rr2buffer_wire(buffer, rr, section);
 	if (status == LDNS_STATUS_OK) {
-		*result_size =  ldns_buffer_position(buffer);
-		*dest = (uint8_t *) ldns_buffer_export(buffer);
+		status = ldns_buffer2wire(dest, buffer, result_size);
 	}
-	ldns_buffer_free(buffer);
+	ldns_buffer_release(buffer);
 	return status;
 }
 
 ldns_status
 ldns_pkt2wire(uint8_t **dest, const ldns_pkt *packet, size_t *result_size)
 {
-	ldns_buffer *buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	ldns_status status;
 	*result_size = 0;
 	*dest = NULL;
@@ -519,9 +855,8 @@ ldns_pkt2wire(uint8_t **dest, const ldns_pkt *packet, size_t *result_size)
 	
 	status = ldns_pkt2buffer_wire(buffer, packet);
 	if (status == LDNS_STATUS_OK) {
-		*result_size =  ldns_buffer_position(buffer);
-		*dest = (uint8_t *) ldns_buffer_export(buffer);
+		status = ldns_buffer2wire(dest, buffer, result_size);
 	}
-	ldns_buffer_free(buffer);
+	ldns_buffer_release(buffer);
 	return status;
 }
@@ -0,0 +1,163 @@
+/*
+ * async.h -- non-blocking query engine
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file async.h
+ *
+ * A query engine that sends many queries at once without blocking.
+ * The engine owns a set of UDP sockets and keeps track of the queries
+ * that are in flight by message ID, socket and nameserver.  Queries that
+ * are not answered in time are sent again, to the next nameserver of
+ * the resolver, until the resolver's retry count is used up.  When an
+ * answer arrives, or the query finally fails, a callback is called with
+ * the result.
+ *
+ * The engine can run its own event loop with ldns_async_run(), which
+ * uses epoll where available and poll() otherwise.  To integrate it in
+ * an existing event loop instead, wait for the file descriptors from
+ * ldns_async_fds() to become readable, or for the time from
+ * ldns_async_timeout() to pass, and then call ldns_async_process().
+ *
+ * The queries are sent with the settings of the resolver the engine was
+ * created for: its nameservers, port, source address, timeout, retry
+ * count and IPv4/IPv6 preference.  Only UDP is used.  Truncated answers
+ * are delivered as they are; it is up to the caller to repeat those
+ * over TCP.  TSIG is not supported.
+ *
+ * An engine must be used by one thread at a time.
+ */
+
+#ifndef LDNS_ASYNC_H
+#define LDNS_ASYNC_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/packet.h>
+#include <ldns/resolver.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default number of UDP sockets per address family */
+#define LDNS_ASYNC_DEFAULT_SOCKETS 16
+
+/**
+ * Non-blocking query engine
+ */
+typedef struct ldns_struct_async ldns_async;
+
+/**
+ * Called when a query is answered or has failed.
+ * \param[in] status LDNS_STATUS_OK when answer holds the answer,
+ *            LDNS_STATUS_NETWORK_ERR when no answer arrived after all
+ *            tries, or another error that prevented sending the query
+ * \param[in] answer the answer, or NULL when status is not
+ *            LDNS_STATUS_OK.  It is owned by the callback.
+ * \param[in] arg the user argument given with the query
+ */
+typedef void (*ldns_async_cb)(ldns_status status, ldns_pkt *answer,
+		void *arg);
+
+/**
+ * Creates a new query engine that sends queries with the settings of
+ * resolver r.  The resolver is not copied and must outlive the engine.
+ * \param[in] r the resolver whose settings to use
+ * \param[in] sockets the number of UDP sockets to use per address
+ *            family, or 0 for LDNS_ASYNC_DEFAULT_SOCKETS
+ * \return the engine, or NULL on error
+ */
+ldns_async *ldns_async_new(ldns_resolver *r, size_t sockets);
+
+/**
+ * Closes the sockets of the engine and frees it.  Queries that are
+ * still in flight are dropped without their callbacks being called.
+ * Must not be called from a callback.
+ * \param[in] a the engine to free
+ */
+void ldns_async_free(ldns_async *a);
+
+/**
+ * Sends a query for name, type t and class c, made like
+ * ldns_resolver_send() would make it.
+ * \param[in] a the engine
+ * \param[in] name the name to query for
+ * \param[in] t the type to query for
+ * \param[in] c the class to query for
+ * \param[in] flags the query flags
+ * \param[in] cb the function to call with the result
+ * \param[in] arg the user argument to pass to cb
+ * \return LDNS_STATUS_OK when the query is in flight, an error otherwise.
+ *         On error cb is not called.
+ */
+ldns_status ldns_async_query(ldns_async *a, const ldns_rdf *name,
+		ldns_rr_type t, ldns_rr_class c, uint16_t flags,
+		ldns_async_cb cb, void *arg);
+
+/**
+ * Sends a query packet.  The message ID of the query is chosen by the
+ * engine, and differs for every try.
+ * \param[in] a the engine
+ * \param[in] query the query to send; it is not used after the call
+ * \param[in] cb the function to call with the result
+ * \param[in] arg the user argument to pass to cb
+ * \return LDNS_STATUS_OK when the query is in flight, an error otherwise.
+ *         On error cb is not called.
+ */
+ldns_status ldns_async_send_pkt(ldns_async *a, const ldns_pkt *query,
+		ldns_async_cb cb, void *arg);
+
+/**
+ * Returns the number of queries in flight
+ * \param[in] a the engine
+ * \return the number of queries that have not been answered or failed
+ */
+size_t ldns_async_outstanding(const ldns_async *a);
+
+/**
+ * Gives the file descriptors to watch for readability.  With epoll this
+ * is a single descriptor that stays the same.  Without epoll these are
+ * the sockets of the engine, which are opened as they are needed; ask
+ * again after sending queries.
+ * \param[in] a the engine
+ * \param[out] fds where to store the file descriptors
+ * \param[in] max the number of file descriptors fds can hold
+ * \return the number of file descriptors, which may be more than max
+ */
+size_t ldns_async_fds(const ldns_async *a, int *fds, size_t max);
+
+/**
+ * Returns how long to wait at most before calling ldns_async_process(),
+ * so that queries that are not answered are retried in time.
+ * \param[in] a the engine
+ * \return the time in milliseconds, or -1 when nothing is in flight
+ */
+int ldns_async_timeout(const ldns_async *a);
+
+/**
+ * Reads the answers that have arrived and handles the queries that
+ * timed out, without blocking.  Callbacks are called from here.
+ * \param[in] a the engine
+ * \return LDNS_STATUS_OK, or an error when waiting for the sockets failed
+ */
+ldns_status ldns_async_process(ldns_async *a);
+
+/**
+ * Runs the event loop of the engine until no queries are in flight.
+ * Callbacks may send new queries, which keep the loop running.
+ * \param[in] a the engine
+ * \return LDNS_STATUS_OK, or an error when waiting for the sockets failed
+ */
+ldns_status ldns_async_run(ldns_async *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_ASYNC_H */
@@ -107,6 +107,59 @@ ldns_buffer *ldns_buffer_new(size_t capacity);
  */
 void ldns_buffer_new_frm_data(ldns_buffer *buffer, const void *data, size_t size);
 
+/**
+ * makes the buffer a view of the given memory.  The data is NOT copied
+ * and no memory is allocated.  The buffer is fixed: it can not grow, and
+ * ldns_buffer_reserve() fails when more room is needed.  The memory
+ * stays the caller's, so the buffer must not be given to
+ * ldns_buffer_free().
+ *
+ * \param[in] buffer pointer to the buffer to make a view
+ * \param[in] data the memory to read from or write to
+ * \param[in] size the size of the memory
+ */
+void ldns_buffer_init_frm_data(ldns_buffer *buffer, void *data, size_t size);
+
+/**
+ * gives a buffer of at least the given capacity, cleared and ready for
+ * writing.  Up to the size of the largest DNS message, the buffer is
+ * taken from a pool of the calling thread when one was released before,
+ * and otherwise made with ldns_buffer_new().  Without threads there is
+ * no pool.
+ *
+ * \param[in] capacity the number of bytes the buffer should hold at least
+ * \return the buffer, to be given back with ldns_buffer_release(), or
+ *         NULL when there is no memory
+ */
+ldns_buffer *ldns_buffer_acquire(size_t capacity);
+
+/**
+ * gives back a buffer from ldns_buffer_acquire(), or from
+ * ldns_buffer_new(), to the pool of the calling thread.  The buffer is
+ * freed instead when the pool is full, when it was exported, or when it
+ * grew beyond the size of the largest DNS message.
+ *
+ * \param[in] buffer the buffer to give back, may be NULL
+ */
+void ldns_buffer_release(ldns_buffer *buffer);
+
+/**
+ * gives back a buffer like ldns_buffer_release(), after its data is
+ * overwritten with zeroes, for buffers that held data that should not
+ * stay around in the pool.  The data up to the limit is cleared, or up
+ * to the position when that lies beyond it, so that all of the buffer is
+ * cleared unless it was flipped, and all that was written when it was.
+ *
+ * \param[in] buffer the buffer to give back, may be NULL
+ */
+void ldns_buffer_release_clear(ldns_buffer *buffer);
+
+/**
+ * frees the buffers in the pool of the calling thread.  The pool of a
+ * thread is emptied when it exits as well.
+ */
+void ldns_buffer_pool_clear(void);
+
 /**
  * clears the buffer and make it ready for writing.  The buffer's limit
  * is set to the capacity and the position is set to 0.
@@ -240,7 +293,8 @@ bool ldns_buffer_set_capacity(ldns_buffer *buffer, size_t capacity);
  * capacity is increased if necessary using buffer_set_capacity().
  *
  * The buffer's limit is always set to the (possibly increased)
- * capacity.
+ * capacity.  A fixed buffer, such as one from ldns_buffer_init_frm_data(),
+ * is not increased: its status is set to LDNS_STATUS_MEM_ERR instead.
  * \param[in] buffer the buffer
  * \param[in] amount amount to use
  * \return whether this failed or succeeded
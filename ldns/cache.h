@@ -0,0 +1,186 @@
+/*
+ * cache.h -- cache of DNS answers
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file cache.h
+ *
+ * A cache of answers, to answer questions that were asked before without
+ * going to the network.  Answers are kept for the smallest TTL of the
+ * RRs in their answer and authority sections, and negative answers
+ * (NXDOMAIN, or no data) for the TTL of the SOA RR in their authority
+ * section or its minimum field, whichever is smaller, as RFC 2308
+ * describes.  Negative answers without a SOA RR are not kept, and
+ * neither are truncated answers, answers with another rcode than
+ * NOERROR or NXDOMAIN, and answers signed with TSIG.  The TTLs of the
+ * RRs in an answer taken from the cache are lowered by the time it was
+ * in the cache.
+ *
+ * Answers are found by the name, type and class of the question, and the
+ * DO, CD and RD bits of the query.  The cache takes no notice of where
+ * answers came from, so a cache should only be shared by resolvers that
+ * ask the same nameservers.
+ *
+ * The cache holds answers up to a maximum size in bytes.  When it is
+ * full, answers that were not used recently are dropped to make room.
+ *
+ * Answers that are asked for often are refreshed before they expire:
+ * when such an answer has less than LDNS_CACHE_PREFETCH percent of its
+ * TTL left, one lookup is told it is not in the cache, so that the
+ * caller asks the nameserver again and stores the fresh answer, while
+ * other lookups are still answered from the cache.
+ *
+ * Validated NSEC and NSEC3 records, stored with
+ * ldns_cache_store_denial(), are used to answer questions for names and
+ * types they prove do not exist without going to the network, as RFC 8198
+ * describes, also for names that were never asked for before.  A quarter
+ * of the size of the cache is for these records.
+ *
+ * Give a resolver a cache with ldns_resolver_set_cache() and
+ * ldns_resolver_send(), ldns_resolver_query() and ldns_resolver_search()
+ * will use it.  The cache is divided into shards with a lock each, so
+ * that resolvers in different threads can share a cache when ldns is
+ * built with pthreads.
+ */
+
+#ifndef LDNS_CACHE_H
+#define LDNS_CACHE_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/packet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default maximum size of a cache in bytes */
+#define LDNS_CACHE_DEFAULT_SIZE		(4 * 1024 * 1024)
+
+/** Longest time an answer is kept, in seconds */
+#define LDNS_CACHE_MAX_TTL		86400
+
+/** Longest time a negative answer is kept, in seconds (RFC 2308) */
+#define LDNS_CACHE_MAX_NEG_TTL		10800
+
+/** Percentage of its TTL left at which a popular answer is refreshed */
+#define LDNS_CACHE_PREFETCH		10
+
+/** Lookups after which an answer is popular enough to be refreshed */
+#define LDNS_CACHE_PREFETCH_HITS	2
+
+/**
+ * Cache of DNS answers
+ */
+typedef struct ldns_struct_cache ldns_cache;
+
+/**
+ * Counters of a cache
+ */
+struct ldns_struct_cache_stats
+{
+	/** Lookups answered from the cache */
+	size_t hits;
+	/** Lookups of answers not in the cache */
+	size_t misses;
+	/** Lookups not answered to refresh a popular answer */
+	size_t prefetches;
+	/** Answers stored */
+	size_t stores;
+	/** Answers dropped to make room */
+	size_t evictions;
+	/** Answers dropped because their TTL ran out */
+	size_t expired;
+	/** Answers in the cache */
+	size_t entries;
+	/** Bytes used by the answers and records in the cache */
+	size_t bytes;
+	/** NSEC and NSEC3 records in the cache */
+	size_t denials;
+	/** Lookups answered from NSEC and NSEC3 records */
+	size_t synthesized;
+};
+typedef struct ldns_struct_cache_stats ldns_cache_stats;
+
+/**
+ * Creates a new, empty, cache
+ * \param[in] max_size the most bytes the answers in the cache may take,
+ *            or 0 for LDNS_CACHE_DEFAULT_SIZE
+ * \return the cache, or NULL on memory error
+ */
+ldns_cache *ldns_cache_new(size_t max_size);
+
+/**
+ * Frees a cache and the answers in it
+ * \param[in] cache the cache to free
+ */
+void ldns_cache_free(ldns_cache *cache);
+
+/**
+ * Drops all answers and NSEC and NSEC3 records from a cache
+ * \param[in] cache the cache
+ */
+void ldns_cache_flush(ldns_cache *cache);
+
+/**
+ * Looks up the answer to a query.  When it is not in the cache, but the
+ * NSEC or NSEC3 records in the cache prove that the name or type does not
+ * exist, a NXDOMAIN or NODATA answer is made from them, with the records
+ * in its authority section when the query has the DO bit.
+ * \param[in] cache the cache
+ * \param[in] query the query
+ * \return a copy of the answer, with the ID of the query and lowered
+ *         TTLs, to be freed by the caller, or NULL when the answer is
+ *         not in the cache
+ */
+ldns_pkt *ldns_cache_lookup(ldns_cache *cache, const ldns_pkt *query);
+
+/**
+ * Stores the answer to a query, replacing an earlier answer to the same
+ * question.
+ * \param[in] cache the cache
+ * \param[in] query the query
+ * \param[in] answer the answer
+ * \return LDNS_STATUS_OK when the answer was stored, LDNS_STATUS_ERR when
+ *         it can not be cached, or LDNS_STATUS_MEM_ERR on memory error
+ */
+ldns_status ldns_cache_store(ldns_cache *cache, const ldns_pkt *query,
+		const ldns_pkt *answer);
+
+/**
+ * Stores the NSEC or NSEC3 records, with their RRSIGs, from the authority
+ * section of an answer, to answer later questions for names and types
+ * that they prove do not exist with NXDOMAIN or NODATA (RFC 8198).  The
+ * SOA record of the zone must be in the authority section too.  The
+ * records are kept for their TTL, but no longer than the negative TTL of
+ * the zone (RFC 9077).
+ *
+ * Only give answers whose records were validated, for example with
+ * ldns_verify() and ldns_dnssec_verify_denial() or
+ * ldns_dnssec_verify_denial_nsec3(): the cache does not check
+ * signatures.
+ * \param[in] cache the cache
+ * \param[in] answer the validated answer
+ * \return LDNS_STATUS_OK when records were stored, LDNS_STATUS_ERR when
+ *         there were none, or LDNS_STATUS_MEM_ERR on memory error
+ */
+ldns_status ldns_cache_store_denial(ldns_cache *cache,
+		const ldns_pkt *answer);
+
+/**
+ * Gets the counters of a cache
+ * \param[in] cache the cache
+ * \param[out] stats where to store the counters
+ */
+void ldns_cache_get_stats(ldns_cache *cache, ldns_cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_CACHE_H */
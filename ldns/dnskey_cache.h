@@ -0,0 +1,157 @@
+/*
+ * dnskey_cache.h -- index of DNSKEY RRs for signature verification
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file dnskey_cache.h
+ *
+ * A set of DNSKEY RRs indexed by owner name, algorithm and key tag, to
+ * find the keys that may have made a signature without going over all
+ * the keys and computing their key tags.  The public key of a DNSKEY is
+ * converted to its OpenSSL form the first time it is needed, and then
+ * reused for all further verifications with that key.
+ *
+ * Looking up keys with ldns_dnskey_cache_lookup() does not change the
+ * cache, but getting the public key with ldns_dnskey_cache_key_pkey()
+ * may.  To share a cache between threads, call ldns_dnskey_cache_prepare()
+ * first, after which it is only read.
+ */
+
+#ifndef LDNS_DNSKEY_CACHE_H
+#define LDNS_DNSKEY_CACHE_H
+
+#include <ldns/common.h>
+#if LDNS_BUILD_CONFIG_HAVE_SSL
+#include <openssl/evp.h>
+#endif
+#include <ldns/error.h>
+#include <ldns/rr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A DNSKEY RR in a ldns_dnskey_cache
+ */
+struct ldns_struct_dnskey_cache_key
+{
+	/** The DNSKEY RR, owned by the cache */
+	ldns_rr *rr;
+	/** The key tag of the DNSKEY */
+	uint16_t keytag;
+	/** The algorithm of the DNSKEY */
+	uint8_t algorithm;
+	/** The next key with the same owner, algorithm and key tag */
+	struct ldns_struct_dnskey_cache_key *next;
+#if LDNS_BUILD_CONFIG_HAVE_SSL
+	/** The public key, once converted */
+	EVP_PKEY *pkey;
+	/** The digest to use with pkey, NULL for EdDSA */
+	const EVP_MD *md;
+#endif
+	/** Whether the public key was converted, and the result of that */
+	bool parsed;
+	/** Why pkey is NULL after conversion */
+	ldns_status status;
+};
+typedef struct ldns_struct_dnskey_cache_key ldns_dnskey_cache_key;
+
+/**
+ * DNSKEY RRs indexed by owner name, algorithm and key tag
+ */
+typedef struct ldns_struct_dnskey_cache ldns_dnskey_cache;
+
+/**
+ * Creates a new, empty, DNSKEY cache.
+ * \return the cache or NULL on memory error
+ */
+ldns_dnskey_cache *ldns_dnskey_cache_new(void);
+
+/**
+ * Frees the cache, the DNSKEY RRs in it and their public keys.
+ * \param[in] cache the cache to free
+ */
+void ldns_dnskey_cache_free(ldns_dnskey_cache *cache);
+
+/**
+ * Adds a copy of a DNSKEY RR to the cache.  Keys that are already in
+ * the cache are not added again.
+ * \param[in] cache the cache to add to
+ * \param[in] key the DNSKEY RR to add
+ * \return LDNS_STATUS_OK on success, LDNS_STATUS_CRYPTO_NO_DNSKEY when
+ *         key is not a DNSKEY RR, or LDNS_STATUS_MEM_ERR on memory error
+ */
+ldns_status ldns_dnskey_cache_add_rr(ldns_dnskey_cache *cache,
+		const ldns_rr *key);
+
+/**
+ * Adds copies of the DNSKEY RRs in a list to the cache.  Other RRs in
+ * the list, such as DS RRs, are skipped.
+ * \param[in] cache the cache to add to
+ * \param[in] keys the list of RRs
+ * \return LDNS_STATUS_OK on success or LDNS_STATUS_MEM_ERR on memory error
+ */
+ldns_status ldns_dnskey_cache_add_rr_list(ldns_dnskey_cache *cache,
+		const ldns_rr_list *keys);
+
+/**
+ * Returns the number of keys in the cache
+ * \param[in] cache the cache
+ * \return the number of keys
+ */
+size_t ldns_dnskey_cache_count(const ldns_dnskey_cache *cache);
+
+/**
+ * Finds the keys with the given owner name, algorithm and key tag.
+ * More than one key may match; they are linked by their next pointers.
+ * \param[in] cache the cache to search
+ * \param[in] owner the owner name of the keys
+ * \param[in] algorithm the algorithm of the keys
+ * \param[in] keytag the key tag of the keys
+ * \return the first matching key, or NULL when there are none
+ */
+ldns_dnskey_cache_key *ldns_dnskey_cache_lookup(const ldns_dnskey_cache *cache,
+		const ldns_rdf *owner, uint8_t algorithm, uint16_t keytag);
+
+/**
+ * Finds the keys that may have made the signature: the keys owned by
+ * the signer name with the algorithm and key tag of the RRSIG.
+ * \param[in] cache the cache to search
+ * \param[in] rrsig the RRSIG RR
+ * \return the first matching key, or NULL when there are none
+ */
+ldns_dnskey_cache_key *ldns_dnskey_cache_lookup_rrsig(
+		const ldns_dnskey_cache *cache, const ldns_rr *rrsig);
+
+/**
+ * Converts the public keys of all the DNSKEYs in the cache, so that the
+ * cache is not modified anymore when it is used.  Keys that can not be
+ * converted are remembered as such, and are not an error here.
+ * \param[in] cache the cache
+ */
+void ldns_dnskey_cache_prepare(ldns_dnskey_cache *cache);
+
+#if LDNS_BUILD_CONFIG_HAVE_SSL
+/**
+ * Returns the public key of a DNSKEY in the cache, converting it the
+ * first time it is asked for.  The key remains owned by the cache.
+ * \param[in] key the key from the cache
+ * \param[out] md the digest to use with the key, NULL for EdDSA keys
+ * \param[out] status when not NULL, why no public key is returned
+ * \return the public key, or NULL when it could not be converted
+ */
+EVP_PKEY *ldns_dnskey_cache_key_pkey(ldns_dnskey_cache_key *key,
+		const EVP_MD **md, ldns_status *status);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_DNSKEY_CACHE_H */
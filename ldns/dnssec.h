@@ -33,6 +33,8 @@
 #include <ldns/zone.h>
 #include <ldns/resolver.h>
 #include <ldns/dnssec_zone.h>
+#include <ldns/nsec3_cache.h>
+#include <ldns/dnskey_cache.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,6 +76,19 @@ ldns_rr *ldns_dnssec_get_rrsig_for_name_and_type(const ldns_rdf *name,
  */
 ldns_rr *ldns_dnssec_get_dnskey_for_rrsig(const ldns_rr *rrsig, const ldns_rr_list *rrs);
 
+/**
+ * Returns the DNSKEY that corresponds to the given RRSIG rr from a key
+ * cache, if any.  Like ldns_dnssec_get_dnskey_for_rrsig(), but the key
+ * is looked up on signer name, algorithm and key tag.
+ *
+ * \param[in] rrsig The rrsig to find the DNSKEY for
+ * \param[in] keys The key cache to find the key in
+ * \return The DNSKEY that corresponds to the given RRSIG, or NULL if it was
+ *         not found.  The key remains owned by the cache.
+ */
+ldns_rr *ldns_dnssec_get_dnskey_for_rrsig_keycache(const ldns_rr *rrsig,
+		const ldns_dnskey_cache *keys);
+
 /**
  * Returns the rdata field that contains the bitmap of the covered types of
  * the given NSEC record
@@ -261,6 +276,22 @@ ldns_dnssec_create_nsec3(const ldns_dnssec_name *from,
 					uint8_t salt_length,
 					const uint8_t *salt);
 
+/**
+ * Creates NSEC3, like ldns_dnssec_create_nsec3(), but takes the hashed
+ * owner name from cache when it is there.
+ * \param[in] cache the NSEC3 hash cache to use; may be NULL
+ */
+ldns_rr *
+ldns_dnssec_create_nsec3_cached(const ldns_dnssec_name *from,
+					const ldns_dnssec_name *to,
+					const ldns_rdf *zone_name,
+					uint8_t algorithm,
+					uint8_t flags,
+					uint16_t iterations,
+					uint8_t salt_length,
+					const uint8_t *salt,
+					ldns_nsec3_cache *cache);
+
 /**
  * Create a NSEC record
  * \param[in] cur_owner the current owner which should be taken as the starting point
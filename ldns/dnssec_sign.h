@@ -151,6 +151,22 @@ ldns_dnssec_zone_create_nsec3s(ldns_dnssec_zone *zone,
 						 uint8_t salt_length,
 						 uint8_t *salt);
 
+/**
+ * Adds NSEC3 records to the zone, like ldns_dnssec_zone_create_nsec3s(),
+ * but looks up the hashed owner names in cache first.  Hashes that had
+ * to be computed are added to the cache.
+ * \param[in] cache the NSEC3 hash cache to use; may be NULL
+ */
+ldns_status
+ldns_dnssec_zone_create_nsec3s_cached(ldns_dnssec_zone *zone,
+						 ldns_rr_list *new_rrs,
+						 uint8_t algorithm,
+						 uint8_t flags,
+						 uint16_t iterations,
+						 uint8_t salt_length,
+						 uint8_t *salt,
+						 ldns_nsec3_cache *cache);
+
 /**
  * remove signatures if callback function tells to
  * 
@@ -307,6 +323,31 @@ ldns_status ldns_dnssec_zone_sign_nsec3_flg_mkmap(ldns_dnssec_zone *zone,
 				ldns_rbtree_t **map
 				);
 
+/**
+ * signs the given zone with the given new zone, with NSEC3, like
+ * ldns_dnssec_zone_sign_nsec3_flg_mkmap(), but takes the hashed owner
+ * names from the NSEC3 hash cache when they are there.
+ *
+ * \param[in] cache the NSEC3 hash cache to use; may be NULL.  Save it
+ *            with ldns_nsec3_cache_save() to speed up the next run.
+ * \return LDNS_STATUS_OK on success, an error code otherwise
+ */
+ldns_status ldns_dnssec_zone_sign_nsec3_flg_mkmap_cached(
+				ldns_dnssec_zone *zone,
+				ldns_rr_list *new_rrs,
+				ldns_key_list *key_list,
+				int (*func)(ldns_rr *, void *),
+				void *arg,
+				uint8_t algorithm,
+				uint8_t flags,
+				uint16_t iterations,
+				uint8_t salt_length,
+				uint8_t *salt,
+				int signflags,
+				ldns_rbtree_t **map,
+				ldns_nsec3_cache *cache
+				);
+
 
 /**
  * signs the given zone with the given keys
@@ -7,6 +7,8 @@
 
 #include <ldns/dnssec.h>
 #include <ldns/host2str.h>
+#include <ldns/dnskey_cache.h>
+#include <ldns/trust_cache.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -89,6 +91,31 @@ ldns_dnssec_data_chain *ldns_dnssec_build_data_chain(ldns_resolver *res,
 										   const ldns_pkt *pkt,
 										   ldns_rr *orig_rr);
 
+/**
+ * Build an ldns_dnssec_data_chain like ldns_dnssec_build_data_chain(),
+ * but first query the DNSKEY and DS RRsets of the signers of the RRSIGs
+ * in pkt and of all their ancestors, up to a trust anchor of the
+ * resolver, all at once with ldns_send_bulk().  The chain is then built
+ * from the answers, so that the time it takes does not grow with the
+ * number of zones between the data and the trust anchor.
+ *
+ * The answers are stored in the cache of the resolver, or in a cache
+ * that is used for this call only when the resolver has none.
+ *
+ * \param[in] *res resolver structure for further needed queries
+ * \param[in] qflags resolution flags
+ * \param[in] *data_set The original rrset where the chain ends
+ * \param[in] *pkt optional, can contain the original packet
+ * (and hence the sigs and maybe the key)
+ * \param[in] *orig_rr The original Resource Record
+ *
+ * \return the DNSSEC data chain
+ */
+ldns_dnssec_data_chain *ldns_dnssec_build_data_chain_parallel(
+		ldns_resolver *res, uint16_t qflags,
+		const ldns_rr_list *data_set, const ldns_pkt *pkt,
+		ldns_rr *orig_rr);
+
 /**
  * Tree structure that contains the relation of DNSSEC data,
  * and their cryptographic status.
@@ -449,6 +476,47 @@ ldns_rr_list *ldns_fetch_valid_domain_keys_time(const ldns_resolver * res,
 		const ldns_rdf * domain, const ldns_rr_list * keys,
 		time_t check_time, ldns_status *status);
 
+/**
+ * Tries to build an authentication chain from the given keys down to
+ * the queried domain, like ldns_fetch_valid_domain_keys_time(), but
+ * queries the DNSKEY and DS RRsets of the domain and its ancestors all at
+ * once, up to a name that has a key in keys, instead of one after
+ * another.  See ldns_dnssec_build_data_chain_parallel().
+ *
+ * \param[in] res the current resolver
+ * \param[in] domain the domain we want valid keys for
+ * \param[in] keys the current set of trusted keys
+ * \param[in] check_time the time for which the validation is performed
+ * \param[out] status pointer to the status variable where the result
+ *                    code will be stored
+ * \return the set of trusted keys for the domain, or NULL if no 
+ *         trust path could be built.
+ */
+ldns_rr_list *ldns_fetch_valid_domain_keys_parallel(ldns_resolver *res,
+		const ldns_rdf *domain, const ldns_rr_list *keys,
+		time_t check_time, ldns_status *status);
+
+/**
+ * Tries to build an authentication chain from the given keys down to
+ * the queried domain, like ldns_fetch_valid_domain_keys_time(), but
+ * takes the DNSKEY and DS RRsets that were validated before from a trust
+ * cache, and stores the ones it validates in it.
+ *
+ * \param[in] res the current resolver
+ * \param[in] domain the domain we want valid keys for
+ * \param[in] keys the current set of trusted keys
+ * \param[in] check_time the time for which the validation is performed
+ * \param[in] tc the trust cache, or NULL to validate without one
+ * \param[out] status pointer to the status variable where the result
+ *                    code will be stored
+ * \return the set of trusted keys for the domain, or NULL if no 
+ *         trust path could be built.
+ */
+ldns_rr_list *ldns_fetch_valid_domain_keys_cached(const ldns_resolver *res,
+		const ldns_rdf *domain, const ldns_rr_list *keys,
+		time_t check_time, ldns_trust_cache *tc,
+		ldns_status *status);
+
 
 /**
  * Validates the DNSKEY RRset for the given domain using the provided 
@@ -540,6 +608,49 @@ ldns_status ldns_verify_trusted_time(
 		ldns_rr_list *rrsigs, time_t check_time,
 		ldns_rr_list *validating_keys);
 
+/**
+ * Verifies a list of signatures for one RRset using a valid trust path,
+ * like ldns_verify_trusted_time(), but queries the DNSKEY and DS RRsets
+ * of the signers and their ancestors all at once, up to a trust anchor
+ * of the resolver, instead of one after another.  See
+ * ldns_dnssec_build_data_chain_parallel().
+ *
+ * \param[in] res the current resolver
+ * \param[in] rrset the rrset to verify
+ * \param[in] rrsigs a list of signatures to check
+ * \param[in] check_time the time for which the validation is performed
+ * \param[out] validating_keys  if this is a (initialized) list, the
+ *                              keys from keys that validate one of
+ *                              the signatures are added to it
+ * \return status LDNS_STATUS_OK if there is at least one correct key
+ */
+ldns_status ldns_verify_trusted_parallel(
+		ldns_resolver *res, ldns_rr_list *rrset,
+		ldns_rr_list *rrsigs, time_t check_time,
+		ldns_rr_list *validating_keys);
+
+/**
+ * Verifies a list of signatures for one RRset using a valid trust path,
+ * like ldns_verify_trusted_time(), but takes the DNSKEY and DS RRsets of
+ * the trust path that were validated before from a trust cache, and
+ * stores the ones it validates in it.  The trust cache must only be used
+ * with the trust anchors of this resolver.
+ *
+ * \param[in] res the current resolver
+ * \param[in] rrset the rrset to verify
+ * \param[in] rrsigs a list of signatures to check
+ * \param[in] check_time the time for which the validation is performed
+ * \param[in] tc the trust cache, or NULL to validate without one
+ * \param[out] validating_keys  if this is a (initialized) list, the
+ *                              keys from keys that validate one of
+ *                              the signatures are added to it
+ * \return status LDNS_STATUS_OK if there is at least one correct key
+ */
+ldns_status ldns_verify_trusted_cached(
+		ldns_resolver *res, ldns_rr_list *rrset,
+		ldns_rr_list *rrsigs, time_t check_time,
+		ldns_trust_cache *tc, ldns_rr_list *validating_keys);
+
 
 /**
  * denial is not just a river in egypt
@@ -687,6 +798,53 @@ ldns_status ldns_verify_rrsig_keylist_notime(const ldns_rr_list *rrset,
 							   const ldns_rr_list *keys,
 							   ldns_rr_list *good_keys);
 
+/**
+ * Verifies an rrsig with the keys from a key cache that have the signer
+ * name, algorithm and key tag of the signature.  Like
+ * ldns_verify_rrsig_keylist_time(), but the keys are found without going
+ * over all of them, and each key is converted to its OpenSSL form only
+ * once for all the signatures it is used with.
+ * \param[in] rrset the rrset to check
+ * \param[in] rrsig the signature of the rrset
+ * \param[in] keys the key cache
+ * \param[in] check_time the time for which the validation is performed
+ * \param[out] good_keys  if this is a (initialized) list, the pointers to
+ *                        the keys in the cache that validate the signature
+ *                        are added to it
+ * \return status LDNS_STATUS_OK if at least one key matched. Else an error.
+ */
+ldns_status ldns_verify_rrsig_keycache_time(const ldns_rr_list *rrset,
+		const ldns_rr *rrsig, ldns_dnskey_cache *keys,
+		time_t check_time, ldns_rr_list *good_keys);
+
+/**
+ * Like ldns_verify_rrsig_keycache_time(), for the current time.
+ * \param[in] rrset the rrset to check
+ * \param[in] rrsig the signature of the rrset
+ * \param[in] keys the key cache
+ * \param[out] good_keys  if this is a (initialized) list, the pointers to
+ *                        the keys in the cache that validate the signature
+ *                        are added to it
+ * \return status LDNS_STATUS_OK if at least one key matched. Else an error.
+ */
+ldns_status ldns_verify_rrsig_keycache(const ldns_rr_list *rrset,
+		const ldns_rr *rrsig, ldns_dnskey_cache *keys,
+		ldns_rr_list *good_keys);
+
+/**
+ * Like ldns_verify_rrsig_keycache_time(), but time is not checked.
+ * \param[in] rrset the rrset to check
+ * \param[in] rrsig the signature of the rrset
+ * \param[in] keys the key cache
+ * \param[out] good_keys  if this is a (initialized) list, the pointers to
+ *                        the keys in the cache that validate the signature
+ *                        are added to it
+ * \return status LDNS_STATUS_OK if at least one key matched. Else an error.
+ */
+ldns_status ldns_verify_rrsig_keycache_notime(const ldns_rr_list *rrset,
+		const ldns_rr *rrsig, ldns_dnskey_cache *keys,
+		ldns_rr_list *good_keys);
+
 /**
  * verify an rrsig with 1 key
  * \param[in] rrset the rrset
@@ -849,6 +1007,111 @@ ldns_status ldns_verify_rrsig_rsamd5_raw(unsigned char* sig,
 								 unsigned char* key,
 								 size_t keylen);
 
+/**
+ * A signature that did not verify, as reported by
+ * ldns_dnssec_zone_verify_signatures()
+ */
+struct ldns_struct_dnssec_verify_error
+{
+	/** owner name of the RRset */
+	ldns_rdf *name;
+	/** type of the RRset */
+	ldns_rr_type type;
+	/** key tag of the signature */
+	uint16_t keytag;
+	/** algorithm of the signature */
+	uint8_t algorithm;
+	/** why the signature did not verify */
+	ldns_status reason;
+};
+typedef struct ldns_struct_dnssec_verify_error ldns_dnssec_verify_error;
+
+/**
+ * The result of ldns_dnssec_zone_verify_signatures()
+ */
+struct ldns_struct_dnssec_verify_errors
+{
+	/** number of errors */
+	size_t count;
+	/** the errors, in zone order */
+	ldns_dnssec_verify_error *errors;
+	/** number of RRsets that were checked */
+	size_t rrsets;
+	/** number of signature verifications that were performed */
+	size_t signatures;
+};
+typedef struct ldns_struct_dnssec_verify_errors ldns_dnssec_verify_errors;
+
+/**
+ * Verifies the signatures of all the authoritative RRsets and NSEC(3)
+ * records in a zone.  An RRset is valid when one of its signatures
+ * validates with one of the keys.  For RRsets that are not valid, an
+ * error is reported for each of its signatures.  RRsets without
+ * signatures are not reported; checking for those is left to the caller.
+ *
+ * The keys are converted to their OpenSSL form only once, and every
+ * RRset is converted to canonical wire format only once, regardless of
+ * the number of signatures.  When ldns is built with pthreads, the
+ * verification is spread over multiple threads.  The zone is not
+ * modified, except for marking glue with ldns_dnssec_zone_mark_glue().
+ *
+ * \param[in] zone the zone to verify
+ * \param[in] keys the keys to verify with; when NULL the DNSKEY RRset at
+ *                 the apex of the zone is used
+ * \param[in] check_time the time for which the validation is performed
+ * \param[in] inception_margin signatures must have been incepted at
+ *                 least this many seconds before check_time
+ * \param[in] expiration_margin signatures must not expire within this
+ *                 many seconds after check_time
+ * \param[in] threads the number of threads to use, 0 for one per online
+ *                 CPU
+ * \param[out] errors when not NULL, the list of errors is returned
+ *                 here, which must be freed with
+ *                 ldns_dnssec_verify_errors_free()
+ * \return LDNS_STATUS_OK when all signed RRsets verified, the reason of
+ *         the first error otherwise, or an error code when the
+ *         verification could not be performed
+ */
+ldns_status ldns_dnssec_zone_verify_signatures(ldns_dnssec_zone *zone,
+		const ldns_rr_list *keys, time_t check_time,
+		int32_t inception_margin, int32_t expiration_margin,
+		size_t threads, ldns_dnssec_verify_errors **errors);
+
+/**
+ * Like ldns_dnssec_zone_verify_signatures(), but with the keys in a key
+ * cache, which can then be used for more verifications afterwards.
+ *
+ * \param[in] zone the zone to verify
+ * \param[in] keys the key cache to verify with; when NULL the DNSKEY
+ *                 RRset at the apex of the zone is used.  All the keys
+ *                 in the cache are converted with
+ *                 ldns_dnskey_cache_prepare()
+ * \param[in] check_time the time for which the validation is performed
+ * \param[in] inception_margin signatures must have been incepted at
+ *                 least this many seconds before check_time
+ * \param[in] expiration_margin signatures must not expire within this
+ *                 many seconds after check_time
+ * \param[in] threads the number of threads to use, 0 for one per online
+ *                 CPU
+ * \param[out] errors when not NULL, the list of errors is returned
+ *                 here, which must be freed with
+ *                 ldns_dnssec_verify_errors_free()
+ * \return LDNS_STATUS_OK when all signed RRsets verified, the reason of
+ *         the first error otherwise, or an error code when the
+ *         verification could not be performed
+ */
+ldns_status ldns_dnssec_zone_verify_signatures_keycache(
+		ldns_dnssec_zone *zone, ldns_dnskey_cache *keys,
+		time_t check_time, int32_t inception_margin,
+		int32_t expiration_margin, size_t threads,
+		ldns_dnssec_verify_errors **errors);
+
+/**
+ * Frees the result of ldns_dnssec_zone_verify_signatures()
+ * \param[in] errors the errors to free
+ */
+void ldns_dnssec_verify_errors_free(ldns_dnssec_verify_errors *errors);
+
 #ifdef __cplusplus
 }
 #endif
@@ -114,6 +114,17 @@ struct ldns_struct_edns_option_list
 };
 typedef struct ldns_struct_edns_option_list ldns_edns_option_list;
 
+/**
+ * Goes over the options in the rdata of an OPT RR, without allocating.
+ */
+struct ldns_struct_edns_option_iter
+{
+	const uint8_t *_data; /* the rdata of the OPT RR */
+	size_t _size; /* the length of the rdata */
+	size_t _pos; /* where the next option starts */
+};
+typedef struct ldns_struct_edns_option_iter ldns_edns_option_iter;
+
 /*
  * Access functions 
  * do this as functions to get type checking
@@ -280,6 +291,76 @@ ldns_edns_option* ldns_edns_option_list_pop(ldns_edns_option_list *options_list)
  */
 ldns_buffer *ldns_edns_option_list2wireformat_buffer(const ldns_edns_option_list *option_list);
 
+/* functions that do not allocate */
+
+/**
+ * starts going over the options in the rdata of an OPT RR.
+ * \param[out] iter  the iterator
+ * \param[in] data   the rdata, which must stay while the iterator is used
+ * \param[in] size   the length of the rdata
+ */
+void ldns_edns_option_iter_init(ldns_edns_option_iter *iter,
+	const uint8_t *data, size_t size);
+
+/**
+ * gets the next option. The option is a view into the rdata: its data is
+ * not copied, and it must not be freed.
+ * \param[in] iter     the iterator
+ * \param[out] option  the option, filled in
+ * \return true when there was a next option, false at the end of the rdata
+ *         and when the rest of the rdata is malformed
+ */
+bool ldns_edns_option_iter_next(ldns_edns_option_iter *iter,
+	ldns_edns_option *option);
+
+/**
+ * appends an EDNS option in wireformat to the buffer.
+ * \param[in] buffer  the buffer to append to
+ * \param[in] code    the EDNS code
+ * \param[in] size    the size of the data
+ * \param[in] data    the data of the option
+ * \return the status of the buffer, or LDNS_STATUS_RDATA_OVERFLOW when the
+ *         data is too long for an option
+ */
+ldns_status ldns_edns_option2buffer_wire(ldns_buffer *buffer,
+	ldns_edns_option_code code, size_t size, const void *data);
+
+/**
+ * appends all the EDNS options in the list in wireformat to the buffer,
+ * without the intermediate buffer of
+ * ldns_edns_option_list2wireformat_buffer.
+ * \param[in] buffer       the buffer to append to
+ * \param[in] option_list  the EDNS options
+ * \return the status of the buffer
+ */
+ldns_status ldns_edns_option_list2buffer_wire(ldns_buffer *buffer,
+	const ldns_edns_option_list *option_list);
+
+/**
+ * appends the start of an OPT RR to the buffer, with an empty rdata. Append
+ * the options after it, and call ldns_edns_opt_end to set the length of
+ * the rdata. The ARCOUNT of the packet is not changed.
+ * \param[in] buffer          the buffer to append to
+ * \param[in] udp_size        the EDNS UDP size
+ * \param[in] extended_rcode  the upper bits of the RCODE
+ * \param[in] version         the EDNS version
+ * \param[in] z               the EDNS flags, with the DO bit
+ * \return the position in the buffer where the options start, to give to
+ *         ldns_edns_opt_end
+ */
+size_t ldns_edns_opt_begin(ldns_buffer *buffer, uint16_t udp_size,
+	uint8_t extended_rcode, uint8_t version, uint16_t z);
+
+/**
+ * sets the length of the rdata of an OPT RR started with
+ * ldns_edns_opt_begin to the options appended after it.
+ * \param[in] buffer  the buffer
+ * \param[in] start   what ldns_edns_opt_begin returned
+ * \return the status of the buffer, or LDNS_STATUS_RDATA_OVERFLOW when the
+ *         options are too long for an OPT RR
+ */
+ldns_status ldns_edns_opt_end(ldns_buffer *buffer, size_t start);
+
 #ifdef __cplusplus
 }
 #endif
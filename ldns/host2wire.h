@@ -31,6 +31,55 @@
 extern "C" {
 #endif
 
+/** Number of slots in a ldns_compression_table.  Must be a power of two. */
+#define LDNS_COMPRESSION_TABLE_SIZE 512
+
+/**
+ * A name suffix in a ldns_compression_table
+ */
+struct ldns_struct_compression_entry
+{
+	/** Hash of the lowercased suffix */
+	uint32_t hash;
+	/** Position of the suffix in the buffer, 0 for an empty slot */
+	uint16_t position;
+};
+typedef struct ldns_struct_compression_entry ldns_compression_entry;
+
+/**
+ * Names written to a message so far, for name compression without heap
+ * allocations.  It is an open addressing hash table of the positions of
+ * name suffixes in the buffer the message is written to, compared to the
+ * names to compress by the wire data written there.  Put it on the stack,
+ * and give it to ldns_compression_table_init() before each message.  The
+ * message must start at the beginning of the buffer.  When the table is
+ * three quarters full, names that follow are compressed against the names
+ * already in it, but not added.
+ */
+struct ldns_struct_compression_table
+{
+	/** Number of suffixes in the table */
+	size_t count;
+	/** The slots */
+	ldns_compression_entry entries[LDNS_COMPRESSION_TABLE_SIZE];
+};
+typedef struct ldns_struct_compression_table ldns_compression_table;
+
+/**
+ * Empties a compression table, to write a new message with it
+ * \param[in] *table the table
+ */
+void ldns_compression_table_init(ldns_compression_table *table);
+
+/**
+ * Forgets the names written at or after a position, for when the buffer
+ * is set back to that position to write something else there
+ * \param[in] *table the table
+ * \param[in] position the position
+ */
+void ldns_compression_table_truncate(ldns_compression_table *table,
+		size_t position);
+
 /**
  * Copies the dname data to the buffer in wire format
  * \param[out] *buffer buffer to append the result to
@@ -39,6 +88,17 @@ extern "C" {
  */
 ldns_status ldns_dname2buffer_wire(ldns_buffer *buffer, const ldns_rdf *name);
 
+/**
+ * Copies the dname data to the buffer in wire format, compressed against
+ * the names written before with the same compression table
+ * \param[out] *buffer buffer to append the result to
+ * \param[in] *name rdata dname to convert
+ * \param[in,out] *table names written so far
+ * \return ldns_status
+ */
+ldns_status ldns_dname2buffer_wire_table(ldns_buffer *buffer,
+		const ldns_rdf *name, ldns_compression_table *table);
+
 /**
  * Copies the dname data to the buffer in wire format
  * \param[out] *buffer buffer to append the result to
@@ -102,6 +162,36 @@ ldns_status ldns_rr2buffer_wire_compress(ldns_buffer *output,
 						  int section,
 						  ldns_rbtree_t *compression_data);
 
+/**
+ * Copies the rr data to the buffer in wire format while doing DNAME
+ * compression with a compression table
+ * \param[out] *output buffer to append the result to
+ * \param[in] *rr resource record to convert
+ * \param[in] section the section in the packet this rr is supposed to be in
+ *            (to determine whether to add rdata or not)
+ * \param[in,out] *table names written so far
+ * \return ldns_status
+ */
+ldns_status ldns_rr2buffer_wire_table(ldns_buffer *output,
+		const ldns_rr *rr, int section, ldns_compression_table *table);
+
+/**
+ * Computes the length the RRs would take when they are written after the
+ * buffer with ldns_rr2buffer_wire_table(), one after the other, without
+ * writing them.  The names are compressed against the names in the table
+ * and against each other, exactly like they would be written, so that it
+ * can be known beforehand whether the RRs fit in a message.
+ * \param[in] *buffer the message written so far
+ * \param[in] *rrs the RRs
+ * \param[in] section the section in the packet the RRs are supposed to be
+ *            in (to determine whether to count rdata or not)
+ * \param[in] *table names written so far, or NULL for no compression
+ * \return the length in bytes
+ */
+size_t ldns_rr_list_compressed_size(const ldns_buffer *buffer,
+		const ldns_rr_list *rrs, int section,
+		const ldns_compression_table *table);
+
 /**
  * Copies the rr data to the buffer in wire format, in canonical format
  * according to RFC3597 (every dname in rdata fields of RR's mentioned in
@@ -139,13 +229,26 @@ ldns_status ldns_rrsig2buffer_wire(ldns_buffer *output, const ldns_rr *sigrr);
 ldns_status ldns_rr_rdata2buffer_wire(ldns_buffer *output, const ldns_rr *rr);
 
 /**
- * Copies the packet data to the buffer in wire format
+ * Copies the packet data to the buffer in wire format, with name
+ * compression using a compression table on the stack
  * \param[out] *output buffer to append the result to
  * \param[in] *pkt packet to convert
  * \return ldns_status
  */
 ldns_status ldns_pkt2buffer_wire(ldns_buffer *output, const ldns_pkt *pkt);
 
+/**
+ * Copies the packet data to the buffer in wire format, with name
+ * compression using the given compression table, which is initialized
+ * first
+ * \param[out] *output buffer to append the result to
+ * \param[in] *pkt packet to convert
+ * \param[out] *table the compression table to use
+ * \return ldns_status
+ */
+ldns_status ldns_pkt2buffer_wire_table(ldns_buffer *output,
+		const ldns_pkt *pkt, ldns_compression_table *table);
+
 /**
  * Copies the packet data to the buffer in wire format
  * \param[out] *output buffer to append the result to
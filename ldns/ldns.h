@@ -120,6 +120,17 @@ Or you can just use the menu above to browse through the API docs.
 #include <ldns/parse.h>
 #include <ldns/zone.h>
 #include <ldns/dnssec_zone.h>
+#include <ldns/nsec3_cache.h>
+#include <ldns/dnskey_cache.h>
+#include <ldns/trust_cache.h>
+#include <ldns/pkt_view.h>
+#include <ldns/server.h>
+#include <ldns/rr_codec.h>
+#include <ldns/tcp_frame.h>
+#include <ldns/async.h>
+#include <ldns/udp_pool.h>
+#include <ldns/tcp_pool.h>
+#include <ldns/cache.h>
 #include <ldns/radix.h>
 #include <ldns/rbtree.h>
 #include <ldns/sha1.h>
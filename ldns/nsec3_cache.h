@@ -0,0 +1,143 @@
+/*
+ * nsec3_cache.h -- persistent cache of NSEC3 hashed owner names
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file nsec3_cache.h
+ *
+ * A cache of NSEC3 owner name hashes that can be stored on disk and
+ * reused by the next signer run.  When a zone is re-signed with the
+ * same NSEC3 parameters, only the names that were added since the
+ * previous run need to be hashed.
+ *
+ * The cache is keyed on the canonical owner name.  The NSEC3 hash
+ * algorithm, iterations and salt are stored once, for the whole cache.
+ * Asking for a hash with other parameters empties the cache, so stale
+ * hashes are never returned.
+ *
+ * On disk the cache is a single file: a small header holding the
+ * parameters, followed by the (owner name, hash) entries sorted on
+ * owner name.  The file is read in one go and searched with binary
+ * search, so loading costs a single allocation. Saving writes only
+ * the entries that were used or added since the cache was loaded,
+ * which drops names that left the zone.
+ */
+
+#ifndef LDNS_NSEC3_CACHE_H
+#define LDNS_NSEC3_CACHE_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/rdata.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Cache of NSEC3 hashed owner names
+ */
+typedef struct ldns_struct_nsec3_cache ldns_nsec3_cache;
+
+/**
+ * Creates a new, empty, NSEC3 hash cache.
+ * \return the cache or NULL on memory error
+ */
+ldns_nsec3_cache *ldns_nsec3_cache_new(void);
+
+/**
+ * Frees the cache and all the entries in it.
+ * \param[in] cache the cache to free
+ */
+void ldns_nsec3_cache_free(ldns_nsec3_cache *cache);
+
+/**
+ * Reads a cache file written by ldns_nsec3_cache_save() into the cache,
+ * replacing its current contents.  A file that does not exist yet is
+ * not an error; the cache is simply left empty.
+ * \param[in] cache the cache to fill
+ * \param[in] filename the file to read
+ * \return LDNS_STATUS_OK on success, LDNS_STATUS_FILE_ERR when the file
+ *         could not be read or is not a valid cache file, and
+ *         LDNS_STATUS_MEM_ERR on memory error
+ */
+ldns_status ldns_nsec3_cache_load(ldns_nsec3_cache *cache,
+		const char *filename);
+
+/**
+ * Writes the entries that were looked up or added since the cache was
+ * loaded to filename.  The file is written under a temporary name
+ * first and renamed when complete, so an interrupted run leaves the
+ * previous cache file intact.
+ * \param[in] cache the cache to write
+ * \param[in] filename the file to write to
+ * \return LDNS_STATUS_OK on success or an error code otherwise
+ */
+ldns_status ldns_nsec3_cache_save(const ldns_nsec3_cache *cache,
+		const char *filename);
+
+/**
+ * Returns the NSEC3 hash of name, like ldns_nsec3_hash_name(), but looks
+ * it up in the cache first.  Hashes that were not in the cache are
+ * computed and added.  When the parameters differ from the ones the
+ * cache was built with, the cache is emptied first.
+ * \param[in] cache the cache to use; when NULL the hash is computed
+ * \param[in] name the owner name to calculate the hash for
+ * \param[in] algorithm the hash algorithm to use
+ * \param[in] iterations the number of hash iterations to use
+ * \param[in] salt_length the length of the salt in bytes
+ * \param[in] salt the salt to use
+ * \return the hashed owner name rdf, without the domain name
+ */
+ldns_rdf *ldns_nsec3_cache_hash_name(ldns_nsec3_cache *cache,
+		const ldns_rdf *name, uint8_t algorithm, uint16_t iterations,
+		uint8_t salt_length, const uint8_t *salt);
+
+/**
+ * Returns the number of entries in the cache
+ * \param[in] cache the cache
+ * \return the number of entries
+ */
+size_t ldns_nsec3_cache_count(const ldns_nsec3_cache *cache);
+
+/**
+ * Returns the number of hashes that were found in the cache
+ * \param[in] cache the cache
+ * \return the number of cache hits
+ */
+size_t ldns_nsec3_cache_hits(const ldns_nsec3_cache *cache);
+
+/**
+ * Returns the number of hashes that had to be computed
+ * \param[in] cache the cache
+ * \return the number of cache misses
+ */
+size_t ldns_nsec3_cache_misses(const ldns_nsec3_cache *cache);
+
+/**
+ * Returns the number of times the cache was emptied because it was
+ * asked for hashes with other NSEC3 parameters than it contained.
+ * \param[in] cache the cache
+ * \return the number of invalidations
+ */
+size_t ldns_nsec3_cache_invalidations(const ldns_nsec3_cache *cache);
+
+/**
+ * Estimates the time saved by the cache hits, based on the time it
+ * took to compute the misses.  When there were no misses, the
+ * average hashing time recorded in the loaded cache file is used.
+ * \param[in] cache the cache
+ * \return the estimated time saved in microseconds
+ */
+uint64_t ldns_nsec3_cache_time_saved(const ldns_nsec3_cache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_NSEC3_CACHE_H */
@@ -742,6 +742,20 @@ bool ldns_pkt_edns(const ldns_pkt *packet);
  */
 ldns_edns_option_list* ldns_pkt_edns_get_option_list(ldns_pkt *packet);
 
+/**
+ * Finds the first EDNS option with a code, without making the list of
+ * structured EDNS options.  The option is a view into the EDNS data of the
+ * packet, or into its list of options when there is one: it must not be
+ * freed, and it is valid until the EDNS data or the list is changed.
+ *
+ * \param[in] packet the packet which contains the EDNS data
+ * \param[in] code the option code to look for
+ * \param[out] option the option, filled in when it is found
+ * \return whether the option was found
+ */
+bool ldns_pkt_edns_option_find(const ldns_pkt *packet,
+		ldns_edns_option_code code, ldns_edns_option *option);
+
 /**
  * Set the packet's edns udp size
  * \param[in] packet the packet
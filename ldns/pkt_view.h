@@ -0,0 +1,192 @@
+/*
+ * pkt_view.h -- read-only view on a packet in wire format
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file pkt_view.h
+ *
+ * A view on a DNS message in wire format, to look at its header, question,
+ * RRs and OPT record without converting it to a ldns_pkt.  Making the view
+ * checks the message in one pass over it, and remembers where each
+ * section starts, without allocating memory or copying the message.
+ * The view points into the buffer the message is in, which must not change
+ * or be freed while the view is used.
+ *
+ * The RRs of a section are gone through with ldns_pkt_view_rr_first()
+ * and ldns_pkt_view_rr_next(), which give their owner name, type, class,
+ * TTL and rdata as they are in the message.  Names are decompressed into
+ * a buffer of the caller with ldns_pkt_view_name(), only when needed.
+ * The flags in the header are read with the LDNS_*_WIRE macros from
+ * wire2host.h on the wire member of the view.
+ */
+
+#ifndef LDNS_PKT_VIEW_H
+#define LDNS_PKT_VIEW_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/rr.h>
+#include <ldns/packet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A view on a DNS message in wire format
+ */
+struct ldns_struct_pkt_view
+{
+	/** The message */
+	const uint8_t *wire;
+	/** Length of the message */
+	size_t size;
+	/** Position of the first RR of each section */
+	size_t sections[4];
+	/** Number of RRs in each section */
+	uint16_t counts[4];
+	/** Position of the OPT RR, or 0 when there is none */
+	size_t opt;
+	/** Number of the OPT RR in the additional section */
+	uint16_t opt_index;
+};
+typedef struct ldns_struct_pkt_view ldns_pkt_view;
+
+/**
+ * A RR in a ldns_pkt_view
+ */
+struct ldns_struct_pkt_view_rr
+{
+	/** The view the RR is in */
+	const ldns_pkt_view *view;
+	/** The section the RR is in */
+	ldns_pkt_section section;
+	/** Number of the RR in its section, from 0 */
+	uint16_t index;
+	/** Owner name, possibly compressed, see ldns_pkt_view_name() */
+	const uint8_t *owner;
+	/** Type */
+	ldns_rr_type type;
+	/** Class, or the UDP payload size for OPT */
+	ldns_rr_class rr_class;
+	/** TTL, 0 in the question section */
+	uint32_t ttl;
+	/** Rdata, NULL in the question section */
+	const uint8_t *rdata;
+	/** Length of the rdata */
+	uint16_t rdlength;
+	/** Position of the next RR */
+	size_t next;
+};
+typedef struct ldns_struct_pkt_view_rr ldns_pkt_view_rr;
+
+/**
+ * Makes a view on a message in wire format.  The header, the owner names
+ * and the lengths of all RRs are checked, like ldns_wire2pkt() does, and
+ * with the same errors.  Names in rdata are not checked until they are
+ * decompressed with ldns_pkt_view_name().
+ * \param[out] view the view to fill
+ * \param[in] wire the message
+ * \param[in] max the length of the message
+ * \return LDNS_STATUS_OK, or the reason the message is malformed
+ */
+ldns_status ldns_pkt_view_init(ldns_pkt_view *view, const uint8_t *wire,
+		size_t max);
+
+/**
+ * Gets the ID of a message
+ * \param[in] view the view on the message
+ * \return the ID
+ */
+uint16_t ldns_pkt_view_id(const ldns_pkt_view *view);
+
+/**
+ * Gets the opcode of a message
+ * \param[in] view the view on the message
+ * \return the opcode
+ */
+ldns_pkt_opcode ldns_pkt_view_get_opcode(const ldns_pkt_view *view);
+
+/**
+ * Gets the rcode of a message, without the extended rcode from the OPT RR
+ * \param[in] view the view on the message
+ * \return the rcode
+ */
+ldns_pkt_rcode ldns_pkt_view_get_rcode(const ldns_pkt_view *view);
+
+/**
+ * Gets the number of RRs in a section of a message
+ * \param[in] view the view on the message
+ * \param[in] section the section, or LDNS_SECTION_ANY or
+ *            LDNS_SECTION_ANY_NOQUESTION
+ * \return the number of RRs
+ */
+uint16_t ldns_pkt_view_section_count(const ldns_pkt_view *view,
+		ldns_pkt_section section);
+
+/**
+ * Gets the first RR of a section
+ * \param[in] view the view on the message
+ * \param[in] section the section
+ * \param[out] rr the RR
+ * \return false when the section has no RRs
+ */
+bool ldns_pkt_view_rr_first(const ldns_pkt_view *view,
+		ldns_pkt_section section, ldns_pkt_view_rr *rr);
+
+/**
+ * Moves to the next RR of the same section
+ * \param[in,out] rr the RR
+ * \return false when rr was the last RR of the section
+ */
+bool ldns_pkt_view_rr_next(ldns_pkt_view_rr *rr);
+
+/**
+ * Gets the OPT RR of a message
+ * \param[in] view the view on the message
+ * \param[out] rr the OPT RR
+ * \return false when the message has no OPT RR
+ */
+bool ldns_pkt_view_edns(const ldns_pkt_view *view, ldns_pkt_view_rr *rr);
+
+/**
+ * Decompresses a name in a message.  A buffer of LDNS_MAX_DOMAINLEN bytes
+ * is always large enough.
+ * \param[in] view the view on the message
+ * \param[in] name the name, in the message: the owner of a RR, or in its
+ *            rdata
+ * \param[out] buf where to put the name in uncompressed wire format
+ * \param[in] size the size of buf
+ * \param[out] len the length of the name
+ * \return LDNS_STATUS_OK, LDNS_STATUS_DOMAINNAME_OVERFLOW when it does not
+ *         fit in buf, or the reason the name is malformed
+ */
+ldns_status ldns_pkt_view_name(const ldns_pkt_view *view,
+		const uint8_t *name, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * Converts a RR in a message to a ldns_rr
+ * \param[out] rr_p the new RR, to be freed by the caller
+ * \param[in] rr the RR in the message
+ * \return LDNS_STATUS_OK, or the reason the RR could not be converted
+ */
+ldns_status ldns_pkt_view_rr2rr(ldns_rr **rr_p, const ldns_pkt_view_rr *rr);
+
+/**
+ * Converts the message to a ldns_pkt, like ldns_wire2pkt()
+ * \param[out] packet_p the new packet, to be freed by the caller
+ * \param[in] view the view on the message
+ * \return LDNS_STATUS_OK, or the reason the message could not be converted
+ */
+ldns_status ldns_pkt_view2pkt(ldns_pkt **packet_p, const ldns_pkt_view *view);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_PKT_VIEW_H */
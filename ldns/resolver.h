@@ -26,6 +26,10 @@
 #include <ldns/tsig.h>
 #include <ldns/rdata.h>
 #include <ldns/packet.h>
+#include <ldns/udp_pool.h>
+#include <ldns/tcp_pool.h>
+#include <ldns/tcp_frame.h>
+#include <ldns/cache.h>
 #include <sys/time.h>
 
 #ifdef __cplusplus
@@ -53,6 +57,25 @@ extern "C" {
 #define LDNS_RESOLV_RTT_INF             0       /* infinity */
 #define LDNS_RESOLV_RTT_MIN             1       /* reachable */
 
+/** Milliseconds to wait for a nameserver without a measured round trip
+ *  time before the next one is raced (see ldns_resolver_set_race()) */
+#define LDNS_RESOLV_RACE_DELAY          250
+/** Shortest wait before the next nameserver is raced, in milliseconds */
+#define LDNS_RESOLV_RACE_DELAY_MIN      20
+
+/** Round trip time in milliseconds assumed for a nameserver that was not
+ *  measured yet, when ordering by smoothed round trip time */
+#define LDNS_RESOLV_RTT_UNKNOWN         376
+/** Highest smoothed round trip time, in milliseconds */
+#define LDNS_RESOLV_RTT_MAX             120000
+/** Shortest retransmission timeout, in milliseconds */
+#define LDNS_RESOLV_RTO_MIN             50
+/** One in this many queries goes to another nameserver than the fastest,
+ *  to measure it again */
+#define LDNS_RESOLV_EXPLORE             20
+/** Seconds after which saved round trip times are no longer loaded */
+#define LDNS_RESOLV_RTT_STATE_AGE       3600
+
 /**
  * DNS stub resolver structure
  */
@@ -66,7 +89,7 @@ struct ldns_struct_resolver
 	/** Number of nameservers in \c _nameservers */
 	size_t _nameserver_count; /* how many do we have */
 
-	/**  Round trip time; 0 -> infinity. Unit: ms? */
+	/**  Round trip time; 0 -> infinity, 1 -> not measured. Unit: ms */
 	size_t *_rtt;
 
 	/**  Whether or not to be recursive */
@@ -143,6 +166,31 @@ struct ldns_struct_resolver
 
 	/** Source address to query from */
 	ldns_rdf *_source;
+
+	/** Sockets to send UDP queries from, or NULL for a new socket
+	 *  per query */
+	ldns_udp_pool *_udp_pool;
+
+	/** Connections to send TCP queries over, or NULL for a new
+	 *  connection per query */
+	ldns_tcp_pool *_tcp_pool;
+
+	/** Race the nameservers instead of trying them one after another */
+	bool _race;
+
+	/** Round trip time variation per nameserver, in ms */
+	size_t *_rttvar;
+	/** Whether the round trip time of a nameserver is measured, false
+	 *  before the first answer and after a backoff */
+	bool *_rtt_measured;
+	/** Pick nameservers and timeouts by smoothed round trip time */
+	bool _srtt;
+
+	/** Cache of answers, or NULL.  Not owned by the resolver. */
+	ldns_cache *_cache;
+
+	/** Takes the messages of an AXFR from the TCP stream */
+	ldns_tcp_reader _axfr_reader;
 };
 typedef struct ldns_struct_resolver ldns_resolver;
 
@@ -163,6 +211,21 @@ uint16_t ldns_resolver_port(const ldns_resolver *r);
  */
 ldns_rdf *ldns_resolver_source(const ldns_resolver *r);
 
+/**
+ * Get the pool of UDP sockets the resolver sends queries from
+ * \param[in] r the resolver
+ * \return the pool, or NULL when a new socket is used for every query
+ */
+ldns_udp_pool *ldns_resolver_udp_pool(const ldns_resolver *r);
+
+/**
+ * Get the pool of TCP connections the resolver sends queries over
+ * \param[in] r the resolver
+ * \return the pool, or NULL when a new connection is made for every
+ *         query
+ */
+ldns_tcp_pool *ldns_resolver_tcp_pool(const ldns_resolver *r);
+
 /**
  * Is the resolver set to recurse
  * \param[in] r the resolver
@@ -265,6 +328,24 @@ bool ldns_resolver_igntc(const ldns_resolver *r);
  * \return true: yes, false: no
  */
 bool ldns_resolver_random(const ldns_resolver *r);
+/**
+ * Does the resolver race its nameservers
+ * \param[in] r the resolver
+ * \return true: yes, false: no
+ */
+bool ldns_resolver_race(const ldns_resolver *r);
+/**
+ * Does the resolver pick nameservers by smoothed round trip time
+ * \param[in] r the resolver
+ * \return true: yes, false: no
+ */
+bool ldns_resolver_srtt(const ldns_resolver *r);
+/**
+ * Get the cache of answers of the resolver
+ * \param[in] r the resolver
+ * \return the cache, or NULL when the resolver does not cache
+ */
+ldns_cache *ldns_resolver_cache(const ldns_resolver *r);
 /**
  * How many nameserver are configured in the resolver
  * \param[in] r the resolver
@@ -309,6 +390,25 @@ size_t * ldns_resolver_rtt(const ldns_resolver *r);
  * \return the rrt, 0: infinite, >0: undefined (as of * yet)
  */
 size_t ldns_resolver_nameserver_rtt(const ldns_resolver *r, size_t pos);
+/**
+ * Return the round trip time variation of a specific nameserver
+ * \param[in] r the resolver
+ * \param[in] pos the index to the nameserver
+ * \return the variation in milliseconds
+ */
+size_t ldns_resolver_nameserver_rttvar(const ldns_resolver *r, size_t pos);
+/**
+ * Return how long to wait for an answer from a specific nameserver before
+ * sending again: the smoothed round trip time plus four times its
+ * variation, at least LDNS_RESOLV_RTO_MIN milliseconds and at most the
+ * timeout of the resolver.  For a nameserver that was not measured yet,
+ * this is the timeout of the resolver.
+ * \param[in] r the resolver
+ * \param[in] pos the index to the nameserver
+ * \return the retransmission timeout
+ */
+struct timeval ldns_resolver_nameserver_rto(const ldns_resolver *r,
+		size_t pos);
 /**
  * Return the tsig keyname as used by the nameserver
  * \param[in] r the resolver
@@ -359,6 +459,24 @@ void ldns_resolver_set_port(ldns_resolver *r, uint16_t p);
  */
 void ldns_resolver_set_source(ldns_resolver *r, ldns_rdf *s);
 
+/**
+ * Set the pool of UDP sockets the resolver sends queries from.  The
+ * resolver takes ownership of the pool and frees it in
+ * ldns_resolver_deep_free(), or when another pool is set.
+ * \param[in] r the resolver
+ * \param[in] pool the pool, or NULL to use a new socket for every query
+ */
+void ldns_resolver_set_udp_pool(ldns_resolver *r, ldns_udp_pool *pool);
+
+/**
+ * Set the pool of TCP connections the resolver sends queries over.  The
+ * resolver takes ownership of the pool and frees it in
+ * ldns_resolver_deep_free(), or when another pool is set.
+ * \param[in] r the resolver
+ * \param[in] pool the pool, or NULL to connect for every query
+ */
+void ldns_resolver_set_tcp_pool(ldns_resolver *r, ldns_tcp_pool *pool);
+
 /**
  * Set the resolver recursion
  * \param[in] r the resolver
@@ -566,6 +684,104 @@ void ldns_resolver_set_nameserver_rtt(ldns_resolver *r, size_t pos, size_t value
  */
 void ldns_resolver_set_random(ldns_resolver *r, bool b);
 
+/**
+ * Whether to race the nameservers for UDP queries.  The query is sent
+ * to the nameserver with the lowest round trip time first.  When no
+ * answer came after twice that time (or LDNS_RESOLV_RACE_DELAY
+ * milliseconds when it was not measured yet), it is sent to the next
+ * nameserver as well, alternating between IPv4 and IPv6 addresses, and
+ * so on.  The first answer that is not SERVFAIL, REFUSED or NOTIMPL is
+ * taken, and the queries to the other nameservers are abandoned.
+ *
+ * Every nameserver is still given the timeout and the number of retries
+ * of the resolver, and nameservers that did not answer are marked
+ * unreachable.  The round trip time of the nameserver that answered is
+ * stored, so that it is tried first next time.  The fail and retrans
+ * settings are not used when racing.  TCP queries are not raced.
+ * \param[in] r the resolver
+ * \param[in] b true: race, false: try the nameservers in turn
+ */
+void ldns_resolver_set_race(ldns_resolver *r, bool b);
+
+/**
+ * Whether to pick nameservers by smoothed round trip time.  Before every
+ * query the nameservers are ordered by their smoothed round trip time,
+ * with the ones not measured yet counting as LDNS_RESOLV_RTT_UNKNOWN
+ * milliseconds.  One in LDNS_RESOLV_EXPLORE queries goes to another
+ * nameserver first, so that slower nameservers are measured again.  Such
+ * a nameserver is tried once, and only waited for as long as the
+ * retransmission timeout of the nameserver after it.
+ *
+ * Each nameserver is waited for as long as its retransmission timeout
+ * (see ldns_resolver_nameserver_rto()), doubled on every retry, instead
+ * of the full timeout of the resolver.  Round trip times are updated
+ * from the query time of answers to a first try, as RFC 6298 describes,
+ * and a nameserver that does not answer has its round trip time doubled
+ * instead of being marked unreachable.
+ * \param[in] r the resolver
+ * \param[in] b true: order by round trip time, false: do not
+ */
+void ldns_resolver_set_srtt(ldns_resolver *r, bool b);
+
+/**
+ * Set the cache of answers of the resolver.  Queries are answered from
+ * the cache when possible, and answers from nameservers are stored in it,
+ * except for queries signed with TSIG.  The cache is not owned by the
+ * resolver: it is shared with clones of the resolver, and must be freed
+ * with ldns_cache_free() after the resolvers that use it.
+ * \param[in] r the resolver
+ * \param[in] cache the cache, or NULL to not cache
+ */
+void ldns_resolver_set_cache(ldns_resolver *r, ldns_cache *cache);
+
+/**
+ * Add a round trip time measurement of a nameserver to its smoothed
+ * round trip time and variation.
+ * \param[in] r the resolver
+ * \param[in] pos the index to the nameserver
+ * \param[in] ms the measured round trip time in milliseconds
+ */
+void ldns_resolver_nameserver_rtt_update(ldns_resolver *r, size_t pos,
+		size_t ms);
+
+/**
+ * Double the smoothed round trip time of a nameserver that did not
+ * answer, up to LDNS_RESOLV_RTT_MAX milliseconds.  The next measurement
+ * replaces it.
+ * \param[in] r the resolver
+ * \param[in] pos the index to the nameserver
+ */
+void ldns_resolver_nameserver_rtt_backoff(ldns_resolver *r, size_t pos);
+
+/**
+ * Order the nameservers by smoothed round trip time, fastest first.  One
+ * in LDNS_RESOLV_EXPLORE times a random other nameserver is put first.
+ * \param[in] r the resolver
+ */
+void ldns_resolver_nameservers_sort_rtt(ldns_resolver *r);
+
+/**
+ * Write the measured round trip times of the nameservers to a file, one
+ * line per nameserver with its address, smoothed round trip time and
+ * variation in milliseconds, and the current time.
+ * \param[in] fp the file to write to
+ * \param[in] r the resolver
+ * \return LDNS_STATUS_OK or LDNS_STATUS_FILE_ERR
+ */
+ldns_status ldns_resolver_write_rtt(FILE *fp, const ldns_resolver *r);
+
+/**
+ * Read round trip times written by ldns_resolver_write_rtt() and set
+ * them for the nameservers of the resolver with the same address.  Lines
+ * older than LDNS_RESOLV_RTT_STATE_AGE seconds and lines for other
+ * addresses are skipped.
+ * \param[in] r the resolver
+ * \param[in] fp the file to read from
+ * \return LDNS_STATUS_OK, or LDNS_STATUS_SYNTAX_ERR for a line that could
+ *         not be parsed
+ */
+ldns_status ldns_resolver_read_rtt(ldns_resolver *r, FILE *fp);
+
 /**
  * Push a new nameserver to the resolver. It must be an IP
  * address v4 or v6.
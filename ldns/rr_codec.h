@@ -0,0 +1,72 @@
+/*
+ * rr_codec.h -- rdata encoders and decoders for each RR type
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file rr_codec.h
+ *
+ * Functions to convert the rdata of one RR type, made from the rdata
+ * field descriptors by rr_codec.pl, so they do not look up the type of
+ * every field when they run.  ldns_wire2rdf(), ldns_rr2wire(),
+ * ldns_rr2buffer_wire_canonical() and ldns_rr_compare() use them for the
+ * types that have them, and fall back to going over the field descriptors
+ * for the other types, and for RRs that do not have the rdfs of their
+ * type.
+ */
+
+#ifndef LDNS_RR_CODEC_H
+#define LDNS_RR_CODEC_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/rr.h>
+#include <ldns/buffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The functions for the rdata of a RR type
+ */
+struct ldns_struct_rr_codec
+{
+	/** Whether the names in the rdata are lowercased in the canonical
+	 *  form (RFC 4034 section 6.2) */
+	bool canonical_lowercase;
+	/** Reads the rdata at *pos up to end and pushes the rdfs to rr, as
+	 *  ldns_wire2rdf() after the rdata length */
+	ldns_status (*wire2rdf)(ldns_rr *rr, const uint8_t *wire, size_t max,
+			size_t *pos, size_t end);
+	/** Writes the rdata of rr to the buffer, without name compression.
+	 *  Returns false, without writing, when rr does not have the rdfs of
+	 *  its type, else the status is that of the buffer. */
+	bool (*rdata2wire)(ldns_buffer *buffer, const ldns_rr *rr);
+	/** Writes the rdata of rr to the buffer in canonical form, or
+	 *  returns false like rdata2wire */
+	bool (*rdata2wire_canonical)(ldns_buffer *buffer, const ldns_rr *rr);
+	/** Compares the rdata of two RRs of the type in canonical form, and
+	 *  puts -1, 0 or 1 in result.  Returns false when it can not tell,
+	 *  for RRs that do not have the rdfs of their type. */
+	bool (*compare)(const ldns_rr *rr1, const ldns_rr *rr2, int *result);
+};
+typedef struct ldns_struct_rr_codec ldns_rr_codec;
+
+/**
+ * Gets the rdata functions of a RR type
+ * \param[in] type the RR type
+ * \return the functions, or NULL for types with a variable number of
+ *         rdata fields and unknown types
+ */
+const ldns_rr_codec *ldns_rr_codec_get(ldns_rr_type type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_RR_CODEC_H */
@@ -0,0 +1,244 @@
+/*
+ * server.h -- answering queries without ldns_pkt
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file server.h
+ *
+ * A fast path for servers, to answer queries without making a ldns_pkt
+ * for the query or for the answer.  ldns_query_info_from_wire() checks a
+ * query in wire format and takes its header, question and EDNS data.  A
+ * ldns_response then writes the answer to a buffer of the caller, which
+ * can be used again for the next answer: the header and question are
+ * taken from the query, and RRs are added with name compression, from
+ * RR lists loaded beforehand or from RRs already in wire format.  RRs that
+ * do not fit in the size the answer may have are left out, and the TC
+ * flag is set when that happens in the answer or authority section.
+ */
+
+#ifndef LDNS_SERVER_H
+#define LDNS_SERVER_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/rr.h>
+#include <ldns/packet.h>
+#include <ldns/buffer.h>
+#include <ldns/host2wire.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The EDNS UDP size put in answers by default */
+#define LDNS_RESPONSE_EDNS_UDP_SIZE	1232
+
+/**
+ * The header, question and EDNS data of a query
+ */
+struct ldns_struct_query_info
+{
+	/** ID */
+	uint16_t id;
+	/** Opcode */
+	ldns_pkt_opcode opcode;
+	/** The RD flag */
+	bool rd;
+	/** The CD flag */
+	bool cd;
+	/** The query name, uncompressed */
+	uint8_t qname[LDNS_MAX_DOMAINLEN];
+	/** Length of the query name, 0 when the query has no question */
+	size_t qname_size;
+	/** Query type */
+	ldns_rr_type qtype;
+	/** Query class */
+	ldns_rr_class qclass;
+	/** Whether the query has an OPT RR */
+	bool edns;
+	/** EDNS UDP size */
+	uint16_t udp_size;
+	/** EDNS version */
+	uint8_t edns_version;
+	/** The DO flag */
+	bool edns_do;
+	/** The EDNS options, in the query */
+	const uint8_t *edns_data;
+	/** Length of the EDNS options */
+	uint16_t edns_data_size;
+};
+typedef struct ldns_struct_query_info ldns_query_info;
+
+/**
+ * An answer being written
+ */
+struct ldns_struct_response
+{
+	/** The buffer the answer is written to */
+	ldns_buffer *buffer;
+	/** The longest the answer may be */
+	size_t max;
+	/** Whether the answer gets an OPT RR */
+	bool edns;
+	/** EDNS UDP size of the answer, may be changed before
+	 *  ldns_response_finish() */
+	uint16_t udp_size;
+	/** The DO flag of the answer */
+	bool edns_do;
+	/** Rcode, including the extended rcode bits */
+	uint16_t rcode;
+	/** Number of RRs in each section */
+	uint16_t counts[4];
+	/** Names written so far */
+	ldns_compression_table table;
+};
+typedef struct ldns_struct_response ldns_response;
+
+/**
+ * Takes the header, the question and the EDNS data of a query in wire
+ * format, after checking it like ldns_pkt_view_init() does.  The EDNS
+ * options are not copied: qi points into wire for them.
+ * \param[out] qi the query information
+ * \param[in] wire the query
+ * \param[in] len the length of the query
+ * \return LDNS_STATUS_OK, LDNS_STATUS_ERR when it is not a query with one
+ *         question, in which case the header fields of qi are set, so a
+ *         FORMERR can be sent with it, or the reason the query is malformed
+ */
+ldns_status ldns_query_info_from_wire(ldns_query_info *qi,
+		const uint8_t *wire, size_t len);
+
+/**
+ * Gets the longest UDP answer that can be sent to a query: the EDNS UDP
+ * size, or 512 without EDNS.
+ * \param[in] qi the query information
+ * \return the size
+ */
+size_t ldns_query_info_max_udp(const ldns_query_info *qi);
+
+/**
+ * Starts an answer to a query.  The header gets the ID, opcode, RD and CD
+ * flag of the query and the QR flag, and the question is copied.  The
+ * answer gets an OPT RR when the query has one.
+ * \param[out] resp the answer
+ * \param[in] buffer where to write the answer; it is cleared first
+ * \param[in] qi the query information
+ * \param[in] max the longest the answer may be, ldns_query_info_max_udp()
+ *            over UDP, or LDNS_MAX_PACKETLEN over TCP
+ * \return LDNS_STATUS_OK, or LDNS_STATUS_MEM_ERR when the buffer can not
+ *         grow to hold the header and question
+ */
+ldns_status ldns_response_init(ldns_response *resp, ldns_buffer *buffer,
+		const ldns_query_info *qi, size_t max);
+
+/**
+ * Sets flags in the header of an answer
+ * \param[in] resp the answer
+ * \param[in] flags LDNS_AA, LDNS_TC, LDNS_RA and LDNS_AD or'ed together
+ */
+void ldns_response_set_flags(ldns_response *resp, uint16_t flags);
+
+/**
+ * Sets the rcode of an answer.  The upper 8 bits of an extended rcode go
+ * in the OPT RR, and are lost when the query had no EDNS.
+ * \param[in] resp the answer
+ * \param[in] rcode the rcode
+ */
+void ldns_response_set_rcode(ldns_response *resp, uint16_t rcode);
+
+/**
+ * Gets the number of bytes left in an answer, with room kept for the OPT
+ * RR when the answer gets one.
+ * \param[in] resp the answer
+ * \return the number of bytes
+ */
+size_t ldns_response_room(const ldns_response *resp);
+
+/**
+ * Gets the number of bytes RRs would take when they are added to a section
+ * of an answer now, with the names compressed exactly like
+ * ldns_response_add_rr_list() would, without writing them.
+ * \param[in] resp the answer
+ * \param[in] section the section
+ * \param[in] rrs the RRs
+ * \return the number of bytes, to compare to ldns_response_room()
+ */
+size_t ldns_response_rr_list_size(const ldns_response *resp,
+		ldns_pkt_section section, const ldns_rr_list *rrs);
+
+/**
+ * Adds RRs to a section of an answer, with name compression.  Their size
+ * is computed first, and when they do not all fit, none are written, and
+ * the TC flag is set for the answer and authority sections.
+ * \param[in] resp the answer
+ * \param[in] section LDNS_SECTION_ANSWER, LDNS_SECTION_AUTHORITY or
+ *            LDNS_SECTION_ADDITIONAL
+ * \param[in] rrs the RRs
+ * \return LDNS_STATUS_OK, LDNS_STATUS_PACKET_OVERFLOW when the RRs do not
+ *         fit, or LDNS_STATUS_MEM_ERR
+ */
+ldns_status ldns_response_add_rr_list(ldns_response *resp,
+		ldns_pkt_section section, const ldns_rr_list *rrs);
+
+/**
+ * Adds whole RRsets to a section of an answer, as far as they fit, without
+ * writing the ones that do not (RFC 2181 section 9).  In the answer and
+ * authority sections, the RRsets after one that does not fit are left out
+ * too, and the TC flag is set.  In the additional section, the RRsets that
+ * do not fit are skipped, and the ones after them are still added when
+ * they fit, without setting the TC flag; set it with
+ * ldns_response_set_flags() when an RRset that is left out is needed, such
+ * as glue for a referral.
+ * \param[in] resp the answer
+ * \param[in] section LDNS_SECTION_ANSWER, LDNS_SECTION_AUTHORITY or
+ *            LDNS_SECTION_ADDITIONAL
+ * \param[in] rrsets the RRsets
+ * \param[in] count the number of RRsets
+ * \param[out] added when not NULL, set for each RRset to whether it was
+ *             added
+ * \return LDNS_STATUS_OK, also when RRsets were skipped in the additional
+ *         section, LDNS_STATUS_PACKET_OVERFLOW when RRsets were left out of
+ *         the answer or authority section, or LDNS_STATUS_MEM_ERR
+ */
+ldns_status ldns_response_add_rrsets(ldns_response *resp,
+		ldns_pkt_section section, ldns_rr_list *const *rrsets,
+		size_t count, bool *added);
+
+/**
+ * Adds RRs in wire format to a section of an answer, as they are, with
+ * uncompressed owner names, as ldns_rr2wire() makes them.  The owner
+ * names are compressed, the rdata is copied as it is.  When they do not
+ * all fit, none are added, and the TC flag is set for the answer and
+ * authority sections.
+ * \param[in] resp the answer
+ * \param[in] section LDNS_SECTION_ANSWER, LDNS_SECTION_AUTHORITY or
+ *            LDNS_SECTION_ADDITIONAL
+ * \param[in] wire the RRs
+ * \param[in] len the length of the RRs
+ * \param[in] count the number of RRs
+ * \return LDNS_STATUS_OK, LDNS_STATUS_PACKET_OVERFLOW when the RRs do not
+ *         fit, LDNS_STATUS_WIRE_RDATA_ERR when they are malformed, or
+ *         LDNS_STATUS_MEM_ERR
+ */
+ldns_status ldns_response_add_wire(ldns_response *resp,
+		ldns_pkt_section section, const uint8_t *wire, size_t len,
+		uint16_t count);
+
+/**
+ * Finishes an answer: writes the counts of the sections and the OPT RR.
+ * The answer is then from the beginning of the buffer up to its position.
+ * \param[in] resp the answer
+ * \return LDNS_STATUS_OK or LDNS_STATUS_MEM_ERR
+ */
+ldns_status ldns_response_finish(ldns_response *resp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_SERVER_H */
@@ -38,6 +38,22 @@ void ldns_sha1_final(unsigned char digest[LDNS_SHA1_DIGEST_LENGTH], ldns_sha1_ct
  */
 unsigned char *ldns_sha1(const unsigned char *data, unsigned int data_len, unsigned char *digest);
 
+/**
+ * Digest a number of independent messages in one go.  On x86 CPUs
+ * with AVX2 (but without the SHA extensions) up to eight messages are
+ * hashed in parallel, which pays off for many short inputs such as
+ * NSEC3 owner names.  Elsewhere the messages are hashed one by one.
+ *
+ * \param[in] count the number of messages
+ * \param[in] data array of count pointers to the messages
+ * \param[in] data_len array of count message lengths in bytes
+ * \param[out] digests buffer receiving the digests, one after the other.
+ *             This pointer MUST have count * LDNS_SHA1_DIGEST_LENGTH
+ *             bytes available
+ */
+void ldns_sha1_many(size_t count, const unsigned char * const *data,
+		const size_t *data_len, unsigned char *digests);
+
 #ifdef __cplusplus
 }
 #endif
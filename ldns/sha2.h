@@ -111,6 +111,22 @@ void ldns_sha512_final(uint8_t[LDNS_SHA512_DIGEST_LENGTH], ldns_sha512_CTX*);
  */
 unsigned char *ldns_sha256(const unsigned char *data, unsigned int data_len, unsigned char *digest);
 
+/**
+ * Digest a number of independent messages in one go.  On x86 CPUs
+ * with AVX2 (but without the SHA extensions) up to eight messages are
+ * hashed in parallel, which pays off for many short inputs.
+ * Elsewhere the messages are hashed one by one.
+ *
+ * \param[in] count the number of messages
+ * \param[in] data array of count pointers to the messages
+ * \param[in] data_len array of count message lengths in bytes
+ * \param[out] digests buffer receiving the digests, one after the other.
+ *             This pointer MUST have count * LDNS_SHA256_DIGEST_LENGTH
+ *             bytes available
+ */
+void ldns_sha256_many(size_t count, const unsigned char * const *data,
+		const size_t *data_len, unsigned char *digests);
+
 /**
  * Convenience function to digest a fixed block of data at once.
  *
@@ -0,0 +1,172 @@
+/*
+ * tcp_frame.h -- DNS messages over TCP, read and written in pieces
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file tcp_frame.h
+ *
+ * Over TCP every DNS message has its length in two bytes in front of it
+ * (RFC 1035 section 4.2.2, RFC 7766 section 8).  A ldns_tcp_reader takes
+ * the bytes of a stream in pieces of any size, as they are received, and
+ * gives the whole messages in them, so that many connections can be read
+ * in one thread without blocking on any of them.  Messages that are whole
+ * in a piece are given where they are, without copying; only messages
+ * that come in more than one piece are put together.
+ *
+ * A ldns_tcp_writer queues messages with their lengths, and writes them
+ * in one gathering sendmsg() call, like writev() but without SIGPIPE when
+ * the other end has gone, continuing where the socket left off when it
+ * does not take everything at once.
+ */
+
+#ifndef LDNS_TCP_FRAME_H
+#define LDNS_TCP_FRAME_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The most messages a ldns_tcp_writer queues */
+#define LDNS_TCP_WRITER_MAX	16
+
+/**
+ * Takes messages from a TCP stream
+ */
+struct ldns_struct_tcp_reader
+{
+	/** The length of the message being read */
+	uint8_t len[2];
+	/** Bytes of the length and the message taken so far */
+	size_t have;
+	/** Where a message that comes in pieces is put together */
+	uint8_t *msg;
+	/** Bytes received by ldns_tcp_reader_recv() */
+	uint8_t *in;
+	/** How far the bytes in in are taken */
+	size_t in_pos;
+	/** The number of bytes in in */
+	size_t in_len;
+};
+typedef struct ldns_struct_tcp_reader ldns_tcp_reader;
+
+/**
+ * Queues messages to write to a TCP stream
+ */
+struct ldns_struct_tcp_writer
+{
+	/** The messages, which must stay until they are written */
+	const uint8_t *msgs[LDNS_TCP_WRITER_MAX];
+	/** The lengths of the messages, as written in front of them */
+	uint8_t lens[LDNS_TCP_WRITER_MAX][2];
+	/** The number of messages queued */
+	size_t count;
+	/** The number of bytes of the queue written */
+	size_t written;
+};
+typedef struct ldns_struct_tcp_writer ldns_tcp_writer;
+
+/**
+ * Initializes a reader for the start of a stream
+ * \param[in] r the reader
+ */
+void ldns_tcp_reader_init(ldns_tcp_reader *r);
+
+/**
+ * Drops the bytes a reader holds and frees its memory.  It can be used
+ * again for the start of a stream.
+ * \param[in] r the reader
+ */
+void ldns_tcp_reader_clear(ldns_tcp_reader *r);
+
+/**
+ * Takes bytes from a piece of a stream, up to the end of the next message.
+ * Call it again with the rest of the piece until all is used, to get the
+ * next messages in the piece.
+ * \param[in] r the reader
+ * \param[in] data the piece
+ * \param[in] len the length of the piece
+ * \param[out] used the number of bytes of the piece taken
+ * \param[out] msg the message when it is whole, or NULL.  It points into
+ *             data when the whole message is in the piece, and else into
+ *             the reader, and may change at the next call.
+ * \param[out] msg_len the length of the message
+ * \return LDNS_STATUS_OK or LDNS_STATUS_MEM_ERR
+ */
+ldns_status ldns_tcp_reader_next(ldns_tcp_reader *r, const uint8_t *data,
+		size_t len, size_t *used, const uint8_t **msg, size_t *msg_len);
+
+/**
+ * Receives once from a socket into the reader.  It can be called on
+ * sockets that do not block.
+ * \param[in] r the reader
+ * \param[in] sockfd the socket
+ * \return LDNS_STATUS_OK when bytes were received or there were none to
+ *         receive yet, LDNS_STATUS_SOCKET_ERROR when the connection is
+ *         closed or failed, or LDNS_STATUS_MEM_ERR
+ */
+ldns_status ldns_tcp_reader_recv(ldns_tcp_reader *r, int sockfd);
+
+/**
+ * Gets the next whole message from the bytes ldns_tcp_reader_recv()
+ * received.
+ * \param[in] r the reader
+ * \param[out] msg the message, valid up to the next call for the reader
+ * \param[out] msg_len the length of the message
+ * \return whether there was a whole message
+ */
+bool ldns_tcp_reader_get(ldns_tcp_reader *r, const uint8_t **msg,
+		size_t *msg_len);
+
+/**
+ * Tells whether a reader has taken part of a message
+ * \param[in] r the reader
+ * \return true when the stream stopped now would end in a message
+ */
+bool ldns_tcp_reader_partial(const ldns_tcp_reader *r);
+
+/**
+ * Initializes a writer without messages
+ * \param[in] w the writer
+ */
+void ldns_tcp_writer_init(ldns_tcp_writer *w);
+
+/**
+ * Queues a message.  It is not copied, and must stay until
+ * ldns_tcp_writer_pending() says it is written.
+ * \param[in] w the writer
+ * \param[in] msg the message
+ * \param[in] len the length of the message
+ * \return false when the queue is full or the message is too long
+ */
+bool ldns_tcp_writer_add(ldns_tcp_writer *w, const uint8_t *msg, size_t len);
+
+/**
+ * Writes the queued messages to a socket, as far as it takes them.
+ * Written messages are taken from the queue.
+ * \param[in] w the writer
+ * \param[in] sockfd the socket
+ * \return LDNS_STATUS_OK, also when the socket does not take all yet, or
+ *         LDNS_STATUS_SOCKET_ERROR
+ */
+ldns_status ldns_tcp_writer_flush(ldns_tcp_writer *w, int sockfd);
+
+/**
+ * Returns the number of bytes queued that are not written yet
+ * \param[in] w the writer
+ * \return the number of bytes
+ */
+size_t ldns_tcp_writer_pending(const ldns_tcp_writer *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_TCP_FRAME_H */
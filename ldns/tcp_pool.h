@@ -0,0 +1,167 @@
+/*
+ * tcp_pool.h -- persistent TCP connections to nameservers
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file tcp_pool.h
+ *
+ * Keeps TCP connections to nameservers open, to send query after query
+ * over them instead of connecting for every query.  Many queries can be
+ * sent at once over a connection, and their answers are matched by
+ * message ID in whatever order they arrive, as described in RFC 7766.
+ *
+ * Queries that carry an EDNS OPT record as their last record get the
+ * edns-tcp-keepalive option (RFC 7828) added.  When a nameserver answers
+ * with a keepalive timeout, the connection is closed once it has been
+ * idle for that long, and at once when the timeout is 0.  Without one,
+ * the idle timeout of the pool is used.  When the nameserver closes a
+ * connection with queries still unanswered, they are sent again over a
+ * new connection.
+ *
+ * Give a resolver a pool with ldns_resolver_set_tcp_pool() and its TCP
+ * queries, including the retries over TCP of truncated answers, are
+ * sent over the connections of the pool.  ldns_send_bulk() pipelines
+ * all its queries over one connection when the resolver uses TCP.
+ *
+ * A pool must be used by one thread at a time, and must not be shared
+ * between processes after fork().
+ */
+
+#ifndef LDNS_TCP_POOL_H
+#define LDNS_TCP_POOL_H
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/rdata.h>
+#include <sys/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default idle timeout in milliseconds, used when the nameserver does
+ *  not give one */
+#define LDNS_TCP_POOL_DEFAULT_IDLE 10000
+
+/**
+ * Pool of TCP connections
+ */
+typedef struct ldns_struct_tcp_pool ldns_tcp_pool;
+
+/**
+ * Counters of a pool
+ */
+struct ldns_struct_tcp_pool_stats
+{
+	/** Connections opened */
+	size_t connects;
+	/** Queries sent */
+	size_t queries;
+	/** Queries sent over a connection that was already open */
+	size_t reused;
+	/** Connections opened again to resend queries after the nameserver
+	 *  closed the connection */
+	size_t reconnects;
+	/** Connections closed because they were idle for too long */
+	size_t expired;
+};
+typedef struct ldns_struct_tcp_pool_stats ldns_tcp_pool_stats;
+
+/**
+ * Creates a new pool without connections
+ * \return the pool, or NULL on memory error
+ */
+ldns_tcp_pool *ldns_tcp_pool_new(void);
+
+/**
+ * Closes the connections of a pool and frees it
+ * \param[in] pool the pool to free
+ */
+void ldns_tcp_pool_free(ldns_tcp_pool *pool);
+
+/**
+ * Closes all connections of a pool
+ * \param[in] pool the pool
+ */
+void ldns_tcp_pool_close(ldns_tcp_pool *pool);
+
+/**
+ * Returns the idle timeout of the pool
+ * \param[in] pool the pool
+ * \return the timeout in milliseconds
+ */
+uint32_t ldns_tcp_pool_idle(const ldns_tcp_pool *pool);
+
+/**
+ * Sets after how long without queries a connection is closed, when the
+ * nameserver did not give a keepalive timeout
+ * \param[in] pool the pool
+ * \param[in] ms the timeout in milliseconds
+ */
+void ldns_tcp_pool_set_idle(ldns_tcp_pool *pool, uint32_t ms);
+
+/**
+ * Sends a query over the connection to a nameserver, and waits for the
+ * answer.
+ * \param[in] pool the pool
+ * \param[in] ns the address of the nameserver (of type A or AAAA)
+ * \param[in] port the port of the nameserver
+ * \param[in] source the address to connect from, or NULL
+ * \param[in] query the query in wire format
+ * \param[in] query_len the length of query
+ * \param[in] timeout how long to wait for the connection and the answer
+ * \param[out] answer the answer in wire format, to be freed by the caller
+ * \param[out] answer_size the length of answer
+ * \return LDNS_STATUS_OK, LDNS_STATUS_NETWORK_ERR when no answer arrived
+ *         in time, or another error
+ */
+ldns_status ldns_tcp_pool_send(ldns_tcp_pool *pool,
+		const ldns_rdf *ns, uint16_t port, const ldns_rdf *source,
+		const uint8_t *query, size_t query_len, struct timeval timeout,
+		uint8_t **answer, size_t *answer_size);
+
+/**
+ * Sends queries over the connection to a nameserver without waiting for
+ * answers in between, and collects the answers as they arrive.  The
+ * queries should have distinct message IDs; answers with the same ID
+ * are given to the queries in the order they were sent.
+ * \param[in] pool the pool
+ * \param[in] ns the address of the nameserver (of type A or AAAA)
+ * \param[in] port the port of the nameserver
+ * \param[in] source the address to connect from, or NULL
+ * \param[in] queries the queries in wire format
+ * \param[in] query_lens the lengths of the queries
+ * \param[in] n the number of queries
+ * \param[in] timeout how long to wait for the connection, and for the
+ *            next answer
+ * \param[out] answers the answers in wire format, NULL for the queries
+ *             that were not answered.  To be freed by the caller.
+ * \param[out] answer_sizes the lengths of the answers
+ * \return LDNS_STATUS_OK when all queries were answered,
+ *         LDNS_STATUS_NETWORK_ERR when not all answers arrived in time,
+ *         or another error
+ */
+ldns_status ldns_tcp_pool_send_many(ldns_tcp_pool *pool,
+		const ldns_rdf *ns, uint16_t port, const ldns_rdf *source,
+		const uint8_t * const *queries, const size_t *query_lens,
+		size_t n, struct timeval timeout,
+		uint8_t **answers, size_t *answer_sizes);
+
+/**
+ * Gets the counters of a pool
+ * \param[in] pool the pool
+ * \param[out] stats where to store the counters
+ */
+void ldns_tcp_pool_get_stats(const ldns_tcp_pool *pool,
+		ldns_tcp_pool_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_TCP_POOL_H */
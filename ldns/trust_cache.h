@@ -0,0 +1,129 @@
+/*
+ * trust_cache.h -- cache of validated DNSKEY and DS RRsets
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file trust_cache.h
+ *
+ * A cache of the DNSKEY and DS RRsets that were validated while building
+ * a chain of trust, per zone, so that validating many RRsets signed by
+ * the same zones does not fetch and validate the whole chain from the
+ * trust anchors down again for each of them.
+ *
+ * An RRset is kept for the smallest TTL of its RRs, but no longer than
+ * LDNS_TRUST_CACHE_MAX_TTL, and no longer than the signatures over it are
+ * valid.  It is only used for validations at times in between the
+ * inception of these signatures and the time it expires.
+ *
+ * The cache takes no notice of which trust anchors the RRsets were
+ * validated from, so a cache should only be used with one set of trust
+ * anchors.  Give it to ldns_fetch_valid_domain_keys_cached() and
+ * ldns_verify_trusted_cached().  Validations in different threads can
+ * share a cache when ldns is built with pthreads.
+ */
+
+#ifndef LDNS_TRUST_CACHE_H
+#define LDNS_TRUST_CACHE_H
+
+#include <time.h>
+
+#include <ldns/common.h>
+#include <ldns/error.h>
+#include <ldns/rr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Longest time a validated RRset is kept, in seconds */
+#define LDNS_TRUST_CACHE_MAX_TTL	86400
+
+/**
+ * Cache of validated DNSKEY and DS RRsets
+ */
+typedef struct ldns_struct_trust_cache ldns_trust_cache;
+
+/**
+ * Counters of a trust cache
+ */
+struct ldns_struct_trust_cache_stats
+{
+	/** Lookups answered from the cache */
+	size_t hits;
+	/** Lookups of RRsets not in the cache */
+	size_t misses;
+	/** RRsets stored */
+	size_t stores;
+	/** RRsets dropped because their TTL or signatures ran out */
+	size_t expired;
+	/** RRsets in the cache */
+	size_t entries;
+};
+typedef struct ldns_struct_trust_cache_stats ldns_trust_cache_stats;
+
+/**
+ * Creates a new, empty, trust cache
+ * \return the cache, or NULL on memory error
+ */
+ldns_trust_cache *ldns_trust_cache_new(void);
+
+/**
+ * Frees a trust cache and the RRsets in it
+ * \param[in] tc the cache to free
+ */
+void ldns_trust_cache_free(ldns_trust_cache *tc);
+
+/**
+ * Drops all RRsets from a trust cache
+ * \param[in] tc the cache
+ */
+void ldns_trust_cache_flush(ldns_trust_cache *tc);
+
+/**
+ * Looks up the validated DNSKEY or DS RRset of a zone
+ * \param[in] tc the cache
+ * \param[in] zone the owner name of the RRset
+ * \param[in] type LDNS_RR_TYPE_DNSKEY or LDNS_RR_TYPE_DS
+ * \param[in] check_time the time for which the validation is performed
+ * \return a copy of the RRset, to be freed by the caller, or NULL when it
+ *         is not in the cache or not valid at check_time
+ */
+ldns_rr_list *ldns_trust_cache_lookup(ldns_trust_cache *tc,
+		const ldns_rdf *zone, ldns_rr_type type, time_t check_time);
+
+/**
+ * Stores a validated DNSKEY or DS RRset, replacing an earlier one with
+ * the same owner and type.  The cache does not check the signatures: only
+ * give RRsets that were validated at check_time.
+ * \param[in] tc the cache
+ * \param[in] zone the owner name of the RRset
+ * \param[in] type LDNS_RR_TYPE_DNSKEY or LDNS_RR_TYPE_DS
+ * \param[in] rrset the RRset
+ * \param[in] rrsigs the signatures over the RRset
+ * \param[in] check_time the time for which the RRset was validated
+ * \return LDNS_STATUS_OK when the RRset was stored, LDNS_STATUS_ERR when
+ *         it can not be cached, or LDNS_STATUS_MEM_ERR on memory error
+ */
+ldns_status ldns_trust_cache_store(ldns_trust_cache *tc,
+		const ldns_rdf *zone, ldns_rr_type type,
+		const ldns_rr_list *rrset, const ldns_rr_list *rrsigs,
+		time_t check_time);
+
+/**
+ * Gets the counters of a trust cache
+ * \param[in] tc the cache
+ * \param[out] stats where to store the counters
+ */
+void ldns_trust_cache_get_stats(ldns_trust_cache *tc,
+		ldns_trust_cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_TRUST_CACHE_H */
@@ -0,0 +1,141 @@
+/*
+ * udp_pool.h -- pool of UDP sockets for a resolver
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+/**
+ * \file udp_pool.h
+ *
+ * A pool of UDP sockets that are opened once and then used for query
+ * after query, instead of opening and closing a socket for every query.
+ * Each socket is bound to a random source port.  A socket is closed and
+ * replaced by one on a new random port after it has been used for a
+ * number of queries, so that the source ports keep changing and remain
+ * hard to guess.  A socket on which a query timed out, and on which the
+ * answer may still arrive, is replaced as well.
+ *
+ * Give a resolver a pool with ldns_resolver_set_udp_pool() and its UDP
+ * queries are sent from the sockets of the pool.  The sockets for an
+ * address family are opened when that family is first needed.
+ *
+ * A pool must be used by one thread at a time, and must not be shared
+ * between processes after fork().
+ */
+
+#ifndef LDNS_UDP_POOL_H
+#define LDNS_UDP_POOL_H
+
+#include <ldns/common.h>
+#include <ldns/rdata.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default number of sockets per address family */
+#define LDNS_UDP_POOL_DEFAULT_SOCKETS 8
+
+/** Default number of queries after which a socket is replaced */
+#define LDNS_UDP_POOL_DEFAULT_ROTATE 100
+
+/**
+ * Pool of UDP sockets
+ */
+typedef struct ldns_struct_udp_pool ldns_udp_pool;
+
+/**
+ * Counters of a pool
+ */
+struct ldns_struct_udp_pool_stats
+{
+	/** Sockets opened */
+	size_t opened;
+	/** Queries sent from a socket that was used before */
+	size_t reused;
+	/** Sockets replaced because they were used for enough queries */
+	size_t rotated;
+	/** Sockets replaced after a timeout or error */
+	size_t discarded;
+	/** Queries sent from a socket of their own, because all sockets
+	 *  of the pool were in use */
+	size_t overflow;
+};
+typedef struct ldns_struct_udp_pool_stats ldns_udp_pool_stats;
+
+/**
+ * Creates a new pool.  No sockets are opened yet.
+ * \param[in] sockets the number of sockets per address family, or 0
+ *            for LDNS_UDP_POOL_DEFAULT_SOCKETS
+ * \return the pool, or NULL on memory error
+ */
+ldns_udp_pool *ldns_udp_pool_new(size_t sockets);
+
+/**
+ * Closes the sockets of a pool and frees it.
+ * \param[in] pool the pool to free
+ */
+void ldns_udp_pool_free(ldns_udp_pool *pool);
+
+/**
+ * Returns the number of sockets per address family of a pool
+ * \param[in] pool the pool
+ * \return the number of sockets
+ */
+size_t ldns_udp_pool_size(const ldns_udp_pool *pool);
+
+/**
+ * Returns after how many queries a socket is replaced
+ * \param[in] pool the pool
+ * \return the number of queries
+ */
+size_t ldns_udp_pool_rotate(const ldns_udp_pool *pool);
+
+/**
+ * Sets after how many queries a socket is replaced by one on a new
+ * random port.
+ * \param[in] pool the pool
+ * \param[in] queries the number of queries, or 0 to never replace
+ *            sockets that are still good
+ */
+void ldns_udp_pool_set_rotate(ldns_udp_pool *pool, size_t queries);
+
+/**
+ * Hands out a socket to send queries of an address family from.  The
+ * socket is not connected, and is nonblocking.  Datagrams that were
+ * still waiting on the socket are discarded.
+ * \param[in] pool the pool
+ * \param[in] family AF_INET or AF_INET6
+ * \param[in] source the address to send from (of type A or AAAA), or
+ *            NULL for any address.  When it differs from the address
+ *            the sockets of the family were bound to, they are replaced.
+ * \return the socket, or -1 on error
+ */
+int ldns_udp_pool_get(ldns_udp_pool *pool, int family,
+		const ldns_rdf *source);
+
+/**
+ * Gives a socket back to the pool after its query is done.
+ * \param[in] pool the pool
+ * \param[in] sockfd the socket, as returned by ldns_udp_pool_get()
+ * \param[in] reuse true when the answer was received and the socket can
+ *            be used again, false when it must be replaced
+ */
+void ldns_udp_pool_release(ldns_udp_pool *pool, int sockfd, bool reuse);
+
+/**
+ * Gets the counters of a pool
+ * \param[in] pool the pool
+ * \param[out] stats where to store the counters
+ */
+void ldns_udp_pool_get_stats(const ldns_udp_pool *pool,
+		ldns_udp_pool_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LDNS_UDP_POOL_H */
@@ -125,6 +125,31 @@ extern "C" {
  */
 ldns_status ldns_wire2pkt(ldns_pkt **packet, const uint8_t *data, size_t len);
 
+/**
+ * Checks the structure of a packet in wire format in one pass, without
+ * allocating memory: the counts against the size, the names and their
+ * compression pointers, the rdata lengths and the rdata fields of each
+ * RR type.  ldns_wire2pkt() runs it first, so it does not allocate for
+ * packets it can not read.
+ *
+ * Without strict, exactly the packets ldns_wire2pkt() rejects are
+ * rejected, with the same status.  With strict, these are rejected too:
+ * counts that can not fit in the size of the packet, rdata that is not
+ * exactly the fields of its type (except empty rdata, as in dynamic
+ * updates), and data after the last RR.
+ *
+ * \param[in] wire the packet
+ * \param[in] max the length of the packet
+ * \param[in] strict whether to do the stricter checks
+ * \return LDNS_STATUS_OK, LDNS_STATUS_WIRE_INCOMPLETE_HEADER or one of
+ *         the other LDNS_STATUS_WIRE_INCOMPLETE_* values for the section
+ *         that goes past the end of the packet, an error for a name
+ *         (LDNS_STATUS_INVALID_POINTER, LDNS_STATUS_LABEL_OVERFLOW,
+ *         LDNS_STATUS_DOMAINNAME_OVERFLOW), LDNS_STATUS_WIRE_RDATA_ERR
+ *         or LDNS_STATUS_WIRE_TRAILING_DATA
+ */
+ldns_status ldns_wire_validate(const uint8_t *wire, size_t max, bool strict);
+
 /**
  * converts the data in the ldns_buffer (in wire format) to a DNS packet.
  * This function will initialize and allocate memory space for the packet 
@@ -151,6 +176,64 @@ ldns_status ldns_buffer2pkt_wire(ldns_pkt **packet, const ldns_buffer *buffer);
  */
 ldns_status ldns_wire2dname(ldns_rdf **dname, const uint8_t *wire, size_t max, size_t *pos);
 
+/**
+ * Decompresses a name in wire format into a buffer of the caller, without
+ * allocating memory, with the same checks and errors as ldns_wire2dname().
+ * Compression pointer loops are found by the positions followed before,
+ * instead of by counting pointers up to LDNS_MAX_POINTERS.
+ *
+ * \param[out] buf where to put the name, LDNS_MAX_DOMAINLEN bytes, or NULL
+ *            to only check the name and skip over it
+ * \param[out] len the length of the name, may be NULL
+ * \param[in] wire pointer to the buffer with the data
+ * \param[in] max the length of the data buffer (in bytes)
+ * \param[in,out] pos the position of the name in the buffer, set to the
+ *            position after it
+ * \return LDNS_STATUS_OK if everything succeeds, error otherwise
+ */
+ldns_status ldns_wire2dname_buf(uint8_t *buf, size_t *len,
+		const uint8_t *wire, size_t max, size_t *pos);
+
+/**
+ * Memory for names decoded from one message, freed all at once
+ */
+typedef struct ldns_struct_dname_arena ldns_dname_arena;
+
+/**
+ * Creates an arena for names
+ * \return the arena, or NULL on memory error
+ */
+ldns_dname_arena *ldns_dname_arena_new(void);
+
+/**
+ * Frees all names in an arena, to use it for the next message
+ * \param[in] arena the arena
+ */
+void ldns_dname_arena_clear(ldns_dname_arena *arena);
+
+/**
+ * Frees an arena and all names in it
+ * \param[in] arena the arena
+ */
+void ldns_dname_arena_free(ldns_dname_arena *arena);
+
+/**
+ * Like ldns_wire2dname(), but makes the rdf in an arena instead of
+ * allocating it.  It is valid until the arena is cleared or freed, and
+ * must not be freed itself, nor be given to functions that take it over,
+ * like ldns_rr_set_owner().  Copy it with ldns_rdf_clone() for that.
+ *
+ * \param[out] dname the rdf, in the arena
+ * \param[in] arena the arena
+ * \param[in] wire pointer to the buffer with the data
+ * \param[in] max the length of the data buffer (in bytes)
+ * \param[in,out] pos the position of the name in the buffer, set to the
+ *            position after it
+ * \return LDNS_STATUS_OK if everything succeeds, error otherwise
+ */
+ldns_status ldns_wire2dname_arena(ldns_rdf **dname, ldns_dname_arena *arena,
+		const uint8_t *wire, size_t max, size_t *pos);
+
 /**
  * converts the data on the uint8_t bytearray (in wire format) to DNS 
  * rdata fields, and adds them to the list of rdfs of the given rr.
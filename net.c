@@ -33,6 +33,9 @@
 #ifdef HAVE_POLL
 #include <poll.h>
 #endif
+#if defined(HAVE_SENDMMSG) || defined(HAVE_RECVMMSG)
+#include <sys/uio.h>
+#endif
 
 ldns_status
 ldns_send(ldns_pkt **result_packet, ldns_resolver *r, const ldns_pkt *query_pkt)
@@ -41,7 +44,7 @@ ldns_send(ldns_pkt **result_packet, ldns_resolver *r, const ldns_pkt *query_pkt)
 	ldns_status result;
 	ldns_rdf *tsig_mac = NULL;
 
-	qb = ldns_buffer_new(LDNS_MIN_BUFLEN);
+	qb = ldns_buffer_acquire(LDNS_MIN_BUFLEN);
 
 	if (query_pkt && ldns_pkt_tsig(query_pkt)) {
 		tsig_mac = ldns_rr_rdf(ldns_pkt_tsig(query_pkt), 3);
@@ -54,7 +57,7 @@ ldns_send(ldns_pkt **result_packet, ldns_resolver *r, const ldns_pkt *query_pkt)
         	result = ldns_send_buffer(result_packet, r, qb, tsig_mac);
 	}
 
-	ldns_buffer_free(qb);
+	ldns_buffer_release(qb);
 
 	return result;
 }
@@ -488,6 +491,565 @@ ldns_udp_send(uint8_t **result, ldns_buffer *qbin,
 			timeout, answer_size);
 }
 
+static bool
+ldns_sockaddr_storage_equal(const struct sockaddr_storage *a,
+		const struct sockaddr_storage *b)
+{
+	if (a->ss_family != b->ss_family) {
+		return false;
+	}
+	if (a->ss_family == AF_INET) {
+		return ((const struct sockaddr_in *)a)->sin_port ==
+		       ((const struct sockaddr_in *)b)->sin_port
+		    && memcmp(&((const struct sockaddr_in *)a)->sin_addr,
+		              &((const struct sockaddr_in *)b)->sin_addr,
+		              sizeof(struct in_addr)) == 0;
+	}
+	if (a->ss_family == AF_INET6) {
+		return ((const struct sockaddr_in6 *)a)->sin6_port ==
+		       ((const struct sockaddr_in6 *)b)->sin6_port
+		    && memcmp(&((const struct sockaddr_in6 *)a)->sin6_addr,
+		              &((const struct sockaddr_in6 *)b)->sin6_addr,
+		              sizeof(struct in6_addr)) == 0;
+	}
+	return false;
+}
+
+/* Like ldns_udp_send_from(), from a socket of the pool.  Since the socket
+ * is used again, only an answer from the nameserver with the ID of the
+ * query is taken; anything else is skipped.
+ */
+static ldns_status
+ldns_udp_send_pool(uint8_t **result, ldns_buffer *qbin, ldns_udp_pool *pool,
+		const ldns_rdf *source,
+		const struct sockaddr_storage *to, socklen_t tolen,
+		struct timeval timeout, size_t *answer_size)
+{
+	struct sockaddr_storage from;
+	socklen_t fromlen;
+	struct timeval end, now, wait;
+	uint8_t *answer;
+	int sockfd;
+
+	sockfd = ldns_udp_pool_get(pool, (int)to->ss_family, source);
+	if (sockfd == -1) {
+		return LDNS_STATUS_SOCKET_ERROR;
+	}
+	if (ldns_udp_send_query(qbin, sockfd, to, tolen) == 0) {
+		ldns_udp_pool_release(pool, sockfd, false);
+		return LDNS_STATUS_SOCKET_ERROR;
+	}
+	gettimeofday(&end, NULL);
+	end.tv_sec += timeout.tv_sec;
+	end.tv_usec += timeout.tv_usec;
+	while (end.tv_usec >= 1000000) {
+		end.tv_usec -= 1000000;
+		end.tv_sec++;
+	}
+	for (;;) {
+		gettimeofday(&now, NULL);
+		wait.tv_sec = end.tv_sec - now.tv_sec;
+		wait.tv_usec = end.tv_usec - now.tv_usec;
+		if (wait.tv_usec < 0) {
+			wait.tv_usec += 1000000;
+			wait.tv_sec--;
+		}
+		if (wait.tv_sec < 0 || !ldns_sock_wait(sockfd, wait, 0)) {
+			/* the answer may still come, do not use it again */
+			ldns_udp_pool_release(pool, sockfd, false);
+			return LDNS_STATUS_NETWORK_ERR;
+		}
+		fromlen = (socklen_t)sizeof(from);
+		answer = ldns_udp_read_wire(sockfd, answer_size,
+				&from, &fromlen);
+		if (!answer) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK
+			||  errno == EINTR) {
+				continue;
+			}
+			ldns_udp_pool_release(pool, sockfd, false);
+			return LDNS_STATUS_NETWORK_ERR;
+		}
+		if (*answer_size >= LDNS_HEADER_SIZE
+		&&  ldns_sockaddr_storage_equal(&from, to)
+		&&  LDNS_ID_WIRE(answer) == LDNS_ID_WIRE(
+				ldns_buffer_begin(qbin))) {
+			break;
+		}
+		LDNS_FREE(answer);
+	}
+	ldns_udp_pool_release(pool, sockfd, true);
+	*result = answer;
+	return LDNS_STATUS_OK;
+}
+
+/* A nameserver in a race */
+typedef struct ldns_race_ns {
+	size_t			 pos;	/* in the nameserver list */
+	struct sockaddr_storage	*addr;
+	size_t			 addr_len;
+	int			 fd;	/* -1 when not (or no longer) racing */
+	uint8_t			 tries;	/* sends left */
+	long			 sent;	/* ms after the start of the race */
+	long			 deadline;
+	long			 wait;	/* ms, for an answer to a send */
+	struct timeval		 tv_sent;
+} ldns_race_ns;
+
+static long
+ldns_race_elapsed(const struct timeval *start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return (long)(now.tv_sec - start->tv_sec) * 1000
+	     + (long)(now.tv_usec - start->tv_usec) / 1000;
+}
+
+/* Milliseconds to wait for the nameserver at pos before the one at
+ * next, after the faster of the two.
+ */
+static long
+ldns_race_delay(const ldns_resolver *r, size_t pos, size_t next)
+{
+	size_t rtt = ldns_resolver_nameserver_rtt(r, pos);
+	size_t rtt_next = ldns_resolver_nameserver_rtt(r, next);
+
+	if (rtt_next > LDNS_RESOLV_RTT_MIN
+	&&  (rtt <= LDNS_RESOLV_RTT_MIN || rtt_next < rtt)) {
+		rtt = rtt_next;
+	}
+
+	if (rtt <= LDNS_RESOLV_RTT_MIN || rtt >= LDNS_RESOLV_RACE_DELAY / 2) {
+		return LDNS_RESOLV_RACE_DELAY;
+	}
+	if (rtt * 2 < LDNS_RESOLV_RACE_DELAY_MIN) {
+		return LDNS_RESOLV_RACE_DELAY_MIN;
+	}
+	return (long)rtt * 2;
+}
+
+/* Sort key of a nameserver; measured ones go before the others */
+static size_t
+ldns_race_rtt(const ldns_resolver *r, size_t pos)
+{
+	size_t rtt = ldns_resolver_nameserver_rtt(r, pos);
+
+	return rtt == LDNS_RESOLV_RTT_MIN ? (size_t)-1 : rtt;
+}
+
+/* Puts the nameservers in the order to race them: by round trip time,
+ * alternating between address families.
+ */
+static void
+ldns_race_order(const ldns_resolver *r, ldns_race_ns *ns, size_t n)
+{
+	ldns_race_ns tmp;
+	size_t i, j;
+	int family;
+
+	/* stable, to keep the order of ldns_resolver_nameservers_randomize,
+	 * and already done by ldns_resolver_nameservers_sort_rtt */
+	for (i = 1; i < n && !ldns_resolver_srtt(r); i++) {
+		tmp = ns[i];
+		for (j = i; j > 0 && ldns_race_rtt(r, ns[j - 1].pos)
+				> ldns_race_rtt(r, tmp.pos); j--) {
+			ns[j] = ns[j - 1];
+		}
+		ns[j] = tmp;
+	}
+	for (i = 1; i < n; i++) {
+		family = ns[i - 1].addr->ss_family;
+		if (ns[i].addr->ss_family != family) {
+			continue;
+		}
+		for (j = i + 1; j < n && ns[j].addr->ss_family == family; j++)
+			;
+		if (j < n) {
+			tmp = ns[j];
+			memmove(&ns[i + 1], &ns[i], (j - i) * sizeof(*ns));
+			ns[i] = tmp;
+		}
+	}
+}
+
+/* Ends the race for a nameserver */
+static void
+ldns_race_stop(ldns_resolver *r, ldns_race_ns *s, bool answered)
+{
+	if (s->fd == -1) {
+		return;
+	}
+	if (ldns_resolver_udp_pool(r)) {
+		ldns_udp_pool_release(ldns_resolver_udp_pool(r), s->fd,
+				answered);
+	} else {
+		close_socket(s->fd);
+	}
+	s->fd = -1;
+}
+
+static bool
+ldns_race_send(ldns_resolver *r, ldns_race_ns *s, ldns_buffer *qb,
+		const struct sockaddr_storage *src, size_t src_len)
+{
+	if (s->fd == -1) {
+		if (ldns_resolver_udp_pool(r)) {
+			s->fd = ldns_udp_pool_get(ldns_resolver_udp_pool(r),
+					(int)s->addr->ss_family,
+					ldns_resolver_source(r));
+			if (s->fd != -1 && ldns_udp_send_query(qb, s->fd,
+					s->addr, (socklen_t)s->addr_len) == 0) {
+				ldns_race_stop(r, s, false);
+			}
+		} else {
+			s->fd = ldns_udp_bgsend_from(qb,
+					s->addr, (socklen_t)s->addr_len,
+					src, (socklen_t)src_len,
+					ldns_resolver_timeout(r));
+			if (s->fd != -1) {
+				ldns_sock_nonblock(s->fd);
+			}
+		}
+		return s->fd != -1;
+	}
+	return ldns_udp_send_query(qb, s->fd,
+			s->addr, (socklen_t)s->addr_len) != 0;
+}
+
+/* Reads the datagrams waiting for a nameserver.  Returns the answer to
+ * the query, or NULL.
+ */
+static uint8_t *
+ldns_race_read(ldns_race_ns *s, ldns_buffer *qb, size_t *size)
+{
+	struct sockaddr_storage from;
+	socklen_t fromlen;
+	uint8_t *answer;
+
+	for (;;) {
+		fromlen = (socklen_t)sizeof(from);
+		if (!(answer = ldns_udp_read_wire(s->fd, size,
+				&from, &fromlen))) {
+			return NULL;
+		}
+		if (*size >= LDNS_HEADER_SIZE
+		&&  ldns_sockaddr_storage_equal(&from, s->addr)
+		&&  LDNS_ID_WIRE(answer) == LDNS_ID_WIRE(
+				ldns_buffer_begin(qb))) {
+			return answer;
+		}
+		LDNS_FREE(answer);
+	}
+}
+
+static int
+ldns_race_wait(ldns_race_ns *ns, size_t n, long ms, int *ready)
+{
+	size_t i;
+	int ret;
+#ifdef HAVE_POLL
+	struct pollfd *pfds;
+	size_t nfds = 0;
+
+	if (!(pfds = LDNS_XMALLOC(struct pollfd, n))) {
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if (ns[i].fd != -1) {
+			pfds[nfds].fd = ns[i].fd;
+			pfds[nfds].events = POLLIN;
+			pfds[nfds].revents = 0;
+			nfds++;
+		}
+	}
+	ret = poll(pfds, (nfds_t)nfds, (int)ms);
+	for (i = 0, nfds = 0; i < n; i++) {
+		ready[i] = 0;
+		if (ns[i].fd != -1) {
+			ready[i] = ret > 0 && pfds[nfds].revents != 0;
+			nfds++;
+		}
+	}
+	LDNS_FREE(pfds);
+#else
+	fd_set fds;
+	struct timeval tv;
+	int max = -1;
+
+	FD_ZERO(&fds);
+	for (i = 0; i < n; i++) {
+		if (ns[i].fd != -1) {
+			FD_SET(FD_SET_T ns[i].fd, &fds);
+			if (ns[i].fd > max) {
+				max = ns[i].fd;
+			}
+		}
+	}
+	tv.tv_sec = ms / 1000;
+	tv.tv_usec = (ms % 1000) * 1000;
+	ret = select(max + 1, &fds, NULL, NULL, &tv);
+	for (i = 0; i < n; i++) {
+		ready[i] = ret > 0 && ns[i].fd != -1
+		        && FD_ISSET(ns[i].fd, &fds);
+	}
+#endif
+	return ret;
+}
+
+/* Races the nameservers of the resolver, see ldns_resolver_set_race().
+ * On success, pos is set to the nameserver that answered, and tv_s to
+ * the time the query was first sent to it.
+ */
+static ldns_status
+ldns_send_race(uint8_t **reply_bytes, size_t *reply_size, uint8_t *pos,
+		struct timeval *tv_s, ldns_resolver *r, ldns_buffer *qb,
+		const struct sockaddr_storage *src, size_t src_len)
+{
+	ldns_race_ns *ns, *s;
+	int *ready = NULL;
+	size_t n = 0, started = 0, active = 0, i;
+	ldns_race_ns *fallback = NULL;
+	uint8_t *fallback_bytes = NULL, *answer;
+	size_t fallback_size = 0, size;
+	struct timeval start;
+	long t, next = 0, wait, timeout_ms;
+	struct timeval rto;
+	ldns_status status = LDNS_STATUS_RES_NO_NS;
+	uint8_t rcode;
+
+	*pos = 0;
+	timeout_ms = (long)ldns_resolver_timeout(r).tv_sec * 1000
+	           + (long)ldns_resolver_timeout(r).tv_usec / 1000;
+	if (!(ns = LDNS_XMALLOC(ldns_race_ns,
+			ldns_resolver_nameserver_count(r)))
+	||  !(ready = LDNS_XMALLOC(int, ldns_resolver_nameserver_count(r)))) {
+		LDNS_FREE(ns);
+		return LDNS_STATUS_MEM_ERR;
+	}
+	for (i = 0; i < ldns_resolver_nameserver_count(r); i++) {
+		if (ldns_resolver_nameserver_rtt(r, i) == LDNS_RESOLV_RTT_INF) {
+			continue;
+		}
+		s = &ns[n];
+		if (!(s->addr = ldns_rdf2native_sockaddr_storage(
+				ldns_resolver_nameservers(r)[i],
+				ldns_resolver_port(r), &s->addr_len))) {
+			continue;
+		}
+		if ((s->addr->ss_family == AF_INET &&
+		     ldns_resolver_ip6(r) == LDNS_RESOLV_INET6)
+		||  (s->addr->ss_family == AF_INET6 &&
+		     ldns_resolver_ip6(r) == LDNS_RESOLV_INET)) {
+			LDNS_FREE(s->addr);
+			continue;
+		}
+		s->pos = i;
+		s->fd = -1;
+		n++;
+	}
+	ldns_race_order(r, ns, n);
+
+	gettimeofday(&start, NULL);
+	for (;;) {
+		t = ldns_race_elapsed(&start);
+
+		/* the next nameserver joins when it is its turn, or when
+		 * all nameservers in the race are out */
+		while (started < n && (t >= next || active == 0)) {
+			s = &ns[started++];
+			if (!ldns_race_send(r, s, qb, src, src_len)) {
+				ldns_resolver_set_nameserver_rtt(r, s->pos,
+						LDNS_RESOLV_RTT_INF);
+				status = LDNS_STATUS_SOCKET_ERROR;
+				continue;
+			}
+			gettimeofday(&s->tv_sent, NULL);
+			s->sent = t;
+			s->wait = timeout_ms;
+			if (ldns_resolver_srtt(r)) {
+				rto = ldns_resolver_nameserver_rto(r, s->pos);
+				s->wait = (long)rto.tv_sec * 1000
+				        + (long)rto.tv_usec / 1000;
+			}
+			s->deadline = t + s->wait;
+			s->tries = ldns_resolver_retry(r) > 0
+			         ? ldns_resolver_retry(r) - 1 : 0;
+			next = t + ldns_race_delay(r, s->pos,
+					started < n ? ns[started].pos : s->pos);
+			active++;
+		}
+		for (i = 0; i < started; i++) {
+			s = &ns[i];
+			if (s->fd == -1 || t < s->deadline) {
+				continue;
+			}
+			if (s->tries > 0 && ldns_race_send(r, s, qb,
+					src, src_len)) {
+				s->tries--;
+				s->wait = s->wait * 2 < timeout_ms
+				        ? s->wait * 2 : timeout_ms;
+				s->deadline = t + s->wait;
+				continue;
+			}
+			/* the answer may still come, do not reuse */
+			ldns_race_stop(r, s, false);
+			if (ldns_resolver_srtt(r)) {
+				ldns_resolver_nameserver_rtt_backoff(r, s->pos);
+			} else {
+				ldns_resolver_set_nameserver_rtt(r, s->pos,
+						LDNS_RESOLV_RTT_INF);
+			}
+			status = LDNS_STATUS_NETWORK_ERR;
+			active--;
+		}
+		if (active == 0) {
+			if (started < n) {
+				continue;
+			}
+			break;
+		}
+
+		wait = started < n ? next - t : timeout_ms;
+		for (i = 0; i < started; i++) {
+			if (ns[i].fd != -1 && ns[i].deadline - t < wait) {
+				wait = ns[i].deadline - t;
+			}
+		}
+		if (ldns_race_wait(ns, started, wait < 0 ? 0 : wait, ready)
+				< 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			status = LDNS_STATUS_NETWORK_ERR;
+			break;
+		}
+		for (i = 0; i < started && !*reply_bytes; i++) {
+			s = &ns[i];
+			if (!ready[i] || s->fd == -1
+			||  !(answer = ldns_race_read(s, qb, &size))) {
+				continue;
+			}
+			ldns_race_stop(r, s, true);
+			active--;
+			t = ldns_race_elapsed(&start);
+			if (ldns_resolver_srtt(r)) {
+				/* only when it is clear which send was
+				 * answered */
+				if (s->tries + 1 == ldns_resolver_retry(r)) {
+					ldns_resolver_nameserver_rtt_update(r,
+						s->pos, (size_t)(t - s->sent));
+				}
+			} else {
+				/* above LDNS_RESOLV_RTT_MIN, which is not
+				 * measured */
+				ldns_resolver_set_nameserver_rtt(r, s->pos,
+						t - s->sent > LDNS_RESOLV_RTT_MIN
+						? (size_t)(t - s->sent)
+						: LDNS_RESOLV_RTT_MIN + 1);
+			}
+			rcode = LDNS_RCODE_WIRE(answer);
+			if (rcode == LDNS_RCODE_SERVFAIL
+			||  rcode == LDNS_RCODE_REFUSED
+			||  rcode == LDNS_RCODE_NOTIMPL) {
+				/* keep it in case no other answer comes */
+				if (!fallback) {
+					fallback = s;
+					fallback_bytes = answer;
+					fallback_size = size;
+				} else {
+					LDNS_FREE(answer);
+				}
+				continue;
+			}
+			*reply_bytes = answer;
+			*reply_size = size;
+			*pos = (uint8_t)s->pos;
+			*tv_s = s->tv_sent;
+		}
+		if (*reply_bytes) {
+			break;
+		}
+	}
+	if (*reply_bytes) {
+		LDNS_FREE(fallback_bytes);
+		status = LDNS_STATUS_OK;
+	} else if (fallback) {
+		*reply_bytes = fallback_bytes;
+		*reply_size = fallback_size;
+		*pos = (uint8_t)fallback->pos;
+		*tv_s = fallback->tv_sent;
+		status = LDNS_STATUS_OK;
+	}
+	/* the others are left behind */
+	for (i = 0; i < n; i++) {
+		ldns_race_stop(r, &ns[i], false);
+		LDNS_FREE(ns[i].addr);
+	}
+	LDNS_FREE(ready);
+	LDNS_FREE(ns);
+	return status;
+}
+
+/* Whether the nameserver at pos is slower than the one after it, which
+ * happens when ldns_resolver_nameservers_sort_rtt() put it first to
+ * measure it again.
+ */
+static bool
+ldns_send_rtt_probe(const ldns_resolver *r, size_t pos)
+{
+	size_t rtt, next;
+
+	if (pos + 1 >= ldns_resolver_nameserver_count(r)) {
+		return false;
+	}
+	rtt = ldns_resolver_nameserver_rtt(r, pos);
+	next = ldns_resolver_nameserver_rtt(r, pos + 1);
+	if (rtt == LDNS_RESOLV_RTT_MIN) {
+		rtt = LDNS_RESOLV_RTT_UNKNOWN;
+	}
+	if (next == LDNS_RESOLV_RTT_MIN) {
+		next = LDNS_RESOLV_RTT_UNKNOWN;
+	}
+	return next != LDNS_RESOLV_RTT_INF && rtt > next;
+}
+
+/* Doubles the time to wait for the next try, up to the timeout of the
+ * resolver.
+ */
+static void
+ldns_send_backoff(const ldns_resolver *r, struct timeval *timeout)
+{
+	struct timeval max = ldns_resolver_timeout(r);
+
+	timeout->tv_sec *= 2;
+	timeout->tv_usec *= 2;
+	while (timeout->tv_usec >= 1000000) {
+		timeout->tv_usec -= 1000000;
+		timeout->tv_sec++;
+	}
+	if (timeout->tv_sec > max.tv_sec || (timeout->tv_sec == max.tv_sec
+			&& timeout->tv_usec > max.tv_usec)) {
+		*timeout = max;
+	}
+}
+
+/* Sets when and from where an answer was received */
+static void
+ldns_send_buffer_stamp(ldns_pkt *reply, const ldns_rdf *ns,
+		struct timeval tv_s, size_t reply_size)
+{
+	struct timeval tv_e;
+
+	gettimeofday(&tv_e, NULL);
+	ldns_pkt_set_querytime(reply, (uint32_t)
+		((tv_e.tv_sec - tv_s.tv_sec) * 1000) +
+		(tv_e.tv_usec - tv_s.tv_usec) / 1000);
+	ldns_pkt_set_answerfrom(reply, ldns_rdf_clone(ns));
+	ldns_pkt_set_timestamp(reply, tv_s);
+	ldns_pkt_set_size(reply, reply_size);
+}
+
 ldns_status
 ldns_send_buffer(ldns_pkt **result, ldns_resolver *r, ldns_buffer *qb, ldns_rdf *tsig_mac)
 {
@@ -498,13 +1060,13 @@ ldns_send_buffer(ldns_pkt **result, ldns_resolver *r, ldns_buffer *qb, ldns_rdf
 	struct sockaddr_storage *ns;
 	size_t ns_len;
 	struct timeval tv_s;
-	struct timeval tv_e;
+	struct timeval timeout;
 
 	ldns_rdf **ns_array;
 	size_t *rtt;
 	ldns_pkt *reply;
 	bool all_servers_rtt_inf;
-	uint8_t retries;
+	uint8_t retries, tries;
 
 	uint8_t *reply_bytes = NULL;
 	size_t reply_size = 0;
@@ -523,12 +1085,35 @@ ldns_send_buffer(ldns_pkt **result, ldns_resolver *r, ldns_buffer *qb, ldns_rdf
 	if (ldns_resolver_random(r)) {
 		ldns_resolver_nameservers_randomize(r);
 	}
+	if (ldns_resolver_srtt(r)) {
+		ldns_resolver_nameservers_sort_rtt(r);
+	}
 
 	if(ldns_resolver_source(r)) {
 		src = ldns_rdf2native_sockaddr_storage_port(
 				ldns_resolver_source(r), 0, &src_len);
 	}
 
+	if (ldns_resolver_race(r) && !ldns_resolver_usevc(r)
+	&&  ldns_resolver_nameserver_count(r) > 1) {
+		status = ldns_send_race(&reply_bytes, &reply_size, &i, &tv_s,
+				r, qb, src, src_len);
+		if (status != LDNS_STATUS_RES_NO_NS) {
+			all_servers_rtt_inf = false;
+		}
+		if (reply_bytes) {
+			status = ldns_wire2pkt(&reply, reply_bytes, reply_size);
+			if (status != LDNS_STATUS_OK) {
+				if(src) LDNS_FREE(src);
+				LDNS_FREE(reply_bytes);
+				return status;
+			}
+			ldns_send_buffer_stamp(reply, ns_array[i], tv_s,
+					reply_size);
+		}
+		goto sent;
+	}
+
 	/* loop through all defined nameservers */
 	for (i = 0; i < ldns_resolver_nameserver_count(r); i++) {
 		if (rtt[i] == LDNS_RESOLV_RTT_INF) {
@@ -566,37 +1151,73 @@ ldns_send_buffer(ldns_pkt **result, ldns_resolver *r, ldns_buffer *qb, ldns_rdf
 		gettimeofday(&tv_s, NULL);
 
 		send_status = LDNS_STATUS_ERR;
+		timeout = ldns_resolver_timeout(r);
+		tries = ldns_resolver_retry(r);
+		if (ldns_resolver_srtt(r)) {
+			timeout = ldns_resolver_nameserver_rto(r, i);
+			if (ldns_send_rtt_probe(r, i)) {
+				timeout = ldns_resolver_nameserver_rto(r, i + 1);
+				tries = 1;
+			}
+		}
 
 		/* reply_bytes implicitly handles our error */
 		if (ldns_resolver_usevc(r)) {
-			for (retries = ldns_resolver_retry(r); retries > 0; retries--) {
+			for (retries = tries; retries > 0; retries--) {
+				if (ldns_resolver_tcp_pool(r)) {
+					send_status = ldns_tcp_pool_send(
+						ldns_resolver_tcp_pool(r),
+						ns_array[i],
+						ldns_resolver_port(r),
+						ldns_resolver_source(r),
+						ldns_buffer_begin(qb),
+						ldns_buffer_position(qb),
+						timeout,
+						&reply_bytes, &reply_size);
+				} else
 				send_status = 
 					ldns_tcp_send_from(&reply_bytes, qb, 
 						ns, (socklen_t)ns_len,
 						src, (socklen_t)src_len,
-						ldns_resolver_timeout(r),
+						timeout,
 						&reply_size);
 				if (send_status == LDNS_STATUS_OK) {
 					break;
 				}
+				ldns_send_backoff(r, &timeout);
 			}
 		} else {
-			for (retries = ldns_resolver_retry(r); retries > 0; retries--) {
+			for (retries = tries; retries > 0; retries--) {
 				/* ldns_rdf_print(stdout, ns_array[i]); */
+				if (ldns_resolver_udp_pool(r)) {
+					send_status = ldns_udp_send_pool(
+						&reply_bytes, qb,
+						ldns_resolver_udp_pool(r),
+						ldns_resolver_source(r),
+						ns,  (socklen_t)ns_len,
+						timeout,
+						&reply_size);
+				} else
 				send_status = 
 					ldns_udp_send_from(&reply_bytes, qb,
 						ns,  (socklen_t)ns_len,
 						src, (socklen_t)src_len,
-						ldns_resolver_timeout(r),
+						timeout,
 						&reply_size);
 				if (send_status == LDNS_STATUS_OK) {
 					break;
 				}
+				ldns_send_backoff(r, &timeout);
 			}
 		}
 
 		if (send_status != LDNS_STATUS_OK) {
-			ldns_resolver_set_nameserver_rtt(r, i, LDNS_RESOLV_RTT_INF);
+			if (ldns_resolver_srtt(r)) {
+				ldns_resolver_nameserver_rtt_backoff(r, i);
+			} else {
+				ldns_resolver_set_nameserver_rtt(r, i,
+						LDNS_RESOLV_RTT_INF);
+			}
 			status = send_status;
 		}
 		
@@ -625,16 +1246,15 @@ ldns_send_buffer(ldns_pkt **result, ldns_resolver *r, ldns_buffer *qb, ldns_rdf
 		assert(reply);
 		
 		LDNS_FREE(ns);
-		gettimeofday(&tv_e, NULL);
 
 		if (reply) {
-			ldns_pkt_set_querytime(reply, (uint32_t)
-				((tv_e.tv_sec - tv_s.tv_sec) * 1000) +
-				(tv_e.tv_usec - tv_s.tv_usec) / 1000);
-			ldns_pkt_set_answerfrom(reply,
-					ldns_rdf_clone(ns_array[i]));
-			ldns_pkt_set_timestamp(reply, tv_s);
-			ldns_pkt_set_size(reply, reply_size);
+			ldns_send_buffer_stamp(reply, ns_array[i], tv_s,
+					reply_size);
+			/* only when it is clear which send was answered */
+			if (ldns_resolver_srtt(r) && retries == tries) {
+				ldns_resolver_nameserver_rtt_update(r, i,
+						ldns_pkt_querytime(reply));
+			}
 			break;
 		} else {
 			if (ldns_resolver_fail(r)) {
@@ -648,6 +1268,7 @@ ldns_send_buffer(ldns_pkt **result, ldns_resolver *r, ldns_buffer *qb, ldns_rdf
 		sleep((unsigned int) ldns_resolver_retrans(r));
 	}
 
+sent:
 	if(src) {
 		LDNS_FREE(src);
 	}
@@ -721,32 +1342,613 @@ uint8_t *
 ldns_udp_read_wire(int sockfd, size_t *size, struct sockaddr_storage *from,
 		socklen_t *fromlen)
 {
-	uint8_t *wire, *wireout;
+	ldns_buffer *buffer;
+	uint8_t *wireout;
 	ssize_t wire_size;
 
-	wire = LDNS_XMALLOC(uint8_t, LDNS_MAX_PACKETLEN);
-	if (!wire) {
-		*size = 0;
+	*size = 0;
+	buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
+	if (!buffer) {
 		return NULL;
 	}
 
-	wire_size = recvfrom(sockfd, (void*)wire, LDNS_MAX_PACKETLEN, 0, 
-			(struct sockaddr *)from, fromlen);
+	wire_size = recvfrom(sockfd, (void*)ldns_buffer_begin(buffer),
+			LDNS_MAX_PACKETLEN, 0, (struct sockaddr *)from, fromlen);
 
 	/* recvfrom can also return 0 */
 	if (wire_size == -1 || wire_size == 0) {
-		*size = 0;
-		LDNS_FREE(wire);
+		ldns_buffer_release(buffer);
 		return NULL;
 	}
 
-	*size = (size_t)wire_size;
-	wireout = LDNS_XREALLOC(wire, uint8_t, (size_t)wire_size);
-	if(!wireout) LDNS_FREE(wire);
+	/* only the message is copied out, the buffer is kept for the next */
+	wireout = LDNS_XMALLOC(uint8_t, (size_t)wire_size);
+	if (wireout) {
+		memcpy(wireout, ldns_buffer_begin(buffer), (size_t)wire_size);
+		*size = (size_t)wire_size;
+	}
+	ldns_buffer_release(buffer);
 
 	return wireout;
 }
 
+ldns_udp_msg *
+ldns_udp_msgs_new(size_t n, size_t size)
+{
+	ldns_udp_msg *msgs;
+	uint8_t *data;
+	size_t i;
+
+	if (n == 0 || n > ((size_t)-1) / (sizeof(ldns_udp_msg) + size)) {
+		return NULL;
+	}
+	/* the buffers follow the messages in the same allocation */
+	msgs = (ldns_udp_msg *)LDNS_XMALLOC(uint8_t,
+			n * (sizeof(ldns_udp_msg) + size));
+	if (!msgs) {
+		return NULL;
+	}
+	data = (uint8_t *)(msgs + n);
+	for (i = 0; i < n; i++) {
+		memset(&msgs[i], 0, sizeof(ldns_udp_msg));
+		msgs[i].data = data + i * size;
+		msgs[i].size = size;
+	}
+	return msgs;
+}
+
+void
+ldns_udp_msgs_free(ldns_udp_msg *msgs)
+{
+	LDNS_FREE(msgs);
+}
+
+#if defined(HAVE_SENDMMSG) || defined(HAVE_RECVMMSG)
+/* Messages handed to a single sendmmsg() or recvmmsg() call */
+#define LDNS_UDP_MMSG_MAX 64
+#endif
+
+ssize_t
+ldns_udp_send_batch(int sockfd, ldns_udp_msg *msgs, size_t n)
+{
+	size_t done = 0;
+#ifdef HAVE_SENDMMSG
+	struct mmsghdr hdrs[LDNS_UDP_MMSG_MAX];
+	struct iovec iovs[LDNS_UDP_MMSG_MAX];
+	size_t i, chunk;
+	int sent;
+
+	while (done < n) {
+		chunk = n - done;
+		if (chunk > LDNS_UDP_MMSG_MAX) {
+			chunk = LDNS_UDP_MMSG_MAX;
+		}
+		memset(hdrs, 0, chunk * sizeof(hdrs[0]));
+		for (i = 0; i < chunk; i++) {
+			iovs[i].iov_base = msgs[done + i].data;
+			iovs[i].iov_len = msgs[done + i].len;
+			hdrs[i].msg_hdr.msg_iov = &iovs[i];
+			hdrs[i].msg_hdr.msg_iovlen = 1;
+			if (msgs[done + i].addrlen) {
+				hdrs[i].msg_hdr.msg_name = &msgs[done + i].addr;
+				hdrs[i].msg_hdr.msg_namelen =
+					msgs[done + i].addrlen;
+			}
+		}
+		sent = sendmmsg(sockfd, hdrs, (unsigned int)chunk, 0);
+		if (sent <= 0) {
+			break;
+		}
+		done += (size_t)sent;
+		if ((size_t)sent < chunk) {
+			break;
+		}
+	}
+#else
+	for (; done < n; done++) {
+		if (sendto(sockfd, (void *)msgs[done].data, msgs[done].len, 0,
+				msgs[done].addrlen ?
+				(struct sockaddr *)&msgs[done].addr : NULL,
+				msgs[done].addrlen) == -1) {
+			break;
+		}
+	}
+#endif
+	return done == 0 && n > 0 ? -1 : (ssize_t)done;
+}
+
+ssize_t
+ldns_udp_recv_batch(int sockfd, ldns_udp_msg *msgs, size_t n)
+{
+	size_t done = 0;
+#ifdef HAVE_RECVMMSG
+	struct mmsghdr hdrs[LDNS_UDP_MMSG_MAX];
+	struct iovec iovs[LDNS_UDP_MMSG_MAX];
+	size_t i, chunk;
+	int got;
+
+	while (done < n) {
+		chunk = n - done;
+		if (chunk > LDNS_UDP_MMSG_MAX) {
+			chunk = LDNS_UDP_MMSG_MAX;
+		}
+		memset(hdrs, 0, chunk * sizeof(hdrs[0]));
+		for (i = 0; i < chunk; i++) {
+			iovs[i].iov_base = msgs[done + i].data;
+			iovs[i].iov_len = msgs[done + i].size;
+			hdrs[i].msg_hdr.msg_iov = &iovs[i];
+			hdrs[i].msg_hdr.msg_iovlen = 1;
+			hdrs[i].msg_hdr.msg_name = &msgs[done + i].addr;
+			hdrs[i].msg_hdr.msg_namelen =
+				(socklen_t)sizeof(msgs[done + i].addr);
+		}
+		/* wait for the first, and then take what is there */
+		got = recvmmsg(sockfd, hdrs, (unsigned int)chunk,
+				done == 0 ? MSG_WAITFORONE : MSG_DONTWAIT, NULL);
+		if (got <= 0) {
+			break;
+		}
+		for (i = 0; i < (size_t)got; i++) {
+			msgs[done + i].len = hdrs[i].msg_len;
+			msgs[done + i].addrlen = hdrs[i].msg_hdr.msg_namelen;
+		}
+		done += (size_t)got;
+		if ((size_t)got < chunk) {
+			break;
+		}
+	}
+#else
+	ssize_t len;
+	int flags = 0;
+
+#ifndef MSG_DONTWAIT
+	/* no way to take only what is there, so take one */
+	if (n > 1) {
+		n = 1;
+	}
+#endif
+	for (; done < n; done++) {
+		msgs[done].addrlen = (socklen_t)sizeof(msgs[done].addr);
+		len = recvfrom(sockfd, (void *)msgs[done].data,
+				msgs[done].size, flags,
+				(struct sockaddr *)&msgs[done].addr,
+				&msgs[done].addrlen);
+		if (len == -1) {
+			break;
+		}
+		msgs[done].len = (size_t)len;
+#ifdef MSG_DONTWAIT
+		flags = MSG_DONTWAIT;
+#endif
+	}
+#endif
+	return done == 0 && n > 0 ? -1 : (ssize_t)done;
+}
+
+/* Queries in flight, and datagrams per batch, for ldns_send_bulk().  A
+ * larger window overflows the receive buffer of a busy nameserver. */
+#define LDNS_BULK_WINDOW 64
+#define LDNS_BULK_BATCH 32
+
+/* The query with a message ID, for looking up the query of an answer */
+typedef struct ldns_bulk_id {
+	uint16_t id;
+	size_t i;
+} ldns_bulk_id;
+
+typedef struct ldns_bulk {
+	ldns_pkt * const *queries;
+	ldns_pkt **answers;
+	size_t n;
+	size_t answered;
+	/* the random message IDs of the queries, sorted on ID */
+	ldns_bulk_id *ids;
+	uint8_t **wires;
+	size_t *wire_lens;
+	struct timeval *sent;
+	ldns_udp_msg out[LDNS_BULK_BATCH];
+	ldns_udp_msg *in;
+} ldns_bulk;
+
+static bool
+ldns_bulk_question_matches(const ldns_pkt *query, const ldns_pkt *answer)
+{
+	ldns_rr *q, *a;
+
+	if (ldns_pkt_qdcount(query) != 1) {
+		return true;
+	}
+	if (ldns_pkt_qdcount(answer) != 1) {
+		return false;
+	}
+	q = ldns_rr_list_rr(ldns_pkt_question(query), 0);
+	a = ldns_rr_list_rr(ldns_pkt_question(answer), 0);
+	return ldns_rr_get_type(q) == ldns_rr_get_type(a)
+	    && ldns_rr_get_class(q) == ldns_rr_get_class(a)
+	    && ldns_dname_compare(ldns_rr_owner(q), ldns_rr_owner(a)) == 0;
+}
+
+static int
+ldns_bulk_id_cmp(const void *a, const void *b)
+{
+	const ldns_bulk_id *ia = a, *ib = b;
+
+	return (int)ia->id - (int)ib->id;
+}
+
+/* Gives every query a random message ID that no other query has */
+static void
+ldns_bulk_set_ids(ldns_bulk *b)
+{
+	uint8_t taken[65536 / 8];
+	uint16_t id;
+	size_t i;
+
+	memset(taken, 0, sizeof(taken));
+	for (i = 0; i < b->n; i++) {
+		/* from a random start to the next ID that is free, which
+		 * there is as there are at most 65536 queries */
+		for (id = ldns_get_random(); taken[id >> 3] & (1 << (id & 7));
+				id++)
+			;
+		taken[id >> 3] |= (uint8_t)(1 << (id & 7));
+		ldns_write_uint16(b->wires[i], id);
+		b->ids[i].id = id;
+		b->ids[i].i = i;
+	}
+	qsort(b->ids, b->n, sizeof(ldns_bulk_id), ldns_bulk_id_cmp);
+}
+
+/* Takes an answer, when it is one to a query that is not answered yet */
+static bool
+ldns_bulk_answer(ldns_bulk *b, const uint8_t *wire, size_t len,
+		const ldns_rdf *ns, const struct timeval *now)
+{
+	ldns_pkt *answer;
+	ldns_bulk_id key, *found;
+	size_t i;
+
+	if (len < LDNS_HEADER_SIZE || !LDNS_QR_WIRE(wire)) {
+		return false;
+	}
+	key.id = LDNS_ID_WIRE(wire);
+	found = bsearch(&key, b->ids, b->n, sizeof(ldns_bulk_id),
+			ldns_bulk_id_cmp);
+	if (!found || b->answers[found->i]) {
+		return false;
+	}
+	i = found->i;
+	if (ldns_wire2pkt(&answer, wire, len) != LDNS_STATUS_OK) {
+		return false;
+	}
+	if (!ldns_bulk_question_matches(b->queries[i], answer)) {
+		ldns_pkt_free(answer);
+		return false;
+	}
+	ldns_pkt_set_querytime(answer, (uint32_t)
+		((now->tv_sec - b->sent[i].tv_sec) * 1000) +
+		(now->tv_usec - b->sent[i].tv_usec) / 1000);
+	ldns_pkt_set_answerfrom(answer, ldns_rdf_clone(ns));
+	ldns_pkt_set_timestamp(answer, b->sent[i]);
+	ldns_pkt_set_size(answer, len);
+	b->answers[i] = answer;
+	b->answered++;
+	return true;
+}
+
+/* Takes the answers in the received datagrams */
+static size_t
+ldns_bulk_answers(ldns_bulk *b, size_t got, const ldns_rdf *ns)
+{
+	struct timeval now;
+	size_t j, matched = 0;
+
+	gettimeofday(&now, NULL);
+	for (j = 0; j < got; j++) {
+		if (ldns_bulk_answer(b, b->in[j].data, b->in[j].len,
+				ns, &now)) {
+			matched++;
+		}
+	}
+	return matched;
+}
+
+/* The time left until a query sent at sent times out, false when none */
+static bool
+ldns_bulk_time_left(const struct timeval *sent, const struct timeval *timeout,
+		const struct timeval *now, struct timeval *left)
+{
+	left->tv_sec = sent->tv_sec + timeout->tv_sec - now->tv_sec;
+	left->tv_usec = sent->tv_usec + timeout->tv_usec - now->tv_usec;
+	while (left->tv_usec < 0) {
+		left->tv_usec += 1000000;
+		left->tv_sec--;
+	}
+	while (left->tv_usec >= 1000000) {
+		left->tv_usec -= 1000000;
+		left->tv_sec++;
+	}
+	return left->tv_sec >= 0;
+}
+
+/* Sends the queries that are not answered yet to one nameserver, and
+ * collects answers until all are in.  A query that is not answered
+ * within the timeout of the resolver gives its place in the window to
+ * the next one, and is sent again with the next try.
+ */
+static ldns_status
+ldns_bulk_send_ns(ldns_bulk *b, ldns_resolver *r, const ldns_rdf *ns_rdf,
+		const struct sockaddr_storage *ns, socklen_t ns_len,
+		const struct sockaddr_storage *src, socklen_t src_len)
+{
+	struct timeval timeout = ldns_resolver_timeout(r);
+	struct timeval now, wait;
+	/* the queries in flight, in the order they were sent */
+	size_t flight[LDNS_BULK_WINDOW];
+	size_t next = 0, in_flight = 0, k, j;
+	ssize_t got;
+	int sockfd;
+
+	if ((sockfd = ldns_udp_connect2(ns, timeout)) == -1) {
+		return LDNS_STATUS_SOCKET_ERROR;
+	}
+	/* connected, so only the nameserver's answers are received */
+	if ((src && bind(sockfd, (const struct sockaddr *)src, src_len) == -1)
+	||  connect(sockfd, (const struct sockaddr *)ns, ns_len) == -1) {
+		close_socket(sockfd);
+		return LDNS_STATUS_SOCKET_ERROR;
+	}
+	ldns_sock_nonblock(sockfd);
+
+	for (;;) {
+		/* fill the window */
+		while (in_flight < LDNS_BULK_WINDOW && next < b->n) {
+			for (k = 0; k < LDNS_BULK_BATCH && next < b->n
+			         && in_flight + k < LDNS_BULK_WINDOW; next++) {
+				if (b->answers[next]) {
+					continue;
+				}
+				b->out[k].data = b->wires[next];
+				b->out[k].len = b->wire_lens[next];
+				b->out[k].addrlen = 0;
+				flight[in_flight + k++] = next;
+			}
+			if (k == 0) {
+				break;
+			}
+			gettimeofday(&now, NULL);
+			/* what is not sent times out, and is sent again
+			 * with the next try */
+			(void) ldns_udp_send_batch(sockfd, b->out, k);
+			for (; k > 0; k--) {
+				b->sent[flight[in_flight++]] = now;
+			}
+		}
+		if (in_flight == 0) {
+			break;
+		}
+		/* wait until the oldest query in flight times out */
+		gettimeofday(&now, NULL);
+		if (ldns_bulk_time_left(&b->sent[flight[0]], &timeout, &now,
+					&wait)
+		&&  ldns_sock_wait(sockfd, wait, 0)) {
+			got = ldns_udp_recv_batch(sockfd, b->in,
+					LDNS_BULK_BATCH);
+			if (got > 0) {
+				(void) ldns_bulk_answers(b, (size_t)got,
+						ns_rdf);
+			} else if (got == -1 && errno != EAGAIN
+			       && errno != EWOULDBLOCK && errno != EINTR) {
+				/* e.g. ECONNREFUSED, no use waiting */
+				break;
+			}
+		}
+		/* free the places of the answered and timed out queries */
+		gettimeofday(&now, NULL);
+		for (j = 0, k = 0; j < in_flight; j++) {
+			if (!b->answers[flight[j]]
+			&&  ldns_bulk_time_left(&b->sent[flight[j]], &timeout,
+					&now, &wait)) {
+				flight[k++] = flight[j];
+			}
+		}
+		in_flight = k;
+	}
+	close_socket(sockfd);
+	return LDNS_STATUS_OK;
+}
+
+/* Like ldns_bulk_send_ns(), pipelined over a TCP connection */
+static ldns_status
+ldns_bulk_send_ns_tcp(ldns_bulk *b, ldns_resolver *r, const ldns_rdf *ns_rdf,
+		ldns_tcp_pool *pool)
+{
+	const uint8_t **wires;
+	uint8_t **answers;
+	size_t *lens, *sizes, i, k = 0;
+	struct timeval now;
+	ldns_status status = LDNS_STATUS_MEM_ERR;
+
+	wires = LDNS_XMALLOC(const uint8_t *, b->n - b->answered);
+	answers = LDNS_XMALLOC(uint8_t *, b->n - b->answered);
+	lens = LDNS_XMALLOC(size_t, b->n - b->answered);
+	sizes = LDNS_XMALLOC(size_t, b->n - b->answered);
+	if (!wires || !answers || !lens || !sizes) {
+		goto done;
+	}
+	gettimeofday(&now, NULL);
+	for (i = 0; i < b->n; i++) {
+		if (!b->answers[i]) {
+			wires[k] = b->wires[i];
+			lens[k] = b->wire_lens[i];
+			b->sent[i] = now;
+			k++;
+		}
+	}
+	status = ldns_tcp_pool_send_many(pool, ns_rdf, ldns_resolver_port(r),
+			ldns_resolver_source(r), wires, lens, k,
+			ldns_resolver_timeout(r), answers, sizes);
+	gettimeofday(&now, NULL);
+	for (i = 0; i < k; i++) {
+		if (answers[i]) {
+			(void) ldns_bulk_answer(b, answers[i], sizes[i],
+					ns_rdf, &now);
+			LDNS_FREE(answers[i]);
+		}
+	}
+done:
+	LDNS_FREE(wires);
+	LDNS_FREE(answers);
+	LDNS_FREE(lens);
+	LDNS_FREE(sizes);
+	/* without a connection there is no use trying again */
+	return status == LDNS_STATUS_SOCKET_ERROR
+	    || status == LDNS_STATUS_MEM_ERR ? status : LDNS_STATUS_OK;
+}
+
+/* ldns_send_bulk() for at most 65536 queries, each with its own ID */
+static ldns_status
+ldns_send_bulk_ids(ldns_pkt **answers, ldns_resolver *r,
+		ldns_pkt * const *queries, size_t n)
+{
+	ldns_bulk b;
+	struct sockaddr_storage *src = NULL, *ns;
+	size_t src_len = 0, ns_len, i, *rtt, in_size = LDNS_MIN_BUFLEN;
+	ldns_rdf **ns_array;
+	ldns_tcp_pool *tcp = NULL;
+	bool all_servers_rtt_inf = true;
+	uint8_t retries;
+	ldns_status status = LDNS_STATUS_OK, s;
+
+	for (i = 0; i < n; i++) {
+		answers[i] = NULL;
+	}
+	memset(&b, 0, sizeof(b));
+	b.queries = queries;
+	b.answers = answers;
+	b.n = n;
+	b.ids = LDNS_XMALLOC(ldns_bulk_id, n);
+	b.wires = LDNS_CALLOC(uint8_t *, n);
+	b.wire_lens = LDNS_XMALLOC(size_t, n);
+	b.sent = LDNS_XMALLOC(struct timeval, n);
+	if (!b.ids || !b.wires || !b.wire_lens || !b.sent) {
+		status = LDNS_STATUS_MEM_ERR;
+		goto done;
+	}
+	for (i = 0; i < n; i++) {
+		status = ldns_pkt2wire(&b.wires[i], queries[i],
+				&b.wire_lens[i]);
+		if (status != LDNS_STATUS_OK) {
+			goto done;
+		}
+		if (ldns_pkt_edns_udp_size(queries[i]) > in_size) {
+			in_size = ldns_pkt_edns_udp_size(queries[i]);
+		}
+	}
+	ldns_bulk_set_ids(&b);
+	if (ldns_resolver_usevc(r)) {
+		if (!(tcp = ldns_resolver_tcp_pool(r))
+		&&  !(tcp = ldns_tcp_pool_new())) {
+			status = LDNS_STATUS_MEM_ERR;
+			goto done;
+		}
+	} else if (!(b.in = ldns_udp_msgs_new(LDNS_BULK_BATCH, in_size))) {
+		status = LDNS_STATUS_MEM_ERR;
+		goto done;
+	}
+	if (ldns_resolver_random(r)) {
+		ldns_resolver_nameservers_randomize(r);
+	}
+	if (ldns_resolver_srtt(r)) {
+		ldns_resolver_nameservers_sort_rtt(r);
+	}
+	if (ldns_resolver_source(r)) {
+		src = ldns_rdf2native_sockaddr_storage_port(
+				ldns_resolver_source(r), 0, &src_len);
+	}
+	rtt = ldns_resolver_rtt(r);
+	ns_array = ldns_resolver_nameservers(r);
+
+	for (i = 0; i < ldns_resolver_nameserver_count(r)
+	            && b.answered < n; i++) {
+		if (rtt[i] == LDNS_RESOLV_RTT_INF) {
+			continue;
+		}
+		ns = ldns_rdf2native_sockaddr_storage(ns_array[i],
+				ldns_resolver_port(r), &ns_len);
+		if (!ns) {
+			continue;
+		}
+		if ((ns->ss_family == AF_INET &&
+		     ldns_resolver_ip6(r) == LDNS_RESOLV_INET6)
+		||  (ns->ss_family == AF_INET6 &&
+		     ldns_resolver_ip6(r) == LDNS_RESOLV_INET)) {
+			/* not reachable */
+			LDNS_FREE(ns);
+			continue;
+		}
+		all_servers_rtt_inf = false;
+
+		for (retries = ldns_resolver_retry(r);
+		     retries > 0 && b.answered < n; retries--) {
+			if (tcp) {
+				s = ldns_bulk_send_ns_tcp(&b, r, ns_array[i],
+						tcp);
+			} else {
+				s = ldns_bulk_send_ns(&b, r, ns_array[i],
+						ns, (socklen_t)ns_len,
+						src, (socklen_t)src_len);
+			}
+			if (s != LDNS_STATUS_OK) {
+				break;
+			}
+		}
+		LDNS_FREE(ns);
+	}
+	if (all_servers_rtt_inf) {
+		status = LDNS_STATUS_RES_NO_NS;
+	} else if (b.answered < n) {
+		status = LDNS_STATUS_NETWORK_ERR;
+	}
+done:
+	for (i = 0; b.wires && i < n; i++) {
+		LDNS_FREE(b.wires[i]);
+	}
+	LDNS_FREE(b.wires);
+	LDNS_FREE(b.ids);
+	LDNS_FREE(b.wire_lens);
+	LDNS_FREE(b.sent);
+	ldns_udp_msgs_free(b.in);
+	if (tcp != ldns_resolver_tcp_pool(r)) {
+		ldns_tcp_pool_free(tcp);
+	}
+	LDNS_FREE(src);
+	return status;
+}
+
+ldns_status
+ldns_send_bulk(ldns_pkt **answers, ldns_resolver *r,
+		ldns_pkt * const *queries, size_t n)
+{
+	ldns_status status = LDNS_STATUS_OK, s;
+	size_t i, chunk;
+
+	if (!answers || !r || (n > 0 && !queries)) {
+		return LDNS_STATUS_NULL;
+	}
+	if (ldns_resolver_nameserver_count(r) == 0) {
+		return LDNS_STATUS_RES_NO_NS;
+	}
+	for (i = 0; i < n; i += chunk) {
+		chunk = n - i > 65536 ? 65536 : n - i;
+		s = ldns_send_bulk_ids(answers + i, r, queries + i, chunk);
+		if (status == LDNS_STATUS_OK) {
+			status = s;
+		}
+	}
+	return status;
+}
+
 uint8_t *
 ldns_tcp_read_wire_timeout(int sockfd, size_t *size, struct timeval timeout)
 {
@@ -806,6 +2008,24 @@ ldns_tcp_read_wire_timeout(int sockfd, size_t *size, struct timeval timeout)
 	return wire;
 }
 
+ldns_status
+ldns_tcp_read_msg_timeout(int sockfd, ldns_tcp_reader *reader,
+		struct timeval timeout, const uint8_t **msg, size_t *size)
+{
+	ldns_status status;
+
+	while (!ldns_tcp_reader_get(reader, msg, size)) {
+		if (!ldns_sock_wait(sockfd, timeout, 0)) {
+			return LDNS_STATUS_NETWORK_ERR;
+		}
+		status = ldns_tcp_reader_recv(reader, sockfd);
+		if (status != LDNS_STATUS_OK) {
+			return status;
+		}
+	}
+	return LDNS_STATUS_OK;
+}
+
 uint8_t *
 ldns_tcp_read_wire(int sockfd, size_t *size)
 {
@@ -1032,5 +2252,6 @@ ldns_axfr_start(ldns_resolver *resolver, const ldns_rdf *domain, ldns_rr_class c
          * The AXFR is done once the second SOA record is sent
          */
         resolver->_axfr_soa_count = 0;
+        ldns_tcp_reader_clear(&resolver->_axfr_reader);
         return LDNS_STATUS_OK;
 }
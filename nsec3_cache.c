@@ -0,0 +1,556 @@
+/*
+ * nsec3_cache.c
+ *
+ * persistent cache of NSEC3 hashed owner names
+ *
+ * a Net::DNS like library for C
+ *
+ * (c) NLnet Labs, 2024
+ *
+ * See the file LICENSE for the license
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+#include <errno.h>
+
+/*
+ * File layout, all integers in network byte order:
+ *
+ *	magic "LDNSN3HC"	8 bytes
+ *	version			1 byte
+ *	algorithm		1 byte
+ *	iterations		2 bytes
+ *	salt length		1 byte
+ *	salt			salt length bytes
+ *	nanoseconds per hash	4 bytes
+ *	entry count		4 bytes
+ *	entries			entry count times
+ *
+ * with every entry being
+ *
+ *	owner name length	1 byte
+ *	canonical owner name	owner name length bytes
+ *	hash			LDNS_NSEC3_CACHE_HASH_LEN bytes
+ *
+ * Entries are sorted on owner name, see ldns_nsec3_cache_cmp().
+ * In memory the entries have the same layout.
+ */
+#define LDNS_NSEC3_CACHE_MAGIC		"LDNSN3HC"
+#define LDNS_NSEC3_CACHE_MAGIC_LEN	8
+#define LDNS_NSEC3_CACHE_VERSION	1
+#define LDNS_NSEC3_CACHE_HASH_LEN	LDNS_SHA1_DIGEST_LENGTH
+#define LDNS_NSEC3_CACHE_INITIAL_ADDED	1024
+
+#define ENTRY_NAME_LEN(e)	((size_t)(e)[0])
+#define ENTRY_NAME(e)		((e) + 1)
+#define ENTRY_HASH(e)		((e) + 1 + ENTRY_NAME_LEN(e))
+#define ENTRY_SIZE(e)		(1 + ENTRY_NAME_LEN(e) + LDNS_NSEC3_CACHE_HASH_LEN)
+
+struct ldns_struct_nsec3_cache {
+	/** Whether the parameters below have been set */
+	bool have_params;
+	uint8_t algorithm;
+	uint16_t iterations;
+	uint8_t salt_length;
+	uint8_t salt[255];
+
+	/** The contents of the loaded cache file */
+	uint8_t *table;
+	/** Pointers to the entries in table, sorted on owner name */
+	uint8_t **loaded;
+	/** Per loaded entry, whether it was used since loading */
+	uint8_t *used;
+	size_t loaded_count;
+
+	/** Separately allocated entries, added since loading, unsorted */
+	uint8_t **added;
+	size_t added_count;
+	size_t added_capacity;
+
+	size_t hits;
+	size_t misses;
+	size_t invalidations;
+	/** Time spent on computing the misses */
+	uint64_t miss_usec;
+	/** Average hashing time recorded in the loaded file */
+	uint32_t loaded_nsec_per_hash;
+};
+
+ldns_nsec3_cache *
+ldns_nsec3_cache_new(void)
+{
+	ldns_nsec3_cache *cache = LDNS_MALLOC(ldns_nsec3_cache);
+
+	if (!cache) {
+		return NULL;
+	}
+	memset(cache, 0, sizeof(*cache));
+	return cache;
+}
+
+static void
+ldns_nsec3_cache_clear(ldns_nsec3_cache *cache)
+{
+	size_t i;
+
+	for (i = 0; i < cache->added_count; i++) {
+		LDNS_FREE(cache->added[i]);
+	}
+	LDNS_FREE(cache->added);
+	LDNS_FREE(cache->table);
+	LDNS_FREE(cache->loaded);
+	LDNS_FREE(cache->used);
+	cache->added = NULL;
+	cache->added_count = 0;
+	cache->added_capacity = 0;
+	cache->table = NULL;
+	cache->loaded = NULL;
+	cache->used = NULL;
+	cache->loaded_count = 0;
+	cache->loaded_nsec_per_hash = 0;
+}
+
+void
+ldns_nsec3_cache_free(ldns_nsec3_cache *cache)
+{
+	if (cache) {
+		ldns_nsec3_cache_clear(cache);
+		LDNS_FREE(cache);
+	}
+}
+
+static int
+ldns_nsec3_cache_cmp(const uint8_t *a, size_t a_len,
+		const uint8_t *b, size_t b_len)
+{
+	int c = memcmp(a, b, a_len < b_len ? a_len : b_len);
+
+	if (c) {
+		return c;
+	}
+	return a_len < b_len ? -1 : a_len > b_len ? 1 : 0;
+}
+
+static int
+ldns_nsec3_cache_entry_cmp(const void *a, const void *b)
+{
+	const uint8_t *ea = *(uint8_t * const *)a;
+	const uint8_t *eb = *(uint8_t * const *)b;
+
+	return ldns_nsec3_cache_cmp(ENTRY_NAME(ea), ENTRY_NAME_LEN(ea),
+			ENTRY_NAME(eb), ENTRY_NAME_LEN(eb));
+}
+
+static bool
+ldns_nsec3_cache_params_match(const ldns_nsec3_cache *cache,
+		uint8_t algorithm, uint16_t iterations,
+		uint8_t salt_length, const uint8_t *salt)
+{
+	return cache->have_params
+	    && cache->algorithm == algorithm
+	    && cache->iterations == iterations
+	    && cache->salt_length == salt_length
+	    && (salt_length == 0 || memcmp(cache->salt, salt, salt_length) == 0);
+}
+
+static void
+ldns_nsec3_cache_set_params(ldns_nsec3_cache *cache,
+		uint8_t algorithm, uint16_t iterations,
+		uint8_t salt_length, const uint8_t *salt)
+{
+	cache->have_params = true;
+	cache->algorithm = algorithm;
+	cache->iterations = iterations;
+	cache->salt_length = salt_length;
+	if (salt_length > 0) {
+		memcpy(cache->salt, salt, salt_length);
+	}
+}
+
+static ldns_status
+ldns_nsec3_cache_parse(ldns_nsec3_cache *cache, uint8_t *data, size_t size)
+{
+	size_t pos, i;
+	uint32_t count;
+	uint8_t salt_length;
+
+	if (size < LDNS_NSEC3_CACHE_MAGIC_LEN + 5
+	||  memcmp(data, LDNS_NSEC3_CACHE_MAGIC, LDNS_NSEC3_CACHE_MAGIC_LEN)
+	||  data[LDNS_NSEC3_CACHE_MAGIC_LEN] != LDNS_NSEC3_CACHE_VERSION
+	||  data[LDNS_NSEC3_CACHE_MAGIC_LEN + 1] != LDNS_SHA1) {
+		return LDNS_STATUS_FILE_ERR;
+	}
+	pos = LDNS_NSEC3_CACHE_MAGIC_LEN + 4;
+	salt_length = data[pos];
+	pos += 1;
+	if (size < pos + salt_length + 8) {
+		return LDNS_STATUS_FILE_ERR;
+	}
+	ldns_nsec3_cache_set_params(cache, LDNS_SHA1,
+			ldns_read_uint16(data + LDNS_NSEC3_CACHE_MAGIC_LEN + 2),
+			salt_length, data + pos);
+	pos += salt_length;
+	cache->loaded_nsec_per_hash = ldns_read_uint32(data + pos);
+	count = ldns_read_uint32(data + pos + 4);
+	pos += 8;
+
+	/* every entry takes at least two bytes plus the hash */
+	if (count > (size - pos) / (2 + LDNS_NSEC3_CACHE_HASH_LEN)) {
+		return LDNS_STATUS_FILE_ERR;
+	}
+	cache->loaded = LDNS_XMALLOC(uint8_t *, count ? count : 1);
+	cache->used = LDNS_XMALLOC(uint8_t, count ? count : 1);
+	if (!cache->loaded || !cache->used) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	memset(cache->used, 0, count);
+	for (i = 0; i < count; i++) {
+		if (pos >= size || data[pos] == 0
+		||  size - pos < ENTRY_SIZE(data + pos)) {
+			return LDNS_STATUS_FILE_ERR;
+		}
+		cache->loaded[i] = data + pos;
+		pos += ENTRY_SIZE(data + pos);
+
+		/* lookups rely on the order, so do not trust it blindly */
+		if (i > 0 && ldns_nsec3_cache_entry_cmp(
+				&cache->loaded[i - 1], &cache->loaded[i]) >= 0) {
+			return LDNS_STATUS_FILE_ERR;
+		}
+	}
+	if (pos != size) {
+		return LDNS_STATUS_FILE_ERR;
+	}
+	cache->loaded_count = count;
+	return LDNS_STATUS_OK;
+}
+
+ldns_status
+ldns_nsec3_cache_load(ldns_nsec3_cache *cache, const char *filename)
+{
+	FILE *fp;
+	long size;
+	uint8_t *data;
+	ldns_status status;
+
+	if (!cache || !filename) {
+		return LDNS_STATUS_NULL;
+	}
+	ldns_nsec3_cache_clear(cache);
+	cache->have_params = false;
+
+	fp = fopen(filename, "rb");
+	if (!fp) {
+		return errno == ENOENT ? LDNS_STATUS_OK : LDNS_STATUS_FILE_ERR;
+	}
+	if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0
+	||  fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		return LDNS_STATUS_FILE_ERR;
+	}
+	data = LDNS_XMALLOC(uint8_t, size ? (size_t)size : 1);
+	if (!data) {
+		fclose(fp);
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (fread(data, 1, (size_t)size, fp) != (size_t)size) {
+		LDNS_FREE(data);
+		fclose(fp);
+		return LDNS_STATUS_FILE_ERR;
+	}
+	fclose(fp);
+
+	cache->table = data;
+	status = ldns_nsec3_cache_parse(cache, data, (size_t)size);
+	if (status != LDNS_STATUS_OK) {
+		ldns_nsec3_cache_clear(cache);
+		cache->have_params = false;
+	}
+	return status;
+}
+
+static ldns_status
+ldns_nsec3_cache_write(const ldns_nsec3_cache *cache, FILE *fp,
+		uint8_t **entries, size_t count)
+{
+	uint8_t hdr[LDNS_NSEC3_CACHE_MAGIC_LEN + 5];
+	uint8_t buf[8];
+	uint64_t nsec_per_hash;
+	size_t i;
+
+	memcpy(hdr, LDNS_NSEC3_CACHE_MAGIC, LDNS_NSEC3_CACHE_MAGIC_LEN);
+	hdr[LDNS_NSEC3_CACHE_MAGIC_LEN] = LDNS_NSEC3_CACHE_VERSION;
+	hdr[LDNS_NSEC3_CACHE_MAGIC_LEN + 1] = cache->algorithm;
+	ldns_write_uint16(hdr + LDNS_NSEC3_CACHE_MAGIC_LEN + 2,
+			cache->iterations);
+	hdr[LDNS_NSEC3_CACHE_MAGIC_LEN + 4] = cache->salt_length;
+
+	if (cache->misses) {
+		nsec_per_hash = cache->miss_usec * 1000 / cache->misses;
+		if (nsec_per_hash > 0xFFFFFFFF) {
+			nsec_per_hash = 0xFFFFFFFF;
+		}
+	} else {
+		nsec_per_hash = cache->loaded_nsec_per_hash;
+	}
+	ldns_write_uint32(buf, (uint32_t)nsec_per_hash);
+	ldns_write_uint32(buf + 4, (uint32_t)count);
+
+	if (fwrite(hdr, sizeof(hdr), 1, fp) != 1
+	|| (cache->salt_length
+	    && fwrite(cache->salt, cache->salt_length, 1, fp) != 1)
+	||  fwrite(buf, sizeof(buf), 1, fp) != 1) {
+		return LDNS_STATUS_FILE_ERR;
+	}
+	for (i = 0; i < count; i++) {
+		if (fwrite(entries[i], ENTRY_SIZE(entries[i]), 1, fp) != 1) {
+			return LDNS_STATUS_FILE_ERR;
+		}
+	}
+	return LDNS_STATUS_OK;
+}
+
+ldns_status
+ldns_nsec3_cache_save(const ldns_nsec3_cache *cache, const char *filename)
+{
+	uint8_t **entries;
+	size_t count = 0, i, j;
+	char *tmpname;
+	size_t tmpname_len;
+	FILE *fp;
+	ldns_status status;
+
+	if (!cache || !filename) {
+		return LDNS_STATUS_NULL;
+	}
+	if (!cache->have_params) {
+		/* nothing was hashed, so there is nothing to store */
+		return LDNS_STATUS_OK;
+	}
+	entries = LDNS_XMALLOC(uint8_t *,
+			cache->loaded_count + cache->added_count + 1);
+	if (!entries) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	for (i = 0; i < cache->loaded_count; i++) {
+		if (cache->used[i]) {
+			entries[count++] = cache->loaded[i];
+		}
+	}
+	for (i = 0; i < cache->added_count; i++) {
+		entries[count++] = cache->added[i];
+	}
+	qsort(entries, count, sizeof(uint8_t *), ldns_nsec3_cache_entry_cmp);
+
+	/* a name hashed twice was added twice */
+	for (i = 0, j = 0; i < count; i++) {
+		if (j == 0 || ldns_nsec3_cache_entry_cmp(
+				&entries[j - 1], &entries[i]) != 0) {
+			entries[j++] = entries[i];
+		}
+	}
+	count = j;
+
+	tmpname_len = strlen(filename) + 5;
+	tmpname = LDNS_XMALLOC(char, tmpname_len);
+	if (!tmpname) {
+		LDNS_FREE(entries);
+		return LDNS_STATUS_MEM_ERR;
+	}
+	snprintf(tmpname, tmpname_len, "%s.tmp", filename);
+
+	fp = fopen(tmpname, "wb");
+	if (!fp) {
+		LDNS_FREE(tmpname);
+		LDNS_FREE(entries);
+		return LDNS_STATUS_FILE_ERR;
+	}
+	status = ldns_nsec3_cache_write(cache, fp, entries, count);
+	LDNS_FREE(entries);
+	if (fclose(fp) != 0 && status == LDNS_STATUS_OK) {
+		status = LDNS_STATUS_FILE_ERR;
+	}
+	if (status == LDNS_STATUS_OK && rename(tmpname, filename) != 0) {
+		status = LDNS_STATUS_FILE_ERR;
+	}
+	if (status != LDNS_STATUS_OK) {
+		(void) remove(tmpname);
+	}
+	LDNS_FREE(tmpname);
+	return status;
+}
+
+static const uint8_t *
+ldns_nsec3_cache_lookup(ldns_nsec3_cache *cache,
+		const uint8_t *name, size_t name_len)
+{
+	size_t lo = 0, hi = cache->loaded_count, mid;
+	const uint8_t *e;
+	int c;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		e = cache->loaded[mid];
+		c = ldns_nsec3_cache_cmp(name, name_len,
+				ENTRY_NAME(e), ENTRY_NAME_LEN(e));
+		if (c == 0) {
+			cache->used[mid] = 1;
+			return ENTRY_HASH(e);
+		} else if (c < 0) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return NULL;
+}
+
+static ldns_status
+ldns_nsec3_cache_add(ldns_nsec3_cache *cache,
+		const uint8_t *name, size_t name_len, const uint8_t *hash)
+{
+	uint8_t **added;
+	uint8_t *e;
+
+	if (cache->added_count == cache->added_capacity) {
+		size_t capacity = cache->added_capacity
+		                ? cache->added_capacity * 2
+		                : LDNS_NSEC3_CACHE_INITIAL_ADDED;
+
+		added = LDNS_XREALLOC(cache->added, uint8_t *, capacity);
+		if (!added) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		cache->added = added;
+		cache->added_capacity = capacity;
+	}
+	e = LDNS_XMALLOC(uint8_t, 1 + name_len + LDNS_NSEC3_CACHE_HASH_LEN);
+	if (!e) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	e[0] = (uint8_t)name_len;
+	memcpy(ENTRY_NAME(e), name, name_len);
+	memcpy(ENTRY_HASH(e), hash, LDNS_NSEC3_CACHE_HASH_LEN);
+	cache->added[cache->added_count++] = e;
+	return LDNS_STATUS_OK;
+}
+
+/* Returns the hashed owner label rdf, as ldns_nsec3_hash_name() does */
+static ldns_rdf *
+ldns_nsec3_cache_hash2rdf(const uint8_t *hash)
+{
+	uint8_t label[2 + 64];
+	int b32_len;
+
+	b32_len = ldns_b32_ntop_extended_hex(hash, LDNS_NSEC3_CACHE_HASH_LEN,
+			(char *)label + 1, sizeof(label) - 2);
+	if (b32_len < 1) {
+		return NULL;
+	}
+	label[0] = (uint8_t)b32_len;
+	label[1 + b32_len] = 0;
+	return ldns_rdf_new_frm_data(LDNS_RDF_TYPE_DNAME,
+			(size_t)b32_len + 2, label);
+}
+
+ldns_rdf *
+ldns_nsec3_cache_hash_name(ldns_nsec3_cache *cache, const ldns_rdf *name,
+		uint8_t algorithm, uint16_t iterations,
+		uint8_t salt_length, const uint8_t *salt)
+{
+	uint8_t cann[LDNS_MAX_DOMAINLEN + 1];
+	uint8_t hash[LDNS_NSEC3_CACHE_HASH_LEN];
+	const uint8_t *cached;
+	size_t cann_len, i;
+	ldns_rdf *hashed;
+	struct timeval start, end;
+
+	if (!cache || algorithm != LDNS_SHA1 || !name
+	||  ldns_rdf_get_type(name) != LDNS_RDF_TYPE_DNAME
+	||  ldns_rdf_size(name) > sizeof(cann)) {
+		return ldns_nsec3_hash_name(name, algorithm, iterations,
+				salt_length, salt);
+	}
+	if (!ldns_nsec3_cache_params_match(cache, algorithm, iterations,
+				salt_length, salt)) {
+		if (cache->have_params) {
+			ldns_nsec3_cache_clear(cache);
+			cache->invalidations++;
+		}
+		ldns_nsec3_cache_set_params(cache, algorithm, iterations,
+				salt_length, salt);
+	}
+
+	cann_len = ldns_rdf_size(name);
+	for (i = 0; i < cann_len; i++) {
+		cann[i] = (uint8_t)LDNS_DNAME_NORMALIZE(
+				(int)ldns_rdf_data(name)[i]);
+	}
+	cached = ldns_nsec3_cache_lookup(cache, cann, cann_len);
+	if (cached) {
+		cache->hits++;
+		return ldns_nsec3_cache_hash2rdf(cached);
+	}
+
+	gettimeofday(&start, NULL);
+	hashed = ldns_nsec3_hash_name(name, algorithm, iterations,
+			salt_length, salt);
+	gettimeofday(&end, NULL);
+	if (!hashed) {
+		return NULL;
+	}
+	cache->misses++;
+	if (end.tv_sec > start.tv_sec || (end.tv_sec == start.tv_sec
+				&& end.tv_usec >= start.tv_usec)) {
+		cache->miss_usec += (uint64_t)(end.tv_sec - start.tv_sec)
+			* 1000000 + end.tv_usec - start.tv_usec;
+	}
+
+	/* remember the raw hash; the label holds its base32 encoding */
+	if (ldns_b32_pton_extended_hex(
+			(const char *)ldns_rdf_data(hashed) + 1,
+			ldns_rdf_data(hashed)[0],
+			hash, sizeof(hash)) == LDNS_NSEC3_CACHE_HASH_LEN) {
+		(void) ldns_nsec3_cache_add(cache, cann, cann_len, hash);
+	}
+	return hashed;
+}
+
+size_t
+ldns_nsec3_cache_count(const ldns_nsec3_cache *cache)
+{
+	return cache ? cache->loaded_count + cache->added_count : 0;
+}
+
+size_t
+ldns_nsec3_cache_hits(const ldns_nsec3_cache *cache)
+{
+	return cache ? cache->hits : 0;
+}
+
+size_t
+ldns_nsec3_cache_misses(const ldns_nsec3_cache *cache)
+{
+	return cache ? cache->misses : 0;
+}
+
+size_t
+ldns_nsec3_cache_invalidations(const ldns_nsec3_cache *cache)
+{
+	return cache ? cache->invalidations : 0;
+}
+
+uint64_t
+ldns_nsec3_cache_time_saved(const ldns_nsec3_cache *cache)
+{
+	if (!cache) {
+		return 0;
+	}
+	if (cache->misses) {
+		return cache->miss_usec * cache->hits / cache->misses;
+	}
+	return (uint64_t)cache->loaded_nsec_per_hash * cache->hits / 1000;
+}
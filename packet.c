@@ -836,6 +836,40 @@ ldns_pkt_edns_get_option_list(ldns_pkt *packet)
 	       = pkt_edns_data2edns_option_list(ldns_pkt_edns_data(packet)));
 }
 
+bool
+ldns_pkt_edns_option_find(const ldns_pkt *packet, ldns_edns_option_code code,
+		ldns_edns_option *option)
+{
+	ldns_edns_option_iter iter;
+	ldns_edns_option *edns;
+	size_t i;
+
+	/* the list is used for wireformat once it exists, so it is looked in
+	 * first, as it is */
+	if (packet->_edns_list) {
+		for (i = 0; i < ldns_edns_option_list_get_count(
+				packet->_edns_list); i++) {
+			edns = ldns_edns_option_list_get_option(
+					packet->_edns_list, i);
+			if (edns->_code == code) {
+				*option = *edns;
+				return true;
+			}
+		}
+		return false;
+	}
+	if (!packet->_edns_data) {
+		return false;
+	}
+	ldns_edns_option_iter_init(&iter, ldns_rdf_data(packet->_edns_data),
+			ldns_rdf_size(packet->_edns_data));
+	while (ldns_edns_option_iter_next(&iter, option)) {
+		if (option->_code == code) {
+			return true;
+		}
+	}
+	return false;
+}
 
 /* Create/destroy/convert functions
  */
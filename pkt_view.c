@@ -0,0 +1,247 @@
+/*
+ * pkt_view.c -- read-only view on a packet in wire format
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+/* Errors for a packet that ends in the middle of a section */
+static const ldns_status ldns_pkt_view_incomplete[4] = {
+	LDNS_STATUS_WIRE_INCOMPLETE_QUESTION,
+	LDNS_STATUS_WIRE_INCOMPLETE_ANSWER,
+	LDNS_STATUS_WIRE_INCOMPLETE_AUTHORITY,
+	LDNS_STATUS_WIRE_INCOMPLETE_ADDITIONAL
+};
+
+/*
+ * Walks over the name at *pos, with the same checks as ldns_wire2dname(),
+ * and leaves *pos after it.  When buf is not NULL, the name is copied to
+ * it, uncompressed.
+ */
+static ldns_status
+ldns_pkt_view_walk_name(const uint8_t *wire, size_t max, size_t *pos,
+		uint8_t *buf, size_t size, size_t *len)
+{
+	uint8_t name[LDNS_MAX_DOMAINLEN];
+	size_t name_len;
+	ldns_status status;
+
+	if (!buf || size >= LDNS_MAX_DOMAINLEN) {
+		return ldns_wire2dname_buf(buf, len, wire, max, pos);
+	}
+	status = ldns_wire2dname_buf(name, &name_len, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (name_len > size) {
+		return LDNS_STATUS_DOMAINNAME_OVERFLOW;
+	}
+	memcpy(buf, name, name_len);
+	if (len) {
+		*len = name_len;
+	}
+	return LDNS_STATUS_OK;
+}
+
+/* Reads the RR at pos, which ldns_pkt_view_init() has checked */
+static void
+ldns_pkt_view_read_rr(const ldns_pkt_view *view, ldns_pkt_section section,
+		uint16_t index, size_t pos, ldns_pkt_view_rr *rr)
+{
+	const uint8_t *wire = view->wire;
+
+	rr->view = view;
+	rr->section = section;
+	rr->index = index;
+	rr->owner = &wire[pos];
+	(void) ldns_pkt_view_walk_name(wire, view->size, &pos, NULL, 0, NULL);
+	rr->type = (ldns_rr_type) ldns_read_uint16(&wire[pos]);
+	rr->rr_class = (ldns_rr_class) ldns_read_uint16(&wire[pos + 2]);
+	pos += 4;
+	if (section == LDNS_SECTION_QUESTION) {
+		rr->ttl = 0;
+		rr->rdata = NULL;
+		rr->rdlength = 0;
+	} else {
+		rr->ttl = ldns_read_uint32(&wire[pos]);
+		rr->rdlength = ldns_read_uint16(&wire[pos + 4]);
+		rr->rdata = &wire[pos + 6];
+		pos += 6 + (size_t)rr->rdlength;
+	}
+	rr->next = pos;
+}
+
+ldns_status
+ldns_pkt_view_init(ldns_pkt_view *view, const uint8_t *wire, size_t max)
+{
+	size_t pos = LDNS_HEADER_SIZE;
+	ldns_status status;
+	int s;
+	uint16_t i;
+
+	if (!view || !wire) {
+		return LDNS_STATUS_NULL;
+	}
+	memset(view, 0, sizeof(*view));
+	if (max < LDNS_HEADER_SIZE) {
+		return LDNS_STATUS_WIRE_INCOMPLETE_HEADER;
+	}
+	view->wire = wire;
+	view->size = max;
+	view->counts[LDNS_SECTION_QUESTION] = LDNS_QDCOUNT(wire);
+	view->counts[LDNS_SECTION_ANSWER] = LDNS_ANCOUNT(wire);
+	view->counts[LDNS_SECTION_AUTHORITY] = LDNS_NSCOUNT(wire);
+	view->counts[LDNS_SECTION_ADDITIONAL] = LDNS_ARCOUNT(wire);
+
+	for (s = LDNS_SECTION_QUESTION; s <= LDNS_SECTION_ADDITIONAL; s++) {
+		view->sections[s] = pos;
+		for (i = 0; i < view->counts[s]; i++) {
+			size_t start = pos;
+
+			status = ldns_pkt_view_walk_name(wire, max, &pos,
+					NULL, 0, NULL);
+			if (status == LDNS_STATUS_PACKET_OVERFLOW) {
+				return ldns_pkt_view_incomplete[s];
+			} else if (status != LDNS_STATUS_OK) {
+				return status;
+			}
+			if (s == LDNS_SECTION_QUESTION) {
+				if (pos + 4 > max) {
+					return ldns_pkt_view_incomplete[s];
+				}
+				pos += 4;
+				continue;
+			}
+			if (pos + 10 > max
+			||  pos + 10 + ldns_read_uint16(&wire[pos + 8]) > max) {
+				return ldns_pkt_view_incomplete[s];
+			}
+			if (s == LDNS_SECTION_ADDITIONAL && view->opt == 0
+			&&  ldns_read_uint16(&wire[pos]) == LDNS_RR_TYPE_OPT) {
+				view->opt = start;
+				view->opt_index = i;
+			}
+			pos += 10 + ldns_read_uint16(&wire[pos + 8]);
+		}
+	}
+	return LDNS_STATUS_OK;
+}
+
+uint16_t
+ldns_pkt_view_id(const ldns_pkt_view *view)
+{
+	return LDNS_ID_WIRE(view->wire);
+}
+
+ldns_pkt_opcode
+ldns_pkt_view_get_opcode(const ldns_pkt_view *view)
+{
+	return (ldns_pkt_opcode) LDNS_OPCODE_WIRE(view->wire);
+}
+
+ldns_pkt_rcode
+ldns_pkt_view_get_rcode(const ldns_pkt_view *view)
+{
+	return (ldns_pkt_rcode) LDNS_RCODE_WIRE(view->wire);
+}
+
+uint16_t
+ldns_pkt_view_section_count(const ldns_pkt_view *view,
+		ldns_pkt_section section)
+{
+	switch (section) {
+	case LDNS_SECTION_QUESTION:
+	case LDNS_SECTION_ANSWER:
+	case LDNS_SECTION_AUTHORITY:
+	case LDNS_SECTION_ADDITIONAL:
+		return view->counts[section];
+	case LDNS_SECTION_ANY:
+		return view->counts[LDNS_SECTION_QUESTION]
+		     + view->counts[LDNS_SECTION_ANSWER]
+		     + view->counts[LDNS_SECTION_AUTHORITY]
+		     + view->counts[LDNS_SECTION_ADDITIONAL];
+	case LDNS_SECTION_ANY_NOQUESTION:
+		return view->counts[LDNS_SECTION_ANSWER]
+		     + view->counts[LDNS_SECTION_AUTHORITY]
+		     + view->counts[LDNS_SECTION_ADDITIONAL];
+	default:
+		return 0;
+	}
+}
+
+bool
+ldns_pkt_view_rr_first(const ldns_pkt_view *view, ldns_pkt_section section,
+		ldns_pkt_view_rr *rr)
+{
+	if (!view || !rr || section < LDNS_SECTION_QUESTION
+	||  section > LDNS_SECTION_ADDITIONAL || view->counts[section] == 0) {
+		return false;
+	}
+	ldns_pkt_view_read_rr(view, section, 0, view->sections[section], rr);
+	return true;
+}
+
+bool
+ldns_pkt_view_rr_next(ldns_pkt_view_rr *rr)
+{
+	if (!rr || !rr->view
+	||  rr->index + 1 >= rr->view->counts[rr->section]) {
+		return false;
+	}
+	ldns_pkt_view_read_rr(rr->view, rr->section, rr->index + 1, rr->next,
+			rr);
+	return true;
+}
+
+bool
+ldns_pkt_view_edns(const ldns_pkt_view *view, ldns_pkt_view_rr *rr)
+{
+	if (!view || !rr || view->opt == 0) {
+		return false;
+	}
+	ldns_pkt_view_read_rr(view, LDNS_SECTION_ADDITIONAL, view->opt_index,
+			view->opt, rr);
+	return true;
+}
+
+ldns_status
+ldns_pkt_view_name(const ldns_pkt_view *view, const uint8_t *name,
+		uint8_t *buf, size_t size, size_t *len)
+{
+	size_t pos;
+
+	if (!view || !name || !buf || name < view->wire) {
+		return LDNS_STATUS_NULL;
+	}
+	pos = (size_t)(name - view->wire);
+	return ldns_pkt_view_walk_name(view->wire, view->size, &pos,
+			buf, size, len);
+}
+
+ldns_status
+ldns_pkt_view_rr2rr(ldns_rr **rr_p, const ldns_pkt_view_rr *rr)
+{
+	size_t pos;
+
+	if (!rr_p || !rr || !rr->view) {
+		return LDNS_STATUS_NULL;
+	}
+	pos = (size_t)(rr->owner - rr->view->wire);
+	return ldns_wire2rr(rr_p, rr->view->wire, rr->view->size, &pos,
+			rr->section);
+}
+
+ldns_status
+ldns_pkt_view2pkt(ldns_pkt **packet_p, const ldns_pkt_view *view)
+{
+	if (!packet_p || !view || !view->wire) {
+		return LDNS_STATUS_NULL;
+	}
+	return ldns_wire2pkt(packet_p, view->wire, view->size);
+}
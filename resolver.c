@@ -32,6 +32,18 @@ ldns_resolver_source(const ldns_resolver *r)
 	return r->_source;
 }
 
+ldns_udp_pool *
+ldns_resolver_udp_pool(const ldns_resolver *r)
+{
+	return r->_udp_pool;
+}
+
+ldns_tcp_pool *
+ldns_resolver_tcp_pool(const ldns_resolver *r)
+{
+	return r->_tcp_pool;
+}
+
 uint16_t
 ldns_resolver_edns_udp_size(const ldns_resolver *r)
 {
@@ -197,6 +209,47 @@ ldns_resolver_nameserver_rtt(const ldns_resolver *r, size_t pos)
 
 }
 
+size_t
+ldns_resolver_nameserver_rttvar(const ldns_resolver *r, size_t pos)
+{
+	assert(r != NULL);
+
+	if (pos >= ldns_resolver_nameserver_count(r) || !r->_rttvar) {
+		return 0;
+	}
+	return r->_rttvar[pos];
+}
+
+/* milliseconds to wait for an answer from the nameserver at pos */
+static size_t
+ldns_resolver_rto_ms(const ldns_resolver *r, size_t pos)
+{
+	size_t timeout, rtt, rto;
+
+	timeout = (size_t)r->_timeout.tv_sec * 1000
+	        + (size_t)r->_timeout.tv_usec / 1000;
+	rtt = ldns_resolver_nameserver_rtt(r, pos);
+	if (rtt == LDNS_RESOLV_RTT_INF || rtt == LDNS_RESOLV_RTT_MIN) {
+		return timeout;
+	}
+	rto = rtt + 4 * ldns_resolver_nameserver_rttvar(r, pos);
+	if (rto < LDNS_RESOLV_RTO_MIN) {
+		rto = LDNS_RESOLV_RTO_MIN;
+	}
+	return rto < timeout ? rto : timeout;
+}
+
+struct timeval
+ldns_resolver_nameserver_rto(const ldns_resolver *r, size_t pos)
+{
+	struct timeval tv;
+	size_t ms = ldns_resolver_rto_ms(r, pos);
+
+	tv.tv_sec = (time_t)(ms / 1000);
+	tv.tv_usec = (long)(ms % 1000) * 1000;
+	return tv;
+}
+
 struct timeval
 ldns_resolver_timeout(const ldns_resolver *r)
 {
@@ -227,6 +280,24 @@ ldns_resolver_random(const ldns_resolver *r)
 	return r->_random;
 }
 
+bool
+ldns_resolver_race(const ldns_resolver *r)
+{
+	return r->_race;
+}
+
+bool
+ldns_resolver_srtt(const ldns_resolver *r)
+{
+	return r->_srtt;
+}
+
+ldns_cache *
+ldns_resolver_cache(const ldns_resolver *r)
+{
+	return r->_cache;
+}
+
 size_t
 ldns_resolver_searchlist_count(const ldns_resolver *r)
 {
@@ -246,6 +317,24 @@ ldns_resolver_set_source(ldns_resolver *r, ldns_rdf *s)
 	r->_source = s;
 }
 
+void
+ldns_resolver_set_udp_pool(ldns_resolver *r, ldns_udp_pool *pool)
+{
+	if (r->_udp_pool != pool) {
+		ldns_udp_pool_free(r->_udp_pool);
+	}
+	r->_udp_pool = pool;
+}
+
+void
+ldns_resolver_set_tcp_pool(ldns_resolver *r, ldns_tcp_pool *pool)
+{
+	if (r->_tcp_pool != pool) {
+		ldns_tcp_pool_free(r->_tcp_pool);
+	}
+	r->_tcp_pool = pool;
+}
+
 ldns_rdf *
 ldns_resolver_pop_nameserver(ldns_resolver *r)
 {
@@ -268,6 +357,8 @@ ldns_resolver_pop_nameserver(ldns_resolver *r)
 	if (ns_count == 1) {
 		LDNS_FREE(nameservers);
 		LDNS_FREE(rtt);
+		LDNS_FREE(r->_rttvar);
+		LDNS_FREE(r->_rtt_measured);
 
 		ldns_resolver_set_nameservers(r, NULL);
 		ldns_resolver_set_rtt(r, NULL);
@@ -278,6 +369,21 @@ ldns_resolver_pop_nameserver(ldns_resolver *r)
 
 	        ldns_resolver_set_nameservers(r, nameservers);
 	        ldns_resolver_set_rtt(r, rtt);
+		/* shrinking, keep the old one when that fails */
+		if (r->_rttvar) {
+			size_t *rttvar = LDNS_XREALLOC(r->_rttvar, size_t,
+					(ns_count - 1));
+			if (rttvar) {
+				r->_rttvar = rttvar;
+			}
+		}
+		if (r->_rtt_measured) {
+			bool *measured = LDNS_XREALLOC(r->_rtt_measured,
+					bool, (ns_count - 1));
+			if (measured) {
+				r->_rtt_measured = measured;
+			}
+		}
 	}
 	/* decr the count */
 	ldns_resolver_dec_nameserver_count(r);
@@ -289,7 +395,8 @@ ldns_resolver_push_nameserver(ldns_resolver *r, const ldns_rdf *n)
 {
 	ldns_rdf **nameservers;
 	size_t ns_count;
-	size_t *rtt;
+	size_t *rtt, *rttvar;
+	bool *measured;
 
 	if (ldns_rdf_get_type(n) != LDNS_RDF_TYPE_A &&
 			ldns_rdf_get_type(n) != LDNS_RDF_TYPE_AAAA) {
@@ -320,14 +427,26 @@ ldns_resolver_push_nameserver(ldns_resolver *r, const ldns_rdf *n)
 	}
         if(!rtt)
                 return LDNS_STATUS_MEM_ERR;
+	ldns_resolver_set_rtt(r, rtt);
+
+	/* and the variation */
+	rttvar = LDNS_XREALLOC(r->_rttvar, size_t, (ns_count + 1));
+	if (!rttvar)
+		return LDNS_STATUS_MEM_ERR;
+	r->_rttvar = rttvar;
+	measured = LDNS_XREALLOC(r->_rtt_measured, bool, (ns_count + 1));
+	if (!measured)
+		return LDNS_STATUS_MEM_ERR;
+	r->_rtt_measured = measured;
 
 	/* slide n in its slot. */
 	/* we clone it here, because then we can free the original
 	 * rr's where it stood */
 	nameservers[ns_count] = ldns_rdf_clone(n);
 	rtt[ns_count] = LDNS_RESOLV_RTT_MIN;
+	rttvar[ns_count] = 0;
+	measured[ns_count] = false;
 	ldns_resolver_incr_nameserver_count(r);
-	ldns_resolver_set_rtt(r, rtt);
 	return LDNS_STATUS_OK;
 }
 
@@ -603,6 +722,80 @@ ldns_resolver_set_random(ldns_resolver *r, bool b)
 	r->_random = b;
 }
 
+void
+ldns_resolver_set_race(ldns_resolver *r, bool b)
+{
+	r->_race = b;
+}
+
+void
+ldns_resolver_set_srtt(ldns_resolver *r, bool b)
+{
+	r->_srtt = b;
+}
+
+void
+ldns_resolver_set_cache(ldns_resolver *r, ldns_cache *cache)
+{
+	r->_cache = cache;
+}
+
+/* Stores a smoothed round trip time, keeping clear of the values that
+ * mean unreachable and not measured.
+ */
+static void
+ldns_resolver_set_srtt_value(ldns_resolver *r, size_t pos, size_t srtt)
+{
+	if (srtt <= LDNS_RESOLV_RTT_MIN) {
+		srtt = LDNS_RESOLV_RTT_MIN + 1;
+	} else if (srtt > LDNS_RESOLV_RTT_MAX) {
+		srtt = LDNS_RESOLV_RTT_MAX;
+	}
+	ldns_resolver_set_nameserver_rtt(r, pos, srtt);
+}
+
+void
+ldns_resolver_nameserver_rtt_update(ldns_resolver *r, size_t pos, size_t ms)
+{
+	size_t srtt, diff;
+
+	if (pos >= ldns_resolver_nameserver_count(r) || !r->_rttvar
+	||  !r->_rtt_measured) {
+		return;
+	}
+	srtt = ldns_resolver_nameserver_rtt(r, pos);
+	if (srtt == LDNS_RESOLV_RTT_INF || srtt == LDNS_RESOLV_RTT_MIN
+	||  !r->_rtt_measured[pos]) {
+		/* the first measurement, or the first after a backoff */
+		r->_rttvar[pos] = ms / 2;
+		r->_rtt_measured[pos] = true;
+		ldns_resolver_set_srtt_value(r, pos, ms);
+		return;
+	}
+	diff = srtt > ms ? srtt - ms : ms - srtt;
+	r->_rttvar[pos] = (3 * r->_rttvar[pos] + diff) / 4;
+	ldns_resolver_set_srtt_value(r, pos, (7 * srtt + ms) / 8);
+}
+
+void
+ldns_resolver_nameserver_rtt_backoff(ldns_resolver *r, size_t pos)
+{
+	size_t rto;
+
+	if (pos >= ldns_resolver_nameserver_count(r)) {
+		return;
+	}
+	rto = ldns_resolver_rto_ms(r, pos);
+	if (rto < ldns_resolver_nameserver_rtt(r, pos)) {
+		rto = ldns_resolver_nameserver_rtt(r, pos);
+	}
+	ldns_resolver_set_srtt_value(r, pos, rto * 2);
+	/* so that the next measurement starts over */
+	if (r->_rtt_measured) {
+		r->_rtt_measured[pos] = false;
+	}
+}
+
 /* more sophisticated functions */
 ldns_resolver *
 ldns_resolver_new(void)
@@ -617,6 +810,11 @@ ldns_resolver_new(void)
 	r->_searchlist = NULL;
 	r->_nameservers = NULL;
 	r->_rtt = NULL;
+	r->_rttvar = NULL;
+	r->_rtt_measured = NULL;
+	r->_udp_pool = NULL;
+	r->_tcp_pool = NULL;
+	r->_cache = NULL;
 
 	/* defaults are filled out */
 	ldns_resolver_set_searchlist_count(r, 0);
@@ -644,6 +842,8 @@ ldns_resolver_new(void)
 	 * when there are multiple
 	 */
 	ldns_resolver_set_random(r, true);
+	ldns_resolver_set_race(r, false);
+	ldns_resolver_set_srtt(r, false);
 
 	ldns_resolver_set_debug(r, 0);
 
@@ -654,6 +854,7 @@ ldns_resolver_new(void)
 	r->_axfr_soa_count = 0;
 	r->_axfr_i = 0;
 	r->_cur_axfr_pkt = NULL;
+	ldns_tcp_reader_init(&r->_axfr_reader);
 
 	r->_tsig_keyname = NULL;
 	r->_tsig_keydata = NULL;
@@ -688,6 +889,8 @@ ldns_resolver_clone(ldns_resolver *src)
 	if (dst->_nameserver_count == 0) {
 		dst->_nameservers = NULL;
 		dst->_rtt = NULL;
+		dst->_rttvar = NULL;
+		dst->_rtt_measured = NULL;
 	} else {
 		if (!(dst->_nameservers =
 		    LDNS_XMALLOC(ldns_rdf *, dst->_nameserver_count)))
@@ -703,9 +906,27 @@ ldns_resolver_clone(ldns_resolver *src)
 			goto error_nameservers;
 		(void) memcpy(dst->_rtt, src->_rtt,
 		    sizeof(size_t) * dst->_nameserver_count);
+		if (!(dst->_rttvar =
+		    LDNS_XMALLOC(size_t, dst->_nameserver_count)))
+			goto error_rtt;
+		if (src->_rttvar)
+			(void) memcpy(dst->_rttvar, src->_rttvar,
+			    sizeof(size_t) * dst->_nameserver_count);
+		else
+			(void) memset(dst->_rttvar, 0,
+			    sizeof(size_t) * dst->_nameserver_count);
+		if (!(dst->_rtt_measured =
+		    LDNS_XMALLOC(bool, dst->_nameserver_count)))
+			goto error_rttvar;
+		if (src->_rtt_measured)
+			(void) memcpy(dst->_rtt_measured, src->_rtt_measured,
+			    sizeof(bool) * dst->_nameserver_count);
+		else
+			(void) memset(dst->_rtt_measured, 0,
+			    sizeof(bool) * dst->_nameserver_count);
 	}
 	if (dst->_domain && (!(dst->_domain = ldns_rdf_clone(src->_domain))))
-		goto error_rtt;
+		goto error_rtt_measured;
 
 	if (dst->_tsig_keyname &&
 	    (!(dst->_tsig_keyname = strdup(src->_tsig_keyname))))
@@ -727,8 +948,28 @@ ldns_resolver_clone(ldns_resolver *src)
 	    (!(dst->_dnssec_anchors=ldns_rr_list_clone(src->_dnssec_anchors))))
 		goto error_cur_axfr_pkt;
 
+	/* the clone gets sockets and connections of its own */
+	if (dst->_udp_pool) {
+		if (!(dst->_udp_pool = ldns_udp_pool_new(
+		    ldns_udp_pool_size(src->_udp_pool))))
+			goto error_dnssec_anchors;
+		ldns_udp_pool_set_rotate(dst->_udp_pool,
+		    ldns_udp_pool_rotate(src->_udp_pool));
+	}
+	if (dst->_tcp_pool) {
+		if (!(dst->_tcp_pool = ldns_tcp_pool_new()))
+			goto error_udp_pool;
+		ldns_tcp_pool_set_idle(dst->_tcp_pool,
+		    ldns_tcp_pool_idle(src->_tcp_pool));
+	}
+	ldns_tcp_reader_init(&dst->_axfr_reader);
+
 	return dst;
 
+error_udp_pool:
+	ldns_udp_pool_free(dst->_udp_pool);
+error_dnssec_anchors:
+	ldns_rr_list_deep_free(dst->_dnssec_anchors);
 error_cur_axfr_pkt:
 	ldns_pkt_free(dst->_cur_axfr_pkt);
 error_tsig_algorithm:
@@ -739,6 +980,10 @@ error_tsig_keyname:
 	LDNS_FREE(dst->_tsig_keyname);
 error_domain:
 	ldns_rdf_deep_free(dst->_domain);
+error_rtt_measured:
+	LDNS_FREE(dst->_rtt_measured);
+error_rttvar:
+	LDNS_FREE(dst->_rttvar);
 error_rtt:
 	LDNS_FREE(dst->_rtt);
 error_nameservers:
@@ -1040,9 +1285,14 @@ ldns_resolver_deep_free(ldns_resolver *res)
 		if (res->_rtt) {
 			LDNS_FREE(res->_rtt);
 		}
+		LDNS_FREE(res->_rttvar);
+		LDNS_FREE(res->_rtt_measured);
 		if (res->_dnssec_anchors) {
 			ldns_rr_list_deep_free(res->_dnssec_anchors);
 		}
+		ldns_udp_pool_free(res->_udp_pool);
+		ldns_tcp_pool_free(res->_tcp_pool);
+		ldns_tcp_reader_clear(&res->_axfr_reader);
 		LDNS_FREE(res);
 	}
 }
@@ -1391,9 +1641,25 @@ ldns_resolver_send(ldns_pkt **answer, ldns_resolver *r, const ldns_rdf *name,
 		ldns_pkt_free(query_pkt);
 	        return LDNS_STATUS_CRYPTO_TSIG_ERR;
 #endif /* HAVE_SSL */
+	} else if (ldns_resolver_cache(r)) {
+		answer_pkt = ldns_cache_lookup(ldns_resolver_cache(r), query_pkt);
+		if (answer_pkt) {
+			ldns_pkt_free(query_pkt);
+			if (answer) {
+				*answer = answer_pkt;
+			} else {
+				ldns_pkt_free(answer_pkt);
+			}
+			return LDNS_STATUS_OK;
+		}
 	}
 
 	status = ldns_resolver_send_pkt(&answer_pkt, r, query_pkt);
+	if (status == LDNS_STATUS_OK && answer_pkt && ldns_resolver_cache(r)
+	    && !ldns_resolver_tsig_keyname(r)) {
+		(void) ldns_cache_store(ldns_resolver_cache(r),
+		                        query_pkt, answer_pkt);
+	}
 	ldns_pkt_free(query_pkt);
 
 	/* allows answer to be NULL when not interested in return value */
@@ -1407,7 +1673,7 @@ ldns_rr *
 ldns_axfr_next(ldns_resolver *resolver)
 {
 	ldns_rr *cur_rr;
-	uint8_t *packet_wire;
+	const uint8_t *packet_wire;
 	size_t packet_wire_size;
 	ldns_status status;
 
@@ -1431,6 +1697,7 @@ ldns_axfr_next(ldns_resolver *resolver)
 			if (resolver->_axfr_soa_count >= 2) {
 
 				close_socket(resolver->_socket);
+				ldns_tcp_reader_clear(&resolver->_axfr_reader);
 
 				ldns_pkt_free(resolver->_cur_axfr_pkt);
 				resolver->_cur_axfr_pkt = NULL;
@@ -1438,13 +1705,16 @@ ldns_axfr_next(ldns_resolver *resolver)
 		}
 		return cur_rr;
 	} else {
-               packet_wire = ldns_tcp_read_wire_timeout(resolver->_socket, &packet_wire_size, resolver->_timeout);
-		if(!packet_wire)
+		/* the messages often come several in one read */
+		if (ldns_tcp_read_msg_timeout(resolver->_socket,
+				&resolver->_axfr_reader, resolver->_timeout,
+				&packet_wire, &packet_wire_size)
+				!= LDNS_STATUS_OK) {
 			return NULL;
+		}
 
 		status = ldns_wire2pkt(&resolver->_cur_axfr_pkt, packet_wire,
 				     packet_wire_size);
-		LDNS_FREE(packet_wire);
 
 		resolver->_axfr_i = 0;
 		if (status != LDNS_STATUS_OK) {
@@ -1458,6 +1728,7 @@ ldns_axfr_next(ldns_resolver *resolver)
 			   in an undefined state */
 
 			close_socket(resolver->_socket);
+			ldns_tcp_reader_clear(&resolver->_axfr_reader);
 
 			return NULL;
 		} else if (ldns_pkt_get_rcode(resolver->_cur_axfr_pkt) != 0) {
@@ -1480,6 +1751,7 @@ ldns_axfr_next(ldns_resolver *resolver)
 			   in an undefined state */
 
 			close_socket(resolver->_socket);
+			ldns_tcp_reader_clear(&resolver->_axfr_reader);
 
 			return NULL;
 		} else {
@@ -1507,6 +1779,7 @@ ldns_axfr_abort(ldns_resolver *resolver)
 		closesocket(resolver->_socket);
 #endif
 		resolver->_socket = -1;
+		ldns_tcp_reader_clear(&resolver->_axfr_reader);
 	}
 }
 
@@ -1543,6 +1816,7 @@ ldns_resolver_nameservers_randomize(ldns_resolver *r)
 	uint16_t i, j;
 	ldns_rdf **ns, *tmpns;
 	size_t *rtt, tmprtt;
+	bool tmpmeasured;
 
 	/* should I check for ldns_resolver_random?? */
 	assert(r != NULL);
@@ -1557,7 +1831,143 @@ ldns_resolver_nameservers_randomize(ldns_resolver *r)
 		tmprtt = rtt[i];
 		rtt[i] = rtt[j];
 		rtt[j] = tmprtt;
+		if (r->_rttvar) {
+			tmprtt = r->_rttvar[i];
+			r->_rttvar[i] = r->_rttvar[j];
+			r->_rttvar[j] = tmprtt;
+		}
+		if (r->_rtt_measured) {
+			tmpmeasured = r->_rtt_measured[i];
+			r->_rtt_measured[i] = r->_rtt_measured[j];
+			r->_rtt_measured[j] = tmpmeasured;
+		}
 	}
 	ldns_resolver_set_nameservers(r, ns);
 }
 
+/* Sort key of a nameserver for ldns_resolver_nameservers_sort_rtt() */
+static size_t
+ldns_resolver_rtt_key(const ldns_resolver *r, size_t pos)
+{
+	size_t rtt = r->_rtt[pos];
+
+	if (rtt == LDNS_RESOLV_RTT_INF) {
+		return (size_t)-1;
+	}
+	return rtt == LDNS_RESOLV_RTT_MIN ? LDNS_RESOLV_RTT_UNKNOWN : rtt;
+}
+
+/* Moves the nameserver at from to position to, shifting those between */
+static void
+ldns_resolver_nameserver_move(ldns_resolver *r, size_t from, size_t to)
+{
+	ldns_rdf *ns = r->_nameservers[from];
+	size_t rtt = r->_rtt[from];
+	size_t rttvar = r->_rttvar[from];
+	bool measured = r->_rtt_measured[from];
+
+	for (; from > to; from--) {
+		r->_nameservers[from] = r->_nameservers[from - 1];
+		r->_rtt[from] = r->_rtt[from - 1];
+		r->_rttvar[from] = r->_rttvar[from - 1];
+		r->_rtt_measured[from] = r->_rtt_measured[from - 1];
+	}
+	r->_nameservers[to] = ns;
+	r->_rtt[to] = rtt;
+	r->_rttvar[to] = rttvar;
+	r->_rtt_measured[to] = measured;
+}
+
+void
+ldns_resolver_nameservers_sort_rtt(ldns_resolver *r)
+{
+	size_t i, j, n;
+
+	assert(r != NULL);
+
+	n = ldns_resolver_nameserver_count(r);
+	if (n < 2 || !r->_rttvar || !r->_rtt_measured) {
+		return;
+	}
+	/* stable, so that equal ones keep their (random) order */
+	for (i = 1; i < n; i++) {
+		for (j = i; j > 0 && ldns_resolver_rtt_key(r, j - 1)
+				> ldns_resolver_rtt_key(r, i); j--)
+			;
+		if (j < i) {
+			ldns_resolver_nameserver_move(r, i, j);
+		}
+	}
+	if (ldns_get_random() % LDNS_RESOLV_EXPLORE == 0) {
+		j = 1 + ldns_get_random() % (n - 1);
+		if (r->_rtt[j] != LDNS_RESOLV_RTT_INF) {
+			ldns_resolver_nameserver_move(r, j, 0);
+		}
+	}
+}
+
+ldns_status
+ldns_resolver_write_rtt(FILE *fp, const ldns_resolver *r)
+{
+	char *str;
+	size_t i, rtt;
+	time_t now = time(NULL);
+
+	for (i = 0; i < ldns_resolver_nameserver_count(r); i++) {
+		rtt = ldns_resolver_nameserver_rtt(r, i);
+		if (rtt == LDNS_RESOLV_RTT_INF || rtt == LDNS_RESOLV_RTT_MIN) {
+			continue;
+		}
+		if (!(str = ldns_rdf2str(ldns_resolver_nameservers(r)[i]))) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		if (fprintf(fp, "%s %lu %lu %lu\n", str, (unsigned long)rtt,
+				(unsigned long)ldns_resolver_nameserver_rttvar(
+					r, i), (unsigned long)now) < 0) {
+			LDNS_FREE(str);
+			return LDNS_STATUS_FILE_ERR;
+		}
+		LDNS_FREE(str);
+	}
+	return ferror(fp) ? LDNS_STATUS_FILE_ERR : LDNS_STATUS_OK;
+}
+
+ldns_status
+ldns_resolver_read_rtt(ldns_resolver *r, FILE *fp)
+{
+	char line[LDNS_MAX_LINELEN + 1], addr[64];
+	unsigned long rtt, rttvar, when;
+	unsigned long now = (unsigned long)time(NULL);
+	ldns_status status = LDNS_STATUS_OK;
+	ldns_rdf *a;
+	size_t i;
+
+	while (fgets(line, (int)sizeof(line), fp)) {
+		if (line[0] == '#' || line[0] == ';' || line[0] == '\n') {
+			continue;
+		}
+		if (sscanf(line, "%63s %lu %lu %lu", addr, &rtt, &rttvar,
+				&when) != 4
+		||  (!(a = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_A, addr))
+		  && !(a = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_AAAA, addr)))) {
+			status = LDNS_STATUS_SYNTAX_ERR;
+			continue;
+		}
+		if (when + LDNS_RESOLV_RTT_STATE_AGE >= now && when <= now
+		&&  rtt > LDNS_RESOLV_RTT_MIN && r->_rttvar
+		&&  r->_rtt_measured) {
+			for (i = 0; i < ldns_resolver_nameserver_count(r); i++) {
+				if (ldns_rdf_compare(a,
+				    ldns_resolver_nameservers(r)[i]) == 0) {
+					ldns_resolver_set_srtt_value(r, i,
+							(size_t)rtt);
+					r->_rttvar[i] = (size_t)rttvar;
+					r->_rtt_measured[i] = true;
+				}
+			}
+		}
+		ldns_rdf_deep_free(a);
+	}
+	return status;
+}
+
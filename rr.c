@@ -1461,56 +1461,60 @@ ldns_rr_list_clone(const ldns_rr_list *rrlist)
 }
 
 
+/* An RR being sorted, with its canonical wire format once it is needed.
+ * The wire formats of all RRs are written one after another in a single
+ * buffer, which may move when it grows, so they are found by offset. */
+struct ldns_rr_sortable {
+	ldns_rr     *rr;
+	ldns_buffer *wire;
+	size_t       pos;
+	size_t       len;
+};
+
+/* Writes the canonical wire format of the RR when it is not there yet.
+ * This may move the buffer, so views are made after both RRs are in. */
+static bool
+ldns_rr_sortable_write(struct ldns_rr_sortable *s)
+{
+	size_t start;
+
+	if (s->len == 0) {
+		start = ldns_buffer_position(s->wire);
+		if (ldns_rr2buffer_wire_canonical(s->wire, s->rr,
+				LDNS_SECTION_ANY) != LDNS_STATUS_OK) {
+			ldns_buffer_set_position(s->wire, start);
+			return false;
+		}
+		s->pos = start;
+		s->len = ldns_buffer_position(s->wire) - start;
+	}
+	return true;
+}
+
 static int
 qsort_schwartz_rr_compare(const void *a, const void *b)
 {
 	int result = 0;
-	ldns_rr *rr1, *rr2;
-	ldns_buffer *rr1_buf, *rr2_buf;
-	struct ldns_schwartzian_compare_struct *sa = *(struct ldns_schwartzian_compare_struct **) a;
-	struct ldns_schwartzian_compare_struct *sb = *(struct ldns_schwartzian_compare_struct **) b;
+	struct ldns_rr_sortable *sa = (struct ldns_rr_sortable *) a;
+	struct ldns_rr_sortable *sb = (struct ldns_rr_sortable *) b;
 	/* if we are doing 2wire, we need to do lowercasing on the dname (and maybe on the rdata)
-	 * this must be done for comparison only, so we need to have a temp var for both buffers,
-	 * which is only used when the transformed object value isn't there yet
+	 * this is done only when the wire format isn't there yet, and only
+	 * for the RRs that compare equal without their rdata
 	 */
-	ldns_rr *canonical_a, *canonical_b;
+	ldns_buffer rr1_buf, rr2_buf;
 
-	rr1 = (ldns_rr *) sa->original_object;
-	rr2 = (ldns_rr *) sb->original_object;
-
-	result = ldns_rr_compare_no_rdata(rr1, rr2);
+	result = ldns_rr_compare_no_rdata(sa->rr, sb->rr);
 
 	if (result == 0) {
-		if (!sa->transformed_object) {
-			canonical_a = ldns_rr_clone(sa->original_object);
-			ldns_rr2canonical(canonical_a);
-			sa->transformed_object = ldns_buffer_new(ldns_rr_uncompressed_size(canonical_a));
-			if (ldns_rr2buffer_wire(sa->transformed_object, canonical_a, LDNS_SECTION_ANY) != LDNS_STATUS_OK) {
-		                ldns_buffer_free((ldns_buffer *)sa->transformed_object);
-                                sa->transformed_object = NULL;
-				ldns_rr_free(canonical_a);
-				return 0;
-			}
-			ldns_rr_free(canonical_a);
-		}
-		if (!sb->transformed_object) {
-			canonical_b = ldns_rr_clone(sb->original_object);
-			ldns_rr2canonical(canonical_b);
-			sb->transformed_object = ldns_buffer_new(ldns_rr_uncompressed_size(canonical_b));
-			if (ldns_rr2buffer_wire(sb->transformed_object, canonical_b, LDNS_SECTION_ANY) != LDNS_STATUS_OK) {
-		                ldns_buffer_free((ldns_buffer *)sa->transformed_object);
-		                ldns_buffer_free((ldns_buffer *)sb->transformed_object);
-                                sa->transformed_object = NULL;
-                                sb->transformed_object = NULL;
-				ldns_rr_free(canonical_b);
-				return 0;
-			}
-			ldns_rr_free(canonical_b);
+		if (!ldns_rr_sortable_write(sa)
+		||  !ldns_rr_sortable_write(sb)) {
+			return 0;
 		}
-		rr1_buf = (ldns_buffer *) sa->transformed_object;
-		rr2_buf = (ldns_buffer *) sb->transformed_object;
-
-		result = ldns_rr_compare_wire(rr1_buf, rr2_buf);
+		ldns_buffer_init_frm_data(&rr1_buf,
+				ldns_buffer_at(sa->wire, sa->pos), sa->len);
+		ldns_buffer_init_frm_data(&rr2_buf,
+				ldns_buffer_at(sb->wire, sb->pos), sb->len);
+		result = ldns_rr_compare_wire(&rr1_buf, &rr2_buf);
 	}
 
 	return result;
@@ -1519,42 +1523,38 @@ qsort_schwartz_rr_compare(const void *a, const void *b)
 void
 ldns_rr_list_sort(ldns_rr_list *unsorted)
 {
-	struct ldns_schwartzian_compare_struct **sortables;
+	struct ldns_rr_sortable *sortables;
+	ldns_buffer *wire;
 	size_t item_count;
 	size_t i;
 
 	if (unsorted) {
 		item_count = ldns_rr_list_rr_count(unsorted);
-
-		sortables = LDNS_XMALLOC(struct ldns_schwartzian_compare_struct *,
-					 item_count);
-                if(!sortables) return; /* no way to return error */
+		if (item_count < 2) {
+			return;
+		}
+		sortables = LDNS_XMALLOC(struct ldns_rr_sortable, item_count);
+		wire = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
+		if (!sortables || !wire) {
+			/* no way to return error */
+			LDNS_FREE(sortables);
+			ldns_buffer_release(wire);
+			return;
+		}
 		for (i = 0; i < item_count; i++) {
-			sortables[i] = LDNS_XMALLOC(struct ldns_schwartzian_compare_struct, 1);
-                        if(!sortables[i]) {
-                                /* free the allocated parts */
-                                while(i>0) {
-                                        i--;
-                                        LDNS_FREE(sortables[i]);
-                                }
-                                /* no way to return error */
-				LDNS_FREE(sortables);
-                                return;
-                        }
-			sortables[i]->original_object = ldns_rr_list_rr(unsorted, i);
-			sortables[i]->transformed_object = NULL;
+			sortables[i].rr = ldns_rr_list_rr(unsorted, i);
+			sortables[i].wire = wire;
+			sortables[i].pos = 0;
+			sortables[i].len = 0;
 		}
 		qsort(sortables,
 		      item_count,
-		      sizeof(struct ldns_schwartzian_compare_struct *),
+		      sizeof(struct ldns_rr_sortable),
 		      qsort_schwartz_rr_compare);
 		for (i = 0; i < item_count; i++) {
-			unsorted->_rrs[i] = sortables[i]->original_object;
-			if (sortables[i]->transformed_object) {
-				ldns_buffer_free(sortables[i]->transformed_object);
-			}
-			LDNS_FREE(sortables[i]);
+			unsorted->_rrs[i] = sortables[i].rr;
 		}
+		ldns_buffer_release(wire);
 		LDNS_FREE(sortables);
 	}
 }
@@ -1642,40 +1642,49 @@ int
 ldns_rr_compare(const ldns_rr *rr1, const ldns_rr *rr2)
 {
 	int result;
-	size_t rr1_len, rr2_len;
+	size_t rr1_len;
 
-	ldns_buffer *rr1_buf;
-	ldns_buffer *rr2_buf;
+	ldns_buffer *wire;
+	ldns_buffer rr1_buf;
+	ldns_buffer rr2_buf;
+	const ldns_rr_codec *codec;
 
 	result = ldns_rr_compare_no_rdata(rr1, rr2);
 	if (result == 0) {
-		rr1_len = ldns_rr_uncompressed_size(rr1);
-		rr2_len = ldns_rr_uncompressed_size(rr2);
-
-		rr1_buf = ldns_buffer_new(rr1_len);
-		rr2_buf = ldns_buffer_new(rr2_len);
-
-		if (ldns_rr2buffer_wire_canonical(rr1_buf,
+		codec = ldns_rr_codec_get(ldns_rr_get_type(rr1));
+		if (codec && codec->compare(rr1, rr2, &result)) {
+			return result;
+		}
+		/* both canonical forms, one after the other, and a view of
+		 * each of the size that ldns_rr_compare_wire() takes */
+		wire = ldns_buffer_acquire(ldns_rr_uncompressed_size(rr1)
+				+ ldns_rr_uncompressed_size(rr2));
+		if (!wire) {
+			return 0;
+		}
+		if (ldns_rr2buffer_wire_canonical(wire,
 								    rr1,
 								    LDNS_SECTION_ANY)
 		    != LDNS_STATUS_OK) {
-			ldns_buffer_free(rr1_buf);
-			ldns_buffer_free(rr2_buf);
+			ldns_buffer_release(wire);
 			return 0;
 		}
-		if (ldns_rr2buffer_wire_canonical(rr2_buf,
+		rr1_len = ldns_buffer_position(wire);
+		if (ldns_rr2buffer_wire_canonical(wire,
 								    rr2,
 								    LDNS_SECTION_ANY)
 		    != LDNS_STATUS_OK) {
-			ldns_buffer_free(rr1_buf);
-			ldns_buffer_free(rr2_buf);
+			ldns_buffer_release(wire);
 			return 0;
 		}
+		ldns_buffer_init_frm_data(&rr1_buf, ldns_buffer_begin(wire),
+				rr1_len);
+		ldns_buffer_init_frm_data(&rr2_buf, ldns_buffer_at(wire, rr1_len),
+				ldns_buffer_position(wire) - rr1_len);
 
-		result = ldns_rr_compare_wire(rr1_buf, rr2_buf);
+		result = ldns_rr_compare_wire(&rr1_buf, &rr2_buf);
 
-		ldns_buffer_free(rr1_buf);
-		ldns_buffer_free(rr2_buf);
+		ldns_buffer_release(wire);
 	}
 
 	return result;
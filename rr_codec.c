@@ -0,0 +1,5120 @@
+/*
+ * rr_codec.c -- rdata encoders and decoders for each RR type
+ *
+ * Generated by rr_codec.pl from the rdata field descriptors in rr.c.
+ * Do not edit, but change rr.c or rr_codec.pl and run "make rr-codec".
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+/* Returned by ldns_rr_codec_cmp() for rdfs of which one starts with the
+ * other */
+#define LDNS_RR_CODEC_CMP_SIZE	2
+
+/* Makes room for n more rdfs in rr, which the ldns_rr_codec_read functions
+ * then put there */
+static bool
+ldns_rr_codec_grow(ldns_rr *rr, size_t n)
+{
+	ldns_rdf **fields = LDNS_XREALLOC(rr->_rdata_fields, ldns_rdf *,
+			rr->_rd_count + n);
+
+	if (!fields) {
+		return false;
+	}
+	rr->_rdata_fields = fields;
+	return true;
+}
+
+/* Reads a rdf of len bytes at *pos */
+static ldns_status
+ldns_rr_codec_read(ldns_rr *rr, ldns_rdf_type type, size_t len,
+		const uint8_t *wire, size_t *pos, size_t end)
+{
+	ldns_rdf *rdf;
+
+	if (*pos + len > end) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	rdf = ldns_rdf_new_frm_data(type, len, &wire[*pos]);
+	if (!rdf) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	rr->_rdata_fields[rr->_rd_count++] = rdf;
+	*pos += len;
+	return LDNS_STATUS_OK;
+}
+
+static ldns_status
+ldns_rr_codec_read_dname(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos)
+{
+	ldns_rdf *rdf = NULL;
+	ldns_status status;
+
+	status = ldns_wire2dname(&rdf, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	rr->_rdata_fields[rr->_rd_count++] = rdf;
+	return LDNS_STATUS_OK;
+}
+
+static ldns_status
+ldns_rr_codec_read_int16_data(ldns_rr *rr, const uint8_t *wire, size_t *pos,
+		size_t end)
+{
+	if (*pos + 2 > end) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	return ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16_DATA,
+			(size_t)ldns_read_uint16(&wire[*pos]) + 2, wire, pos, end);
+}
+
+/* Writes a rdf, for which room is reserved */
+static void
+ldns_rr_codec_write(ldns_buffer *buffer, const ldns_rdf *rdf)
+{
+	ldns_buffer_write(buffer, rdf->_data, rdf->_size);
+}
+
+/* Writes a name lowercased, for which room is reserved */
+static void
+ldns_rr_codec_write_lower(ldns_buffer *buffer, const ldns_rdf *rdf)
+{
+	const uint8_t *data = rdf->_data;
+	uint8_t *out = ldns_buffer_current(buffer);
+	size_t i;
+
+	for (i = 0; i < rdf->_size; i++) {
+		out[i] = (uint8_t) LDNS_DNAME_NORMALIZE((int)data[i]);
+	}
+	ldns_buffer_skip(buffer, (ssize_t)rdf->_size);
+}
+
+/* Compares two rdfs as they are in the canonical form: -1 or 1 when they
+ * differ, 0 when they are the same, or LDNS_RR_CODEC_CMP_SIZE when the
+ * shorter one is the start of the other one */
+static int
+ldns_rr_codec_cmp(const ldns_rdf *rdf1, const ldns_rdf *rdf2, bool lower)
+{
+	const uint8_t *data1 = rdf1->_data;
+	const uint8_t *data2 = rdf2->_data;
+	size_t size1 = rdf1->_size;
+	size_t size2 = rdf2->_size;
+	size_t i, n = size1 < size2 ? size1 : size2;
+	int c;
+
+	if (!lower) {
+		c = n ? memcmp(data1, data2, n) : 0;
+		if (c != 0) {
+			return c < 0 ? -1 : 1;
+		}
+	} else {
+		for (i = 0; i < n; i++) {
+			uint8_t b1 = (uint8_t) LDNS_DNAME_NORMALIZE((int)data1[i]);
+			uint8_t b2 = (uint8_t) LDNS_DNAME_NORMALIZE((int)data2[i]);
+
+			if (b1 != b2) {
+				return b1 < b2 ? -1 : 1;
+			}
+		}
+	}
+	return size1 == size2 ? 0 : LDNS_RR_CODEC_CMP_SIZE;
+}
+
+/* A */
+static ldns_status
+ldns_rr_codec_a_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_A, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_a_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_a_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_a = {
+	false,
+	ldns_rr_codec_a_wire2rdf,
+	ldns_rr_codec_a_rdata2wire,
+	ldns_rr_codec_a_rdata2wire,
+	ldns_rr_codec_a_compare
+};
+
+/* DNAME, names lowercased */
+static ldns_status
+ldns_rr_codec_ns_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_ns_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_ns_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (f[0]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write_lower(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_ns_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	if (f1[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[0]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_ns = {
+	true,
+	ldns_rr_codec_ns_wire2rdf,
+	ldns_rr_codec_ns_rdata2wire,
+	ldns_rr_codec_ns_canonical,
+	ldns_rr_codec_ns_compare
+};
+
+/* DNAME DNAME INT32 PERIOD PERIOD PERIOD PERIOD, names lowercased */
+static ldns_status
+ldns_rr_codec_soa_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 7)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT32, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_PERIOD, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_PERIOD, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_PERIOD, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_PERIOD, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_soa_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 7) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size + f[6]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+		ldns_rr_codec_write(buffer, f[6]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_soa_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 7) {
+		return false;
+	}
+	if (f[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f[1]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size + f[6]->_size)) {
+		ldns_rr_codec_write_lower(buffer, f[0]);
+		ldns_rr_codec_write_lower(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+		ldns_rr_codec_write(buffer, f[6]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_soa_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 7 || rr2->_rd_count != 7) {
+		return false;
+	}
+	if (f1[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f1[1]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[1]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[4], f2[4], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[5], f2[5], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[6], f2[6], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[6]->_size < f2[6]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_soa = {
+	true,
+	ldns_rr_codec_soa_wire2rdf,
+	ldns_rr_codec_soa_rdata2wire,
+	ldns_rr_codec_soa_canonical,
+	ldns_rr_codec_soa_compare
+};
+
+/* A WKS */
+static ldns_status
+ldns_rr_codec_wks_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_A, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_WKS, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_wks_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_wks_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_wks = {
+	false,
+	ldns_rr_codec_wks_wire2rdf,
+	ldns_rr_codec_wks_rdata2wire,
+	ldns_rr_codec_wks_rdata2wire,
+	ldns_rr_codec_wks_compare
+};
+
+/* STR STR, names lowercased */
+static ldns_status
+ldns_rr_codec_hinfo_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_hinfo_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_hinfo_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_hinfo_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_hinfo = {
+	true,
+	ldns_rr_codec_hinfo_wire2rdf,
+	ldns_rr_codec_hinfo_rdata2wire,
+	ldns_rr_codec_hinfo_canonical,
+	ldns_rr_codec_hinfo_compare
+};
+
+/* DNAME DNAME, names lowercased */
+static ldns_status
+ldns_rr_codec_minfo_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_minfo_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_minfo_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (f[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f[1]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write_lower(buffer, f[0]);
+		ldns_rr_codec_write_lower(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_minfo_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	if (f1[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f1[1]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[1]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_minfo = {
+	true,
+	ldns_rr_codec_minfo_wire2rdf,
+	ldns_rr_codec_minfo_rdata2wire,
+	ldns_rr_codec_minfo_canonical,
+	ldns_rr_codec_minfo_compare
+};
+
+/* INT16 DNAME, names lowercased */
+static ldns_status
+ldns_rr_codec_mx_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_mx_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_mx_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (f[1]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write_lower(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_mx_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	if (f1[1]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[1]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_mx = {
+	true,
+	ldns_rr_codec_mx_wire2rdf,
+	ldns_rr_codec_mx_rdata2wire,
+	ldns_rr_codec_mx_canonical,
+	ldns_rr_codec_mx_compare
+};
+
+/* STR */
+static ldns_status
+ldns_rr_codec_x25_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_x25_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_x25_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_x25 = {
+	false,
+	ldns_rr_codec_x25_wire2rdf,
+	ldns_rr_codec_x25_rdata2wire,
+	ldns_rr_codec_x25_rdata2wire,
+	ldns_rr_codec_x25_compare
+};
+
+/* STR STR */
+static ldns_status
+ldns_rr_codec_isdn_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_isdn_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_isdn_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_isdn = {
+	false,
+	ldns_rr_codec_isdn_wire2rdf,
+	ldns_rr_codec_isdn_rdata2wire,
+	ldns_rr_codec_isdn_rdata2wire,
+	ldns_rr_codec_isdn_compare
+};
+
+/* NSAP */
+static ldns_status
+ldns_rr_codec_nsap_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_NSAP, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_nsap_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_nsap_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_nsap = {
+	false,
+	ldns_rr_codec_nsap_wire2rdf,
+	ldns_rr_codec_nsap_rdata2wire,
+	ldns_rr_codec_nsap_rdata2wire,
+	ldns_rr_codec_nsap_compare
+};
+
+/* TYPE ALG INT8 INT32 TIME TIME INT16 DNAME B64, names lowercased */
+static ldns_status
+ldns_rr_codec_sig_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 9)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_TYPE, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_ALG, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT32, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_TIME, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_TIME, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_B64, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_sig_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 9) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size + f[6]->_size + f[7]->_size + f[8]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+		ldns_rr_codec_write(buffer, f[6]);
+		ldns_rr_codec_write(buffer, f[7]);
+		ldns_rr_codec_write(buffer, f[8]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_sig_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 9) {
+		return false;
+	}
+	if (f[7]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size + f[6]->_size + f[7]->_size + f[8]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+		ldns_rr_codec_write(buffer, f[6]);
+		ldns_rr_codec_write_lower(buffer, f[7]);
+		ldns_rr_codec_write(buffer, f[8]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_sig_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 9 || rr2->_rd_count != 9) {
+		return false;
+	}
+	if (f1[7]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[7]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[4], f2[4], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[5], f2[5], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[6], f2[6], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[7], f2[7], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[8], f2[8], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[8]->_size < f2[8]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_sig = {
+	true,
+	ldns_rr_codec_sig_wire2rdf,
+	ldns_rr_codec_sig_rdata2wire,
+	ldns_rr_codec_sig_canonical,
+	ldns_rr_codec_sig_compare
+};
+
+/* INT16 INT8 INT8 B64 */
+static ldns_status
+ldns_rr_codec_key_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_B64, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_key_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_key_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_key = {
+	false,
+	ldns_rr_codec_key_wire2rdf,
+	ldns_rr_codec_key_rdata2wire,
+	ldns_rr_codec_key_rdata2wire,
+	ldns_rr_codec_key_compare
+};
+
+/* INT16 DNAME DNAME, names lowercased */
+static ldns_status
+ldns_rr_codec_px_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 3)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_px_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_px_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (f[1]->_type != LDNS_RDF_TYPE_DNAME
+	||  f[2]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write_lower(buffer, f[1]);
+		ldns_rr_codec_write_lower(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_px_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 3 || rr2->_rd_count != 3) {
+		return false;
+	}
+	if (f1[1]->_type != LDNS_RDF_TYPE_DNAME
+	||  f1[2]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[1]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[2]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[2]->_size < f2[2]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_px = {
+	true,
+	ldns_rr_codec_px_wire2rdf,
+	ldns_rr_codec_px_rdata2wire,
+	ldns_rr_codec_px_canonical,
+	ldns_rr_codec_px_compare
+};
+
+/* STR STR STR */
+static ldns_status
+ldns_rr_codec_gpos_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 3)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_gpos_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_gpos_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 3 || rr2->_rd_count != 3) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[2]->_size < f2[2]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_gpos = {
+	false,
+	ldns_rr_codec_gpos_wire2rdf,
+	ldns_rr_codec_gpos_rdata2wire,
+	ldns_rr_codec_gpos_rdata2wire,
+	ldns_rr_codec_gpos_compare
+};
+
+/* AAAA */
+static ldns_status
+ldns_rr_codec_aaaa_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_AAAA, 16,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_aaaa_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_aaaa_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_aaaa = {
+	false,
+	ldns_rr_codec_aaaa_wire2rdf,
+	ldns_rr_codec_aaaa_rdata2wire,
+	ldns_rr_codec_aaaa_rdata2wire,
+	ldns_rr_codec_aaaa_compare
+};
+
+/* LOC */
+static ldns_status
+ldns_rr_codec_loc_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_LOC, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_loc_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_loc_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_loc = {
+	false,
+	ldns_rr_codec_loc_wire2rdf,
+	ldns_rr_codec_loc_rdata2wire,
+	ldns_rr_codec_loc_rdata2wire,
+	ldns_rr_codec_loc_compare
+};
+
+/* DNAME UNKNOWN, names lowercased */
+static ldns_status
+ldns_rr_codec_nxt_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_UNKNOWN, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_nxt_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_nxt_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (f[0]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write_lower(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_nxt_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	if (f1[0]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[0]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_nxt = {
+	true,
+	ldns_rr_codec_nxt_wire2rdf,
+	ldns_rr_codec_nxt_rdata2wire,
+	ldns_rr_codec_nxt_canonical,
+	ldns_rr_codec_nxt_compare
+};
+
+/* HEX */
+static ldns_status
+ldns_rr_codec_eid_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_HEX, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_eid_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_eid_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_eid = {
+	false,
+	ldns_rr_codec_eid_wire2rdf,
+	ldns_rr_codec_eid_rdata2wire,
+	ldns_rr_codec_eid_rdata2wire,
+	ldns_rr_codec_eid_compare
+};
+
+/* INT16 INT16 INT16 DNAME, names lowercased */
+static ldns_status
+ldns_rr_codec_srv_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_srv_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_srv_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (f[3]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write_lower(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_srv_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	if (f1[3]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[3]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_srv = {
+	true,
+	ldns_rr_codec_srv_wire2rdf,
+	ldns_rr_codec_srv_rdata2wire,
+	ldns_rr_codec_srv_canonical,
+	ldns_rr_codec_srv_compare
+};
+
+/* ATMA */
+static ldns_status
+ldns_rr_codec_atma_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_ATMA, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_atma_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_atma_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_atma = {
+	false,
+	ldns_rr_codec_atma_wire2rdf,
+	ldns_rr_codec_atma_rdata2wire,
+	ldns_rr_codec_atma_rdata2wire,
+	ldns_rr_codec_atma_compare
+};
+
+/* INT16 INT16 STR STR STR DNAME, names lowercased */
+static ldns_status
+ldns_rr_codec_naptr_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 6)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_naptr_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 6) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_naptr_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 6) {
+		return false;
+	}
+	if (f[5]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write_lower(buffer, f[5]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_naptr_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 6 || rr2->_rd_count != 6) {
+		return false;
+	}
+	if (f1[5]->_type != LDNS_RDF_TYPE_DNAME
+	||  f2[5]->_type != LDNS_RDF_TYPE_DNAME) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[4], f2[4], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[5], f2[5], true);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[5]->_size < f2[5]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_naptr = {
+	true,
+	ldns_rr_codec_naptr_wire2rdf,
+	ldns_rr_codec_naptr_rdata2wire,
+	ldns_rr_codec_naptr_canonical,
+	ldns_rr_codec_naptr_compare
+};
+
+/* CERT_ALG INT16 ALG B64 */
+static ldns_status
+ldns_rr_codec_cert_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_CERT_ALG, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_ALG, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_B64, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_cert_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_cert_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_cert = {
+	false,
+	ldns_rr_codec_cert_wire2rdf,
+	ldns_rr_codec_cert_rdata2wire,
+	ldns_rr_codec_cert_rdata2wire,
+	ldns_rr_codec_cert_compare
+};
+
+/* UNKNOWN, names lowercased */
+static ldns_status
+ldns_rr_codec_a6_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_UNKNOWN, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_a6_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_a6_canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_a6_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_a6 = {
+	true,
+	ldns_rr_codec_a6_wire2rdf,
+	ldns_rr_codec_a6_rdata2wire,
+	ldns_rr_codec_a6_canonical,
+	ldns_rr_codec_a6_compare
+};
+
+/* INT8 */
+static ldns_status
+ldns_rr_codec_sink_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_sink_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_sink_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_sink = {
+	false,
+	ldns_rr_codec_sink_wire2rdf,
+	ldns_rr_codec_sink_rdata2wire,
+	ldns_rr_codec_sink_rdata2wire,
+	ldns_rr_codec_sink_compare
+};
+
+/* UNKNOWN */
+static ldns_status
+ldns_rr_codec_opt_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_UNKNOWN, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_opt_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_opt_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_opt = {
+	false,
+	ldns_rr_codec_opt_wire2rdf,
+	ldns_rr_codec_opt_rdata2wire,
+	ldns_rr_codec_opt_rdata2wire,
+	ldns_rr_codec_opt_compare
+};
+
+/* INT16 ALG INT8 HEX */
+static ldns_status
+ldns_rr_codec_ds_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_ALG, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_HEX, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_ds_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_ds_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_ds = {
+	false,
+	ldns_rr_codec_ds_wire2rdf,
+	ldns_rr_codec_ds_rdata2wire,
+	ldns_rr_codec_ds_rdata2wire,
+	ldns_rr_codec_ds_compare
+};
+
+/* INT8 INT8 HEX */
+static ldns_status
+ldns_rr_codec_sshfp_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 3)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_HEX, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_sshfp_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_sshfp_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 3 || rr2->_rd_count != 3) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[2]->_size < f2[2]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_sshfp = {
+	false,
+	ldns_rr_codec_sshfp_wire2rdf,
+	ldns_rr_codec_sshfp_rdata2wire,
+	ldns_rr_codec_sshfp_rdata2wire,
+	ldns_rr_codec_sshfp_compare
+};
+
+/* IPSECKEY */
+static ldns_status
+ldns_rr_codec_ipseckey_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_IPSECKEY, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_ipseckey_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_ipseckey_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_ipseckey = {
+	false,
+	ldns_rr_codec_ipseckey_wire2rdf,
+	ldns_rr_codec_ipseckey_rdata2wire,
+	ldns_rr_codec_ipseckey_rdata2wire,
+	ldns_rr_codec_ipseckey_compare
+};
+
+/* DNAME NSEC */
+static ldns_status
+ldns_rr_codec_nsec_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_NSEC, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_nsec_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_nsec_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_nsec = {
+	false,
+	ldns_rr_codec_nsec_wire2rdf,
+	ldns_rr_codec_nsec_rdata2wire,
+	ldns_rr_codec_nsec_rdata2wire,
+	ldns_rr_codec_nsec_compare
+};
+
+/* INT16 INT8 ALG B64 */
+static ldns_status
+ldns_rr_codec_dnskey_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_ALG, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_B64, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_dnskey_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_dnskey_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_dnskey = {
+	false,
+	ldns_rr_codec_dnskey_wire2rdf,
+	ldns_rr_codec_dnskey_rdata2wire,
+	ldns_rr_codec_dnskey_rdata2wire,
+	ldns_rr_codec_dnskey_compare
+};
+
+/* B64 */
+static ldns_status
+ldns_rr_codec_dhcid_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_B64, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_dhcid_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_dhcid_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_dhcid = {
+	false,
+	ldns_rr_codec_dhcid_wire2rdf,
+	ldns_rr_codec_dhcid_rdata2wire,
+	ldns_rr_codec_dhcid_rdata2wire,
+	ldns_rr_codec_dhcid_compare
+};
+
+/* INT8 INT8 INT16 NSEC3_SALT NSEC3_NEXT_OWNER NSEC */
+static ldns_status
+ldns_rr_codec_nsec3_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 6)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_NSEC3_SALT,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_NSEC3_NEXT_OWNER,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_NSEC, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_nsec3_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 6) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_nsec3_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 6 || rr2->_rd_count != 6) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[4], f2[4], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[5], f2[5], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[5]->_size < f2[5]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_nsec3 = {
+	false,
+	ldns_rr_codec_nsec3_wire2rdf,
+	ldns_rr_codec_nsec3_rdata2wire,
+	ldns_rr_codec_nsec3_rdata2wire,
+	ldns_rr_codec_nsec3_compare
+};
+
+/* INT8 INT8 INT16 NSEC3_SALT */
+static ldns_status
+ldns_rr_codec_nsec3param_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_NSEC3_SALT,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_nsec3param_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_nsec3param_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_nsec3param = {
+	false,
+	ldns_rr_codec_nsec3param_wire2rdf,
+	ldns_rr_codec_nsec3param_rdata2wire,
+	ldns_rr_codec_nsec3param_rdata2wire,
+	ldns_rr_codec_nsec3param_compare
+};
+
+/* CERTIFICATE_USAGE SELECTOR MATCHING_TYPE HEX */
+static ldns_status
+ldns_rr_codec_tlsa_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_CERTIFICATE_USAGE, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_SELECTOR, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_MATCHING_TYPE, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_HEX, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_tlsa_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_tlsa_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_tlsa = {
+	false,
+	ldns_rr_codec_tlsa_wire2rdf,
+	ldns_rr_codec_tlsa_rdata2wire,
+	ldns_rr_codec_tlsa_rdata2wire,
+	ldns_rr_codec_tlsa_compare
+};
+
+/* DNAME DNAME */
+static ldns_status
+ldns_rr_codec_talink_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_talink_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_talink_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_talink = {
+	false,
+	ldns_rr_codec_talink_wire2rdf,
+	ldns_rr_codec_talink_rdata2wire,
+	ldns_rr_codec_talink_rdata2wire,
+	ldns_rr_codec_talink_compare
+};
+
+/* INT32 INT16 NSEC */
+static ldns_status
+ldns_rr_codec_csync_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 3)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT32, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_NSEC, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_csync_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_csync_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 3 || rr2->_rd_count != 3) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[2]->_size < f2[2]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_csync = {
+	false,
+	ldns_rr_codec_csync_wire2rdf,
+	ldns_rr_codec_csync_rdata2wire,
+	ldns_rr_codec_csync_rdata2wire,
+	ldns_rr_codec_csync_compare
+};
+
+/* INT32 INT8 INT8 HEX */
+static ldns_status
+ldns_rr_codec_zonemd_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT32, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_HEX, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_zonemd_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 4) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_zonemd_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 4 || rr2->_rd_count != 4) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[3]->_size < f2[3]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_zonemd = {
+	false,
+	ldns_rr_codec_zonemd_wire2rdf,
+	ldns_rr_codec_zonemd_rdata2wire,
+	ldns_rr_codec_zonemd_rdata2wire,
+	ldns_rr_codec_zonemd_compare
+};
+
+#ifdef RRTYPE_SVCB_HTTPS
+/* INT16 DNAME SVCPARAMS */
+static ldns_status
+ldns_rr_codec_svcb_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 3)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_SVCPARAMS, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_svcb_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_svcb_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 3 || rr2->_rd_count != 3) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[2]->_size < f2[2]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_svcb = {
+	false,
+	ldns_rr_codec_svcb_wire2rdf,
+	ldns_rr_codec_svcb_rdata2wire,
+	ldns_rr_codec_svcb_rdata2wire,
+	ldns_rr_codec_svcb_compare
+};
+#endif
+
+/* INT16 ILNP64 */
+static ldns_status
+ldns_rr_codec_nid_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_ILNP64, 8,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_nid_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_nid_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_nid = {
+	false,
+	ldns_rr_codec_nid_wire2rdf,
+	ldns_rr_codec_nid_rdata2wire,
+	ldns_rr_codec_nid_rdata2wire,
+	ldns_rr_codec_nid_compare
+};
+
+/* INT16 A */
+static ldns_status
+ldns_rr_codec_l32_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_A, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_l32_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_l32_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_l32 = {
+	false,
+	ldns_rr_codec_l32_wire2rdf,
+	ldns_rr_codec_l32_rdata2wire,
+	ldns_rr_codec_l32_rdata2wire,
+	ldns_rr_codec_l32_compare
+};
+
+/* INT16 DNAME */
+static ldns_status
+ldns_rr_codec_lp_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 2)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_lp_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 2) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_lp_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 2 || rr2->_rd_count != 2) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[1]->_size < f2[1]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_lp = {
+	false,
+	ldns_rr_codec_lp_wire2rdf,
+	ldns_rr_codec_lp_rdata2wire,
+	ldns_rr_codec_lp_rdata2wire,
+	ldns_rr_codec_lp_compare
+};
+
+/* EUI48 */
+static ldns_status
+ldns_rr_codec_eui48_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_EUI48, 6,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_eui48_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_eui48_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_eui48 = {
+	false,
+	ldns_rr_codec_eui48_wire2rdf,
+	ldns_rr_codec_eui48_rdata2wire,
+	ldns_rr_codec_eui48_rdata2wire,
+	ldns_rr_codec_eui48_compare
+};
+
+/* EUI64 */
+static ldns_status
+ldns_rr_codec_eui64_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_EUI64, 8,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_eui64_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_eui64_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_eui64 = {
+	false,
+	ldns_rr_codec_eui64_wire2rdf,
+	ldns_rr_codec_eui64_rdata2wire,
+	ldns_rr_codec_eui64_rdata2wire,
+	ldns_rr_codec_eui64_compare
+};
+
+/* DNAME TIME TIME INT16 INT16 INT16_DATA INT16_DATA */
+static ldns_status
+ldns_rr_codec_tkey_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 7)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_TIME, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_TIME, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_int16_data(rr, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_int16_data(rr, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_tkey_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 7) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size + f[6]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+		ldns_rr_codec_write(buffer, f[6]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_tkey_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 7 || rr2->_rd_count != 7) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[4], f2[4], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[5], f2[5], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[6], f2[6], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[6]->_size < f2[6]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_tkey = {
+	false,
+	ldns_rr_codec_tkey_wire2rdf,
+	ldns_rr_codec_tkey_rdata2wire,
+	ldns_rr_codec_tkey_rdata2wire,
+	ldns_rr_codec_tkey_compare
+};
+
+/* DNAME TSIGTIME INT16 INT16_DATA INT16 INT16 INT16_DATA */
+static ldns_status
+ldns_rr_codec_tsig_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 7)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_dname(rr, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_TSIGTIME, 6,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_int16_data(rr, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read_int16_data(rr, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_tsig_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 7) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size + f[5]->_size + f[6]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+		ldns_rr_codec_write(buffer, f[5]);
+		ldns_rr_codec_write(buffer, f[6]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_tsig_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 7 || rr2->_rd_count != 7) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[4], f2[4], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[5], f2[5], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[6], f2[6], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[6]->_size < f2[6]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_tsig = {
+	false,
+	ldns_rr_codec_tsig_wire2rdf,
+	ldns_rr_codec_tsig_rdata2wire,
+	ldns_rr_codec_tsig_rdata2wire,
+	ldns_rr_codec_tsig_compare
+};
+
+/* INT16 INT16 LONG_STR */
+static ldns_status
+ldns_rr_codec_uri_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 3)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16, 2,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_LONG_STR, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_uri_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_uri_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 3 || rr2->_rd_count != 3) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[2]->_size < f2[2]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_uri = {
+	false,
+	ldns_rr_codec_uri_wire2rdf,
+	ldns_rr_codec_uri_rdata2wire,
+	ldns_rr_codec_uri_rdata2wire,
+	ldns_rr_codec_uri_compare
+};
+
+/* INT8 TAG LONG_STR */
+static ldns_status
+ldns_rr_codec_caa_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 3)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_TAG,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_LONG_STR, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_caa_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 3) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_caa_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 3 || rr2->_rd_count != 3) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[2]->_size < f2[2]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_caa = {
+	false,
+	ldns_rr_codec_caa_wire2rdf,
+	ldns_rr_codec_caa_rdata2wire,
+	ldns_rr_codec_caa_rdata2wire,
+	ldns_rr_codec_caa_compare
+};
+
+#ifdef RRTYPE_DOA
+/* INT32 INT32 INT8 STR B64 */
+static ldns_status
+ldns_rr_codec_doa_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 5)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT32, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT32, 4,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT8, 1,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_STR,
+			(size_t)wire[*pos] + 1, wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_B64, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_doa_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 5) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size + f[1]->_size + f[2]->_size + f[3]->_size + f[4]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+		ldns_rr_codec_write(buffer, f[1]);
+		ldns_rr_codec_write(buffer, f[2]);
+		ldns_rr_codec_write(buffer, f[3]);
+		ldns_rr_codec_write(buffer, f[4]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_doa_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 5 || rr2->_rd_count != 5) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[1], f2[1], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[2], f2[2], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[3], f2[3], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		return false;
+	} else if (c != 0) {
+		*result = c;
+		return true;
+	}
+	c = ldns_rr_codec_cmp(f1[4], f2[4], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[4]->_size < f2[4]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_doa = {
+	false,
+	ldns_rr_codec_doa_wire2rdf,
+	ldns_rr_codec_doa_rdata2wire,
+	ldns_rr_codec_doa_rdata2wire,
+	ldns_rr_codec_doa_compare
+};
+#endif
+
+#ifdef RRTYPE_AMTRELAY
+/* AMTRELAY */
+static ldns_status
+ldns_rr_codec_amtrelay_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos, size_t end)
+{
+	ldns_status status;
+
+	if (*pos < end && !ldns_rr_codec_grow(rr, 1)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (*pos >= end) {
+		return LDNS_STATUS_OK;
+	}
+	status = ldns_rr_codec_read(rr, LDNS_RDF_TYPE_AMTRELAY, end - *pos,
+			wire, pos, end);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	(void) max;
+	return LDNS_STATUS_OK;
+}
+
+static bool
+ldns_rr_codec_amtrelay_rdata2wire(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	ldns_rdf *const *f = rr->_rdata_fields;
+
+	if (rr->_rd_count != 1) {
+		return false;
+	}
+	if (ldns_buffer_reserve(buffer, f[0]->_size)) {
+		ldns_rr_codec_write(buffer, f[0]);
+	}
+	return true;
+}
+
+static bool
+ldns_rr_codec_amtrelay_compare(const ldns_rr *rr1, const ldns_rr *rr2, int *result)
+{
+	ldns_rdf *const *f1 = rr1->_rdata_fields;
+	ldns_rdf *const *f2 = rr2->_rdata_fields;
+	int c;
+
+	if (rr1->_rd_count != 1 || rr2->_rd_count != 1) {
+		return false;
+	}
+	c = ldns_rr_codec_cmp(f1[0], f2[0], false);
+	if (c == LDNS_RR_CODEC_CMP_SIZE) {
+		c = f1[0]->_size < f2[0]->_size ? -1 : 1;
+	}
+	*result = c;
+	return true;
+}
+
+static const ldns_rr_codec ldns_rr_codec_amtrelay = {
+	false,
+	ldns_rr_codec_amtrelay_wire2rdf,
+	ldns_rr_codec_amtrelay_rdata2wire,
+	ldns_rr_codec_amtrelay_rdata2wire,
+	ldns_rr_codec_amtrelay_compare
+};
+#endif
+
+static const ldns_rr_codec *const ldns_rr_codecs[256] = {
+	NULL,
+	&ldns_rr_codec_a,	/* A */
+	&ldns_rr_codec_ns,	/* NS */
+	&ldns_rr_codec_ns,	/* MD */
+	&ldns_rr_codec_ns,	/* MF */
+	&ldns_rr_codec_ns,	/* CNAME */
+	&ldns_rr_codec_soa,	/* SOA */
+	&ldns_rr_codec_ns,	/* MB */
+	&ldns_rr_codec_ns,	/* MG */
+	&ldns_rr_codec_ns,	/* MR */
+	NULL,
+	&ldns_rr_codec_wks,	/* WKS */
+	&ldns_rr_codec_ns,	/* PTR */
+	&ldns_rr_codec_hinfo,	/* HINFO */
+	&ldns_rr_codec_minfo,	/* MINFO */
+	&ldns_rr_codec_mx,	/* MX */
+	NULL,
+	&ldns_rr_codec_minfo,	/* RP */
+	&ldns_rr_codec_mx,	/* AFSDB */
+	&ldns_rr_codec_x25,	/* X25 */
+	&ldns_rr_codec_isdn,	/* ISDN */
+	&ldns_rr_codec_mx,	/* RT */
+	&ldns_rr_codec_nsap,	/* NSAP */
+	&ldns_rr_codec_x25,	/* NSAP_PTR */
+	&ldns_rr_codec_sig,	/* SIG */
+	&ldns_rr_codec_key,	/* KEY */
+	&ldns_rr_codec_px,	/* PX */
+	&ldns_rr_codec_gpos,	/* GPOS */
+	&ldns_rr_codec_aaaa,	/* AAAA */
+	&ldns_rr_codec_loc,	/* LOC */
+	&ldns_rr_codec_nxt,	/* NXT */
+	&ldns_rr_codec_eid,	/* EID */
+	&ldns_rr_codec_eid,	/* NIMLOC */
+	&ldns_rr_codec_srv,	/* SRV */
+	&ldns_rr_codec_atma,	/* ATMA */
+	&ldns_rr_codec_naptr,	/* NAPTR */
+	&ldns_rr_codec_mx,	/* KX */
+	&ldns_rr_codec_cert,	/* CERT */
+	&ldns_rr_codec_a6,	/* A6 */
+	&ldns_rr_codec_ns,	/* DNAME */
+	&ldns_rr_codec_sink,	/* SINK */
+	&ldns_rr_codec_opt,	/* OPT */
+	NULL,
+	&ldns_rr_codec_ds,	/* DS */
+	&ldns_rr_codec_sshfp,	/* SSHFP */
+	&ldns_rr_codec_ipseckey,	/* IPSECKEY */
+	&ldns_rr_codec_sig,	/* RRSIG */
+	&ldns_rr_codec_nsec,	/* NSEC */
+	&ldns_rr_codec_dnskey,	/* DNSKEY */
+	&ldns_rr_codec_dhcid,	/* DHCID */
+	&ldns_rr_codec_nsec3,	/* NSEC3 */
+	&ldns_rr_codec_nsec3param,	/* NSEC3PARAM */
+	&ldns_rr_codec_tlsa,	/* TLSA */
+	&ldns_rr_codec_tlsa,	/* SMIMEA */
+	NULL,
+	NULL,
+	NULL,
+#ifdef RRTYPE_RKEY
+	&ldns_rr_codec_key,	/* RKEY */
+#else
+	NULL,
+#endif
+	&ldns_rr_codec_talink,	/* TALINK */
+	&ldns_rr_codec_ds,	/* CDS */
+	&ldns_rr_codec_dnskey,	/* CDNSKEY */
+#ifdef RRTYPE_OPENPGPKEY
+	&ldns_rr_codec_dhcid,	/* OPENPGPKEY */
+#else
+	NULL,
+#endif
+	&ldns_rr_codec_csync,	/* CSYNC */
+	&ldns_rr_codec_zonemd,	/* ZONEMD */
+#ifdef RRTYPE_SVCB_HTTPS
+	&ldns_rr_codec_svcb,	/* SVCB */
+#else
+	NULL,
+#endif
+#ifdef RRTYPE_SVCB_HTTPS
+	&ldns_rr_codec_svcb,	/* HTTPS */
+#else
+	NULL,
+#endif
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	&ldns_rr_codec_nid,	/* NID */
+	&ldns_rr_codec_l32,	/* L32 */
+	&ldns_rr_codec_nid,	/* L64 */
+	&ldns_rr_codec_lp,	/* LP */
+	&ldns_rr_codec_eui48,	/* EUI48 */
+	&ldns_rr_codec_eui64,	/* EUI64 */
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	&ldns_rr_codec_opt,	/* NXNAME */
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	&ldns_rr_codec_tkey,	/* TKEY */
+	&ldns_rr_codec_tsig,	/* TSIG */
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+};
+
+const ldns_rr_codec *
+ldns_rr_codec_get(ldns_rr_type type)
+{
+	if ((int)type < 256) {
+		return ldns_rr_codecs[type];
+	}
+	switch (type) {
+	case LDNS_RR_TYPE_URI:
+		return &ldns_rr_codec_uri;
+	case LDNS_RR_TYPE_CAA:
+		return &ldns_rr_codec_caa;
+#ifdef RRTYPE_DOA
+	case LDNS_RR_TYPE_DOA:
+		return &ldns_rr_codec_doa;
+#endif
+#ifdef RRTYPE_AMTRELAY
+	case LDNS_RR_TYPE_AMTRELAY:
+		return &ldns_rr_codec_amtrelay;
+#endif
+#ifdef RRTYPE_TA
+	case LDNS_RR_TYPE_TA:
+		return &ldns_rr_codec_ds;
+#endif
+	case LDNS_RR_TYPE_DLV:
+		return &ldns_rr_codec_ds;
+	default:
+		return NULL;
+	}
+}
@@ -0,0 +1,464 @@
+#!/usr/bin/env perl
+#
+# rr_codec.pl -- generates rr_codec.c from the rdata field descriptors
+#
+# Copyright (c) 2024, NLnet Labs. All rights reserved.
+#
+# See LICENSE for the license.
+#
+# Reads the type_*_wireformat arrays and the rdata_field_descriptors table
+# of rr.c, and writes C code with a decoder, an encoder, a canonical
+# encoder and a compare function for every RR type with a fixed list of
+# rdata fields.  Run "make rr-codec" after changing the table in rr.c.
+#
+# usage: rr_codec.pl rr.c > rr_codec.c  (with ldns/rr.h next to rr.c)
+
+use strict;
+use warnings;
+
+# Types of which the names in the rdata are lowercased in the canonical
+# form (RFC 4034 section 6.2, RFC 6840 section 5.1)
+my %lowercase = map { $_ => 1 } qw(
+	NS MD MF CNAME SOA MB MG MR PTR HINFO MINFO MX RP AFSDB RT SIG PX NXT
+	NAPTR KX SRV DNAME A6 RRSIG
+);
+
+# Length of the rdf types with a fixed length, as in ldns_wire2rdf()
+my %fixed = (
+	CLASS => 1, ALG => 1, CERTIFICATE_USAGE => 1, SELECTOR => 1,
+	MATCHING_TYPE => 1, INT8 => 1,
+	TYPE => 2, INT16 => 2, CERT_ALG => 2,
+	TIME => 4, INT32 => 4, A => 4, PERIOD => 4,
+	TSIGTIME => 6, EUI48 => 6,
+	ILNP64 => 8, EUI64 => 8,
+	AAAA => 16
+);
+# Rdf types with their length in the first byte
+my %counted = map { $_ => 1 } qw(STR NSEC3_SALT TAG B32_EXT NSEC3_NEXT_OWNER);
+# Rdf types that take the rest of the rdata
+my %rest = map { $_ => 1 } qw(
+	APL B64 HEX NSEC UNKNOWN SERVICE LOC WKS NSAP ATMA IPSECKEY LONG_STR
+	AMTRELAY SVCPARAMS NONE
+);
+
+my $file = shift or die "usage: $0 rr.c\n";
+open(my $in, '<', $file) or die "$file: $!\n";
+my $src = do { local $/; <$in> };
+close($in);
+$src =~ s{/\*.*?\*/}{}gs;
+
+my (%wireformat, @types, @cond);
+my ($array, $in_table);
+for my $line (split /\n/, $src) {
+	if ($line =~ /^#\s*ifdef\s+(\w+)/) {
+		push @cond, $1;
+		next;
+	} elsif ($line =~ /^#\s*else/) {
+		$cond[-1] = "!$cond[-1]";
+		next;
+	} elsif ($line =~ /^#\s*endif/) {
+		pop @cond;
+		next;
+	}
+	if ($line =~ /static const ldns_rdf_type (\w+)\[\]\s*=\s*\{(.*)$/) {
+		($array, $line) = ($1, $2);
+		$wireformat{$array} = [];
+	}
+	if (defined $array) {
+		push @{$wireformat{$array}}, $line =~ /LDNS_RDF_TYPE_(\w+)/g;
+		undef $array if $line =~ /\}/;
+		next;
+	}
+	if ($line =~ /rdata_field_descriptors\[\]\s*=/) {
+		$in_table = 1;
+	} elsif ($in_table && $line =~ /^\};/) {
+		last;
+	} elsif ($in_table && $line =~ /\{\s*LDNS_RR_TYPE_(\w+)\s*,\s*"[^"]*"\s*,\s*(\d+)\s*,\s*(\d+)\s*,\s*(\w+)\s*,\s*LDNS_RDF_TYPE_(\w+)/) {
+		my ($type, $max, $fields, $variable) = ($1, $3, $4, $5);
+
+		next if $type eq 'NULL' || $variable ne 'NONE';
+		die "$type: no $fields\n" unless $wireformat{$fields};
+		die "$type: less than $max fields in $fields\n"
+			if $max > @{$wireformat{$fields}};
+		# ldns_wire2rdf() reads up to max fields
+		push @types, {
+			type => $type,
+			fields => $fields,
+			max => $max,
+			lower => $lowercase{$type} ? 1 : 0,
+			cond => [@cond]
+		};
+	}
+}
+die "$file: no rdata_field_descriptors\n" unless @types;
+
+# The numbers of the types are in ldns/rr.h next to rr.c
+(my $header = $file) =~ s{[^/]*$}{ldns/rr.h};
+open($in, '<', $header) or die "$header: $!\n";
+my $rr_h = do { local $/; <$in> };
+close($in);
+$rr_h =~ s{/\*.*?\*/}{}gs;
+my %number = $rr_h =~ /LDNS_RR_TYPE_(\w+)\s*=\s*(\d+)/g;
+for my $t (@types) {
+	die "$t->{type}: no number in $header\n"
+		unless defined $number{$t->{type}};
+	$t->{number} = $number{$t->{type}};
+}
+for my $type (keys %lowercase) {
+	die "$type: no fixed list of rdata fields\n"
+		unless grep { $_->{type} eq $type } @types;
+}
+
+# The functions are made once for each list of fields, and named after
+# the first type with that list
+my (%codec, @codecs);
+for my $t (@types) {
+	my @fields = @{$wireformat{$t->{fields}}}[0 .. $t->{max} - 1];
+	my $key = join(' ', @fields, $t->{lower});
+
+	if (!$codec{$key}) {
+		$codec{$key} = {
+			name => lc($t->{type}),
+			fields => \@fields,
+			lower => $t->{lower},
+			cond => $t->{cond}
+		};
+		push @codecs, $codec{$key};
+	} elsif (join(' ', @{$codec{$key}->{cond}})
+			ne join(' ', @{$t->{cond}})) {
+		$codec{$key}->{cond} = [];
+	}
+	$t->{codec} = $codec{$key}->{name};
+}
+
+sub cond_begin {
+	my ($cond) = @_;
+	return join('', map { /^!(\w+)/ ? "#ifndef $1\n" : "#ifdef $_\n" }
+			@$cond);
+}
+
+sub cond_end {
+	my ($cond) = @_;
+	return join('', map { "#endif\n" } @$cond);
+}
+
+# Reading one field in ldns_rr_codec_*_wire2rdf()
+sub decode_field {
+	my ($f) = @_;
+
+	if ($f eq 'DNAME') {
+		return "ldns_rr_codec_read_dname(rr, wire, max, pos)";
+	} elsif ($fixed{$f}) {
+		return "ldns_rr_codec_read(rr, LDNS_RDF_TYPE_$f, $fixed{$f},\n"
+		     . "\t\t\twire, pos, end)";
+	} elsif ($counted{$f}) {
+		return "ldns_rr_codec_read(rr, LDNS_RDF_TYPE_$f,\n"
+		     . "\t\t\t(size_t)wire[*pos] + 1, wire, pos, end)";
+	} elsif ($f eq 'INT16_DATA') {
+		return "ldns_rr_codec_read_int16_data(rr, wire, pos, end)";
+	} elsif ($f eq 'HIP') {
+		return "ldns_rr_codec_read_hip(rr, wire, pos, end)";
+	} elsif ($rest{$f}) {
+		return "ldns_rr_codec_read(rr, LDNS_RDF_TYPE_$f, end - *pos,\n"
+		     . "\t\t\twire, pos, end)";
+	}
+	die "LDNS_RDF_TYPE_$f: unknown length, add it to $0\n";
+}
+
+# The dname fields must be dnames for the names to be lowercased
+sub dname_check {
+	my ($c, @arrays) = @_;
+	my @fields = @{$c->{fields}};
+	my @checks;
+
+	return '' unless $c->{lower};
+	for my $f (@arrays) {
+		for my $i (0 .. $#fields) {
+			next unless $fields[$i] eq 'DNAME';
+			push @checks, "${f}[$i]->_type != LDNS_RDF_TYPE_DNAME";
+		}
+	}
+	return '' unless @checks;
+	return "\tif (" . join("\n\t||  ", @checks) . ") {\n"
+	     . "\t\treturn false;\n\t}\n";
+}
+
+# Writing the rdata, with the names lowercased or not
+sub encode {
+	my ($c, $func, $lower) = @_;
+	my @fields = @{$c->{fields}};
+	my $n = @fields;
+	my $out = '';
+
+	$out .= "static bool\n"
+	      . "ldns_rr_codec_$c->{name}_$func(ldns_buffer *buffer, "
+	      . "const ldns_rr *rr)\n{\n";
+	$out .= "\tldns_rdf *const *f = rr->_rdata_fields;\n\n";
+	$out .= "\tif (rr->_rd_count != $n) {\n\t\treturn false;\n\t}\n";
+	$out .= dname_check($c, 'f') if $lower;
+	$out .= "\tif (ldns_buffer_reserve(buffer, "
+	      . join(' + ', map { "f[$_]->_size" } 0 .. $n - 1) . ")) {\n";
+	for my $i (0 .. $n - 1) {
+		my $write = $lower && $fields[$i] eq 'DNAME'
+			? 'ldns_rr_codec_write_lower' : 'ldns_rr_codec_write';
+		$out .= "\t\t$write(buffer, f[$i]);\n";
+	}
+	$out .= "\t}\n\treturn true;\n}\n\n";
+	return $out;
+}
+
+sub write_codec {
+	my ($c) = @_;
+	my $name = $c->{name};
+	my @fields = @{$c->{fields}};
+	my $n = @fields;
+	my $out = '';
+
+	$out .= cond_begin($c->{cond});
+	$out .= "/* " . join(' ', @fields)
+	      . ($c->{lower} ? ", names lowercased" : "") . " */\n";
+
+	$out .= "static ldns_status\n"
+	      . "ldns_rr_codec_${name}_wire2rdf(ldns_rr *rr, const uint8_t *wire, "
+	      . "size_t max,\n\t\tsize_t *pos, size_t end)\n{\n";
+	$out .= "\tldns_status status;\n\n";
+	$out .= "\tif (*pos < end && !ldns_rr_codec_grow(rr, $n)) {\n"
+	      . "\t\treturn LDNS_STATUS_MEM_ERR;\n\t}\n";
+	for my $f (@fields) {
+		$out .= "\tif (*pos >= end) {\n\t\treturn LDNS_STATUS_OK;\n\t}\n";
+		$out .= "\tstatus = " . decode_field($f) . ";\n";
+		$out .= "\tif (status != LDNS_STATUS_OK) {\n"
+		      . "\t\treturn status;\n\t}\n";
+	}
+	$out .= "\t(void) max;\n" unless grep { $_ eq 'DNAME' } @fields;
+	$out .= "\treturn LDNS_STATUS_OK;\n}\n\n";
+
+	$out .= encode($c, 'rdata2wire', 0);
+	$out .= encode($c, 'canonical', 1) if $c->{lower};
+
+	$out .= "static bool\n"
+	      . "ldns_rr_codec_${name}_compare(const ldns_rr *rr1, "
+	      . "const ldns_rr *rr2, int *result)\n{\n";
+	$out .= "\tldns_rdf *const *f1 = rr1->_rdata_fields;\n"
+	      . "\tldns_rdf *const *f2 = rr2->_rdata_fields;\n"
+	      . "\tint c;\n\n";
+	$out .= "\tif (rr1->_rd_count != $n || rr2->_rd_count != $n) {\n"
+	      . "\t\treturn false;\n\t}\n";
+	$out .= dname_check($c, 'f1', 'f2');
+	for my $i (0 .. $n - 1) {
+		my $lower = $c->{lower} && $fields[$i] eq 'DNAME'
+			? 'true' : 'false';
+		$out .= "\tc = ldns_rr_codec_cmp(f1[$i], f2[$i], $lower);\n";
+		if ($i < $n - 1) {
+			$out .= "\tif (c == LDNS_RR_CODEC_CMP_SIZE) {\n"
+			      . "\t\treturn false;\n"
+			      . "\t} else if (c != 0) {\n"
+			      . "\t\t*result = c;\n\t\treturn true;\n\t}\n";
+		} else {
+			$out .= "\tif (c == LDNS_RR_CODEC_CMP_SIZE) {\n"
+			      . "\t\tc = f1[$i]->_size < f2[$i]->_size ? -1 : 1;\n"
+			      . "\t}\n"
+			      . "\t*result = c;\n\treturn true;\n";
+		}
+	}
+	$out .= "}\n\n";
+
+	$out .= "static const ldns_rr_codec ldns_rr_codec_${name} = {\n"
+	      . "\t" . ($c->{lower} ? 'true' : 'false') . ",\n"
+	      . "\tldns_rr_codec_${name}_wire2rdf,\n"
+	      . "\tldns_rr_codec_${name}_rdata2wire,\n"
+	      . "\tldns_rr_codec_${name}_"
+	      . ($c->{lower} ? 'canonical' : 'rdata2wire') . ",\n"
+	      . "\tldns_rr_codec_${name}_compare\n};\n";
+	$out .= cond_end($c->{cond});
+	return $out . "\n";
+}
+
+print <<'EOF';
+/*
+ * rr_codec.c -- rdata encoders and decoders for each RR type
+ *
+ * Generated by rr_codec.pl from the rdata field descriptors in rr.c.
+ * Do not edit, but change rr.c or rr_codec.pl and run "make rr-codec".
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+/* Returned by ldns_rr_codec_cmp() for rdfs of which one starts with the
+ * other */
+#define LDNS_RR_CODEC_CMP_SIZE	2
+
+/* Makes room for n more rdfs in rr, which the ldns_rr_codec_read functions
+ * then put there */
+static bool
+ldns_rr_codec_grow(ldns_rr *rr, size_t n)
+{
+	ldns_rdf **fields = LDNS_XREALLOC(rr->_rdata_fields, ldns_rdf *,
+			rr->_rd_count + n);
+
+	if (!fields) {
+		return false;
+	}
+	rr->_rdata_fields = fields;
+	return true;
+}
+
+/* Reads a rdf of len bytes at *pos */
+static ldns_status
+ldns_rr_codec_read(ldns_rr *rr, ldns_rdf_type type, size_t len,
+		const uint8_t *wire, size_t *pos, size_t end)
+{
+	ldns_rdf *rdf;
+
+	if (*pos + len > end) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	rdf = ldns_rdf_new_frm_data(type, len, &wire[*pos]);
+	if (!rdf) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	rr->_rdata_fields[rr->_rd_count++] = rdf;
+	*pos += len;
+	return LDNS_STATUS_OK;
+}
+
+static ldns_status
+ldns_rr_codec_read_dname(ldns_rr *rr, const uint8_t *wire, size_t max,
+		size_t *pos)
+{
+	ldns_rdf *rdf = NULL;
+	ldns_status status;
+
+	status = ldns_wire2dname(&rdf, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	rr->_rdata_fields[rr->_rd_count++] = rdf;
+	return LDNS_STATUS_OK;
+}
+
+static ldns_status
+ldns_rr_codec_read_int16_data(ldns_rr *rr, const uint8_t *wire, size_t *pos,
+		size_t end)
+{
+	if (*pos + 2 > end) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	return ldns_rr_codec_read(rr, LDNS_RDF_TYPE_INT16_DATA,
+			(size_t)ldns_read_uint16(&wire[*pos]) + 2, wire, pos, end);
+}
+
+/* Writes a rdf, for which room is reserved */
+static void
+ldns_rr_codec_write(ldns_buffer *buffer, const ldns_rdf *rdf)
+{
+	ldns_buffer_write(buffer, rdf->_data, rdf->_size);
+}
+
+/* Writes a name lowercased, for which room is reserved */
+static void
+ldns_rr_codec_write_lower(ldns_buffer *buffer, const ldns_rdf *rdf)
+{
+	const uint8_t *data = rdf->_data;
+	uint8_t *out = ldns_buffer_current(buffer);
+	size_t i;
+
+	for (i = 0; i < rdf->_size; i++) {
+		out[i] = (uint8_t) LDNS_DNAME_NORMALIZE((int)data[i]);
+	}
+	ldns_buffer_skip(buffer, (ssize_t)rdf->_size);
+}
+
+/* Compares two rdfs as they are in the canonical form: -1 or 1 when they
+ * differ, 0 when they are the same, or LDNS_RR_CODEC_CMP_SIZE when the
+ * shorter one is the start of the other one */
+static int
+ldns_rr_codec_cmp(const ldns_rdf *rdf1, const ldns_rdf *rdf2, bool lower)
+{
+	const uint8_t *data1 = rdf1->_data;
+	const uint8_t *data2 = rdf2->_data;
+	size_t size1 = rdf1->_size;
+	size_t size2 = rdf2->_size;
+	size_t i, n = size1 < size2 ? size1 : size2;
+	int c;
+
+	if (!lower) {
+		c = n ? memcmp(data1, data2, n) : 0;
+		if (c != 0) {
+			return c < 0 ? -1 : 1;
+		}
+	} else {
+		for (i = 0; i < n; i++) {
+			uint8_t b1 = (uint8_t) LDNS_DNAME_NORMALIZE((int)data1[i]);
+			uint8_t b2 = (uint8_t) LDNS_DNAME_NORMALIZE((int)data2[i]);
+
+			if (b1 != b2) {
+				return b1 < b2 ? -1 : 1;
+			}
+		}
+	}
+	return size1 == size2 ? 0 : LDNS_RR_CODEC_CMP_SIZE;
+}
+
+EOF
+
+# HIP is not in a fixed list of fields now
+print <<'EOF' if grep { $_ eq 'HIP' } map { @{$_->{fields}} } @codecs;
+static ldns_status
+ldns_rr_codec_read_hip(ldns_rr *rr, const uint8_t *wire, size_t *pos,
+		size_t end)
+{
+	if (*pos + 4 > end) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	return ldns_rr_codec_read(rr, LDNS_RDF_TYPE_HIP, (size_t)wire[*pos]
+			+ (size_t)ldns_read_uint16(&wire[*pos + 2]) + 4,
+			wire, pos, end);
+}
+
+EOF
+
+for my $c (@codecs) {
+	print write_codec($c);
+}
+
+# Types below 256 are looked up in an array, the others in a switch
+my %low;
+for my $t (@types) {
+	push @{$low{$t->{number}}}, $t if $t->{number} < 256;
+}
+print "static const ldns_rr_codec *const ldns_rr_codecs[256] = {\n";
+for my $number (0 .. 255) {
+	my @ts = @{$low{$number} || []};
+
+	die "type $number is in the table twice\n" if @ts > 1;
+	if (!@ts) {
+		print "\tNULL,\n";
+	} elsif (!@{$ts[0]->{cond}}) {
+		print "\t&ldns_rr_codec_$ts[0]->{codec},\t/* $ts[0]->{type} */\n";
+	} else {
+		print cond_begin($ts[0]->{cond});
+		print "\t&ldns_rr_codec_$ts[0]->{codec},\t/* $ts[0]->{type} */\n";
+		print "#else\n\tNULL,\n";
+		print cond_end($ts[0]->{cond});
+	}
+}
+print "};\n\n";
+
+print "const ldns_rr_codec *\nldns_rr_codec_get(ldns_rr_type type)\n{\n"
+    . "\tif ((int)type < 256) {\n\t\treturn ldns_rr_codecs[type];\n\t}\n"
+    . "\tswitch (type) {\n";
+for my $t (grep { $_->{number} >= 256 } @types) {
+	print cond_begin($t->{cond});
+	print "\tcase LDNS_RR_TYPE_$t->{type}:\n"
+	    . "\t\treturn &ldns_rr_codec_$t->{codec};\n";
+	print cond_end($t->{cond});
+}
+print "\tdefault:\n\t\treturn NULL;\n\t}\n}\n";
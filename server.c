@@ -0,0 +1,369 @@
+/*
+ * server.c -- answering queries without ldns_pkt
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+/* Length of an OPT RR without options */
+#define LDNS_RESPONSE_OPT_SIZE	11
+
+ldns_status
+ldns_query_info_from_wire(ldns_query_info *qi, const uint8_t *wire,
+		size_t len)
+{
+	ldns_pkt_view view;
+	ldns_pkt_view_rr rr;
+	ldns_status status;
+
+	if (!qi || !wire) {
+		return LDNS_STATUS_NULL;
+	}
+	memset(qi, 0, sizeof(*qi));
+	if (len < LDNS_HEADER_SIZE) {
+		return LDNS_STATUS_WIRE_INCOMPLETE_HEADER;
+	}
+	qi->id = LDNS_ID_WIRE(wire);
+	qi->opcode = (ldns_pkt_opcode) LDNS_OPCODE_WIRE(wire);
+	qi->rd = LDNS_RD_WIRE(wire) != 0;
+	qi->cd = LDNS_CD_WIRE(wire) != 0;
+
+	status = ldns_pkt_view_init(&view, wire, len);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (LDNS_QR_WIRE(wire)
+	||  ldns_pkt_view_section_count(&view, LDNS_SECTION_QUESTION) != 1) {
+		return LDNS_STATUS_ERR;
+	}
+	(void) ldns_pkt_view_rr_first(&view, LDNS_SECTION_QUESTION, &rr);
+	status = ldns_pkt_view_name(&view, rr.owner, qi->qname,
+			sizeof(qi->qname), &qi->qname_size);
+	if (status != LDNS_STATUS_OK) {
+		qi->qname_size = 0;
+		return status;
+	}
+	qi->qtype = rr.type;
+	qi->qclass = rr.rr_class;
+
+	if (ldns_pkt_view_edns(&view, &rr)) {
+		qi->edns = true;
+		qi->udp_size = (uint16_t) rr.rr_class;
+		qi->edns_version = (uint8_t)(rr.ttl >> 16);
+		qi->edns_do = (rr.ttl & 0x8000) != 0;
+		qi->edns_data = rr.rdata;
+		qi->edns_data_size = rr.rdlength;
+	}
+	return LDNS_STATUS_OK;
+}
+
+size_t
+ldns_query_info_max_udp(const ldns_query_info *qi)
+{
+	if (qi && qi->edns && qi->udp_size > LDNS_MIN_BUFLEN) {
+		return qi->udp_size;
+	}
+	return LDNS_MIN_BUFLEN;
+}
+
+ldns_status
+ldns_response_init(ldns_response *resp, ldns_buffer *buffer,
+		const ldns_query_info *qi, size_t max)
+{
+	ldns_rdf qname;
+
+	if (!resp || !buffer || !qi) {
+		return LDNS_STATUS_NULL;
+	}
+	resp->buffer = buffer;
+	resp->max = max;
+	resp->edns = qi->edns;
+	resp->udp_size = LDNS_RESPONSE_EDNS_UDP_SIZE;
+	resp->edns_do = qi->edns_do;
+	resp->rcode = 0;
+	memset(resp->counts, 0, sizeof(resp->counts));
+	ldns_compression_table_init(&resp->table);
+
+	ldns_buffer_clear(buffer);
+	if (!ldns_buffer_reserve(buffer, LDNS_HEADER_SIZE + qi->qname_size + 4)) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	ldns_buffer_write_u16(buffer, qi->id);
+	ldns_buffer_write_u8(buffer, LDNS_QR_MASK
+			| (((uint8_t)qi->opcode << LDNS_OPCODE_SHIFT)
+				& LDNS_OPCODE_MASK)
+			| (qi->rd ? LDNS_RD_MASK : 0));
+	ldns_buffer_write_u8(buffer, qi->cd ? LDNS_CD_MASK : 0);
+	ldns_buffer_write_u16(buffer, 0);
+	ldns_buffer_write_u16(buffer, 0);
+	ldns_buffer_write_u16(buffer, 0);
+	ldns_buffer_write_u16(buffer, 0);
+	if (qi->qname_size > 0) {
+		qname._size = qi->qname_size;
+		qname._type = LDNS_RDF_TYPE_DNAME;
+		qname._data = (void *)qi->qname;
+		(void) ldns_dname2buffer_wire_table(buffer, &qname,
+				&resp->table);
+		ldns_buffer_write_u16(buffer, qi->qtype);
+		ldns_buffer_write_u16(buffer, qi->qclass);
+		resp->counts[LDNS_SECTION_QUESTION] = 1;
+	}
+	return ldns_buffer_status(buffer);
+}
+
+void
+ldns_response_set_flags(ldns_response *resp, uint16_t flags)
+{
+	uint8_t *wire = ldns_buffer_begin(resp->buffer);
+
+	if (flags & LDNS_QR) {
+		LDNS_QR_SET(wire);
+	}
+	if (flags & LDNS_AA) {
+		LDNS_AA_SET(wire);
+	}
+	if (flags & LDNS_TC) {
+		LDNS_TC_SET(wire);
+	}
+	if (flags & LDNS_RD) {
+		LDNS_RD_SET(wire);
+	}
+	if (flags & LDNS_CD) {
+		LDNS_CD_SET(wire);
+	}
+	if (flags & LDNS_RA) {
+		LDNS_RA_SET(wire);
+	}
+	if (flags & LDNS_AD) {
+		LDNS_AD_SET(wire);
+	}
+}
+
+void
+ldns_response_set_rcode(ldns_response *resp, uint16_t rcode)
+{
+	resp->rcode = rcode;
+}
+
+/* Checks what was added since start, and takes it back when it does not
+ * fit or could not be written */
+static ldns_status
+ldns_response_added(ldns_response *resp, ldns_pkt_section section,
+		size_t start, size_t count, ldns_status status)
+{
+	size_t end = ldns_buffer_position(resp->buffer);
+
+	if (status == LDNS_STATUS_OK
+	&&  (end + (resp->edns ? LDNS_RESPONSE_OPT_SIZE : 0) > resp->max
+	  || resp->counts[section] + count + (resp->edns ? 1 : 0) > 65535)) {
+		status = LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	if (status != LDNS_STATUS_OK) {
+		ldns_buffer_set_position(resp->buffer, start);
+		ldns_compression_table_truncate(&resp->table, start);
+		if (status == LDNS_STATUS_PACKET_OVERFLOW
+		&&  section != LDNS_SECTION_ADDITIONAL) {
+			LDNS_TC_SET(ldns_buffer_begin(resp->buffer));
+		}
+		return status;
+	}
+	resp->counts[section] += (uint16_t) count;
+	return LDNS_STATUS_OK;
+}
+
+size_t
+ldns_response_room(const ldns_response *resp)
+{
+	size_t used = ldns_buffer_position(resp->buffer)
+		+ (resp->edns ? LDNS_RESPONSE_OPT_SIZE : 0);
+
+	return used < resp->max ? resp->max - used : 0;
+}
+
+size_t
+ldns_response_rr_list_size(const ldns_response *resp,
+		ldns_pkt_section section, const ldns_rr_list *rrs)
+{
+	return ldns_rr_list_compressed_size(resp->buffer, rrs, section,
+			&resp->table);
+}
+
+/* The size of RRs without name compression, counted up to a limit */
+static size_t
+ldns_response_uncompressed_size(const ldns_rr_list *rrs, size_t limit)
+{
+	const ldns_rr *rr;
+	size_t size = 0, i, j;
+
+	for (i = 0; i < rrs->_rr_count && size <= limit; i++) {
+		rr = rrs->_rrs[i];
+		size += LDNS_RR_OVERHEAD + (rr->_owner ? rr->_owner->_size : 0);
+		for (j = 0; j < rr->_rd_count; j++) {
+			size += rr->_rdata_fields[j]->_size;
+		}
+	}
+	return size;
+}
+
+ldns_status
+ldns_response_add_rr_list(ldns_response *resp, ldns_pkt_section section,
+		const ldns_rr_list *rrs)
+{
+	ldns_status status = LDNS_STATUS_OK;
+	size_t start, i, room;
+
+	if (!resp || !rrs) {
+		return LDNS_STATUS_NULL;
+	}
+	if (section != LDNS_SECTION_ANSWER && section != LDNS_SECTION_AUTHORITY
+	&&  section != LDNS_SECTION_ADDITIONAL) {
+		return LDNS_STATUS_ERR;
+	}
+	start = ldns_buffer_position(resp->buffer);
+
+	/* RRs that do not fit are not written at all.  Compression only
+	 * makes them shorter, so they are only sized when they would not fit
+	 * uncompressed. */
+	room = ldns_response_room(resp);
+	if (ldns_response_uncompressed_size(rrs, room) > room
+	&&  ldns_response_rr_list_size(resp, section, rrs) > room) {
+		if (section != LDNS_SECTION_ADDITIONAL) {
+			LDNS_TC_SET(ldns_buffer_begin(resp->buffer));
+		}
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	for (i = 0; i < ldns_rr_list_rr_count(rrs); i++) {
+		status = ldns_rr2buffer_wire_table(resp->buffer,
+				ldns_rr_list_rr(rrs, i), section, &resp->table);
+		if (status != LDNS_STATUS_OK) {
+			break;
+		}
+	}
+	return ldns_response_added(resp, section, start,
+			ldns_rr_list_rr_count(rrs), status);
+}
+
+ldns_status
+ldns_response_add_rrsets(ldns_response *resp, ldns_pkt_section section,
+		ldns_rr_list *const *rrsets, size_t count, bool *added)
+{
+	ldns_status status = LDNS_STATUS_OK, s;
+	size_t i;
+
+	if (!resp || (!rrsets && count > 0)) {
+		return LDNS_STATUS_NULL;
+	}
+	for (i = 0; i < count; i++) {
+		if (status != LDNS_STATUS_OK) {
+			/* not after one was left out of the answer or
+			 * authority section */
+			s = LDNS_STATUS_PACKET_OVERFLOW;
+		} else {
+			s = ldns_response_add_rr_list(resp, section,
+					rrsets[i]);
+		}
+		if (added) {
+			added[i] = s == LDNS_STATUS_OK;
+		}
+		if (s == LDNS_STATUS_PACKET_OVERFLOW
+		&&  section == LDNS_SECTION_ADDITIONAL) {
+			/* a smaller one after it may still fit */
+			continue;
+		}
+		if (s != LDNS_STATUS_OK && status == LDNS_STATUS_OK) {
+			status = s;
+		}
+	}
+	return status;
+}
+
+ldns_status
+ldns_response_add_wire(ldns_response *resp, ldns_pkt_section section,
+		const uint8_t *wire, size_t len, uint16_t count)
+{
+	ldns_status status = LDNS_STATUS_OK;
+	ldns_rdf owner;
+	size_t start, pos = 0, end, rdlength;
+	uint16_t i;
+
+	if (!resp || (!wire && count > 0)) {
+		return LDNS_STATUS_NULL;
+	}
+	if (section != LDNS_SECTION_ANSWER && section != LDNS_SECTION_AUTHORITY
+	&&  section != LDNS_SECTION_ADDITIONAL) {
+		return LDNS_STATUS_ERR;
+	}
+	start = ldns_buffer_position(resp->buffer);
+	owner._type = LDNS_RDF_TYPE_DNAME;
+	for (i = 0; i < count && status == LDNS_STATUS_OK; i++) {
+		for (end = pos; end < len && wire[end] != 0;
+				end += wire[end] + 1) {
+			if (wire[end] > LDNS_MAX_LABELLEN) {
+				break;
+			}
+		}
+		if (end >= len || wire[end] != 0
+		||  end + 1 - pos > LDNS_MAX_DOMAINLEN
+		||  end + 11 > len
+		||  end + 11 + ldns_read_uint16(&wire[end + 9]) > len) {
+			status = LDNS_STATUS_WIRE_RDATA_ERR;
+			break;
+		}
+		end++;
+		rdlength = ldns_read_uint16(&wire[end + 8]);
+		owner._size = end - pos;
+		owner._data = (void *)&wire[pos];
+		status = ldns_dname2buffer_wire_table(resp->buffer, &owner,
+				&resp->table);
+		if (status == LDNS_STATUS_OK
+		&&  ldns_buffer_reserve(resp->buffer, 10 + rdlength)) {
+			ldns_buffer_write(resp->buffer, &wire[end],
+					10 + rdlength);
+		}
+		status = ldns_buffer_status(resp->buffer);
+		pos = end + 10 + rdlength;
+	}
+	return ldns_response_added(resp, section, start, count, status);
+}
+
+ldns_status
+ldns_response_finish(ldns_response *resp)
+{
+	uint8_t *wire;
+
+	if (!resp) {
+		return LDNS_STATUS_NULL;
+	}
+	if (resp->edns) {
+		if (!ldns_buffer_reserve(resp->buffer, LDNS_RESPONSE_OPT_SIZE)) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		ldns_buffer_write_u8(resp->buffer, 0);
+		ldns_buffer_write_u16(resp->buffer, LDNS_RR_TYPE_OPT);
+		ldns_buffer_write_u16(resp->buffer, resp->udp_size);
+		ldns_buffer_write_u8(resp->buffer, (uint8_t)(resp->rcode >> 4));
+		ldns_buffer_write_u8(resp->buffer, 0);
+		ldns_buffer_write_u16(resp->buffer, resp->edns_do ? 0x8000 : 0);
+		ldns_buffer_write_u16(resp->buffer, 0);
+		resp->counts[LDNS_SECTION_ADDITIONAL]++;
+		/* Not twice when finished again */
+		resp->edns = false;
+	}
+	wire = ldns_buffer_begin(resp->buffer);
+	LDNS_RCODE_SET(wire, resp->rcode & LDNS_RCODE_MASK);
+	ldns_write_uint16(wire + LDNS_QDCOUNT_OFF,
+			resp->counts[LDNS_SECTION_QUESTION]);
+	ldns_write_uint16(wire + LDNS_ANCOUNT_OFF,
+			resp->counts[LDNS_SECTION_ANSWER]);
+	ldns_write_uint16(wire + LDNS_NSCOUNT_OFF,
+			resp->counts[LDNS_SECTION_AUTHORITY]);
+	ldns_write_uint16(wire + LDNS_ARCOUNT_OFF,
+			resp->counts[LDNS_SECTION_ADDITIONAL]);
+	return ldns_buffer_status(resp->buffer);
+}
@@ -43,8 +43,8 @@
 
 /* Hash a single 512-bit block. This is the core of the algorithm. */
 
-void
-ldns_sha1_transform(uint32_t state[5], const unsigned char buffer[LDNS_SHA1_BLOCK_LENGTH])
+static void
+ldns_sha1_transform_generic(uint32_t state[5], const unsigned char buffer[LDNS_SHA1_BLOCK_LENGTH])
 {
     uint32_t a, b, c, d, e;
     typedef union {
@@ -101,6 +101,305 @@ ldns_sha1_transform(uint32_t state[5], const unsigned char buffer[LDNS_SHA1_BLOC
 }
 
 
+/* A message being hashed, split in directly readable and padding blocks */
+struct ldns_sha1_lane {
+    const unsigned char *data;
+    size_t msg;      /* index of the message in the batch */
+    size_t block;    /* next block to hash */
+    size_t nfull;    /* blocks that can be read from data directly */
+    size_t nblocks;  /* total number of blocks, including padding */
+    unsigned char tail[2 * LDNS_SHA1_BLOCK_LENGTH];
+};
+
+static void
+ldns_sha1_lane_init(struct ldns_sha1_lane *lane, size_t msg,
+        const unsigned char *data, size_t len)
+{
+    size_t rest = len % LDNS_SHA1_BLOCK_LENGTH;
+    size_t tail_len = rest + 9 > LDNS_SHA1_BLOCK_LENGTH
+                    ? 2 * LDNS_SHA1_BLOCK_LENGTH : LDNS_SHA1_BLOCK_LENGTH;
+    uint64_t bits = (uint64_t) len << 3;
+    int i;
+
+    lane->data = data;
+    lane->msg = msg;
+    lane->block = 0;
+    lane->nfull = len / LDNS_SHA1_BLOCK_LENGTH;
+    lane->nblocks = lane->nfull + tail_len / LDNS_SHA1_BLOCK_LENGTH;
+    memset(lane->tail, 0, tail_len);
+    if (rest > 0) {
+        memcpy(lane->tail, data + len - rest, rest);
+    }
+    lane->tail[rest] = 0x80;
+    for (i = 0; i < 8; i++) {
+        lane->tail[tail_len - 1 - i] = (unsigned char) (bits >> (8 * i));
+    }
+}
+
+#ifdef USE_SHA_ACCEL
+/*
+ * x86 backends.  The SHA-NI code hashes one message using the dedicated
+ * SHA instructions, the AVX2 code hashes eight independent messages at
+ * once, one in every 32-bit lane.  Which one is used is decided at
+ * runtime from the cpuid feature bits.
+ */
+#include <immintrin.h>
+#include <cpuid.h>
+
+#define LDNS_SHA1_CPU_SHANI 0x01
+#define LDNS_SHA1_CPU_AVX2  0x02
+
+static int
+ldns_sha1_cpu_features(void)
+{
+    static int features = -1;
+    unsigned int eax, ebx, ecx, edx, xcr0;
+    int f = 0;
+
+    if (features >= 0)
+        return features;
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        /* SSSE3 (bit 9), SSE4.1 (bit 19), OSXSAVE (bit 27), AVX (bit 28) */
+        int sse = (ecx & (1u << 9)) && (ecx & (1u << 19));
+        int avx = (ecx & (1u << 27)) && (ecx & (1u << 28));
+
+        if (avx) {
+            /* the OS must save the XMM and YMM state */
+            __asm__ ("xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0));
+            avx = (xcr0 & 6) == 6;
+        }
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            /* SHA (bit 29), AVX2 (bit 5) */
+            if (sse && (ebx & (1u << 29)))
+                f |= LDNS_SHA1_CPU_SHANI;
+            if (avx && (ebx & (1u << 5)))
+                f |= LDNS_SHA1_CPU_AVX2;
+        }
+    }
+    features = f;
+    return features;
+}
+
+/*
+ * One group of four rounds.  msg[g % 4] holds the schedule words of
+ * group g, the message schedule for the following groups is computed
+ * interleaved with the rounds.
+ */
+#define SHA1_NI_GROUP(g, cur, nxt) do { \
+        if ((g) == 0) \
+            cur = _mm_add_epi32(cur, msg[0]); \
+        else \
+            cur = _mm_sha1nexte_epu32(cur, msg[(g) % 4]); \
+        nxt = abcd; \
+        if ((g) >= 3 && (g) <= 18) \
+            msg[((g) + 1) % 4] = _mm_sha1msg2_epu32(msg[((g) + 1) % 4], msg[(g) % 4]); \
+        abcd = _mm_sha1rnds4_epu32(abcd, cur, (g) / 5); \
+        if ((g) >= 1 && (g) <= 16) \
+            msg[((g) + 3) % 4] = _mm_sha1msg1_epu32(msg[((g) + 3) % 4], msg[(g) % 4]); \
+        if ((g) >= 2 && (g) <= 17) \
+            msg[((g) + 2) % 4] = _mm_xor_si128(msg[((g) + 2) % 4], msg[(g) % 4]); \
+    } while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void
+ldns_sha1_transform_shani(uint32_t state[5], const unsigned char *data, size_t nblocks)
+{
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd, abcd_save, e0, e0_save, e1;
+    __m128i msg[4];
+    int i;
+
+    abcd = _mm_loadu_si128((const __m128i *) state);
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+    e0 = _mm_set_epi32((int) state[4], 0, 0, 0);
+
+    for (; nblocks > 0; nblocks--, data += LDNS_SHA1_BLOCK_LENGTH) {
+        abcd_save = abcd;
+        e0_save = e0;
+        for (i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(
+                (const __m128i *) (data + 16 * i)), mask);
+        }
+        SHA1_NI_GROUP(0, e0, e1);  SHA1_NI_GROUP(1, e1, e0);
+        SHA1_NI_GROUP(2, e0, e1);  SHA1_NI_GROUP(3, e1, e0);
+        SHA1_NI_GROUP(4, e0, e1);  SHA1_NI_GROUP(5, e1, e0);
+        SHA1_NI_GROUP(6, e0, e1);  SHA1_NI_GROUP(7, e1, e0);
+        SHA1_NI_GROUP(8, e0, e1);  SHA1_NI_GROUP(9, e1, e0);
+        SHA1_NI_GROUP(10, e0, e1); SHA1_NI_GROUP(11, e1, e0);
+        SHA1_NI_GROUP(12, e0, e1); SHA1_NI_GROUP(13, e1, e0);
+        SHA1_NI_GROUP(14, e0, e1); SHA1_NI_GROUP(15, e1, e0);
+        SHA1_NI_GROUP(16, e0, e1); SHA1_NI_GROUP(17, e1, e0);
+        SHA1_NI_GROUP(18, e0, e1); SHA1_NI_GROUP(19, e1, e0);
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    abcd = _mm_shuffle_epi32(abcd, 0x1B);
+    _mm_storeu_si128((__m128i *) state, abcd);
+    state[4] = (uint32_t) _mm_extract_epi32(e0, 3);
+}
+
+#define MB_LANES 8
+#define MB_ROL(x, n) _mm256_or_si256(_mm256_slli_epi32((x), (n)), \
+                                     _mm256_srli_epi32((x), 32 - (n)))
+
+/*
+ * Hash one block for each of the eight lanes. state[i][l] is word i of
+ * the state of lane l.
+ */
+__attribute__((target("avx2")))
+static void
+ldns_sha1_transform_avx2(uint32_t state[5][MB_LANES],
+        const unsigned char *blocks[MB_LANES])
+{
+    uint32_t words[16][MB_LANES];
+    __m256i w[16], a, b, c, d, e, f, k, t;
+    int i, l;
+
+    for (i = 0; i < 16; i++) {
+        for (l = 0; l < MB_LANES; l++) {
+            const unsigned char *p = blocks[l] + 4 * i;
+            words[i][l] = ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16)
+                        | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+        }
+        w[i] = _mm256_loadu_si256((const __m256i *) words[i]);
+    }
+    a = _mm256_loadu_si256((const __m256i *) state[0]);
+    b = _mm256_loadu_si256((const __m256i *) state[1]);
+    c = _mm256_loadu_si256((const __m256i *) state[2]);
+    d = _mm256_loadu_si256((const __m256i *) state[3]);
+    e = _mm256_loadu_si256((const __m256i *) state[4]);
+
+    for (i = 0; i < 80; i++) {
+        if (i >= 16) {
+            t = _mm256_xor_si256(
+                _mm256_xor_si256(w[(i + 13) & 15], w[(i + 8) & 15]),
+                _mm256_xor_si256(w[(i + 2) & 15], w[i & 15]));
+            w[i & 15] = MB_ROL(t, 1);
+        }
+        if (i < 20) {
+            f = _mm256_xor_si256(d, _mm256_and_si256(b, _mm256_xor_si256(c, d)));
+            k = _mm256_set1_epi32(0x5A827999);
+        } else if (i < 40) {
+            f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+            k = _mm256_set1_epi32(0x6ED9EBA1);
+        } else if (i < 60) {
+            f = _mm256_or_si256(_mm256_and_si256(b, c),
+                _mm256_and_si256(d, _mm256_or_si256(b, c)));
+            k = _mm256_set1_epi32((int) 0x8F1BBCDC);
+        } else {
+            f = _mm256_xor_si256(_mm256_xor_si256(b, c), d);
+            k = _mm256_set1_epi32((int) 0xCA62C1D6);
+        }
+        t = _mm256_add_epi32(_mm256_add_epi32(MB_ROL(a, 5), f),
+            _mm256_add_epi32(_mm256_add_epi32(e, k), w[i & 15]));
+        e = d;
+        d = c;
+        c = MB_ROL(b, 30);
+        b = a;
+        a = t;
+    }
+
+    a = _mm256_add_epi32(a, _mm256_loadu_si256((const __m256i *) state[0]));
+    b = _mm256_add_epi32(b, _mm256_loadu_si256((const __m256i *) state[1]));
+    c = _mm256_add_epi32(c, _mm256_loadu_si256((const __m256i *) state[2]));
+    d = _mm256_add_epi32(d, _mm256_loadu_si256((const __m256i *) state[3]));
+    e = _mm256_add_epi32(e, _mm256_loadu_si256((const __m256i *) state[4]));
+    _mm256_storeu_si256((__m256i *) state[0], a);
+    _mm256_storeu_si256((__m256i *) state[1], b);
+    _mm256_storeu_si256((__m256i *) state[2], c);
+    _mm256_storeu_si256((__m256i *) state[3], d);
+    _mm256_storeu_si256((__m256i *) state[4], e);
+}
+
+static void
+ldns_sha1_many_avx2(size_t count, const unsigned char * const *data,
+        const size_t *data_len, unsigned char *digests)
+{
+    static const unsigned char idle_block[LDNS_SHA1_BLOCK_LENGTH];
+    struct ldns_sha1_lane lanes[MB_LANES];
+    int busy[MB_LANES];
+    uint32_t state[5][MB_LANES];
+    const unsigned char *blocks[MB_LANES];
+    size_t next = 0, active = 0;
+    int i, l;
+
+    for (l = 0; l < MB_LANES; l++) {
+        busy[l] = 0;
+    }
+    for (;;) {
+        /* refill the lanes that are free */
+        for (l = 0; l < MB_LANES && next < count; l++) {
+            if (busy[l]) {
+                continue;
+            }
+            ldns_sha1_lane_init(&lanes[l], next, data[next], data_len[next]);
+            state[0][l] = 0x67452301;
+            state[1][l] = 0xEFCDAB89;
+            state[2][l] = 0x98BADCFE;
+            state[3][l] = 0x10325476;
+            state[4][l] = 0xC3D2E1F0;
+            busy[l] = 1;
+            active++;
+            next++;
+        }
+        if (active == 0) {
+            break;
+        }
+        for (l = 0; l < MB_LANES; l++) {
+            struct ldns_sha1_lane *lane = &lanes[l];
+
+            if (!busy[l]) {
+                blocks[l] = idle_block;
+            } else if (lane->block < lane->nfull) {
+                blocks[l] = lane->data + lane->block * LDNS_SHA1_BLOCK_LENGTH;
+            } else {
+                blocks[l] = lane->tail
+                    + (lane->block - lane->nfull) * LDNS_SHA1_BLOCK_LENGTH;
+            }
+        }
+        ldns_sha1_transform_avx2(state, blocks);
+        for (l = 0; l < MB_LANES; l++) {
+            unsigned char *digest;
+
+            if (!busy[l] || ++lanes[l].block < lanes[l].nblocks) {
+                continue;
+            }
+            digest = digests + lanes[l].msg * LDNS_SHA1_DIGEST_LENGTH;
+            for (i = 0; i < LDNS_SHA1_DIGEST_LENGTH; i++) {
+                digest[i] = (unsigned char)
+                    (state[i >> 2][l] >> ((3 - (i & 3)) * 8));
+            }
+            busy[l] = 0;
+            active--;
+        }
+    }
+}
+#endif /* USE_SHA_ACCEL */
+
+/* Hash nblocks consecutive 512-bit blocks with the best available code. */
+
+static void
+ldns_sha1_blocks(uint32_t state[5], const unsigned char *data, size_t nblocks)
+{
+#ifdef USE_SHA_ACCEL
+    if (ldns_sha1_cpu_features() & LDNS_SHA1_CPU_SHANI) {
+        ldns_sha1_transform_shani(state, data, nblocks);
+        return;
+    }
+#endif
+    for (; nblocks > 0; nblocks--, data += LDNS_SHA1_BLOCK_LENGTH) {
+        ldns_sha1_transform_generic(state, data);
+    }
+}
+
+void
+ldns_sha1_transform(uint32_t state[5], const unsigned char buffer[LDNS_SHA1_BLOCK_LENGTH])
+{
+    ldns_sha1_blocks(state, buffer, 1);
+}
+
+
 /* SHA1Init - Initialize new context */
 
 void
@@ -128,9 +427,10 @@ ldns_sha1_update(ldns_sha1_ctx *context, const unsigned char *data, unsigned int
     context->count += (len << 3);
     if ((j + len) > 63) {
         memmove(&context->buffer[j], data, (i = 64 - j));
-        ldns_sha1_transform(context->state, context->buffer);
-        for ( ; i + 63 < len; i += 64) {
-            ldns_sha1_transform(context->state, &data[i]);
+        ldns_sha1_blocks(context->state, context->buffer, 1);
+        if (i + 63 < len) {
+            ldns_sha1_blocks(context->state, &data[i], (len - i) / 64);
+            i += ((len - i) / 64) * 64;
         }
         j = 0;
     }
@@ -141,6 +441,8 @@ ldns_sha1_update(ldns_sha1_ctx *context, const unsigned char *data, unsigned int
 
 /* Add padding and return the message digest. */
 
+static const unsigned char ldns_sha1_padding[LDNS_SHA1_BLOCK_LENGTH] = { 0x80 };
+
 void
 ldns_sha1_final(unsigned char digest[LDNS_SHA1_DIGEST_LENGTH], ldns_sha1_ctx *context)
 {
@@ -151,10 +453,10 @@ ldns_sha1_final(unsigned char digest[LDNS_SHA1_DIGEST_LENGTH], ldns_sha1_ctx *co
         finalcount[i] = (unsigned char)((context->count >>
             ((7 - (i & 7)) * 8)) & 255);  /* Endian independent */
     }
-    ldns_sha1_update(context, (unsigned char *)"\200", 1);
-    while ((context->count & 504) != 448) {
-        ldns_sha1_update(context, (unsigned char *)"\0", 1);
-    }
+    /* Pad with a 1 bit and zeroes up to 56 bytes modulo 64 */
+    ldns_sha1_update(context, ldns_sha1_padding,
+        (unsigned int)(((context->count >> 3) & 63) < 56 ? 56 : 120)
+        - (unsigned int)((context->count >> 3) & 63));
     ldns_sha1_update(context, finalcount, 8);  /* Should cause a SHA1Transform() */
 
     if (digest != NULL)
@@ -167,12 +469,49 @@ ldns_sha1_final(unsigned char digest[LDNS_SHA1_DIGEST_LENGTH], ldns_sha1_ctx *co
 #endif
 }
 
+/* Digest a complete message at once, without a context */
+
+static void
+ldns_sha1_oneshot(const unsigned char *data, size_t len, unsigned char *digest)
+{
+    struct ldns_sha1_lane lane;
+    uint32_t state[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE,
+                          0x10325476, 0xC3D2E1F0 };
+    int i;
+
+    ldns_sha1_lane_init(&lane, 0, data, len);
+    ldns_sha1_blocks(state, data, lane.nfull);
+    ldns_sha1_blocks(state, lane.tail, lane.nblocks - lane.nfull);
+    for (i = 0; i < LDNS_SHA1_DIGEST_LENGTH; i++) {
+        digest[i] = (unsigned char)((state[i >> 2] >> ((3 - (i & 3)) * 8)) & 255);
+    }
+}
+
 unsigned char *
 ldns_sha1(const unsigned char *data, unsigned int data_len, unsigned char *digest)
 {
-    ldns_sha1_ctx ctx;
-    ldns_sha1_init(&ctx);
-    ldns_sha1_update(&ctx, data, data_len);
-    ldns_sha1_final(digest, &ctx);
+    size_t len = data_len;
+
+    ldns_sha1_many(1, &data, &len, digest);
     return digest;
 }
+
+void
+ldns_sha1_many(size_t count, const unsigned char * const *data,
+        const size_t *data_len, unsigned char *digests)
+{
+    size_t i;
+
+#ifdef USE_SHA_ACCEL
+    /* The SHA instructions beat eight lanes, only use AVX2 without them */
+    if (count > 1 && (ldns_sha1_cpu_features() &
+            (LDNS_SHA1_CPU_SHANI | LDNS_SHA1_CPU_AVX2)) == LDNS_SHA1_CPU_AVX2) {
+        ldns_sha1_many_avx2(count, data, data_len, digests);
+        return;
+    }
+#endif
+    for (i = 0; i < count; i++) {
+        ldns_sha1_oneshot(data[i], data_len[i],
+            digests + i * LDNS_SHA1_DIGEST_LENGTH);
+    }
+}
@@ -358,8 +358,8 @@ void ldns_sha256_init(ldns_sha256_CTX* context) {
 	(h) = T1 + Sigma0_256(a) + Maj((a), (b), (c)); \
 	j++
 
-static void ldns_sha256_Transform(ldns_sha256_CTX* context,
-                                  const sha2_word32* data) {
+static void ldns_sha256_Transform_generic(ldns_sha256_CTX* context,
+                                          const sha2_word32* data) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1, *W256;
 	int		j;
@@ -417,8 +417,8 @@ static void ldns_sha256_Transform(ldns_sha256_CTX* context,
 
 #else /* SHA2_UNROLL_TRANSFORM */
 
-static void ldns_sha256_Transform(ldns_sha256_CTX* context,
-                                  const sha2_word32* data) {
+static void ldns_sha256_Transform_generic(ldns_sha256_CTX* context,
+                                          const sha2_word32* data) {
 	sha2_word32	a, b, c, d, e, f, g, h, s0, s1;
 	sha2_word32	T1, T2, *W256;
 	int		j;
@@ -499,6 +499,305 @@ static void ldns_sha256_Transform(ldns_sha256_CTX* context,
 
 #endif /* SHA2_UNROLL_TRANSFORM */
 
+/* A message split in directly readable blocks and padding blocks: */
+typedef struct _ldns_sha256_lane {
+	const sha2_byte	*data;
+	size_t		msg;		/* index of the message in the batch */
+	size_t		block;		/* next block to hash */
+	size_t		nfull;		/* blocks read from data directly */
+	size_t		nblocks;	/* total blocks, including padding */
+	sha2_byte	tail[2 * LDNS_SHA256_BLOCK_LENGTH];
+} ldns_sha256_lane;
+
+static void ldns_sha256_lane_init(ldns_sha256_lane* lane, size_t msg,
+                                  const sha2_byte* data, size_t len) {
+	size_t		rest = len % LDNS_SHA256_BLOCK_LENGTH;
+	size_t		tail_len = rest > ldns_sha256_SHORT_BLOCK_LENGTH - 1 ?
+			    2 * LDNS_SHA256_BLOCK_LENGTH : LDNS_SHA256_BLOCK_LENGTH;
+	sha2_word64	bits = (sha2_word64)len << 3;
+	int		i;
+
+	lane->data = data;
+	lane->msg = msg;
+	lane->block = 0;
+	lane->nfull = len / LDNS_SHA256_BLOCK_LENGTH;
+	lane->nblocks = lane->nfull + tail_len / LDNS_SHA256_BLOCK_LENGTH;
+	MEMSET_BZERO(lane->tail, tail_len);
+	if (rest > 0) {
+		MEMCPY_BCOPY(lane->tail, data + len - rest, rest);
+	}
+	lane->tail[rest] = 0x80;
+	for (i = 0; i < 8; i++) {
+		lane->tail[tail_len - 1 - i] = (sha2_byte)(bits >> (8 * i));
+	}
+}
+
+#ifdef USE_SHA_ACCEL
+/*
+ * x86 SHA-256 backends.  The SHA-NI code hashes one message using the
+ * dedicated SHA instructions, the AVX2 code hashes eight independent
+ * messages at once, one in every 32-bit lane.  Which one is used is
+ * decided at runtime from the cpuid feature bits.
+ */
+#include <immintrin.h>
+#include <cpuid.h>
+
+#define SHA2_CPU_SHANI	0x01
+#define SHA2_CPU_AVX2	0x02
+
+static int ldns_sha256_cpu_features(void) {
+	static int	features = -1;
+	unsigned int	eax, ebx, ecx, edx, xcr0;
+	int		f = 0;
+
+	if (features >= 0) {
+		return features;
+	}
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		/* SSSE3 (bit 9), SSE4.1 (bit 19), OSXSAVE (bit 27), AVX (bit 28) */
+		int sse = (ecx & (1u << 9)) && (ecx & (1u << 19));
+		int avx = (ecx & (1u << 27)) && (ecx & (1u << 28));
+
+		if (avx) {
+			/* the OS must save the XMM and YMM state */
+			__asm__ ("xgetbv" : "=a" (xcr0), "=d" (edx) : "c" (0));
+			avx = (xcr0 & 6) == 6;
+		}
+		if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+			/* SHA (bit 29), AVX2 (bit 5) */
+			if (sse && (ebx & (1u << 29))) {
+				f |= SHA2_CPU_SHANI;
+			}
+			if (avx && (ebx & (1u << 5))) {
+				f |= SHA2_CPU_AVX2;
+			}
+		}
+	}
+	features = f;
+	return features;
+}
+
+/*
+ * Four rounds.  msg[g % 4] holds the schedule words of group g, the
+ * message schedule for the following groups is computed interleaved
+ * with the rounds.
+ */
+#define SHA256_NI_GROUP(g)	do { \
+	m = _mm_add_epi32(msg[(g) % 4], \
+	    _mm_loadu_si128((const __m128i*)&K256[4 * (g)])); \
+	state1 = _mm_sha256rnds2_epu32(state1, state0, m); \
+	if ((g) >= 3 && (g) <= 14) { \
+		tmp = _mm_alignr_epi8(msg[(g) % 4], msg[((g) + 3) % 4], 4); \
+		msg[((g) + 1) % 4] = _mm_add_epi32(msg[((g) + 1) % 4], tmp); \
+		msg[((g) + 1) % 4] = _mm_sha256msg2_epu32(msg[((g) + 1) % 4], \
+		    msg[(g) % 4]); \
+	} \
+	m = _mm_shuffle_epi32(m, 0x0E); \
+	state0 = _mm_sha256rnds2_epu32(state0, state1, m); \
+	if ((g) >= 1 && (g) <= 12) { \
+		msg[((g) + 3) % 4] = _mm_sha256msg1_epu32(msg[((g) + 3) % 4], \
+		    msg[(g) % 4]); \
+	} \
+} while (0)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void ldns_sha256_Transform_shani(sha2_word32 state[8],
+                                        const sha2_byte* data, size_t nblocks) {
+	const __m128i	mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+			    0x0405060700010203ULL);
+	__m128i		state0, state1, abef_save, cdgh_save, m, tmp;
+	__m128i		msg[4];
+	int		i;
+
+	/* state0 holds ABEF, state1 CDGH */
+	tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);
+	state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	for (; nblocks > 0; nblocks--, data += LDNS_SHA256_BLOCK_LENGTH) {
+		abef_save = state0;
+		cdgh_save = state1;
+		for (i = 0; i < 4; i++) {
+			msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(
+			    (const __m128i*)(data + 16 * i)), mask);
+		}
+		SHA256_NI_GROUP(0);  SHA256_NI_GROUP(1);
+		SHA256_NI_GROUP(2);  SHA256_NI_GROUP(3);
+		SHA256_NI_GROUP(4);  SHA256_NI_GROUP(5);
+		SHA256_NI_GROUP(6);  SHA256_NI_GROUP(7);
+		SHA256_NI_GROUP(8);  SHA256_NI_GROUP(9);
+		SHA256_NI_GROUP(10); SHA256_NI_GROUP(11);
+		SHA256_NI_GROUP(12); SHA256_NI_GROUP(13);
+		SHA256_NI_GROUP(14); SHA256_NI_GROUP(15);
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+	_mm_storeu_si128((__m128i*)&state[0], state0);
+	_mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+#define SHA2_LANES	8
+#define MB_ROR(x,n)	_mm256_or_si256(_mm256_srli_epi32((x), (n)), \
+			    _mm256_slli_epi32((x), 32 - (n)))
+
+/*
+ * Hash one block for each of the eight lanes.  state[i][l] is word i of
+ * the state of lane l.
+ */
+__attribute__((target("avx2")))
+static void ldns_sha256_Transform_avx2(sha2_word32 state[8][SHA2_LANES],
+                                       const sha2_byte* blocks[SHA2_LANES]) {
+	sha2_word32	words[16][SHA2_LANES];
+	__m256i		w[16], s[8], a, b, c, d, e, f, g, h, s0, s1, T1, T2;
+	int		i, l;
+
+	for (i = 0; i < 16; i++) {
+		for (l = 0; l < SHA2_LANES; l++) {
+			const sha2_byte *p = blocks[l] + 4 * i;
+			words[i][l] = ((sha2_word32)p[0] << 24) |
+			    ((sha2_word32)p[1] << 16) |
+			    ((sha2_word32)p[2] << 8) | (sha2_word32)p[3];
+		}
+		w[i] = _mm256_loadu_si256((const __m256i*)words[i]);
+	}
+	for (i = 0; i < 8; i++) {
+		s[i] = _mm256_loadu_si256((const __m256i*)state[i]);
+	}
+	a = s[0]; b = s[1]; c = s[2]; d = s[3];
+	e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+	for (i = 0; i < 64; i++) {
+		if (i >= 16) {
+			s0 = w[(i + 1) & 0x0f];
+			s0 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(s0, 7),
+			    MB_ROR(s0, 18)), _mm256_srli_epi32(s0, 3));
+			s1 = w[(i + 14) & 0x0f];
+			s1 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(s1, 17),
+			    MB_ROR(s1, 19)), _mm256_srli_epi32(s1, 10));
+			w[i & 0x0f] = _mm256_add_epi32(w[i & 0x0f],
+			    _mm256_add_epi32(_mm256_add_epi32(s0, s1),
+			    w[(i + 9) & 0x0f]));
+		}
+		/* T1 = h + Sigma1(e) + Ch(e, f, g) + K256[i] + W256[i] */
+		T1 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(e, 6),
+		    MB_ROR(e, 11)), MB_ROR(e, 25));
+		T1 = _mm256_add_epi32(_mm256_add_epi32(h, T1),
+		    _mm256_xor_si256(g, _mm256_and_si256(e,
+		    _mm256_xor_si256(f, g))));
+		T1 = _mm256_add_epi32(T1, _mm256_add_epi32(w[i & 0x0f],
+		    _mm256_set1_epi32((int)K256[i])));
+		/* T2 = Sigma0(a) + Maj(a, b, c) */
+		T2 = _mm256_xor_si256(_mm256_xor_si256(MB_ROR(a, 2),
+		    MB_ROR(a, 13)), MB_ROR(a, 22));
+		T2 = _mm256_add_epi32(T2, _mm256_or_si256(_mm256_and_si256(a, b),
+		    _mm256_and_si256(c, _mm256_or_si256(a, b))));
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, T1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(T1, T2);
+	}
+
+	s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+	s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+	s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+	s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+	for (i = 0; i < 8; i++) {
+		_mm256_storeu_si256((__m256i*)state[i], s[i]);
+	}
+}
+
+static void ldns_sha256_many_avx2(size_t count, const unsigned char * const *data,
+                                  const size_t *data_len, unsigned char *digests) {
+	static const sha2_byte	idle_block[LDNS_SHA256_BLOCK_LENGTH];
+	ldns_sha256_lane	lanes[SHA2_LANES];
+	int			busy[SHA2_LANES];
+	sha2_word32		state[8][SHA2_LANES];
+	const sha2_byte		*blocks[SHA2_LANES];
+	size_t			next = 0, active = 0;
+	int			i, l;
+
+	for (l = 0; l < SHA2_LANES; l++) {
+		busy[l] = 0;
+	}
+	for (;;) {
+		/* Refill the lanes that are free: */
+		for (l = 0; l < SHA2_LANES && next < count; l++) {
+			if (busy[l]) {
+				continue;
+			}
+			ldns_sha256_lane_init(&lanes[l], next,
+			    data[next], data_len[next]);
+			for (i = 0; i < 8; i++) {
+				state[i][l] = ldns_sha256_initial_hash_value[i];
+			}
+			busy[l] = 1;
+			active++;
+			next++;
+		}
+		if (active == 0) {
+			break;
+		}
+		for (l = 0; l < SHA2_LANES; l++) {
+			ldns_sha256_lane *lane = &lanes[l];
+
+			if (!busy[l]) {
+				blocks[l] = idle_block;
+			} else if (lane->block < lane->nfull) {
+				blocks[l] = lane->data +
+				    lane->block * LDNS_SHA256_BLOCK_LENGTH;
+			} else {
+				blocks[l] = lane->tail + (lane->block -
+				    lane->nfull) * LDNS_SHA256_BLOCK_LENGTH;
+			}
+		}
+		ldns_sha256_Transform_avx2(state, blocks);
+		for (l = 0; l < SHA2_LANES; l++) {
+			unsigned char *digest;
+
+			if (!busy[l] || ++lanes[l].block < lanes[l].nblocks) {
+				continue;
+			}
+			digest = digests + lanes[l].msg * LDNS_SHA256_DIGEST_LENGTH;
+			for (i = 0; i < LDNS_SHA256_DIGEST_LENGTH; i++) {
+				digest[i] = (unsigned char)
+				    (state[i >> 2][l] >> ((3 - (i & 3)) * 8));
+			}
+			busy[l] = 0;
+			active--;
+		}
+	}
+}
+#endif /* USE_SHA_ACCEL */
+
+/* Process nblocks complete blocks with the best available code: */
+static void ldns_sha256_Blocks(ldns_sha256_CTX* context,
+                               const sha2_byte* data, size_t nblocks) {
+#ifdef USE_SHA_ACCEL
+	if (ldns_sha256_cpu_features() & SHA2_CPU_SHANI) {
+		ldns_sha256_Transform_shani(context->state, data, nblocks);
+		return;
+	}
+#endif
+	for (; nblocks > 0; nblocks--, data += LDNS_SHA256_BLOCK_LENGTH) {
+		ldns_sha256_Transform_generic(context, (const sha2_word32*)data);
+	}
+}
+
+static void ldns_sha256_Transform(ldns_sha256_CTX* context,
+                                  const sha2_word32* data) {
+	ldns_sha256_Blocks(context, (const sha2_byte*)data, 1);
+}
+
 void ldns_sha256_update(ldns_sha256_CTX* context, const sha2_byte *data, size_t len) {
 	size_t freespace, usedspace;
 
@@ -532,12 +831,14 @@ void ldns_sha256_update(ldns_sha256_CTX* context, const sha2_byte *data, size_t
 			return;
 		}
 	}
-	while (len >= LDNS_SHA256_BLOCK_LENGTH) {
+	if (len >= LDNS_SHA256_BLOCK_LENGTH) {
 		/* Process as many complete blocks as we can */
-		ldns_sha256_Transform(context, (sha2_word32*)data);
-		context->bitcount += LDNS_SHA256_BLOCK_LENGTH << 3;
-		len -= LDNS_SHA256_BLOCK_LENGTH;
-		data += LDNS_SHA256_BLOCK_LENGTH;
+		size_t nblocks = len / LDNS_SHA256_BLOCK_LENGTH;
+
+		ldns_sha256_Blocks(context, data, nblocks);
+		context->bitcount += (sha2_word64)nblocks * LDNS_SHA256_BLOCK_LENGTH << 3;
+		len -= nblocks * LDNS_SHA256_BLOCK_LENGTH;
+		data += nblocks * LDNS_SHA256_BLOCK_LENGTH;
 	}
 	if (len > 0) {
 		/* There's left-overs, so save 'em */
@@ -620,14 +921,50 @@ void ldns_sha256_final(sha2_byte digest[LDNS_SHA256_DIGEST_LENGTH], ldns_sha256_
 	(void)usedspace;
 }
 
+/* Digest a complete message at once, without a context: */
+static void ldns_sha256_oneshot(const sha2_byte* data, size_t len,
+                                sha2_byte* digest) {
+	ldns_sha256_CTX		context;
+	ldns_sha256_lane	lane;
+	int			i;
+
+	MEMCPY_BCOPY(context.state, ldns_sha256_initial_hash_value,
+	    LDNS_SHA256_DIGEST_LENGTH);
+	ldns_sha256_lane_init(&lane, 0, data, len);
+	ldns_sha256_Blocks(&context, data, lane.nfull);
+	ldns_sha256_Blocks(&context, lane.tail, lane.nblocks - lane.nfull);
+	for (i = 0; i < LDNS_SHA256_DIGEST_LENGTH; i++) {
+		digest[i] = (sha2_byte)(context.state[i >> 2] >> ((3 - (i & 3)) * 8));
+	}
+}
+
 unsigned char *
 ldns_sha256(const unsigned char *data, unsigned int data_len, unsigned char *digest)
 {
-    ldns_sha256_CTX ctx;
-    ldns_sha256_init(&ctx);
-    ldns_sha256_update(&ctx, data, data_len);
-    ldns_sha256_final(digest, &ctx);
-    return digest;
+	size_t len = data_len;
+
+	ldns_sha256_many(1, &data, &len, digest);
+	return digest;
+}
+
+void
+ldns_sha256_many(size_t count, const unsigned char * const *data,
+		const size_t *data_len, unsigned char *digests)
+{
+	size_t i;
+
+#ifdef USE_SHA_ACCEL
+	/* The SHA instructions beat eight lanes, only use AVX2 without them */
+	if (count > 1 && (ldns_sha256_cpu_features() &
+		(SHA2_CPU_SHANI | SHA2_CPU_AVX2)) == SHA2_CPU_AVX2) {
+		ldns_sha256_many_avx2(count, data, data_len, digests);
+		return;
+	}
+#endif
+	for (i = 0; i < count; i++) {
+		ldns_sha256_oneshot(data[i], data_len[i],
+			digests + i * LDNS_SHA256_DIGEST_LENGTH);
+	}
 }
 
 /*** SHA-512: *********************************************************/
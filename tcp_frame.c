@@ -0,0 +1,247 @@
+/*
+ * tcp_frame.c -- DNS messages over TCP, read and written in pieces
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+#include <errno.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/* Room for the largest message with its length, so that any message that
+ * arrives at once is given without copying */
+#define LDNS_TCP_READER_IN_SIZE	(LDNS_MAX_PACKETLEN + 2)
+
+static bool
+ldns_tcp_frame_again(void)
+{
+#ifndef USE_WINSOCK
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#else
+	return WSAGetLastError() == WSAEWOULDBLOCK
+	    || WSAGetLastError() == WSAEINTR;
+#endif
+}
+
+void
+ldns_tcp_reader_init(ldns_tcp_reader *r)
+{
+	memset(r, 0, sizeof(*r));
+}
+
+void
+ldns_tcp_reader_clear(ldns_tcp_reader *r)
+{
+	LDNS_FREE(r->msg);
+	LDNS_FREE(r->in);
+	ldns_tcp_reader_init(r);
+}
+
+ldns_status
+ldns_tcp_reader_next(ldns_tcp_reader *r, const uint8_t *data, size_t len,
+		size_t *used, const uint8_t **msg, size_t *msg_len)
+{
+	size_t pos = 0, need, n;
+
+	*msg = NULL;
+	*msg_len = 0;
+	while (r->have < 2 && pos < len) {
+		r->len[r->have++] = data[pos++];
+	}
+	*used = pos;
+	if (r->have < 2) {
+		return LDNS_STATUS_OK;
+	}
+	need = ldns_read_uint16(r->len);
+	if (r->have == 2 && len - pos >= need) {
+		/* all of it is here */
+		*msg = data + pos;
+		*msg_len = need;
+		*used = pos + need;
+		r->have = 0;
+		return LDNS_STATUS_OK;
+	}
+	if (!r->msg && !(r->msg = LDNS_XMALLOC(uint8_t, LDNS_MAX_PACKETLEN))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	n = need - (r->have - 2);
+	if (n > len - pos) {
+		n = len - pos;
+	}
+	memcpy(r->msg + r->have - 2, data + pos, n);
+	r->have += n;
+	*used = pos + n;
+	if (r->have - 2 == need) {
+		*msg = r->msg;
+		*msg_len = need;
+		r->have = 0;
+	}
+	return LDNS_STATUS_OK;
+}
+
+ldns_status
+ldns_tcp_reader_recv(ldns_tcp_reader *r, int sockfd)
+{
+	ssize_t got;
+
+	if (!r->in && !(r->in = LDNS_XMALLOC(uint8_t,
+			LDNS_TCP_READER_IN_SIZE))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (!r->msg && !(r->msg = LDNS_XMALLOC(uint8_t, LDNS_MAX_PACKETLEN))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	if (r->in_pos > 0) {
+		memmove(r->in, r->in + r->in_pos, r->in_len - r->in_pos);
+		r->in_len -= r->in_pos;
+		r->in_pos = 0;
+	}
+	if (r->in_len == LDNS_TCP_READER_IN_SIZE) {
+		return LDNS_STATUS_OK;
+	}
+	got = recv(sockfd, (void *)(r->in + r->in_len),
+			LDNS_TCP_READER_IN_SIZE - r->in_len, 0);
+	if (got > 0) {
+		r->in_len += (size_t)got;
+	} else if (got == 0 || !ldns_tcp_frame_again()) {
+		return LDNS_STATUS_SOCKET_ERROR;
+	}
+	return LDNS_STATUS_OK;
+}
+
+bool
+ldns_tcp_reader_get(ldns_tcp_reader *r, const uint8_t **msg, size_t *msg_len)
+{
+	size_t used;
+
+	while (r->in_pos < r->in_len) {
+		if (ldns_tcp_reader_next(r, r->in + r->in_pos,
+				r->in_len - r->in_pos, &used, msg, msg_len)
+				!= LDNS_STATUS_OK) {
+			return false;
+		}
+		r->in_pos += used;
+		if (*msg) {
+			return true;
+		}
+	}
+	r->in_pos = r->in_len = 0;
+	return false;
+}
+
+bool
+ldns_tcp_reader_partial(const ldns_tcp_reader *r)
+{
+	return r->have > 0 || r->in_pos < r->in_len;
+}
+
+void
+ldns_tcp_writer_init(ldns_tcp_writer *w)
+{
+	w->count = 0;
+	w->written = 0;
+}
+
+bool
+ldns_tcp_writer_add(ldns_tcp_writer *w, const uint8_t *msg, size_t len)
+{
+	if (w->count == LDNS_TCP_WRITER_MAX || len > LDNS_MAX_PACKETLEN) {
+		return false;
+	}
+	w->msgs[w->count] = msg;
+	ldns_write_uint16(w->lens[w->count], (uint16_t)len);
+	w->count++;
+	return true;
+}
+
+size_t
+ldns_tcp_writer_pending(const ldns_tcp_writer *w)
+{
+	size_t i, n = 0;
+
+	for (i = 0; i < w->count; i++) {
+		n += 2 + ldns_read_uint16(w->lens[i]);
+	}
+	return n - w->written;
+}
+
+/* Takes n more written bytes off the queue */
+static void
+ldns_tcp_writer_skip(ldns_tcp_writer *w, size_t n)
+{
+	size_t i = 0, size;
+
+	w->written += n;
+	while (i < w->count
+	&&     w->written >= (size = 2 + ldns_read_uint16(w->lens[i]))) {
+		w->written -= size;
+		i++;
+	}
+	if (i > 0) {
+		memmove(w->msgs, w->msgs + i, (w->count - i) * sizeof(*w->msgs));
+		memmove(w->lens, w->lens + i, (w->count - i) * sizeof(*w->lens));
+		w->count -= i;
+	}
+}
+
+ldns_status
+ldns_tcp_writer_flush(ldns_tcp_writer *w, int sockfd)
+{
+	const uint8_t *data[2 * LDNS_TCP_WRITER_MAX];
+	size_t sizes[2 * LDNS_TCP_WRITER_MAX];
+	size_t i, n, skip;
+	ssize_t r;
+#if defined(HAVE_SENDMSG) && defined(HAVE_SYS_UIO_H)
+	struct iovec iov[2 * LDNS_TCP_WRITER_MAX];
+	struct msghdr mh;
+#endif
+
+	while (w->count > 0) {
+		/* the lengths and the messages not written yet */
+		skip = w->written;
+		for (i = 0, n = 0; i < w->count; i++) {
+			data[n] = w->lens[i];
+			sizes[n++] = 2;
+			data[n] = w->msgs[i];
+			sizes[n++] = ldns_read_uint16(w->lens[i]);
+		}
+		for (i = 0; skip >= sizes[i]; i++) {
+			skip -= sizes[i];
+		}
+		data[i] += skip;
+		sizes[i] -= skip;
+#if defined(HAVE_SENDMSG) && defined(HAVE_SYS_UIO_H)
+		for (n -= i, skip = 0; skip < n; skip++) {
+			iov[skip].iov_base = (void *)data[i + skip];
+			iov[skip].iov_len = sizes[i + skip];
+		}
+		memset(&mh, 0, sizeof(mh));
+		mh.msg_iov = iov;
+		mh.msg_iovlen = n;
+		r = sendmsg(sockfd, &mh, MSG_NOSIGNAL);
+#else
+		r = send(sockfd, (void *)data[i], sizes[i], MSG_NOSIGNAL);
+#endif
+		if (r < 0) {
+			return ldns_tcp_frame_again()
+				? LDNS_STATUS_OK : LDNS_STATUS_SOCKET_ERROR;
+		}
+		ldns_tcp_writer_skip(w, (size_t)r);
+	}
+	return LDNS_STATUS_OK;
+}
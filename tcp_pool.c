@@ -0,0 +1,700 @@
+/*
+ * tcp_pool.c -- persistent TCP connections to nameservers
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#ifndef USE_WINSOCK
+#include <netinet/tcp.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#include <sys/time.h>
+#include <errno.h>
+#include <fcntl.h>
+#ifdef HAVE_POLL
+#include <poll.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/* Bytes added to a query by the edns-tcp-keepalive option */
+#define LDNS_TCP_POOL_KEEPALIVE_LEN	4
+
+/* Largest message with its length in front */
+#define LDNS_TCP_POOL_RBUF_SIZE		(LDNS_MAX_PACKETLEN + 2)
+
+/* What ldns_tcp_pool_wait() found */
+#define LDNS_TCP_POOL_IN		1
+#define LDNS_TCP_POOL_OUT		2
+
+typedef struct ldns_tcp_conn ldns_tcp_conn;
+
+/* A connection to a nameserver */
+struct ldns_tcp_conn {
+	ldns_tcp_conn	*next;
+	ldns_rdf	*ns;
+	uint16_t	 port;
+	ldns_rdf	*source;	/* or NULL */
+	int		 fd;		/* -1 when not connected */
+
+	/* Idle timeout in milliseconds, from the nameserver or the pool,
+	 * and when it runs out */
+	uint32_t	 idle;
+	struct timeval	 idle_until;
+
+	/* Bytes read that do not make a whole message yet */
+	uint8_t		*rbuf;
+	size_t		 rlen;
+};
+
+struct ldns_struct_tcp_pool {
+	ldns_tcp_conn		*conns;
+	uint32_t		 idle;
+	ldns_tcp_pool_stats	 stats;
+};
+
+ldns_tcp_pool *
+ldns_tcp_pool_new(void)
+{
+	ldns_tcp_pool *pool;
+
+	if (!(pool = LDNS_CALLOC(ldns_tcp_pool, 1))) {
+		return NULL;
+	}
+	pool->idle = LDNS_TCP_POOL_DEFAULT_IDLE;
+	return pool;
+}
+
+static void
+ldns_tcp_conn_free(ldns_tcp_conn *c)
+{
+	close_socket(c->fd);
+	ldns_rdf_deep_free(c->ns);
+	ldns_rdf_deep_free(c->source);
+	LDNS_FREE(c->rbuf);
+	LDNS_FREE(c);
+}
+
+void
+ldns_tcp_pool_free(ldns_tcp_pool *pool)
+{
+	ldns_tcp_conn *c, *next;
+
+	if (!pool) {
+		return;
+	}
+	for (c = pool->conns; c; c = next) {
+		next = c->next;
+		ldns_tcp_conn_free(c);
+	}
+	LDNS_FREE(pool);
+}
+
+void
+ldns_tcp_pool_close(ldns_tcp_pool *pool)
+{
+	ldns_tcp_conn *c;
+
+	for (c = pool->conns; c; c = c->next) {
+		close_socket(c->fd);
+		c->rlen = 0;
+	}
+}
+
+uint32_t
+ldns_tcp_pool_idle(const ldns_tcp_pool *pool)
+{
+	return pool->idle;
+}
+
+void
+ldns_tcp_pool_set_idle(ldns_tcp_pool *pool, uint32_t ms)
+{
+	pool->idle = ms;
+}
+
+void
+ldns_tcp_pool_get_stats(const ldns_tcp_pool *pool, ldns_tcp_pool_stats *stats)
+{
+	*stats = pool->stats;
+}
+
+static void
+ldns_tcp_pool_add_ms(struct timeval *tv, uint32_t ms)
+{
+	tv->tv_sec += ms / 1000;
+	tv->tv_usec += (ms % 1000) * 1000;
+	if (tv->tv_usec >= 1000000) {
+		tv->tv_usec -= 1000000;
+		tv->tv_sec++;
+	}
+}
+
+static uint32_t
+ldns_tcp_pool_timeval2ms(struct timeval tv)
+{
+	return (uint32_t)tv.tv_sec * 1000 + (uint32_t)tv.tv_usec / 1000;
+}
+
+/* Milliseconds from now until end, at most INT_MAX, or 0 when passed */
+static int
+ldns_tcp_pool_ms_until(const struct timeval *end)
+{
+	struct timeval now;
+	long ms;
+
+	gettimeofday(&now, NULL);
+	ms = (long)(end->tv_sec - now.tv_sec) * 1000
+	   + (long)(end->tv_usec - now.tv_usec) / 1000;
+	return ms <= 0 ? 0 : ms > 0x7fffffff ? 0x7fffffff : (int)ms;
+}
+
+/** best effort to set nonblocking */
+static void
+ldns_tcp_pool_sock_nonblock(int sockfd)
+{
+#ifdef HAVE_FCNTL
+	int flag;
+	if((flag = fcntl(sockfd, F_GETFL)) != -1) {
+		flag |= O_NONBLOCK;
+		if(fcntl(sockfd, F_SETFL, flag) == -1) {
+			/* ignore error, continue blockingly */
+		}
+	}
+#elif defined(HAVE_IOCTLSOCKET)
+	unsigned long on = 1;
+	if(ioctlsocket(sockfd, FIONBIO, &on) != 0) {
+		/* ignore error, continue blockingly */
+	}
+#endif
+}
+
+/* Waits until fd is readable, or writable when write is set.  Returns
+ * what it is as LDNS_TCP_POOL_IN and LDNS_TCP_POOL_OUT, 0 on timeout, or
+ * -1 on error.  An error on the socket counts as readable.
+ */
+static int
+ldns_tcp_pool_wait(int fd, bool write, int ms)
+{
+	int ret;
+#ifdef HAVE_POLL
+	struct pollfd pfd;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN | (write ? POLLOUT : 0);
+	pfd.revents = 0;
+	if ((ret = poll(&pfd, 1, ms)) <= 0) {
+		return ret;
+	}
+	return ((pfd.revents & (POLLIN | POLLERR | POLLHUP))
+	        ? LDNS_TCP_POOL_IN : 0)
+	     | ((pfd.revents & POLLOUT) ? LDNS_TCP_POOL_OUT : 0);
+#else
+	fd_set rfds, wfds;
+	struct timeval tv;
+
+	FD_ZERO(&rfds);
+	FD_ZERO(&wfds);
+	FD_SET(FD_SET_T fd, &rfds);
+	if (write) {
+		FD_SET(FD_SET_T fd, &wfds);
+	}
+	tv.tv_sec = ms / 1000;
+	tv.tv_usec = (ms % 1000) * 1000;
+	if ((ret = select(fd + 1, &rfds, write ? &wfds : NULL, NULL, &tv))
+			<= 0) {
+		return ret;
+	}
+	return (FD_ISSET(fd, &rfds) ? LDNS_TCP_POOL_IN : 0)
+	     | (FD_ISSET(fd, &wfds) ? LDNS_TCP_POOL_OUT : 0);
+#endif
+}
+
+static bool
+ldns_tcp_pool_again(void)
+{
+#ifndef USE_WINSOCK
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#else
+	return WSAGetLastError() == WSAEWOULDBLOCK
+	    || WSAGetLastError() == WSAEINTR;
+#endif
+}
+
+static bool
+ldns_tcp_pool_connect(ldns_tcp_pool *pool, ldns_tcp_conn *c,
+		struct timeval timeout)
+{
+	struct sockaddr_storage *to, *from = NULL;
+	size_t to_len, from_len = 0;
+	int error = 0, on = 1;
+	socklen_t len = (socklen_t)sizeof(error);
+
+	if (!(to = ldns_rdf2native_sockaddr_storage(c->ns, c->port,
+			&to_len))) {
+		return false;
+	}
+	if (c->source && !(from = ldns_rdf2native_sockaddr_storage(
+			c->source, 0, &from_len))) {
+		goto error;
+	}
+	if ((c->fd = socket((int)to->ss_family, SOCK_STREAM, IPPROTO_TCP))
+			== SOCK_INVALID) {
+		c->fd = -1;
+		goto error;
+	}
+	if (from && bind(c->fd, (struct sockaddr *)from, (socklen_t)from_len)
+			== -1) {
+		goto error;
+	}
+	ldns_tcp_pool_sock_nonblock(c->fd);
+#ifdef TCP_NODELAY
+	/* pipelined queries should not wait for each other's ACKs */
+	(void) setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, (void *)&on,
+			(socklen_t)sizeof(on));
+#endif
+#ifdef SO_NOSIGPIPE
+	(void) setsockopt(c->fd, SOL_SOCKET, SO_NOSIGPIPE, (void *)&on,
+			(socklen_t)sizeof(on));
+#endif
+	(void)on;
+	if (connect(c->fd, (struct sockaddr *)to, (socklen_t)to_len) == -1) {
+#ifndef USE_WINSOCK
+		if (errno != EINPROGRESS) {
+			goto error;
+		}
+#else
+		if (WSAGetLastError() != WSAEINPROGRESS
+		&&  WSAGetLastError() != WSAEWOULDBLOCK) {
+			goto error;
+		}
+#endif
+		if (ldns_tcp_pool_wait(c->fd, true,
+				(int)ldns_tcp_pool_timeval2ms(timeout)) <= 0
+		||  getsockopt(c->fd, SOL_SOCKET, SO_ERROR, (void *)&error,
+				&len) < 0
+		||  error != 0) {
+			goto error;
+		}
+	}
+	LDNS_FREE(to);
+	LDNS_FREE(from);
+	c->idle = pool->idle;
+	c->rlen = 0;
+	pool->stats.connects++;
+	return true;
+error:
+	close_socket(c->fd);
+	LDNS_FREE(to);
+	LDNS_FREE(from);
+	return false;
+}
+
+/* Finds the connection for ns, port and source, or adds it */
+static ldns_tcp_conn *
+ldns_tcp_pool_conn(ldns_tcp_pool *pool, const ldns_rdf *ns, uint16_t port,
+		const ldns_rdf *source)
+{
+	ldns_tcp_conn *c;
+
+	for (c = pool->conns; c; c = c->next) {
+		if (c->port == port
+		&&  ldns_rdf_compare(c->ns, ns) == 0
+		&&  (c->source == NULL) == (source == NULL)
+		&&  (!source || ldns_rdf_compare(c->source, source) == 0)) {
+			return c;
+		}
+	}
+	if (!(c = LDNS_CALLOC(ldns_tcp_conn, 1))) {
+		return NULL;
+	}
+	c->fd = -1;
+	c->port = port;
+	if (!(c->ns = ldns_rdf_clone(ns))
+	||  (source && !(c->source = ldns_rdf_clone(source)))) {
+		ldns_tcp_conn_free(c);
+		return NULL;
+	}
+	c->next = pool->conns;
+	pool->conns = c;
+	return c;
+}
+
+/* An idle connection that became readable was closed by the nameserver,
+ * or has data that nobody asked for.  Either way it is not used again.
+ */
+static bool
+ldns_tcp_pool_alive(const ldns_tcp_conn *c)
+{
+	return c->rlen == 0 && ldns_tcp_pool_wait(c->fd, false, 0) == 0;
+}
+
+static bool
+ldns_tcp_pool_skip_name(const uint8_t *wire, size_t len, size_t *pos)
+{
+	uint8_t c;
+
+	while (*pos < len) {
+		c = wire[*pos];
+		if (c == 0) {
+			*pos += 1;
+			return true;
+		}
+		if ((c & 0xc0) == 0xc0) {
+			*pos += 2;
+			return *pos <= len;
+		}
+		if (c & 0xc0) {
+			return false;
+		}
+		*pos += 1 + (size_t)c;
+	}
+	return false;
+}
+
+/* Finds the OPT record of a message.  *rdlen is set to the offset of its
+ * RDLENGTH field and *end to the offset right after it.
+ */
+static bool
+ldns_tcp_pool_find_opt(const uint8_t *wire, size_t len,
+		size_t *rdlen, size_t *end)
+{
+	size_t pos = LDNS_HEADER_SIZE, i, rrs, ar, rdl;
+
+	if (len < LDNS_HEADER_SIZE) {
+		return false;
+	}
+	for (i = 0; i < LDNS_QDCOUNT(wire); i++) {
+		if (!ldns_tcp_pool_skip_name(wire, len, &pos)
+		||  (pos += 4) > len) {
+			return false;
+		}
+	}
+	ar = LDNS_ARCOUNT(wire);
+	rrs = (size_t)LDNS_ANCOUNT(wire) + LDNS_NSCOUNT(wire) + ar;
+	for (i = 0; i < rrs; i++) {
+		if (!ldns_tcp_pool_skip_name(wire, len, &pos)
+		||  pos + 10 > len) {
+			return false;
+		}
+		rdl = ldns_read_uint16(wire + pos + 8);
+		if (pos + 10 + rdl > len) {
+			return false;
+		}
+		if (i >= rrs - ar
+		&&  ldns_read_uint16(wire + pos) == LDNS_RR_TYPE_OPT) {
+			*rdlen = pos + 8;
+			*end = pos + 10 + rdl;
+			return true;
+		}
+		pos += 10 + rdl;
+	}
+	return false;
+}
+
+/* Finds an option in the OPT record found by ldns_tcp_pool_find_opt() */
+static const uint8_t *
+ldns_tcp_pool_find_option(const uint8_t *wire, size_t rdlen, size_t end,
+		uint16_t code, uint16_t *option_len)
+{
+	size_t pos = rdlen + 2;
+	uint16_t l;
+
+	while (pos + 4 <= end) {
+		l = ldns_read_uint16(wire + pos + 2);
+		if (pos + 4 + l > end) {
+			return NULL;
+		}
+		if (ldns_read_uint16(wire + pos) == code) {
+			*option_len = l;
+			return wire + pos + 4;
+		}
+		pos += 4 + (size_t)l;
+	}
+	return NULL;
+}
+
+/* Appends a query, with its length in front, to out.  The keepalive
+ * option is added when the OPT record is the last record and does not
+ * have it yet.
+ */
+static size_t
+ldns_tcp_pool_frame(uint8_t *out, const uint8_t *query, size_t len)
+{
+	size_t rdlen, end;
+	uint16_t option_len;
+	bool keepalive;
+
+	keepalive = len + LDNS_TCP_POOL_KEEPALIVE_LEN <= LDNS_MAX_PACKETLEN
+	         && ldns_tcp_pool_find_opt(query, len, &rdlen, &end)
+	         && end == len
+	         && !ldns_tcp_pool_find_option(query, rdlen, end,
+	                 LDNS_EDNS_KEEPALIVE, &option_len);
+	memcpy(out + 2, query, len);
+	if (keepalive) {
+		ldns_write_uint16(out + 2 + rdlen, (uint16_t)(
+			ldns_read_uint16(query + rdlen)
+			+ LDNS_TCP_POOL_KEEPALIVE_LEN));
+		ldns_write_uint16(out + 2 + len, LDNS_EDNS_KEEPALIVE);
+		ldns_write_uint16(out + 4 + len, 0);
+		len += LDNS_TCP_POOL_KEEPALIVE_LEN;
+	}
+	ldns_write_uint16(out, (uint16_t)len);
+	return len + 2;
+}
+
+/* Takes the idle timeout the nameserver gives in an answer */
+static void
+ldns_tcp_pool_keepalive(ldns_tcp_conn *c, const uint8_t *answer, size_t len)
+{
+	const uint8_t *option;
+	size_t rdlen, end;
+	uint16_t option_len;
+
+	if (ldns_tcp_pool_find_opt(answer, len, &rdlen, &end)
+	&&  (option = ldns_tcp_pool_find_option(answer, rdlen, end,
+			LDNS_EDNS_KEEPALIVE, &option_len))
+	&&  option_len == 2) {
+		/* in units of 100 milliseconds */
+		c->idle = (uint32_t)ldns_read_uint16(option) * 100;
+	}
+}
+
+/* Takes the whole messages from the read buffer.  Returns the number of
+ * queries answered.
+ */
+static size_t
+ldns_tcp_pool_read_answers(ldns_tcp_conn *c,
+		const uint8_t * const *queries, size_t n,
+		uint8_t **answers, size_t *answer_sizes, size_t *next)
+{
+	size_t pos = 0, len, i = 0, k, matched = 0;
+	const uint8_t *msg;
+	uint16_t id;
+
+	while (c->rlen - pos >= 2
+	&&     c->rlen - pos - 2 >= (len = ldns_read_uint16(c->rbuf + pos))) {
+		msg = c->rbuf + pos + 2;
+		pos += 2 + len;
+		if (len < LDNS_HEADER_SIZE) {
+			continue;
+		}
+		/* answers mostly come in the order of the queries */
+		id = LDNS_ID_WIRE(msg);
+		for (k = 0; k < n; k++) {
+			i = (*next + k) % n;
+			if (!answers[i] && LDNS_ID_WIRE(queries[i]) == id) {
+				break;
+			}
+		}
+		if (k == n || !(answers[i] = LDNS_XMALLOC(uint8_t, len))) {
+			continue;
+		}
+		memcpy(answers[i], msg, len);
+		answer_sizes[i] = len;
+		*next = i + 1;
+		matched++;
+		ldns_tcp_pool_keepalive(c, msg, len);
+	}
+	if (pos > 0) {
+		memmove(c->rbuf, c->rbuf + pos, c->rlen - pos);
+		c->rlen -= pos;
+	}
+	return matched;
+}
+
+/* Sends the queries that are not answered yet over c, and reads answers
+ * until all are in.  Returns LDNS_STATUS_OK when they are,
+ * LDNS_STATUS_NETWORK_ERR when no answer came for the timeout, and
+ * LDNS_STATUS_SOCKET_ERROR when the connection failed or was closed.
+ * *got is set to the number of answers received.
+ */
+static ldns_status
+ldns_tcp_pool_exchange(ldns_tcp_pool *pool, ldns_tcp_conn *c,
+		const uint8_t * const *queries, const size_t *query_lens,
+		size_t n, struct timeval timeout,
+		uint8_t **answers, size_t *answer_sizes,
+		size_t *answered, size_t *got)
+{
+	uint8_t *out;
+	size_t out_len = 0, out_pos = 0, i, next = 0;
+	struct timeval end;
+	ssize_t r;
+	int ev, ms;
+	ldns_status status = LDNS_STATUS_OK;
+
+	*got = 0;
+	if (!c->rbuf && !(c->rbuf = LDNS_XMALLOC(uint8_t,
+			LDNS_TCP_POOL_RBUF_SIZE))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	for (i = 0; i < n; i++) {
+		if (!answers[i]) {
+			out_len += 2 + query_lens[i]
+			         + LDNS_TCP_POOL_KEEPALIVE_LEN;
+		}
+	}
+	if (!(out = LDNS_XMALLOC(uint8_t, out_len))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	for (i = 0, out_len = 0; i < n; i++) {
+		if (!answers[i]) {
+			out_len += ldns_tcp_pool_frame(out + out_len,
+					queries[i], query_lens[i]);
+			pool->stats.queries++;
+		}
+	}
+	gettimeofday(&end, NULL);
+	ldns_tcp_pool_add_ms(&end, ldns_tcp_pool_timeval2ms(timeout));
+
+	while (*answered < n) {
+		if ((ms = ldns_tcp_pool_ms_until(&end)) == 0) {
+			status = LDNS_STATUS_NETWORK_ERR;
+			break;
+		}
+		ev = ldns_tcp_pool_wait(c->fd, out_pos < out_len, ms);
+		if (ev == 0) {
+			status = LDNS_STATUS_NETWORK_ERR;
+			break;
+		}
+		if (ev < 0) {
+			if (ldns_tcp_pool_again()) {
+				continue;
+			}
+			status = LDNS_STATUS_SOCKET_ERROR;
+			break;
+		}
+		if (ev & LDNS_TCP_POOL_OUT) {
+			r = send(c->fd, (void *)(out + out_pos),
+					out_len - out_pos, MSG_NOSIGNAL);
+			if (r > 0) {
+				out_pos += (size_t)r;
+			} else if (!ldns_tcp_pool_again()) {
+				status = LDNS_STATUS_SOCKET_ERROR;
+				break;
+			}
+		}
+		if (ev & LDNS_TCP_POOL_IN) {
+			r = recv(c->fd, (void *)(c->rbuf + c->rlen),
+					LDNS_TCP_POOL_RBUF_SIZE - c->rlen, 0);
+			if (r == 0 || (r < 0 && !ldns_tcp_pool_again())) {
+				/* closed by the nameserver */
+				status = LDNS_STATUS_SOCKET_ERROR;
+				break;
+			}
+			if (r < 0) {
+				continue;
+			}
+			c->rlen += (size_t)r;
+			if ((i = ldns_tcp_pool_read_answers(c, queries, n,
+					answers, answer_sizes, &next)) > 0) {
+				*answered += i;
+				*got += i;
+				gettimeofday(&end, NULL);
+				ldns_tcp_pool_add_ms(&end,
+					ldns_tcp_pool_timeval2ms(timeout));
+			}
+		}
+	}
+	LDNS_FREE(out);
+	return status;
+}
+
+ldns_status
+ldns_tcp_pool_send_many(ldns_tcp_pool *pool,
+		const ldns_rdf *ns, uint16_t port, const ldns_rdf *source,
+		const uint8_t * const *queries, const size_t *query_lens,
+		size_t n, struct timeval timeout,
+		uint8_t **answers, size_t *answer_sizes)
+{
+	ldns_tcp_conn *c;
+	struct timeval now;
+	size_t i, answered = 0, got;
+	bool fresh;
+	ldns_status status;
+
+	for (i = 0; i < n; i++) {
+		answers[i] = NULL;
+		answer_sizes[i] = 0;
+	}
+	for (i = 0; i < n; i++) {
+		if (query_lens[i] < LDNS_HEADER_SIZE
+		||  query_lens[i] > LDNS_MAX_PACKETLEN) {
+			return LDNS_STATUS_PACKET_OVERFLOW;
+		}
+	}
+	if (n == 0) {
+		return LDNS_STATUS_OK;
+	}
+	if (!(c = ldns_tcp_pool_conn(pool, ns, port, source))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	gettimeofday(&now, NULL);
+	if (c->fd != -1 && !timercmp(&now, &c->idle_until, <)) {
+		pool->stats.expired++;
+		close_socket(c->fd);
+	} else if (c->fd != -1 && !ldns_tcp_pool_alive(c)) {
+		close_socket(c->fd);
+	}
+	for (;;) {
+		if ((fresh = c->fd == -1)
+		&&  !ldns_tcp_pool_connect(pool, c, timeout)) {
+			status = LDNS_STATUS_SOCKET_ERROR;
+			break;
+		}
+		if (!fresh) {
+			pool->stats.reused += n - answered;
+		}
+		status = ldns_tcp_pool_exchange(pool, c, queries, query_lens,
+				n, timeout, answers, answer_sizes,
+				&answered, &got);
+		if (status == LDNS_STATUS_OK) {
+			break;
+		}
+		/* unanswered queries could still be answered, so this
+		 * connection is not used again */
+		close_socket(c->fd);
+		c->rlen = 0;
+		if (status != LDNS_STATUS_SOCKET_ERROR || (fresh && got == 0)) {
+			break;
+		}
+		/* closed by the nameserver; send the rest over a new
+		 * connection */
+		pool->stats.reconnects++;
+	}
+	if (status == LDNS_STATUS_OK) {
+		if (c->idle == 0) {
+			close_socket(c->fd);
+		} else {
+			gettimeofday(&c->idle_until, NULL);
+			ldns_tcp_pool_add_ms(&c->idle_until, c->idle);
+		}
+	} else if (status == LDNS_STATUS_SOCKET_ERROR && answered > 0) {
+		status = LDNS_STATUS_NETWORK_ERR;
+	}
+	return status;
+}
+
+ldns_status
+ldns_tcp_pool_send(ldns_tcp_pool *pool,
+		const ldns_rdf *ns, uint16_t port, const ldns_rdf *source,
+		const uint8_t *query, size_t query_len, struct timeval timeout,
+		uint8_t **answer, size_t *answer_size)
+{
+	return ldns_tcp_pool_send_many(pool, ns, port, source,
+			&query, &query_len, 1, timeout, answer, answer_size);
+}
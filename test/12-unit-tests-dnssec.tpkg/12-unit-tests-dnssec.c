@@ -121,6 +121,417 @@ check_ldns_canonicalization(void)
 	return status;
 }
 
+ldns_status
+check_ldns_nsec3_cache(void)
+{
+	const char *names[] = { "example.", "a.example.", "ai.example.",
+	                        "Ns1.Example.", "x.y.w.example.", NULL };
+	const char cache_file[] = "nsec3.cache";
+	const uint8_t salt[] = { 0xaa, 0xbb, 0xcc, 0xdd };
+	ldns_nsec3_cache *cache = ldns_nsec3_cache_new();
+	ldns_status status = LDNS_STATUS_OK;
+	ldns_rdf *name, *h1, *h2;
+	size_t i, round;
+
+	if (!cache) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	/* the second round is served from the saved file, the third
+	 * one uses another salt and must not return stale hashes
+	 */
+	for (round = 0; round < 3 && status == LDNS_STATUS_OK; round++) {
+		uint8_t salt_length = round < 2 ? 4 : 3;
+
+		if (ldns_nsec3_cache_load(cache, cache_file)
+				!= LDNS_STATUS_OK) {
+			printf("Error loading nsec3 cache\n");
+			status = LDNS_STATUS_ERR;
+			break;
+		}
+		for (i = 0; names[i] && status == LDNS_STATUS_OK; i++) {
+			(void) ldns_str2rdf_dname(&name, names[i]);
+			h1 = ldns_nsec3_hash_name(name, 1, 12,
+					salt_length, salt);
+			h2 = ldns_nsec3_cache_hash_name(cache, name, 1, 12,
+					salt_length, salt);
+			if (!h1 || !h2 || ldns_rdf_compare(h1, h2) != 0) {
+				printf("Error, cached nsec3 hash differs "
+				       "for %s\n", names[i]);
+				status = LDNS_STATUS_ERR;
+			}
+			ldns_rdf_deep_free(name);
+			ldns_rdf_deep_free(h1);
+			ldns_rdf_deep_free(h2);
+		}
+		if (ldns_nsec3_cache_hits(cache) != (round == 0 ? 0 : 5)) {
+			printf("Error, unexpected number of nsec3 cache hits "
+			       "in round %d\n", (int)round);
+			status = LDNS_STATUS_ERR;
+		}
+		if (ldns_nsec3_cache_save(cache, cache_file)
+				!= LDNS_STATUS_OK) {
+			printf("Error saving nsec3 cache\n");
+			status = LDNS_STATUS_ERR;
+		}
+	}
+	ldns_nsec3_cache_free(cache);
+	(void) remove(cache_file);
+	return status;
+}
+
+ldns_status
+check_ldns_dnssec_zone_verify_signatures(void)
+{
+	const char *rrs[] = {
+		"example. 3600 IN SOA ns.example. host.example. 1 2 3 4 5",
+		"example. 3600 IN NS ns.example.",
+		"ns.example. 3600 IN A 192.0.2.1",
+		"*.example. 3600 IN TXT \"wildcard\"",
+		"a.example. 3600 IN A 192.0.2.2",
+		"a.example. 3600 IN A 192.0.2.3", NULL };
+	ldns_dnssec_zone *zone = ldns_dnssec_zone_new();
+	ldns_dnssec_verify_errors *errors = NULL;
+	ldns_key_list *keys = ldns_key_list_new();
+	ldns_rr_list *new_rrs = ldns_rr_list_new();
+	ldns_key *key = ldns_key_new_frm_algorithm(LDNS_SIGN_ECDSAP256SHA256, 0);
+	ldns_status status = LDNS_STATUS_ERR;
+	ldns_rdf *origin = NULL, *tampered = NULL;
+	ldns_dnskey_cache *keycache = NULL;
+	ldns_dnssec_rrsets *soa;
+	ldns_rr_list *soa_list = NULL, *key_list = NULL;
+	ldns_rr *rr, *dnskey;
+	size_t i;
+
+	if (!zone || !keys || !new_rrs || !key
+	||  ldns_str2rdf_dname(&origin, "example.") != LDNS_STATUS_OK) {
+		goto error;
+	}
+	ldns_key_set_pubkey_owner(key, ldns_rdf_clone(origin));
+	ldns_key_set_flags(key, LDNS_KEY_ZONE_KEY);
+	ldns_key_list_push_key(keys, key);
+	if (!(rr = ldns_key2rr(key))) {
+		goto error;
+	}
+	ldns_key_set_keytag(key, ldns_calc_keytag(rr));
+	dnskey = rr;
+	if (ldns_dnssec_zone_add_rr(zone, rr) != LDNS_STATUS_OK) {
+		goto error;
+	}
+	for (i = 0; rrs[i]; i++) {
+		if (ldns_rr_new_frm_str(&rr, rrs[i], 0, NULL, NULL)
+				!= LDNS_STATUS_OK
+		||  ldns_dnssec_zone_add_rr(zone, rr) != LDNS_STATUS_OK) {
+			goto error;
+		}
+	}
+	if (ldns_dnssec_zone_sign(zone, new_rrs, keys,
+			ldns_dnssec_default_replace_signatures, NULL)
+			!= LDNS_STATUS_OK) {
+		goto error;
+	}
+	status = ldns_dnssec_zone_verify_signatures(zone, NULL, ldns_time(NULL),
+			0, 0, 2, &errors);
+	if (status != LDNS_STATUS_OK || !errors || errors->count != 0
+	||  errors->rrsets != 10) {
+		printf("Error verifying signed zone: %s\n",
+				ldns_get_errorstr_by_id(status));
+		status = LDNS_STATUS_ERR;
+		goto error;
+	}
+	ldns_dnssec_verify_errors_free(errors);
+	errors = NULL;
+
+	/* The same with the keys given in a list and in a key cache */
+	key_list = ldns_rr_list_new();
+	if (!key_list || !ldns_rr_list_push_rr(key_list, dnskey)
+	||  ldns_dnssec_zone_verify_signatures(zone, key_list,
+			ldns_time(NULL), 0, 0, 2, NULL) != LDNS_STATUS_OK
+	||  !(keycache = ldns_dnskey_cache_new())
+	||  ldns_dnskey_cache_add_rr_list(keycache, key_list) != LDNS_STATUS_OK
+	||  ldns_dnssec_zone_verify_signatures_keycache(zone, keycache,
+			ldns_time(NULL), 0, 0, 2, NULL) != LDNS_STATUS_OK) {
+		printf("Error verifying signed zone with given keys\n");
+		status = LDNS_STATUS_ERR;
+		goto error;
+	}
+	ldns_dnskey_cache_free(keycache);
+	keycache = NULL;
+
+	/* The SOA verifies with a key cache holding the (duplicate) key */
+	soa = ldns_dnssec_zone_find_rrset(zone, origin, LDNS_RR_TYPE_SOA);
+	soa_list = ldns_rr_list_new();
+	if (!(keycache = ldns_dnskey_cache_new()) || !soa || !soa_list
+	||  ldns_dnskey_cache_add_rr(keycache, dnskey) != LDNS_STATUS_OK
+	||  ldns_dnskey_cache_add_rr(keycache, dnskey) != LDNS_STATUS_OK
+	||  ldns_dnskey_cache_count(keycache) != 1
+	||  !ldns_rr_list_push_rr(soa_list, soa->rrs->rr)
+	||  ldns_verify_rrsig_keycache(soa_list, soa->signatures->rr,
+			keycache, NULL) != LDNS_STATUS_OK
+	||  ldns_rr_compare(dnskey, ldns_dnssec_get_dnskey_for_rrsig_keycache(
+			soa->signatures->rr, keycache)) != 0
+	||  ldns_dnskey_cache_lookup(keycache, origin,
+			ldns_key_algorithm(key), ldns_key_keytag(key) + 1)) {
+		printf("Error verifying with a key cache\n");
+		status = LDNS_STATUS_ERR;
+		goto error;
+	}
+
+	/* Change the address of the last A RR of a.example. */
+	(void) ldns_str2rdf_dname(&tampered, "a.example.");
+	rr = ldns_dnssec_zone_find_rrset(zone, tampered,
+			LDNS_RR_TYPE_A)->rrs->rr;
+	ldns_rdf_deep_free(ldns_rr_set_rdf(rr,
+			ldns_rdf_new_frm_str(LDNS_RDF_TYPE_A, "192.0.2.4"), 0));
+	status = ldns_dnssec_zone_verify_signatures(zone, NULL, ldns_time(NULL),
+			0, 0, 2, &errors);
+	if (status != LDNS_STATUS_CRYPTO_BOGUS || !errors
+	||  errors->count != 1 || errors->errors[0].type != LDNS_RR_TYPE_A
+	||  ldns_dname_compare(errors->errors[0].name, tampered) != 0
+	||  errors->errors[0].keytag != ldns_key_keytag(key)) {
+		printf("Error, tampered RRset not reported correctly: %s\n",
+				ldns_get_errorstr_by_id(status));
+		status = LDNS_STATUS_ERR;
+		goto error;
+	}
+	status = LDNS_STATUS_OK;
+error:
+	ldns_dnssec_verify_errors_free(errors);
+	ldns_dnskey_cache_free(keycache);
+	ldns_rr_list_free(soa_list);
+	ldns_rr_list_free(key_list);
+	ldns_rdf_deep_free(tampered);
+	ldns_rdf_deep_free(origin);
+	ldns_rr_list_free(new_rrs);
+	ldns_key_list_free(keys);
+	ldns_dnssec_zone_deep_free(zone);
+	return status;
+}
+
+static ldns_status
+check_ldns_trust_cache(void)
+{
+	const time_t inception = 1000000000, expiration = 1000007200;
+	ldns_key *key = ldns_key_new_frm_algorithm(LDNS_SIGN_ECDSAP256SHA256, 0);
+	ldns_key_list *keys = ldns_key_list_new();
+	ldns_rr_list *rrset = ldns_rr_list_new(), *sigs = NULL, *r1, *r2, *r3;
+	ldns_trust_cache *tc = ldns_trust_cache_new();
+	ldns_trust_cache_stats stats;
+	ldns_status status = LDNS_STATUS_ERR;
+	ldns_resolver *res = ldns_resolver_new();
+	ldns_rr_list *validating = ldns_rr_list_new(), *bad = NULL;
+	ldns_rdf *origin = NULL;
+	ldns_rr *rr;
+
+	if (!key || !keys || !rrset || !tc || !res || !validating
+	||  ldns_str2rdf_dname(&origin, "example.") != LDNS_STATUS_OK) {
+		goto error;
+	}
+	ldns_key_set_pubkey_owner(key, ldns_rdf_clone(origin));
+	ldns_key_set_flags(key, LDNS_KEY_ZONE_KEY);
+	ldns_key_set_inception(key, (uint32_t)inception);
+	ldns_key_set_expiration(key, (uint32_t)expiration);
+	ldns_key_list_push_key(keys, key);
+	if (!(rr = ldns_key2rr(key))) {
+		goto error;
+	}
+	ldns_key_set_keytag(key, ldns_calc_keytag(rr));
+	ldns_rr_set_ttl(rr, 86400);
+	ldns_rr_list_push_rr(rrset, rr);
+	if (!(sigs = ldns_sign_public(rrset, keys))) {
+		goto error;
+	}
+	/* Unsigned RRsets are not kept, signed ones until their RRSIGs expire */
+	if (ldns_trust_cache_store(tc, origin, LDNS_RR_TYPE_DNSKEY, rrset,
+			NULL, inception + 100) != LDNS_STATUS_ERR
+	||  ldns_trust_cache_store(tc, origin, LDNS_RR_TYPE_DNSKEY, rrset,
+			sigs, inception + 100) != LDNS_STATUS_OK) {
+		printf("Error storing in the trust cache\n");
+		goto error;
+	}
+	r1 = ldns_trust_cache_lookup(tc, origin, LDNS_RR_TYPE_DNSKEY,
+			inception + 100);
+	r2 = ldns_trust_cache_lookup(tc, origin, LDNS_RR_TYPE_DNSKEY,
+			expiration - 1);
+	r3 = ldns_trust_cache_lookup(tc, origin, LDNS_RR_TYPE_DS,
+			inception + 100);
+	if (!r1 || ldns_rr_list_compare(r1, rrset) != 0 || !r2 || r3
+	||  ldns_trust_cache_lookup(tc, origin, LDNS_RR_TYPE_DNSKEY,
+			inception - 1)) {
+		printf("Error looking up in the trust cache\n");
+		status = LDNS_STATUS_ERR;
+	} else {
+		status = LDNS_STATUS_OK;
+	}
+	ldns_rr_list_deep_free(r1);
+	ldns_rr_list_deep_free(r2);
+	ldns_rr_list_deep_free(r3);
+	if (status == LDNS_STATUS_OK
+	&&  (ldns_trust_cache_lookup(tc, origin, LDNS_RR_TYPE_DNSKEY,
+			expiration)
+	||   (ldns_trust_cache_get_stats(tc, &stats), stats.entries != 0)
+	||   stats.hits != 2 || stats.expired != 1)) {
+		printf("Error, expired RRset found in the trust cache\n");
+		status = LDNS_STATUS_ERR;
+	}
+	/* The trusted keys come from the cache, without any queries */
+	if (status == LDNS_STATUS_OK
+	&&  (ldns_resolver_push_dnssec_anchor(res, rr) != LDNS_STATUS_OK
+	||   ldns_trust_cache_store(tc, origin, LDNS_RR_TYPE_DNSKEY, rrset,
+			sigs, inception + 100) != LDNS_STATUS_OK
+	||   ldns_verify_trusted_cached(res, rrset, sigs, inception + 100,
+			tc, validating) != LDNS_STATUS_OK
+	||   ldns_rr_list_rr_count(validating) != 1
+	||   ldns_rr_compare(ldns_rr_list_rr(validating, 0), rr) != 0
+	||   !(bad = ldns_rr_list_clone(rrset))
+	||   !ldns_rr_dnskey_set_flags(ldns_rr_list_rr(bad, 0),
+			ldns_native2rdf_int16(LDNS_RDF_TYPE_INT16, 257))
+	||   ldns_verify_trusted_cached(res, bad, sigs, inception + 100,
+			tc, NULL) != LDNS_STATUS_CRYPTO_BOGUS)) {
+		printf("Error verifying with keys from the trust cache\n");
+		status = LDNS_STATUS_ERR;
+	}
+error:
+	ldns_rr_list_deep_free(bad);
+	ldns_rr_list_deep_free(validating);
+	ldns_resolver_deep_free(res);
+	ldns_trust_cache_free(tc);
+	ldns_rr_list_deep_free(sigs);
+	ldns_rr_list_deep_free(rrset);
+	ldns_rdf_deep_free(origin);
+	ldns_key_list_free(keys);
+	return status;
+}
+
+/* Sets the digest of the ZONEMD RR with the given hash algorithm, to the
+ * given digest or to zeroes when it is NULL.
+ */
+static void
+set_zonemd_digest(ldns_dnssec_rrsets *zonemd, uint8_t hash,
+		const uint8_t *digest, size_t len)
+{
+	uint8_t zeroes[LDNS_SHA512_DIGEST_LENGTH];
+	ldns_dnssec_rrs *rrs;
+
+	memset(zeroes, 0, sizeof(zeroes));
+	for (rrs = zonemd->rrs; rrs; rrs = rrs->next) {
+		if (ldns_rdf2native_int8(ldns_rr_rdf(rrs->rr, 2)) == hash) {
+			ldns_rdf_deep_free(ldns_rr_set_rdf(rrs->rr,
+				ldns_rdf_new_frm_data(LDNS_RDF_TYPE_HEX, len,
+					digest ? digest : zeroes), 3));
+		}
+	}
+}
+
+/* Zones with many names are digested in a pipeline with a thread per hash
+ * algorithm, which must give the same digests as one RR at a time.
+ */
+static ldns_status
+check_ldns_dnssec_zone_verify_zonemd(void)
+{
+	uint8_t sha384[LDNS_SHA384_DIGEST_LENGTH];
+	uint8_t sha512[LDNS_SHA512_DIGEST_LENGTH];
+	ldns_dnssec_zone *zone = ldns_dnssec_zone_new();
+	ldns_buffer *buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_status status = LDNS_STATUS_OK;
+	ldns_sha384_CTX ctx384;
+	ldns_sha512_CTX ctx512;
+	ldns_dnssec_rrsets *rrset, *zonemd;
+	ldns_dnssec_rrs *rrs;
+	ldns_rbnode_t *node;
+	ldns_rdf *origin = NULL;
+	ldns_rr *rr;
+	char str[256];
+	size_t i;
+
+	if (!zone || !buf
+	||  ldns_str2rdf_dname(&origin, "example.") != LDNS_STATUS_OK) {
+		status = LDNS_STATUS_MEM_ERR;
+		goto error;
+	}
+	/* enough names for the pipeline, and data for a few batches */
+	for (i = 0; i < 30002 && status == LDNS_STATUS_OK; i++) {
+		if (i == 0) {
+			snprintf(str, sizeof(str), "example. 3600 IN SOA "
+			         "ns.example. host.example. 7 2 3 4 5");
+		} else if (i == 1) {
+			snprintf(str, sizeof(str), "example. 3600 IN ZONEMD "
+			         "7 1 1 %096d", 0);
+		} else if (i == 2) {
+			snprintf(str, sizeof(str), "example. 3600 IN ZONEMD "
+			         "7 1 2 %0128d", 0);
+		} else if (i % 2) {
+			snprintf(str, sizeof(str), "H%u.example. 3600 IN A "
+			         "192.0.2.%u", (unsigned)i, (unsigned)i % 250);
+		} else {
+			snprintf(str, sizeof(str), "h%u.example. 3600 IN TXT "
+			         "\"v=spf1 ip4:192.0.2.0/24 -all\" \"%u\"",
+			         (unsigned)i - 1, (unsigned)i);
+		}
+		if ((status = ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL))
+				== LDNS_STATUS_OK
+		&&  (status = ldns_dnssec_zone_add_rr(zone, rr))
+				!= LDNS_STATUS_OK) {
+			ldns_rr_free(rr);
+		}
+	}
+	if (status != LDNS_STATUS_OK) {
+		printf("Error creating the zone: %s\n",
+		       ldns_get_errorstr_by_id(status));
+		goto error;
+	}
+	ldns_sha384_init(&ctx384);
+	ldns_sha512_init(&ctx512);
+	for (node = ldns_rbtree_first(zone->names); node != LDNS_RBTREE_NULL;
+			node = ldns_rbtree_next(node)) {
+		rrset = ((ldns_dnssec_name *)node->data)->rrsets;
+		for (; rrset; rrset = rrset->next) {
+			if (rrset->type == LDNS_RR_TYPE_ZONEMD) {
+				continue;
+			}
+			for (rrs = rrset->rrs; rrs; rrs = rrs->next) {
+				ldns_buffer_clear(buf);
+				(void) ldns_rr2buffer_wire_canonical(buf,
+					rrs->rr, LDNS_SECTION_ANSWER);
+				ldns_sha384_update(&ctx384,
+					ldns_buffer_begin(buf),
+					ldns_buffer_position(buf));
+				ldns_sha512_update(&ctx512,
+					ldns_buffer_begin(buf),
+					ldns_buffer_position(buf));
+			}
+		}
+	}
+	ldns_sha384_final(sha384, &ctx384);
+	ldns_sha512_final(sha512, &ctx512);
+
+	/* Both digests are computed each time, only one of them is right */
+	zonemd = ldns_dnssec_zone_find_rrset(zone, origin,
+			LDNS_RR_TYPE_ZONEMD);
+	if (!zonemd
+	||  ldns_dnssec_zone_verify_zonemd(zone)
+			!= LDNS_STATUS_NO_VALID_ZONEMD) {
+		printf("Error, wrong ZONEMD digests were accepted\n");
+		status = LDNS_STATUS_ERR;
+		goto error;
+	}
+	set_zonemd_digest(zonemd, 1, sha384, sizeof(sha384));
+	if (ldns_dnssec_zone_verify_zonemd(zone) != LDNS_STATUS_OK) {
+		printf("Error, the SHA384 ZONEMD digest differs\n");
+		status = LDNS_STATUS_ERR;
+	}
+	set_zonemd_digest(zonemd, 1, NULL, sizeof(sha384));
+	set_zonemd_digest(zonemd, 2, sha512, sizeof(sha512));
+	if (ldns_dnssec_zone_verify_zonemd(zone) != LDNS_STATUS_OK) {
+		printf("Error, the SHA512 ZONEMD digest differs\n");
+		status = LDNS_STATUS_ERR;
+	}
+error:
+	ldns_rdf_deep_free(origin);
+	ldns_buffer_free(buf);
+	ldns_dnssec_zone_deep_free(zone);
+	return status;
+}
+
 int main(void)
 {
 	int result = EXIT_SUCCESS;
@@ -135,5 +546,25 @@ int main(void)
 		result = EXIT_FAILURE;
 	}
 
+	if (check_ldns_nsec3_cache() != LDNS_STATUS_OK) {
+		printf("ldns_nsec3_cache_hash_name() failed.\n");
+		result = EXIT_FAILURE;
+	}
+
+	if (check_ldns_dnssec_zone_verify_signatures() != LDNS_STATUS_OK) {
+		printf("ldns_dnssec_zone_verify_signatures() failed.\n");
+		result = EXIT_FAILURE;
+	}
+
+	if (check_ldns_trust_cache() != LDNS_STATUS_OK) {
+		printf("ldns_trust_cache_lookup() failed.\n");
+		result = EXIT_FAILURE;
+	}
+
+	if (check_ldns_dnssec_zone_verify_zonemd() != LDNS_STATUS_OK) {
+		printf("ldns_dnssec_zone_verify_zonemd() failed.\n");
+		result = EXIT_FAILURE;
+	}
+
 	exit(result);
 }
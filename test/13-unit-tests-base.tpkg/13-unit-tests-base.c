@@ -4,6 +4,13 @@
 #include "ldns/config.h"
 
 #include <ldns/ldns.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
 
 int test_duration(void)
 {
@@ -428,6 +435,1801 @@ test_sha256(const void *data, const void *expect_result_str)
 	return result;
 }
 
+/* compare the batch functions with the incremental ones */
+int
+test_sha_many(void)
+{
+	const unsigned char *msgs[150];
+	size_t lens[150];
+	unsigned char data[150 * 151];
+	unsigned char sha1s[150 * LDNS_SHA1_DIGEST_LENGTH];
+	unsigned char sha256s[150 * LDNS_SHA256_DIGEST_LENGTH];
+	unsigned char digest[LDNS_SHA256_DIGEST_LENGTH];
+	ldns_sha1_ctx sha1_ctx;
+	ldns_sha256_CTX sha256_ctx;
+	size_t i;
+	int result = 0;
+
+	for (i = 0; i < sizeof(data); i++) {
+		data[i] = (unsigned char)(i * 7 + 3);
+	}
+	for (i = 0; i < 150; i++) {
+		msgs[i] = data + i * 151;
+		lens[i] = i;
+	}
+	ldns_sha1_many(150, msgs, lens, sha1s);
+	ldns_sha256_many(150, msgs, lens, sha256s);
+
+	for (i = 0; i < 150; i++) {
+		ldns_sha1_init(&sha1_ctx);
+		ldns_sha1_update(&sha1_ctx, msgs[i], (unsigned int)lens[i]);
+		ldns_sha1_final(digest, &sha1_ctx);
+		if (memcmp(digest, sha1s + i * LDNS_SHA1_DIGEST_LENGTH,
+		           LDNS_SHA1_DIGEST_LENGTH) != 0) {
+			printf("Bad ldns_sha1_many digest for length %u\n",
+			       (unsigned int)i);
+			result = 1;
+		}
+		ldns_sha256_init(&sha256_ctx);
+		ldns_sha256_update(&sha256_ctx, msgs[i], lens[i]);
+		ldns_sha256_final(digest, &sha256_ctx);
+		if (memcmp(digest, sha256s + i * LDNS_SHA256_DIGEST_LENGTH,
+		           LDNS_SHA256_DIGEST_LENGTH) != 0) {
+			printf("Bad ldns_sha256_many digest for length %u\n",
+			       (unsigned int)i);
+			result = 1;
+		}
+	}
+	return result;
+}
+
+/* The NSEC3 hash, without the zone, of name in example. with no salt
+ * and no extra iterations */
+static void
+cache_nsec3_hash(const char *name, char *hash, size_t len)
+{
+	ldns_rdf *dname = ldns_dname_new_frm_str(name);
+	ldns_rdf *hashed = ldns_nsec3_hash_name(dname, 1, 0, 0, NULL);
+	char *str = ldns_rdf2str(hashed);
+
+	snprintf(hash, len, "%s", str);
+	hash[strlen(hash) - 1] = 0;
+	LDNS_FREE(str);
+	ldns_rdf_deep_free(hashed);
+	ldns_rdf_deep_free(dname);
+}
+
+/* Stores a NXDOMAIN answer for example. with the NSEC3 records of the
+ * owner and next hashes given, each with the types of the apex */
+static ldns_status
+cache_store_nsec3s(ldns_cache *cache, const char **hashes, size_t count)
+{
+	ldns_pkt *answer = ldns_pkt_new();
+	ldns_status s;
+	ldns_rr *rr;
+	char str[256];
+	size_t i;
+
+	ldns_pkt_set_rcode(answer, LDNS_RCODE_NXDOMAIN);
+	(void) ldns_rr_new_frm_str(&rr, "example. 3600 IN SOA ns.example. "
+			"host.example. 1 3600 900 604800 60", 0, NULL, NULL);
+	ldns_pkt_push_rr(answer, LDNS_SECTION_AUTHORITY, rr);
+	for (i = 0; i < count; i++) {
+		snprintf(str, sizeof(str), "%s.example. 60 IN NSEC3 1 0 0 - "
+			"%s NS SOA RRSIG DNSKEY NSEC3PARAM", hashes[2 * i],
+			hashes[2 * i + 1]);
+		(void) ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL);
+		ldns_pkt_push_rr(answer, LDNS_SECTION_AUTHORITY, rr);
+		snprintf(str, sizeof(str), "%s.example. 60 IN RRSIG NSEC3 8 2 "
+			"60 20300101000000 20200101000000 1 example. AAAA",
+			hashes[2 * i]);
+		(void) ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL);
+		ldns_pkt_push_rr(answer, LDNS_SECTION_AUTHORITY, rr);
+	}
+	s = ldns_cache_store_denial(cache, answer);
+	ldns_pkt_free(answer);
+	return s;
+}
+
+/* The rcode the cache makes for name, or -1 when it has no answer */
+static int
+cache_rcode(ldns_cache *cache, const char *name, ldns_rr_type type)
+{
+	ldns_pkt *query, *hit;
+	int rcode = -1;
+
+	query = ldns_pkt_query_new(ldns_dname_new_frm_str(name), type,
+			LDNS_RR_CLASS_IN, LDNS_RD);
+	if ((hit = ldns_cache_lookup(cache, query))) {
+		rcode = (int)ldns_pkt_get_rcode(hit);
+		ldns_pkt_free(hit);
+	}
+	ldns_pkt_free(query);
+	return rcode;
+}
+
+/* NXDOMAIN and NODATA from NSEC3 records, and none from a record that
+ * does not cover the name */
+static int
+test_cache_nsec3(void)
+{
+	char apex[64], name[64], hash[64];
+	const char *last = "vvvvvvvvvvvvvvvvvvvvvvvvvvvvvvvv";
+	const char *first = "00000000000000000000000000000000";
+	const char *hashes[4];
+	ldns_cache *cache;
+	unsigned i;
+	int result = 0;
+
+	/* a name that hashes before the apex */
+	cache_nsec3_hash("example.", apex, sizeof(apex));
+	for (i = 0; i < 100; i++) {
+		snprintf(name, sizeof(name), "n%u.example.", i);
+		cache_nsec3_hash(name, hash, sizeof(hash));
+		if (strcmp(hash, apex) < 0) {
+			break;
+		}
+	}
+	if (i == 100) {
+		printf("cache nsec3: no name hashes before the apex\n");
+		return 1;
+	}
+
+	/* The only NSEC3 goes from the apex to the end and does not wrap,
+	 * so it covers nothing before the apex */
+	cache = ldns_cache_new(0);
+	hashes[0] = apex;
+	hashes[1] = last;
+	if (cache_store_nsec3s(cache, hashes, 1) != LDNS_STATUS_OK) {
+		printf("cache nsec3: NSEC3 not stored\n");
+		result = 1;
+	}
+	if (cache_rcode(cache, "example.", LDNS_RR_TYPE_TXT)
+			!= LDNS_RCODE_NOERROR) {
+		printf("cache nsec3: no NODATA for the apex\n");
+		result = 1;
+	}
+	if (cache_rcode(cache, "example.", LDNS_RR_TYPE_SOA) != -1) {
+		printf("cache nsec3: NODATA for a type that exists\n");
+		result = 1;
+	}
+	if (cache_rcode(cache, name, LDNS_RR_TYPE_A) != -1) {
+		printf("cache nsec3: %s denied by an NSEC3 that does not "
+			"cover it\n", name);
+		result = 1;
+	}
+
+	/* with the hashes before the apex covered too, it is denied */
+	hashes[2] = first;
+	hashes[3] = apex;
+	if (cache_store_nsec3s(cache, hashes + 2, 1) != LDNS_STATUS_OK) {
+		printf("cache nsec3: NSEC3 not stored\n");
+		result = 1;
+	}
+	if (cache_rcode(cache, name, LDNS_RR_TYPE_A) != LDNS_RCODE_NXDOMAIN) {
+		printf("cache nsec3: no NXDOMAIN for %s\n", name);
+		result = 1;
+	}
+	ldns_cache_free(cache);
+	return result;
+}
+
+/* store and look up answers in a ldns_cache */
+int
+test_cache(void)
+{
+	ldns_cache *cache;
+	ldns_cache_stats stats;
+	ldns_pkt *query, *answer, *hit;
+	ldns_rr *rr;
+	int result = 0;
+
+	cache = ldns_cache_new(0);
+	query = ldns_pkt_query_new(ldns_dname_new_frm_str("www.example."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	answer = ldns_pkt_clone(query);
+	ldns_pkt_set_qr(answer, true);
+	(void) ldns_rr_new_frm_str(&rr, "www.example. 300 IN A 192.0.2.1",
+			0, NULL, NULL);
+	ldns_pkt_push_rr(answer, LDNS_SECTION_ANSWER, rr);
+	if (ldns_cache_store(cache, query, answer) != LDNS_STATUS_OK) {
+		printf("Answer not stored in cache\n");
+		result = 1;
+	}
+	ldns_pkt_free(query);
+	ldns_pkt_free(answer);
+
+	/* names are compared case insensitive, and the ID is the query's */
+	query = ldns_pkt_query_new(ldns_dname_new_frm_str("WWW.Example."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	ldns_pkt_set_id(query, 4711);
+	hit = ldns_cache_lookup(cache, query);
+	if (!hit || ldns_pkt_id(hit) != 4711 || ldns_pkt_ancount(hit) != 1
+	    || ldns_rr_ttl(ldns_rr_list_rr(ldns_pkt_answer(hit), 0)) > 300) {
+		printf("Bad answer from cache\n");
+		result = 1;
+	}
+	ldns_pkt_free(hit);
+
+	/* the RD bit is part of the key */
+	ldns_pkt_set_rd(query, false);
+	if ((hit = ldns_cache_lookup(cache, query))) {
+		printf("Answer from cache for query without RD\n");
+		ldns_pkt_free(hit);
+		result = 1;
+	}
+	ldns_pkt_free(query);
+
+	/* negative answers need a SOA, and SERVFAIL is not cached */
+	query = ldns_pkt_query_new(ldns_dname_new_frm_str("nx.example."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	answer = ldns_pkt_clone(query);
+	ldns_pkt_set_qr(answer, true);
+	ldns_pkt_set_rcode(answer, LDNS_RCODE_NXDOMAIN);
+	if (ldns_cache_store(cache, query, answer) != LDNS_STATUS_ERR) {
+		printf("Negative answer without SOA stored in cache\n");
+		result = 1;
+	}
+	(void) ldns_rr_new_frm_str(&rr, "example. 3600 IN SOA ns.example. "
+			"host.example. 1 3600 900 604800 60", 0, NULL, NULL);
+	ldns_pkt_push_rr(answer, LDNS_SECTION_AUTHORITY, rr);
+	if (ldns_cache_store(cache, query, answer) != LDNS_STATUS_OK) {
+		printf("Negative answer not stored in cache\n");
+		result = 1;
+	}
+	ldns_pkt_set_rcode(answer, LDNS_RCODE_SERVFAIL);
+	if (ldns_cache_store(cache, query, answer) != LDNS_STATUS_ERR) {
+		printf("SERVFAIL stored in cache\n");
+		result = 1;
+	}
+	ldns_pkt_free(answer);
+	hit = ldns_cache_lookup(cache, query);
+	if (!hit || ldns_pkt_get_rcode(hit) != LDNS_RCODE_NXDOMAIN) {
+		printf("Bad negative answer from cache\n");
+		result = 1;
+	}
+	ldns_pkt_free(hit);
+	ldns_pkt_free(query);
+
+	ldns_cache_get_stats(cache, &stats);
+	if (stats.hits != 2 || stats.misses != 1 || stats.stores != 2
+	    || stats.entries != 2) {
+		printf("Bad cache counters\n");
+		result = 1;
+	}
+	ldns_cache_flush(cache);
+	ldns_cache_get_stats(cache, &stats);
+	if (stats.entries != 0 || stats.bytes != 0) {
+		printf("Cache not empty after flush\n");
+		result = 1;
+	}
+
+	/* NXDOMAIN for other names from the NSEC records (RFC 8198) */
+	answer = ldns_pkt_new();
+	ldns_pkt_set_rcode(answer, LDNS_RCODE_NXDOMAIN);
+	(void) ldns_rr_new_frm_str(&rr, "example. 3600 IN SOA ns.example. "
+			"host.example. 1 3600 900 604800 60", 0, NULL, NULL);
+	ldns_pkt_push_rr(answer, LDNS_SECTION_AUTHORITY, rr);
+	(void) ldns_rr_new_frm_str(&rr, "example. 60 IN NSEC www.example. "
+			"NS SOA RRSIG NSEC", 0, NULL, NULL);
+	ldns_pkt_push_rr(answer, LDNS_SECTION_AUTHORITY, rr);
+	(void) ldns_rr_new_frm_str(&rr, "example. 60 IN RRSIG NSEC 8 1 60 "
+			"20300101000000 20200101000000 1 example. AAAA",
+			0, NULL, NULL);
+	ldns_pkt_push_rr(answer, LDNS_SECTION_AUTHORITY, rr);
+	if (ldns_cache_store_denial(cache, answer) != LDNS_STATUS_OK) {
+		printf("NSEC not stored in cache\n");
+		result = 1;
+	}
+	ldns_pkt_free(answer);
+	query = ldns_pkt_query_new(ldns_dname_new_frm_str("nx.example."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	hit = ldns_cache_lookup(cache, query);
+	if (!hit || ldns_pkt_get_rcode(hit) != LDNS_RCODE_NXDOMAIN) {
+		printf("No NXDOMAIN made from NSEC in cache\n");
+		result = 1;
+	}
+	ldns_pkt_free(hit);
+	ldns_pkt_free(query);
+	ldns_cache_free(cache);
+
+	if (test_cache_nsec3())
+		result = 1;
+	return result;
+}
+
+static void
+compression_node_free(ldns_rbnode_t *node, void *arg)
+{
+	(void)arg;
+	ldns_rdf_deep_free((ldns_rdf *)node->key);
+	LDNS_FREE(node);
+}
+
+/* name compression with a compression table, also when it is full */
+int
+test_compression(void)
+{
+	ldns_buffer *table_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *tree_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_rbtree_t *tree = ldns_rbtree_create(
+			(int (*)(const void *, const void *))ldns_dname_compare);
+	ldns_pkt *pkt, *back = NULL;
+	ldns_rr *rr;
+	char str[128];
+	int result = 0;
+	unsigned i;
+
+	pkt = ldns_pkt_query_new(ldns_dname_new_frm_str("www.Example."),
+			LDNS_RR_TYPE_NS, LDNS_RR_CLASS_IN, LDNS_RD);
+	for (i = 0; i < 10; i++) {
+		snprintf(str, sizeof(str), "WWW.example. NS ns%u.www.EXAMPLE.", i);
+		(void) ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL);
+		ldns_pkt_push_rr(pkt, LDNS_SECTION_ANSWER, rr);
+	}
+	(void) ldns_pkt2buffer_wire(table_buf, pkt);
+	(void) ldns_pkt2buffer_wire_compress(tree_buf, pkt, tree);
+	if (ldns_buffer_position(table_buf) != ldns_buffer_position(tree_buf)
+	||  memcmp(ldns_buffer_begin(table_buf), ldns_buffer_begin(tree_buf),
+			ldns_buffer_position(tree_buf)) != 0) {
+		printf("Compression with a table differs from a tree\n");
+		result = 1;
+	}
+
+	/* More names than fit in the table */
+	for (i = 0; i < 300; i++) {
+		snprintf(str, sizeof(str), "n%u.sub%u.example. NS ns.n%u.example.",
+				i, i % 7, i);
+		(void) ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL);
+		ldns_pkt_push_rr(pkt, LDNS_SECTION_AUTHORITY, rr);
+	}
+	ldns_buffer_clear(table_buf);
+	if (ldns_pkt2buffer_wire(table_buf, pkt) != LDNS_STATUS_OK
+	||  ldns_wire2pkt(&back, ldns_buffer_begin(table_buf),
+			ldns_buffer_position(table_buf)) != LDNS_STATUS_OK
+	||  ldns_rr_list_compare(ldns_pkt_answer(pkt),
+			ldns_pkt_answer(back)) != 0
+	||  ldns_rr_list_compare(ldns_pkt_authority(pkt),
+			ldns_pkt_authority(back)) != 0) {
+		printf("Packet not the same after compression\n");
+		result = 1;
+	}
+	ldns_pkt_free(back);
+	ldns_pkt_free(pkt);
+	ldns_traverse_postorder(tree, compression_node_free, NULL);
+	ldns_rbtree_free(tree);
+	ldns_buffer_free(table_buf);
+	ldns_buffer_free(tree_buf);
+	return result;
+}
+
+int
+test_pkt_view(void)
+{
+	ldns_buffer *buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_pkt *pkt, *back = NULL;
+	ldns_pkt_view view;
+	ldns_pkt_view_rr vrr;
+	ldns_rr *rr, *vr;
+	uint8_t name[LDNS_MAX_DOMAINLEN];
+	/* A question with a name that points to itself */
+	uint8_t loop[] = { 0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00,
+			   0x00, 0x00, 0x00, 0x00, 0xc0, 0x0c, 0x00, 0x01,
+			   0x00, 0x01 };
+	char str[128];
+	size_t len;
+	int result = 0;
+	unsigned i;
+	bool more;
+
+	pkt = ldns_pkt_query_new(ldns_dname_new_frm_str("www.Example."),
+			LDNS_RR_TYPE_NS, LDNS_RR_CLASS_IN, LDNS_RD);
+	for (i = 0; i < 5; i++) {
+		snprintf(str, sizeof(str), "WWW.example. NS ns%u.www.EXAMPLE.", i);
+		(void) ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL);
+		ldns_pkt_push_rr(pkt, LDNS_SECTION_ANSWER, rr);
+	}
+	ldns_pkt_set_edns_udp_size(pkt, 1232);
+	(void) ldns_pkt2buffer_wire(buf, pkt);
+	(void) ldns_wire2pkt(&back, ldns_buffer_begin(buf),
+			ldns_buffer_position(buf));
+
+	if (ldns_pkt_view_init(&view, ldns_buffer_begin(buf),
+			ldns_buffer_position(buf)) != LDNS_STATUS_OK
+	||  ldns_pkt_view_id(&view) != ldns_pkt_id(back)
+	||  ldns_pkt_view_section_count(&view, LDNS_SECTION_ANSWER) != 5
+	||  !ldns_pkt_view_edns(&view, &vrr) || vrr.rr_class != 1232) {
+		printf("Packet view not made\n");
+		ldns_pkt_free(pkt);
+		ldns_pkt_free(back);
+		ldns_buffer_free(buf);
+		return 1;
+	}
+	for (more = ldns_pkt_view_rr_first(&view, LDNS_SECTION_ANSWER, &vrr), i = 0;
+			more; more = ldns_pkt_view_rr_next(&vrr), i++) {
+		rr = ldns_rr_list_rr(ldns_pkt_answer(back), vrr.index);
+		vr = NULL;
+		if (ldns_pkt_view_name(&view, vrr.owner, name, sizeof(name),
+				&len) != LDNS_STATUS_OK
+		||  len != ldns_rdf_size(ldns_rr_owner(rr))
+		||  memcmp(name, ldns_rdf_data(ldns_rr_owner(rr)), len) != 0
+		||  vrr.type != ldns_rr_get_type(rr)
+		||  vrr.ttl != ldns_rr_ttl(rr)
+		||  ldns_pkt_view_rr2rr(&vr, &vrr) != LDNS_STATUS_OK
+		||  ldns_rr_compare(vr, rr) != 0) {
+			printf("Packet view RR %u differs\n", i);
+			result = 1;
+		}
+		ldns_rr_free(vr);
+	}
+	if (i != 5) {
+		printf("Packet view has %u answer RRs\n", i);
+		result = 1;
+	}
+	if (ldns_pkt_view_name(&view, vrr.owner, name, 4, &len)
+			!= LDNS_STATUS_DOMAINNAME_OVERFLOW) {
+		printf("Packet view name does not check the buffer size\n");
+		result = 1;
+	}
+	if (ldns_pkt_view_init(&view, ldns_buffer_begin(buf), 40)
+			!= LDNS_STATUS_WIRE_INCOMPLETE_ANSWER) {
+		printf("Packet view accepts a truncated packet\n");
+		result = 1;
+	}
+	if (ldns_pkt_view_init(&view, loop, sizeof(loop))
+			!= LDNS_STATUS_INVALID_POINTER) {
+		printf("Packet view accepts a pointer loop\n");
+		result = 1;
+	}
+	ldns_pkt_free(pkt);
+	ldns_pkt_free(back);
+	ldns_buffer_free(buf);
+	return result;
+}
+
+int
+test_server(void)
+{
+	ldns_buffer *buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *rrs = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_rr_list *list = ldns_rr_list_new();
+	ldns_pkt *query, *answer = NULL;
+	ldns_query_info qi;
+	ldns_response resp;
+	ldns_rr *rr;
+	uint8_t *wire = NULL;
+	char str[128];
+	size_t len;
+	int result = 0;
+	unsigned i;
+
+	query = ldns_pkt_query_new(ldns_dname_new_frm_str("www.Example."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	ldns_pkt_set_id(query, 4711);
+	ldns_pkt_set_edns_udp_size(query, 1232);
+	ldns_pkt_set_edns_do(query, true);
+	(void) ldns_pkt2wire(&wire, query, &len);
+	if (ldns_query_info_from_wire(&qi, wire, len) != LDNS_STATUS_OK
+	||  qi.id != 4711 || !qi.rd || qi.qtype != LDNS_RR_TYPE_A
+	||  qi.qname_size != 13 || !qi.edns || !qi.edns_do
+	||  ldns_query_info_max_udp(&qi) != 1232) {
+		printf("Query information not taken from the query\n");
+		result = 1;
+	}
+
+	for (i = 0; i < 40; i++) {
+		snprintf(str, sizeof(str), "www.example. A 192.0.2.%u", i);
+		(void) ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL);
+		ldns_rr_list_push_rr(list, rr);
+	}
+	(void) ldns_rr_new_frm_str(&rr, "example. NS ns.example.", 0, NULL, NULL);
+	(void) ldns_rr2buffer_wire(rrs, rr, LDNS_SECTION_AUTHORITY);
+	ldns_rr_free(rr);
+
+	/* 40 A RRs do not fit in 512 bytes */
+	if (ldns_response_init(&resp, buf, &qi, 512) != LDNS_STATUS_OK
+	||  ldns_response_add_rr_list(&resp, LDNS_SECTION_ANSWER, list)
+			!= LDNS_STATUS_PACKET_OVERFLOW
+	||  ldns_response_add_wire(&resp, LDNS_SECTION_AUTHORITY,
+			ldns_buffer_begin(rrs), ldns_buffer_position(rrs), 1)
+			!= LDNS_STATUS_OK
+	||  ldns_response_finish(&resp) != LDNS_STATUS_OK
+	||  ldns_wire2pkt(&answer, ldns_buffer_begin(buf),
+			ldns_buffer_position(buf)) != LDNS_STATUS_OK
+	||  ldns_pkt_id(answer) != 4711 || !ldns_pkt_qr(answer)
+	||  !ldns_pkt_tc(answer) || ldns_pkt_ancount(answer) != 0
+	||  ldns_pkt_nscount(answer) != 1 || !ldns_pkt_edns_do(answer)) {
+		printf("Truncated answer not right\n");
+		result = 1;
+	}
+	ldns_pkt_free(answer);
+	answer = NULL;
+
+	(void) ldns_response_init(&resp, buf, &qi, 1232);
+	ldns_response_set_flags(&resp, LDNS_AA);
+	if (ldns_response_add_rr_list(&resp, LDNS_SECTION_ANSWER, list)
+			!= LDNS_STATUS_OK
+	||  ldns_response_finish(&resp) != LDNS_STATUS_OK
+	||  ldns_wire2pkt(&answer, ldns_buffer_begin(buf),
+			ldns_buffer_position(buf)) != LDNS_STATUS_OK
+	||  !ldns_pkt_aa(answer) || ldns_pkt_tc(answer)
+	||  ldns_rr_list_compare(ldns_pkt_answer(answer), list) != 0
+	||  ldns_rr_list_compare(ldns_pkt_question(answer),
+			ldns_pkt_question(query)) != 0) {
+		printf("Answer not right\n");
+		result = 1;
+	}
+
+	/* An answer is not a query */
+	LDNS_QR_SET(wire);
+	if (ldns_query_info_from_wire(&qi, wire, len) != LDNS_STATUS_ERR
+	||  qi.id != 4711) {
+		printf("Answer taken for a query\n");
+		result = 1;
+	}
+	LDNS_FREE(wire);
+	ldns_pkt_free(answer);
+	ldns_pkt_free(query);
+	ldns_rr_list_deep_free(list);
+	ldns_buffer_free(rrs);
+	ldns_buffer_free(buf);
+	return result;
+}
+
+/* A random RRset with names from a few labels, in mixed case */
+static ldns_rr_list *
+random_rrset(void)
+{
+	const char *labels[] = { "www", "ns", "Example", "mail", "a", "b",
+		"com", "Net", "org", "xn--bcher-kva", "sub" };
+	const char *types[] = { "A 192.0.2.1", "NS", "MX 10", "CNAME",
+		"TXT \"text\"", "SOA", "AAAA 2001:db8::1", "SRV 1 2 3" };
+	const size_t nlabels = sizeof(labels) / sizeof(labels[0]);
+	const size_t ntypes = sizeof(types) / sizeof(types[0]);
+	ldns_rr_list *rrs = ldns_rr_list_new();
+	char owner[128], target[128];
+	char str[2 * sizeof(owner) + sizeof(target) + 32];
+	size_t t = (size_t)random() % ntypes, n, i, k, len;
+	ldns_rr *rr;
+
+	for (len = 0, k = 1 + (size_t)random() % 4;
+			k > 0 && len < sizeof(owner); k--) {
+		len += (size_t)snprintf(owner + len, sizeof(owner) - len,
+			"%s.", labels[random() % nlabels]);
+	}
+	for (n = 1 + (size_t)random() % 4, i = 0; i < n; i++) {
+		for (len = 0, k = 1 + (size_t)random() % 4;
+				k > 0 && len < sizeof(target); k--) {
+			len += (size_t)snprintf(target + len,
+				sizeof(target) - len, "%s.",
+				labels[random() % nlabels]);
+		}
+		if (t == 5) {
+			snprintf(str, sizeof(str), "%s SOA %s %s 1 2 3 4 5",
+				owner, target, owner);
+		} else if (t == 0 || t == 4 || t == 6) {
+			snprintf(str, sizeof(str), "%s %s", owner, types[t]);
+		} else {
+			snprintf(str, sizeof(str), "%s %s %s", owner,
+				types[t], target);
+		}
+		if (ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL)
+				== LDNS_STATUS_OK) {
+			ldns_rr_list_push_rr(rrs, rr);
+		}
+	}
+	return rrs;
+}
+
+int
+test_response_size(void)
+{
+	ldns_buffer *buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_rr_list *sets[8];
+	ldns_query_info qi;
+	ldns_response resp;
+	size_t size, start, i;
+	ldns_status status;
+	bool added[8];
+	int result = 0;
+	unsigned round;
+
+	memset(&qi, 0, sizeof(qi));
+	qi.qname[0] = 0;
+	qi.qname_size = 1;
+	qi.qtype = LDNS_RR_TYPE_NS;
+	qi.qclass = LDNS_RR_CLASS_IN;
+	qi.edns = true;
+
+	/* the size is that of the RRs as they are written, up to past
+	 * where names are no longer added to the compression table */
+	srandom(2181);
+	for (round = 0; round < 20 && result == 0; round++) {
+		(void) ldns_response_init(&resp, buf, &qi, LDNS_MAX_PACKETLEN);
+		for (;;) {
+			sets[0] = random_rrset();
+			start = ldns_buffer_position(buf);
+			size = ldns_response_rr_list_size(&resp,
+					LDNS_SECTION_ANSWER, sets[0]);
+			status = ldns_response_add_rr_list(&resp,
+					LDNS_SECTION_ANSWER, sets[0]);
+			ldns_rr_list_deep_free(sets[0]);
+			if (status == LDNS_STATUS_PACKET_OVERFLOW
+			&&  ldns_buffer_position(buf) == start
+			&&  size > ldns_response_room(&resp)) {
+				break;
+			}
+			if (status != LDNS_STATUS_OK
+			||  ldns_buffer_position(buf) - start != size) {
+				printf("response size: %u computed, %u written "
+					"at %u\n", (unsigned)size,
+					(unsigned)(ldns_buffer_position(buf)
+						- start), (unsigned)start);
+				result = 1;
+				break;
+			}
+		}
+	}
+
+	/* additional RRsets are added as far as they fit */
+	(void) ldns_response_init(&resp, buf, &qi, 512);
+	for (i = 0; i < 8; i++) {
+		sets[i] = ldns_rr_list_new();
+	}
+	for (i = 0; i < 8; i++) {
+		ldns_rr *rr;
+		char str[300];
+
+		snprintf(str, sizeof(str), "ns%u.example. TXT \"%0*u\"",
+			(unsigned)i, i == 3 ? 200 : 100, 0);
+		(void) ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL);
+		ldns_rr_list_push_rr(sets[i], rr);
+	}
+	if (ldns_response_add_rrsets(&resp, LDNS_SECTION_ADDITIONAL, sets, 8,
+			added) != LDNS_STATUS_OK
+	||  !added[0] || !added[1] || !added[2] || added[3] || !added[4]
+	||  added[5] || added[6] || added[7]
+	||  LDNS_TC_WIRE(ldns_buffer_begin(buf))
+	||  ldns_response_finish(&resp) != LDNS_STATUS_OK
+	||  ldns_buffer_position(buf) > 512) {
+		printf("response size: additional RRsets not fitted\n");
+		result = 1;
+	}
+	(void) ldns_response_init(&resp, buf, &qi, 512);
+	if (ldns_response_add_rrsets(&resp, LDNS_SECTION_ANSWER, sets, 8,
+			added) != LDNS_STATUS_PACKET_OVERFLOW
+	||  !added[2] || added[3] || added[4]
+	||  !LDNS_TC_WIRE(ldns_buffer_begin(buf))) {
+		printf("response size: answer RRsets not truncated\n");
+		result = 1;
+	}
+	for (i = 0; i < 8; i++) {
+		ldns_rr_list_deep_free(sets[i]);
+	}
+	ldns_buffer_free(buf);
+	return result;
+}
+
+/* ldns_wire2dname() as it was before ldns_wire2dname_buf(), to compare
+ * with */
+static ldns_status
+old_wire2dname(ldns_rdf **dname, const uint8_t *wire, size_t max, size_t *pos)
+{
+	uint8_t label_size;
+	uint16_t pointer_target;
+	uint8_t pointer_target_buf[2];
+	size_t dname_pos = 0;
+	size_t compression_pos = 0;
+	uint8_t tmp_dname[LDNS_MAX_DOMAINLEN];
+	unsigned int pointer_count = 0;
+
+	if (pos == NULL) {
+		return LDNS_STATUS_WIRE_RDATA_ERR;
+	}
+	if (*pos >= max) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	label_size = wire[*pos];
+	while (label_size > 0) {
+		/* compression */
+		while (label_size >= 192) {
+			if (compression_pos == 0) {
+				compression_pos = *pos + 2;
+			}
+
+			pointer_count++;
+
+			/* remove first two bits */
+			if (*pos + 2 > max) {
+				return LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			pointer_target_buf[0] = wire[*pos] & 63;
+			pointer_target_buf[1] = wire[*pos + 1];
+			pointer_target = ldns_read_uint16(pointer_target_buf);
+
+			if (pointer_target == 0) {
+				return LDNS_STATUS_INVALID_POINTER;
+			} else if (pointer_target >= max) {
+				return LDNS_STATUS_INVALID_POINTER;
+			} else if (pointer_count > LDNS_MAX_POINTERS) {
+				return LDNS_STATUS_INVALID_POINTER;
+			}
+			*pos = pointer_target;
+			label_size = wire[*pos];
+		}
+		if(label_size == 0)
+			break; /* break from pointer to 0 byte */
+		if (label_size > LDNS_MAX_LABELLEN) {
+			return LDNS_STATUS_LABEL_OVERFLOW;
+		}
+		if (*pos + 1 + label_size > max) {
+			return LDNS_STATUS_LABEL_OVERFLOW;
+		}
+
+		/* check space for labelcount itself */
+		if (dname_pos + 1 > LDNS_MAX_DOMAINLEN) {
+			return LDNS_STATUS_DOMAINNAME_OVERFLOW;
+		}
+		tmp_dname[dname_pos] = label_size;
+		if (label_size > 0) {
+			dname_pos++;
+		}
+		*pos = *pos + 1;
+		if (dname_pos + label_size > LDNS_MAX_DOMAINLEN) {
+			return LDNS_STATUS_DOMAINNAME_OVERFLOW;
+		}
+		memcpy(&tmp_dname[dname_pos], &wire[*pos], label_size);
+		dname_pos += label_size;
+		*pos = *pos + label_size;
+
+		if (*pos < max) {
+			label_size = wire[*pos];
+		}
+	}
+
+	if (compression_pos > 0) {
+		*pos = compression_pos;
+	} else {
+		*pos = *pos + 1;
+	}
+
+	if (dname_pos >= LDNS_MAX_DOMAINLEN) {
+		return LDNS_STATUS_DOMAINNAME_OVERFLOW;
+	}
+
+	tmp_dname[dname_pos] = 0;
+	dname_pos++;
+
+	*dname = ldns_rdf_new_frm_data(LDNS_RDF_TYPE_DNAME,
+			(uint16_t) dname_pos, tmp_dname);
+	if (!*dname) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	return LDNS_STATUS_OK;
+}
+
+/* Random data that looks a bit like names */
+static void
+fuzz_names(uint8_t *wire, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		switch (random() % 8) {
+		case 0:
+			wire[i] = 0;
+			break;
+		case 1:
+		case 2:
+		case 3:
+			wire[i] = (uint8_t)(1 + random() % 4);
+			break;
+		case 4:
+			wire[i] = 0xC0;
+			if (i + 1 < len) {
+				wire[++i] = (uint8_t)(random() % len);
+			}
+			break;
+		case 5:
+			wire[i] = (uint8_t)(62 + random() % 4);
+			break;
+		default:
+			wire[i] = (uint8_t)random();
+			break;
+		}
+	}
+}
+
+int
+test_wire2dname(void)
+{
+	uint8_t wire[600], buf[LDNS_MAX_DOMAINLEN];
+	ldns_dname_arena *arena = ldns_dname_arena_new();
+	ldns_rdf *old, *new, *in_arena;
+	ldns_status old_st, new_st, arena_st;
+	size_t len, max, start, old_pos, new_pos, arena_pos, i;
+	int result = 0;
+	unsigned n;
+
+	srandom(4711);
+	for (n = 0; n < 200000 && result == 0; n++) {
+		max = 1 + (size_t)random() % (n % 2 ? 40 : sizeof(wire));
+		fuzz_names(wire, max);
+		start = (size_t)random() % max;
+		old = new = in_arena = NULL;
+		old_pos = new_pos = arena_pos = start;
+		old_st = old_wire2dname(&old, wire, max, &old_pos);
+		new_st = ldns_wire2dname(&new, wire, max, &new_pos);
+		arena_st = ldns_wire2dname_arena(&in_arena, arena, wire, max,
+				&arena_pos);
+		if (old_st != new_st || old_st != arena_st
+		||  (old_st == LDNS_STATUS_OK
+		  && (old_pos != new_pos || old_pos != arena_pos
+		   || ldns_rdf_compare(old, new) != 0
+		   || ldns_rdf_compare(old, in_arena) != 0))) {
+			printf("wire2dname differs at %u: %s / %s\n", n,
+				ldns_get_errorstr_by_id(old_st),
+				ldns_get_errorstr_by_id(new_st));
+			result = 1;
+		}
+		ldns_rdf_deep_free(old);
+		ldns_rdf_deep_free(new);
+		if (n % 100 == 0) {
+			ldns_dname_arena_clear(arena);
+		}
+	}
+
+	/* A long chain of pointers, and a loop of pointers */
+	for (i = 0; i + 2 < sizeof(wire); i += 2) {
+		wire[i] = 0xC0 | (uint8_t)((i + 2) >> 8);
+		wire[i + 1] = (uint8_t)(i + 2);
+	}
+	wire[i] = 0;
+	start = 0;
+	if (ldns_wire2dname_buf(buf, &len, wire, sizeof(wire), &start)
+			!= LDNS_STATUS_OK || len != 1 || start != 2) {
+		printf("Chain of pointers not followed\n");
+		result = 1;
+	}
+	wire[i - 2] = 0xC0;
+	wire[i - 1] = 2;
+	start = 0;
+	if (ldns_wire2dname_buf(buf, &len, wire, sizeof(wire), &start)
+			!= LDNS_STATUS_INVALID_POINTER) {
+		printf("Loop of pointers not found\n");
+		result = 1;
+	}
+	ldns_dname_arena_free(arena);
+	return result;
+}
+
+/* ldns_wire2rdf() as it was before the rdata codecs, to compare with */
+static ldns_status
+old_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max, size_t *pos)
+{
+	size_t end;
+	size_t cur_rdf_length;
+	uint8_t rdf_index;
+	uint8_t *data;
+	uint16_t rd_length;
+	ldns_rdf *cur_rdf = NULL;
+	ldns_rdf_type cur_rdf_type;
+	const ldns_rr_descriptor *descriptor;
+	ldns_status status;
+
+	assert(rr != NULL);
+
+	descriptor = ldns_rr_descript(ldns_rr_get_type(rr));
+
+	if (*pos + 2 > max) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+
+	rd_length = ldns_read_uint16(&wire[*pos]);
+	*pos = *pos + 2;
+
+	if (*pos + rd_length > max) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+
+	end = *pos + (size_t) rd_length;
+
+	rdf_index = 0;
+	while (*pos < end &&
+			rdf_index < ldns_rr_descriptor_maximum(descriptor)) {
+
+		cur_rdf_length = 0;
+
+		cur_rdf_type = ldns_rr_descriptor_field_type(
+				descriptor, rdf_index);
+
+		/* handle special cases immediately, set length
+		   for fixed length rdata and do them below */
+		switch (cur_rdf_type) {
+		case LDNS_RDF_TYPE_DNAME:
+			status = ldns_wire2dname(&cur_rdf, wire, max, pos);
+			if (status != LDNS_STATUS_OK) {
+				return status;
+			}
+			break;
+		case LDNS_RDF_TYPE_CLASS:
+		case LDNS_RDF_TYPE_ALG:
+		case LDNS_RDF_TYPE_CERTIFICATE_USAGE:
+		case LDNS_RDF_TYPE_SELECTOR:
+		case LDNS_RDF_TYPE_MATCHING_TYPE:
+		case LDNS_RDF_TYPE_INT8:
+			cur_rdf_length = LDNS_RDF_SIZE_BYTE;
+			break;
+		case LDNS_RDF_TYPE_TYPE:
+		case LDNS_RDF_TYPE_INT16:
+		case LDNS_RDF_TYPE_CERT_ALG:
+			cur_rdf_length = LDNS_RDF_SIZE_WORD;
+			break;
+		case LDNS_RDF_TYPE_TIME:
+		case LDNS_RDF_TYPE_INT32:
+		case LDNS_RDF_TYPE_A:
+		case LDNS_RDF_TYPE_PERIOD:
+			cur_rdf_length = LDNS_RDF_SIZE_DOUBLEWORD;
+			break;
+		case LDNS_RDF_TYPE_TSIGTIME:
+		case LDNS_RDF_TYPE_EUI48:
+			cur_rdf_length = LDNS_RDF_SIZE_6BYTES;
+			break;
+		case LDNS_RDF_TYPE_ILNP64:
+		case LDNS_RDF_TYPE_EUI64:
+			cur_rdf_length = LDNS_RDF_SIZE_8BYTES;
+			break;
+		case LDNS_RDF_TYPE_AAAA:
+			cur_rdf_length = LDNS_RDF_SIZE_16BYTES;
+			break;
+		case LDNS_RDF_TYPE_STR:
+		case LDNS_RDF_TYPE_NSEC3_SALT:
+		case LDNS_RDF_TYPE_TAG:
+			/* len is stored in first byte
+			 * it should be in the rdf too, so just
+			 * copy len+1 from this position
+			 */
+			cur_rdf_length = ((size_t) wire[*pos]) + 1;
+			break;
+
+		case LDNS_RDF_TYPE_INT16_DATA:
+			if (*pos + 2 > end) {
+				return LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			cur_rdf_length =
+				(size_t) ldns_read_uint16(&wire[*pos]) + 2;
+			break;
+		case LDNS_RDF_TYPE_HIP:
+			if (*pos + 4 > end) {
+				return LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			cur_rdf_length =
+				(size_t) wire[*pos] +
+				(size_t) ldns_read_uint16(&wire[*pos + 2]) + 4;
+			break;
+		case LDNS_RDF_TYPE_B32_EXT:
+		case LDNS_RDF_TYPE_NSEC3_NEXT_OWNER:
+			/* length is stored in first byte */
+			cur_rdf_length = ((size_t) wire[*pos]) + 1;
+			break;
+		case LDNS_RDF_TYPE_APL:
+		case LDNS_RDF_TYPE_B64:
+		case LDNS_RDF_TYPE_HEX:
+		case LDNS_RDF_TYPE_NSEC:
+		case LDNS_RDF_TYPE_UNKNOWN:
+		case LDNS_RDF_TYPE_SERVICE:
+		case LDNS_RDF_TYPE_LOC:
+		case LDNS_RDF_TYPE_WKS:
+		case LDNS_RDF_TYPE_NSAP:
+		case LDNS_RDF_TYPE_ATMA:
+		case LDNS_RDF_TYPE_IPSECKEY:
+		case LDNS_RDF_TYPE_LONG_STR:
+		case LDNS_RDF_TYPE_AMTRELAY:
+		case LDNS_RDF_TYPE_SVCPARAMS:
+		case LDNS_RDF_TYPE_NONE:
+			/*
+			 * Read to end of rr rdata
+			 */
+			cur_rdf_length = end - *pos;
+			break;
+		}
+
+		/* fixed length rdata */
+		if (cur_rdf_length > 0) {
+			if (cur_rdf_length + *pos > end) {
+				return LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			data = LDNS_XMALLOC(uint8_t, rd_length);
+			if (!data) {
+				return LDNS_STATUS_MEM_ERR;
+			}
+			memcpy(data, &wire[*pos], cur_rdf_length);
+
+			cur_rdf = ldns_rdf_new(cur_rdf_type,
+					cur_rdf_length, data);
+			*pos = *pos + cur_rdf_length;
+		}
+
+		if (cur_rdf) {
+			ldns_rr_push_rdf(rr, cur_rdf);
+			cur_rdf = NULL;
+		}
+
+		rdf_index++;
+
+	} /* while (rdf_index < ldns_rr_descriptor_maximum(descriptor)) */
+
+
+	return LDNS_STATUS_OK;
+}
+
+/* The rdata of a RR in canonical form as it was before the rdata codecs */
+static void
+old_rdata2canonical(ldns_buffer *buffer, const ldns_rr *rr)
+{
+	bool pre_rfc3597 = false;
+	size_t i;
+
+	switch (ldns_rr_get_type(rr)) {
+	case LDNS_RR_TYPE_NS:
+	case LDNS_RR_TYPE_MD:
+	case LDNS_RR_TYPE_MF:
+	case LDNS_RR_TYPE_CNAME:
+	case LDNS_RR_TYPE_SOA:
+	case LDNS_RR_TYPE_MB:
+	case LDNS_RR_TYPE_MG:
+	case LDNS_RR_TYPE_MR:
+	case LDNS_RR_TYPE_PTR:
+	case LDNS_RR_TYPE_HINFO:
+	case LDNS_RR_TYPE_MINFO:
+	case LDNS_RR_TYPE_MX:
+	case LDNS_RR_TYPE_RP:
+	case LDNS_RR_TYPE_AFSDB:
+	case LDNS_RR_TYPE_RT:
+	case LDNS_RR_TYPE_SIG:
+	case LDNS_RR_TYPE_PX:
+	case LDNS_RR_TYPE_NXT:
+	case LDNS_RR_TYPE_NAPTR:
+	case LDNS_RR_TYPE_KX:
+	case LDNS_RR_TYPE_SRV:
+	case LDNS_RR_TYPE_DNAME:
+	case LDNS_RR_TYPE_A6:
+	case LDNS_RR_TYPE_RRSIG:
+		pre_rfc3597 = true;
+		break;
+	default:
+		break;
+	}
+	for (i = 0; i < ldns_rr_rd_count(rr); i++) {
+		if (pre_rfc3597) {
+			(void) ldns_rdf2buffer_wire_canonical(buffer,
+					ldns_rr_rdf(rr, i));
+		} else {
+			(void) ldns_rdf2buffer_wire(buffer, ldns_rr_rdf(rr, i));
+		}
+	}
+}
+
+/* ldns_rr_compare() of two RRs that only differ in rdata, as it was
+ * before the rdata codecs */
+static int
+old_rdata_compare(const ldns_rr *rr1, const ldns_rr *rr2)
+{
+	ldns_buffer *buf1 = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *buf2 = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	int result;
+
+	/* ldns_rr_compare_wire() skips the owner name and header */
+	ldns_buffer_write(buf1, "\0\0\0\0\0\0\0\0\0\0\0", 11);
+	ldns_buffer_write(buf2, "\0\0\0\0\0\0\0\0\0\0\0", 11);
+	old_rdata2canonical(buf1, rr1);
+	old_rdata2canonical(buf2, rr2);
+	ldns_buffer_set_capacity(buf1, ldns_buffer_position(buf1));
+	ldns_buffer_set_capacity(buf2, ldns_buffer_position(buf2));
+	result = ldns_rr_compare_wire(buf1, buf2);
+	ldns_buffer_free(buf1);
+	ldns_buffer_free(buf2);
+	return result;
+}
+
+/* Decodes the rdata with and without the codec of the type, and compares
+ * the RRs, the canonical forms and how they compare with prev */
+static int
+check_rr_codec(ldns_rr_type type, const uint8_t *wire, size_t max,
+		ldns_rr **prev)
+{
+	ldns_rr *old = ldns_rr_new(), *new = ldns_rr_new();
+	ldns_buffer *old_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_buffer *new_buf = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	ldns_status old_st, new_st;
+	size_t old_pos = 0, new_pos = 0, i;
+	int result = 0;
+
+	ldns_rr_set_type(old, type);
+	ldns_rr_set_type(new, type);
+	ldns_rr_set_owner(new, ldns_dname_new_frm_str("."));
+	old_st = old_wire2rdf(old, wire, max, &old_pos);
+	new_st = ldns_wire2rdf(new, wire, max, &new_pos);
+	if (old_st != new_st || old_pos != new_pos
+	||  ldns_rr_rd_count(old) != ldns_rr_rd_count(new)) {
+		printf("%s: wire2rdf differs: %s / %s\n",
+			ldns_rr_descript(type)->_name,
+			ldns_get_errorstr_by_id(old_st),
+			ldns_get_errorstr_by_id(new_st));
+		result = 1;
+	}
+	for (i = 0; result == 0 && i < ldns_rr_rd_count(old); i++) {
+		if (ldns_rdf_get_type(ldns_rr_rdf(old, i))
+				!= ldns_rdf_get_type(ldns_rr_rdf(new, i))
+		||  ldns_rdf_compare(ldns_rr_rdf(old, i),
+				ldns_rr_rdf(new, i)) != 0) {
+			printf("%s: rdf %d differs\n",
+				ldns_rr_descript(type)->_name, (int)i);
+			result = 1;
+		}
+	}
+	if (result == 0 && new_st == LDNS_STATUS_OK) {
+		old_rdata2canonical(old_buf, old);
+		(void) ldns_rr2buffer_wire_canonical(new_buf, new,
+				LDNS_SECTION_ANSWER);
+		/* skip the root owner name and the header */
+		if (ldns_buffer_position(new_buf) != 11
+				+ ldns_buffer_position(old_buf)
+		||  memcmp(ldns_buffer_at(new_buf, 11), ldns_buffer_begin(old_buf),
+				ldns_buffer_position(old_buf)) != 0) {
+			printf("%s: canonical form differs\n",
+				ldns_rr_descript(type)->_name);
+			result = 1;
+		}
+		ldns_buffer_clear(old_buf);
+		ldns_buffer_clear(new_buf);
+		for (i = 0; i < ldns_rr_rd_count(old); i++) {
+			(void) ldns_rdf2buffer_wire(old_buf,
+					ldns_rr_rdf(old, i));
+		}
+		(void) ldns_rr_rdata2buffer_wire(new_buf, new);
+		if (ldns_buffer_position(new_buf)
+				!= ldns_buffer_position(old_buf)
+		||  memcmp(ldns_buffer_begin(new_buf), ldns_buffer_begin(old_buf),
+				ldns_buffer_position(old_buf)) != 0) {
+			printf("%s: rdata differs\n",
+				ldns_rr_descript(type)->_name);
+			result = 1;
+		}
+		if (*prev && ldns_rr_compare(new, *prev)
+				!= old_rdata_compare(old, *prev)) {
+			printf("%s: compare differs\n",
+				ldns_rr_descript(type)->_name);
+			result = 1;
+		}
+		ldns_rr_free(*prev);
+		*prev = new;
+		new = NULL;
+	}
+	ldns_rr_free(old);
+	ldns_rr_free(new);
+	ldns_buffer_free(old_buf);
+	ldns_buffer_free(new_buf);
+	return result;
+}
+
+int
+test_rr_codec(void)
+{
+	uint8_t wire[200];
+	ldns_rr *prev;
+	size_t rdlength, i;
+	unsigned n, type;
+	int result = 0;
+
+	srandom(4712);
+	for (type = 0; type < 65536 && result == 0; type++) {
+		if (!ldns_rr_codec_get((ldns_rr_type)type)) {
+			continue;
+		}
+		prev = NULL;
+		fuzz_names(wire, sizeof(wire));
+		for (n = 0; n < 2000 && result == 0; n++) {
+			if (n % 2 && prev) {
+				/* a few bytes changed, to compare the same
+				 * rdata, a name in another case and rdata
+				 * that starts the same */
+				for (i = (size_t)random() % 3; i > 0; i--) {
+					wire[2 + random() % 30] ^= 0x20;
+				}
+				if (random() % 4 == 0) {
+					rdlength = ldns_read_uint16(wire);
+					ldns_write_uint16(wire, rdlength
+						+ (random() % 2 ? 1 : -1));
+				}
+			} else {
+				fuzz_names(wire, sizeof(wire));
+				rdlength = (size_t)random() % 60;
+				ldns_write_uint16(wire, (uint16_t)rdlength);
+			}
+			result = check_rr_codec((ldns_rr_type)type, wire,
+					sizeof(wire), &prev);
+		}
+		ldns_rr_free(prev);
+	}
+	return result;
+}
+
+static bool
+tcp_frame_msg_ok(const uint8_t *msg, size_t len, const size_t *lens,
+		size_t i)
+{
+	size_t k;
+
+	if (!msg || len != lens[i]) {
+		return false;
+	}
+	for (k = 0; k < len; k++) {
+		if (msg[k] != (uint8_t)(i + 1)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int
+test_tcp_frame(void)
+{
+	static uint8_t stream[70000];
+	const size_t lens[] = { 12, 0, 1, 300, 65535, 2, 512 };
+	const size_t n = sizeof(lens) / sizeof(lens[0]);
+	size_t stream_len = 0, pos, used, chunk, len, i;
+	const uint8_t *msg;
+	ldns_tcp_reader r;
+	ldns_tcp_writer w;
+	int fds[2], result = 0;
+	unsigned round;
+
+	for (i = 0; i < n; i++) {
+		ldns_write_uint16(stream + stream_len, (uint16_t)lens[i]);
+		memset(stream + stream_len + 2, (int)i + 1, lens[i]);
+		stream_len += 2 + lens[i];
+	}
+
+	/* in pieces of random sizes */
+	srandom(4713);
+	ldns_tcp_reader_init(&r);
+	for (round = 0; round < 100 && result == 0; round++) {
+		for (pos = 0, i = 0; pos < stream_len && result == 0; ) {
+			chunk = 1 + (size_t)random() % (round % 3 ? 3 : 70000);
+			if (chunk > stream_len - pos) {
+				chunk = stream_len - pos;
+			}
+			while (chunk > 0) {
+				if (ldns_tcp_reader_next(&r, stream + pos, chunk,
+						&used, &msg, &len)
+						!= LDNS_STATUS_OK) {
+					result = 1;
+					break;
+				}
+				pos += used;
+				chunk -= used;
+				if (msg && !tcp_frame_msg_ok(msg, len, lens,
+						i++)) {
+					printf("tcp frame: message %u is not "
+						"right in round %u\n",
+						(unsigned)i - 1, round);
+					result = 1;
+					break;
+				}
+			}
+		}
+		if (result == 0 && (i != n || ldns_tcp_reader_partial(&r))) {
+			printf("tcp frame: %u messages in round %u\n",
+				(unsigned)i, round);
+			result = 1;
+		}
+	}
+
+	/* all at once, without copying */
+	for (pos = 0, i = 0; pos < stream_len && result == 0; pos += used) {
+		(void) ldns_tcp_reader_next(&r, stream + pos, stream_len - pos,
+				&used, &msg, &len);
+		if (msg != stream + pos + 2
+		||  !tcp_frame_msg_ok(msg, len, lens, i++)) {
+			printf("tcp frame: message %u is copied\n",
+				(unsigned)i - 1);
+			result = 1;
+		}
+	}
+	ldns_tcp_reader_clear(&r);
+
+	/* over a socket, with a writer that does not block */
+	if (result == 0 && socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0) {
+		(void) fcntl(fds[0], F_SETFL, O_NONBLOCK);
+		ldns_tcp_writer_init(&w);
+		for (i = 0, pos = 0; i < n; i++) {
+			(void) ldns_tcp_writer_add(&w, stream + pos + 2, lens[i]);
+			pos += 2 + lens[i];
+		}
+		if (ldns_tcp_writer_pending(&w) != stream_len) {
+			printf("tcp frame: %u bytes pending\n",
+				(unsigned)ldns_tcp_writer_pending(&w));
+			result = 1;
+		}
+		for (i = 0; i < n && result == 0; ) {
+			if (ldns_tcp_writer_flush(&w, fds[0])
+					!= LDNS_STATUS_OK
+			||  ldns_tcp_reader_recv(&r, fds[1])
+					!= LDNS_STATUS_OK) {
+				result = 1;
+				break;
+			}
+			while (i < n && ldns_tcp_reader_get(&r, &msg, &len)) {
+				if (!tcp_frame_msg_ok(msg, len, lens, i++)) {
+					printf("tcp frame: message %u over the "
+						"socket is not right\n",
+						(unsigned)i - 1);
+					result = 1;
+				}
+			}
+		}
+		if (result == 0 && ldns_tcp_writer_pending(&w) != 0) {
+			printf("tcp frame: not all written\n");
+			result = 1;
+		}
+		close(fds[0]);
+		if (ldns_tcp_reader_recv(&r, fds[1])
+				!= LDNS_STATUS_SOCKET_ERROR) {
+			printf("tcp frame: close not seen\n");
+			result = 1;
+		}
+		close(fds[1]);
+		ldns_tcp_reader_clear(&r);
+	}
+	return result;
+}
+
+int
+test_wire_validate(void)
+{
+	const char *rrs[] = {
+		"example.com. 300 IN SOA ns.example.com. host.example.com. "
+			"1 2 3 4 5",
+		"example.com. 300 IN MX 10 mail.example.com.",
+		"example.com. 300 IN TXT \"one\" \"two\"",
+		"www.example.com. 300 IN A 192.0.2.1",
+		"www.example.com. 300 IN AAAA 2001:db8::1",
+		"example.com. 300 IN NSEC a.example.com. A NS SOA RRSIG",
+		"example.com. 300 IN DS 12345 8 2 "
+			"0123456789abcdef0123456789abcdef"
+			"0123456789abcdef0123456789abcdef",
+	};
+	uint8_t *wire = NULL, *copy;
+	size_t wire_len = 0, i, len;
+	ldns_pkt *pkt, *p2;
+	ldns_rr *rr;
+	ldns_status s1, s2;
+	unsigned round;
+	int result = 0;
+
+	pkt = ldns_pkt_query_new(ldns_dname_new_frm_str("example.com."),
+			LDNS_RR_TYPE_SOA, LDNS_RR_CLASS_IN, 0);
+	for (i = 0; i < sizeof(rrs) / sizeof(rrs[0]); i++) {
+		if (ldns_rr_new_frm_str(&rr, rrs[i], 0, NULL, NULL)
+				!= LDNS_STATUS_OK) {
+			printf("wire validate: can not read %s\n", rrs[i]);
+			ldns_pkt_free(pkt);
+			return 1;
+		}
+		(void) ldns_pkt_push_rr(pkt, i % 2 ? LDNS_SECTION_AUTHORITY
+				: LDNS_SECTION_ANSWER, rr);
+	}
+	if (ldns_pkt2wire(&wire, pkt, &wire_len) != LDNS_STATUS_OK) {
+		ldns_pkt_free(pkt);
+		return 1;
+	}
+	ldns_pkt_free(pkt);
+	if (ldns_wire_validate(wire, wire_len, true) != LDNS_STATUS_OK) {
+		printf("wire validate: valid packet is not valid\n");
+		result = 1;
+	}
+
+	/* without strict, the same answers as ldns_wire2pkt */
+	copy = LDNS_XMALLOC(uint8_t, wire_len + 1);
+	srandom(1035);
+	for (round = 0; round < 20000 && result == 0; round++) {
+		memcpy(copy, wire, wire_len);
+		len = round % 4 ? wire_len : (size_t)random() % wire_len;
+		for (i = 0; i < 1 + round % 3; i++) {
+			copy[(size_t)random() % wire_len] = (uint8_t)random();
+		}
+		s1 = ldns_wire_validate(copy, len, false);
+		s2 = ldns_wire2pkt(&p2, copy, len);
+		if (s2 == LDNS_STATUS_OK) {
+			ldns_pkt_free(p2);
+		}
+		if (s1 != s2) {
+			printf("wire validate: %s where wire2pkt has %s in "
+				"round %u\n", ldns_get_errorstr_by_id(s1),
+				ldns_get_errorstr_by_id(s2), round);
+			result = 1;
+		}
+	}
+
+	/* the stricter checks */
+	memcpy(copy, wire, wire_len);
+	copy[wire_len] = 0;
+	if (ldns_wire_validate(copy, wire_len + 1, false) != LDNS_STATUS_OK
+	||  ldns_wire_validate(copy, wire_len + 1, true)
+			!= LDNS_STATUS_WIRE_TRAILING_DATA) {
+		printf("wire validate: trailing data\n");
+		result = 1;
+	}
+	ldns_write_uint16(copy + 6, 60000);
+	if (ldns_wire_validate(copy, wire_len, true)
+			!= LDNS_STATUS_WIRE_INCOMPLETE_ANSWER) {
+		printf("wire validate: answer count is not checked\n");
+		result = 1;
+	}
+	LDNS_FREE(copy);
+	LDNS_FREE(wire);
+
+	/* an A record with five bytes of rdata */
+	{
+		const uint8_t a5[] = { 0, 1, 0x81, 0x80, 0, 0, 0, 1, 0, 0,
+			0, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 5, 192, 0, 2, 1, 9 };
+
+		if (ldns_wire_validate(a5, sizeof(a5), true)
+				!= LDNS_STATUS_WIRE_RDATA_ERR) {
+			printf("wire validate: long A rdata\n");
+			result = 1;
+		}
+	}
+	return result;
+}
+
+int
+test_buffer_pool(void)
+{
+	uint8_t mem[8];
+	ldns_buffer view, *b, *b2;
+	ldns_rr_list *list;
+	ldns_rr *rr;
+	char str[64], *s;
+	unsigned i;
+	int result = 0;
+
+	/* a view does not grow out of the memory it was given */
+	ldns_buffer_init_frm_data(&view, mem, sizeof(mem));
+	ldns_buffer_write_u32(&view, 1);
+	ldns_buffer_write_u32(&view, 2);
+	if (ldns_buffer_reserve(&view, 1)
+	||  ldns_buffer_status(&view) != LDNS_STATUS_MEM_ERR
+	||  ldns_buffer_begin(&view) != mem
+	||  ldns_read_uint32(mem + 4) != 2) {
+		printf("buffer pool: the view was resized\n");
+		result = 1;
+	}
+
+	b = ldns_buffer_acquire(100);
+	if (!b || ldns_buffer_capacity(b) < 100) {
+		printf("buffer pool: no buffer\n");
+		return 1;
+	}
+	ldns_buffer_printf(b, "%s", "some text");
+	ldns_buffer_release(b);
+	b2 = ldns_buffer_acquire(200);
+	if (!b2 || ldns_buffer_position(b2) != 0
+	||  ldns_buffer_limit(b2) != ldns_buffer_capacity(b2)
+	||  !ldns_buffer_status_ok(b2)) {
+		printf("buffer pool: the buffer was not cleared\n");
+		result = 1;
+	}
+#ifdef HAVE_PTHREAD
+	if (b2 != b) {
+		printf("buffer pool: the buffer was not used again\n");
+		result = 1;
+	}
+#endif
+	ldns_buffer_printf(b2, "%s", "secret");
+	ldns_buffer_release_clear(b2);
+#ifdef HAVE_PTHREAD
+	b = ldns_buffer_acquire(200);
+	if (!b || memcmp(ldns_buffer_begin(b), "\0\0\0\0\0\0", 6) != 0) {
+		printf("buffer pool: the data was not cleared\n");
+		result = 1;
+	}
+	/* data that fills the buffer is cleared after a flip as well */
+	if (b) {
+		while (ldns_buffer_remaining(b) > 0) {
+			ldns_buffer_write_u8(b, 'x');
+		}
+		ldns_buffer_flip(b);
+	}
+	ldns_buffer_release_clear(b);
+	b2 = ldns_buffer_acquire(200);
+	if (!b2 || b2 != b) {
+		printf("buffer pool: the full buffer was not used again\n");
+		result = 1;
+	} else {
+		for (i = 0; i < ldns_buffer_capacity(b2); i++) {
+			if (ldns_buffer_at(b2, i)[0] != 0) {
+				printf("buffer pool: the full buffer was "
+				       "not cleared\n");
+				result = 1;
+				break;
+			}
+		}
+	}
+	ldns_buffer_release(b2);
+#endif
+	b = ldns_buffer_acquire(LDNS_MAX_PACKETLEN + 1);
+	if (!b || ldns_buffer_capacity(b) != LDNS_MAX_PACKETLEN + 1) {
+		printf("buffer pool: large buffer\n");
+		result = 1;
+	}
+	ldns_buffer_release(b);
+
+	/* sorting writes the RRs in a shared buffer and compares views */
+	list = ldns_rr_list_new();
+	for (i = 0; i < 40; i++) {
+		snprintf(str, sizeof(str), "example. 300 IN MX %u %s%u.example.",
+			(i * 7) % 5, i % 2 ? "MAIL" : "mail", (i * 13) % 40);
+		if (ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL)
+				!= LDNS_STATUS_OK) {
+			printf("buffer pool: can not read %s\n", str);
+			ldns_rr_list_deep_free(list);
+			return 1;
+		}
+		ldns_rr_list_push_rr(list, rr);
+	}
+	ldns_rr_list_sort(list);
+	for (i = 1; i < ldns_rr_list_rr_count(list); i++) {
+		if (ldns_rr_compare(ldns_rr_list_rr(list, i - 1),
+				ldns_rr_list_rr(list, i)) > 0) {
+			s = ldns_rr2str(ldns_rr_list_rr(list, i));
+			printf("buffer pool: %s is not sorted\n", s);
+			LDNS_FREE(s);
+			result = 1;
+		}
+	}
+	s = ldns_rr2str(ldns_rr_list_rr(list, 0));
+	if (!s || strcmp(s, "example.\t300\tIN\tMX\t0 mail0.example.\n")) {
+		printf("buffer pool: first is %s\n", s ? s : "NULL");
+		result = 1;
+	}
+	LDNS_FREE(s);
+	ldns_rr_list_deep_free(list);
+
+	/* more canonical forms than fit in the buffer it starts with, so
+	 * that it grows while the RRs are compared */
+	list = ldns_rr_list_new();
+	for (i = 0; i < 4000; i++) {
+		snprintf(str, sizeof(str), "example. 300 IN TXT \"text %u\"",
+			3999 - i);
+		if (ldns_rr_new_frm_str(&rr, str, 0, NULL, NULL)
+				!= LDNS_STATUS_OK) {
+			printf("buffer pool: can not read %s\n", str);
+			ldns_rr_list_deep_free(list);
+			return 1;
+		}
+		ldns_rr_list_push_rr(list, rr);
+	}
+	if (ldns_rr_list_rr_count(list) * ldns_rr_uncompressed_size(
+			ldns_rr_list_rr(list, 0)) <= LDNS_MAX_PACKETLEN) {
+		printf("buffer pool: the RRs are too small\n");
+		result = 1;
+	}
+	ldns_rr_list_sort(list);
+	for (i = 1; i < ldns_rr_list_rr_count(list); i++) {
+		if (ldns_rr_compare(ldns_rr_list_rr(list, i - 1),
+				ldns_rr_list_rr(list, i)) > 0) {
+			printf("buffer pool: large list is not sorted\n");
+			result = 1;
+			break;
+		}
+	}
+	ldns_rr_list_deep_free(list);
+	ldns_buffer_pool_clear();
+	return result;
+}
+
+/* Checks the smoothed round trip time and variation of nameserver pos */
+static int
+rtt_is(const ldns_resolver *r, size_t pos, size_t rtt, size_t rttvar,
+		const char *what)
+{
+	if (ldns_resolver_nameserver_rtt(r, pos) == rtt
+	&&  ldns_resolver_nameserver_rttvar(r, pos) == rttvar) {
+		return 0;
+	}
+	printf("rtt: %s: %u/%u instead of %u/%u\n", what,
+		(unsigned)ldns_resolver_nameserver_rtt(r, pos),
+		(unsigned)ldns_resolver_nameserver_rttvar(r, pos),
+		(unsigned)rtt, (unsigned)rttvar);
+	return 1;
+}
+
+int
+test_rtt(void)
+{
+	ldns_resolver *r, *r2;
+	ldns_rdf *ns1, *ns2;
+	FILE *fp;
+	unsigned i;
+	int result = 0;
+
+	ns1 = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_A, "192.0.2.1");
+	ns2 = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_A, "192.0.2.2");
+	r = ldns_resolver_new();
+	r2 = ldns_resolver_new();
+	if (!ns1 || !ns2 || !r || !r2
+	||  ldns_resolver_push_nameserver(r, ns1) != LDNS_STATUS_OK
+	||  ldns_resolver_push_nameserver(r, ns2) != LDNS_STATUS_OK
+	||  ldns_resolver_push_nameserver(r2, ns2) != LDNS_STATUS_OK
+	||  ldns_resolver_push_nameserver(r2, ns1) != LDNS_STATUS_OK) {
+		printf("rtt: can not make the resolvers\n");
+		return 1;
+	}
+
+	/* the first measurement sets both */
+	ldns_resolver_nameserver_rtt_update(r, 0, 100);
+	result |= rtt_is(r, 0, 100, 50, "first");
+
+	/* the variation of a steady nameserver goes down to 0, which
+	 * must not make the next measurement count as the first */
+	for (i = 0; i < 20; i++) {
+		ldns_resolver_nameserver_rtt_update(r, 0, 100);
+	}
+	result |= rtt_is(r, 0, 100, 0, "steady");
+	ldns_resolver_nameserver_rtt_update(r, 0, 200);
+	result |= rtt_is(r, 0, 112, 25, "after steady");
+
+	/* a backoff doubles the timeout and the next measurement
+	 * starts over */
+	ldns_resolver_nameserver_rtt_backoff(r, 0);
+	result |= rtt_is(r, 0, 424, 25, "backoff");
+	ldns_resolver_nameserver_rtt_update(r, 0, 80);
+	result |= rtt_is(r, 0, 80, 40, "after backoff");
+
+	/* only measured nameservers are written, and they are read back
+	 * for the same address as measurements to smooth */
+	if (!(fp = tmpfile())
+	||  ldns_resolver_write_rtt(fp, r) != LDNS_STATUS_OK
+	||  fseek(fp, 0, SEEK_SET) != 0
+	||  ldns_resolver_read_rtt(r2, fp) != LDNS_STATUS_OK) {
+		printf("rtt: can not write and read the round trip times\n");
+		result = 1;
+	} else {
+		result |= rtt_is(r2, 0, LDNS_RESOLV_RTT_MIN, 0, "not read");
+		result |= rtt_is(r2, 1, 80, 40, "read");
+		ldns_resolver_nameserver_rtt_update(r2, 1, 80);
+		result |= rtt_is(r2, 1, 80, 30, "after read");
+	}
+	if (fp) {
+		fclose(fp);
+	}
+
+	/* lines that can not be parsed are reported and skipped */
+	if ((fp = tmpfile())) {
+		fprintf(fp, "; comment\nnot an address 1 2 3\n");
+		if (fseek(fp, 0, SEEK_SET) != 0
+		||  ldns_resolver_read_rtt(r2, fp) != LDNS_STATUS_SYNTAX_ERR) {
+			printf("rtt: a bad line is not reported\n");
+			result = 1;
+		}
+		fclose(fp);
+	}
+	ldns_resolver_deep_free(r);
+	ldns_resolver_deep_free(r2);
+	ldns_rdf_deep_free(ns1);
+	ldns_rdf_deep_free(ns2);
+	return result;
+}
+
+/* Answers the queries on sock, except those for names starting with d */
+static void
+bulk_server(int sock)
+{
+	uint8_t buf[512];
+	struct sockaddr_storage from;
+	socklen_t from_len;
+	ssize_t len;
+
+	alarm(30);
+	for (;;) {
+		from_len = (socklen_t)sizeof(from);
+		len = recvfrom(sock, (void *)buf, sizeof(buf), 0,
+				(struct sockaddr *)&from, &from_len);
+		if (len <= LDNS_HEADER_SIZE + 1 || buf[13] == 'd') {
+			continue;
+		}
+		LDNS_QR_SET(buf);
+		(void) sendto(sock, (void *)buf, (size_t)len, 0,
+				(struct sockaddr *)&from, from_len);
+	}
+}
+
+int
+test_send_bulk(void)
+{
+	const size_t n = 200, dropped = 100;
+	struct sockaddr_in addr;
+	socklen_t addr_len = (socklen_t)sizeof(addr);
+	struct timeval timeout = { 0, 200000 };
+	ldns_pkt *queries[200], *answers[200];
+	ldns_resolver *r;
+	ldns_rdf *ns;
+	ldns_status status;
+	char name[32];
+	size_t i, consecutive = 0;
+	int sock, result = 0;
+	pid_t pid;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if ((sock = socket(AF_INET, SOCK_DGRAM, 0)) == -1
+	||  bind(sock, (struct sockaddr *)&addr, addr_len) == -1
+	||  getsockname(sock, (struct sockaddr *)&addr, &addr_len) == -1
+	||  (pid = fork()) == -1) {
+		printf("send bulk: can not start the server\n");
+		return 1;
+	}
+	if (pid == 0) {
+		bulk_server(sock);
+		_exit(0);
+	}
+	close(sock);
+
+	r = ldns_resolver_new();
+	ns = ldns_rdf_new_frm_str(LDNS_RDF_TYPE_A, "127.0.0.1");
+	(void) ldns_resolver_push_nameserver(r, ns);
+	ldns_resolver_set_port(r, ntohs(addr.sin_port));
+	ldns_resolver_set_timeout(r, timeout);
+	ldns_resolver_set_retry(r, 1);
+	for (i = 0; i < n; i++) {
+		snprintf(name, sizeof(name), "%c%u.example.",
+			i < dropped ? 'd' : 'a', (unsigned)i);
+		queries[i] = ldns_pkt_query_new(ldns_dname_new_frm_str(name),
+				LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, LDNS_RD);
+	}
+
+	/* More unanswered queries than fit in the window do not keep the
+	 * others from being sent */
+	status = ldns_send_bulk(answers, r, queries, n);
+	if (status != LDNS_STATUS_NETWORK_ERR) {
+		printf("send bulk: %s\n", ldns_get_errorstr_by_id(status));
+		result = 1;
+	}
+	for (i = 0; i < n; i++) {
+		if ((answers[i] == NULL) != (i < dropped)) {
+			printf("send bulk: query %u %sanswered\n",
+				(unsigned)i, answers[i] ? "" : "not ");
+			result = 1;
+			break;
+		}
+	}
+
+	/* and the message IDs can not be guessed from one another */
+	for (i = dropped + 1; result == 0 && i < n; i++) {
+		if (ldns_pkt_id(answers[i]) ==
+				(uint16_t)(ldns_pkt_id(answers[i - 1]) + 1)) {
+			consecutive++;
+		}
+	}
+	if (consecutive > 10) {
+		printf("send bulk: %u consecutive message IDs\n",
+			(unsigned)consecutive);
+		result = 1;
+	}
+	kill(pid, SIGKILL);
+	(void) waitpid(pid, NULL, 0);
+	for (i = 0; i < n; i++) {
+		ldns_pkt_free(queries[i]);
+		ldns_pkt_free(answers[i]);
+	}
+	ldns_rdf_deep_free(ns);
+	ldns_resolver_deep_free(r);
+	return result;
+}
+
 int
 main(void)
 {
@@ -872,11 +2674,50 @@ main(void)
 	if (test_sha256("Test vector from febooti.com", "077b18fe29036ada4890bdec192186e10678597a67880290521df70df4bac9ab") != 0) {
 		result = EXIT_FAILURE;
 	}
+	if (test_sha_many() != 0) {
+		result = EXIT_FAILURE;
+	}
 	free(data);
 
 	if (test_duration())
 		result = EXIT_FAILURE;
 
+	if (test_cache())
+		result = EXIT_FAILURE;
+
+	if (test_compression())
+		result = EXIT_FAILURE;
+
+	if (test_pkt_view())
+		result = EXIT_FAILURE;
+
+	if (test_server())
+		result = EXIT_FAILURE;
+
+	if (test_wire2dname())
+		result = EXIT_FAILURE;
+
+	if (test_rr_codec())
+		result = EXIT_FAILURE;
+
+	if (test_tcp_frame())
+		result = EXIT_FAILURE;
+
+	if (test_wire_validate())
+		result = EXIT_FAILURE;
+
+	if (test_response_size())
+		result = EXIT_FAILURE;
+
+	if (test_buffer_pool())
+		result = EXIT_FAILURE;
+
+	if (test_rtt())
+		result = EXIT_FAILURE;
+
+	if (test_send_bulk())
+		result = EXIT_FAILURE;
+
 	printf("unit test is %s\n", result==EXIT_SUCCESS?"ok":"fail");
 	exit(result);
 }
@@ -256,6 +256,108 @@ check_option_list(void)
 	return 1;
 }
 
+static int
+check_option_find(void)
+{
+	uint8_t cookie[] = {1, 2, 3, 4, 5, 6, 7, 8};
+	uint8_t padding[] = {0, 0, 0};
+	uint8_t expect[] = {
+		0, 0, 41, 0x04, 0xd0, 0, 0, 0x80, 0,	/* OPT, 1232, DO */
+		0, 19,					/* rdlength */
+		0, 10, 0, 8, 1, 2, 3, 4, 5, 6, 7, 8,	/* COOKIE */
+		0, 12, 0, 3, 0, 0, 0			/* PADDING */
+	};
+	ldns_edns_option_list *list;
+	ldns_edns_option_iter iter;
+	ldns_edns_option option;
+	ldns_buffer *buf;
+	ldns_pkt *pkt, *pkt2;
+	uint8_t *wire;
+	size_t wire_len, start, n;
+	int result = 1;
+
+	/* an OPT RR written in place */
+	buf = ldns_buffer_new(16);
+	start = ldns_edns_opt_begin(buf, 1232, 0, 0, 0x8000);
+	(void) ldns_edns_option2buffer_wire(buf, LDNS_EDNS_COOKIE,
+			sizeof(cookie), cookie);
+	(void) ldns_edns_option2buffer_wire(buf, LDNS_EDNS_PADDING,
+			sizeof(padding), padding);
+	if (ldns_edns_opt_end(buf, start) != LDNS_STATUS_OK
+	||  ldns_buffer_position(buf) != sizeof(expect)
+	||  memcmp(ldns_buffer_begin(buf), expect, sizeof(expect)) != 0) {
+		printf("Error: OPT RR written in place is incorrect\n");
+		result = 0;
+	}
+	ldns_buffer_free(buf);
+
+	/* the same OPT RR from a packet with a list of options */
+	pkt = ldns_pkt_query_new(ldns_dname_new_frm_str("example.com."),
+			LDNS_RR_TYPE_A, LDNS_RR_CLASS_IN, 0);
+	ldns_pkt_set_edns_udp_size(pkt, 1232);
+	ldns_pkt_set_edns_do(pkt, true);
+	list = ldns_edns_option_list_new();
+	ldns_edns_option_list_push(list, ldns_edns_new_from_data(
+			LDNS_EDNS_COOKIE, sizeof(cookie), cookie));
+	ldns_edns_option_list_push(list, ldns_edns_new_from_data(
+			LDNS_EDNS_PADDING, sizeof(padding), padding));
+	ldns_pkt_set_edns_option_list(pkt, list);
+	if (ldns_pkt2wire(&wire, pkt, &wire_len) != LDNS_STATUS_OK
+	||  wire_len < sizeof(expect)
+	||  memcmp(wire + wire_len - sizeof(expect), expect,
+			sizeof(expect)) != 0) {
+		printf("Error: OPT RR of the packet is incorrect\n");
+		ldns_pkt_free(pkt);
+		return 0;
+	}
+	ldns_pkt_free(pkt);
+
+	/* found without making the list */
+	if (ldns_wire2pkt(&pkt2, wire, wire_len) != LDNS_STATUS_OK) {
+		printf("Error: packet with OPT RR can not be read\n");
+		LDNS_FREE(wire);
+		return 0;
+	}
+	LDNS_FREE(wire);
+	if (!ldns_pkt_edns_option_find(pkt2, LDNS_EDNS_COOKIE, &option)
+	||  ldns_edns_get_size(&option) != sizeof(cookie)
+	||  memcmp(ldns_edns_get_data(&option), cookie, sizeof(cookie)) != 0
+	||  ldns_pkt_edns_option_find(pkt2, LDNS_EDNS_EDE, &option)
+	||  pkt2->_edns_list != NULL) {
+		printf("Error: EDNS option is not found in the data\n");
+		result = 0;
+	}
+	ldns_edns_option_iter_init(&iter,
+			ldns_rdf_data(ldns_pkt_edns_data(pkt2)),
+			ldns_rdf_size(ldns_pkt_edns_data(pkt2)));
+	for (n = 0; ldns_edns_option_iter_next(&iter, &option); n++)
+		;
+	if (n != 2) {
+		printf("Error: EDNS iterator gives %d options\n", (int)n);
+		result = 0;
+	}
+
+	/* and in the list once it is made and changed */
+	list = ldns_pkt_edns_get_option_list(pkt2);
+	ldns_edns_deep_free(ldns_edns_option_list_pop(list));
+	if (!ldns_pkt_edns_option_find(pkt2, LDNS_EDNS_COOKIE, &option)
+	||  ldns_pkt_edns_option_find(pkt2, LDNS_EDNS_PADDING, &option)) {
+		printf("Error: EDNS option is not found in the list\n");
+		result = 0;
+	}
+	ldns_pkt_free(pkt2);
+
+	/* a malformed option ends the iteration */
+	expect[14] = 9;
+	ldns_edns_option_iter_init(&iter, expect + 11, sizeof(expect) - 11);
+	if (ldns_edns_option_iter_next(&iter, &option)
+	&&  ldns_edns_option_iter_next(&iter, &option)) {
+		printf("Error: malformed EDNS option is given\n");
+		result = 0;
+	}
+	return result;
+}
+
 int main(void)
 {
 	int result = EXIT_SUCCESS;
@@ -268,6 +370,10 @@ int main(void)
 		printf("check_option_list() failed.\n");
 		result = EXIT_FAILURE;
 	}
+	if (!check_option_find()) {
+		printf("check_option_find() failed.\n");
+		result = EXIT_FAILURE;
+	}
 
 	exit(result);
 }
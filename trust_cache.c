@@ -0,0 +1,313 @@
+/*
+ * trust_cache.c -- cache of validated DNSKEY and DS RRsets
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/* Seconds between walks over the cache to drop expired RRsets */
+#define LDNS_TRUST_CACHE_SWEEP		60
+
+/* A validated RRset */
+typedef struct ldns_trust_cache_rrset {
+	ldns_rr_list	*rrset;
+	/* Valid for validations from this time ... */
+	time_t		 from;
+	/* ... until this time */
+	time_t		 expires;
+} ldns_trust_cache_rrset;
+
+/* The validated RRsets of a zone */
+typedef struct ldns_trust_cache_zone {
+	/* key points to name */
+	ldns_rbnode_t		 node;
+	ldns_rdf		*name;
+	ldns_trust_cache_rrset	 dnskey;
+	ldns_trust_cache_rrset	 ds;
+} ldns_trust_cache_zone;
+
+struct ldns_struct_trust_cache
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_t		 lock;
+#endif
+	ldns_rbtree_t		*zones;
+	time_t			 sweep;
+	size_t			 hits;
+	size_t			 misses;
+	size_t			 stores;
+	size_t			 expired;
+	size_t			 entries;
+};
+
+static void
+ldns_trust_cache_lock(ldns_trust_cache *tc)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_lock(&tc->lock);
+#else
+	(void)tc;
+#endif
+}
+
+static void
+ldns_trust_cache_unlock(ldns_trust_cache *tc)
+{
+#ifdef HAVE_PTHREAD
+	pthread_mutex_unlock(&tc->lock);
+#else
+	(void)tc;
+#endif
+}
+
+ldns_trust_cache *
+ldns_trust_cache_new(void)
+{
+	ldns_trust_cache *tc = LDNS_CALLOC(ldns_trust_cache, 1);
+
+	if (!tc) {
+		return NULL;
+	}
+	if (!(tc->zones = ldns_rbtree_create(ldns_dname_compare_v))) {
+		LDNS_FREE(tc);
+		return NULL;
+	}
+#ifdef HAVE_PTHREAD
+	pthread_mutex_init(&tc->lock, NULL);
+#endif
+	return tc;
+}
+
+static void
+ldns_trust_cache_zone_free(ldns_rbnode_t *node, void *arg)
+{
+	ldns_trust_cache_zone *zone = (ldns_trust_cache_zone *)node;
+
+	(void)arg;
+	ldns_rdf_deep_free(zone->name);
+	ldns_rr_list_deep_free(zone->dnskey.rrset);
+	ldns_rr_list_deep_free(zone->ds.rrset);
+	LDNS_FREE(zone);
+}
+
+static void
+ldns_trust_cache_clear(ldns_trust_cache *tc)
+{
+	ldns_traverse_postorder(tc->zones, ldns_trust_cache_zone_free, NULL);
+	ldns_rbtree_init(tc->zones, ldns_dname_compare_v);
+	tc->entries = 0;
+}
+
+void
+ldns_trust_cache_free(ldns_trust_cache *tc)
+{
+	if (!tc) {
+		return;
+	}
+	ldns_trust_cache_clear(tc);
+	ldns_rbtree_free(tc->zones);
+#ifdef HAVE_PTHREAD
+	pthread_mutex_destroy(&tc->lock);
+#endif
+	LDNS_FREE(tc);
+}
+
+void
+ldns_trust_cache_flush(ldns_trust_cache *tc)
+{
+	if (!tc) {
+		return;
+	}
+	ldns_trust_cache_lock(tc);
+	ldns_trust_cache_clear(tc);
+	ldns_trust_cache_unlock(tc);
+}
+
+static ldns_trust_cache_rrset *
+ldns_trust_cache_slot(ldns_trust_cache_zone *zone, ldns_rr_type type)
+{
+	return type == LDNS_RR_TYPE_DNSKEY ? &zone->dnskey : &zone->ds;
+}
+
+/* Drops an RRset, and its zone when that has none left */
+static void
+ldns_trust_cache_drop(ldns_trust_cache *tc, ldns_trust_cache_zone *zone,
+		ldns_trust_cache_rrset *rrset)
+{
+	ldns_rr_list_deep_free(rrset->rrset);
+	rrset->rrset = NULL;
+	tc->entries--;
+	if (!zone->dnskey.rrset && !zone->ds.rrset) {
+		(void) ldns_rbtree_delete(tc->zones, zone->name);
+		ldns_trust_cache_zone_free(&zone->node, NULL);
+	}
+}
+
+static void
+ldns_trust_cache_sweep(ldns_trust_cache *tc, time_t now)
+{
+	ldns_rbnode_t *node, *next;
+	ldns_trust_cache_zone *zone;
+
+	for (node = ldns_rbtree_first(tc->zones); node != LDNS_RBTREE_NULL;
+			node = next) {
+		next = ldns_rbtree_next(node);
+		zone = (ldns_trust_cache_zone *)node;
+		if (zone->ds.rrset && zone->ds.expires <= now) {
+			tc->expired++;
+			ldns_trust_cache_drop(tc, zone, &zone->ds);
+		}
+		if (zone->dnskey.rrset && zone->dnskey.expires <= now) {
+			tc->expired++;
+			ldns_trust_cache_drop(tc, zone, &zone->dnskey);
+		}
+	}
+	tc->sweep = now + LDNS_TRUST_CACHE_SWEEP;
+}
+
+ldns_rr_list *
+ldns_trust_cache_lookup(ldns_trust_cache *tc, const ldns_rdf *zone,
+		ldns_rr_type type, time_t check_time)
+{
+	ldns_trust_cache_zone *z;
+	ldns_trust_cache_rrset *rrset;
+	ldns_rr_list *r = NULL;
+
+	if (!tc || !zone || (type != LDNS_RR_TYPE_DNSKEY
+				&& type != LDNS_RR_TYPE_DS)) {
+		return NULL;
+	}
+	ldns_trust_cache_lock(tc);
+	z = (ldns_trust_cache_zone *)ldns_rbtree_search(tc->zones, zone);
+	if (z) {
+		rrset = ldns_trust_cache_slot(z, type);
+		if (rrset->rrset && rrset->expires <= check_time) {
+			tc->expired++;
+			ldns_trust_cache_drop(tc, z, rrset);
+		} else if (rrset->rrset && rrset->from <= check_time) {
+			r = ldns_rr_list_clone(rrset->rrset);
+		}
+	}
+	if (r) {
+		tc->hits++;
+	} else {
+		tc->misses++;
+	}
+	ldns_trust_cache_unlock(tc);
+	return r;
+}
+
+ldns_status
+ldns_trust_cache_store(ldns_trust_cache *tc, const ldns_rdf *zone,
+		ldns_rr_type type, const ldns_rr_list *rrset,
+		const ldns_rr_list *rrsigs, time_t check_time)
+{
+	ldns_trust_cache_zone *z;
+	ldns_trust_cache_rrset *slot;
+	ldns_rr_list *clone;
+	ldns_rr *sig;
+	uint32_t ttl = LDNS_TRUST_CACHE_MAX_TTL;
+	time_t from = 0, expires;
+	int32_t left, since;
+	bool valid = false;
+	size_t i;
+
+	if (!tc || !zone || !rrset || ldns_rr_list_rr_count(rrset) == 0
+	||  (type != LDNS_RR_TYPE_DNSKEY && type != LDNS_RR_TYPE_DS)) {
+		return LDNS_STATUS_ERR;
+	}
+	for (i = 0; i < ldns_rr_list_rr_count(rrset); i++) {
+		if (ldns_rr_ttl(ldns_rr_list_rr(rrset, i)) < ttl) {
+			ttl = ldns_rr_ttl(ldns_rr_list_rr(rrset, i));
+		}
+	}
+	expires = check_time + ttl;
+
+	/* Keep it no longer than the signatures over it are valid, using
+	 * serial number arithmetic like ldns_verify_rrsig_time() does.
+	 */
+	for (i = 0; i < ldns_rr_list_rr_count(rrsigs); i++) {
+		sig = ldns_rr_list_rr(rrsigs, i);
+		if (ldns_rr_get_type(sig) != LDNS_RR_TYPE_RRSIG
+		||  ldns_rr_rd_count(sig) < 9
+		||  ldns_rdf2rr_type(ldns_rr_rrsig_typecovered(sig)) != type) {
+			continue;
+		}
+		left = (int32_t)(ldns_rdf2native_int32(
+				ldns_rr_rrsig_expiration(sig))
+				- (uint32_t)check_time);
+		since = (int32_t)((uint32_t)check_time
+				- ldns_rdf2native_int32(
+					ldns_rr_rrsig_inception(sig)));
+		if (left <= 0 || since < 0) {
+			continue;
+		}
+		if (check_time + left < expires) {
+			expires = check_time + left;
+		}
+		if (!valid || check_time - since > from) {
+			from = check_time - since;
+		}
+		valid = true;
+	}
+	if (!valid || expires <= check_time) {
+		return LDNS_STATUS_ERR;
+	}
+	if (!(clone = ldns_rr_list_clone(rrset))) {
+		return LDNS_STATUS_MEM_ERR;
+	}
+	ldns_trust_cache_lock(tc);
+	if (check_time >= tc->sweep) {
+		ldns_trust_cache_sweep(tc, check_time);
+	}
+	z = (ldns_trust_cache_zone *)ldns_rbtree_search(tc->zones, zone);
+	if (!z) {
+		if (!(z = LDNS_CALLOC(ldns_trust_cache_zone, 1))
+		||  !(z->name = ldns_rdf_clone(zone))) {
+			ldns_trust_cache_unlock(tc);
+			LDNS_FREE(z);
+			ldns_rr_list_deep_free(clone);
+			return LDNS_STATUS_MEM_ERR;
+		}
+		ldns_dname2canonical(z->name);
+		z->node.key = z->name;
+		(void) ldns_rbtree_insert(tc->zones, &z->node);
+	}
+	slot = ldns_trust_cache_slot(z, type);
+	if (slot->rrset) {
+		ldns_rr_list_deep_free(slot->rrset);
+	} else {
+		tc->entries++;
+	}
+	slot->rrset = clone;
+	slot->from = from;
+	slot->expires = expires;
+	tc->stores++;
+	ldns_trust_cache_unlock(tc);
+	return LDNS_STATUS_OK;
+}
+
+void
+ldns_trust_cache_get_stats(ldns_trust_cache *tc, ldns_trust_cache_stats *stats)
+{
+	if (!tc || !stats) {
+		return;
+	}
+	ldns_trust_cache_lock(tc);
+	stats->hits = tc->hits;
+	stats->misses = tc->misses;
+	stats->stores = tc->stores;
+	stats->expired = tc->expired;
+	stats->entries = tc->entries;
+	ldns_trust_cache_unlock(tc);
+}
@@ -198,7 +198,7 @@ ldns_tsig_mac_new(ldns_rdf **tsig_mac, const uint8_t *pkt_wire, size_t pkt_wire_
 	/*
 	 * prepare the digestible information
 	 */
-	data_buffer = ldns_buffer_new(LDNS_MAX_PACKETLEN);
+	data_buffer = ldns_buffer_acquire(LDNS_MAX_PACKETLEN);
 	if (!data_buffer) {
 		status = LDNS_STATUS_MEM_ERR;
 		goto clean;
@@ -275,7 +275,7 @@ ldns_tsig_mac_new(ldns_rdf **tsig_mac, const uint8_t *pkt_wire, size_t pkt_wire_
 	LDNS_FREE(mac_bytes);
 	LDNS_FREE(key_bytes);
 	LDNS_FREE(algorithm_name);
-	ldns_buffer_free(data_buffer);
+	ldns_buffer_release_clear(data_buffer);
 	ldns_rdf_deep_free(canonical_algorithm_rdf);
 	ldns_rdf_deep_free(canonical_key_name_rdf);
 	return status;
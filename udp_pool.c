@@ -0,0 +1,357 @@
+/*
+ * udp_pool.c -- pool of UDP sockets for a resolver
+ *
+ * Copyright (c) 2024, NLnet Labs. All rights reserved.
+ *
+ * See LICENSE for the license.
+ *
+ */
+
+#include <ldns/config.h>
+
+#include <ldns/ldns.h>
+
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#include <errno.h>
+#include <fcntl.h>
+
+/* Random ports to try binding to before leaving it to the system */
+#define LDNS_UDP_POOL_BIND_TRIES	10
+
+/* Lowest random port to bind to */
+#define LDNS_UDP_POOL_PORT_MIN		1024
+
+/* Datagrams to discard at most when a socket is handed out */
+#define LDNS_UDP_POOL_DRAIN		64
+
+typedef struct ldns_udp_pool_sock ldns_udp_pool_sock;
+
+/* A socket of the pool */
+struct ldns_udp_pool_sock {
+	int	fd;		/* -1 when not open */
+	size_t	uses;		/* queries sent from it */
+	bool	busy;		/* handed out */
+	bool	stale;		/* bound to an old source address */
+};
+
+/* The sockets of one address family */
+typedef struct ldns_udp_pool_family {
+	ldns_udp_pool_sock	*socks;
+	int			 family;
+	/* The address the sockets are bound to, or NULL for any */
+	ldns_rdf		*source;
+	bool			 opened;
+} ldns_udp_pool_family;
+
+struct ldns_struct_udp_pool {
+	size_t			 size;
+	size_t			 rotate;
+	ldns_udp_pool_family	 families[2];
+	ldns_udp_pool_stats	 stats;
+};
+
+ldns_udp_pool *
+ldns_udp_pool_new(size_t sockets)
+{
+	ldns_udp_pool *pool;
+	size_t i;
+
+	if (sockets == 0) {
+		sockets = LDNS_UDP_POOL_DEFAULT_SOCKETS;
+	}
+	if (!(pool = LDNS_CALLOC(ldns_udp_pool, 1))) {
+		return NULL;
+	}
+	pool->size = sockets;
+	pool->rotate = LDNS_UDP_POOL_DEFAULT_ROTATE;
+	pool->families[0].family = AF_INET;
+	pool->families[1].family = AF_INET6;
+	if (!(pool->families[0].socks = LDNS_XMALLOC(ldns_udp_pool_sock,
+			sockets))
+	||  !(pool->families[1].socks = LDNS_XMALLOC(ldns_udp_pool_sock,
+			sockets))) {
+		ldns_udp_pool_free(pool);
+		return NULL;
+	}
+	for (i = 0; i < sockets; i++) {
+		pool->families[0].socks[i].fd = -1;
+		pool->families[0].socks[i].uses = 0;
+		pool->families[0].socks[i].busy = false;
+		pool->families[0].socks[i].stale = false;
+		pool->families[1].socks[i] = pool->families[0].socks[i];
+	}
+	return pool;
+}
+
+void
+ldns_udp_pool_free(ldns_udp_pool *pool)
+{
+	size_t f, i;
+
+	if (!pool) {
+		return;
+	}
+	for (f = 0; f < 2; f++) {
+		if (pool->families[f].socks) {
+			for (i = 0; i < pool->size; i++) {
+				close_socket(pool->families[f].socks[i].fd);
+			}
+			LDNS_FREE(pool->families[f].socks);
+		}
+		ldns_rdf_deep_free(pool->families[f].source);
+	}
+	LDNS_FREE(pool);
+}
+
+size_t
+ldns_udp_pool_size(const ldns_udp_pool *pool)
+{
+	return pool->size;
+}
+
+size_t
+ldns_udp_pool_rotate(const ldns_udp_pool *pool)
+{
+	return pool->rotate;
+}
+
+void
+ldns_udp_pool_set_rotate(ldns_udp_pool *pool, size_t queries)
+{
+	pool->rotate = queries;
+}
+
+void
+ldns_udp_pool_get_stats(const ldns_udp_pool *pool, ldns_udp_pool_stats *stats)
+{
+	*stats = pool->stats;
+}
+
+/** best effort to set nonblocking */
+static void
+ldns_udp_pool_sock_nonblock(int sockfd)
+{
+#ifdef HAVE_FCNTL
+	int flag;
+	if((flag = fcntl(sockfd, F_GETFL)) != -1) {
+		flag |= O_NONBLOCK;
+		if(fcntl(sockfd, F_SETFL, flag) == -1) {
+			/* ignore error, continue blockingly */
+		}
+	}
+#elif defined(HAVE_IOCTLSOCKET)
+	unsigned long on = 1;
+	if(ioctlsocket(sockfd, FIONBIO, &on) != 0) {
+		/* ignore error, continue blockingly */
+	}
+#endif
+}
+
+static void
+ldns_udp_pool_set_port(struct sockaddr_storage *addr, uint16_t port)
+{
+	if (addr->ss_family == AF_INET) {
+		((struct sockaddr_in *)addr)->sin_port = htons(port);
+	} else if (addr->ss_family == AF_INET6) {
+		((struct sockaddr_in6 *)addr)->sin6_port = htons(port);
+	}
+}
+
+/* Opens a socket bound to a random port.  Ports that are in use are
+ * skipped; when no free one is found the system picks the port.
+ */
+static int
+ldns_udp_pool_open(ldns_udp_pool *pool, ldns_udp_pool_family *fam)
+{
+	struct sockaddr_storage any, *addr;
+	size_t addr_len;
+	uint16_t port;
+	int fd, i;
+
+	if (fam->source) {
+		if (!(addr = ldns_rdf2native_sockaddr_storage(fam->source, 0,
+				&addr_len))) {
+			return -1;
+		}
+		if (addr->ss_family != fam->family) {
+			LDNS_FREE(addr);
+			return -1;
+		}
+	} else {
+		memset(&any, 0, sizeof(any));
+		any.ss_family = (sa_family_t)fam->family;
+		addr = &any;
+		addr_len = fam->family == AF_INET6
+		         ? sizeof(struct sockaddr_in6)
+		         : sizeof(struct sockaddr_in);
+	}
+	if ((fd = socket(fam->family, SOCK_DGRAM, IPPROTO_UDP))
+			== SOCK_INVALID) {
+		fd = -1;
+		goto done;
+	}
+	for (i = 0; i < LDNS_UDP_POOL_BIND_TRIES; i++) {
+		port = LDNS_UDP_POOL_PORT_MIN + ldns_get_random()
+		     % (65536 - LDNS_UDP_POOL_PORT_MIN);
+		ldns_udp_pool_set_port(addr, port);
+		if (bind(fd, (struct sockaddr *)addr, (socklen_t)addr_len)
+				== 0) {
+			break;
+		}
+		if (errno != EADDRINUSE && errno != EACCES) {
+			close_socket(fd);
+			goto done;
+		}
+	}
+	if (i == LDNS_UDP_POOL_BIND_TRIES) {
+		ldns_udp_pool_set_port(addr, 0);
+		if (bind(fd, (struct sockaddr *)addr, (socklen_t)addr_len)
+				== -1) {
+			close_socket(fd);
+			goto done;
+		}
+	}
+	ldns_udp_pool_sock_nonblock(fd);
+	pool->stats.opened++;
+done:
+	if (addr != &any) {
+		LDNS_FREE(addr);
+	}
+	return fd;
+}
+
+/* Discards the datagrams waiting on a socket, such as late answers to
+ * an earlier query.
+ */
+static void
+ldns_udp_pool_drain(int fd)
+{
+	uint8_t buf[1];
+	int i;
+
+	for (i = 0; i < LDNS_UDP_POOL_DRAIN; i++) {
+		if (recv(fd, (void *)buf, sizeof(buf), 0) < 0) {
+			break;
+		}
+	}
+}
+
+/* Binds the sockets of a family to source from now on */
+static bool
+ldns_udp_pool_set_source(ldns_udp_pool_family *fam, size_t size,
+		const ldns_rdf *source)
+{
+	ldns_rdf *copy = NULL;
+	size_t i;
+
+	if (source && !(copy = ldns_rdf_clone(source))) {
+		return false;
+	}
+	for (i = 0; i < size; i++) {
+		if (fam->socks[i].busy) {
+			fam->socks[i].stale = true;
+		} else {
+			close_socket(fam->socks[i].fd);
+			fam->socks[i].uses = 0;
+		}
+	}
+	ldns_rdf_deep_free(fam->source);
+	fam->source = copy;
+	return true;
+}
+
+int
+ldns_udp_pool_get(ldns_udp_pool *pool, int family, const ldns_rdf *source)
+{
+	ldns_udp_pool_family *fam;
+	ldns_udp_pool_sock *s = NULL;
+	size_t i, start;
+	int fd;
+
+	if (family == AF_INET) {
+		fam = &pool->families[0];
+	} else if (family == AF_INET6) {
+		fam = &pool->families[1];
+	} else {
+		return -1;
+	}
+	if (!fam->opened
+	||  (fam->source == NULL) != (source == NULL)
+	||  (source && ldns_rdf_compare(fam->source, source) != 0)) {
+		if (!ldns_udp_pool_set_source(fam, pool->size, source)) {
+			return -1;
+		}
+		/* open them all now, so they are ready for the queries */
+		for (i = 0; i < pool->size; i++) {
+			if (!fam->socks[i].busy) {
+				fam->socks[i].fd = ldns_udp_pool_open(pool, fam);
+			}
+		}
+		fam->opened = true;
+	}
+	/* a random socket that is not in use */
+	start = (size_t)ldns_get_random() % pool->size;
+	for (i = 0; i < pool->size; i++) {
+		s = &fam->socks[(start + i) % pool->size];
+		if (!s->busy) {
+			break;
+		}
+	}
+	if (i == pool->size) {
+		/* all in use, this one is closed again on release */
+		pool->stats.overflow++;
+		return ldns_udp_pool_open(pool, fam);
+	}
+	if (s->fd != -1 && pool->rotate && s->uses >= pool->rotate) {
+		close_socket(s->fd);
+		pool->stats.rotated++;
+	}
+	if (s->fd == -1) {
+		if ((fd = ldns_udp_pool_open(pool, fam)) == -1) {
+			return -1;
+		}
+		s->fd = fd;
+		s->uses = 0;
+	} else {
+		ldns_udp_pool_drain(s->fd);
+	}
+	if (s->uses > 0) {
+		pool->stats.reused++;
+	}
+	s->uses++;
+	s->busy = true;
+	return s->fd;
+}
+
+void
+ldns_udp_pool_release(ldns_udp_pool *pool, int sockfd, bool reuse)
+{
+	ldns_udp_pool_sock *s;
+	size_t f, i;
+
+	for (f = 0; f < 2; f++) {
+		for (i = 0; i < pool->size; i++) {
+			s = &pool->families[f].socks[i];
+			if (s->fd != sockfd || !s->busy) {
+				continue;
+			}
+			s->busy = false;
+			if (!reuse) {
+				pool->stats.discarded++;
+			}
+			if (!reuse || s->stale) {
+				close_socket(s->fd);
+				s->uses = 0;
+				s->stale = false;
+			}
+			return;
+		}
+	}
+	/* not one of the pool */
+	close_socket(sockfd);
+}
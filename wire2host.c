@@ -51,107 +51,350 @@
  */
 
 
-/* allocates memory to *dname! */
+/* Compression pointers point below 16384, and are followed by at most
+ * LDNS_MAX_DOMAINLEN bytes of labels before the next pointer, so only
+ * pointers at positions below this are ever followed again. */
+#define LDNS_WIRE2DNAME_LOOP_POSITIONS	(16384 + LDNS_MAX_DOMAINLEN)
+/* Pointers followed before looking for a loop */
+#define LDNS_WIRE2DNAME_FEW_POINTERS	8
+
+/* Follows the compression pointer at p and what comes after it, the way
+ * ldns_wire2dname_buf() does with name_len bytes of the name done, to see
+ * whether it loops.  A pointer followed
+ * again loops for ever: the name grows too long when there are labels in
+ * the loop, and only pointers are followed when there are none.  Anything
+ * else wrong is left for ldns_wire2dname_buf() to find. */
+static ldns_status
+ldns_wire2dname_loop(const uint8_t *wire, size_t max, size_t p,
+		size_t name_len)
+{
+	uint8_t seen[(LDNS_WIRE2DNAME_LOOP_POSITIONS + 7) / 8];
+	size_t start;
+
+	memset(seen, 0, sizeof(seen));
+	for (;;) {
+		if (wire[p] == 0) {
+			return LDNS_STATUS_OK;
+		} else if (wire[p] < 192) {
+			name_len += 1 + (size_t)wire[p];
+			if (wire[p] > LDNS_MAX_LABELLEN || p + 1 + wire[p] >= max
+			||  name_len > LDNS_MAX_DOMAINLEN) {
+				return LDNS_STATUS_OK;
+			}
+			p += 1 + (size_t)wire[p];
+			continue;
+		}
+		if (p + 2 > max) {
+			return LDNS_STATUS_OK;
+		}
+		if (p < LDNS_WIRE2DNAME_LOOP_POSITIONS) {
+			if (seen[p >> 3] & (1 << (p & 7))) {
+				break;
+			}
+			seen[p >> 3] |= (1 << (p & 7));
+		}
+		p = (size_t)(wire[p] & 63) << 8 | wire[p + 1];
+		if (p == 0 || p >= max) {
+			return LDNS_STATUS_OK;
+		}
+	}
+	start = p;
+	do {
+		if (wire[p] < 192) {
+			return LDNS_STATUS_DOMAINNAME_OVERFLOW;
+		}
+		p = (size_t)(wire[p] & 63) << 8 | wire[p + 1];
+	} while (p != start);
+	return LDNS_STATUS_INVALID_POINTER;
+}
+
 ldns_status
-ldns_wire2dname(ldns_rdf **dname, const uint8_t *wire, size_t max, size_t *pos)
+ldns_wire2dname_buf(uint8_t *buf, size_t *len,
+		const uint8_t *wire, size_t max, size_t *pos)
 {
-	uint8_t label_size;
-	uint16_t pointer_target;
-	uint8_t pointer_target_buf[2];
-	size_t dname_pos = 0;
-	size_t compression_pos = 0;
-	uint8_t tmp_dname[LDNS_MAX_DOMAINLEN];
-	unsigned int pointer_count = 0;
+	size_t p, run, name_len = 0, end = 0;
+	unsigned int pointers = 0;
+	ldns_status status;
+	uint8_t label;
 
 	if (pos == NULL) {
 		return LDNS_STATUS_WIRE_RDATA_ERR;
 	}
-	if (*pos >= max) {
+	p = *pos;
+	if (p >= max) {
 		return LDNS_STATUS_PACKET_OVERFLOW;
 	}
-	label_size = wire[*pos];
-	while (label_size > 0) {
-		/* compression */
-		while (label_size >= 192) {
-			if (compression_pos == 0) {
-				compression_pos = *pos + 2;
+	label = wire[p];
+	for (;;) {
+		/* Check a run of labels, and copy it at once.  When the data
+		 * ends after a label, the length of that label is checked
+		 * once more, and fails. */
+		for (run = p; label > 0 && label < 192; ) {
+			if (label > LDNS_MAX_LABELLEN || p + 1 + label > max) {
+				return LDNS_STATUS_LABEL_OVERFLOW;
 			}
-
-			pointer_count++;
-
-			/* remove first two bits */
-			if (*pos + 2 > max) {
-				return LDNS_STATUS_PACKET_OVERFLOW;
+			if (name_len + (p - run) + 1 + label
+					> LDNS_MAX_DOMAINLEN) {
+				return LDNS_STATUS_DOMAINNAME_OVERFLOW;
 			}
-			pointer_target_buf[0] = wire[*pos] & 63;
-			pointer_target_buf[1] = wire[*pos + 1];
-			pointer_target = ldns_read_uint16(pointer_target_buf);
-
-			if (pointer_target == 0) {
-				return LDNS_STATUS_INVALID_POINTER;
-			} else if (pointer_target >= max) {
-				return LDNS_STATUS_INVALID_POINTER;
-			} else if (pointer_count > LDNS_MAX_POINTERS) {
-				return LDNS_STATUS_INVALID_POINTER;
+			p += 1 + (size_t)label;
+			if (p < max) {
+				label = wire[p];
 			}
-			*pos = pointer_target;
-			label_size = wire[*pos];
 		}
-		if(label_size == 0)
-			break; /* break from pointer to 0 byte */
-		if (label_size > LDNS_MAX_LABELLEN) {
-			return LDNS_STATUS_LABEL_OVERFLOW;
+		if (buf && p > run) {
+			memcpy(buf + name_len, wire + run, p - run);
 		}
-		if (*pos + 1 + label_size > max) {
-			return LDNS_STATUS_LABEL_OVERFLOW;
+		name_len += p - run;
+		if (label == 0) {
+			break;
 		}
 
-		/* check space for labelcount itself */
-		if (dname_pos + 1 > LDNS_MAX_DOMAINLEN) {
-			return LDNS_STATUS_DOMAINNAME_OVERFLOW;
+		/* compression */
+		if (end == 0) {
+			end = p + 2;
 		}
-		tmp_dname[dname_pos] = label_size;
-		if (label_size > 0) {
-			dname_pos++;
+		if (p + 2 > max) {
+			return LDNS_STATUS_PACKET_OVERFLOW;
 		}
-		*pos = *pos + 1;
-		if (dname_pos + label_size > LDNS_MAX_DOMAINLEN) {
-			return LDNS_STATUS_DOMAINNAME_OVERFLOW;
+		if (++pointers == LDNS_WIRE2DNAME_FEW_POINTERS
+		&&  (status = ldns_wire2dname_loop(wire, max, p, name_len))
+				!= LDNS_STATUS_OK) {
+			return status;
 		}
-		memcpy(&tmp_dname[dname_pos], &wire[*pos], label_size);
-		dname_pos += label_size;
-		*pos = *pos + label_size;
-
-		if (*pos < max) {
-			label_size = wire[*pos];
+		run = (size_t)(label & 63) << 8 | wire[p + 1];
+		if (run == 0 || run >= max) {
+			return LDNS_STATUS_INVALID_POINTER;
 		}
+		p = run;
+		label = wire[p];
 	}
-
-	if (compression_pos > 0) {
-		*pos = compression_pos;
-	} else {
-		*pos = *pos + 1;
-	}
-
-	if (dname_pos >= LDNS_MAX_DOMAINLEN) {
+	*pos = end ? end : p + 1;
+	if (name_len >= LDNS_MAX_DOMAINLEN) {
 		return LDNS_STATUS_DOMAINNAME_OVERFLOW;
 	}
+	if (buf) {
+		buf[name_len] = 0;
+	}
+	if (len) {
+		*len = name_len + 1;
+	}
+	return LDNS_STATUS_OK;
+}
 
-	tmp_dname[dname_pos] = 0;
-	dname_pos++;
+/* allocates memory to *dname! */
+ldns_status
+ldns_wire2dname(ldns_rdf **dname, const uint8_t *wire, size_t max, size_t *pos)
+{
+	uint8_t tmp_dname[LDNS_MAX_DOMAINLEN];
+	size_t dname_len;
+	ldns_status status;
 
+	status = ldns_wire2dname_buf(tmp_dname, &dname_len, wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
 	*dname = ldns_rdf_new_frm_data(LDNS_RDF_TYPE_DNAME,
-			(uint16_t) dname_pos, tmp_dname);
+			(uint16_t) dname_len, tmp_dname);
 	if (!*dname) {
 		return LDNS_STATUS_MEM_ERR;
 	}
 	return LDNS_STATUS_OK;
 }
 
+/* Size of a chunk of a ldns_dname_arena */
+#define LDNS_DNAME_ARENA_CHUNK	4096
+/* Alignment of the rdfs in a chunk */
+#define LDNS_DNAME_ARENA_ALIGN(n) (((n) + 7) & ~(size_t)7)
+
+/* A chunk, followed by the rdfs and names made in it */
+typedef struct ldns_dname_arena_chunk {
+	struct ldns_dname_arena_chunk	*next;
+	size_t				 used;
+} ldns_dname_arena_chunk;
+
+struct ldns_struct_dname_arena
+{
+	/* The chunk names are made in, followed by the ones filled before */
+	ldns_dname_arena_chunk	*chunks;
+};
+
+ldns_dname_arena *
+ldns_dname_arena_new(void)
+{
+	return LDNS_CALLOC(ldns_dname_arena, 1);
+}
+
+void
+ldns_dname_arena_clear(ldns_dname_arena *arena)
+{
+	ldns_dname_arena_chunk *chunk, *next;
+
+	if (!arena || !arena->chunks) {
+		return;
+	}
+	/* Keep one chunk for the next message */
+	for (chunk = arena->chunks; chunk->next; chunk = next) {
+		next = chunk->next;
+		LDNS_FREE(chunk);
+	}
+	chunk->used = LDNS_DNAME_ARENA_ALIGN(sizeof(*chunk));
+	arena->chunks = chunk;
+}
+
+void
+ldns_dname_arena_free(ldns_dname_arena *arena)
+{
+	if (!arena) {
+		return;
+	}
+	ldns_dname_arena_clear(arena);
+	LDNS_FREE(arena->chunks);
+	LDNS_FREE(arena);
+}
+
+ldns_status
+ldns_wire2dname_arena(ldns_rdf **dname, ldns_dname_arena *arena,
+		const uint8_t *wire, size_t max, size_t *pos)
+{
+	const size_t rdf_size = LDNS_DNAME_ARENA_ALIGN(sizeof(ldns_rdf));
+	ldns_dname_arena_chunk *chunk;
+	ldns_rdf *rdf;
+	size_t len;
+	ldns_status status;
+
+	if (!dname || !arena) {
+		return LDNS_STATUS_NULL;
+	}
+	chunk = arena->chunks;
+	if (!chunk || chunk->used + rdf_size + LDNS_MAX_DOMAINLEN
+			> LDNS_DNAME_ARENA_CHUNK) {
+		chunk = (ldns_dname_arena_chunk *)
+			LDNS_XMALLOC(uint8_t, LDNS_DNAME_ARENA_CHUNK);
+		if (!chunk) {
+			return LDNS_STATUS_MEM_ERR;
+		}
+		chunk->next = arena->chunks;
+		chunk->used = LDNS_DNAME_ARENA_ALIGN(sizeof(*chunk));
+		arena->chunks = chunk;
+	}
+	/* Decompress right after the rdf, and keep only what is used */
+	rdf = (ldns_rdf *)((uint8_t *)chunk + chunk->used);
+	status = ldns_wire2dname_buf((uint8_t *)rdf + rdf_size, &len,
+			wire, max, pos);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	rdf->_size = len;
+	rdf->_type = LDNS_RDF_TYPE_DNAME;
+	rdf->_data = (uint8_t *)rdf + rdf_size;
+	chunk->used += LDNS_DNAME_ARENA_ALIGN(rdf_size + len);
+	*dname = rdf;
+	return LDNS_STATUS_OK;
+}
+
 /* maybe make this a goto error so data can be freed or something/ */
 #define LDNS_STATUS_CHECK_RETURN(st) {if (st != LDNS_STATUS_OK) { return st; }}
 #define LDNS_STATUS_CHECK_GOTO(st, label) {if (st != LDNS_STATUS_OK) { /*printf("STG %s:%d: status code %d\n", __FILE__, __LINE__, st);*/  goto label; }}
 
+/*
+ * Gets the size of the rdf of type at pos, for all rdf types but
+ * LDNS_RDF_TYPE_DNAME, checking that it ends before end.  The size is 0
+ * for types that can not be in wire format.
+ */
+static ldns_status
+ldns_rdf_wire_size(ldns_rdf_type type, const uint8_t *wire, size_t pos,
+		size_t end, size_t *size)
+{
+	switch (type) {
+	case LDNS_RDF_TYPE_CLASS:
+	case LDNS_RDF_TYPE_ALG:
+	case LDNS_RDF_TYPE_CERTIFICATE_USAGE:
+	case LDNS_RDF_TYPE_SELECTOR:
+	case LDNS_RDF_TYPE_MATCHING_TYPE:
+	case LDNS_RDF_TYPE_INT8:
+		*size = LDNS_RDF_SIZE_BYTE;
+		break;
+	case LDNS_RDF_TYPE_TYPE:
+	case LDNS_RDF_TYPE_INT16:
+	case LDNS_RDF_TYPE_CERT_ALG:
+		*size = LDNS_RDF_SIZE_WORD;
+		break;
+	case LDNS_RDF_TYPE_TIME:
+	case LDNS_RDF_TYPE_INT32:
+	case LDNS_RDF_TYPE_A:
+	case LDNS_RDF_TYPE_PERIOD:
+		*size = LDNS_RDF_SIZE_DOUBLEWORD;
+		break;
+	case LDNS_RDF_TYPE_TSIGTIME:
+	case LDNS_RDF_TYPE_EUI48:
+		*size = LDNS_RDF_SIZE_6BYTES;
+		break;
+	case LDNS_RDF_TYPE_ILNP64:
+	case LDNS_RDF_TYPE_EUI64:
+		*size = LDNS_RDF_SIZE_8BYTES;
+		break;
+	case LDNS_RDF_TYPE_AAAA:
+		*size = LDNS_RDF_SIZE_16BYTES;
+		break;
+	case LDNS_RDF_TYPE_STR:
+	case LDNS_RDF_TYPE_NSEC3_SALT:
+	case LDNS_RDF_TYPE_TAG:
+		/* len is stored in first byte
+		 * it should be in the rdf too, so just
+		 * copy len+1 from this position
+		 */
+		*size = ((size_t) wire[pos]) + 1;
+		break;
+
+	case LDNS_RDF_TYPE_INT16_DATA:
+		if (pos + 2 > end) {
+			return LDNS_STATUS_PACKET_OVERFLOW;
+		}
+		*size = (size_t) ldns_read_uint16(&wire[pos]) + 2;
+		break;
+	case LDNS_RDF_TYPE_HIP:
+		if (pos + 4 > end) {
+			return LDNS_STATUS_PACKET_OVERFLOW;
+		}
+		*size = (size_t) wire[pos] + 
+			(size_t) ldns_read_uint16(&wire[pos + 2]) + 4;
+		break;
+	case LDNS_RDF_TYPE_B32_EXT:
+	case LDNS_RDF_TYPE_NSEC3_NEXT_OWNER:
+		/* length is stored in first byte */
+		*size = ((size_t) wire[pos]) + 1;
+		break;
+	case LDNS_RDF_TYPE_APL:
+	case LDNS_RDF_TYPE_B64:
+	case LDNS_RDF_TYPE_HEX:
+	case LDNS_RDF_TYPE_NSEC:
+	case LDNS_RDF_TYPE_UNKNOWN:
+	case LDNS_RDF_TYPE_SERVICE:
+	case LDNS_RDF_TYPE_LOC:
+	case LDNS_RDF_TYPE_WKS:
+	case LDNS_RDF_TYPE_NSAP:
+	case LDNS_RDF_TYPE_ATMA:
+	case LDNS_RDF_TYPE_IPSECKEY:
+	case LDNS_RDF_TYPE_LONG_STR:
+	case LDNS_RDF_TYPE_AMTRELAY:
+	case LDNS_RDF_TYPE_SVCPARAMS:
+	case LDNS_RDF_TYPE_NONE:
+		/*
+		 * Read to end of rr rdata
+		 */
+		*size = end - pos;
+		break;
+	default:
+		*size = 0;
+		break;
+	}
+	if (*size + pos > end) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	return LDNS_STATUS_OK;
+}
+
 ldns_status
 ldns_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max, size_t *pos)
 {
@@ -163,12 +406,11 @@ ldns_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max, size_t *pos)
 	ldns_rdf *cur_rdf = NULL;
 	ldns_rdf_type cur_rdf_type;
 	const ldns_rr_descriptor *descriptor;
+	const ldns_rr_codec *codec;
 	ldns_status status;
 
 	assert(rr != NULL);
 
-	descriptor = ldns_rr_descript(ldns_rr_get_type(rr));
-
 	if (*pos + 2 > max) {
 		return LDNS_STATUS_PACKET_OVERFLOW;
 	}
@@ -182,6 +424,12 @@ ldns_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max, size_t *pos)
 
 	end = *pos + (size_t) rd_length;
 
+	codec = ldns_rr_codec_get(ldns_rr_get_type(rr));
+	if (codec) {
+		return codec->wire2rdf(rr, wire, max, pos, end);
+	}
+	descriptor = ldns_rr_descript(ldns_rr_get_type(rr));
+
 	rdf_index = 0;
 	while (*pos < end &&
 			rdf_index < ldns_rr_descriptor_maximum(descriptor)) {
@@ -191,100 +439,17 @@ ldns_wire2rdf(ldns_rr *rr, const uint8_t *wire, size_t max, size_t *pos)
 		cur_rdf_type = ldns_rr_descriptor_field_type(
 				descriptor, rdf_index);
 
-		/* handle special cases immediately, set length
-		   for fixed length rdata and do them below */
-		switch (cur_rdf_type) {
-		case LDNS_RDF_TYPE_DNAME:
+		if (cur_rdf_type == LDNS_RDF_TYPE_DNAME) {
 			status = ldns_wire2dname(&cur_rdf, wire, max, pos);
 			LDNS_STATUS_CHECK_RETURN(status);
-			break;
-		case LDNS_RDF_TYPE_CLASS:
-		case LDNS_RDF_TYPE_ALG:
-		case LDNS_RDF_TYPE_CERTIFICATE_USAGE:
-		case LDNS_RDF_TYPE_SELECTOR:
-		case LDNS_RDF_TYPE_MATCHING_TYPE:
-		case LDNS_RDF_TYPE_INT8:
-			cur_rdf_length = LDNS_RDF_SIZE_BYTE;
-			break;
-		case LDNS_RDF_TYPE_TYPE:
-		case LDNS_RDF_TYPE_INT16:
-		case LDNS_RDF_TYPE_CERT_ALG:
-			cur_rdf_length = LDNS_RDF_SIZE_WORD;
-			break;
-		case LDNS_RDF_TYPE_TIME:
-		case LDNS_RDF_TYPE_INT32:
-		case LDNS_RDF_TYPE_A:
-		case LDNS_RDF_TYPE_PERIOD:
-			cur_rdf_length = LDNS_RDF_SIZE_DOUBLEWORD;
-			break;
-		case LDNS_RDF_TYPE_TSIGTIME:
-		case LDNS_RDF_TYPE_EUI48:
-			cur_rdf_length = LDNS_RDF_SIZE_6BYTES;
-			break;
-		case LDNS_RDF_TYPE_ILNP64:
-		case LDNS_RDF_TYPE_EUI64:
-			cur_rdf_length = LDNS_RDF_SIZE_8BYTES;
-			break;
-		case LDNS_RDF_TYPE_AAAA:
-			cur_rdf_length = LDNS_RDF_SIZE_16BYTES;
-			break;
-		case LDNS_RDF_TYPE_STR:
-		case LDNS_RDF_TYPE_NSEC3_SALT:
-		case LDNS_RDF_TYPE_TAG:
-			/* len is stored in first byte
-			 * it should be in the rdf too, so just
-			 * copy len+1 from this position
-			 */
-			cur_rdf_length = ((size_t) wire[*pos]) + 1;
-			break;
-
-		case LDNS_RDF_TYPE_INT16_DATA:
-			if (*pos + 2 > end) {
-				return LDNS_STATUS_PACKET_OVERFLOW;
-			}
-			cur_rdf_length =
-				(size_t) ldns_read_uint16(&wire[*pos]) + 2;
-			break;
-		case LDNS_RDF_TYPE_HIP:
-			if (*pos + 4 > end) {
-				return LDNS_STATUS_PACKET_OVERFLOW;
-			}
-			cur_rdf_length =
-				(size_t) wire[*pos] + 
-				(size_t) ldns_read_uint16(&wire[*pos + 2]) + 4;
-			break;
-		case LDNS_RDF_TYPE_B32_EXT:
-		case LDNS_RDF_TYPE_NSEC3_NEXT_OWNER:
-			/* length is stored in first byte */
-			cur_rdf_length = ((size_t) wire[*pos]) + 1;
-			break;
-		case LDNS_RDF_TYPE_APL:
-		case LDNS_RDF_TYPE_B64:
-		case LDNS_RDF_TYPE_HEX:
-		case LDNS_RDF_TYPE_NSEC:
-		case LDNS_RDF_TYPE_UNKNOWN:
-		case LDNS_RDF_TYPE_SERVICE:
-		case LDNS_RDF_TYPE_LOC:
-		case LDNS_RDF_TYPE_WKS:
-		case LDNS_RDF_TYPE_NSAP:
-		case LDNS_RDF_TYPE_ATMA:
-		case LDNS_RDF_TYPE_IPSECKEY:
-		case LDNS_RDF_TYPE_LONG_STR:
-		case LDNS_RDF_TYPE_AMTRELAY:
-		case LDNS_RDF_TYPE_SVCPARAMS:
-		case LDNS_RDF_TYPE_NONE:
-			/*
-			 * Read to end of rr rdata
-			 */
-			cur_rdf_length = end - *pos;
-			break;
+		} else {
+			status = ldns_rdf_wire_size(cur_rdf_type, wire, *pos,
+					end, &cur_rdf_length);
+			LDNS_STATUS_CHECK_RETURN(status);
 		}
 
 		/* fixed length rdata */
 		if (cur_rdf_length > 0) {
-			if (cur_rdf_length + *pos > end) {
-				return LDNS_STATUS_PACKET_OVERFLOW;
-			}
 			data = LDNS_XMALLOC(uint8_t, rd_length);
 			if (!data) {
 				return LDNS_STATUS_MEM_ERR;
@@ -362,6 +527,129 @@ status_error:
 	return status;
 }
 
+/* Walks over the rdata at pos like ldns_wire2rdf(), without making rdfs */
+static ldns_status
+ldns_wire_validate_rdata(ldns_rr_type type, const uint8_t *wire, size_t max,
+		size_t *pos, bool strict)
+{
+	const ldns_rr_descriptor *descriptor = ldns_rr_descript(type);
+	size_t end, size, fields = 0;
+	uint16_t rd_length;
+	uint8_t rdf_index = 0;
+	ldns_rdf_type rdf_type;
+	ldns_status status;
+
+	if (*pos + 2 > max) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	rd_length = ldns_read_uint16(&wire[*pos]);
+	*pos += 2;
+	if (*pos + rd_length > max) {
+		return LDNS_STATUS_PACKET_OVERFLOW;
+	}
+	end = *pos + (size_t) rd_length;
+
+	/* the index wraps as in ldns_wire2rdf() */
+	while (*pos < end &&
+			rdf_index < ldns_rr_descriptor_maximum(descriptor)) {
+		rdf_type = ldns_rr_descriptor_field_type(descriptor, rdf_index);
+		if (rdf_type == LDNS_RDF_TYPE_DNAME) {
+			status = ldns_wire2dname_buf(NULL, NULL, wire, max, pos);
+		} else {
+			status = ldns_rdf_wire_size(rdf_type, wire, *pos, end,
+					&size);
+			*pos += size;
+		}
+		if (status != LDNS_STATUS_OK) {
+			return status;
+		}
+		rdf_index++;
+		fields++;
+	}
+	/* empty rdata is allowed, for dynamic updates */
+	if (strict && rd_length > 0
+	&&  (*pos != end
+	  || fields < ldns_rr_descriptor_minimum(descriptor))) {
+		return LDNS_STATUS_WIRE_RDATA_ERR;
+	}
+	return LDNS_STATUS_OK;
+}
+
+ldns_status
+ldns_wire_validate(const uint8_t *wire, size_t max, bool strict)
+{
+	static const ldns_status incomplete[4] = {
+		LDNS_STATUS_WIRE_INCOMPLETE_QUESTION,
+		LDNS_STATUS_WIRE_INCOMPLETE_ANSWER,
+		LDNS_STATUS_WIRE_INCOMPLETE_AUTHORITY,
+		LDNS_STATUS_WIRE_INCOMPLETE_ADDITIONAL
+	};
+	size_t pos = LDNS_HEADER_SIZE, least = LDNS_HEADER_SIZE;
+	uint16_t counts[4];
+	ldns_rr_type type;
+	ldns_status status;
+	int s;
+	uint16_t i;
+
+	if (max < LDNS_HEADER_SIZE) {
+		return LDNS_STATUS_WIRE_INCOMPLETE_HEADER;
+	}
+	counts[LDNS_SECTION_QUESTION] = LDNS_QDCOUNT(wire);
+	counts[LDNS_SECTION_ANSWER] = LDNS_ANCOUNT(wire);
+	counts[LDNS_SECTION_AUTHORITY] = LDNS_NSCOUNT(wire);
+	counts[LDNS_SECTION_ADDITIONAL] = LDNS_ARCOUNT(wire);
+
+	if (strict) {
+		/* a question takes at least 5 bytes, a RR at least 11 */
+		for (s = LDNS_SECTION_QUESTION; s <= LDNS_SECTION_ADDITIONAL;
+				s++) {
+			least += (size_t)counts[s]
+			       * (s == LDNS_SECTION_QUESTION ? 5 : 11);
+			if (least > max) {
+				return incomplete[s];
+			}
+		}
+	}
+	for (s = LDNS_SECTION_QUESTION; s <= LDNS_SECTION_ADDITIONAL; s++) {
+		for (i = 0; i < counts[s]; i++) {
+			status = ldns_wire2dname_buf(NULL, NULL, wire, max, &pos);
+			if (status == LDNS_STATUS_OK && pos + 4 > max) {
+				status = LDNS_STATUS_PACKET_OVERFLOW;
+			}
+			if (status == LDNS_STATUS_OK
+			&&  s != LDNS_SECTION_QUESTION) {
+				type = (ldns_rr_type)
+					ldns_read_uint16(&wire[pos]);
+				pos += 4;
+				if (pos + 4 > max) {
+					status = LDNS_STATUS_PACKET_OVERFLOW;
+				} else {
+					pos += 4;
+					status = ldns_wire_validate_rdata(type,
+						wire, max, &pos, strict);
+				}
+				/* ldns_wire2pkt() takes a TSIG RR out of
+				 * the count it reads */
+				if (!strict && s == LDNS_SECTION_ADDITIONAL
+				&&  type == LDNS_RR_TYPE_TSIG) {
+					counts[s]--;
+				}
+			} else {
+				pos += 4;
+			}
+			if (status == LDNS_STATUS_PACKET_OVERFLOW) {
+				return incomplete[s];
+			} else if (status != LDNS_STATUS_OK) {
+				return status;
+			}
+		}
+	}
+	if (strict && pos != max) {
+		return LDNS_STATUS_WIRE_TRAILING_DATA;
+	}
+	return LDNS_STATUS_OK;
+}
+
 static ldns_status
 ldns_wire2pkt_hdr(ldns_pkt *packet, const uint8_t *wire, size_t max, size_t *pos)
 {
@@ -405,13 +693,18 @@ ldns_wire2pkt(ldns_pkt **packet_p, const uint8_t *wire, size_t max)
 	size_t pos = 0;
 	uint16_t i;
 	ldns_rr *rr;
-	ldns_pkt *packet = ldns_pkt_new();
+	ldns_pkt *packet;
 	ldns_status status = LDNS_STATUS_OK;
 	uint8_t have_edns = 0;
 
 	uint8_t data[4];
 
-	if (!packet) {
+	/* malformed packets are turned away before anything is allocated */
+	status = ldns_wire_validate(wire, max, false);
+	if (status != LDNS_STATUS_OK) {
+		return status;
+	}
+	if (!(packet = ldns_pkt_new())) {
 		return LDNS_STATUS_MEM_ERR;
 	}
 